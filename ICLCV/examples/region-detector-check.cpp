@@ -0,0 +1,261 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/region-detector-check.cpp               **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+#include <ICLCV/RegionDetector.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/Random.h>
+
+#include <set>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+// reference: the former sequential region detection with region part join trees
+namespace reference{
+  struct Part;
+
+  struct Segment{
+    int x,y,xend,val;
+    Part *reg;
+  };
+
+  struct Part{
+    std::vector<Part*> children;
+    std::vector<Segment*> segments;
+    bool top,collected;
+  };
+
+  struct Region{
+    int val;
+    bool isBorder;
+    std::vector<LineSegment> segments;
+    std::set<int> neighbours;
+  };
+
+  static void collect(Part *p, int id, std::vector<LineSegment> &dst, std::vector<int> &ids,
+                      const Segment *base){
+    if(p->collected) return;
+    p->collected = true;
+    for(unsigned int i=0;i<p->segments.size();++i){
+      const Segment *s = p->segments[i];
+      dst.push_back(LineSegment(s->x,s->y,s->xend));
+      ids[s-base] = id;
+    }
+    for(unsigned int i=0;i<p->children.size();++i){
+      collect(p->children[i],id,dst,ids,base);
+    }
+  }
+
+  static void join(Part *oldR, Part *newR, Segment *begin, Segment *end){
+    for(Segment *s=begin;s!=end;++s){
+      if(s->reg == oldR){
+        oldR->top = false;
+        newR->children.push_back(oldR);
+        s->reg = newR;
+      }
+    }
+  }
+
+  static void link(std::vector<Region> &regions, int a, int b){
+    if(a != b){
+      regions[a].neighbours.insert(b);
+      regions[b].neighbours.insert(a);
+    }
+  }
+
+  std::vector<Region> detect(const Img8u &image){
+    const Rect roi = image.getROI();
+    const int W = roi.width, H = roi.height;
+
+    // run length encoding
+    std::vector<Segment> segments;
+    std::vector<int> rows(H+1);
+    segments.reserve(W*H);
+    for(int y=0;y<H;++y){
+      rows[y] = (int)segments.size();
+      const icl8u *p = &image(roi.x,roi.y+y,0);
+      for(int x=0;x<W;){
+        int xend = x+1;
+        while(xend < W && p[xend] == p[x]) ++xend;
+        Segment s = { roi.x+x, roi.y+y, roi.x+xend, p[x], 0 };
+        segments.push_back(s);
+        x = xend;
+      }
+    }
+    rows[H] = (int)segments.size();
+    Segment *base = segments.data();
+
+    // region parts
+    std::vector<Part> parts(segments.size());
+    Part *nextReg = parts.data();
+    for(int y=0;y<H;++y){
+      Segment *cStart = base + rows[y], *c = cStart, *cEnd = base + rows[y+1];
+      Segment *l = y ? base + rows[y-1] : 0, *lEnd = y ? cStart : 0;
+      while(c < cEnd){
+        if(y){
+          do{
+            if(l->val == c->val && c->reg != l->reg){
+              if(!c->reg){
+                c->reg = l->reg;
+                c->reg->segments.push_back(c);
+              }else{
+                Part *oldR = l->reg, *newR = c->reg;
+                join(oldR,newR,l,lEnd);
+                join(oldR,newR,cStart,c);
+              }
+            }
+          }while(c->xend > l->xend && ++l);
+        }
+        if(!c->reg){
+          c->reg = nextReg++;
+          c->reg->segments.push_back(c);
+          c->reg->top = true;
+          c->reg->collected = false;
+        }
+        if(y && c->xend == l->xend) ++l;
+        ++c;
+      }
+    }
+
+    // regions
+    std::vector<Region> regions;
+    std::vector<int> ids(segments.size());
+    for(Part *p=parts.data();p!=nextReg;++p){
+      if(p->top){
+        regions.push_back(Region());
+        regions.back().val = p->segments[0]->val;
+        regions.back().isBorder = false;
+        collect(p,(int)regions.size()-1,regions.back().segments,ids,base);
+      }
+    }
+
+    // region graph
+    for(int y=0;y<H;++y){
+      for(int i=rows[y];i<rows[y+1];++i){
+        if(i > rows[y]) link(regions,ids[i-1],ids[i]);
+        if(y){
+          for(int k=rows[y-1];k<rows[y];++k){
+            if(segments[k].x < segments[i].xend && segments[k].xend > segments[i].x){
+              link(regions,ids[k],ids[i]);
+            }
+          }
+        }
+        if(!y || y == H-1 || i == rows[y] || i == rows[y+1]-1){
+          regions[ids[i]].isBorder = true;
+        }
+      }
+    }
+    return regions;
+  }
+}
+
+// creates an image with random blobs of the given size and the given number of different values
+Img8u create_image(const Size &size, int blobSize, int nValues){
+  Img8u image(size,1);
+  const int bw = (size.width+blobSize-1)/blobSize, bh = (size.height+blobSize-1)/blobSize;
+  std::vector<icl8u> blobs(bw*bh);
+  for(unsigned int i=0;i<blobs.size();++i){
+    blobs[i] = (icl8u)random((unsigned int)nValues);
+  }
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      image(x,y,0) = blobs[(y/blobSize)*bw + x/blobSize];
+    }
+  }
+  return image;
+}
+
+// compares the regions of the RegionDetector with the reference, returns the number of differences
+int compare(const std::vector<ImageRegion> &rs, const std::vector<reference::Region> &ref){
+  if(rs.size() != ref.size()){
+    std::cout << "  number of regions differs: " << rs.size() << " (reference: " << ref.size() << ")" << std::endl;
+    return 1;
+  }
+  int errors = 0;
+  for(unsigned int i=0;i<rs.size();++i){
+    const ImageRegion &r = rs[i];
+    const std::vector<LineSegment> &sls = r.getLineSegments();
+    bool equal = r.getID() == (int)i && r.getVal() == ref[i].val && sls.size() == ref[i].segments.size();
+    for(unsigned int j=0;equal && j<sls.size();++j){
+      const LineSegment &a = sls[j], &b = ref[i].segments[j];
+      equal = a.x == b.x && a.y == b.y && a.xend == b.xend;
+    }
+    std::set<int> neighbours;
+    const std::vector<ImageRegion> &ns = r.getNeighbours();
+    for(unsigned int j=0;j<ns.size();++j){
+      neighbours.insert(ns[j].getID());
+    }
+    equal = equal && neighbours == ref[i].neighbours && r.isBorderRegion() == ref[i].isBorder;
+    if(!equal){
+      if(errors < 10){
+        std::cout << "  region " << i << " differs (id: " << r.getID() << ", segments: " << sls.size()
+                  << ", reference segments: " << ref[i].segments.size() << ")" << std::endl;
+      }
+      ++errors;
+    }
+  }
+  return errors;
+}
+
+int main(int n, char **ppc){
+  pa_explain("-size","image size")
+            ("-n","number of random images per configuration")
+            ("-seed","random seed");
+  pa_init(n,ppc,"-size|-s(Size=VGA) -n(int=10) -seed(int=42)");
+
+  const Size size = pa("-size");
+  const int N = pa("-n");
+  randomSeed((long int)pa("-seed").as<int>());
+
+  const int blobSizes[] = { 1, 1, 2, 5, 20 };
+  const int nValues[] = { 2, 3, 2, 4, 6 };
+  RegionDetector rd(true);
+  rd.setConstraints(0,size.getDim(),0,255);
+
+  int failed = 0;
+  for(int c=0;c<5;++c){
+    for(int i=0;i<N;++i){
+      Img8u image = create_image(size,blobSizes[c],nValues[c]);
+      if(i%2){
+        image.setROI(Rect(size.width/8,size.height/8,size.width/2+1,size.height/2+3));
+      }
+      const int errors = compare(rd.detect(&image),reference::detect(image));
+      if(errors){
+        std::cout << "image " << i << " (blob size " << blobSizes[c] << ", " << nValues[c]
+                  << " values" << (i%2 ? ", with ROI" : "") << "): " << errors << " differences" << std::endl;
+        ++failed;
+      }
+    }
+  }
+  std::cout << (5*N-failed) << " of " << 5*N << " images were processed equally" << std::endl;
+  return failed ? 1 : 0;
+}
@@ -106,6 +106,7 @@ namespace icl{
     int ImageRegion::getSize() const{
       // {{{ open
   
+      if(m_data->moments) return m_data->moments->m00[m_data->id];
       int &size = data()->size;
       if(size) return size;
       for(unsigned int i=0;i<data()->segments.size();++i){
@@ -133,6 +134,7 @@ namespace icl{
   
     Point32f ImageRegion::getCOG() const{
       // {{{ open
+      if(m_data->moments) return m_data->moments->getCOG(m_data->id);
       ImageRegionData::SimpleInformation *simple = m_data->ensureSimple();
       if(simple->cog) return *simple->cog;
       
@@ -157,6 +159,7 @@ namespace icl{
     
     const Rect &ImageRegion::getBoundingBox() const{
       // {{{ open
+      if(m_data->moments) return m_data->moments->boundingBoxes[m_data->id];
       ImageRegionData::SimpleInformation *simple = m_data->ensureSimple();
       if(simple->boundingBox) return *simple->boundingBox;
       
@@ -197,6 +200,9 @@ namespace icl{
       // {{{ open
       ImageRegionData::SimpleInformation *simple = m_data->ensureSimple();
       if(simple->pcainfo) return *simple->pcainfo;
+      if(m_data->moments){
+        return *(simple->pcainfo = new RegionPCAInfo(m_data->moments->getPCAInfo(m_data->id)));
+      }
       
       register int x,end,len;
       register double y;
@@ -226,17 +232,7 @@ namespace icl{
       avgYY/=nPts;
       avgXY/=nPts;
       
-      
-      double fSxx = avgXX - avgX*avgX;
-      double fSyy = avgYY - avgY*avgY;
-      double fSxy = avgXY - avgX*avgY;
-      
-      double fP = 0.5*(fSxx+fSyy);
-      double fD = 0.5*(fSxx-fSyy);
-      fD = ::sqrt(fD*fD + fSxy*fSxy);
-      double fA  = fP + fD;
-      
-      return *(simple->pcainfo = new RegionPCAInfo(2*::sqrt(fP + fD),2*::sqrt(fP - fD),::atan2(fA-fSxx,fSxy),avgX,avgY));
+      return *(simple->pcainfo = new RegionPCAInfo(RegionMoments::computePCAInfo(avgX,avgY,avgXX,avgXY,avgYY)));
     }
     // }}}
    
@@ -592,7 +588,7 @@ namespace icl{
       if(inner->graph->isBorder) return true;
       
       // then: depth first
-      for(std::set<ImageRegionData*>::iterator it=inner->graph->neighbours.begin(), 
+      for(ImageRegionData::NeighbourSet::iterator it=inner->graph->neighbours.begin(), 
           itEnd=inner->graph->neighbours.end() ; it != itEnd; ++it){
         //      if((*it)->isBorder) return true; // we check all neighbours first
         if(!buf.count(*it)){
@@ -627,7 +623,7 @@ namespace icl{
       if (inner->graph->isBorder || is_rect_larger(ImageRegion(inner).getBoundingBox(),r)) return true;
       
       // then: depth first
-      for(std::set<ImageRegionData*>::iterator it=inner->graph->neighbours.begin(), 
+      for(ImageRegionData::NeighbourSet::iterator it=inner->graph->neighbours.begin(), 
           itEnd=inner->graph->neighbours.end() ; it != itEnd; ++it){
         //      if((*it)->isBorder) return true; // we check all neighbours first
         if(!buf.count(*it)){
@@ -650,7 +646,7 @@ namespace icl{
     }
   
   
-    void collect_subregions_recursive(std::set<ImageRegionData*> &all, ImageRegionData *r){
+    void collect_subregions_recursive(ImageRegionData::NeighbourSet &all, ImageRegionData *r){
       ImageRegion(r).getSubRegions();
       
       std::vector<ImageRegionData*> &cs = r->graph->children;
@@ -674,8 +670,8 @@ namespace icl{
       if(!complex->directSubRegions){
         ImageRegionData *r = m_data;
         if(r->graph->neighbours.size() > 1){
-          std::set<ImageRegionData*> &nb = r->graph->neighbours;
-          for(std::set<ImageRegionData*>::iterator itn = nb.begin();itn != nb.end(); ++itn){
+          ImageRegionData::NeighbourSet &nb = r->graph->neighbours;
+          for(ImageRegionData::NeighbourSet::iterator itn = nb.begin();itn != nb.end(); ++itn){
             ImageRegionData *n = *itn;
             if(!n->graph->isBorder){
               if(n->graph->neighbours.size() == 1 || is_region_contained_bb(r,n)){
@@ -689,7 +685,7 @@ namespace icl{
       if(directOnly){
         return *complex->directSubRegions;
       }else{
-        std::set<ImageRegionData*> all; 
+        ImageRegionData::NeighbourSet all; 
         collect_subregions_recursive(all,m_data); 
         return *(complex->allSubRegions = new std::vector<ImageRegion>(all.begin(),all.end()));
       }
@@ -734,7 +730,7 @@ namespace icl{
       ImageRegionData::ComplexInformation *complex = m_data->ensureComplex();
       if(complex->publicNeighbours) return *complex->publicNeighbours;
   
-      std::set<ImageRegionData*> &nb = m_data->graph->neighbours;
+      ImageRegionData::NeighbourSet &nb = m_data->graph->neighbours;
       return *(complex->publicNeighbours = new std::vector<ImageRegion>(nb.begin(),nb.end()));
     }
   
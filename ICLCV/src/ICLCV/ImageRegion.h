@@ -136,6 +136,8 @@ namespace icl{
       void sample(core::ImgBase *image, const std::vector<int> &channelColors);
       
       /// returns the pixel count of the Region
+      /** This and getCOG(), getBoundingBox() and getPCAInfo() are O(1) operations
+          if the parent RegionDetector accumulates region moments (see RegionMoments) */
       int getSize() const;
       
       /// returns the pixel value of  the region
@@ -30,7 +30,8 @@
 
 
 #include <ICLCV/ImageRegionData.h>
-#include <ICLCV/ImageRegionPart.h>
+
+#include <algorithm>
 
 using namespace icl::utils;
 using namespace icl::core;
@@ -39,52 +40,121 @@ namespace icl{
   namespace cv{
   
   
-    struct TransformLinesegAndSetImageRegionData{
-      ImageRegionData *d;
-      TransformLinesegAndSetImageRegionData(ImageRegionData *d) : d(d){}
-      const LineSegment &operator()(WorkingLineSegment *in){
-        in->ird = d;
-        return *in;
-      }
-    };
-  
-    static unsigned int collect(ImageRegionPart *r, LineSegment *s, ImageRegionData *ird){
-      if(r->is_collected()) return 0;
-      r->notify_collected();
-      LineSegment *sSave = s;
-      
-      std::transform(r->segments.begin(),r->segments.end(),s,TransformLinesegAndSetImageRegionData(ird));
-      
-      s += r->segments.size();
-      
-      for(ImageRegionPart::children_container::iterator it = r->children.begin(); it != r->children.end(); ++it){
-        s += collect(*it,s,ird);
+    void ImageRegionData::reinit(int value, int id, unsigned int segmentSize, bool createGraph, const ImgBase *image){
+      this->value = value;
+      this->id = id;
+      this->size = 0;
+      this->image = image;
+      segments.resize(segmentSize);
+      meta = Any();
+      moments = 0;
+      if(createGraph){
+        if(graph){
+          graph->isBorder = false;
+          graph->neighbours.clear();
+          graph->children.clear();
+          graph->parent = 0;
+        }else{
+          graph = new RegionGraphInfo;
+        }
+      }else{
+        ICL_DELETE(graph);
       }
-      
-      return (unsigned int)(s - sSave);
+      ICL_DELETE(simple);
+      ICL_DELETE(complex);
     }
   
+    void ImageRegionData::computeMoments(RegionMoments *moments){
+      moments->compute(id,segments.data(),segments.data()+segments.size());
+      this->moments = moments;
+    }
   
-    static unsigned int count(ImageRegionPart *r){
-      if(r->is_counted()) return 0;
-      r->notify_counted();
-      
-      unsigned int n = r->segments.size();
-      for(ImageRegionPart::children_container::iterator it = r->children.begin(); it != r->children.end(); ++it){
-        n += count(*it);
+    namespace{
+      /// union-find over region parts: returns the top part of p (with path halving)
+      inline int part_find(int *up, int p){
+        while(up[p] != p){
+          up[p] = up[up[p]];
+          p = up[p];
+        }
+        return p;
       }
-      return n;
     }
-    
-    ImageRegionData * ImageRegionData::createInstance(CornerDetectorCSS *css, ImageRegionPart *topRegionPart, int id, bool createGraphInfo, const ImgBase *image){
-      ImageRegionData *data = new ImageRegionData(css,topRegionPart->val,id,count(topRegionPart), createGraphInfo, image);
-      collect(topRegionPart, data->segments.data(),data);
-      return data;
+
+    LineSegment ImageRegionData::restoreJoinTreeOrder(std::vector<int> &buffer, std::vector<LineSegment> &sorted){
+      const int n = (int)segments.size();
+      if(n == 1) return segments[0];
+      buffer.resize(7*n);
+      int *part = buffer.data();     // part of each segment (possibly adopted meanwhile)
+      int *up = part + n;            // union-find entries of the parts
+      int *next = up + n;            // next own segment of the same part
+      int *tail = next + n;          // last own segment of each part
+      int *child = tail + n;         // first adopted part of each part
+      int *lastChild = child + n;    // last adopted part of each part
+      int *sibling = lastChild + n;  // next part adopted by the same part
+      bool joined = false;
+
+      int pBegin = 0, pEnd = 0, cBegin = 0, l = 0;
+      for(int i=0;i<n;++i){
+        const LineSegment &c = segments[i];
+        if(!i || c.y != segments[i-1].y){
+          if(i && segments[i-1].y == c.y-1){
+            pBegin = cBegin;
+            pEnd = i;
+          }else{
+            pBegin = pEnd = i;
+          }
+          cBegin = i;
+          l = pBegin;
+        }
+        part[i] = -1;
+        while(l < pEnd && segments[l].xend <= c.x) ++l;
+        for(int k=l; k < pEnd && segments[k].x < c.xend; ++k){
+          const int lt = part_find(up,part[k]);
+          if(part[i] == -1){
+            part[i] = lt;
+            next[tail[lt]] = i;
+            tail[lt] = i;
+            next[i] = -1;
+          }else{
+            const int ct = part_find(up,part[i]);
+            if(ct != lt){
+              up[lt] = ct;
+              if(child[ct] == -1) child[ct] = lt;
+              else sibling[lastChild[ct]] = lt;
+              lastChild[ct] = lt;
+              joined = true;
+            }
+          }
+        }
+        if(part[i] == -1){
+          part[i] = up[i] = tail[i] = i;
+          next[i] = child[i] = sibling[i] = -1;
+        }
+      }
+
+      if(!joined) return segments[0]; // a single part: segments are in scan-line order
+      const int top = part_find(up,part[0]);
+      const LineSegment topSegment = segments[top];
+
+      // depth-first collection (the part stack re-uses the tail entries)
+      sorted.resize(n);
+      int *stack = tail, sp = 0, m = 0;
+      stack[sp++] = top;
+      while(sp){
+        const int p = stack[--sp];
+        for(int s=p; s != -1; s=next[s]){
+          sorted[m++] = segments[s];
+        }
+        const int sp0 = sp;
+        for(int a=child[p]; a != -1; a=sibling[a]){
+          stack[sp++] = a;
+        }
+        std::reverse(stack+sp0,stack+sp);
+      }
+      std::copy(sorted.begin(),sorted.end(),segments.begin());
+      return topSegment;
     }
   
-  
-  
-    
     void ImageRegionData::showTree(int indent) const{
       ICLASSERT_RETURN(graph);
       for(int i=0;i<indent-1;++i) std::cout << "   ";
@@ -97,7 +167,7 @@ namespace icl{
     void ImageRegionData::showWithNeighbours() const{
       ICLASSERT_RETURN(graph);
       std::cout << "neighbours of region " << id << ':'<< std::endl;
-      for(std::set<ImageRegionData*>::const_iterator it = graph->neighbours.begin(); it != graph->neighbours.end(); ++it){
+      for(NeighbourSet::const_iterator it = graph->neighbours.begin(); it != graph->neighbours.end(); ++it){
         if(!*it) {
           std::cout << "\t" << "Border" << std::endl;
         }else{
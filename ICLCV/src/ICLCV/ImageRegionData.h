@@ -37,6 +37,7 @@
 #include <ICLCV/ImageRegionPart.h>
 #include <ICLCV/ImageRegion.h>
 #include <ICLCV/RegionPCAInfo.h>
+#include <ICLCV/RegionMoments.h>
 #include <ICLCV/CornerDetectorCSS.h>
 
 #include <set>
@@ -51,13 +52,40 @@ namespace icl{
     private:
       typedef ImageRegionData IRD;
     public:
+      /// orders regions by their IDs (this makes the order of region neighbours and sub-regions reproducible)
+      struct IDLess{
+        inline bool operator()(const ImageRegionData *a, const ImageRegionData *b) const{
+          return a->id < b->id;
+        }
+      };
+      
+      /// set type for region neighbours and sub-regions
+      typedef std::set<ImageRegionData*,IDLess> NeighbourSet;
+
       friend class RegionDetector; 
       friend struct ImageRegion;     
       friend bool region_search_border(std::set<IRD*>&,IRD*); 
-      friend void collect_subregions_recursive(std::set<IRD*>&,IRD*);
+      friend void collect_subregions_recursive(NeighbourSet&,IRD*);
       friend bool is_region_contained(IRD*,IRD*);
       friend bool region_search_outer_bb(const utils::Rect&,std::set<IRD*>&,IRD*);
-    
+
+      /// re-initializes an instance for the next detection run (used by the RegionDetector)
+      /** The RegionDetector re-uses its ImageRegionData instances. All cached
+          information is released, but the allocated segment buffer is kept. */
+      void reinit(int value, int id, unsigned int segmentSize, bool createGraph, const core::ImgBase *image);
+
+      /// computes the region's entry (at index id) of the given moments and uses them from now on
+      void computeMoments(RegionMoments *moments);
+
+      /// sorts the line segments like the region part join tree of the scan-line algorithm (used by the RegionDetector)
+      /** The line segments must be given in scan-line order. Each segment either extends the
+          part of the first adjacent segment above or it creates a new part. If a segment touches
+          another part, its own part adopts the other one. This is replayed for the region's segments,
+          which are then collected depth-first from the top part (own segments before adopted parts).
+          The given buffers are used as temporary memory. Returns the segment that created the
+          top part (the RegionDetector numbers the regions in scan-line order of these segments) */
+      LineSegment restoreJoinTreeOrder(std::vector<int> &buffer, std::vector<LineSegment> &sorted);
+
     private:
       /// image pixle value
       int  value; 
@@ -76,6 +104,9 @@ namespace icl{
       
       /// meta data, that can be associated with a region structure
       utils::Any meta;
+
+      /// accumulated moments of all regions (indexed by id, null if not accumulated)
+      const RegionMoments *moments;
   
       /// structure for representing region-graph information
       struct RegionGraphInfo{
@@ -86,7 +117,7 @@ namespace icl{
         bool isBorder;
         
         // region graph information
-        std::set<ImageRegionData*> neighbours;
+        NeighbourSet neighbours;
   
         // child regions
         std::vector<ImageRegionData*> children;
@@ -169,13 +200,11 @@ namespace icl{
       
       CornerDetectorCSS *css; //!< for corner detection
   
-      /// Utility factory function
-      static ImageRegionData *createInstance(CornerDetectorCSS *css, ImageRegionPart *topRegionPart, int id, bool createGraphInfo, const core::ImgBase *image);
-  
       /// Constructor
       inline ImageRegionData(CornerDetectorCSS *css, int value, int id, unsigned int segmentSize, bool createGraph,const core::ImgBase *image):
-        value(value),id(id),size(0),image(image),segments(segmentSize),graph(createGraph ? new RegionGraphInfo : 0),
+        value(value),id(id),size(0),image(image),segments(segmentSize),moments(0),graph(createGraph ? new RegionGraphInfo : 0),
       simple(0),complex(0),css(css){}
+
       
       /// Destructor
       inline ~ImageRegionData(){
@@ -35,10 +35,10 @@
 #include <ICLCV/LineSegment.h>
 #include <ICLCV/WorkingLineSegment.h>
 #include <ICLCV/RunLengthEncoder.h>
-#include <ICLCV/ImageRegionPart.h>
 
 #include <ICLUtils/Range.h>
 #include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
 
 #include <algorithm>
 
@@ -50,16 +50,133 @@ namespace icl{
   namespace cv{
   
     namespace{
-      struct JoinRegionsIf{
-        ImageRegionPart *m_oldR;
-        ImageRegionPart *m_newR;
-        inline JoinRegionsIf(ImageRegionPart*oldR, ImageRegionPart*newR):
-          m_oldR(oldR),m_newR(newR){
+      /// images with less pixels are labeled by the calling thread only
+      static const int LABEL_PARALLEL_MIN_PIXELS = 1<<16;
+
+      /// minimum number of rows of a band that is labeled by a single task
+      static const int LABEL_MIN_BAND_HEIGHT = 16;
+
+      /// union-find: returns the root of x (with path halving)
+      inline int uf_find(int *parent, int x){
+        while(parent[x] != x){
+          parent[x] = parent[parent[x]];
+          x = parent[x];
+        }
+        return x;
+      }
+
+      /// union-find: joins the sets of a and b
+      /** The smaller root index always becomes the new root. Since segment
+          indices grow in scan-line order, the root of each set is always its
+          first segment, no matter in which order the sets were joined */
+      inline void uf_unite(int *parent, int a, int b){
+        a = uf_find(parent,a);
+        b = uf_find(parent,b);
+        if(a < b) parent[b] = a;
+        else if(b < a) parent[a] = b;
+      }
+
+      /// joins the sets of all adjacent segments of the rows y-1 and y that have the same value
+      inline void merge_rows(const RunLengthEncoder &rle, int *parent, int y){
+        const WorkingLineSegment *base = rle.begin(0);
+        const WorkingLineSegment *l = rle.begin(y-1);
+        const WorkingLineSegment *c = rle.begin(y);
+        const WorkingLineSegment *cEnd = rle.end(y);
+        while(c < cEnd){
+          do{
+            if(l->val == c->val){
+              uf_unite(parent,(int)(l-base),(int)(c-base));
+            }
+          }while(c->xend > l->xend && ++l);
+
+          if(c->xend == l->xend) ++l;
+          ++c;
+        }
+      }
+
+      /// labels all segments of the bands [begin,end)
+      /** Each band only accesses the union-find entries of its own
+          segments, so bands can be processed in parallel */
+      struct LabelBands{
+        const RunLengthEncoder *rle;
+        int *parent;
+        int H;
+        int bandHeight;
+
+        void operator()(int begin, int end) const{
+          const WorkingLineSegment *base = rle->begin(0);
+          for(int band=begin;band<end;++band){
+            const int yBegin = band*bandHeight, yEnd = iclMin(H,yBegin+bandHeight);
+            for(int y=yBegin;y<yEnd;++y){
+              for(const WorkingLineSegment *s=rle->begin(y); s != rle->end(y); ++s){
+                const int i = (int)(s-base);
+                parent[i] = i;
+              }
+              if(y > yBegin) merge_rows(*rle,parent,y);
+            }
+          }
+        }
+      };
+
+      /// finds the root of each segment of the rows [begin,end) (without modifying the union-find entries)
+      struct FindRoots{
+        const RunLengthEncoder *rle;
+        const int *parent;
+        int *roots;
+
+        void operator()(int begin, int end) const{
+          const WorkingLineSegment *base = rle->begin(0);
+          for(int y=begin;y<end;++y){
+            for(const WorkingLineSegment *s=rle->begin(y); s != rle->end(y); ++s){
+              int x = (int)(s-base);
+              while(parent[x] != x) x = parent[x];
+              roots[s-base] = x;
+            }
+          }
+        }
+      };
+
+      /// re-initializes the region data structures [begin,end) and resets their segment counters
+      struct ReinitRegions{
+        ImageRegionData **data;
+        int *sizes;
+        const int *values;
+        bool createGraph;
+        const ImgBase *image;
+
+        void operator()(int begin, int end) const{
+          for(int r=begin;r<end;++r){
+            data[r]->reinit(values[r],r,sizes[r],createGraph,image);
+            sizes[r] = 0;
+          }
+        }
+      };
+
+      /// restores the region part join tree order of the regions [begin,end)
+      /** The scan-line position of each region's top part is written to tops */
+      struct JoinTreeOrder{
+        ImageRegionData **data;
+        std::pair<int,int> *tops;
+        int W;
+
+        void operator()(int begin, int end) const{
+          std::vector<int> buffer;
+          std::vector<LineSegment> sorted;
+          for(int r=begin;r<end;++r){
+            const LineSegment top = data[r]->restoreJoinTreeOrder(buffer,sorted);
+            tops[r] = std::make_pair(top.y*W + top.x, r);
+          }
         }
-        inline void operator()(WorkingLineSegment &sl) const { 
-          if(sl.reg == m_oldR){
-            m_newR->children.push_back(m_oldR->adopt());
-            sl.reg = m_newR;
+      };
+
+      /// computes the moments of the regions [begin,end) and links them to the regions
+      struct ComputeMoments{
+        ImageRegionData **data;
+        RegionMoments *moments;
+
+        void operator()(int begin, int end) const{
+          for(int r=begin;r<end;++r){
+            data[r]->computeMoments(moments);
           }
         }
       };
@@ -73,16 +190,24 @@ namespace icl{
       Rect roi;
       RunLengthEncoder rle;
       
-      std::vector<ImageRegionPart> parts;
-      int nUsedParts;
+      std::vector<int> parent;         //!< union-find entries (one per segment buffer entry)
+      std::vector<int> roots;          //!< region index of each segment
+      std::vector<int> sizes;          //!< number of segments of each region
+      std::vector<int> values;         //!< value of each region
+      std::vector<std::pair<int,int> > tops; //!< scan-line position of each region's top part and region index
+      int nRegions;                    //!< number of regions found in the last run
+      
+      RegionMoments moments;           //!< moments of all regions (see RegionDetector::getRegionMoments)
+      bool momentsValid;               //!< whether the moments were computed for the last run
       
       std::vector<ImageRegion> regions;
       std::vector<ImageRegion> filteredRegions;
   
+      /// arena of region data structures (re-used in subsequent runs)
       std::vector<ImageRegionData*> regionData;
       
       
-      Data():image(0){}
+      Data():image(0),nRegions(0),momentsValid(false){}
   
       ~Data(){
         for(unsigned int i=0;i<regionData.size();++i){
@@ -110,6 +235,19 @@ namespace icl{
                   "detection step. This graph is used to find\n"
                   "region neighbours, children (fully contained\n"
                   "regions) and parents.");
+      addProperty("accumulate moments","menu","off,on","off",0,
+                  "If this property is set to 'on', the raw\n"
+                  "moments and bounding boxes of all regions are\n"
+                  "computed in the region creation step. This makes\n"
+                  "the region's size, center of gravity, bounding\n"
+                  "box and PCA-information O(1) operations.");
+      addProperty("track times.on","flag","",false);
+      addProperty("track times.rle","info","","-");
+      addProperty("track times.label regions","info","","-");
+      addProperty("track times.create regions","info","","-");
+      addProperty("track times.create graph","info","","-");
+      addProperty("track times.filter regions","info","","-");
+      addProperty("track times.total","info","","-");
   
       addChildConfigurable(&m_data->css,"CSS");
     }
@@ -123,10 +261,11 @@ namespace icl{
       addProperty("minimum value","range:slider","[0,255]",str(minVal));
       addProperty("maximum value","range:slider","[0,255]",str(maxVal));
       addProperty("create region graph","menu","off,on",createRegionGraph ? "on" : "off");
+      addProperty("accumulate moments","menu","off,on","off");
       addProperty("track times.on","flag","",false);
       addProperty("track times.rle","info","","-");
-      addProperty("track times.analyse regions","info","","-");
-      addProperty("track times.join regions","info","","-");
+      addProperty("track times.label regions","info","","-");
+      addProperty("track times.create regions","info","","-");
       addProperty("track times.create graph","info","","-");
       addProperty("track times.filter regions","info","","-");
       addProperty("track times.total","info","","-");
@@ -138,6 +277,10 @@ namespace icl{
       setPropertyValue("create region graph", on ? "on" : "off");
     }  
   
+    void RegionDetector::setAccumulateMoments(bool on){
+      setPropertyValue("accumulate moments", on ? "on" : "off");
+    }
+
     RegionDetector::~RegionDetector(){
       delete m_data;
     }
@@ -179,75 +322,140 @@ namespace icl{
       m_data->image = image;
     }
     
-    void RegionDetector::analyseRegions(){
+    void RegionDetector::labelRegions(){
       //BENCHMARK_THIS_FUNCTION;
-      int W = m_data->roi.width, H = m_data->roi.height;
-      if((int)m_data->parts.size() != W*H){
-        m_data->parts.resize(W*H);
+      const int W = m_data->roi.width, H = m_data->roi.height;
+      if((int)m_data->parent.size() != W*H){
+        m_data->parent.resize(W*H);
+        m_data->roots.resize(W*H);
       }
+      const RunLengthEncoder &rle = m_data->rle;
+      int *parent = m_data->parent.data();
       
-      ImageRegionPart *nextReg = m_data->parts.data()-1;
-      RunLengthEncoder &rle = m_data->rle;
-      
-      // start region-detection on scan-line basis
-      // first line: each sl gets a new region
-      for(WorkingLineSegment *s=rle.begin(0); s != rle.end(0); ++s){
-        s->reg = (++nextReg)->init(s); 
+      // label bands of image rows independently
+      int nBands = 1;
+      if(W*H >= LABEL_PARALLEL_MIN_PIXELS){
+        nBands = iclMin(2*TaskScheduler::instance().getNumThreads(), H/LABEL_MIN_BAND_HEIGHT);
       }
-  
-      for(int y=1;y<H;++y){
-        WorkingLineSegment *l = rle.begin(y-1); 
-        WorkingLineSegment *c = l+W;
-        
-        WorkingLineSegment *lEnd = rle.end(y-1);
-        WorkingLineSegment *cEnd = rle.end(y);
-        WorkingLineSegment *cStart = c;
-        while(c < cEnd){
-          do{
-            if( (l->val == c->val) && (c->reg != l->reg) ){
-              if(!c->reg){
-                c->reg = l->reg; // just copy the label if only one is equal
-                c->reg->segments.push_back(c);
-              }else{
-                JoinRegionsIf joiner(l->reg,c->reg);
-                std::for_each(l,lEnd,joiner);
-                std::for_each(cStart,c,joiner);
-              }
-            }
-          }while(c->xend > l->xend && ++l);
-  
-          if(!c->reg){
-            c->reg = (++nextReg)->init(c); 
-          }
-          if(c->xend == l->xend) ++l;
-          ++c;
-        }
+      nBands = iclMax(nBands,1);
+      const int bandHeight = (H + nBands - 1) / nBands;
+      nBands = (H + bandHeight - 1) / bandHeight;
+      const LabelBands bands = { &rle, parent, H, bandHeight };
+      if(nBands == 1){
+        bands(0,1);
+      }else{
+        parallel_for(0,nBands,bands,1);
+      }
+      
+      // merge the seams between the bands
+      for(int band=1;band<nBands;++band){
+        merge_rows(rle,parent,band*bandHeight);
       }
-      ++nextReg;
-      m_data->nUsedParts =  (int)(nextReg-m_data->parts.data());
     }
   
-    void RegionDetector::joinRegions(){
+    void RegionDetector::createRegions(){
       //BENCHMARK_THIS_FUNCTION;
-      /// clear former data regions and their data
       m_data->regions.clear();
       m_data->filteredRegions.clear();
-      for(unsigned int i=0;i<m_data->regionData.size();++i){
-        delete m_data->regionData[i];
+      
+      const int W = m_data->roi.width, H = m_data->roi.height;
+      RunLengthEncoder &rle = m_data->rle;
+      WorkingLineSegment *base = rle.begin(0);
+      int *roots = m_data->roots.data();
+      
+      const FindRoots findRoots = { &rle, m_data->parent.data(), roots };
+      if(W*H < LABEL_PARALLEL_MIN_PIXELS){
+        findRoots(0,H);
+      }else{
+        parallel_for(0,H,findRoots);
       }
-      m_data->regionData.clear();
       
-      bool crg = getPropertyValue("create region graph") == "on";
+      // the first segment of each set is its root: regions are temporarily
+      // numbered in scan-line order of their first segment. Here, the roots
+      // are replaced by region indices
+      std::vector<int> &sizes = m_data->sizes;
+      std::vector<int> &values = m_data->values;
+      sizes.clear();
+      values.clear();
+      for(int y=0;y<H;++y){
+        for(WorkingLineSegment *s=rle.begin(y); s != rle.end(y); ++s){
+          const int i = (int)(s-base);
+          if(roots[i] == i){
+            roots[i] = (int)sizes.size();
+            sizes.push_back(1);
+            values.push_back(s->val);
+          }else{
+            roots[i] = roots[roots[i]];
+            ++sizes[roots[i]];
+          }
+        }
+      }
+      m_data->nRegions = (int)sizes.size();
       
-      int nextID = -1;
-      ImageRegionPart *parts = m_data->parts.data();
-      ImageRegionPart *partsEnd = parts + m_data->nUsedParts;
-      for(ImageRegionPart *p=parts; p != partsEnd; ++p){
-        if(p->is_top()){
-          m_data->regionData.push_back(ImageRegionData::createInstance(&m_data->css,p,++nextID, crg, m_data->image));
-          m_data->regions.push_back(ImageRegion(m_data->regionData.back()));
+      // (re-)initialize the region data structures
+      const bool crg = getPropertyValue("create region graph") == "on";
+      std::vector<ImageRegionData*> &data = m_data->regionData;
+      while((int)data.size() < m_data->nRegions){
+        data.push_back(new ImageRegionData(&m_data->css,0,0,0,crg,m_data->image));
+      }
+      const ReinitRegions reinit = { data.data(), sizes.data(), values.data(), crg, m_data->image };
+      if(W*H < LABEL_PARALLEL_MIN_PIXELS){
+        reinit(0,m_data->nRegions);
+      }else{
+        parallel_for(0,m_data->nRegions,reinit);
+      }
+      
+      // copy the segments into their regions
+      for(int y=0;y<H;++y){
+        for(WorkingLineSegment *s=rle.begin(y); s != rle.end(y); ++s){
+          const int r = roots[s-base];
+          ImageRegionData *d = data[r];
+          d->segments[sizes[r]++] = *s;
+          s->ird = d;
         }
       }
+      
+      // restore the region and segment order of the region part join tree
+      std::vector<std::pair<int,int> > &tops = m_data->tops;
+      tops.resize(m_data->nRegions);
+      const JoinTreeOrder order = { data.data(), tops.data(), W };
+      if(W*H < LABEL_PARALLEL_MIN_PIXELS){
+        order(0,m_data->nRegions);
+      }else{
+        parallel_for(0,m_data->nRegions,order);
+      }
+      std::sort(tops.begin(),tops.end());
+      for(int r=0;r<m_data->nRegions;++r){
+        data[tops[r].second]->id = r;
+      }
+      
+      m_data->momentsValid = false;
+      if(getPropertyValue("accumulate moments") == "on"){
+        computeMoments();
+      }
+      
+      m_data->regions.reserve(m_data->nRegions);
+      for(int r=0;r<m_data->nRegions;++r){
+        m_data->regions.push_back(ImageRegion(data[tops[r].second]));
+      }
+    }
+    
+    void RegionDetector::computeMoments(){
+      //BENCHMARK_THIS_FUNCTION;
+      const int n = m_data->nRegions;
+      m_data->moments.resize(n);
+      const ComputeMoments compute = { m_data->regionData.data(), &m_data->moments };
+      if(m_data->roi.getDim() < LABEL_PARALLEL_MIN_PIXELS){
+        compute(0,n);
+      }else{
+        parallel_for(0,n,compute);
+      }
+      m_data->momentsValid = true;
+    }
+
+    const RegionMoments &RegionDetector::getRegionMoments(){
+      if(!m_data->momentsValid) computeMoments();
+      return m_data->moments;
     }
     
     void RegionDetector::linkRegions(){
@@ -372,19 +580,19 @@ namespace icl{
         setPropertyValue("track times.rle", msec_string_and_reset(t));
       }
   
-      // find all image region parts
-      analyseRegions();
+      // label connected line segments
+      labelRegions();
 
       if(trackTimes){
-        setPropertyValue("track times.analyse regions", msec_string_and_reset(t));
+        setPropertyValue("track times.label regions", msec_string_and_reset(t));
       }
 
   
-      // join parts and create image regions
-      joinRegions();
+      // create image regions from the labeled segments
+      createRegions();
 
       if(trackTimes){
-        setPropertyValue("track times.join regions", msec_string_and_reset(t));
+        setPropertyValue("track times.create regions", msec_string_and_reset(t));
       }
 
   
@@ -35,6 +35,7 @@
 #include <ICLUtils/Configurable.h>
 #include <ICLCore/ImgBase.h>
 #include <ICLCV/ImageRegion.h>
+#include <ICLCV/RegionMoments.h>
 
 #include <vector>
 
@@ -118,8 +119,9 @@ namespace icl{
         
         The Algorithm is split into 6 parts:
         -# run length encoding
-        -# region analysis (create region-parts)
-        -# region joining (collect sup-parts of top-level parts in order to obtain regions)
+        -# region labeling (join adjacent line segments using union-find)
+        -# region creation (collect the line segments of each set in order to obtain regions)
+        -# moment accumulation (optional) compute raw moments and bounding boxes of all regions
         -# region linking (only if a region graph is created) set up region neighbours 
         -# setting up border regions (only if a region graph is created)
         -# region filtering (filter regions by using given size and value constraint)
@@ -135,29 +137,44 @@ namespace icl{
         the first pixel value that is different from the current one) is accelerated by
         checking 4 next pixels at once.
         
-        \subsection RA Region Analysis
+        \subsection RA Region Labeling
         In this processing step, each 2 successive image lines (represented as sequences of
-        LineSegments) are processed. Internally, we used a utility structure called 
-        WorkingLineSegment for run length encoding. This utility class can also hold additinal
-        information which is a pointer to an ImageRegionPart in this step. If two
-        line segments A and B with identical values are adjacent (using 4-neighbourhood), 
-        they are both added to A's ImageRegionPart and B's ImageRegionPart is set to 
-        A's ImageRegionPart. Occasionally, A and B are already set up with an ImageRegionPart.
-        In this case, B's ImageRegionPart is added to A's ImageRegionPart and B's 
-        ImageRegionPart is set to be no longer on top level. Only top level ImageRegionParts
-        are transformed to complete image regions in the next step.\n
-        After this step, we have a set of ImageRegionParts. Some of this parts are still top
-        level, others are not and need to be added to their top-most ImageRegionPart.
-        
-        \subsection JO Region Joining
-        Here, a ImageRegion (stricly speaking ImageRegionData-structure) is created from 
-        each top level ImageRegionParts T. During the creation process, all  
-        WorkingLineSegments of T and all contained ImageRegionParts are collected recursively. 
-        Furthermore, the internally used WorkingLineSegments do no longer 
-        need information about their parent ImageRegionPart. Therefore, their data pointer 
-        is set to their parent ImageRegionData structure.\n
+        LineSegments) are processed. If two line segments A and B with identical values
+        are adjacent (using 4-neighbourhood), their sets are joined in a union-find
+        structure, that contains one entry per line segment. The union-find structure
+        always uses the set's first line segment (in scan-line order) as its root, so
+        the result does not depend on the order in which the sets were joined.\n
+        For larger images, the image rows are split into horizontal bands that are
+        labeled in parallel (each band only touches the union-find entries of its own
+        line segments). Afterwards, the seams between the bands are merged.
+        
+        \subsection JO Region Creation
+        Here, an ImageRegion (stricly speaking ImageRegionData-structure) is created for
+        each union-find set. The internally used WorkingLineSegments are linked to their
+        ImageRegionData.\n
+        Region IDs and the order of each region's line segments are the same as in the
+        former sequential algorithm, where each line segment either extended the region
+        part of its first adjacent line segment above or created a new region part, and
+        region parts that were found to be connected were adopted by the current segment's
+        part. Since this only depends on the line segments of a single region, the part
+        tree is replayed for each region independently (and in parallel for larger
+        images, see ImageRegionData::restoreJoinTreeOrder). Regions are then numbered in
+        creation order of their top level part and each region's line segments are
+        collected recursively from its top level part. Therefore, the results do not
+        depend on the number of threads used.
+        The ImageRegionData structures are not released after a detection run, but
+        they are re-used in the next run.\n
         After this step, we already have a set of all image regions.
         
+        \subsection MOMENTS Region Moments
+        Optionally (see setAccumulateMoments), the raw moments up to second order
+        and the bounding boxes of all regions are computed right after the regions were
+        created. Each region's moments are accumulated in closed form from its line
+        segments, and regions are processed in parallel. The results are stored as
+        a structure of arrays (see RegionMoments) that can be obtained using
+        getRegionMoments(), and ImageRegion's getSize(), getCOG(), getBoundingBox() and
+        getPCAInfo() become O(1) operations.
+        
         \subsection LINKING Region Linking
         If a region graph needs to be created, this step is used to detect which regions
         are adjacent. Again, we use the internal WorkingLineSegment representation. For 
@@ -199,6 +216,10 @@ namespace icl{
       
       /// set up the region-graph creation flag
       void setCreateGraph(bool on);
+
+      /// set up whether region moments are accumulated in the region creation step
+      /** see \ref MOMENTS */
+      void setAccumulateMoments(bool on);
   
       /// sets the internally used parameters for CSS-based corner detection
       /** The internal corner detector is used if ImageRegion::getBoundaryCorners is
@@ -219,18 +240,30 @@ namespace icl{
           it is outside the image rectangle), a null-region is returned. */
       const ImageRegion click(const utils::Point &pos);
       const std::vector<ImageRegion> & getLastDetectedRegions();
+
+      /// returns the moments and bounding boxes of all regions found in the last detect call
+      /** The returned structure is indexed by region ID and contains the features of all
+          regions, i.e. also of the ones that were filtered out by the size and value
+          constraints. If the moments were not accumulated in the last detect call
+          (see setAccumulateMoments), they are computed now. See \ref MOMENTS */
+      const RegionMoments &getRegionMoments();
+
       private:
       
       /// Internally used utility function that extracts the input images ROI if necessary
       void useImage(const core::ImgBase *image) throw (utils::ICLException);
       
-      /// creates region-parts 
+      /// labels connected line segments
       /** see \ref RA */
-      void analyseRegions();
+      void labelRegions();
   
-      /// combines ImageRegionParts
+      /// creates the image regions from the labeled line segments
       /** see \ref JO */
-      void joinRegions();
+      void createRegions();
+      
+      /// computes the moments of all regions
+      /** see \ref MOMENTS */
+      void computeMoments();
       
       /// detects region neighbours
       /** see \ref LINKING */
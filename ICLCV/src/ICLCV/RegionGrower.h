@@ -35,6 +35,7 @@
 #include <ICLCore/DataSegment.h>
 #include <ICLMath/HomogeneousMath.h>
 #include <ICLUtils/Exception.h>
+#include <ICLUtils/TaskScheduler.h>
 
 namespace icl{
   namespace cv{
@@ -42,6 +43,16 @@ namespace icl{
     /// class for region growing on images and DataSegments (e.g. poincloud xyzh)
     /** The RegionGrower class is designed as template applying a growing criterion to given input data.
         A mask defines the points for processing (e.g. a region of interest).
+
+        \section UF Union-Find based Region Growing
+        Besides the sequential flood fill, that is used by the generic apply methods,
+        applyUnionFind implements the region growing as parallel connected component
+        labeling: the image is split into horizontal strips that are labeled in parallel
+        using a union-find structure, the strips are merged afterwards. This is only
+        equivalent to the flood fill for symmetric criteria, which is why it is used by
+        applyEqualThreshold and applyFloat4EuclideanDistance only. Region IDs are assigned
+        in the same order as by the flood fill, but the pixel indices within the regions
+        are sorted in row-major order.
     */
 
     class RegionGrower{
@@ -120,7 +131,8 @@ namespace icl{
         */   
         const core::Img32s &applyFloat4EuclideanDistance(const core::DataSegment<float,4> &dataseg, core::Img8u mask, 
                             const int threshold, const unsigned int minSize=0, const unsigned int startID=1){
-          return apply(dataseg, Float4EuclideanDistance(threshold), &mask, minSize, startID);
+          Float4EuclideanDistanceIdx crit = { &dataseg, (float)threshold };
+          return applyUnionFind(dataseg.getSize(), crit, &mask, minSize, startID);
         }
   
         
@@ -134,7 +146,85 @@ namespace icl{
         */     
         const core::Img32s &applyEqualThreshold(const core::Img8u &image, core::Img8u mask, const int threshold, 
                             const unsigned int minSize=0, const unsigned int startID=1){
-          return apply(image, EqualThreshold(threshold), &mask, minSize, startID);
+          if(image.getChannels() != 1) throw utils::ICLException("wrong number of image channels");
+          EqualThresholdIdx crit = { image.begin(0), threshold };
+          return applyUnionFind(image.getSize(), crit, &mask, minSize, startID);
+        }
+
+        /// Applies a parallel union-find based region growing (see \ref UF)
+        /** @param size the image size
+            @param crit the growing criterion, which is called with pixel indices (x+y*width):
+                   crit(i,i) defines whether a region can be started at pixel i, two 8-connected
+                   pixels i and j belong to the same region if crit(i,j) and crit(j,i) are true.
+                   The criterion must be thread-safe.
+            @param initialMask the initial mask (pixels != 0 are not processed). As for the
+                   flood fill, the pixels of all resulting regions are set to 1.
+            @param minSize the minimum size of regions (smaller regions are removed)
+            @param startID the start id for the result label image
+            @return the result label image
+        */
+        template<class IndexCriterion>
+        const core::Img32s &applyUnionFind(const utils::Size &size, IndexCriterion crit, core::Img8u *initialMask = 0,
+                                           const unsigned int minSize=0, const unsigned int startID=1){
+          const int w = size.width, h = size.height, dim = w*h;
+          this->result.setChannels(1);
+          this->result.setSize(size);
+          this->result.clear();
+          regions.clear();
+          if(!dim) return this->result;
+
+          icl8u *m = (initialMask && initialMask->getDim() == dim && initialMask->getChannels()) ? initialMask->begin(0) : 0;
+          parent.resize(dim);
+          const int nThreads = utils::TaskScheduler::instance().getNumThreads();
+          const int rowsPerStrip = iclMax(16, (h + 4*nThreads - 1) / (4*nThreads));
+          const int nStrips = (h + rowsPerStrip - 1) / rowsPerStrip;
+          LabelStrips<IndexCriterion> f = { w, h, rowsPerStrip, m, parent.data(), &crit };
+          utils::parallel_for(0, nStrips, f, 1);
+
+          // merge the strip borders
+          int *par = parent.data();
+          for(int y=rowsPerStrip;y<h;y+=rowsPerStrip){
+            for(int x=0;x<w;++x){
+              const int i = x + y*w;
+              if(par[i] < 0) continue;
+              for(int dx=-1;dx<=1;++dx){
+                if(x+dx >= 0 && x+dx < w && f.connected(i,i-w+dx)) uf_union(par,i,i-w+dx);
+              }
+            }
+          }
+
+          // regions are numbered in the order of their first seed pixel (as for the flood fill)
+          component.assign(dim,-1);
+          rootSize.assign(dim,0);
+          std::vector<int> roots;
+          for(int i=0;i<dim;++i){
+            if(par[i] < 0) continue;
+            const int r = uf_find(par,i);
+            par[i] = r;
+            ++rootSize[r];
+            if(component[r] < 0 && crit(i,i)){
+              component[r] = roots.size();
+              roots.push_back(r);
+            }
+          }
+          std::vector<int> ids(roots.size(),0);
+          int nextID = startID;
+          for(unsigned int i=0;i<roots.size();++i){
+            if(rootSize[roots[i]] < (int)minSize) continue;
+            ids[i] = nextID++;
+            regions.push_back(std::vector<int>());
+            regions.back().reserve(rootSize[roots[i]]);
+          }
+          icl32s *res = this->result.begin(0);
+          for(int i=0;i<dim;++i){
+            if(par[i] < 0 || component[par[i]] < 0) continue;
+            const int id = ids[component[par[i]]];
+            if(!id) continue;
+            res[i] = id;
+            regions[id-startID].push_back(i);
+            if(m) m[i] = 1;
+          }
+          return this->result;
         }
   
   
@@ -151,6 +241,9 @@ namespace icl{
         core::Img8u mask;
         core::Img32s result;
         std::vector<std::vector<int> > regions;
+        std::vector<int> parent;    //!< union-find parent pixels (-1 for masked pixels)
+        std::vector<int> component; //!< component index of union-find root pixels
+        std::vector<int> rootSize;  //!< component size of union-find root pixels
       
         template<class T, class DataT, int DIM>
         struct RegionGrowerDataAccessor{
@@ -191,6 +284,86 @@ namespace icl{
         };
         
   
+        /// index based version of EqualThreshold (for applyUnionFind)
+        struct EqualThresholdIdx{
+          const icl8u *data;
+          int t;
+          bool operator()(int i, int j) const{
+            return (int)data[j] == t;
+          }
+        };
+
+        /// index based version of Float4EuclideanDistance (for applyUnionFind)
+        struct Float4EuclideanDistanceIdx{
+          const core::DataSegment<float,4> *data;
+          float t;
+          bool operator()(int i, int j) const{
+            return math::dist3((*data)[i],(*data)[j]) < t;
+          }
+        };
+
+        /// returns the root of the given union-find element
+        static inline int uf_find(int *parent, int i){
+          while(parent[i] != i){
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+          }
+          return i;
+        }
+
+        /// merges the sets of a and b (the smaller index becomes the root)
+        static inline void uf_union(int *parent, int a, int b){
+          a = uf_find(parent,a);
+          b = uf_find(parent,b);
+          if(a < b) parent[b] = a;
+          else if(b < a) parent[a] = b;
+        }
+
+        /// labels horizontal image strips independently (used with utils::parallel_for)
+        template<class IndexCriterion>
+        struct LabelStrips{
+          int w,h,rowsPerStrip;
+          const icl8u *mask;
+          int *parent;
+          const IndexCriterion *crit;
+
+          inline bool connected(int i, int j) const{
+            return parent[j] >= 0 && (*crit)(i,j) && (*crit)(j,i);
+          }
+
+          inline void link(int i, int j, bool &linked) const{
+            if(!connected(i,j)) return;
+            if(linked){
+              uf_union(parent,i,j);
+            }else{
+              parent[i] = uf_find(parent,j);
+              linked = true;
+            }
+          }
+
+          void operator()(int begin, int end) const{
+            for(int s=begin;s<end;++s){
+              const int y0 = s*rowsPerStrip, y1 = iclMin(h,y0+rowsPerStrip);
+              for(int i=y0*w;i<y1*w;++i){
+                parent[i] = (mask && mask[i]) ? -1 : i;
+              }
+              for(int y=y0;y<y1;++y){
+                for(int x=0;x<w;++x){
+                  const int i = x + y*w;
+                  if(parent[i] < 0) continue;
+                  // i is still a root here, so it is attached directly to its first neighbour
+                  bool linked = false;
+                  if(x > 0) link(i,i-1,linked);
+                  if(y == y0) continue;
+                  for(int dx=-1;dx<=1;++dx){
+                    if(x+dx >= 0 && x+dx < w) link(i,i-w+dx,linked);
+                  }
+                }
+              }
+            }
+          }
+        };
+
         template<class T, class DataT, int DIM, class Criterion>
         static void flood_fill(const RegionGrowerDataAccessor<T,DataT,DIM> &a, int xStart, int yStart, 
                                core::Channel8u &processed, Criterion crit, std::vector<int> &result,  core::Channel32s &result2, int id);
@@ -0,0 +1,110 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/RegionMoments.cpp                      **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/RegionMoments.h>
+
+#include <cmath>
+
+using namespace icl::utils;
+
+namespace icl{
+  namespace cv{
+
+    namespace{
+      /// returns sum(i=0..k) i
+      inline double sum_to(double k){
+        return k*(k+1)/2.0;
+      }
+      /// returns sum(i=0..k) i*i
+      inline double sum_of_squares_to(double k){
+        return k*(k+1)*(2*k+1)/6.0;
+      }
+    }
+    
+    void RegionMoments::resize(int n){
+      m00.resize(n);
+      m10.resize(n);
+      m01.resize(n);
+      m20.resize(n);
+      m11.resize(n);
+      m02.resize(n);
+      cogX.resize(n);
+      cogY.resize(n);
+      boundingBoxes.resize(n);
+    }
+    
+    void RegionMoments::compute(int idx, const LineSegment *begin, const LineSegment *end){
+      int n = 0, minX = begin->x, maxX = begin->xend;
+      double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+      for(const LineSegment *s = begin; s != end; ++s){
+        const int l = s->len();
+        const double y = s->y;
+        const double x = sum_to(s->xend-1) - sum_to(s->x-1);
+        n += l;
+        sx += x;
+        sy += l*y;
+        sxx += sum_of_squares_to(s->xend-1) - sum_of_squares_to(s->x-1);
+        sxy += y*x;
+        syy += l*y*y;
+        if(s->x < minX) minX = s->x;
+        if(s->xend > maxX) maxX = s->xend;
+      }
+      m00[idx] = n;
+      m10[idx] = sx;
+      m01[idx] = sy;
+      m20[idx] = sxx;
+      m11[idx] = sxy;
+      m02[idx] = syy;
+      cogX[idx] = sx/n;
+      cogY[idx] = sy/n;
+      // segments are sorted by y
+      boundingBoxes[idx] = Rect(minX,begin->y,maxX-minX,(end-1)->y-begin->y+1);
+    }
+    
+    RegionPCAInfo RegionMoments::getPCAInfo(int idx) const{
+      const double n = m00[idx];
+      return computePCAInfo(m10[idx]/n, m01[idx]/n, m20[idx]/n, m11[idx]/n, m02[idx]/n);
+    }
+    
+    RegionPCAInfo RegionMoments::computePCAInfo(double avgX, double avgY, double avgXX, double avgXY, double avgYY){
+      double fSxx = avgXX - avgX*avgX;
+      double fSyy = avgYY - avgY*avgY;
+      double fSxy = avgXY - avgX*avgY;
+      
+      double fP = 0.5*(fSxx+fSyy);
+      double fD = 0.5*(fSxx-fSyy);
+      fD = ::sqrt(fD*fD + fSxy*fSxy);
+      double fA  = fP + fD;
+      
+      return RegionPCAInfo(2*::sqrt(fP + fD),2*::sqrt(fP - fD),::atan2(fA-fSxx,fSxy),avgX,avgY);
+    }
+    
+  } // namespace cv
+}
@@ -0,0 +1,108 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/RegionMoments.h                        **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Rect.h>
+#include <ICLUtils/Point32f.h>
+#include <ICLCV/LineSegment.h>
+#include <ICLCV/RegionPCAInfo.h>
+
+#include <vector>
+
+namespace icl{
+  namespace cv{
+
+    /// Structure-of-arrays representation of the raw moments and bounding boxes of image regions \ingroup G_RD
+    /** The RegionDetector can be set up to accumulate the raw moments
+        \f$m_{pq} = \sum_{(x,y)\in R} x^p y^q\f$ (for \f$p+q \leq 2\f$) and
+        the bounding boxes of all regions while the regions are created
+        (see RegionDetector::setAccumulateMoments). In this case, the
+        ImageRegion functions getSize(), getCOG(), getBoundingBox() and
+        getPCAInfo() become O(1) operations.
+
+        All arrays are indexed by region ID (see ImageRegion::getID()) and
+        contain entries for all regions found in the last detection run (not only
+        for the ones that match the RegionDetector's size and value constraints).
+        This allows for filtering large sets of regions without having to touch
+        the individual ImageRegion instances, e.g.:
+        \code
+        const RegionMoments &m = rd.getRegionMoments();
+        for(int i=0;i<m.getRegionCount();++i){
+          if(m.m00[i] > 100 && m.cogY[i] < 240) ...
+        }
+        \endcode
+        
+        The moments are accumulated per line segment in closed form, so the
+        costs depend on the number of line segments rather than on the number of
+        pixels. The higher order moments are stored as doubles, which represent
+        them exactly as long as they stay below 2^53 (this holds for all common
+        image sizes).
+    */
+    struct ICLCV_API RegionMoments{
+      std::vector<int> m00;    //!< pixel count (zeroth order moment)
+      std::vector<double> m10; //!< sum of x-coordinates
+      std::vector<double> m01; //!< sum of y-coordinates
+      std::vector<double> m20; //!< sum of squared x-coordinates
+      std::vector<double> m11; //!< sum of x*y
+      std::vector<double> m02; //!< sum of squared y-coordinates
+
+      std::vector<float> cogX; //!< x-coordinate of the center of gravity (m10/m00)
+      std::vector<float> cogY; //!< y-coordinate of the center of gravity (m01/m00)
+
+      /// bounding boxes (using the same convention as ImageRegion::getBoundingBox())
+      std::vector<utils::Rect> boundingBoxes;
+
+      /// resizes all arrays to n entries
+      void resize(int n);
+
+      /// returns the number of regions
+      inline int getRegionCount() const { return (int)m00.size(); }
+
+      /// computes all entries for the region with given index from its line segments
+      /** The line segments need to be given in scan-line order */
+      void compute(int idx, const LineSegment *begin, const LineSegment *end);
+
+      /// returns the center of gravity of the region with given index
+      inline utils::Point32f getCOG(int idx) const{
+        return utils::Point32f(cogX[idx],cogY[idx]);
+      }
+
+      /// computes the spatial PCA information of the region with given index
+      RegionPCAInfo getPCAInfo(int idx) const;
+      
+      /// computes spatial PCA information from the given normalized moments
+      /** This is also used by ImageRegion::getPCAInfo() if no moments were accumulated */
+      static RegionPCAInfo computePCAInfo(double avgX, double avgY, double avgXX, double avgXY, double avgYY);
+    };
+    
+  } // namespace cv
+}
@@ -31,6 +31,7 @@
 
 #include <ICLCV/RunLengthEncoder.h>
 #include <ICLCV/RegionDetectorTools.h>
+#include <ICLUtils/TaskScheduler.h>
 
 
 
@@ -66,72 +67,91 @@ namespace icl{
       }
     }
     
-    template<class T>
-    void RunLengthEncoder::encode_internal(const Img<T> &image){
-      if(image.hasFullROI()){
-        // optimized version form images without ROI
-        const int W = image.getWidth();
-        const int H = image.getHeight();
-        
-        WLS *sldata = m_data.data(), *sls = 0;
-        
-        const T *p = image.begin(0);
-        const T *pEnd(0),*pLast(0),*pBegin(0);
-        T curr(0);
-        
-        for(int y=0;y<H;++y){
-          pBegin = p;    // pixel pointer to current image line begin
-          pEnd = p+W;    // pixel pointer to current image line end
-          curr = *p++;  
-          sls = sldata+y*W;
-          pLast = p-1;
-          while(true){//p<pEnd){
-            p = find_first_not(p,pEnd,curr);
-            sls->init((int)(pLast-pBegin), y,(int)(p-pBegin),curr); 
-            ++sls;
-            if(p == pEnd) break;
-            pLast = p;
-            curr = *p; 
+    namespace{
+      /// images with less pixels are encoded by the calling thread only
+      static const int RLE_PARALLEL_MIN_PIXELS = 1<<16;
+
+      /// encodes the rows [yBegin,yEnd) (relative to the image ROI)
+      /** Each row is encoded independently, so that disjoint row ranges can
+          be processed in parallel */
+      template<class T>
+      struct EncodeRows{
+        const Img<T> *image;
+        WorkingLineSegment *sldata;
+        WorkingLineSegment **ends;
+
+        void operator()(int yBegin, int yEnd) const{
+          if(image->hasFullROI()){
+            // optimized version form images without ROI
+            const int W = image->getWidth();
+
+            WorkingLineSegment *sls = 0;
+
+            const T *p = image->begin(0) + yBegin*W;
+            const T *pEnd(0),*pLast(0),*pBegin(0);
+            T curr(0);
+
+            for(int y=yBegin;y<yEnd;++y){
+              pBegin = p;    // pixel pointer to current image line begin
+              pEnd = p+W;    // pixel pointer to current image line end
+              curr = *p++;
+              sls = sldata+y*W;
+              pLast = p-1;
+              while(true){//p<pEnd){
+                p = find_first_not(p,pEnd,curr);
+                sls->init((int)(pLast-pBegin), y,(int)(p-pBegin),curr);
+                ++sls;
+                if(p == pEnd) break;
+                pLast = p;
+                curr = *p;
+              }
+              ends[y] = sls;
+            }
+          }else{
+            // ROI-version (slighly slower due to some overhead for roi-handling
+            // and shifting of scanlines)
+            const Rect &roi = image->getROI();
+
+            const int rx = roi.x;
+            const int ry = roi.y;
+            const int rw = roi.width;
+
+            WorkingLineSegment *sls = 0;
+
+            const T *p = image->getROIData(0) + yBegin*image->getWidth();
+            const T *pEnd(0),*pLast(0),*pBegin(0);
+            T curr(0);
+
+            const int xStep = image->getWidth()-rw;
+            for(int y=ry+yBegin;y<ry+yEnd;++y){
+              pBegin = p;    // pixel pointer to current image line begin
+              pEnd = p+rw;   // pixel pointer to current image line end
+              curr = *p++;
+              sls = sldata+rw*(y-ry);
+              pLast = p-1;
+              while(p<pEnd){
+                p = find_first_not(p,pEnd,curr);
+                sls->init(rx+(int)(pLast-pBegin), y,rx+(int)(p-pBegin),curr);
+                ++sls;
+                curr = *p;
+                pLast = p;
+              }
+              p += xStep;
+              ends[y-ry] = sls;
+            }
           }
-          m_ends[y] = sls;
         }
-  
-  
+      };
+    }
+
+    template<class T>
+    void RunLengthEncoder::encode_internal(const Img<T> &image){
+      const EncodeRows<T> rows = { &image, m_data.data(), m_ends.data() };
+      const int H = m_imageROI.height;
+      if(m_imageROI.getDim() < RLE_PARALLEL_MIN_PIXELS){
+        rows(0,H);
       }else{
-        
-        // ROI-version (slighly slower due to some overhead for roi-handling 
-        // and shifting of scanlines)
-        const Rect &roi = image.getROI();
-        
-        const int rx = roi.x;
-        const int ry = roi.y;
-        const int rw = roi.width;
-        const int rh = roi.height;
-        
-        WLS *sldata = m_data.data(), *sls = 0;
-        
-        const T *p = &*image.beginROI(0);
-        const T *pEnd(0),*pLast(0),*pBegin(0);
-        T curr(0);
-        
-        const int yEnd = ry+rh;
-        const int xStep = image.getWidth()-rw;
-        for(int y=ry;y<yEnd;++y){
-          pBegin = p;    // pixel pointer to current image line begin
-          pEnd = p+rw;   // pixel pointer to current image line end
-          curr = *p++;  
-          sls = sldata+rw*(y-ry);
-          pLast = p-1;
-          while(p<pEnd){
-            p = find_first_not(p,pEnd,curr);
-            sls->init(rx+(int)(pLast-pBegin), y,rx+(int)(p-pBegin),curr); 
-            ++sls;
-            curr = *p; 
-            pLast = p;
-          }
-          p += xStep;
-          m_ends[y-ry] = sls;
-        }
+        parallel_for(0,H,rows);
       }
     }
     
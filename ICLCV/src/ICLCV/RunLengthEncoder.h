@@ -73,6 +73,10 @@ namespace icl {
         As the used WorkingLineSegment class provides only an int-value parameter,
         the RunLengthEncoder is <b>not</b> able to process icl32f and icl64f images
   
+        \section PARALLEL Parallel Encoding
+        Image rows are encoded independently. For larger images, the rows are therefore
+        split into bands that are encoded in parallel using utils::parallel_for.
+  
         \section ROI ROI Support
         The RunLengthEncoder provides ROI support. The internal encoding function is implemented
         twice (with and without ROI handling) because handling of an images ROI entails a few
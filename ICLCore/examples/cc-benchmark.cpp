@@ -0,0 +1,145 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/examples/cc-benchmark.cpp                      **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCore/CCFunctions.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/CPUFeatures.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Time.h>
+#include <cmath>
+#include <cstdlib>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+
+template<class T>
+double max_diff(const Img<T> &a, const Img<T> &b){
+  double d = 0;
+  for(int c=0;c<a.getChannels();++c){
+    const T *pa = a.begin(c), *pb = b.begin(c);
+    for(int i=0;i<a.getDim();++i){
+      d = iclMax(d,std::fabs(double(pa[i]) - double(pb[i])));
+    }
+  }
+  return d;
+}
+
+double max_diff(const ImgBase *a, const ImgBase *b){
+  switch(a->getDepth()){
+#define ICL_INSTANTIATE_DEPTH(D) case depth##D: return max_diff(*a->asImg<icl##D>(),*b->asImg<icl##D>());
+    ICL_INSTANTIATE_ALL_DEPTHS;
+#undef ICL_INSTANTIATE_DEPTH
+  }
+  return 0;
+}
+
+// returns the throughput in megapixels per second
+double benchmark(const ImgBase *src, ImgBase *dst, int n){
+  cc(src,dst); // warm up
+  Time t = Time::now();
+  for(int i=0;i<n;++i){
+    cc(src,dst);
+  }
+  return (double(n)*src->getDim()) / t.age().toMicroSecondsDouble();
+}
+
+int main(int n, char **ppc){
+  pa_explain("-size","source image size")
+            ("-n","number of cc calls per measurement")
+            ("-threads","number of threads (0: ICL_NUM_THREADS or number of cores)")
+            ("-all-depths","measure all 25 depth combinations instead of 8u/32f only");
+  pa_init(n,ppc,"-size|-s(Size=VGA) -n(int=20) -threads|-t(int=0) -all-depths");
+
+  const Size size = pa("-size");
+  const int N = pa("-n");
+  TaskScheduler::setNumThreads(pa("-threads"));
+
+  std::cout << "image size: " << size << "  threads: " << TaskScheduler::instance().getNumThreads()
+            << "  AVX2 supported: " << (cpu_supports(cpuAVX2) ? "yes" : "no") << std::endl;
+
+  const format formats[] = { formatGray, formatRGB, formatHLS, formatYUV, formatLAB, formatChroma };
+  std::vector<depth> depths;
+  if(pa("-all-depths")){
+    for(int d=0;d<=depthLast;++d) depths.push_back((depth)d);
+  }else{
+    depths.push_back(depth8u);
+    depths.push_back(depth32f);
+  }
+
+  // random rgb image, that is converted into all source formats
+  Img8u rgb(size,formatRGB);
+  for(int c=0;c<3;++c){
+    for(icl8u *p=rgb.begin(c);p!=rgb.end(c);++p) *p = rand() % 256;
+  }
+
+  TextTable table;
+  table[0] = tok("conversion,depths,generic [MP/s],SSE2 [MP/s],auto [MP/s],speedup,max. diff",",");
+
+  for(int s=0;s<6;++s){
+    for(int d=0;d<6;++d){
+      if(s == d || cc_available(formats[s],formats[d]) != ccAvailable) continue;
+      for(unsigned int sd=0;sd<depths.size();++sd){
+        ImgBase *src = imgNew(depths[sd],size,formats[s]);
+        cc(&rgb,src);
+        for(unsigned int dd=0;dd<depths.size();++dd){
+          ImgBase *ref = imgNew(depths[dd],size,formats[d]);
+          ImgBase *dst = imgNew(depths[dd],size,formats[d]);
+
+          cc_set_simd_mode(ccSIMDOff);
+          const double tGeneric = benchmark(src,ref,N);
+          cc_set_simd_mode(ccSIMDSSE2);
+          const double tSSE2 = benchmark(src,dst,N);
+          double diff = max_diff(ref,dst);
+          cc_set_simd_mode(ccSIMDAuto);
+          const double tAuto = benchmark(src,dst,N);
+          diff = iclMax(diff,max_diff(ref,dst));
+
+          const int row = table.getSize().height;
+          table(0,row) = str(formats[s]).substr(6) + "->" + str(formats[d]).substr(6);
+          table(1,row) = str(depths[sd]).substr(5) + "->" + str(depths[dd]).substr(5);
+          table(2,row) = str(tGeneric);
+          table(3,row) = str(tSSE2);
+          table(4,row) = str(tAuto);
+          table(5,row) = str(tAuto/tGeneric);
+          table(6,row) = str(diff);
+
+          ICL_DELETE(ref);
+          ICL_DELETE(dst);
+        }
+        ICL_DELETE(src);
+      }
+    }
+  }
+  std::cout << table << std::endl;
+}
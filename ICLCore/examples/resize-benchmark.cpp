@@ -0,0 +1,104 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/examples/resize-benchmark.cpp                  **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCore/Img.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Time.h>
+#include <cstdlib>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+
+// returns the throughput in destination megapixels per second
+double benchmark(const ImgBase *src, ImgBase *dst, scalemode mode, int n){
+  src->scaledCopy(&dst,mode); // warm up (also creates the coordinate tables)
+  Time t = Time::now();
+  for(int i=0;i<n;++i){
+    src->scaledCopy(&dst,mode);
+  }
+  return (double(n)*dst->getDim()) / t.age().toMicroSecondsDouble();
+}
+
+int main(int n, char **ppc){
+  pa_explain("-size","source image size")
+            ("-n","number of scaledCopy calls per measurement")
+            ("-threads","number of threads for the parallel measurement (0: ICL_NUM_THREADS or number of cores)");
+  pa_init(n,ppc,"-size|-s(Size=HD720) -n(int=20) -threads|-t(int=0)");
+
+  const Size size = pa("-size");
+  const int N = pa("-n");
+  TaskScheduler::setNumThreads(pa("-threads"));
+  const int nThreads = TaskScheduler::instance().getNumThreads();
+
+  std::cout << "source size: " << size << "  threads: " << nThreads << std::endl;
+
+  const depth depths[] = { depth8u, depth16s, depth32f };
+  const scalemode modes[] = { interpolateLIN, interpolateRA };
+  const char *modeNames[] = { "LIN", "RA" };
+  const float factors[] = { 0.5f, 0.25f, 0.4f, 1.5f };
+
+  TextTable table;
+  table[0] = tok("depth,mode,dst size,1 thread [MP/s],parallel [MP/s],speedup",",");
+
+  for(int d=0;d<3;++d){
+    ImgBase *src = imgNew(depths[d],size,formatRGB);
+    Img8u rnd(size,formatRGB);
+    for(int c=0;c<3;++c){
+      for(icl8u *p=rnd.begin(c);p!=rnd.end(c);++p) *p = rand() % 256;
+    }
+    rnd.convert(src);
+    for(int m=0;m<2;++m){
+      for(int f=0;f<4;++f){
+        const Size dstSize(size.width*factors[f],size.height*factors[f]);
+        ImgBase *dst = imgNew(depths[d],dstSize,formatRGB);
+
+        TaskScheduler::setNumThreads(1);
+        const double t1 = benchmark(src,dst,modes[m],N);
+        TaskScheduler::setNumThreads(nThreads);
+        const double tN = benchmark(src,dst,modes[m],N);
+
+        const int row = table.getSize().height;
+        table(0,row) = str(depths[d]).substr(5);
+        table(1,row) = modeNames[m];
+        table(2,row) = str(dstSize);
+        table(3,row) = str(t1);
+        table(4,row) = str(tN);
+        table(5,row) = str(tN/t1);
+        ICL_DELETE(dst);
+      }
+    }
+    ICL_DELETE(src);
+  }
+  std::cout << table << std::endl;
+}
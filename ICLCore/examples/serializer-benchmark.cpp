@@ -0,0 +1,96 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/examples/serializer-benchmark.cpp              **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+#include <ICLCore/Img.h>
+#include <ICLCore/ImageSerializer.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Time.h>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+
+// returns the mean time per deserialization in milliseconds
+double benchmark(const icl8u *data, int size, bool shallow, int n){
+  // the block is owned by the caller
+  const SmartArray<icl8u> block(const_cast<icl8u*>(data),false);
+  ImgBase *dst = 0;
+  Time t = Time::now();
+  for(int i=0;i<n;++i){
+    if(shallow){
+      delete ImageSerializer::deserializeShallow(block,size);
+    }else{
+      ImageSerializer::deserialize(data,&dst);
+    }
+  }
+  const double ms = t.age().toMilliSecondsDouble() / n;
+  ICL_DELETE(dst);
+  return ms;
+}
+
+int main(int n, char **ppc){
+  pa_explain("-size","image size")
+            ("-n","number of deserialize calls per measurement");
+  pa_init(n,ppc,"-size|-s(Size=HD720) -n(int=100)");
+
+  const Size size = pa("-size");
+  const int N = pa("-n");
+
+  const depth depths[] = { depth8u, depth16s, depth32f, depth64f };
+
+  TextTable table;
+  table[0] = tok("depth,serialized size [MB],deep copy [ms],shallow [ms],saved per frame [ms]",",");
+
+  for(int d=0;d<4;++d){
+    ImgBase *src = imgNew(depths[d],size,formatRGB);
+    src->clear(-1,42);
+    src->setMetaData("frame meta data");
+
+    // the serialized image is placed such that the channel data behind the header are 8-byte aligned
+    std::vector<icl8u> buffer(ImageSerializer::estimateSerializedSize(src) + 8);
+    icl8u *data = buffer.data();
+    while((size_t)(data + ImageSerializer::getHeaderSize()) % 8) ++data;
+    ImageSerializer::serialize(src,data);
+
+    const int serializedSize = ImageSerializer::estimateSerializedSize(src);
+    const double tDeep = benchmark(data,serializedSize,false,N);
+    const double tShallow = benchmark(data,serializedSize,true,N);
+
+    const int row = table.getSize().height;
+    table(0,row) = str(depths[d]).substr(5);
+    table(1,row) = str(serializedSize/double(1<<20));
+    table(2,row) = str(tDeep);
+    table(3,row) = str(tShallow);
+    table(4,row) = str(tDeep-tShallow);
+    ICL_DELETE(src);
+  }
+  std::cout << "image size: " << size << std::endl << table << std::endl;
+}
@@ -33,7 +33,14 @@
 #include <ICLCore/Img.h>
 #include <map>
 #include <ICLCore/CCLUT.h>
+#include <ICLCore/CCFunctionsSIMD.h>
+#include <ICLCore/CCFunctionsSIMDImpl.h>
 #include <ICLUtils/SSEUtils.h>
+#include <ICLUtils/CPUFeatures.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Atomic.h>
+#include <cmath>
+#include <climits>
 
 using namespace icl::utils;
 
@@ -169,122 +176,70 @@ namespace icl{
   
     // }}}
     
+    /// scalar 'Ops' for the SIMD conversion kernels (see CCFunctionsSIMDImpl.h)
+    /** The generic RGB/YUV conversions apply the SIMD kernels with these scalar
+        operations. Therefore, they compute the same single precision operations in
+        the same order, and their results are bit-identical to the SSE2 and AVX2 code */
+    struct CCScalarOps{
+      typedef icl32f vf;
+      static const int NF = 1;
+
+      template<class T> static inline vf load(const T *p){ return (vf)*p; }
+
+      /// like cvtps2dq: round to nearest even, NaN and out of range values yield INT_MIN
+      static inline icl32s round(vf v){
+        return (v >= -2147483648.0f && v < 2147483648.0f) ? (icl32s)lrintf(v) : INT_MIN;
+      }
+      static inline void store(icl8u *p, vf v){ *p = (icl8u)utils::clip(round(v),0,255); }
+      static inline void store(icl16s *p, vf v){ *p = (icl16s)utils::clip(round(v),-32768,32767); }
+      static inline void store(icl32s *p, vf v){ *p = round(min(max(v,-2147483520.f),2147483520.f)); }
+      static inline void store(icl32f *p, vf v){ *p = v; }
+      static inline void store(icl64f *p, vf v){ *p = v; }
+
+      static inline vf set1(float f) { return f; }
+      static inline vf add(vf a, vf b) { return a+b; }
+      static inline vf sub(vf a, vf b) { return a-b; }
+      static inline vf mul(vf a, vf b) { return a*b; }
+      /// minps/maxps semantics: b is returned if a or b is NaN
+      static inline vf min(vf a, vf b) { return a < b ? a : b; }
+      static inline vf max(vf a, vf b) { return a > b ? a : b; }
+    };
+
+    /// applies a 3 to 3 channel SIMD kernel to a single pixel using CCScalarOps
+    template<class K, class S, class D>
+    inline void cc_apply_scalar_kernel(const S &a, const S &b, const S &c, D &x, D &y, D &z){
+      icl32f in[3] = { CCScalarOps::load(&a), CCScalarOps::load(&b), CCScalarOps::load(&c) };
+      icl32f out[3];
+      K::apply(in,out);
+      CCScalarOps::store(&x,out[0]);
+      CCScalarOps::store(&y,out[1]);
+      CCScalarOps::store(&z,out[2]);
+    }
+
+    /// converts a single rgb pixel to yuv using the same formula as cc (see SIMDRGBToYUV)
     void cc_util_rgb_to_yuv(const icl32s r, const icl32s g, const icl32s b, icl32s &y, icl32s &u, icl32s &v){
-      // {{{ integer open
-  #ifdef USE_RGB_TO_YUV_FULL_RANGE_UV
-      /// fixed point approximation of the the rgb2yuv version :
-      /** we no longer use this version due to compatibility issues with IPP based code */
-      y = ( 1254097*r + 2462056*g + 478151*b ) >> 22;  
-      u = ( 2366989*(b-y) + 534773760        ) >> 22;
-      v = ( 2991658*(r-y) + 534773760        ) >> 22;
-  #else
-      /// this is the way Intel IPP does rgb-to-yuv conversion
-      y = ( 1254097*r + 2462056*g + 478151*b ) >> 22;  
-      u = (2063598*(b-y) >> 22) + 128;
-      v = (3678405*(r-y) >> 22) + 128; 
-      if(v<0) v=0;
-      else if(v > 255) v = 255;
-  #endif
+      cc_apply_scalar_kernel<SIMDRGBToYUV<CCScalarOps> >(r,g,b,y,u,v);
     }
-    // }}}
 
     inline void cc_util_rgb_to_yuv_inline(const icl32s r, const icl32s g, const icl32s b, icl32s &y, icl32s &u, icl32s &v){
-      // {{{ integer open
-  #ifdef USE_RGB_TO_YUV_FULL_RANGE_UV
-      /// fixed point approximation of the the rgb2yuv version :
-      /** we no longer use this version due to compatibility issues with IPP based code */
-      y = ( 1254097*r + 2462056*g + 478151*b ) >> 22;  
-      u = ( 2366989*(b-y) + 534773760        ) >> 22;
-      v = ( 2991658*(r-y) + 534773760        ) >> 22;
-  #else
-      /// this is the way Intel IPP does rgb-to-yuv conversion
-      y = ( 1254097*r + 2462056*g + 478151*b ) >> 22;  
-      u = (2063598*(b-y) >> 22) + 128;
-      v = (3678405*(r-y) >> 22) + 128; 
-      if(v<0) v=0;
-      else if(v > 255) v = 255;
-  #endif
+      cc_apply_scalar_kernel<SIMDRGBToYUV<CCScalarOps> >(r,g,b,y,u,v);
     }
-    // }}}
 
     inline void cc_util_rgb_to_yuv(const icl32f r, const icl32f g, const icl32f b, icl32f &y, icl32f &u, icl32f &v){
-      /// this is the way Intel IPP does rgb-to-yuv conversion
-      y = 0.299f*r + 0.587f*g + 0.114*b;
-      u = 0.492f*(b-y) + 128.0f;
-      v = 0.877f*(r-y) + 128.0f; 
-      if(v < 0.0f) v = 0.0f;
-      else if(v > 255.0f) v = 255.0f;
+      cc_apply_scalar_kernel<SIMDRGBToYUV<CCScalarOps> >(r,g,b,y,u,v);
     }
 
+    /// converts a single yuv pixel to rgb using the same formula as cc (see SIMDYUVToRGB)
     void cc_util_yuv_to_rgb(const icl32s y,const icl32s u,const icl32s v, icl32s &r, icl32s &g, icl32s &b){
-      // {{{ open
-  #ifdef USE_RGB_TO_YUV_FULL_RANGE_UV
-      icl32s u2 = 14343*u - 1828717; 
-      icl32s v2 = 20231*v - 2579497; 
-      
-      r = y +  ( ( 290 * v2 ) >> 22 );
-      g = y -  ( ( 100  * u2 + 148 * v2) >> 22 );
-      b = y +  ( ( 518 * u2 ) >> 22 );
-  #else
-      // ipp compatible version (please note, due to the clipping process of 'v' in rgb_to_yuv,
-      // this method cannot restore an original rgb value completetly. Since we lost some information
-      // in v, the resulting r and g values are differ as follows: r-r' in [-32,35], and g-g' in [-17,18]
-      icl32s u2 = u-128;
-      icl32s v2 = v-128;
-      icl32s y2 = y<<22;
-      
-      r = (y2 + 4781506 * v2 ) >> 22;
-      g = (y2 - 1652556 * u2 - 2436891 *v2 ) >> 22;
-      b = (y2 + 8522826 * u2 ) >> 22;
-      
-      r = utils::clip(r,0,255);
-      g = utils::clip(g,0,255);
-      b = utils::clip(b,0,255);
-  #endif
-    } 
-    // }}}
+      cc_apply_scalar_kernel<SIMDYUVToRGB<CCScalarOps> >(y,u,v,r,g,b);
+    }
 
     inline void cc_util_yuv_to_rgb_inline(const icl32s y,const icl32s u,const icl32s v, icl32s &r, icl32s &g, icl32s &b){
-      // {{{ open
-  #ifdef USE_RGB_TO_YUV_FULL_RANGE_UV
-      icl32s u2 = 14343*u - 1828717; 
-      icl32s v2 = 20231*v - 2579497; 
-      
-      r = y +  ( ( 290 * v2 ) >> 22 );
-      g = y -  ( ( 100  * u2 + 148 * v2) >> 22 );
-      b = y +  ( ( 518 * u2 ) >> 22 );
-  #else
-      // ipp compatible version (please note, due to the clipping process of 'v' in rgb_to_yuv,
-      // this method cannot restore an original rgb value completetly. Since we lost some information
-      // in v, the resulting r and g values are differ as follows: r-r' in [-32,35], and g-g' in [-17,18]
-      icl32s u2 = u-128;
-      icl32s v2 = v-128;
-      icl32s y2 = y<<22;
-      
-      r = (y2 + 4781506 * v2 ) >> 22;
-      g = (y2 - 1652556 * u2 - 2436891 *v2 ) >> 22;
-      b = (y2 + 8522826 * u2 ) >> 22;
-      
-      r = utils::clip(r,0,255);
-      g = utils::clip(g,0,255);
-      b = utils::clip(b,0,255);
-  #endif
-    } 
-    // }}}
+      cc_apply_scalar_kernel<SIMDYUVToRGB<CCScalarOps> >(y,u,v,r,g,b);
+    }
 
     inline void cc_util_yuv_to_rgb(const icl32f y,const icl32f u,const icl32f v, icl32f &r, icl32f &g, icl32f &b){
-      // {{{ open
-      // ipp compatible version using 32f values
-      icl32f u2 = u-128.0f;
-      icl32f v2 = v-128.0f;
-      
-      r = (y + 1.140f * v2 );
-      g = (y - 0.394f * u2 - 0.581f * v2 );
-      b = (y + 2.032f * u2 );
-      
-      r = utils::clip(r,0.0f,255.0f);
-      g = utils::clip(g,0.0f,255.0f);
-      b = utils::clip(b,0.0f,255.0f);
+      cc_apply_scalar_kernel<SIMDYUVToRGB<CCScalarOps> >(y,u,v,r,g,b);
     }
 
     void cc_util_rgb_to_hls(const icl32f r255,const icl32f g255,const icl32f b255, icl32f &h, icl32f &l, icl32f &s){
@@ -684,22 +639,22 @@ namespace icl{
           ImgIterator<D> itCr = dst->beginROI(0);
           ImgIterator<D> itCg = dst->beginROI(1);
           const ImgIterator<S> itEnd = src->endROI(0);
-          register S sum;
+          register icl32f sum; // S might overflow
           for(; itR!= itEnd; ++itR,++itG,++itB,++itCr,++itCg){
             sum = *itR + *itG + *itB;
             sum += !sum; //avoid division by zero
-            *itCr = clipped_cast<S,D>((*itR * 255) / sum);
-            *itCg = clipped_cast<S,D>((*itG * 255) / sum);
+            *itCr = clipped_cast<icl32f,D>((*itR * 255) / sum);
+            *itCg = clipped_cast<icl32f,D>((*itG * 255) / sum);
           }
         } else {
           GET_3_CHANNEL_POINTERS_DIM(const S,src,r,g,b,dim);
           GET_2_CHANNEL_POINTERS_NODIM(D,dst,cromaR,cromaG);
-          register S sum;
+          register icl32f sum; // S might overflow
           for(int i=0;i<dim;++i){
             sum = r[i]+g[i]+b[i];
             sum+=!sum; //avoid division by zero
-            cromaR[i]=clipped_cast<S,D>((r[i]*255)/sum);
-            cromaG[i]=clipped_cast<S,D>((g[i]*255)/sum);
+            cromaR[i]=clipped_cast<icl32f,D>((r[i]*255)/sum);
+            cromaG[i]=clipped_cast<icl32f,D>((g[i]*255)/sum);
           }
         }
       }
@@ -718,28 +673,14 @@ namespace icl{
           ImgIterator<D> itU = dst->beginROI(1);
           ImgIterator<D> itV = dst->beginROI(2);
           const ImgIterator<D> itEnd = dst->endROI(0);
-          register icl32s reg_y, reg_u, reg_v;
           for(;itY!= itEnd;++itR,++itG,++itB,++itY, ++itU, ++itV){
-            cc_util_rgb_to_yuv_inline(clipped_cast<S,icl32s>(*itR),
-                                      clipped_cast<S,icl32s>(*itG),
-                                      clipped_cast<S,icl32s>(*itB),
-                                      reg_y, reg_u, reg_v);
-            *itY = clipped_cast<icl32s,D>(reg_y);
-            *itU = clipped_cast<icl32s,D>(reg_u);
-            *itV = clipped_cast<icl32s,D>(reg_v);
+            cc_apply_scalar_kernel<SIMDRGBToYUV<CCScalarOps> >(*itR,*itG,*itB,*itY,*itU,*itV);
           }
         }else{
           GET_3_CHANNEL_POINTERS_DIM(const S,src,r,g,b,dim);
           GET_3_CHANNEL_POINTERS_NODIM(D,dst,y,u,v);
-          register icl32s reg_y, reg_u, reg_v;
           for(int i=0;i<dim;++i){ 
-            cc_util_rgb_to_yuv_inline(clipped_cast<S,icl32s>(r[i]),
-                                      clipped_cast<S,icl32s>(g[i]),
-                                      clipped_cast<S,icl32s>(b[i]),
-                                      reg_y, reg_u, reg_v);
-            y[i] = clipped_cast<icl32s,D>(reg_y);
-            u[i] = clipped_cast<icl32s,D>(reg_u);
-            v[i] = clipped_cast<icl32s,D>(reg_v);
+            cc_apply_scalar_kernel<SIMDRGBToYUV<CCScalarOps> >(r[i],g[i],b[i],y[i],u[i],v[i]);
           }
         }
       }
@@ -1095,7 +1036,6 @@ namespace icl{
       // {{{ open
       static void convert(const Img<S> *src, Img<D> *dst, bool roiOnly){
         FUNCTION_LOG("");
-        register icl32s reg_r, reg_g, reg_b;
         if(roiOnly){
           const ImgIterator<S> itY = src->beginROI(0);
           const ImgIterator<S> itU = src->beginROI(1);
@@ -1105,25 +1045,13 @@ namespace icl{
           ImgIterator<D> itB = dst->beginROI(2);
           const ImgIterator<S> itEnd = src->endROI(0);
           for(;itY!= itEnd;++itY,++itU,++itV,++itR,++itG,++itB){
-            cc_util_yuv_to_rgb_inline(clipped_cast<S,icl32s>(*itY),
-                                      clipped_cast<S,icl32s>(*itU),
-                                      clipped_cast<S,icl32s>(*itV),
-                                      reg_r, reg_g, reg_b);
-            *itR = clipped_cast<icl32s,D>(reg_r);
-            *itG = clipped_cast<icl32s,D>(reg_g);
-            *itB = clipped_cast<icl32s,D>(reg_b);
+            cc_apply_scalar_kernel<SIMDYUVToRGB<CCScalarOps> >(*itY,*itU,*itV,*itR,*itG,*itB);
           }
         }else{
           GET_3_CHANNEL_POINTERS_DIM(const S,src,y,u,v,dim);
           GET_3_CHANNEL_POINTERS_NODIM(D,dst,r,g,b);
           for(int i=0;i<dim;++i){
-            cc_util_yuv_to_rgb_inline(clipped_cast<S,icl32s>(y[i]),
-                                      clipped_cast<S,icl32s>(u[i]),
-                                      clipped_cast<S,icl32s>(v[i]),
-                                      reg_r, reg_g, reg_b);
-            r[i] = clipped_cast<icl32s,D>(reg_r);
-            g[i] = clipped_cast<icl32s,D>(reg_g);
-            b[i] = clipped_cast<icl32s,D>(reg_b);
+            cc_apply_scalar_kernel<SIMDYUVToRGB<CCScalarOps> >(y[i],u[i],v[i],r[i],g[i],b[i]);
           }
         }
       }
@@ -1268,82 +1196,6 @@ namespace icl{
 
     // ++ for-loops ++ // 
 
-    template<class S, class D>
-    inline void sse_for_image_roi(const Img<S> *src, Img<D> *dst,
-                                  void (*subMethod)(const S*, D*, D*, D*),
-                                  void (*subSSEMethod)(const S*, D*, D*, D*),
-                                  long step = 16) {
-      int srcW = src->getWidth();
-      int dstW = dst->getWidth();
-
-      Point pROI;
-      Size sROI;
-      src->getROI(pROI, sROI);
-
-      long offset  = pROI.y * src->getWidth() + pROI.x;
-
-      const S *src0 = src->getData(0) + offset;
-
-      D *dst0      = dst->getData(0) + offset;
-      D *dst1      = dst->getData(1) + offset;
-      D *dst2      = dst->getData(2) + offset;
-      D *dstEnd    = dst0 + sROI.width + (sROI.height - 1) * dstW;
-
-      sse_for(src0, dst0, dst1, dst2, dstEnd,
-              srcW, dstW, sROI.width, subMethod, subSSEMethod, step, step);
-    }
-
-    template<class S, class D>
-    inline void sse_for_image_roi(const Img<S> *src, Img<D> *dst,
-                                  void (*subMethod)(const S*, const S*, const S*, D*),
-                                  void (*subSSEMethod)(const S*, const S*, const S*, D*),
-                                  long step = 16) {
-      int srcW = src->getWidth();
-      int dstW = dst->getWidth();
-
-      Point pROI;
-      Size sROI;
-      src->getROI(pROI, sROI);
-
-      long offset  = pROI.y * src->getWidth() + pROI.x;
-
-      const S *src0 = src->getData(0) + offset;
-      const S *src1 = src->getData(1) + offset;
-      const S *src2 = src->getData(2) + offset;
-
-      D *dst0   = dst->getData(0) + offset;
-      D *dstEnd = dst0 + sROI.width + (sROI.height - 1) * dstW;
-
-      sse_for(src0, src1, src2, dst0, dstEnd,
-              srcW, dstW, sROI.width, subMethod, subSSEMethod, step, step);
-    }
-
-    template<class S, class D>
-    inline void sse_for_image_roi(const Img<S> *src, Img<D> *dst,
-                                  void (*subMethod)(const S*, const S*, const S*, D*, D*),
-                                  void (*subSSEMethod)(const S*, const S*, const S*, D*, D*),
-                                  long step = 16) {
-      int srcW = src->getWidth();
-      int dstW = dst->getWidth();
-
-      Point pROI;
-      Size sROI;
-      src->getROI(pROI, sROI);
-
-      long offset  = pROI.y * src->getWidth() + pROI.x;
-
-      const S *src0 = src->getData(0) + offset;
-      const S *src1 = src->getData(1) + offset;
-      const S *src2 = src->getData(2) + offset;
-
-      D *dst0   = dst->getData(0) + offset;
-      D *dst1   = dst->getData(1) + offset;
-      D *dstEnd = dst0 + sROI.width + (sROI.height - 1) * dstW;
-
-      sse_for(src0, src1, src2, dst0, dst1, dstEnd,
-              srcW, dstW, sROI.width, subMethod, subSSEMethod, step, step);
-    }
-
     template<class S, class D>
     inline void sse_for_image_roi(const Img<S> *src, Img<D> *dst,
                                   void (*subMethod)(const S*, const S*, const S*, D*, D*, D*),
@@ -1356,67 +1208,22 @@ namespace icl{
       Size sROI;
       src->getROI(pROI, sROI);
 
-      long offset  = pROI.y * src->getWidth() + pROI.x;
+      long offset    = pROI.y * srcW + pROI.x;
+      long dstOffset = dst->getROIYOffset() * dstW + dst->getROIXOffset();
 
       const S *src0 = src->getData(0) + offset;
       const S *src1 = src->getData(1) + offset;
       const S *src2 = src->getData(2) + offset;
 
-      D *dst0   = dst->getData(0) + offset;
-      D *dst1   = dst->getData(1) + offset;
-      D *dst2   = dst->getData(2) + offset;
+      D *dst0   = dst->getData(0) + dstOffset;
+      D *dst1   = dst->getData(1) + dstOffset;
+      D *dst2   = dst->getData(2) + dstOffset;
       D *dstEnd = dst0 + sROI.width + (sROI.height - 1) * dstW;
 
       sse_for(src0, src1, src2, dst0, dst1, dst2, dstEnd,
               srcW, dstW, sROI.width, subMethod, subSSEMethod, step, step);
     }
 
-    template<class S, class D>
-    inline void sse_for_image(const Img<S> *src, Img<D> *dst,
-                              void (*subMethod)(const S*, D*, D*, D*),
-                              void (*subSSEMethod)(const S*, D*, D*, D*),
-                              long step = 16) {
-      const S *src0 = src->getData(0);
-
-      D *dst0      = dst->getData(0);
-      D *dst1      = dst->getData(1);
-      D *dst2      = dst->getData(2);
-      D *dstEnd    = dst0 + dst->getDim();
-
-      sse_for(src0, dst0, dst1, dst2, dstEnd, subMethod, subSSEMethod, step, step);
-    }
-
-    template<class S, class D>
-    inline void sse_for_image(const Img<S> *src, Img<D> *dst,
-                              void (*subMethod)(const S*, const S*, const S*, D*),
-                              void (*subSSEMethod)(const S*, const S*, const S*, D*),
-                              long step = 16) {
-      const S *src0 = src->getData(0);
-      const S *src1 = src->getData(1);
-      const S *src2 = src->getData(2);
-
-      D *dst0   = dst->getData(0);
-      D *dstEnd = dst0 + dst->getDim();
-
-      sse_for(src0, src1, src2, dst0, dstEnd, subMethod, subSSEMethod, step, step);
-    }
-
-    template<class S, class D>
-    inline void sse_for_image(const Img<S> *src, Img<D> *dst,
-                              void (*subMethod)(const S*, const S*, const S*, D*, D*),
-                              void (*subSSEMethod)(const S*, const S*, const S*, D*, D*),
-                              long step = 16) {
-      const S *src0 = src->getData(0);
-      const S *src1 = src->getData(1);
-      const S *src2 = src->getData(2);
-
-      D *dst0      = dst->getData(0);
-      D *dst1      = dst->getData(1);
-      D *dstEnd    = dst0 + dst->getDim();
-
-      sse_for(src0, src1, src2, dst0, dst1, dstEnd, subMethod, subSSEMethod, step, step);
-    }
-
     template<class S, class D>
     inline void sse_for_image(const Img<S> *src, Img<D> *dst,
                               void (*subMethod)(const S*, const S*, const S*, D*, D*, D*),
@@ -1450,999 +1257,145 @@ namespace icl{
       };
 
 
-    // ++ Gray to RGB ++ //
+    // ++ HLS to YUV ++ //
 
     template<class S, class D>
-    inline void subGraytoRGB(const S *gr, D *r, D *g, D *b) {
-      *r = *g = *b = clipped_cast<S,D>(*gr);
-    }
-
-    inline void subSSEGraytoRGB(const icl8u *gr, icl8u *r, icl8u *g, icl8u *b) {
-      // load gray values
-      icl8ux16 vGr = icl8ux16(gr);
-
-      // store the 'calculated' values
-      vGr.storeu(r);
-      vGr.storeu(g);
-      vGr.storeu(b);
-    }
-
-    inline void subSSEGraytoRGB(const icl8u *gr, icl32f *r, icl32f *g, icl32f *b) {
-      // load gray values
-      icl512 vGr = icl512(gr);
-
-      // store the 'calculated' values
-      vGr.storeu(r);
-      vGr.storeu(g);
-      vGr.storeu(b);
+    inline void subHLStoYUV(const S *h, const S *l, const S *s, D *y, D *u, D *v) {
+      register icl32f reg_r(0), reg_g(0), reg_b(0);
+      register icl32f reg_y, reg_u, reg_v;
+      cc_util_hls_to_rgb_inline(clipped_cast<S,icl32f>(*h),
+                                clipped_cast<S,icl32f>(*l),
+                                clipped_cast<S,icl32f>(*s),
+                                reg_r,reg_g,reg_b);
+      cc_util_rgb_to_yuv(reg_r, reg_g, reg_b,
+                         reg_y, reg_u, reg_v);
+      *y = clipped_cast<icl32f,D>(reg_y);
+      *u = clipped_cast<icl32f,D>(reg_u);
+      *v = clipped_cast<icl32f,D>(reg_v);
     }
 
-    inline void subSSEGraytoRGB(const icl32f *gr, icl8u *r, icl8u *g, icl8u *b) {
-      // load gray values
-      icl512 vGr = icl512(gr);
-
-      // store the 'calculated' values
-      vGr.storeu(r);
-      vGr.storeu(g);
-      vGr.storeu(b);
+    template<class S>
+    inline void subHLStoYUV(const S *h, const S *l, const S *s, icl8u *y, icl8u *u, icl8u *v) {
+      register icl32f reg_r(0), reg_g(0), reg_b(0);
+      register icl32f reg_y, reg_u, reg_v;
+      cc_util_hls_to_rgb_inline(clipped_cast<S,icl32f>(*h),
+                                clipped_cast<S,icl32f>(*l),
+                                clipped_cast<S,icl32f>(*s),
+                                reg_r,reg_g,reg_b);
+      cc_util_rgb_to_yuv(reg_r, reg_g, reg_b,
+                         reg_y, reg_u, reg_v);
+      *y = clipped_cast<icl32f,icl8u>(reg_y + 0.5f);
+      *u = clipped_cast<icl32f,icl8u>(reg_u + 0.5f);
+      *v = clipped_cast<icl32f,icl8u>(reg_v + 0.5f);
     }
 
-    inline void subSSEGraytoRGB(const icl32f *gr, icl32f *r, icl32f *g, icl32f *b) {
-      // load gray values
-      icl128 vGr = icl128(gr);
-
-      // store the 'calculated' values
-      vGr.storeu(r);
-      vGr.storeu(g);
-      vGr.storeu(b);
-    }
+    template<class S, class D>
+    inline void subSSEHLStoYUV(const S *h, const S *l, const S *s, D *y, D *u, D *v) {
+      // load HLS values
+      icl512 vH = icl512(h);
+      icl512 vL = icl512(l);
+      icl512 vS = icl512(s);
 
-    USE_SSE_CONVERT(icl8u,icl8u,Gray,RGB,subGraytoRGB,subSSEGraytoRGB,16)
-    USE_SSE_CONVERT(icl8u,icl32f,Gray,RGB,subGraytoRGB,subSSEGraytoRGB,16)
-    USE_SSE_CONVERT(icl32f,icl8u,Gray,RGB,subGraytoRGB,subSSEGraytoRGB,16)
-    USE_SSE_CONVERT(icl32f,icl32f,Gray,RGB,subGraytoRGB,subSSEGraytoRGB,4)
+      vH *= icl512(6.0f/255.0f);
+      vL *= icl512(1.0f/255.0f);
+      vS *= icl512(1.0f/255.0f);
 
-    // -- Gray to RGB -- //
+      icl512 vSL  = vL * vS;
+      icl512 vLSL = vL + vS - vSL;
+      icl512 vV = sse_ifelse(vL <= icl512(0.5f), vL + vSL, vLSL);
 
+      icl512 vM = vL + vL - vV;
+      icl512 vSV = (vV - vM) * icl512(vV).rcp();
+      icl512 vST = icl512i32s(_mm_cvttps_epi32(vH.v0), _mm_cvttps_epi32(vH.v1),
+                              _mm_cvttps_epi32(vH.v2), _mm_cvttps_epi32(vH.v3));
+      icl512 vF = vH - vST;
+      icl512 vVSF = vV * vSV * vF;
+      icl512 vMid1 = vM + vVSF;
+      icl512 vMid2 = vV - vVSF;
 
-    // ++ RBG to Gray ++ ///
+      icl512 vIf0 = (vV  > icl512(0.0f));
+      icl512 vIf1 = (vST < icl512(1.0f));
+      icl512 vIf2 = (vST < icl512(2.0f));
+      icl512 vIf3 = (vST < icl512(3.0f));
+      icl512 vIf4 = (vST < icl512(4.0f));
+      icl512 vIf5 = (vST < icl512(5.0f));
+      icl512 vIf6 = (vST < icl512(6.0f));
 
-    template<class S, class D>
-    inline void subRGBtoGray(const S *r, const S *g, const S *b, D *gr) {
-      *gr = clipped_cast<S,D>((*r + *g + *b)/3.0f + 0.5f);
-    }
+      icl512 vR = vV;
+      vR = sse_ifelse(vIf1, vR, vMid2);
+      vR = sse_ifelse(vIf2, vR, vM);
+      vR = sse_ifelse(vIf4, vR, vMid1);
+      vR = sse_ifelse(vIf5, vR, vV);
+      vR = sse_if(vIf0, vR);
 
-    inline void subSSERGBtoGray(const icl8u *r, const icl8u *g, const icl8u *b, icl8u *gr) {
-      icl16sx16 vR = icl8ux16(r);
-      icl16sx16 vG = icl8ux16(g);
-      icl16sx16 vB = icl8ux16(b);
+      icl512 vG = vMid1;
+      vG = sse_ifelse(vIf1, vG, vV);
+      vG = sse_ifelse(vIf3, vG, vMid2);
+      vG = sse_ifelse(vIf4, vG, vM);
+      vG = sse_ifelse(vIf6, vG, vMid1);
+      vG = sse_if(vIf0, vG);
 
-      vR += vB;
-      vR += vG;
+      icl512 vB = vM;
+      vB = sse_ifelse(vIf2, vB, vMid1);
+      vB = sse_ifelse(vIf3, vB, vV);
+      vB = sse_ifelse(vIf5, vB, vMid2);
+      vB = sse_ifelse(vIf6, vB, vM);
+      vB = sse_if(vIf0, vB);
 
-      icl512 vRes = icl512i32s(vR);
+      vR *= icl512(255.0f);
+      vG *= icl512(255.0f);
+      vB *= icl512(255.0f);
 
-      vRes *= icl512(1.0f/3.0f);
-      vRes.storeu(gr);
-    }
+      // calculate Y values
+      icl512 vY(icl512(0.299f) * vR);
+      vY += icl512(0.587f) * vG;
+      vY += icl512(0.114f) * vB;
 
-    inline void subSSERGBtoGray(const icl8u *r, const icl8u *g, const icl8u *b, icl32f *gr) {
-      icl16sx16 vR = icl8ux16(r);
-      icl16sx16 vG = icl8ux16(g);
-      icl16sx16 vB = icl8ux16(b);
+      // calculate U values
+      vB -= vY;
+      icl512 vU = icl512(0.492f) * vB;
+      vU += icl512(128.0f);
 
-      vR += vB;
-      vR += vG;
+      // calculate V values
+      vR -= vY;
+      icl512 vVV = icl512(0.877f) * vR;
+      vVV += icl512(128.0f);
 
-      icl512 vRes = icl512i32s(vR);
+      // saturate values
+      vU = max(vU, icl512(0.0f));
+      vU = min(vU, icl512(255.0f));
+      vVV = max(vVV, icl512(0.0f));
+      vVV = min(vVV, icl512(255.0f));
 
-      vRes *= icl512(1.0f/3.0f);
-      vRes.storeu(gr);
+      // store the calculated values
+      vY.storeu(y);
+      vU.storeu(u);
+      vVV.storeu(v);
     }
 
-    inline void subSSERGBtoGray(const icl32f *r, const icl32f *g, const icl32f *b, icl8u *gr) {
-      icl512 vR(r);
-      icl512 vG(g);
-      icl512 vB(b);
+    template<class S>
+    inline void subSSEHLStoYUV(const S *h, const S *l, const S *s, icl8u *y, icl8u *u, icl8u *v) {
+      // load HLS values
+      icl512 vH = icl512(h);
+      icl512 vL = icl512(l);
+      icl512 vS = icl512(s);
 
-      vR += vB;
-      vR += vG;
-      vR *= icl512(1.0f/3.0f);
+      vH *= icl512(6.0f/255.0f);
+      vL *= icl512(1.0f/255.0f);
+      vS *= icl512(1.0f/255.0f);
 
-      vR.storeu(gr);
-    }
+      icl512 vSL  = vL * vS;
+      icl512 vLSL = vL + vS - vSL;
+      icl512 vV = sse_ifelse(vL <= icl512(0.5f), vL + vSL, vLSL);
 
-    inline void subSSERGBtoGray(const icl32f *r, const icl32f *g, const icl32f *b, icl32f *gr) {
-      icl128 vR(r);
-      icl128 vG(g);
-      icl128 vB(b);
-
-      vR += vB;
-      vR += vG;
-      vR *= icl128(1.0f/3.0f);
-
-      vR.storeu(gr);
-    }
-
-    template<> struct CCFunc<icl8u,icl8u,formatRGB,formatGray>{
-      static void convert(const Img<icl8u> *src, Img<icl8u> *dst, bool roiOnly){
-        FUNCTION_LOG("");
-        if(roiOnly){
-          sse_for_image_roi(src, dst, subRGBtoGray, subSSERGBtoGray);
-        }else{
-          GET_3_CHANNEL_POINTERS_DIM(const icl8u,src,r,g,b,dim);
-          icl8u *gr = dst->getData(0);
-
-          // convert the channels to vector channels
-          __m128i *cR  = (__m128i*)r;
-          __m128i *cG  = (__m128i*)g;
-          __m128i *cB  = (__m128i*)b;
-          __m128i *cGr = (__m128i*)gr;
-
-          int i = 0;
-
-          // convert 16 values at the same time
-          for(; i<dim-15; i+=16, cR++, cG++, cB++, cGr++){
-            icl16sx16 vR = icl8ux16(cR);
-            icl16sx16 vG = icl8ux16(cG);
-            icl16sx16 vB = icl8ux16(cB);
-
-            vR += vB;
-            vR += vG;
-
-            icl512 vTmp = icl512i32s(vR);
-
-            vTmp *= icl512(1.0f/3.0f);
-
-            icl8ux16 vRes = icl512i32s(vTmp);
-            vRes.storeu(cGr);
-          }
-
-          // convert the last values (one by one)
-          for(; i<dim; ++i){
-            gr[i] = clipped_cast<icl8u,icl8u>((r[i]+g[i]+b[i])/3);
-          }
-        }
-      }
-    };
-
-    template<> struct CCFunc<icl8u,icl32f,formatRGB,formatGray>{
-      static void convert(const Img<icl8u> *src, Img<icl32f> *dst, bool roiOnly){
-        FUNCTION_LOG("");
-        if(roiOnly){
-          sse_for_image_roi(src, dst, subRGBtoGray, subSSERGBtoGray);
-        }else{
-          GET_3_CHANNEL_POINTERS_DIM(const icl8u,src,r,g,b,dim);
-          icl32f *gr = dst->getData(0);
-
-          // convert the channels to  vector channels
-          __m128i *cR = (__m128i*)r;
-          __m128i *cG = (__m128i*)g;
-          __m128i *cB = (__m128i*)b;
-
-          int i = 0;
-
-          // convert 16 values at the same time
-          for(; i<dim-15; i+=16, ++cR, ++cG, ++cB){
-            icl16sx16 vR = icl8ux16(cR);
-            icl16sx16 vG = icl8ux16(cG);
-            icl16sx16 vB = icl8ux16(cB);
-
-            vR += vB;
-            vR += vG;
-
-            icl512 vRes = icl512i32s(vR);
-
-            vRes *= icl512(1.0f/3.0f);
-            vRes.storeu(&gr[i]);
-          }
-
-          // convert the last values (one by one)
-          for(; i<dim; ++i){
-            gr[i] = clipped_cast<icl8u,icl32f>((r[i]+g[i]+b[i])/3.0f);
-          }
-        }
-      }
-    };
-
-    USE_SSE_CONVERT(icl32f,icl8u,RGB,Gray,subRGBtoGray,subSSERGBtoGray,16)
-    USE_SSE_CONVERT(icl32f,icl32f,RGB,Gray,subRGBtoGray,subSSERGBtoGray,4)
-
-    // -- RBG to Gray -- //
-
-
-    // ++ RBG to HLS ++ //
-
-    template<class S, class D>
-    inline void subRGBtoHLS(const S *r, const S *g, const S *b, D *h, D *l, D *s) {
-      register icl32f reg_h, reg_l, reg_s;
-      cc_util_rgb_to_hls(clipped_cast<S,icl32f>(*r),
-                         clipped_cast<S,icl32f>(*g),
-                         clipped_cast<S,icl32f>(*b),
-                         reg_h,reg_l,reg_s);
-      *h = clipped_cast<icl32f,D>(reg_h);
-      *l = clipped_cast<icl32f,D>(reg_l);
-      *s = clipped_cast<icl32f,D>(reg_s);
-    }
-
-    template<class S>
-    inline void subRGBtoHLS(const S *r, const S *g, const S *b, icl8u *h, icl8u *l, icl8u *s) {
-      register icl32f reg_h, reg_l, reg_s;
-      cc_util_rgb_to_hls_inline(clipped_cast<S,icl32f>(*r),
-                                clipped_cast<S,icl32f>(*g),
-                                clipped_cast<S,icl32f>(*b),
-                                reg_h,reg_l,reg_s);
-      *h = clipped_cast<icl32f,icl8u>(reg_h + 0.5f);
-      *l = clipped_cast<icl32f,icl8u>(reg_l + 0.5f);
-      *s = clipped_cast<icl32f,icl8u>(reg_s + 0.5f);
-    }
-
-    template<class S, class D>
-    inline void subSSERGBtoHLS(const S *r, const S *g, const S *b,
-                               D *h, D *l, D *s) {
-      // load RGB values
-      icl512 vR = icl512(r);
-      icl512 vG = icl512(g);
-      icl512 vB = icl512(b);
-
-      // change the range to 0..1
-      vR *= icl512(1.0f/255.0f);
-      vG *= icl512(1.0f/255.0f);
-      vB *= icl512(1.0f/255.0f);
-
-      icl512 vMax = max(max(vR, vG), vB);
-      icl512 vMin = min(min(vR, vG), vB);
-      icl512 vMpM  = vMax + vMin;
-      icl512 vMmM  = vMax - vMin;
-
-      // calculate lightness
-      icl512 vL = vMpM * icl512(0.5f);
-
-      // calculate saturation
-
-      icl512 vIf0 = (vL > icl512(0.5f));
-      icl512 vIf1 = (vMin != vMax);
-
-      icl512 vS = ((vMmM * (icl512(2.0f) - vMpM).rcp()) & vIf0);
-      icl512 vS1 = andnot(vMmM * vMpM.rcp(), vIf0);
-
-      vS += vS1;
-      vS &= vIf1;
-      vS &= (vL != icl512(0.0f));
-
-
-      // calculate hue
-
-      vMmM.rcp();
-
-      icl512 vIf00 = (vR == vMax);
-      icl512 vIf01 = andnot(vG == vMax, vIf00);
-      icl512 vIf02 = andnot(andnot(vB == vMax, vIf01), vIf00);
-
-      icl512 vH = (((vG - vB) * vMmM) & vIf00);
-      vH += ((icl512(2.0f) + ((vB - vR) * vMmM)) & vIf01);
-      vH += ((icl512(4.0f) + ((vR - vG) * vMmM)) & vIf02);
-      vH *= icl512(60.0f);
-
-      icl512 vIf10 = (vH < icl512(0.0f));
-      vH += (icl512(360.0f) & vIf10);
-
-
-      // TODO: maybe this is not important?
-      vH &= (vL != icl512(0.0f));
-      vH &= vIf1;
-
-      // change the range of the calculated values to 0..255
-      vH *= icl512(255.0f/360.0f);
-      vL *= icl512(255.0f);
-      vS *= icl512(255.0f);
-
-      // store the calculated values
-      vH.storeu(h);
-      vL.storeu(l);
-      vS.storeu(s);
-    }
-
-    template<>
-    inline void subSSERGBtoHLS(const icl32f *r, const icl32f *g, const icl32f *b,
-                               icl32f *h, icl32f *l, icl32f *s) {
-      // load RGB values
-      icl128 vR = icl128(r);
-      icl128 vG = icl128(g);
-      icl128 vB = icl128(b);
-
-      // change the range to 0..1
-      vR *= icl128(1.0f/255.0f);
-      vG *= icl128(1.0f/255.0f);
-      vB *= icl128(1.0f/255.0f);
-
-      icl128 vMax = max(max(vR, vG), vB);
-      icl128 vMin = min(min(vR, vG), vB);
-      icl128 vMpM  = vMax + vMin;
-      icl128 vMmM  = vMax - vMin;
-
-      // calculate lightness
-      icl128 vL = vMpM * icl128(0.5f);
-
-      // calculate saturation
-
-      icl128 vIf0 = (vL > icl128(0.5f));
-      icl128 vIf1 = (vMin != vMax);
-
-      icl128 vS = ((vMmM * (icl128(2.0f) - vMpM).rcp()) & vIf0);
-      icl128 vS1 = andnot(vMmM * vMpM.rcp(), vIf0);
-
-      vS += vS1;
-      vS &= vIf1;
-      vS &= (vL != icl128(0.0f));
-
-
-      // calculate hue
-
-      vMmM.rcp();
-
-      icl128 vIf00 = (vR == vMax);
-      icl128 vIf01 = andnot(vG == vMax, vIf00);
-      icl128 vIf02 = andnot(andnot(vB == vMax, vIf01), vIf00);
-
-      icl128 vH = (((vG - vB) * vMmM) & vIf00);
-      vH += ((icl128(2.0f) + ((vB - vR) * vMmM)) & vIf01);
-      vH += ((icl128(4.0f) + ((vR - vG) * vMmM)) & vIf02);
-      vH *= icl128(60.0f);
-
-      icl128 vIf10 = (vH < icl128(0.0f));
-      vH += (icl128(360.0f) & vIf10);
-
-
-      // TODO: maybe this is not important?
-      vH &= (vL != icl128(0.0f));
-      vH &= vIf1;
-
-      // change the range of the calculated values to 0..255
-      vH *= icl128(255.0f/360.0f);
-      vL *= icl128(255.0f);
-      vS *= icl128(255.0f);
-
-      // store the calculated values
-      vH.storeu(h);
-      vL.storeu(l);
-      vS.storeu(s);
-    }
-
-    USE_SSE_CONVERT(icl8u,icl8u,RGB,HLS,subRGBtoHLS,subSSERGBtoHLS,16)
-    USE_SSE_CONVERT(icl8u,icl32f,RGB,HLS,subRGBtoHLS,subSSERGBtoHLS,16)
-    USE_SSE_CONVERT(icl32f,icl8u,RGB,HLS,subRGBtoHLS,subSSERGBtoHLS,16)
-    USE_SSE_CONVERT(icl32f,icl32f,RGB,HLS,subRGBtoHLS,subSSERGBtoHLS,4)
-
-    // -- RBG to HLS -- //
-
-
-    // ++ RBG to YUV ++ //
-
-    template<class S, class D>
-    inline void subRGBtoYUV(const S *r, const S *g, const S *b, D *y, D *u, D *v) {
-      register icl32f reg_y, reg_u, reg_v;
-      cc_util_rgb_to_yuv(clipped_cast<S,icl32f>(*r),
-                         clipped_cast<S,icl32f>(*g),
-                         clipped_cast<S,icl32f>(*b),
-                         reg_y, reg_u, reg_v);
-      *y = clipped_cast<icl32f,D>(reg_y);
-      *u = clipped_cast<icl32f,D>(reg_u);
-      *v = clipped_cast<icl32f,D>(reg_v);
-    }
-
-    template<class S>
-    inline void subRGBtoYUV(const S *r, const S *g, const S *b, icl8u *y, icl8u *u, icl8u *v) {
-      register icl32f reg_y, reg_u, reg_v;
-      cc_util_rgb_to_yuv(clipped_cast<S,icl32f>(*r),
-                         clipped_cast<S,icl32f>(*g),
-                         clipped_cast<S,icl32f>(*b),
-                         reg_y, reg_u, reg_v);
-      *y = clipped_cast<icl32f,icl8u>(reg_y);
-      *u = clipped_cast<icl32f,icl8u>(reg_u);
-      *v = clipped_cast<icl32f,icl8u>(reg_v);
-    }
-
-    template<class S, class D>
-    inline void subSSERGBtoYUV(const S *r, const S *g, const S *b,
-                               D *y, D *u, D *v) {
-      // load RGB values
-      icl512 vR = icl512(r);
-      icl512 vG = icl512(g);
-      icl512 vB = icl512(b);
-
-      // calculate Y values
-      icl512 vY(icl512(0.299f) * vR);
-      vY += icl512(0.587f) * vG;
-      vY += icl512(0.114f) * vB;
-
-      // calculate U values
-      vB -= vY;
-      icl512 vU = icl512(0.492f) * vB;
-      vU += icl512(128.0f);
-
-      // calculate V values
-      vR -= vY;
-      icl512 vV = icl512(0.877f) * vR;
-      vV += icl512(128.0f);
-
-      //max(vV, C_0);
-      //min(vV, C_255);
-
-      // store the calculated values
-      vY.storeu(y);
-      vU.storeu(u);
-      vV.storeu(v);
-    }
-
-    template<>
-    inline void subSSERGBtoYUV(const icl8u *r, const icl8u *g, const icl8u *b,
-                               icl32f *y, icl32f *u, icl32f *v) {
-      // load RGB values
-      icl512 vR = icl512(r);
-      icl512 vG = icl512(g);
-      icl512 vB = icl512(b);
-
-      // calculate Y values
-      icl512 vY(icl512(0.299f) * vR);
-      vY += icl512(0.587f) * vG;
-      vY += icl512(0.114f) * vB;
-
-      // calculate U values
-      vB -= vY;
-      icl512 vU = icl512(0.492f) * vB;
-      vU += icl512(128.0f);
-
-      // calculate V values
-      vR -= vY;
-      icl512 vV = icl512(0.877f) * vR;
-      vV += icl512(128.0f);
-
-      // saturate values
-      vU = max(vU, icl512(0.0f));
-      vU = min(vU, icl512(255.0f));
-      vV = max(vV, icl512(0.0f));
-      vV = min(vV, icl512(255.0f));
-
-      // store the calculated values
-      vY.storeu(y);
-      vU.storeu(u);
-      vV.storeu(v);
-    }
-
-    template<>
-    inline void subSSERGBtoYUV(const icl32f *r, const icl32f *g, const icl32f *b,
-                               icl32f *y, icl32f *u, icl32f *v) {
-      // load RGB values
-      icl128 vR = icl128(r);
-      icl128 vG = icl128(g);
-      icl128 vB = icl128(b);
-
-      // calculate Y values
-      icl128 vY(icl128(0.299f) * vR);
-      vY += icl128(0.587f) * vG;
-      vY += icl128(0.114f) * vB;
-
-      // calculate U values
-      vB -= vY;
-      icl128 vU = icl128(0.492f) * vB;
-      vU += icl128(128.0f);
-
-      // calculate V values
-      vR -= vY;
-      icl128 vV = icl128(0.877f) * vR;
-      vV += icl128(128.0f);
-
-      // saturate values
-      vU = max(vU, icl128(0.0f));
-      vU = min(vU, icl128(255.0f));
-      vV = max(vV, icl128(0.0f));
-      vV = min(vV, icl128(255.0f));
-
-      // store the calculated values
-      vY.storeu(y);
-      vU.storeu(u);
-      vV.storeu(v);
-    }
-
-    USE_SSE_CONVERT(icl8u,icl8u,RGB,YUV,subRGBtoYUV,subSSERGBtoYUV,16)
-    USE_SSE_CONVERT(icl8u,icl32f,RGB,YUV,subRGBtoYUV,subSSERGBtoYUV,16)
-    USE_SSE_CONVERT(icl32f,icl8u,RGB,YUV,subRGBtoYUV,subSSERGBtoYUV,16)
-    USE_SSE_CONVERT(icl32f,icl32f,RGB,YUV,subRGBtoYUV,subSSERGBtoYUV,4)
-
-    // -- RBG to YUV -- //
-
-
-    // ++ RBG to Lab ++ //
-
-    template<class S, class D>
-    inline void subRGBtoLab(const S *r, const S *g, const S *b, D *L, D *A, D *B) {
-      register icl32f reg_X,reg_Y,reg_Z,reg_L, reg_a, reg_b;
-      cc_util_rgb_to_xyz_inline(clipped_cast<S,icl32f>(*r),
-                         clipped_cast<S,icl32f>(*g),
-                         clipped_cast<S,icl32f>(*b),
-                         reg_X,reg_Y,reg_Z);
-      cc_util_xyz_to_lab_inline(reg_X,reg_Y,reg_Z,reg_L,reg_a,reg_b);
-      *L = clipped_cast<icl32f,D>(reg_L);
-      *A = clipped_cast<icl32f,D>(reg_a);
-      *B = clipped_cast<icl32f,D>(reg_b);
-    }
-
-    template<class S>
-    inline void subRGBtoLab(const S *r, const S *g, const S *b, icl8u *L, icl8u *A, icl8u *B) {
-      register icl32f reg_X,reg_Y,reg_Z,reg_L, reg_a, reg_b;
-      cc_util_rgb_to_xyz_inline(clipped_cast<S,icl32f>(*r),
-                         clipped_cast<S,icl32f>(*g),
-                         clipped_cast<S,icl32f>(*b),
-                         reg_X,reg_Y,reg_Z);
-      cc_util_xyz_to_lab_inline(reg_X,reg_Y,reg_Z,reg_L,reg_a,reg_b);
-      *L = clipped_cast<icl32f,icl8u>(reg_L);
-      *A = clipped_cast<icl32f,icl8u>(reg_a);
-      *B = clipped_cast<icl32f,icl8u>(reg_b);
-    }
-
-    template<class S, class D>
-    inline void subSSERGBtoLab(const S *r, const S *g, const S *b,
-                               D *L, D *A, D *B) {
-      // load RGB values
-      icl512 vR = icl512(r);
-      icl512 vG = icl512(g);
-      icl512 vB = icl512(b);
-
-      // RGB to XYZ
-      icl512 x = icl512(0.412453f/255.0f) * vR
-               + icl512(0.35758f/255.0f)  * vG
-               + icl512(0.180423f/255.0f) * vB;
-      icl512 y = icl512(0.212671f/255.0f) * vR
-               + icl512(0.71516f/255.0f)  * vG
-               + icl512(0.072169f/255.0f) * vB;
-      icl512 z = icl512(0.019334f/255.0f) * vR
-               + icl512(0.119193f/255.0f) * vG
-               + icl512(0.950227f/255.0f) * vB;
-
-      x *= icl512(1.0f/0.950455f);
-      z *= icl512(1.0f/1.088753f);
-
-      icl512 fX = cbrt(x);
-      icl512 fY = cbrt(y);
-      icl512 fZ = cbrt(z);
-
-      icl512 ifX = (x > icl512(0.008856f));
-      icl512 ifY = (y > icl512(0.008856f));
-      icl512 ifZ = (z > icl512(0.008856f));
-
-      fX &= ifX;
-      fX += andnot(icl512(7.787f) * x + icl512(16.0f/116.0f), ifX);
-      fY &= ifY;
-      fY += andnot(icl512(7.787f) * y + icl512(16.0f/116.0f), ifY);
-      fZ &= ifZ;
-      fZ += andnot(icl512(7.787f) * z + icl512(16.0f/116.0f), ifZ);
-
-      icl512 vL = icl512(116.0f * 2.55f) * fY - icl512(16.0f * (255.0f / 100.0f));
-      icl512 va = icl512(500.0f) * (fX - fY) + icl512(128.0f);
-      icl512 vb = icl512(200.0f) * (fY - fZ) + icl512(128.0f);
-
-      // store the calculated values
-      vL.storeu(L);
-      va.storeu(A);
-      vb.storeu(B);
-    }
-
-    template<>
-    inline void subSSERGBtoLab(const icl32f *r, const icl32f *g, const icl32f *b,
-                               icl32f *L, icl32f *A, icl32f *B) {
-      // load RGB values
-      icl128 vR = icl128(r);
-      icl128 vG = icl128(g);
-      icl128 vB = icl128(b);
-
-      // RGB to XYZ
-      icl128 x = icl128(0.412453f/255.0f) * vR
-               + icl128(0.35758f/255.0f)  * vG
-               + icl128(0.180423f/255.0f) * vB;
-      icl128 y = icl128(0.212671f/255.0f) * vR
-               + icl128(0.71516f/255.0f)  * vG
-               + icl128(0.072169f/255.0f) * vB;
-      icl128 z = icl128(0.019334f/255.0f) * vR
-               + icl128(0.119193f/255.0f) * vG
-               + icl128(0.950227f/255.0f) * vB;
-
-      x *= icl128(1.0f/0.950455f);
-      z *= icl128(1.0f/1.088753f);
-
-      icl128 fX = cbrt(x);
-      icl128 fY = cbrt(y);
-      icl128 fZ = cbrt(z);
-
-      icl128 ifX = (x > icl128(0.008856f));
-      icl128 ifY = (y > icl128(0.008856f));
-      icl128 ifZ = (z > icl128(0.008856f));
-
-      fX &= ifX;
-      fX += andnot(icl128(7.787f) * x + icl128(16.0f/116.0f), ifX);
-      fY &= ifY;
-      fY += andnot(icl128(7.787f) * y + icl128(16.0f/116.0f), ifY);
-      fZ &= ifZ;
-      fZ += andnot(icl128(7.787f) * z + icl128(16.0f/116.0f), ifZ);
-
-      icl128 vL = icl128(116.0f * 2.55f) * fY - icl128(16.0f * (255.0f / 100.0f));
-      icl128 va = icl128(500.0f) * (fX - fY) + icl128(128.0f);
-      icl128 vb = icl128(200.0f) * (fY - fZ) + icl128(128.0f);
-
-      // store the calculated values
-      vL.storeu(L);
-      va.storeu(A);
-      vb.storeu(B);
-    }
-
-    USE_SSE_CONVERT(icl8u,icl8u,RGB,LAB,subRGBtoLab,subSSERGBtoLab,16)
-    USE_SSE_CONVERT(icl8u,icl32f,RGB,LAB,subRGBtoLab,subSSERGBtoLab,16)
-    USE_SSE_CONVERT(icl32f,icl8u,RGB,LAB,subRGBtoLab,subSSERGBtoLab,16)
-    USE_SSE_CONVERT(icl32f,icl32f,RGB,LAB,subRGBtoLab,subSSERGBtoLab,4)
-
-    // -- RBG to Lab -- //
-
-
-    // ++ RBG to Chroma ++ //
-
-    template<class S, class D>
-    inline void subRGBtoChroma(const S *r, const S *g, const S *b, D *cr, D *cg) {
-          register icl32f sum = *r+*g+*b;
-          sum+=!sum; //avoid division by zero
-          *cr=clipped_cast<icl32f,D>((*r*255)/sum + 0.5f);
-          *cg=clipped_cast<icl32f,D>((*g*255)/sum + 0.5f);
-    }
-
-    template<class S, class D>
-    inline void subSSERGBtoChroma(const S *r, const S *g, const S *b, D *cr, D *cg) {
-      // load RGB values
-      icl512 vR = icl512(r);
-      icl512 vG = icl512(g);
-      icl512 vB = icl512(b);
-
-      vB += vR;
-      vB += vG;
-      vB.rcp();
-
-      vR *= icl512(255.0f);
-      vR *= vB;
-      vG *= icl512(255.0f);
-      vG *= vB;
-
-      // store the calculated values
-      vR.storeu(cr);
-      vG.storeu(cg);
-    }
-
-    template<>
-    inline void subSSERGBtoChroma(const icl32f *r, const icl32f *g, const icl32f *b,
-                                  icl32f *cr, icl32f *cg) {
-      // load RGB values
-      icl128 vR = icl128(r);
-      icl128 vG = icl128(g);
-      icl128 vB = icl128(b);
-
-      vB += vR;
-      vB += vG;
-      vB.rcp();
-
-      vR *= icl128(255.0f);
-      vR *= vB;
-      vG *= icl128(255.0f);
-      vG *= vB;
-
-      // store the calculated values
-      vR.storeu(cr);
-      vG.storeu(cg);
-    }
-
-    USE_SSE_CONVERT(icl8u,icl8u,RGB,Chroma,subRGBtoChroma,subSSERGBtoChroma,16)
-    USE_SSE_CONVERT(icl8u,icl32f,RGB,Chroma,subRGBtoChroma,subSSERGBtoChroma,16)
-    USE_SSE_CONVERT(icl32f,icl8u,RGB,Chroma,subRGBtoChroma,subSSERGBtoChroma,16)
-    USE_SSE_CONVERT(icl32f,icl32f,RGB,Chroma,subRGBtoChroma,subSSERGBtoChroma,4)
-
-    // -- RBG to Chroma -- //
-
-
-    // ++ HLS to RGB ++ //
-
-    template<class S, class D>
-    inline void subHLStoRGB(const S *h, const S *l, const S *s, D *r, D *g, D *b) {
-      register icl32f reg_r(0), reg_g(0), reg_b(0);
-      cc_util_hls_to_rgb_inline(clipped_cast<S,icl32f>(*h),
-                                clipped_cast<S,icl32f>(*l),
-                                clipped_cast<S,icl32f>(*s),
-                                reg_r,reg_g,reg_b);
-      *r = clipped_cast<icl32f,D>(reg_r);
-      *g = clipped_cast<icl32f,D>(reg_g);
-      *b = clipped_cast<icl32f,D>(reg_b);
-    }
-
-    template<class S>
-    inline void subHLStoRGB(const S *h, const S *l, const S *s, icl8u *r, icl8u *g, icl8u *b) {
-      register icl32f reg_r(0), reg_g(0), reg_b(0);
-      cc_util_hls_to_rgb_inline(clipped_cast<S,icl32f>(*h),
-                                clipped_cast<S,icl32f>(*l),
-                                clipped_cast<S,icl32f>(*s),
-                                reg_r,reg_g,reg_b);
-      *r = clipped_cast<icl32f,icl8u>(reg_r + 0.5f);
-      *g = clipped_cast<icl32f,icl8u>(reg_g + 0.5f);
-      *b = clipped_cast<icl32f,icl8u>(reg_b + 0.5f);
-    }
-
-    template<class S, class D>
-    inline void subSSEHLStoRGB(const S *h, const S *l, const S *s, D *r, D *g, D *b) {
-      // load HLS values
-      icl512 vH = icl512(h);
-      icl512 vL = icl512(l);
-      icl512 vS = icl512(s);
-
-      vH *= icl512(6.0f/255.0f);
-      vL *= icl512(1.0f/255.0f);
-      vS *= icl512(1.0f/255.0f);
-
-      icl512 vSL  = vL * vS;
-      icl512 vLSL = vL + vS - vSL;
-      icl512 vV = sse_ifelse(vL <= icl512(0.5f), vL + vSL, vLSL);
-
-      icl512 vM = vL + vL - vV;
-      icl512 vSV = (vV - vM) * icl512(vV).rcp();
-      icl512 vST = icl512i32s(_mm_cvttps_epi32(vH.v0), _mm_cvttps_epi32(vH.v1),
-                              _mm_cvttps_epi32(vH.v2), _mm_cvttps_epi32(vH.v3));
-      icl512 vF = vH - vST;
-      icl512 vVSF = vV * vSV * vF;
-      icl512 vMid1 = vM + vVSF;
-      icl512 vMid2 = vV - vVSF;
-
-      icl512 vIf0 = (vV  > icl512(0.0f));
-      icl512 vIf1 = (vST < icl512(1.0f));
-      icl512 vIf2 = (vST < icl512(2.0f));
-      icl512 vIf3 = (vST < icl512(3.0f));
-      icl512 vIf4 = (vST < icl512(4.0f));
-      icl512 vIf5 = (vST < icl512(5.0f));
-      icl512 vIf6 = (vST < icl512(6.0f));
-
-      icl512 vR = vV;
-      vR = sse_ifelse(vIf1, vR, vMid2);
-      vR = sse_ifelse(vIf2, vR, vM);
-      vR = sse_ifelse(vIf4, vR, vMid1);
-      vR = sse_ifelse(vIf5, vR, vV);
-      vR = sse_if(vIf0, vR);
-
-      icl512 vG = vMid1;
-      vG = sse_ifelse(vIf1, vG, vV);
-      vG = sse_ifelse(vIf3, vG, vMid2);
-      vG = sse_ifelse(vIf4, vG, vM);
-      vG = sse_ifelse(vIf6, vG, vMid1);
-      vG = sse_if(vIf0, vG);
-
-      icl512 vB = vM;
-      vB = sse_ifelse(vIf2, vB, vMid1);
-      vB = sse_ifelse(vIf3, vB, vV);
-      vB = sse_ifelse(vIf5, vB, vMid2);
-      vB = sse_ifelse(vIf6, vB, vM);
-      vB = sse_if(vIf0, vB);
-
-      vR *= icl512(255.0f);
-      vG *= icl512(255.0f);
-      vB *= icl512(255.0f);
-
-      // store the calculated values
-      vR.storeu(r);
-      vG.storeu(g);
-      vB.storeu(b);
-    }
-
-    template<>
-    inline void subSSEHLStoRGB(const icl32f *h, const icl32f *l, const icl32f *s,
-                               icl32f *r, icl32f *g, icl32f *b) {
-      // load HLS values
-      icl128 vH = icl128(h);
-      icl128 vL = icl128(l);
-      icl128 vS = icl128(s);
-
-      vH *= icl128(6.0f/255.0f);
-      vL *= icl128(1.0f/255.0f);
-      vS *= icl128(1.0f/255.0f);
-
-      icl128 vSL  = vL * vS;
-      icl128 vLSL = vL + vS - vSL;
-      icl128 vV = sse_ifelse(vL <= icl128(0.5f), vL + vSL, vLSL);
-
-      icl128 vM = vL + vL - vV;
-      icl128 vSV = (vV - vM) * icl128(vV).rcp();
-      icl128 vST = icl128i32s(_mm_cvttps_epi32(vH.v0));
-      icl128 vF = vH - vST;
-      icl128 vVSF = vV * vSV * vF;
-      icl128 vMid1 = vM + vVSF;
-      icl128 vMid2 = vV - vVSF;
-
-      icl128 vIf0 = (vV  > icl128(0.0f));
-      icl128 vIf1 = (vST < icl128(1.0f));
-      icl128 vIf2 = (vST < icl128(2.0f));
-      icl128 vIf3 = (vST < icl128(3.0f));
-      icl128 vIf4 = (vST < icl128(4.0f));
-      icl128 vIf5 = (vST < icl128(5.0f));
-      icl128 vIf6 = (vST < icl128(6.0f));
-
-      icl128 vR = vV;
-      vR = sse_ifelse(vIf1, vR, vMid2);
-      vR = sse_ifelse(vIf2, vR, vM);
-      vR = sse_ifelse(vIf4, vR, vMid1);
-      vR = sse_ifelse(vIf5, vR, vV);
-      vR = sse_if(vIf0, vR);
-
-      icl128 vG = vMid1;
-      vG = sse_ifelse(vIf1, vG, vV);
-      vG = sse_ifelse(vIf3, vG, vMid2);
-      vG = sse_ifelse(vIf4, vG, vM);
-      vG = sse_ifelse(vIf6, vG, vMid1);
-      vG = sse_if(vIf0, vG);
-
-      icl128 vB = vM;
-      vB = sse_ifelse(vIf2, vB, vMid1);
-      vB = sse_ifelse(vIf3, vB, vV);
-      vB = sse_ifelse(vIf5, vB, vMid2);
-      vB = sse_ifelse(vIf6, vB, vM);
-      vB = sse_if(vIf0, vB);
-
-      vR *= icl128(255.0f);
-      vG *= icl128(255.0f);
-      vB *= icl128(255.0f);
-
-      // store the calculated values
-      vR.storeu(r);
-      vG.storeu(g);
-      vB.storeu(b);
-    }
-
-    USE_SSE_CONVERT(icl8u,icl8u,HLS,RGB,subHLStoRGB,subSSEHLStoRGB,16)
-    USE_SSE_CONVERT(icl8u,icl32f,HLS,RGB,subHLStoRGB,subSSEHLStoRGB,16)
-    USE_SSE_CONVERT(icl32f,icl8u,HLS,RGB,subHLStoRGB,subSSEHLStoRGB,16)
-    USE_SSE_CONVERT(icl32f,icl32f,HLS,RGB,subHLStoRGB,subSSEHLStoRGB,4)
-
-    // -- HLS to RGB -- //
-
-
-    // ++ HLS to YUV ++ //
-
-    template<class S, class D>
-    inline void subHLStoYUV(const S *h, const S *l, const S *s, D *y, D *u, D *v) {
-      register icl32f reg_r(0), reg_g(0), reg_b(0);
-      register icl32f reg_y, reg_u, reg_v;
-      cc_util_hls_to_rgb_inline(clipped_cast<S,icl32f>(*h),
-                                clipped_cast<S,icl32f>(*l),
-                                clipped_cast<S,icl32f>(*s),
-                                reg_r,reg_g,reg_b);
-      cc_util_rgb_to_yuv(reg_r, reg_g, reg_b,
-                         reg_y, reg_u, reg_v);
-      *y = clipped_cast<icl32f,D>(reg_y);
-      *u = clipped_cast<icl32f,D>(reg_u);
-      *v = clipped_cast<icl32f,D>(reg_v);
-    }
-
-    template<class S>
-    inline void subHLStoYUV(const S *h, const S *l, const S *s, icl8u *y, icl8u *u, icl8u *v) {
-      register icl32f reg_r(0), reg_g(0), reg_b(0);
-      register icl32f reg_y, reg_u, reg_v;
-      cc_util_hls_to_rgb_inline(clipped_cast<S,icl32f>(*h),
-                                clipped_cast<S,icl32f>(*l),
-                                clipped_cast<S,icl32f>(*s),
-                                reg_r,reg_g,reg_b);
-      cc_util_rgb_to_yuv(reg_r, reg_g, reg_b,
-                         reg_y, reg_u, reg_v);
-      *y = clipped_cast<icl32f,icl8u>(reg_y + 0.5f);
-      *u = clipped_cast<icl32f,icl8u>(reg_u + 0.5f);
-      *v = clipped_cast<icl32f,icl8u>(reg_v + 0.5f);
-    }
-
-    template<class S, class D>
-    inline void subSSEHLStoYUV(const S *h, const S *l, const S *s, D *y, D *u, D *v) {
-      // load HLS values
-      icl512 vH = icl512(h);
-      icl512 vL = icl512(l);
-      icl512 vS = icl512(s);
-
-      vH *= icl512(6.0f/255.0f);
-      vL *= icl512(1.0f/255.0f);
-      vS *= icl512(1.0f/255.0f);
-
-      icl512 vSL  = vL * vS;
-      icl512 vLSL = vL + vS - vSL;
-      icl512 vV = sse_ifelse(vL <= icl512(0.5f), vL + vSL, vLSL);
-
-      icl512 vM = vL + vL - vV;
-      icl512 vSV = (vV - vM) * icl512(vV).rcp();
-      icl512 vST = icl512i32s(_mm_cvttps_epi32(vH.v0), _mm_cvttps_epi32(vH.v1),
-                              _mm_cvttps_epi32(vH.v2), _mm_cvttps_epi32(vH.v3));
-      icl512 vF = vH - vST;
-      icl512 vVSF = vV * vSV * vF;
-      icl512 vMid1 = vM + vVSF;
-      icl512 vMid2 = vV - vVSF;
-
-      icl512 vIf0 = (vV  > icl512(0.0f));
-      icl512 vIf1 = (vST < icl512(1.0f));
-      icl512 vIf2 = (vST < icl512(2.0f));
-      icl512 vIf3 = (vST < icl512(3.0f));
-      icl512 vIf4 = (vST < icl512(4.0f));
-      icl512 vIf5 = (vST < icl512(5.0f));
-      icl512 vIf6 = (vST < icl512(6.0f));
-
-      icl512 vR = vV;
-      vR = sse_ifelse(vIf1, vR, vMid2);
-      vR = sse_ifelse(vIf2, vR, vM);
-      vR = sse_ifelse(vIf4, vR, vMid1);
-      vR = sse_ifelse(vIf5, vR, vV);
-      vR = sse_if(vIf0, vR);
-
-      icl512 vG = vMid1;
-      vG = sse_ifelse(vIf1, vG, vV);
-      vG = sse_ifelse(vIf3, vG, vMid2);
-      vG = sse_ifelse(vIf4, vG, vM);
-      vG = sse_ifelse(vIf6, vG, vMid1);
-      vG = sse_if(vIf0, vG);
-
-      icl512 vB = vM;
-      vB = sse_ifelse(vIf2, vB, vMid1);
-      vB = sse_ifelse(vIf3, vB, vV);
-      vB = sse_ifelse(vIf5, vB, vMid2);
-      vB = sse_ifelse(vIf6, vB, vM);
-      vB = sse_if(vIf0, vB);
-
-      vR *= icl512(255.0f);
-      vG *= icl512(255.0f);
-      vB *= icl512(255.0f);
-
-      // calculate Y values
-      icl512 vY(icl512(0.299f) * vR);
-      vY += icl512(0.587f) * vG;
-      vY += icl512(0.114f) * vB;
-
-      // calculate U values
-      vB -= vY;
-      icl512 vU = icl512(0.492f) * vB;
-      vU += icl512(128.0f);
-
-      // calculate V values
-      vR -= vY;
-      icl512 vVV = icl512(0.877f) * vR;
-      vVV += icl512(128.0f);
-
-      // saturate values
-      vU = max(vU, icl512(0.0f));
-      vU = min(vU, icl512(255.0f));
-      vVV = max(vVV, icl512(0.0f));
-      vVV = min(vVV, icl512(255.0f));
-
-      // store the calculated values
-      vY.storeu(y);
-      vU.storeu(u);
-      vVV.storeu(v);
-    }
-
-    template<class S>
-    inline void subSSEHLStoYUV(const S *h, const S *l, const S *s, icl8u *y, icl8u *u, icl8u *v) {
-      // load HLS values
-      icl512 vH = icl512(h);
-      icl512 vL = icl512(l);
-      icl512 vS = icl512(s);
-
-      vH *= icl512(6.0f/255.0f);
-      vL *= icl512(1.0f/255.0f);
-      vS *= icl512(1.0f/255.0f);
-
-      icl512 vSL  = vL * vS;
-      icl512 vLSL = vL + vS - vSL;
-      icl512 vV = sse_ifelse(vL <= icl512(0.5f), vL + vSL, vLSL);
-
-      icl512 vM = vL + vL - vV;
-      icl512 vSV = (vV - vM) * icl512(vV).rcp();
-      icl512 vST = icl512i32s(_mm_cvttps_epi32(vH.v0), _mm_cvttps_epi32(vH.v1),
-                              _mm_cvttps_epi32(vH.v2), _mm_cvttps_epi32(vH.v3));
-      icl512 vF = vH - vST;
-      icl512 vVSF = vV * vSV * vF;
-      icl512 vMid1 = vM + vVSF;
-      icl512 vMid2 = vV - vVSF;
+      icl512 vM = vL + vL - vV;
+      icl512 vSV = (vV - vM) * icl512(vV).rcp();
+      icl512 vST = icl512i32s(_mm_cvttps_epi32(vH.v0), _mm_cvttps_epi32(vH.v1),
+                              _mm_cvttps_epi32(vH.v2), _mm_cvttps_epi32(vH.v3));
+      icl512 vF = vH - vST;
+      icl512 vVSF = vV * vSV * vF;
+      icl512 vMid1 = vM + vVSF;
+      icl512 vMid2 = vV - vVSF;
 
       icl512 vIf0 = (vV  > icl512(0.0f));
       icl512 vIf1 = (vST < icl512(1.0f));
@@ -2749,181 +1702,69 @@ namespace icl{
       icl128 vR = vV;
       vR = sse_ifelse(vIf1, vR, vMid2);
       vR = sse_ifelse(vIf2, vR, vM);
-      vR = sse_ifelse(vIf4, vR, vMid1);
-      vR = sse_ifelse(vIf5, vR, vV);
-      vR = sse_if(vIf0, vR);
-
-      icl128 vG = vMid1;
-      vG = sse_ifelse(vIf1, vG, vV);
-      vG = sse_ifelse(vIf3, vG, vMid2);
-      vG = sse_ifelse(vIf4, vG, vM);
-      vG = sse_ifelse(vIf6, vG, vMid1);
-      vG = sse_if(vIf0, vG);
-
-      icl128 vB = vM;
-      vB = sse_ifelse(vIf2, vB, vMid1);
-      vB = sse_ifelse(vIf3, vB, vV);
-      vB = sse_ifelse(vIf5, vB, vMid2);
-      vB = sse_ifelse(vIf6, vB, vM);
-      vB = sse_if(vIf0, vB);
-
-      // RGB to XYZ
-      icl128 x = icl128(0.412453f) * vR
-               + icl128(0.35758f)  * vG
-               + icl128(0.180423f) * vB;
-      icl128 y = icl128(0.212671f) * vR
-               + icl128(0.71516f)  * vG
-               + icl128(0.072169f) * vB;
-      icl128 z = icl128(0.019334f) * vR
-               + icl128(0.119193f) * vG
-               + icl128(0.950227f) * vB;
-
-      x *= icl128(1.0f/0.950455f);
-      z *= icl128(1.0f/1.088753f);
-
-      icl128 fX = cbrt(x);
-      icl128 fY = cbrt(y);
-      icl128 fZ = cbrt(z);
-
-      icl128 ifX = (x > icl128(0.008856f));
-      icl128 ifY = (y > icl128(0.008856f));
-      icl128 ifZ = (z > icl128(0.008856f));
-
-      fX &= ifX;
-      fX += andnot(icl128(7.787f) * x + icl128(16.0f/116.0f), ifX);
-      fY &= ifY;
-      fY += andnot(icl128(7.787f) * y + icl128(16.0f/116.0f), ifY);
-      fZ &= ifZ;
-      fZ += andnot(icl128(7.787f) * z + icl128(16.0f/116.0f), ifZ);
-
-      icl128 vl = icl128(116.0f * 2.55f) * fY - icl128(16.0f * (255.0f / 100.0f));
-      icl128 va = icl128(500.0f) * (fX - fY) + icl128(128.0f);
-      icl128 vb = icl128(200.0f) * (fY - fZ) + icl128(128.0f);
-
-      // store the calculated values
-      vl.storeu(L);
-      va.storeu(a);
-      vb.storeu(b);
-    }
-
-    USE_SSE_CONVERT(icl8u,icl8u,HLS,LAB,subHLStoLab,subSSEHLStoLab,16)
-    USE_SSE_CONVERT(icl8u,icl32f,HLS,LAB,subHLStoLab,subSSEHLStoLab,16)
-    USE_SSE_CONVERT(icl32f,icl8u,HLS,LAB,subHLStoLab,subSSEHLStoLab,16)
-    USE_SSE_CONVERT(icl32f,icl32f,HLS,LAB,subHLStoLab,subSSEHLStoLab,4)
-
-    // -- HLS to Lab -- //
-
-
-    // ++ YUV to RGB ++ //
-
-    template<class S, class D>
-    inline void subYUVtoRGB(const S *y, const S *u, const S *v, D *r, D *g, D *b) {
-      register icl32f reg_r, reg_g, reg_b;
-      cc_util_yuv_to_rgb(clipped_cast<S,icl32f>(*y),
-                         clipped_cast<S,icl32f>(*u),
-                         clipped_cast<S,icl32f>(*v),
-                         reg_r, reg_g, reg_b);
-      *r = clipped_cast<icl32f,D>(reg_r);
-      *g = clipped_cast<icl32f,D>(reg_g);
-      *b = clipped_cast<icl32f,D>(reg_b);
-    }
-
-    template<class S>
-    inline void subYUVtoRGB(const S *y, const S *u, const S *v, icl8u *r, icl8u *g, icl8u *b) {
-      register icl32f reg_r, reg_g, reg_b;
-      cc_util_yuv_to_rgb(clipped_cast<S,icl32f>(*y),
-                         clipped_cast<S,icl32f>(*u),
-                         clipped_cast<S,icl32f>(*v),
-                         reg_r, reg_g, reg_b);
-      *r = clipped_cast<icl32f,icl8u>(reg_r + 0.5f);
-      *g = clipped_cast<icl32f,icl8u>(reg_g + 0.5f);
-      *b = clipped_cast<icl32f,icl8u>(reg_b + 0.5f);
-    }
-
-    template<class S, class D>
-    inline void subSSEYUVtoRGB(const S *y, const S *u, const S *v, D *r, D *g, D *b) {
-      // load YUV values
-      icl512 vY = icl512(y);
-      icl512 vU = icl512(u);
-      icl512 vV = icl512(v);
-
-      vU -= icl512(128.0f);
-      vV -= icl512(128.0f);
-
-      icl512 vR = vY + icl512(1.140f) * vV;
-      icl512 vG = vY - icl512(0.394f) * vU - icl512(0.581f) * vV;
-      icl512 vB = vY + icl512(2.032f) * vU;
-
-      // clip values
-      vR = min(vR, icl512(255.0f));
-      vR = max(vR, icl512(0.0f));
-      vG = min(vG, icl512(255.0f));
-      vG = max(vG, icl512(0.0f));
-      vB = min(vB, icl512(255.0f));
-      vB = max(vB, icl512(0.0f));
-
-      // store the calculated values
-      vR.storeu(r);
-      vG.storeu(g);
-      vB.storeu(b);
-    }
-
-    template<class S>
-    inline void subSSEYUVtoRGB(const S *y, const S *u, const S *v,
-                               icl8u *r, icl8u *g, icl8u *b) {
-      // load YUV values
-      icl512 vY = icl512(y);
-      icl512 vU = icl512(u);
-      icl512 vV = icl512(v);
+      vR = sse_ifelse(vIf4, vR, vMid1);
+      vR = sse_ifelse(vIf5, vR, vV);
+      vR = sse_if(vIf0, vR);
 
-      vU -= icl512(128.0f);
-      vV -= icl512(128.0f);
+      icl128 vG = vMid1;
+      vG = sse_ifelse(vIf1, vG, vV);
+      vG = sse_ifelse(vIf3, vG, vMid2);
+      vG = sse_ifelse(vIf4, vG, vM);
+      vG = sse_ifelse(vIf6, vG, vMid1);
+      vG = sse_if(vIf0, vG);
 
-      icl512 vR = vY + icl512(1.140f) * vV;
-      icl512 vG = vY - icl512(0.394f) * vU - icl512(0.581f) * vV;
-      icl512 vB = vY + icl512(2.032f) * vU;
+      icl128 vB = vM;
+      vB = sse_ifelse(vIf2, vB, vMid1);
+      vB = sse_ifelse(vIf3, vB, vV);
+      vB = sse_ifelse(vIf5, vB, vMid2);
+      vB = sse_ifelse(vIf6, vB, vM);
+      vB = sse_if(vIf0, vB);
 
-      // store the calculated values
-      vR.storeu(r);
-      vG.storeu(g);
-      vB.storeu(b);
-    }
+      // RGB to XYZ
+      icl128 x = icl128(0.412453f) * vR
+               + icl128(0.35758f)  * vG
+               + icl128(0.180423f) * vB;
+      icl128 y = icl128(0.212671f) * vR
+               + icl128(0.71516f)  * vG
+               + icl128(0.072169f) * vB;
+      icl128 z = icl128(0.019334f) * vR
+               + icl128(0.119193f) * vG
+               + icl128(0.950227f) * vB;
 
-    template<>
-    inline void subSSEYUVtoRGB(const icl32f *y, const icl32f *u, const icl32f *v,
-                               icl32f *r, icl32f *g, icl32f *b) {
-      // load YUV values
-      icl128 vY = icl128(y);
-      icl128 vU = icl128(u);
-      icl128 vV = icl128(v);
+      x *= icl128(1.0f/0.950455f);
+      z *= icl128(1.0f/1.088753f);
 
-      vU -= icl128(128.0f);
-      vV -= icl128(128.0f);
+      icl128 fX = cbrt(x);
+      icl128 fY = cbrt(y);
+      icl128 fZ = cbrt(z);
 
-      icl128 vR = vY + icl128(1.140f) * vV;
-      icl128 vG = vY - icl128(0.394f) * vU - icl128(0.581f) * vV;
-      icl128 vB = vY + icl128(2.032f) * vU;
+      icl128 ifX = (x > icl128(0.008856f));
+      icl128 ifY = (y > icl128(0.008856f));
+      icl128 ifZ = (z > icl128(0.008856f));
 
-      // clip values
-      vR = min(vR, icl128(255.0f));
-      vR = max(vR, icl128(0.0f));
-      vG = min(vG, icl128(255.0f));
-      vG = max(vG, icl128(0.0f));
-      vB = min(vB, icl128(255.0f));
-      vB = max(vB, icl128(0.0f));
+      fX &= ifX;
+      fX += andnot(icl128(7.787f) * x + icl128(16.0f/116.0f), ifX);
+      fY &= ifY;
+      fY += andnot(icl128(7.787f) * y + icl128(16.0f/116.0f), ifY);
+      fZ &= ifZ;
+      fZ += andnot(icl128(7.787f) * z + icl128(16.0f/116.0f), ifZ);
+
+      icl128 vl = icl128(116.0f * 2.55f) * fY - icl128(16.0f * (255.0f / 100.0f));
+      icl128 va = icl128(500.0f) * (fX - fY) + icl128(128.0f);
+      icl128 vb = icl128(200.0f) * (fY - fZ) + icl128(128.0f);
 
       // store the calculated values
-      vR.storeu(r);
-      vG.storeu(g);
-      vB.storeu(b);
+      vl.storeu(L);
+      va.storeu(a);
+      vb.storeu(b);
     }
 
-    USE_SSE_CONVERT(icl8u,icl8u,YUV,RGB,subYUVtoRGB,subSSEYUVtoRGB,16)
-    USE_SSE_CONVERT(icl8u,icl32f,YUV,RGB,subYUVtoRGB,subSSEYUVtoRGB,16)
-    USE_SSE_CONVERT(icl32f,icl8u,YUV,RGB,subYUVtoRGB,subSSEYUVtoRGB,16)
-    USE_SSE_CONVERT(icl32f,icl32f,YUV,RGB,subYUVtoRGB,subSSEYUVtoRGB,4)
+    USE_SSE_CONVERT(icl8u,icl8u,HLS,LAB,subHLStoLab,subSSEHLStoLab,16)
+    USE_SSE_CONVERT(icl8u,icl32f,HLS,LAB,subHLStoLab,subSSEHLStoLab,16)
+    USE_SSE_CONVERT(icl32f,icl8u,HLS,LAB,subHLStoLab,subSSEHLStoLab,16)
+    USE_SSE_CONVERT(icl32f,icl32f,HLS,LAB,subHLStoLab,subSSEHLStoLab,4)
 
-    // -- YUV to RGB -- //
+    // -- HLS to Lab -- //
 
 
     // ++ YUV to HLS ++ //
@@ -3286,127 +2127,6 @@ namespace icl{
     // -- YUV to Lab -- //
 
 
-    // ++ Lab to RGB ++ //
-
-    template<class S, class D>
-    inline void subLabtoRGB(const S *L, const S *A, const S *B, D *r, D *g, D *b) {
-        register icl32f reg_x, reg_y, reg_z, reg_r, reg_g, reg_b;
-        cc_util_lab_to_xyz(clipped_cast<S,icl32f>(*L),
-                           clipped_cast<S,icl32f>(*A),
-                           clipped_cast<S,icl32f>(*B),
-                           reg_x,reg_y,reg_z);
-        cc_util_xyz_to_rgb(reg_x,reg_y,reg_z,reg_r,reg_g,reg_b);
-        *r = clipped_cast<icl32f,D>(reg_r);
-        *g = clipped_cast<icl32f,D>(reg_g);
-        *b = clipped_cast<icl32f,D>(reg_b);
-    }
-
-    template<class S>
-    inline void subLabtoRGB(const S *L, const S *A, const S *B, icl8u *r, icl8u *g, icl8u *b) {
-        register icl32f reg_x, reg_y, reg_z, reg_r, reg_g, reg_b;
-        cc_util_lab_to_xyz(clipped_cast<S,icl32f>(*L),
-                           clipped_cast<S,icl32f>(*A),
-                           clipped_cast<S,icl32f>(*B),
-                           reg_x,reg_y,reg_z);
-        cc_util_xyz_to_rgb(reg_x,reg_y,reg_z,reg_r,reg_g,reg_b);
-        *r = clipped_cast<icl32f,icl8u>(reg_r + 0.5f);
-        *g = clipped_cast<icl32f,icl8u>(reg_g + 0.5f);
-        *b = clipped_cast<icl32f,icl8u>(reg_b + 0.5f);
-    }
-
-    template<class S, class D>
-    inline void subSSELabtoRGB(const S *L, const S *A, const S *B, D *r, D *g, D *b) {
-      // load Lab values
-      icl512 vL = icl512(L);
-      icl512 vA = icl512(A);
-      icl512 vB = icl512(B);
-
-      icl512 vFy = (vL + icl512(16.0f*2.55f)) * icl512(1.0f/(2.55f*116.0f));
-      icl512 vFx = vFy + (vA - icl512(128.0f)) * icl512(1/500.0f);
-      icl512 vFz = vFy - (vB - icl512(128.0f)) * icl512(1/200.0f);
-
-      icl512 vY0 = vFy * vFy * vFy;
-      icl512 vX0 = vFx * vFx * vFx;
-      icl512 vZ0 = vFz * vFz * vFz;
-      icl512 vY1 = (vFy - icl512(16.0f/116.0f)) * icl512(1.0f/7.787f);
-      icl512 vX1 = (vFx - icl512(16.0f/116.0f)) * icl512(1.0f/7.787f);
-      icl512 vZ1 = (vFz - icl512(16.0f/116.0f)) * icl512(1.0f/7.787f);
-      vY0 = sse_ifelse(vFy > icl512(0.206893f), vY0, vY1);
-      vX0 = sse_ifelse(vFx > icl512(0.206893f), vX0, vX1);
-      vZ0 = sse_ifelse(vFz > icl512(0.206893f), vZ0, vZ1);
-
-      // white point correction
-      vX0 *= icl512(0.950455f);
-      vZ0 *= icl512(1.088754f);
-
-      // XYZ to RGB
-      icl512 vRr = icl512(3.240479*255.0f) * vX0
-                 + icl512(-1.53715*255.0f)  * vY0
-                 + icl512(-0.498535*255.0f) * vZ0;
-      icl512 vRg = icl512(-0.969256*255.0f) * vX0
-                 + icl512(1.875991*255.0f)  * vY0
-                 + icl512(0.041556*255.0f) * vZ0;
-      icl512 vRb = icl512(0.055648*255.0f) * vX0
-                 + icl512(-0.204043*255.0f) * vY0
-                 + icl512(1.057311*255.0f) * vZ0;
-
-      // store the calculated values
-      vRr.storeu(r);
-      vRg.storeu(g);
-      vRb.storeu(b);
-    }
-
-    template<>
-    inline void subSSELabtoRGB(const icl32f *L, const icl32f *A, const icl32f *B,
-                               icl32f *r, icl32f *g, icl32f *b) {
-      // load Lab values
-      icl128 vL = icl128(L);
-      icl128 vA = icl128(A);
-      icl128 vB = icl128(B);
-
-      icl128 vFy = (vL + icl128(16.0f*2.55f)) * icl128(1.0f/(2.55f*116.0f));
-      icl128 vFx = vFy + (vA - icl128(128.0f)) * icl128(1/500.0f);
-      icl128 vFz = vFy - (vB - icl128(128.0f)) * icl128(1/200.0f);
-
-      icl128 vY0 = vFy * vFy * vFy;
-      icl128 vX0 = vFx * vFx * vFx;
-      icl128 vZ0 = vFz * vFz * vFz;
-      icl128 vY1 = (vFy - icl128(16.0f/116.0f)) * icl128(1.0f/7.787f);
-      icl128 vX1 = (vFx - icl128(16.0f/116.0f)) * icl128(1.0f/7.787f);
-      icl128 vZ1 = (vFz - icl128(16.0f/116.0f)) * icl128(1.0f/7.787f);
-      vY0 = sse_ifelse(vFy > icl128(0.206893f), vY0, vY1);
-      vX0 = sse_ifelse(vFx > icl128(0.206893f), vX0, vX1);
-      vZ0 = sse_ifelse(vFz > icl128(0.206893f), vZ0, vZ1);
-
-      // white point correction
-      vX0 *= icl128(0.950455f);
-      vZ0 *= icl128(1.088754f);
-
-      // XYZ to RGB
-      icl128 vRr = icl128(3.240479*255.0f) * vX0
-                 + icl128(-1.53715*255.0f)  * vY0
-                 + icl128(-0.498535*255.0f) * vZ0;
-      icl128 vRg = icl128(-0.969256*255.0f) * vX0
-                 + icl128(1.875991*255.0f)  * vY0
-                 + icl128(0.041556*255.0f) * vZ0;
-      icl128 vRb = icl128(0.055648*255.0f) * vX0
-                 + icl128(-0.204043*255.0f) * vY0
-                 + icl128(1.057311*255.0f) * vZ0;
-
-      // store the calculated values
-      vRr.storeu(r);
-      vRg.storeu(g);
-      vRb.storeu(b);
-    }
-
-    USE_SSE_CONVERT(icl8u,icl8u,LAB,RGB,subLabtoRGB,subSSELabtoRGB,16)
-    USE_SSE_CONVERT(icl8u,icl32f,LAB,RGB,subLabtoRGB,subSSELabtoRGB,16)
-    USE_SSE_CONVERT(icl32f,icl8u,LAB,RGB,subLabtoRGB,subSSELabtoRGB,16)
-    USE_SSE_CONVERT(icl32f,icl32f,LAB,RGB,subLabtoRGB,subSSELabtoRGB,4)
-
-    // -- Lab to RGB -- //
-
-
     // ++ Lab to HLS ++ //
 
     template<class S, class D>
@@ -3906,6 +2626,148 @@ namespace icl{
   
     // }}}
   
+    static void cc_d(const ImgBase *src, ImgBase *dst, bool roiOnly){
+      // {{{ open
+
+      switch(src->getDepth()){ //TODO depth macro
+        case depth8u: cc_s(src->asImg<icl8u>(),dst,roiOnly); break;
+        case depth16s: cc_s(src->asImg<icl16s>(),dst,roiOnly); break;
+        case depth32s: cc_s(src->asImg<icl32s>(),dst,roiOnly); break;
+        case depth32f: cc_s(src->asImg<icl32f>(),dst,roiOnly); break;
+        case depth64f: cc_s(src->asImg<icl64f>(),dst,roiOnly); break;
+        default:
+          ICL_INVALID_DEPTH;
+      }
+    }
+
+    // }}}
+
+    /// process-wide SIMD mode (accessed atomically, cc reads it once per call)
+    static int g_iCCSIMDMode = ccSIMDAuto;
+
+    void cc_set_simd_mode(ccsimd mode){
+      utils::Atomic::store(&g_iCCSIMDMode, (int)mode);
+    }
+
+    ccsimd cc_get_simd_mode(){
+      return (ccsimd)utils::Atomic::load(&g_iCCSIMDMode);
+    }
+
+    /// images with less pixels are not split into row bands
+    static const int CC_PARALLEL_MIN_PIXELS = 65536;
+
+    /// approximate number of pixels per row band
+    static const int CC_BAND_PIXELS = 16384;
+
+    static bool get_simd_conversion(format srcFmt, format dstFmt, SIMDColorConversionJob::Conversion &c){
+      // {{{ open
+
+      typedef SIMDColorConversionJob J;
+      if(srcFmt == formatGray && dstFmt == formatRGB){
+        c = J::grayToRGB;
+      }else if(srcFmt == formatRGB){
+        switch(dstFmt){
+          case formatGray: c = J::rgbToGray; break;
+          case formatHLS: c = J::rgbToHLS; break;
+          case formatYUV: c = J::rgbToYUV; break;
+          case formatLAB: c = J::rgbToLAB; break;
+          case formatChroma: c = J::rgbToChroma; break;
+          default: return false;
+        }
+      }else if(dstFmt == formatRGB){
+        switch(srcFmt){
+          case formatHLS: c = J::hlsToRGB; break;
+          case formatYUV: c = J::yuvToRGB; break;
+          case formatLAB: c = J::labToRGB; break;
+          default: return false;
+        }
+      }else{
+        return false;
+      }
+      return true;
+    }
+
+    // }}}
+
+    /// converts the row band [begin,end) of the source and destination rects
+    /** Either by processing a part of the given SIMD job or by using shallow
+        copies with adapted ROI for the generic implementation */
+    struct CCBandConverter{
+      const ImgBase *src;
+      ImgBase *dst;
+      Rect srcRect;
+      Rect dstRect;
+      bool simd;
+      bool avx2;
+      SIMDColorConversionJob job;
+
+      void operator()(int begin, int end) const{
+        if(simd){
+          SIMDColorConversionJob j = job;
+          const long srcOffset = (long)begin*j.srcStride*getSizeOf(src->getDepth());
+          const long dstOffset = (long)begin*j.dstStride*getSizeOf(dst->getDepth());
+          for(int c=0;c<3;++c){
+            if(j.src[c]) j.src[c] = static_cast<const char*>(j.src[c]) + srcOffset;
+            if(j.dst[c]) j.dst[c] = static_cast<char*>(j.dst[c]) + dstOffset;
+          }
+          j.height = end-begin;
+          if(!avx2 || !simd_color_conversion_avx2(j)){
+            simd_color_conversion_sse2(j);
+          }
+        }else{
+          const ImgBase *s = src->shallowCopy(Rect(srcRect.x,srcRect.y+begin,srcRect.width,end-begin));
+          ImgBase *d = dst->shallowCopy(Rect(dstRect.x,dstRect.y+begin,dstRect.width,end-begin));
+          cc_d(s,d,true);
+          delete s;
+          delete d;
+        }
+      }
+    };
+
+    static void cc_available_parallel(const ImgBase *src, ImgBase *dst, bool roiOnly){
+      // {{{ open
+
+      CCBandConverter band;
+      band.src = src;
+      band.dst = dst;
+      band.srcRect = roiOnly ? src->getROI() : src->getImageRect();
+      band.dstRect = roiOnly ? dst->getROI() : dst->getImageRect();
+      const ccsimd mode = cc_get_simd_mode();
+      band.avx2 = mode == ccSIMDAuto && cpu_supports(cpuAVX2);
+  #ifdef ICL_HAVE_SSE2
+      band.simd = (mode != ccSIMDOff &&
+                   get_simd_conversion(src->getFormat(),dst->getFormat(),band.job.conversion));
+  #else
+      band.simd = false;
+  #endif
+      const Size size = band.srcRect.getSize();
+
+      if(band.simd){
+        SIMDColorConversionJob &j = band.job;
+        j.srcDepth = (SIMDColorConversionJob::Depth)src->getDepth();
+        j.dstDepth = (SIMDColorConversionJob::Depth)dst->getDepth();
+        j.srcStride = src->getWidth();
+        j.dstStride = dst->getWidth();
+        j.width = size.width;
+        j.height = size.height;
+        const long srcOffset = ((long)band.srcRect.y*j.srcStride + band.srcRect.x)*getSizeOf(src->getDepth());
+        const long dstOffset = ((long)band.dstRect.y*j.dstStride + band.dstRect.x)*getSizeOf(dst->getDepth());
+        for(int c=0;c<3;++c){
+          j.src[c] = c < src->getChannels() ? static_cast<const char*>(src->getDataPtr(c)) + srcOffset : 0;
+          j.dst[c] = c < dst->getChannels() ? static_cast<char*>(dst->getDataPtr(c)) + dstOffset : 0;
+        }
+      }
+
+      if(size.getDim() < CC_PARALLEL_MIN_PIXELS){
+        if(band.simd) band(0,size.height);
+        else cc_d(src,dst,roiOnly);
+      }else{
+        parallel_for(0,size.height,band,iclMax(1,CC_BAND_PIXELS/size.width));
+      }
+    }
+
+    // }}}
+
     void cc(const ImgBase *src, ImgBase *dst, bool roiOnly){
       // {{{ open
   
@@ -3943,15 +2805,7 @@ namespace icl{
       
       switch(cc_available(src->getFormat(), dst->getFormat())){
         case ccAvailable:
-          switch(src->getDepth()){ //TODO depth macro
-            case depth8u: cc_s(src->asImg<icl8u>(),dst,roiOnly); break;
-            case depth16s: cc_s(src->asImg<icl16s>(),dst,roiOnly); break;
-            case depth32s: cc_s(src->asImg<icl32s>(),dst,roiOnly); break;
-            case depth32f: cc_s(src->asImg<icl32f>(),dst,roiOnly); break;
-            case depth64f: cc_s(src->asImg<icl64f>(),dst,roiOnly); break;
-            default:
-              ICL_INVALID_DEPTH;
-          }
+          cc_available_parallel(src,dst,roiOnly);
           break;
         case ccEmulated:{
           if(roiOnly){
@@ -5182,7 +4036,178 @@ namespace icl{
   
     // }}}
 
+    // {{{ convertInterleaved
+
+    static format interleaved_layout_format(interleavedLayout layout){
+      switch(layout){
+        case layoutGray: return formatGray;
+        case layoutYUYV: case layoutUYVY: case layoutUYV: return formatYUV;
+        default: return formatRGB;
+      }
+    }
+
+    static int interleaved_layout_bytes(interleavedLayout layout){
+      switch(layout){
+        case layoutGray: return 1;
+        case layoutYUYV: case layoutUYVY: return 2;
+        case layoutRGBA: case layoutBGRA: return 4;
+        default: return 3;
+      }
+    }
+
+    /// unpacks n pixels of 4:2:2 data (starting at a pixel pair) into full resolution y, u and v
+    static void unpack_yuv422_line(const icl8u *src, int n, icl8u *y, icl8u *u, icl8u *v, bool uyvy){
+      int i=0;
+  #ifdef ICL_HAVE_SSE2
+      const __m128i lo8 = _mm_set1_epi16(0x00FF);
+      const __m128i lo16 = _mm_set1_epi32(0x0000FFFF);
+      for(; i<=n-16; i+=16, src+=32){
+        const __m128i a = _mm_loadu_si128((const __m128i*)src);
+        const __m128i b = _mm_loadu_si128((const __m128i*)(src+16));
+        // 16 bit lanes: y values and the interleaved chroma pairs u,v,u,v,...
+        const __m128i ya = uyvy ? _mm_srli_epi16(a,8) : _mm_and_si128(a,lo8);
+        const __m128i yb = uyvy ? _mm_srli_epi16(b,8) : _mm_and_si128(b,lo8);
+        const __m128i ca = uyvy ? _mm_and_si128(a,lo8) : _mm_srli_epi16(a,8);
+        const __m128i cb = uyvy ? _mm_and_si128(b,lo8) : _mm_srli_epi16(b,8);
+        _mm_storeu_si128((__m128i*)(y+i), _mm_packus_epi16(ya,yb));
+
+        // each chroma value is used for two pixels
+        __m128i ua = _mm_and_si128(ca,lo16), ub = _mm_and_si128(cb,lo16);
+        __m128i va = _mm_srli_epi32(ca,16), vb = _mm_srli_epi32(cb,16);
+        ua = _mm_or_si128(ua,_mm_slli_epi32(ua,16));
+        ub = _mm_or_si128(ub,_mm_slli_epi32(ub,16));
+        va = _mm_or_si128(va,_mm_slli_epi32(va,16));
+        vb = _mm_or_si128(vb,_mm_slli_epi32(vb,16));
+        _mm_storeu_si128((__m128i*)(u+i), _mm_packus_epi16(ua,ub));
+        _mm_storeu_si128((__m128i*)(v+i), _mm_packus_epi16(va,vb));
+      }
+  #endif
+      const int iy0 = uyvy ? 1 : 0, iy1 = uyvy ? 3 : 2, iu = uyvy ? 0 : 1, iv = uyvy ? 2 : 3;
+      for(; i<n; i+=2, src+=4){
+        y[i] = src[iy0];
+        u[i] = src[iu];
+        v[i] = src[iv];
+        if(i+1 < n){
+          y[i+1] = src[iy1];
+          u[i+1] = src[iu];
+          v[i+1] = src[iv];
+        }
+      }
+    }
+
+    /// unpacks n interleaved 3-channel pixels (the last pixels are copied separately
+    /// as the shuffle based unpacking reads a few bytes ahead)
+    static void unpack_c3_line(const icl8u *src, int n, icl8u *a, icl8u *b, icl8u *c){
+      const int m = iclMax(0,n-2);
+      for_copy_c3p3(src,a,b,c,a+m);
+      for_copy_c3p3(src+3*m,a+m,b+m,c+m,a+n);
+    }
+
+    /// unpacks a single line of n pixels into the given planes (the 4th plane is only
+    /// used for the alpha channel of the RGBA layouts)
+    static void unpack_interleaved_line(const icl8u *src, interleavedLayout layout, int n, icl8u **dst){
+      switch(layout){
+        case layoutGray: memcpy(dst[0],src,n); break;
+        case layoutRGB: unpack_c3_line(src,n,dst[0],dst[1],dst[2]); break;
+        case layoutBGR: unpack_c3_line(src,n,dst[2],dst[1],dst[0]); break;
+        case layoutUYV: unpack_c3_line(src,n,dst[1],dst[0],dst[2]); break;
+        case layoutRGBA: for_copy_c4p4(src,dst[0],dst[1],dst[2],dst[3],dst[0]+n); break;
+        case layoutBGRA: for_copy_c4p4(src,dst[2],dst[1],dst[0],dst[3],dst[2]+n); break;
+        case layoutYUYV: unpack_yuv422_line(src,n,dst[0],dst[1],dst[2],false); break;
+        case layoutUYVY: unpack_yuv422_line(src,n,dst[0],dst[1],dst[2],true); break;
+      }
+    }
+
+    struct InterleavedBandConverter{
+      const icl8u *src;
+      interleavedLayout layout;
+      int srcLineStep;
+      ImgBase *dst;
+      Rect roi;
+      format fmt;  //!< natural format of the layout
+      int x0;      //!< first source pixel that is unpacked (pixel pair aligned for 4:2:2)
+      int n;       //!< number of unpacked pixels per line
+      bool direct; //!< unpack directly into the destination
+
+      const icl8u *line(int y) const {
+        return src + (long)(roi.y+y)*srcLineStep + x0*interleaved_layout_bytes(layout);
+      }
+
+      void operator()(int begin, int end) const{
+        const bool alpha = layout == layoutRGBA || layout == layoutBGRA;
+        if(direct){
+          Img8u &d = *dst->as8u();
+          std::vector<icl8u> a(alpha ? n : 0);
+          icl8u *ch[4] = { 0, 0, 0, alpha ? a.data() : 0 };
+          for(int y=begin;y<end;++y){
+            for(int c=0;c<d.getChannels() && c<3;++c){
+              ch[c] = d.getROIData(c) + (long)y*d.getWidth();
+            }
+            unpack_interleaved_line(line(y),layout,n,ch);
+          }
+          return;
+        }
+        // unpack bands of a few rows into a cache resident buffer and convert these
+        const int rows = iclMin(end-begin,iclMax(1,CC_BAND_PIXELS/n));
+        const int nc = alpha ? 4 : getChannelsOfFormat(fmt);
+        Img8u buf(Size(n,rows),nc);
+        std::vector<icl8u*> ch(nc);
+        for(int y=begin;y<end;y+=rows){
+          const int h = iclMin(rows,end-y);
+          for(int i=0;i<h;++i){
+            for(int c=0;c<nc;++c) ch[c] = buf.getData(c) + i*n;
+            unpack_interleaved_line(line(y+i),layout,n,ch.data());
+          }
+          for(int c=0;c<nc;++c) ch[c] = buf.getData(c);
+          ch.resize(getChannelsOfFormat(fmt));
+          Img8u tmp(Size(n,h),fmt,ch);
+          tmp.setROI(Rect(roi.x-x0,0,roi.width,h));
+          ImgBase *d = dst->shallowCopy(Rect(roi.x,roi.y+y,roi.width,h));
+          cc(&tmp,d,true);
+          delete d;
+          ch.resize(nc);
+        }
+      }
+    };
+
+    void convertInterleaved(const icl8u *src, interleavedLayout layout, ImgBase *dst, int srcLineStep){
+      ICLASSERT_RETURN(src);
+      ICLASSERT_RETURN(dst);
+      ICLASSERT_RETURN(dst->getChannels());
+      const Rect roi = dst->getROI();
+      if(!roi.getDim()) return;
+
+      InterleavedBandConverter band;
+      band.src = src;
+      band.layout = layout;
+      band.srcLineStep = srcLineStep < 0 ? interleaved_layout_bytes(layout)*dst->getWidth() : srcLineStep;
+      band.dst = dst;
+      band.roi = roi;
+      band.fmt = interleaved_layout_format(layout);
+      band.x0 = (layout == layoutYUYV || layout == layoutUYVY) ? (roi.x & ~1) : roi.x;
+      band.n = roi.right() - band.x0;
+      band.direct = (band.x0 == roi.x && dst->getDepth() == depth8u && dst->getFormat() == band.fmt &&
+                     dst->getChannels() == getChannelsOfFormat(band.fmt));
+
+      if(roi.getDim() < CC_PARALLEL_MIN_PIXELS){
+        band(0,roi.height);
+      }else{
+        parallel_for(0,roi.height,band,iclMax(1,CC_BAND_PIXELS/roi.width));
+      }
+    }
+
+    // }}}
+
   #ifdef ICL_HAVE_SSE2
+      inline void subYUV420toRGB(const icl8u *y, const icl8u *u, const icl8u *v,
+                                 icl8u *r, icl8u *g, icl8u *b) {
+        icl32f reg_r, reg_g, reg_b;
+        cc_util_yuv_to_rgb(icl32f(*y), icl32f(*u), icl32f(*v), reg_r, reg_g, reg_b);
+        *r = clipped_cast<icl32f,icl8u>(reg_r + 0.5f);
+        *g = clipped_cast<icl32f,icl8u>(reg_g + 0.5f);
+        *b = clipped_cast<icl32f,icl8u>(reg_b + 0.5f);
+      }
+
       inline void subSSEYUV420toRGB(const icl8u *y, const icl8u *u, const icl8u *v,
                                     icl8u *r, icl8u *g, icl8u *b) {
         // load YUV values
@@ -5243,8 +4268,8 @@ namespace icl{
         cB += 16;
       } else {
         for (;cY < lEnd; ++cY, ++cU, ++cV, ++cR, ++cG, ++cB) {
-          subYUVtoRGB(cY++, cU, cV, cR++, cG++, cB++);
-          subYUVtoRGB(cY, cU, cV, cR, cG, cB);
+          subYUV420toRGB(cY++, cU, cV, cR++, cG++, cB++);
+          subYUV420toRGB(cY, cU, cV, cR, cG, cB);
         }
         lEnd += w;
         sEnd += w;
@@ -5267,8 +4292,8 @@ namespace icl{
         cB += 16;
       } else {
         for (;cY < lEnd; ++cY, ++cU, ++cV, ++cR, ++cG, ++cB) {
-          subYUVtoRGB(cY++, cU, cV, cR++, cG++, cB++);
-          subYUVtoRGB(cY, cU, cV, cR, cG, cB);
+          subYUV420toRGB(cY++, cU, cV, cR++, cG++, cB++);
+          subYUV420toRGB(cY, cU, cV, cR, cG, cB);
         }
         lEnd += w;
         sEnd += w;
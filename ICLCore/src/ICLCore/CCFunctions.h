@@ -418,6 +418,28 @@ namespace icl{
         </table>
   
         
+        \section SIMD SIMD Acceleration and Multi-Threading
+
+        Conversions from and to RGB (RGB to Gray, HLS, YUV, LAB and Chroma, and
+        Gray, HLS, YUV and LAB to RGB) are computed by vectorized code for all
+        source and destination depths if ICL was compiled with SSE2 support.
+        AVX2 is used instead if the CPU supports it (see utils::cpu_supports).
+        All values are computed in single precision. Integer destination values
+        are rounded to the nearest integer and saturated. The generic implementation
+        of the RGB/YUV conversions uses the same kernels with scalar operations, so
+        its results are bit-identical to the SIMD code. The remaining conversions
+        (e.g. YUV to HLS) use the SSE-optimized code for 8u and 32f images only.
+        The SIMD code can be disabled or restricted to SSE2 using cc_set_simd_mode.
+
+        Images with at least 65536 pixels are split into bands of rows that are
+        converted in parallel by the utils::TaskScheduler (see utils::parallel_for).
+        The number of threads can be adjusted with utils::TaskScheduler::setNumThreads
+        or the ICL_NUM_THREADS environment variable.
+
+        The ICLCore example cc-benchmark reports the throughput of all conversions
+        in megapixels per second.
+
+
         \section ROI ROI-Support
   
         A new feature is the ROI-Support of the "cc" function. If the "roiOnly"-flag given to cc function is 
@@ -488,6 +510,21 @@ namespace icl{
   
     /// returns the ccimpl state to a conversion from srcFmt to dstFmt
     ICLCore_API ccimpl cc_available(format srcFmt, format dstFmt);
+
+    /// Selects the SIMD code that is used by cc (see \ref SIMD)
+    enum ccsimd{
+      ccSIMDOff,  /**< plain C++ implementation (8u and 32f images are still partially SSE-optimized) */
+      ccSIMDSSE2, /**< SSE2 code, even if the CPU supports AVX2 */
+      ccSIMDAuto  /**< the best instruction set supported by the CPU (default) */
+    };
+
+    /// sets the process-wide SIMD mode of cc (mainly for benchmarks and debugging)
+    /** The mode may be changed while other threads call cc; each cc call reads
+        it once, so a concurrent change takes effect with the next call */
+    ICLCore_API void cc_set_simd_mode(ccsimd mode);
+
+    /// returns the current SIMD mode of cc
+    ICLCore_API ccsimd cc_get_simd_mode();
   
   
     /// Convert an image in YUV420-format to RGB8 format (ippi accelerated)
@@ -538,6 +575,41 @@ namespace icl{
     template<class S, class D> ICLCore_API
     void interleavedToPlanar(const S *src, Img<D> *dst, int srcLineStep = -1);
 
+    /// memory layouts of interleaved 8 bit pixel data that are supported by convertInterleaved
+    enum interleavedLayout{
+      layoutGray, //!< one byte per pixel
+      layoutRGB,  //!< r,g,b
+      layoutBGR,  //!< b,g,r
+      layoutRGBA, //!< r,g,b,a (alpha is skipped)
+      layoutBGRA, //!< b,g,r,a (alpha is skipped)
+      layoutYUYV, //!< two pixels in four bytes: y0,u,y1,v
+      layoutUYVY, //!< two pixels in four bytes: u,y0,v,y1
+      layoutUYV   //!< u,y,v (full resolution chroma)
+    };
+
+    /// Fused unpacking, color- and depth conversion of interleaved 8 bit data
+    /** The source buffer is interpreted as an image of dst's size with the given
+        interleaved layout. Only the pixels within dst's ROI are read and written,
+        converted to dst's format and depth in a single pass: the image is processed in
+        bands of a few rows that are unpacked into a small (cache resident) planar buffer
+        using SIMD shuffles and then converted into the destination using cc. Larger
+        images are processed in parallel using the utils::TaskScheduler.
+        Compared to interleavedToPlanar followed by cc and/or Img::convert, the
+        image data is only read and written once.
+
+        The natural format of the layout (formatGray, formatRGB or formatYUV) is
+        converted to dst's format with the same semantics as cc, i.e. all destination
+        formats supported by cc can be used (dst's channel count must match its format).
+        For YUYV and UYVY, the source width must be even.
+        @param src source data pointer
+        @param layout interleaved pixel layout of src
+        @param dst destination image (size, format, depth and ROI must be set up)
+        @param srcLineStep optional source line step in bytes (if -1, the source lines are
+                           assumed to be packed)
+    */
+    ICLCore_API void convertInterleaved(const icl8u *src, interleavedLayout layout,
+                                        ImgBase *dst, int srcLineStep = -1);
+
 
     /// converts given (r,g,b) pixel into the yuv format
     ICLCore_API void cc_util_rgb_to_yuv(const icl32s r, const icl32s g, const icl32s b, icl32s &y, icl32s &u, icl32s &v);
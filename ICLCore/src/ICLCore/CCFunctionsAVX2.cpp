@@ -0,0 +1,132 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/src/ICLCore/CCFunctionsAVX2.cpp                **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+/* This file is compiled with ICL_AVX2_FLAGS (see ICLCore/CMakeLists.txt).
+   Therefore, it must not include any headers that contain inline functions or
+   templates used by other translation units as well: the linker could pick
+   the AVX2-compiled instances, which would crash on CPUs without AVX2. */
+
+#include <ICLCore/CCFunctionsSIMDImpl.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace icl{
+  namespace core{
+
+#ifdef __AVX2__
+    namespace{
+      struct AVX2Ops{
+        typedef __m256 vf;
+        static const int NF = 8;
+
+        static inline vf load(const unsigned char *p){
+          return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p)));
+        }
+        static inline vf load(const short *p){
+          return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p)));
+        }
+        static inline vf load(const int *p){
+          return _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)p));
+        }
+        static inline vf load(const float *p){
+          return _mm256_loadu_ps(p);
+        }
+        static inline vf load(const double *p){
+          return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_loadu_pd(p))),
+                                      _mm256_cvtpd_ps(_mm256_loadu_pd(p+4)),1);
+        }
+
+        static inline __m128i packs(vf v){
+          const __m256i i = _mm256_cvtps_epi32(v);
+          return _mm_packs_epi32(_mm256_castsi256_si128(i),_mm256_extracti128_si256(i,1));
+        }
+        static inline void store(unsigned char *p, vf v){
+          const __m128i s = packs(v);
+          _mm_storel_epi64((__m128i*)p,_mm_packus_epi16(s,s));
+        }
+        static inline void store(short *p, vf v){
+          _mm_storeu_si128((__m128i*)p,packs(v));
+        }
+        static inline void store(int *p, vf v){
+          // largest floats that can be converted to int without overflow
+          v = _mm256_min_ps(_mm256_max_ps(v,_mm256_set1_ps(-2147483520.f)),_mm256_set1_ps(2147483520.f));
+          _mm256_storeu_si256((__m256i*)p,_mm256_cvtps_epi32(v));
+        }
+        static inline void store(float *p, vf v){
+          _mm256_storeu_ps(p,v);
+        }
+        static inline void store(double *p, vf v){
+          _mm256_storeu_pd(p,_mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+          _mm256_storeu_pd(p+4,_mm256_cvtps_pd(_mm256_extractf128_ps(v,1)));
+        }
+
+        static inline vf set1(float f) { return _mm256_set1_ps(f); }
+        static inline vf add(vf a, vf b) { return _mm256_add_ps(a,b); }
+        static inline vf sub(vf a, vf b) { return _mm256_sub_ps(a,b); }
+        static inline vf mul(vf a, vf b) { return _mm256_mul_ps(a,b); }
+        static inline vf div(vf a, vf b) { return _mm256_div_ps(a,b); }
+        static inline vf min(vf a, vf b) { return _mm256_min_ps(a,b); }
+        static inline vf max(vf a, vf b) { return _mm256_max_ps(a,b); }
+
+        static inline vf cmpgt(vf a, vf b) { return _mm256_cmp_ps(a,b,_CMP_GT_OQ); }
+        static inline vf cmplt(vf a, vf b) { return _mm256_cmp_ps(a,b,_CMP_LT_OQ); }
+        static inline vf cmple(vf a, vf b) { return _mm256_cmp_ps(a,b,_CMP_LE_OQ); }
+        static inline vf cmpeq(vf a, vf b) { return _mm256_cmp_ps(a,b,_CMP_EQ_OQ); }
+        static inline vf mask(vf m, vf a) { return _mm256_and_ps(m,a); }
+        static inline vf select(vf m, vf a, vf b) { return _mm256_blendv_ps(b,a,m); }
+
+        static inline vf trunc(vf a){
+          return _mm256_round_ps(a,_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        }
+        static inline vf cbrt_guess(vf a){
+          // unsigned division by 3 via multiplication with 0xAAAAAAAB and a shift by 33
+          const __m256i i = _mm256_castps_si256(a);
+          const __m256i k = _mm256_set1_epi32(0xAAAAAAAB);
+          const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(i,k),33);
+          const __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(i,32),k),33);
+          const __m256i q = _mm256_or_si256(even,_mm256_slli_epi64(odd,32));
+          return _mm256_castsi256_ps(_mm256_add_epi32(q,_mm256_set1_epi32(709921077)));
+        }
+      };
+    }
+
+    bool simd_color_conversion_avx2(const SIMDColorConversionJob &job){
+      return simd_color_conversion_run<AVX2Ops>(job);
+    }
+#else
+    bool simd_color_conversion_avx2(const SIMDColorConversionJob&){
+      return false;
+    }
+#endif
+
+  } // namespace core
+}
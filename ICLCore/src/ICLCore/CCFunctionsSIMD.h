@@ -0,0 +1,88 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/src/ICLCore/CCFunctionsSIMD.h                  **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+namespace icl{
+  namespace core{
+
+    /// Internally used description of a planar color conversion for the SIMD backend of core::cc
+    /** The job is set up by core::cc and processed by one of the instruction
+        set specific implementations. Like the SIMDConvolutionJob of the
+        ICLFilter package, it does only contain plain pointers and integers,
+        because the AVX2 implementation is compiled in a separate translation
+        unit with different compiler flags.
+
+        All conversions are computed in single precision floating point
+        arithmetic. Integer destination values are rounded to the nearest
+        integer and saturated to the destination range. */
+    struct SIMDColorConversionJob{
+      /// supported conversions
+      enum Conversion{
+        grayToRGB,   //!< 1 source channel, 3 destination channels
+        rgbToGray,   //!< 3 source channels, 1 destination channel
+        rgbToHLS,    //!< 3 source channels, 3 destination channels
+        rgbToYUV,    //!< 3 source channels, 3 destination channels
+        rgbToLAB,    //!< 3 source channels, 3 destination channels
+        rgbToChroma, //!< 3 source channels, 2 destination channels
+        hlsToRGB,    //!< 3 source channels, 3 destination channels
+        yuvToRGB,    //!< 3 source channels, 3 destination channels
+        labToRGB     //!< 3 source channels, 3 destination channels
+      };
+
+      /// supported pixel types (same order as core::depth)
+      enum Depth{
+        type8u,  //!< unsigned char
+        type16s, //!< short
+        type32s, //!< int
+        type32f, //!< float
+        type64f  //!< double
+      };
+
+      Conversion conversion;
+      Depth srcDepth;      //!< source pixel type
+      Depth dstDepth;      //!< destination pixel type
+      const void *src[3];  //!< first source pixel of each used channel
+      int srcStride;       //!< source line stride (in pixels)
+      void *dst[3];        //!< first destination pixel of each used channel
+      int dstStride;       //!< destination line stride (in pixels)
+      int width;           //!< number of pixels per line
+      int height;          //!< number of lines
+    };
+
+    /// Internally used SSE2 color conversion (returns false if ICL was compiled without SSE2 support)
+    bool simd_color_conversion_sse2(const SIMDColorConversionJob &job);
+
+    /// Internally used AVX2 color conversion (returns false if ICL was compiled without AVX2 support)
+    /** This function must only be called if utils::cpu_supports(utils::cpuAVX2) returns true */
+    bool simd_color_conversion_avx2(const SIMDColorConversionJob &job);
+
+  } // namespace core
+}
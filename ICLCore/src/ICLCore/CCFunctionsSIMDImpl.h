@@ -0,0 +1,366 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/src/ICLCore/CCFunctionsSIMDImpl.h              **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLCore/CCFunctionsSIMD.h>
+#include <cstring>
+
+/* This header is included by the instruction set specific translation units
+   CCFunctionsSSE2.cpp and CCFunctionsAVX2.cpp only. Each of them defines an
+   'Ops' class that wraps the required vector intrinsics and instantiates
+   simd_color_conversion_run<Ops>. Everything is placed in an anonymous
+   namespace so that the differently compiled instances never get merged by
+   the linker. For the same reason, no standard library templates are used.
+   CCFunctions.cpp includes this header as well: its generic RGB/YUV
+   conversions apply the kernels with scalar operations (CCScalarOps).
+
+   Ops interface:
+   - typedef vf (float vector), NF: number of floats in vf
+   - vf load(const T*) for T in {unsigned char, short, int, float, double}:
+     NF pixels converted to float
+   - void store(T*,vf) for the same types: NF pixels, integer types are
+     rounded to nearest and saturated
+   - vf set1(float), add, sub, mul, div, min, max (vf,vf)
+   - comparison masks: cmpgt, cmplt, cmple, cmpeq (vf,vf)
+   - vf mask(vf m, vf a): a where m is set, 0 otherwise
+   - vf select(vf m, vf a, vf b): a where m is set, b otherwise
+   - vf trunc(vf): rounding towards zero
+   - vf cbrt_guess(vf): W. Kahan's 5 bit cube root approximation, i.e.
+     the bit pattern divided by 3 (unsigned) plus 709921077
+*/
+
+namespace icl{
+  namespace core{
+    namespace{
+
+      // ++ conversion kernels ++ //
+
+      /// each kernel provides the channel counts NIN and NOUT and apply(in,out)
+      template<class Ops> struct SIMDGrayToRGB{
+        typedef typename Ops::vf vf;
+        static const int NIN = 1;
+        static const int NOUT = 3;
+        static inline void apply(const vf *in, vf *out){
+          out[0] = out[1] = out[2] = in[0];
+        }
+      };
+
+      template<class Ops> struct SIMDRGBToGray{
+        typedef typename Ops::vf vf;
+        static const int NIN = 3;
+        static const int NOUT = 1;
+        static inline void apply(const vf *in, vf *out){
+          out[0] = Ops::mul(Ops::add(Ops::add(in[0],in[1]),in[2]),Ops::set1(1.0f/3.0f));
+        }
+      };
+
+      template<class Ops> struct SIMDRGBToHLS{
+        typedef typename Ops::vf vf;
+        static const int NIN = 3;
+        static const int NOUT = 3;
+        static inline void apply(const vf *in, vf *out){
+          const vf k = Ops::set1(1.0f/255.0f);
+          const vf r = Ops::mul(in[0],k), g = Ops::mul(in[1],k), b = Ops::mul(in[2],k);
+          const vf vMax = Ops::max(Ops::max(r,g),b);
+          const vf vMin = Ops::min(Ops::min(r,g),b);
+          const vf sum = Ops::add(vMax,vMin);
+          const vf diff = Ops::sub(vMax,vMin);
+          const vf l = Ops::mul(sum,Ops::set1(0.5f));
+
+          // hue and saturation are 0 for black and for gray values
+          const vf valid = Ops::mask(Ops::cmpgt(l,Ops::set1(0.0f)),Ops::cmpgt(diff,Ops::set1(0.0f)));
+          const vf s = Ops::div(diff,Ops::select(Ops::cmpgt(l,Ops::set1(0.5f)),
+                                                 Ops::sub(Ops::set1(2.0f),sum),sum));
+
+          const vf inv = Ops::div(Ops::set1(60.0f),diff);
+          vf h = Ops::select(Ops::cmpeq(r,vMax), Ops::mul(Ops::sub(g,b),inv),
+                             Ops::select(Ops::cmpeq(g,vMax),
+                                         Ops::add(Ops::set1(120.0f),Ops::mul(Ops::sub(b,r),inv)),
+                                         Ops::add(Ops::set1(240.0f),Ops::mul(Ops::sub(r,g),inv))));
+          h = Ops::add(h,Ops::mask(Ops::cmplt(h,Ops::set1(0.0f)),Ops::set1(360.0f)));
+          h = Ops::mul(h,Ops::set1(255.0f/360.0f));
+          // H=255 is identical to H=0
+          h = Ops::mask(Ops::cmplt(h,Ops::set1(255.0f)),h);
+
+          out[0] = Ops::mask(valid,h);
+          out[1] = Ops::mask(Ops::cmpgt(l,Ops::set1(0.0f)),Ops::mul(l,Ops::set1(255.0f)));
+          out[2] = Ops::mask(valid,Ops::mul(s,Ops::set1(255.0f)));
+        }
+      };
+
+      template<class Ops> struct SIMDRGBToYUV{
+        typedef typename Ops::vf vf;
+        static const int NIN = 3;
+        static const int NOUT = 3;
+        static inline void apply(const vf *in, vf *out){
+          const vf y = Ops::add(Ops::add(Ops::mul(Ops::set1(0.299f),in[0]),
+                                         Ops::mul(Ops::set1(0.587f),in[1])),
+                                Ops::mul(Ops::set1(0.114f),in[2]));
+          const vf u = Ops::add(Ops::mul(Ops::set1(0.492f),Ops::sub(in[2],y)),Ops::set1(128.0f));
+          const vf v = Ops::add(Ops::mul(Ops::set1(0.877f),Ops::sub(in[0],y)),Ops::set1(128.0f));
+          out[0] = y;
+          out[1] = Ops::min(Ops::max(u,Ops::set1(0.0f)),Ops::set1(255.0f));
+          out[2] = Ops::min(Ops::max(v,Ops::set1(0.0f)),Ops::set1(255.0f));
+        }
+      };
+
+      /// cube root using Kahan's approximation followed by one Halley step (like cc_util_xyz_to_lab)
+      template<class Ops>
+      inline typename Ops::vf simd_cbrt(const typename Ops::vf &x){
+        typedef typename Ops::vf vf;
+        const vf a = Ops::cbrt_guess(x);
+        const vf a3 = Ops::mul(Ops::mul(a,a),a);
+        return Ops::div(Ops::mul(a,Ops::add(a3,Ops::add(x,x))),Ops::add(Ops::add(a3,a3),x));
+      }
+
+      template<class Ops>
+      inline typename Ops::vf simd_lab_f(const typename Ops::vf &t){
+        return Ops::select(Ops::cmpgt(t,Ops::set1(0.008856f)), simd_cbrt<Ops>(t),
+                           Ops::add(Ops::mul(Ops::set1(7.787f),t),Ops::set1(16.0f/116.0f)));
+      }
+
+      template<class Ops> struct SIMDRGBToLAB{
+        typedef typename Ops::vf vf;
+        static const int NIN = 3;
+        static const int NOUT = 3;
+        static inline vf dot(const vf *in, float a, float b, float c){
+          return Ops::add(Ops::add(Ops::mul(Ops::set1(a),in[0]),Ops::mul(Ops::set1(b),in[1])),
+                          Ops::mul(Ops::set1(c),in[2]));
+        }
+        static inline void apply(const vf *in, vf *out){
+          // RGB to XYZ including the white point normalization
+          const vf x = Ops::mul(dot(in,0.412453f/255.0f,0.35758f/255.0f,0.180423f/255.0f),
+                                Ops::set1(1.0f/0.950455f));
+          const vf y = dot(in,0.212671f/255.0f,0.71516f/255.0f,0.072169f/255.0f);
+          const vf z = Ops::mul(dot(in,0.019334f/255.0f,0.119193f/255.0f,0.950227f/255.0f),
+                                Ops::set1(1.0f/1.088753f));
+          const vf fx = simd_lab_f<Ops>(x), fy = simd_lab_f<Ops>(y), fz = simd_lab_f<Ops>(z);
+          out[0] = Ops::sub(Ops::mul(Ops::set1(116.0f*2.55f),fy),Ops::set1(16.0f*2.55f));
+          out[1] = Ops::add(Ops::mul(Ops::set1(500.0f),Ops::sub(fx,fy)),Ops::set1(128.0f));
+          out[2] = Ops::add(Ops::mul(Ops::set1(200.0f),Ops::sub(fy,fz)),Ops::set1(128.0f));
+        }
+      };
+
+      template<class Ops> struct SIMDRGBToChroma{
+        typedef typename Ops::vf vf;
+        static const int NIN = 3;
+        static const int NOUT = 2;
+        static inline void apply(const vf *in, vf *out){
+          vf sum = Ops::add(Ops::add(in[0],in[1]),in[2]);
+          sum = Ops::add(sum,Ops::mask(Ops::cmpeq(sum,Ops::set1(0.0f)),Ops::set1(1.0f)));
+          const vf k = Ops::div(Ops::set1(255.0f),sum);
+          out[0] = Ops::mul(in[0],k);
+          out[1] = Ops::mul(in[1],k);
+        }
+      };
+
+      template<class Ops> struct SIMDHLSToRGB{
+        typedef typename Ops::vf vf;
+        static const int NIN = 3;
+        static const int NOUT = 3;
+        static inline void apply(const vf *in, vf *out){
+          const vf h = Ops::mul(in[0],Ops::set1(6.0f/255.0f));
+          const vf l = Ops::mul(in[1],Ops::set1(1.0f/255.0f));
+          const vf s = Ops::mul(in[2],Ops::set1(1.0f/255.0f));
+          const vf sl = Ops::mul(l,s);
+          const vf v = Ops::select(Ops::cmple(l,Ops::set1(0.5f)), Ops::add(l,sl), Ops::sub(Ops::add(l,s),sl));
+          const vf m = Ops::sub(Ops::add(l,l),v);
+          const vf sextant = Ops::trunc(h);
+          const vf vsf = Ops::mul(Ops::sub(v,m),Ops::sub(h,sextant));
+          const vf mid1 = Ops::add(m,vsf);
+          const vf mid2 = Ops::sub(v,vsf);
+
+          const vf s1 = Ops::cmplt(sextant,Ops::set1(1.0f));
+          const vf s2 = Ops::cmplt(sextant,Ops::set1(2.0f));
+          const vf s3 = Ops::cmplt(sextant,Ops::set1(3.0f));
+          const vf s4 = Ops::cmplt(sextant,Ops::set1(4.0f));
+          const vf s5 = Ops::cmplt(sextant,Ops::set1(5.0f));
+          const vf s6 = Ops::cmplt(sextant,Ops::set1(6.0f));
+
+          // sextant:   0    1    2    3    4    5    6
+          // r:         v    mid2 m    m    mid1 v    v
+          // g:         mid1 v    v    mid2 m    m    mid1
+          // b:         m    m    mid1 v    v    mid2 m
+          vf r = Ops::select(s5,Ops::select(s4,Ops::select(s2,Ops::select(s1,v,mid2),m),mid1),v);
+          vf g = Ops::select(s6,Ops::select(s4,Ops::select(s3,Ops::select(s1,mid1,v),mid2),m),mid1);
+          vf b = Ops::select(s6,Ops::select(s5,Ops::select(s3,Ops::select(s2,m,mid1),v),mid2),m);
+
+          const vf valid = Ops::cmpgt(v,Ops::set1(0.0f));
+          const vf k = Ops::set1(255.0f);
+          out[0] = Ops::mask(valid,Ops::mul(r,k));
+          out[1] = Ops::mask(valid,Ops::mul(g,k));
+          out[2] = Ops::mask(valid,Ops::mul(b,k));
+        }
+      };
+
+      template<class Ops> struct SIMDYUVToRGB{
+        typedef typename Ops::vf vf;
+        static const int NIN = 3;
+        static const int NOUT = 3;
+        static inline vf clip(const vf &a){
+          return Ops::min(Ops::max(a,Ops::set1(0.0f)),Ops::set1(255.0f));
+        }
+        static inline void apply(const vf *in, vf *out){
+          const vf y = in[0];
+          const vf u = Ops::sub(in[1],Ops::set1(128.0f));
+          const vf v = Ops::sub(in[2],Ops::set1(128.0f));
+          out[0] = clip(Ops::add(y,Ops::mul(Ops::set1(1.140f),v)));
+          out[1] = clip(Ops::sub(Ops::sub(y,Ops::mul(Ops::set1(0.394f),u)),Ops::mul(Ops::set1(0.581f),v)));
+          out[2] = clip(Ops::add(y,Ops::mul(Ops::set1(2.032f),u)));
+        }
+      };
+
+      template<class Ops> struct SIMDLABToRGB{
+        typedef typename Ops::vf vf;
+        static const int NIN = 3;
+        static const int NOUT = 3;
+        static inline vf finv(const vf &f){
+          return Ops::select(Ops::cmpgt(f,Ops::set1(0.206893f)), Ops::mul(Ops::mul(f,f),f),
+                             Ops::mul(Ops::sub(f,Ops::set1(16.0f/116.0f)),Ops::set1(1.0f/7.787f)));
+        }
+        static inline vf dot(const vf &x, const vf &y, const vf &z, float a, float b, float c){
+          return Ops::add(Ops::add(Ops::mul(Ops::set1(a),x),Ops::mul(Ops::set1(b),y)),Ops::mul(Ops::set1(c),z));
+        }
+        static inline void apply(const vf *in, vf *out){
+          const vf fy = Ops::mul(Ops::add(in[0],Ops::set1(16.0f*2.55f)),Ops::set1(1.0f/(2.55f*116.0f)));
+          const vf fx = Ops::add(fy,Ops::mul(Ops::sub(in[1],Ops::set1(128.0f)),Ops::set1(1.0f/500.0f)));
+          const vf fz = Ops::sub(fy,Ops::mul(Ops::sub(in[2],Ops::set1(128.0f)),Ops::set1(1.0f/200.0f)));
+          // XYZ including the white point
+          const vf x = Ops::mul(finv(fx),Ops::set1(0.950455f));
+          const vf y = finv(fy);
+          const vf z = Ops::mul(finv(fz),Ops::set1(1.088754f));
+          out[0] = dot(x,y,z, 3.240479f*255.0f, -1.53715f*255.0f, -0.498535f*255.0f);
+          out[1] = dot(x,y,z,-0.969256f*255.0f,  1.875991f*255.0f, 0.041556f*255.0f);
+          out[2] = dot(x,y,z, 0.055648f*255.0f, -0.204043f*255.0f, 1.057311f*255.0f);
+        }
+      };
+
+      // -- conversion kernels -- //
+
+
+      /// applies the kernel K line by line
+      template<class Ops, class K, class S, class D>
+      void simd_cc_lines(const SIMDColorConversionJob &job){
+        typedef typename Ops::vf vf;
+        const int NF = Ops::NF;
+        const int w = job.width;
+        for(int y=0;y<job.height;++y){
+          const S *s[3];
+          D *d[3];
+          for(int c=0;c<K::NIN;++c) s[c] = static_cast<const S*>(job.src[c]) + (long)y*job.srcStride;
+          for(int c=0;c<K::NOUT;++c) d[c] = static_cast<D*>(job.dst[c]) + (long)y*job.dstStride;
+
+          vf in[3], out[3];
+          int x = 0;
+          for(;x<=w-NF;x+=NF){
+            for(int c=0;c<K::NIN;++c) in[c] = Ops::load(s[c]+x);
+            K::apply(in,out);
+            for(int c=0;c<K::NOUT;++c) Ops::store(d[c]+x,out[c]);
+          }
+          if(x < w){
+            // the remaining pixels are passed through zero-padded buffers
+            S sBuf[Ops::NF];
+            D dBuf[Ops::NF];
+            const int n = w-x;
+            for(int c=0;c<K::NIN;++c){
+              for(int i=0;i<NF;++i) sBuf[i] = S(0);
+              std::memcpy(sBuf,s[c]+x,n*sizeof(S));
+              in[c] = Ops::load(sBuf);
+            }
+            K::apply(in,out);
+            for(int c=0;c<K::NOUT;++c){
+              Ops::store(dBuf,out[c]);
+              std::memcpy(d[c]+x,dBuf,n*sizeof(D));
+            }
+          }
+        }
+      }
+
+      template<class Ops, class K, class S>
+      void simd_cc_dispatch_dst(const SIMDColorConversionJob &job){
+        typedef SIMDColorConversionJob J;
+        switch(job.dstDepth){
+          case J::type8u: simd_cc_lines<Ops,K,S,unsigned char>(job); break;
+          case J::type16s: simd_cc_lines<Ops,K,S,short>(job); break;
+          case J::type32s: simd_cc_lines<Ops,K,S,int>(job); break;
+          case J::type32f: simd_cc_lines<Ops,K,S,float>(job); break;
+          case J::type64f: simd_cc_lines<Ops,K,S,double>(job); break;
+        }
+      }
+
+      template<class Ops, class K>
+      void simd_cc_dispatch_src(const SIMDColorConversionJob &job){
+        typedef SIMDColorConversionJob J;
+        switch(job.srcDepth){
+          case J::type8u: simd_cc_dispatch_dst<Ops,K,unsigned char>(job); break;
+          case J::type16s: simd_cc_dispatch_dst<Ops,K,short>(job); break;
+          case J::type32s: simd_cc_dispatch_dst<Ops,K,int>(job); break;
+          case J::type32f: simd_cc_dispatch_dst<Ops,K,float>(job); break;
+          case J::type64f: simd_cc_dispatch_dst<Ops,K,double>(job); break;
+        }
+      }
+
+      /// gray to rgb without depth conversion is a plain copy
+      inline void simd_cc_copy_gray(const SIMDColorConversionJob &job){
+        static const int sizes[] = { 1, 2, 4, 4, 8 };
+        const int size = sizes[job.srcDepth];
+        for(int y=0;y<job.height;++y){
+          const char *s = static_cast<const char*>(job.src[0]) + (long)y*job.srcStride*size;
+          for(int c=0;c<3;++c){
+            std::memcpy(static_cast<char*>(job.dst[c]) + (long)y*job.dstStride*size, s, job.width*size);
+          }
+        }
+      }
+
+      template<class Ops>
+      bool simd_color_conversion_run(const SIMDColorConversionJob &job){
+        typedef SIMDColorConversionJob J;
+        switch(job.conversion){
+          case J::grayToRGB:
+            if(job.srcDepth == job.dstDepth) simd_cc_copy_gray(job);
+            else simd_cc_dispatch_src<Ops,SIMDGrayToRGB<Ops> >(job);
+            break;
+          case J::rgbToGray: simd_cc_dispatch_src<Ops,SIMDRGBToGray<Ops> >(job); break;
+          case J::rgbToHLS: simd_cc_dispatch_src<Ops,SIMDRGBToHLS<Ops> >(job); break;
+          case J::rgbToYUV: simd_cc_dispatch_src<Ops,SIMDRGBToYUV<Ops> >(job); break;
+          case J::rgbToLAB: simd_cc_dispatch_src<Ops,SIMDRGBToLAB<Ops> >(job); break;
+          case J::rgbToChroma: simd_cc_dispatch_src<Ops,SIMDRGBToChroma<Ops> >(job); break;
+          case J::hlsToRGB: simd_cc_dispatch_src<Ops,SIMDHLSToRGB<Ops> >(job); break;
+          case J::yuvToRGB: simd_cc_dispatch_src<Ops,SIMDYUVToRGB<Ops> >(job); break;
+          case J::labToRGB: simd_cc_dispatch_src<Ops,SIMDLABToRGB<Ops> >(job); break;
+          default: return false;
+        }
+        return true;
+      }
+
+    } // anonymous namespace
+  } // namespace core
+}
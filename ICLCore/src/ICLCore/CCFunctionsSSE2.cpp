@@ -0,0 +1,129 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/src/ICLCore/CCFunctionsSSE2.cpp                **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLUtils/SSETypes.h>
+#include <ICLCore/CCFunctionsSIMDImpl.h>
+
+namespace icl{
+  namespace core{
+
+#ifdef ICL_HAVE_SSE2
+    namespace{
+      struct SSE2Ops{
+        typedef __m128 vf;
+        static const int NF = 4;
+
+        static inline vf load(const unsigned char *p){
+          int i;
+          std::memcpy(&i,p,4);
+          const __m128i z = _mm_setzero_si128();
+          const __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(i),z),z);
+          return _mm_cvtepi32_ps(v);
+        }
+        static inline vf load(const short *p){
+          const __m128i v = _mm_loadl_epi64((const __m128i*)p);
+          return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v,v),16));
+        }
+        static inline vf load(const int *p){
+          return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)p));
+        }
+        static inline vf load(const float *p){
+          return _mm_loadu_ps(p);
+        }
+        static inline vf load(const double *p){
+          return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(p)),_mm_cvtpd_ps(_mm_loadu_pd(p+2)));
+        }
+
+        static inline void store(unsigned char *p, vf v){
+          const __m128i i = _mm_cvtps_epi32(v);
+          const __m128i s = _mm_packs_epi32(i,i);
+          const int u = _mm_cvtsi128_si32(_mm_packus_epi16(s,s));
+          std::memcpy(p,&u,4);
+        }
+        static inline void store(short *p, vf v){
+          const __m128i i = _mm_cvtps_epi32(v);
+          _mm_storel_epi64((__m128i*)p,_mm_packs_epi32(i,i));
+        }
+        static inline void store(int *p, vf v){
+          // largest floats that can be converted to int without overflow
+          v = _mm_min_ps(_mm_max_ps(v,_mm_set1_ps(-2147483520.f)),_mm_set1_ps(2147483520.f));
+          _mm_storeu_si128((__m128i*)p,_mm_cvtps_epi32(v));
+        }
+        static inline void store(float *p, vf v){
+          _mm_storeu_ps(p,v);
+        }
+        static inline void store(double *p, vf v){
+          _mm_storeu_pd(p,_mm_cvtps_pd(v));
+          _mm_storeu_pd(p+2,_mm_cvtps_pd(_mm_movehl_ps(v,v)));
+        }
+
+        static inline vf set1(float f) { return _mm_set1_ps(f); }
+        static inline vf add(vf a, vf b) { return _mm_add_ps(a,b); }
+        static inline vf sub(vf a, vf b) { return _mm_sub_ps(a,b); }
+        static inline vf mul(vf a, vf b) { return _mm_mul_ps(a,b); }
+        static inline vf div(vf a, vf b) { return _mm_div_ps(a,b); }
+        static inline vf min(vf a, vf b) { return _mm_min_ps(a,b); }
+        static inline vf max(vf a, vf b) { return _mm_max_ps(a,b); }
+
+        static inline vf cmpgt(vf a, vf b) { return _mm_cmpgt_ps(a,b); }
+        static inline vf cmplt(vf a, vf b) { return _mm_cmplt_ps(a,b); }
+        static inline vf cmple(vf a, vf b) { return _mm_cmple_ps(a,b); }
+        static inline vf cmpeq(vf a, vf b) { return _mm_cmpeq_ps(a,b); }
+        static inline vf mask(vf m, vf a) { return _mm_and_ps(m,a); }
+        static inline vf select(vf m, vf a, vf b){
+          return _mm_or_ps(_mm_and_ps(m,a),_mm_andnot_ps(m,b));
+        }
+
+        static inline vf trunc(vf a){
+          return _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        }
+        static inline vf cbrt_guess(vf a){
+          // unsigned division by 3 via multiplication with 0xAAAAAAAB and a shift by 33
+          const __m128i i = _mm_castps_si128(a);
+          const __m128i k = _mm_set1_epi32(0xAAAAAAAB);
+          const __m128i even = _mm_srli_epi64(_mm_mul_epu32(i,k),33);
+          const __m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(i,32),k),33);
+          const __m128i q = _mm_or_si128(even,_mm_slli_epi64(odd,32));
+          return _mm_castsi128_ps(_mm_add_epi32(q,_mm_set1_epi32(709921077)));
+        }
+      };
+    }
+
+    bool simd_color_conversion_sse2(const SIMDColorConversionJob &job){
+      return simd_color_conversion_run<SSE2Ops>(job);
+    }
+#else
+    bool simd_color_conversion_sse2(const SIMDColorConversionJob&){
+      return false;
+    }
+#endif
+
+  } // namespace core
+}
@@ -29,6 +29,8 @@
 ********************************************************************/
 
 #include <ICLCore/ImageSerializer.h>
+#include <ICLCore/Img.h>
+#include <ICLCore/ImgChannelPool.h>
 #include <ICLUtils/StringUtils.h>
 
 using namespace icl::utils;
@@ -58,6 +60,34 @@ namespace icl{
           return *this;
         }
       };
+
+      /// keeps a serialized data block alive as long as one of the image channels references it
+      struct SerializedBlockOwner : public ImgChannelPool::BlockOwner{
+        SerializedBlockOwner(const SmartArray<icl8u> &block):block(block){}
+        SmartArray<icl8u> block;
+      };
+
+      template<class T>
+      ImgBase *create_shallow_image(const SmartArray<icl8u> &owner, const icl8u *data,
+                                    int channels, const Size &size, format fmt){
+        const int dim = size.getDim();
+        if((size_t)data % sizeof(T)){
+          // unaligned access to wide depths is not portable: fall back to a deep copy
+          Img<T> *image = new Img<T>(size,channels,fmt);
+          for(int i=0;i<channels;++i){
+            memcpy(image->getData(i),data + i*dim*sizeof(T),dim*sizeof(T));
+          }
+          return image;
+        }
+        std::vector<T*> ptrs(channels);
+        for(int i=0;i<channels;++i){
+          // the returned image is const, the data is never written
+          ptrs[i] = const_cast<T*>(reinterpret_cast<const T*>(data + i*dim*sizeof(T)));
+          // each channel holds its own reference to the block, so that shallow copies keep it alive
+          ImgChannelPool::instance()->adopt(ptrs[i],new SerializedBlockOwner(owner));
+        }
+        return new Img<T>(size,channels,fmt,ptrs,true);
+      }
     }
     
     
@@ -163,6 +193,70 @@ namespace icl{
       }
     }
   
+    const ImgBase *ImageSerializer::deserializeShallow(const SmartArray<icl8u> &block, int blockSize) throw (ICLException){
+      ICLASSERT_THROW(block.get(),ICLException(str(__FUNCTION__)+": source data pinter was null"));
+      const int headerSize = getHeaderSize();
+      if(blockSize < headerSize + (int)sizeof(icl32s)){
+        throw ICLException(str(__FUNCTION__)+": data block is too small for an image header");
+      }
+      const icl8u *data = block.get();
+
+      BinaryUnserializer ser(data);
+
+      icl32s is[9];
+      int64_t l;
+      for(int i=0;i<9;++i){
+        ser >> is[i];
+      }
+      ser >> l;
+      data += headerSize;
+
+      static const int SIZES[] = { sizeof(icl8u), sizeof(icl16s), sizeof(icl32s), sizeof(icl32f), sizeof(icl64f)};
+      if(is[0] < 0 || is[0] > depthLast){
+        throw ICLException(str(__FUNCTION__)+": invalid depth in image header");
+      }
+      if(is[3] < 0 || is[3] > formatLast){
+        throw ICLException(str(__FUNCTION__)+": invalid format in image header");
+      }
+      if(is[1] < 0 || is[2] < 0 || is[4] < 0 ||
+         (is[3] != formatMatrix && is[4] != getChannelsOfFormat((format)is[3]))){
+        throw ICLException(str(__FUNCTION__)+": invalid size or channel count in image header");
+      }
+      if(is[5] < 0 || is[6] < 0 || is[7] < 0 || is[8] < 0 ||
+         (int64_t)is[5] + is[7] > is[1] || (int64_t)is[6] + is[8] > is[2]){
+        throw ICLException(str(__FUNCTION__)+": invalid roi in image header");
+      }
+      // computed in 64 bit, the header values are not trusted
+      const int64_t dataLength = (int64_t)is[1] * is[2] * is[4] * SIZES[is[0]];
+      if(dataLength > blockSize - headerSize - (int64_t)sizeof(icl32s)){
+        throw ICLException(str(__FUNCTION__)+": image data in header exceed the data block size");
+      }
+      const int metaLen = *(const icl32s*)(data + dataLength);
+      if(metaLen < 0 || metaLen > blockSize - headerSize - (int64_t)sizeof(icl32s) - dataLength){
+        throw ICLException(str(__FUNCTION__)+": meta data in header exceed the data block size");
+      }
+
+      const Size size(is[1],is[2]);
+      const int channels = is[4];
+      const format fmt = (format)is[3];
+      ImgBase *image = 0;
+      switch(is[0]){
+#define ICL_INSTANTIATE_DEPTH(D)                                                    \
+        case depth##D: image = create_shallow_image<icl##D>(block,data,channels,size,fmt); break;
+        ICL_INSTANTIATE_ALL_DEPTHS
+#undef ICL_INSTANTIATE_DEPTH
+        default: break;
+      }
+
+      image->setROI(Rect(is[5],is[6],is[7],is[8]));
+      image->setTime(Time(l));
+      data += dataLength + sizeof(icl32s);
+      if(metaLen){
+        image->getMetaData().assign((const char*)data, metaLen);
+      }
+      return image;
+    }
+
     int ImageSerializer::estimateSerializedSize(const ImgBase *image, bool skipMetaData) throw (ICLException){
       ICLASSERT_THROW(image,ICLException(str(__FUNCTION__)+": image was null"));
       return getHeaderSize() + estimateImageDataSize(image) + sizeof(icl32s) + (skipMetaData ? 0 : image->getMetaData().length());
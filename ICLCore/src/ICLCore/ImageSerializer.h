@@ -35,6 +35,7 @@
 #include <ICLCore/Types.h>
 #include <ICLUtils/Exception.h>
 #include <ICLUtils/Time.h>
+#include <ICLUtils/SmartArray.h>
 #include <vector>
 
 namespace icl{
@@ -61,6 +62,30 @@ namespace icl{
         [size][Meta-Data]
         <-4 -><- size  ->
         </pre>
+
+        \section ZC Zero-Copy Deserialization
+        deserialize() copies the channel data into the destination image.
+        If the serialized data block is kept alive anyway (e.g. a received
+        network message or a mapped shared memory segment),
+        deserializeShallow() can be used instead: it creates an image whose
+        channels directly reference the channel data blocks within the
+        serialized data. Only header and meta data are copied.
+        The data block is passed as utils::SmartArray, which is referenced
+        by each of the returned image's channels, so an owned block is
+        released together with the image and all of its shallow copies.
+        If the block is owned elsewhere (e.g. a mapped segment wrapped into
+        a non-owning SmartArray), its owner is responsible for keeping it
+        alive and unchanged as long as the image is used.
+
+        Since the channel data directly follow the 44 byte header, they are
+        only aligned if the data block starts at a suitable address. As
+        unaligned access to wide depths is not portable, deserializeShallow
+        copies the channel data if they are not aligned to the size of the
+        image's data type (in particular, depth64f data behind a header
+        that starts at an 8-byte aligned address).
+
+        The header values are validated against the given block size, so
+        deserializeShallow can also be used for data from untrusted sources.
     */
     struct ICLCore_API ImageSerializer{
       
@@ -92,6 +117,15 @@ namespace icl{
       /// deserializes an image (and optionally also the meta-data) from given icl8u data block
       static void deserialize(const icl8u *data, ImgBase **dst) throw (utils::ICLException);
   
+      /// deserializes an image without copying the channel data (see \ref ZC)
+      /** The returned image references the channel data within the given data
+          block and keeps the block alive. The caller takes the ownership of the
+          returned image. If the channel data are not aligned to the image's
+          data type, they are copied. An exception is thrown if the header is
+          invalid or if header, data and meta data exceed the given block size
+          (in bytes) */
+      static const ImgBase *deserializeShallow(const utils::SmartArray<icl8u> &data, int blockSize) throw (utils::ICLException);
+
       /// extracts only an images TimeStamp from it's serialized form
       static utils::Time deserializeTimeStamp(const icl8u *data) throw (utils::ICLException);
   
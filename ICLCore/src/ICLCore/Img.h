@@ -35,6 +35,7 @@
 #include <ICLUtils/Exception.h>
 #include <ICLCore/ImgBase.h>
 #include <ICLCore/ImgIterator.h>
+#include <ICLCore/ImgChannelPool.h>
 #include <ICLCore/Channel.h>
 #include <ICLCore/PixelRef.h>
 #include <ICLMath/DynMatrix.h>
@@ -77,7 +78,7 @@ namespace icl {
       /* {{{ open */
   
       /// internally used storage for the image channels
-      std::vector<utils::SmartArray<Type> > m_vecChannels;
+      std::vector<ImgChannelArray<Type> > m_vecChannels;
       /// @}
   
       /* }}} */
@@ -89,7 +90,7 @@ namespace icl {
       /** if the give Type* ptDataToCopy is not NULL, the data addressed from it, 
           is copied deeply into the new created data pointer
           **/
-      utils::SmartArray<Type> createChannel(Type *ptDataToCopy=0) const;
+      ImgChannelArray<Type> createChannel(Type *ptDataToCopy=0) const;
   
       /// returns the start index for a channel loop
       /** In some functions to cases must be regarded:
@@ -0,0 +1,270 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/src/ICLCore/ImgChannelPool.cpp                 **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCore/ImgChannelPool.h>
+#include <ICLUtils/Mutex.h>
+#include <ICLUtils/Atomic.h>
+#include <map>
+#include <vector>
+#include <new>
+#include <cstdlib>
+
+using namespace icl::utils;
+
+namespace icl{
+  namespace core{
+
+    static const size_t POOL_ALIGNMENT = 64;
+
+    /// size class 0 is POOL_ALIGNMENT, then 4 classes per power of two
+    static const int POOL_NUM_CLASSES = 1 + 4*(int)(8*sizeof(size_t)-6);
+
+    static int pool_class_index(size_t bytes){
+      if(bytes <= POOL_ALIGNMENT) return 0;
+      int k = 6;
+      size_t base = POOL_ALIGNMENT;
+      while(base*2 < bytes){ base *= 2; ++k; }
+      const size_t step = base/4;
+      return 1 + (k-6)*4 + (int)((bytes - base + step - 1)/step) - 1;
+    }
+
+    static size_t pool_class_size(int idx){
+      if(!idx) return POOL_ALIGNMENT;
+      const size_t base = POOL_ALIGNMENT << ((idx-1)/4);
+      return base + ((idx-1)%4 + 1)*(base/4);
+    }
+
+    /// stored right in front of each aligned block
+    struct PoolBlockHeader{
+      void *raw;  //!< original malloc pointer
+      int cls;    //!< size class index
+    };
+
+    static inline PoolBlockHeader *pool_header(void *p){
+      return static_cast<PoolBlockHeader*>(p) - 1;
+    }
+
+    // blocks are over-allocated, the header is stored right in front
+    // of the aligned block
+    static void *pool_alloc_block(int cls){
+      const size_t bytes = pool_class_size(cls);
+      char *raw = static_cast<char*>(malloc(bytes + POOL_ALIGNMENT + sizeof(PoolBlockHeader)));
+      if(!raw) throw std::bad_alloc();
+      const size_t a = (reinterpret_cast<size_t>(raw) + sizeof(PoolBlockHeader) + POOL_ALIGNMENT - 1) & ~(POOL_ALIGNMENT-1);
+      void *p = reinterpret_cast<void*>(a);
+      pool_header(p)->raw = raw;
+      pool_header(p)->cls = cls;
+      return p;
+    }
+
+    static void pool_free_block(void *p){
+      free(pool_header(p)->raw);
+    }
+
+    static inline size_t pool_add(size_t &v, size_t x){ return Atomic::add(&v,x); }
+    static inline void pool_sub(size_t &v, size_t x){ Atomic::sub(&v,x); }
+    static inline size_t pool_get(const size_t &v){ return Atomic::load(&v); }
+
+    /// free blocks of a single size class
+    struct PoolFreeList{
+      Mutex mutex;
+      std::vector<void*> blocks;
+    };
+
+    struct ImgChannelPool::Data{
+      PoolFreeList lists[POOL_NUM_CLASSES]; // one list (and lock) per size class
+      Mutex foreignMutex;
+      std::multimap<void*,BlockOwner*> foreign; // adopted blocks, that were not allocated by the pool
+      int numForeign;                        // accessed atomically (avoids locking in release)
+      size_t maxHeld;                        // accessed atomically
+      bool disabled;
+      Stats stats;                           // counters are accessed atomically
+    };
+
+    ImgChannelPool::ImgChannelPool():m_data(new Data){
+      m_data->numForeign = 0;
+      m_data->maxHeld = size_t(256) << 20;
+      m_data->disabled = getenv("ICL_DISABLE_IMG_POOL") != 0;
+    }
+
+    ImgChannelPool::~ImgChannelPool(){
+      trim(0);
+      delete m_data;
+    }
+
+    ImgChannelPool *ImgChannelPool::instance(){
+      // never deleted: images may be released during static deinitialization
+      static ImgChannelPool *pool = new ImgChannelPool;
+      return pool;
+    }
+
+    size_t ImgChannelPool::getSizeClass(size_t bytes){
+      return pool_class_size(pool_class_index(bytes));
+    }
+
+    void *ImgChannelPool::allocate(size_t bytes){
+      const int cls = pool_class_index(bytes);
+      const size_t size = pool_class_size(cls);
+      Data &d = *m_data;
+      void *p = 0;
+      {
+        PoolFreeList &l = d.lists[cls];
+        Mutex::Locker lock(l.mutex);
+        if(l.blocks.size()){
+          // most recently released block first (likely still cached)
+          p = l.blocks.back();
+          l.blocks.pop_back();
+        }
+      }
+      if(p){
+        pool_add(d.stats.hits,1);
+        pool_sub(d.stats.bytesHeld,size);
+        pool_sub(d.stats.blocksHeld,1);
+      }else{
+        p = pool_alloc_block(cls);
+        pool_add(d.stats.misses,1);
+      }
+      pool_add(d.stats.bytesInUse,size);
+      pool_add(d.stats.blocksInUse,1);
+      return p;
+    }
+
+    void ImgChannelPool::adopt(void *p){
+      if(!p) return;
+      Data &d = *m_data;
+      Mutex::Locker lock(d.foreignMutex);
+      if(d.foreign.find(p) == d.foreign.end()){
+        d.foreign.insert(std::make_pair(p,(BlockOwner*)0));
+        Atomic::inc(&d.numForeign);
+      }
+    }
+
+    void ImgChannelPool::adopt(void *p, BlockOwner *owner){
+      if(!p){
+        delete owner;
+        return;
+      }
+      Data &d = *m_data;
+      Mutex::Locker lock(d.foreignMutex);
+      d.foreign.insert(std::make_pair(p,owner));
+      Atomic::inc(&d.numForeign);
+    }
+
+    bool ImgChannelPool::release(void *p){
+      if(!p) return false;
+      Data &d = *m_data;
+      if(Atomic::load(&d.numForeign)){
+        BlockOwner *owner = 0;
+        {
+          Mutex::Locker lock(d.foreignMutex);
+          std::multimap<void*,BlockOwner*>::iterator it = d.foreign.find(p);
+          if(it != d.foreign.end()){
+            owner = it->second;
+            d.foreign.erase(it);
+            Atomic::dec(&d.numForeign);
+            if(!owner) return false;
+          }
+        }
+        if(owner){
+          // the owner may release the last reference to the block
+          delete owner;
+          return true;
+        }
+      }
+      const int cls = pool_header(p)->cls;
+      const size_t size = pool_class_size(cls);
+      pool_sub(d.stats.bytesInUse,size);
+      pool_sub(d.stats.blocksInUse,1);
+      if(d.disabled || pool_add(d.stats.bytesHeld,size) > pool_get(d.maxHeld)){
+        if(!d.disabled) pool_sub(d.stats.bytesHeld,size);
+        pool_free_block(p);
+        pool_add(d.stats.freed,1);
+      }else{
+        {
+          PoolFreeList &l = d.lists[cls];
+          Mutex::Locker lock(l.mutex);
+          l.blocks.push_back(p);
+        }
+        pool_add(d.stats.blocksHeld,1);
+        pool_add(d.stats.releases,1);
+      }
+      return true;
+    }
+
+    ImgChannelPool::Stats ImgChannelPool::getStats() const{
+      const Stats &s = m_data->stats;
+      Stats r;
+      r.hits = pool_get(s.hits);
+      r.misses = pool_get(s.misses);
+      r.releases = pool_get(s.releases);
+      r.freed = pool_get(s.freed);
+      r.bytesHeld = pool_get(s.bytesHeld);
+      r.bytesInUse = pool_get(s.bytesInUse);
+      r.blocksHeld = pool_get(s.blocksHeld);
+      r.blocksInUse = pool_get(s.blocksInUse);
+      return r;
+    }
+
+    void ImgChannelPool::resetStats(){
+      Stats &s = m_data->stats;
+      Atomic::store(&s.hits,0);
+      Atomic::store(&s.misses,0);
+      Atomic::store(&s.releases,0);
+      Atomic::store(&s.freed,0);
+    }
+
+    void ImgChannelPool::setMaxHeldBytes(size_t maxBytes){
+      Atomic::store(&m_data->maxHeld,maxBytes);
+      trim(maxBytes);
+    }
+
+    size_t ImgChannelPool::getMaxHeldBytes() const{
+      return pool_get(m_data->maxHeld);
+    }
+
+    void ImgChannelPool::trim(size_t maxHeldBytes){
+      Data &d = *m_data;
+      // the largest blocks are released first
+      for(int cls=POOL_NUM_CLASSES-1; cls >= 0 && pool_get(d.stats.bytesHeld) > maxHeldBytes; --cls){
+        const size_t size = pool_class_size(cls);
+        PoolFreeList &l = d.lists[cls];
+        Mutex::Locker lock(l.mutex);
+        while(l.blocks.size() && pool_get(d.stats.bytesHeld) > maxHeldBytes){
+          pool_free_block(l.blocks.back());
+          l.blocks.pop_back();
+          pool_sub(d.stats.bytesHeld,size);
+          pool_sub(d.stats.blocksHeld,1);
+          pool_add(d.stats.freed,1);
+        }
+      }
+    }
+
+  } // namespace core
+}
@@ -0,0 +1,187 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/src/ICLCore/ImgChannelPool.h                   **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/SmartPtrBase.h>
+#include <cstddef>
+
+namespace icl{
+  namespace core{
+
+    /// Singleton, thread-safe memory pool for image channel data \ingroup IMAGE
+    /** \section GEN General Information
+        Img<T> instances obtain their channel data from the ImgChannelPool.
+        Released channels are not deleted, but put back into the pool, so that
+        they can be reused by the next image of a similar size. This avoids
+        most of the malloc/free calls in typical processing pipelines, that
+        create, resize and copy images of the same size over and over again,
+        and it reduces heap fragmentation in long-running processes.
+
+        \section SIZE Size Classes
+        Requests are rounded up to size classes, that are spaced by four
+        classes per power of two (i.e. at most 25% of a block is unused).
+        All blocks are 64-byte (cache-line) aligned. Each size class has its
+        own free list and lock, so that threads, that allocate images of
+        different sizes, do not contend. The size class of a block is stored
+        in a small header in front of the block, so releasing a block does
+        not need a lookup.
+
+        \section TRIM Trim Policy
+        The pool keeps released blocks until the total size of all held
+        blocks would exceed the maximum held bytes (default: 256 MB). Blocks
+        that would exceed this limit are freed directly. trim can be used to
+        explicitly release held blocks (e.g. after a change of the camera
+        resolution).
+
+        \section ENV Environment
+        If the environment variable ICL_DISABLE_IMG_POOL is set, released
+        blocks are always freed directly (allocations are still aligned).
+    */
+    class ICLCore_API ImgChannelPool : public utils::Uncopyable{
+      struct Data;  //!< internal data storage class
+      Data *m_data; //!< internal data storage pointer
+      ImgChannelPool(); //!< private constructor -> use instance()
+      ~ImgChannelPool();
+
+      public:
+
+      /// usage statistics
+      struct Stats{
+        Stats():hits(0),misses(0),releases(0),freed(0),
+                bytesHeld(0),bytesInUse(0),blocksHeld(0),blocksInUse(0){}
+        size_t hits;        //!< allocations that were served from the pool
+        size_t misses;      //!< allocations that needed a new block
+        size_t releases;    //!< blocks that were put back into the pool
+        size_t freed;       //!< blocks that were freed (trim or limit exceeded)
+        size_t bytesHeld;   //!< bytes of all blocks in the pool
+        size_t bytesInUse;  //!< bytes of all blocks that are currently used
+        size_t blocksHeld;  //!< number of blocks in the pool
+        size_t blocksInUse; //!< number of blocks that are currently used
+      };
+
+      /// Interface for objects that keep externally owned channel data alive (see adopt)
+      struct BlockOwner{
+        /// releases the reference to the data
+        virtual ~BlockOwner(){}
+      };
+
+      /// returns the singleton instance (it is never deleted)
+      static ImgChannelPool *instance();
+
+      /// returns a 64-byte aligned block of at least the given size
+      void *allocate(size_t bytes);
+
+      /// puts a block back into the pool
+      /** returns false if the block was adopted without an owner (see adopt).
+          For blocks that were adopted with an owner, the owner is deleted */
+      bool release(void *p);
+
+      /// registers a block, that was not allocated by the pool
+      /** Image channels, whose data ownership is passed to the image,
+          must be registered, so that release returns false for them
+          rather than putting them into the pool */
+      void adopt(void *p);
+
+      /// registers a block, that is kept alive by the given owner
+      /** The pool takes the ownership of the owner, which is deleted when the
+          image channel is released (instead of deleting the block). The same
+          block can be registered several times with different owners, each
+          release then deletes one of them */
+      void adopt(void *p, BlockOwner *owner);
+
+      /// returns the current statistics
+      /** The counters are updated atomically, but not in a single
+          transaction, so the values may be slightly inconsistent while
+          other threads allocate or release blocks */
+      Stats getStats() const;
+
+      /// resets the hit, miss, release and freed counters
+      void resetStats();
+
+      /// sets the maximum number of bytes held by the pool
+      void setMaxHeldBytes(size_t maxBytes);
+
+      /// returns the maximum number of bytes held by the pool
+      size_t getMaxHeldBytes() const;
+
+      /// frees held blocks until at most maxHeldBytes are held
+      void trim(size_t maxHeldBytes=0);
+
+      /// returns the size class a given request is rounded up to
+      static size_t getSizeClass(size_t bytes);
+    };
+
+    /// Delete operation for image channel data (returns the data to the ImgChannelPool) \ingroup IMAGE
+    /** Data that was adopted by the pool (i.e. data passed to an Img with
+        passOwnerShip=true) is released using delete[], unless it was adopted
+        with an ImgChannelPool::BlockOwner */
+    struct ImgChannelDelOp : public utils::DelOpBase{
+      template<class T> static void delete_func(T *t){
+        if(!ImgChannelPool::instance()->release(t)) delete [] t;
+      }
+    };
+
+    /// Reference counted image channel data (see utils::SmartArray) \ingroup IMAGE
+    template<class T>
+    struct ImgChannelArray : public utils::SmartPtrBase<T, ImgChannelDelOp>{
+      /// type definition for the parent class
+      typedef utils::SmartPtrBase<T,ImgChannelDelOp> super;
+
+      /// creates a null pointer
+      ImgChannelArray():super(){}
+
+      /// gets pointer, ownership is passed optionally
+      /** Owned data is adopted by the ImgChannelPool (and deleted using delete[]) */
+      ImgChannelArray(T *ptData, bool bOwn=true):super(ptData,bOwn){
+        if(ptData && bOwn) ImgChannelPool::instance()->adopt(ptData);
+      }
+
+      /// reference counting copy constructor
+      ImgChannelArray(const utils::SmartPtrBase<T,ImgChannelDelOp>& r):super(r){}
+
+      /// creates a new, uninitialized array of n elements from the ImgChannelPool
+      static ImgChannelArray<T> create(size_t n){
+        ImgChannelArray<T> a;
+        a.set(static_cast<T*>(ImgChannelPool::instance()->allocate(n*sizeof(T))),new int(1),true);
+        return a;
+      }
+
+      /// index access operator (no index checks)
+      T &operator[](int idx){ ICLASSERT(super::e); return super::e[idx]; }
+
+      /// index access operator (const, no index checks)
+      const T&operator[](int idx) const{ ICLASSERT(super::e); return super::e[idx]; }
+    };
+
+  } // namespace core
+}
@@ -0,0 +1,573 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/src/ICLCore/ImgScaling.cpp                     **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCore/ImgScaling.h>
+#include <ICLUtils/ClippedCast.h>
+#include <ICLUtils/Macros.h>
+#include <ICLUtils/Mutex.h>
+#include <ICLUtils/SSETypes.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <vector>
+#include <cmath>
+
+using namespace icl::utils;
+
+namespace icl{
+  namespace core{
+
+    namespace{
+
+      /// images with less destination pixels are scaled in the calling thread
+      static const int SCALE_PARALLEL_MIN_PIXELS = 65536;
+
+      /// approximate number of destination pixels per parallel band
+      static const int SCALE_BAND_PIXELS = 16384;
+
+      /// fixed point precision of the icl8u bilinear interpolation
+      static const int LIN_BITS = 11;
+      static const int LIN_ONE = 1<<LIN_BITS;
+
+      /// maximum number of cached coordinate tables
+      static const unsigned int MAX_CACHED_TABLES = 16;
+
+      // {{{ coordinate tables
+
+      struct ScaleTables{
+        scalemode mode;
+        Rect srcRect;
+        Size dstSize;
+        int users;
+
+        // interpolateLIN: indices (relative to the source ROI) of the two
+        // contributing pixels and the weight of the second one
+        std::vector<int> x0,x1,y0,y1;
+        std::vector<float> xw,yw;
+        std::vector<int> xwi,ywi;
+
+        // interpolateRA: first index, number of contributing pixels and
+        // offset of the first weight in the weight list
+        std::vector<int> xb,xn,xo,yb,yn,yo;
+        std::vector<float> xa,ya;
+        int decimation;
+      };
+
+      static void create_lin_table(int offs, int srcLen, int dstLen, std::vector<int> &i0,
+                                   std::vector<int> &i1, std::vector<float> &w, std::vector<int> &wi){
+        // same mapping as the former per-pixel implementation
+        const float f = ((float)srcLen-1)/(float)dstLen;
+        i0.resize(dstLen); i1.resize(dstLen); w.resize(dstLen); wi.resize(dstLen);
+        for(int k=0;k<dstLen;++k){
+          const float s = offs + f*k;
+          i0[k] = (int)s - offs;
+          i1[k] = iclMin(i0[k]+1,srcLen-1);
+          w[k] = s - ::floor(s);
+          wi[k] = (int)(w[k]*LIN_ONE + 0.5f);
+        }
+      }
+
+      static void create_area_table(int srcLen, int dstLen, std::vector<int> &b, std::vector<int> &n,
+                                    std::vector<int> &o, std::vector<float> &w){
+        const double f = (double)srcLen/dstLen;
+        b.resize(dstLen); n.resize(dstLen); o.resize(dstLen);
+        w.clear();
+        for(int k=0;k<dstLen;++k){
+          const double s = k*f, e = (k+1)*f;
+          const int ib = iclMin((int)::floor(s),srcLen-1);
+          const int ie = iclMax(iclMin((int)::ceil(e),srcLen),ib+1);
+          b[k] = ib;
+          n[k] = ie-ib;
+          o[k] = (int)w.size();
+          double sum = 0;
+          for(int i=ib;i<ie;++i){
+            const double c = iclMax(iclMin(e,(double)(i+1)) - iclMax(s,(double)i),0.0);
+            w.push_back(c);
+            sum += c;
+          }
+          for(int i=0;i<n[k];++i){
+            w[o[k]+i] = sum > 0 ? w[o[k]+i]/sum : 1.0f/n[k];
+          }
+        }
+      }
+
+      static ScaleTables *create_tables(scalemode mode, const Rect &srcRect, const Size &dstSize){
+        ScaleTables *t = new ScaleTables;
+        t->mode = mode;
+        t->srcRect = srcRect;
+        t->dstSize = dstSize;
+        t->users = 0;
+        t->decimation = 0;
+        if(mode == interpolateLIN){
+          create_lin_table(srcRect.x,srcRect.width,dstSize.width,t->x0,t->x1,t->xw,t->xwi);
+          create_lin_table(srcRect.y,srcRect.height,dstSize.height,t->y0,t->y1,t->yw,t->ywi);
+        }else{
+          for(int k=2;k<=4;k+=2){
+            if(srcRect.width == k*dstSize.width && srcRect.height == k*dstSize.height){
+              t->decimation = k;
+            }
+          }
+          if(!t->decimation){
+            create_area_table(srcRect.width,dstSize.width,t->xb,t->xn,t->xo,t->xa);
+            create_area_table(srcRect.height,dstSize.height,t->yb,t->yn,t->yo,t->ya);
+          }
+        }
+        return t;
+      }
+
+      struct ScaleTablesCache{
+        Mutex mutex;
+        std::vector<ScaleTables*> tables; // least recently used first
+        ~ScaleTablesCache(){
+          for(unsigned int i=0;i<tables.size();++i) delete tables[i];
+        }
+      };
+
+      static ScaleTablesCache &get_tables_cache(){
+        static ScaleTablesCache cache;
+        return cache;
+      }
+
+      /// scoped access to the cached tables for a given geometry
+      struct ScaleTablesLock{
+        ScaleTables *t;
+
+        ScaleTablesLock(scalemode mode, const Rect &srcRect, const Size &dstSize):t(0){
+          ScaleTablesCache &c = get_tables_cache();
+          Mutex::Locker lock(&c.mutex);
+          for(unsigned int i=0;i<c.tables.size();++i){
+            ScaleTables *e = c.tables[i];
+            if(e->mode == mode && e->srcRect == srcRect && e->dstSize == dstSize){
+              c.tables.erase(c.tables.begin()+i);
+              t = e;
+              break;
+            }
+          }
+          if(!t) t = create_tables(mode,srcRect,dstSize);
+          ++t->users;
+          c.tables.push_back(t);
+          // tables, that are currently used by other threads are not evicted
+          for(unsigned int i=0;c.tables.size() > MAX_CACHED_TABLES && i<c.tables.size();){
+            if(c.tables[i]->users) ++i;
+            else{
+              delete c.tables[i];
+              c.tables.erase(c.tables.begin()+i);
+            }
+          }
+        }
+
+        ~ScaleTablesLock(){
+          ScaleTablesCache &c = get_tables_cache();
+          Mutex::Locker lock(&c.mutex);
+          --t->users;
+        }
+      };
+
+      // }}}
+
+      // {{{ helpers
+
+      template<class T> struct ScaleWork{ typedef float W; };
+      template<> struct ScaleWork<icl64f>{ typedef icl64f W; };
+
+      template<class T, class W>
+      inline T scale_round(W v){ return clipped_cast<W,T>(v); }
+
+  #define ICL_INSTANTIATE_SCALE_ROUND(T)                                                        \
+      template<> inline T scale_round<T,float>(float v){ return clipped_cast<float,T>(::floor(v+0.5f)); } \
+      template<> inline T scale_round<T,double>(double v){ return clipped_cast<double,T>(::floor(v+0.5)); }
+      ICL_INSTANTIATE_SCALE_ROUND(icl8u)
+      ICL_INSTANTIATE_SCALE_ROUND(icl16s)
+      ICL_INSTANTIATE_SCALE_ROUND(icl32s)
+  #undef ICL_INSTANTIATE_SCALE_ROUND
+
+      template<class T>
+      struct ScaleBand{
+        const T *src;
+        int srcLineWidth;
+        Rect srcRect;
+        T *dst;
+        int dstLineWidth;
+        Rect dstRect;
+        const ScaleTables *t;
+
+        inline const T *srcRow(int y) const{
+          return src + (long)(srcRect.y+y)*srcLineWidth + srcRect.x;
+        }
+        inline T *dstRow(int y) const{
+          return dst + (long)(dstRect.y+y)*dstLineWidth + dstRect.x;
+        }
+
+        void operator()(int begin, int end) const;
+      };
+
+      // }}}
+
+      // {{{ interpolateLIN
+
+      // vertical blending of two source lines: v = w0*a + w1*b
+      template<class T, class W>
+      inline void lin_vertical(const T *a, const T *b, int n, W w0, W w1, W *v){
+        for(int i=0;i<n;++i) v[i] = w0*a[i] + w1*b[i];
+      }
+
+  #ifdef ICL_HAVE_SSE2
+      template<>
+      inline void lin_vertical(const icl32f *a, const icl32f *b, int n, float w0, float w1, float *v){
+        const __m128 vw0 = _mm_set1_ps(w0), vw1 = _mm_set1_ps(w1);
+        int i=0;
+        for(;i<=n-4;i+=4){
+          _mm_storeu_ps(v+i,_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a+i),vw0),
+                                       _mm_mul_ps(_mm_loadu_ps(b+i),vw1)));
+        }
+        for(;i<n;++i) v[i] = w0*a[i] + w1*b[i];
+      }
+
+      inline __m128 load_16s_as_float(const icl16s *p){
+        const __m128i v = _mm_loadl_epi64((const __m128i*)p);
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v,v),16));
+      }
+
+      template<>
+      inline void lin_vertical(const icl16s *a, const icl16s *b, int n, float w0, float w1, float *v){
+        const __m128 vw0 = _mm_set1_ps(w0), vw1 = _mm_set1_ps(w1);
+        int i=0;
+        for(;i<=n-4;i+=4){
+          _mm_storeu_ps(v+i,_mm_add_ps(_mm_mul_ps(load_16s_as_float(a+i),vw0),
+                                       _mm_mul_ps(load_16s_as_float(b+i),vw1)));
+        }
+        for(;i<n;++i) v[i] = w0*a[i] + w1*b[i];
+      }
+  #endif
+
+      // fixed point version: v = (LIN_ONE-w)*a + w*b
+      inline void lin_vertical_8u(const icl8u *a, const icl8u *b, int n, int w, int *v){
+        const int w0 = LIN_ONE-w;
+        int i=0;
+  #ifdef ICL_HAVE_SSE2
+        // a and b are interleaved as 16 bit values, so that madd computes a*w0 + b*w
+        const __m128i vw = _mm_set1_epi32(w0 | (w << 16));
+        const __m128i z = _mm_setzero_si128();
+        for(;i<=n-16;i+=16){
+          const __m128i va = _mm_loadu_si128((const __m128i*)(a+i));
+          const __m128i vb = _mm_loadu_si128((const __m128i*)(b+i));
+          const __m128i al = _mm_unpacklo_epi8(va,z), ah = _mm_unpackhi_epi8(va,z);
+          const __m128i bl = _mm_unpacklo_epi8(vb,z), bh = _mm_unpackhi_epi8(vb,z);
+          _mm_storeu_si128((__m128i*)(v+i),   _mm_madd_epi16(_mm_unpacklo_epi16(al,bl),vw));
+          _mm_storeu_si128((__m128i*)(v+i+4), _mm_madd_epi16(_mm_unpackhi_epi16(al,bl),vw));
+          _mm_storeu_si128((__m128i*)(v+i+8), _mm_madd_epi16(_mm_unpacklo_epi16(ah,bh),vw));
+          _mm_storeu_si128((__m128i*)(v+i+12),_mm_madd_epi16(_mm_unpackhi_epi16(ah,bh),vw));
+        }
+  #endif
+        for(;i<n;++i) v[i] = a[i]*w0 + b[i]*w;
+      }
+
+      template<class T>
+      void lin_rows(const ScaleBand<T> &s, int begin, int end){
+        typedef typename ScaleWork<T>::W W;
+        const ScaleTables &t = *s.t;
+        const int w = s.dstRect.width;
+        std::vector<W> buf(s.srcRect.width);
+        for(int y=begin;y<end;++y){
+          const W wy = t.yw[y];
+          lin_vertical(s.srcRow(t.y0[y]),s.srcRow(t.y1[y]),s.srcRect.width,W(1)-wy,wy,&buf[0]);
+          T *d = s.dstRow(y);
+          for(int x=0;x<w;++x){
+            const W wx = t.xw[x];
+            d[x] = scale_round<T,W>((W(1)-wx)*buf[t.x0[x]] + wx*buf[t.x1[x]]);
+          }
+        }
+      }
+
+      template<>
+      void lin_rows(const ScaleBand<icl8u> &s, int begin, int end){
+        static const int ROUND = 1 << (2*LIN_BITS-1);
+        const ScaleTables &t = *s.t;
+        const int w = s.dstRect.width;
+        std::vector<int> buf(s.srcRect.width);
+        const int *x0 = &t.x0[0], *x1 = &t.x1[0], *xw = &t.xwi[0];
+        for(int y=begin;y<end;++y){
+          lin_vertical_8u(s.srcRow(t.y0[y]),s.srcRow(t.y1[y]),s.srcRect.width,t.ywi[y],&buf[0]);
+          const int *v = &buf[0];
+          icl8u *d = s.dstRow(y);
+          for(int x=0;x<w;++x){
+            d[x] = (icl8u)((v[x0[x]]*(LIN_ONE-xw[x]) + v[x1[x]]*xw[x] + ROUND) >> (2*LIN_BITS));
+          }
+        }
+      }
+
+      // }}}
+
+      // {{{ interpolateRA
+
+      // acc (+)= w*row
+      template<class T, class W>
+      inline void area_accumulate(const T *row, int n, W w, W *acc, bool first){
+        if(first) for(int i=0;i<n;++i) acc[i] = w*row[i];
+        else for(int i=0;i<n;++i) acc[i] += w*row[i];
+      }
+
+  #ifdef ICL_HAVE_SSE2
+      template<>
+      inline void area_accumulate(const icl8u *row, int n, float w, float *acc, bool first){
+        const __m128 vw = _mm_set1_ps(w);
+        const __m128i z = _mm_setzero_si128();
+        int i=0;
+        for(;i<=n-8;i+=8){
+          const __m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(row+i)),z);
+          __m128 lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(p,z)),vw);
+          __m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(p,z)),vw);
+          if(!first){
+            lo = _mm_add_ps(lo,_mm_loadu_ps(acc+i));
+            hi = _mm_add_ps(hi,_mm_loadu_ps(acc+i+4));
+          }
+          _mm_storeu_ps(acc+i,lo);
+          _mm_storeu_ps(acc+i+4,hi);
+        }
+        for(;i<n;++i) acc[i] = (first ? 0.0f : acc[i]) + w*row[i];
+      }
+
+      template<>
+      inline void area_accumulate(const icl16s *row, int n, float w, float *acc, bool first){
+        const __m128 vw = _mm_set1_ps(w);
+        int i=0;
+        for(;i<=n-4;i+=4){
+          __m128 v = _mm_mul_ps(load_16s_as_float(row+i),vw);
+          if(!first) v = _mm_add_ps(v,_mm_loadu_ps(acc+i));
+          _mm_storeu_ps(acc+i,v);
+        }
+        for(;i<n;++i) acc[i] = (first ? 0.0f : acc[i]) + w*row[i];
+      }
+
+      template<>
+      inline void area_accumulate(const icl32f *row, int n, float w, float *acc, bool first){
+        const __m128 vw = _mm_set1_ps(w);
+        int i=0;
+        for(;i<=n-4;i+=4){
+          __m128 v = _mm_mul_ps(_mm_loadu_ps(row+i),vw);
+          if(!first) v = _mm_add_ps(v,_mm_loadu_ps(acc+i));
+          _mm_storeu_ps(acc+i,v);
+        }
+        for(;i<n;++i) acc[i] = (first ? 0.0f : acc[i]) + w*row[i];
+      }
+  #endif
+
+      template<class T>
+      void area_rows(const ScaleBand<T> &s, int begin, int end){
+        typedef typename ScaleWork<T>::W W;
+        const ScaleTables &t = *s.t;
+        const int w = s.dstRect.width;
+        std::vector<W> acc(s.srcRect.width);
+        for(int y=begin;y<end;++y){
+          const float *wy = &t.ya[0] + t.yo[y];
+          for(int k=0;k<t.yn[y];++k){
+            area_accumulate(s.srcRow(t.yb[y]+k),s.srcRect.width,(W)wy[k],&acc[0],k==0);
+          }
+          T *d = s.dstRow(y);
+          for(int x=0;x<w;++x){
+            const float *wx = &t.xa[0] + t.xo[x];
+            const W *a = &acc[0] + t.xb[x];
+            W sum = 0;
+            for(int j=0;j<t.xn[x];++j) sum += wx[j]*a[j];
+            d[x] = scale_round<T,W>(sum);
+          }
+        }
+      }
+
+      // exact k x k box filter for sizes that are exactly k times the destination size
+      template<class T> struct DecimationSum{ typedef double S; };
+      template<> struct DecimationSum<icl8u>{ typedef int S; };
+      template<> struct DecimationSum<icl16s>{ typedef int S; };
+
+      template<int K, class T>
+      void decimate_rows_k(const ScaleBand<T> &s, int begin, int end){
+        typedef typename DecimationSum<T>::S S;
+        const int w = s.dstRect.width;
+        const double norm = 1.0/(K*K);
+        for(int y=begin;y<end;++y){
+          const T *r[K];
+          for(int dy=0;dy<K;++dy) r[dy] = s.srcRow(K*y+dy);
+          T *d = s.dstRow(y);
+          for(int x=0;x<w;++x){
+            S sum = 0;
+            for(int dy=0;dy<K;++dy){
+              const T *p = r[dy] + K*x;
+              for(int dx=0;dx<K;++dx) sum += p[dx];
+            }
+            d[x] = scale_round<T,double>(sum*norm);
+          }
+        }
+      }
+
+      template<class T>
+      void decimate_rows(const ScaleBand<T> &s, int k, int begin, int end){
+        if(k == 2) decimate_rows_k<2>(s,begin,end);
+        else decimate_rows_k<4>(s,begin,end);
+      }
+
+  #ifdef ICL_HAVE_SSE2
+      // sums of horizontally adjacent byte pairs as 8 16 bit values
+      inline __m128i pair_sums_8u(const __m128i &v){
+        const __m128i m = _mm_set1_epi16(0x00ff);
+        return _mm_add_epi16(_mm_and_si128(v,m),_mm_srli_epi16(v,8));
+      }
+
+      inline __m128i quad_sums_8u(const icl8u *r0, const icl8u *r1, const icl8u *r2, const icl8u *r3){
+        // 4 rows x 16 bytes -> 4 box sums as 32 bit values
+        const __m128i s = _mm_add_epi16(_mm_add_epi16(pair_sums_8u(_mm_loadu_si128((const __m128i*)r0)),
+                                                      pair_sums_8u(_mm_loadu_si128((const __m128i*)r1))),
+                                        _mm_add_epi16(pair_sums_8u(_mm_loadu_si128((const __m128i*)r2)),
+                                                      pair_sums_8u(_mm_loadu_si128((const __m128i*)r3))));
+        return _mm_madd_epi16(s,_mm_set1_epi16(1));
+      }
+
+      template<>
+      void decimate_rows(const ScaleBand<icl8u> &s, int k, int begin, int end){
+        const int w = s.dstRect.width;
+        for(int y=begin;y<end;++y){
+          icl8u *d = s.dstRow(y);
+          int x = 0;
+          if(k == 2){
+            const icl8u *r0 = s.srcRow(2*y), *r1 = s.srcRow(2*y+1);
+            const __m128i two = _mm_set1_epi16(2);
+            for(;x<=w-16;x+=16){
+              const __m128i lo = _mm_add_epi16(pair_sums_8u(_mm_loadu_si128((const __m128i*)(r0+2*x))),
+                                               pair_sums_8u(_mm_loadu_si128((const __m128i*)(r1+2*x))));
+              const __m128i hi = _mm_add_epi16(pair_sums_8u(_mm_loadu_si128((const __m128i*)(r0+2*x+16))),
+                                               pair_sums_8u(_mm_loadu_si128((const __m128i*)(r1+2*x+16))));
+              _mm_storeu_si128((__m128i*)(d+x),_mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo,two),2),
+                                                                _mm_srli_epi16(_mm_add_epi16(hi,two),2)));
+            }
+            for(;x<w;++x){
+              d[x] = (icl8u)((r0[2*x]+r0[2*x+1]+r1[2*x]+r1[2*x+1]+2) >> 2);
+            }
+          }else{
+            const icl8u *r[4] = { s.srcRow(4*y), s.srcRow(4*y+1), s.srcRow(4*y+2), s.srcRow(4*y+3) };
+            const __m128i eight = _mm_set1_epi32(8);
+            for(;x<=w-16;x+=16){
+              __m128i q[4];
+              for(int i=0;i<4;++i){
+                const int o = 4*x+16*i;
+                q[i] = _mm_srli_epi32(_mm_add_epi32(quad_sums_8u(r[0]+o,r[1]+o,r[2]+o,r[3]+o),eight),4);
+              }
+              _mm_storeu_si128((__m128i*)(d+x),_mm_packus_epi16(_mm_packs_epi32(q[0],q[1]),
+                                                                _mm_packs_epi32(q[2],q[3])));
+            }
+            for(;x<w;++x){
+              int sum = 8;
+              for(int i=0;i<4;++i){
+                const icl8u *p = r[i]+4*x;
+                sum += p[0]+p[1]+p[2]+p[3];
+              }
+              d[x] = (icl8u)(sum >> 4);
+            }
+          }
+        }
+      }
+
+      template<>
+      void decimate_rows(const ScaleBand<icl32f> &s, int k, int begin, int end){
+        if(k != 2){
+          const int w = s.dstRect.width;
+          for(int y=begin;y<end;++y){
+            icl32f *d = s.dstRow(y);
+            for(int x=0;x<w;++x){
+              float sum = 0;
+              for(int dy=0;dy<4;++dy){
+                const icl32f *p = s.srcRow(4*y+dy) + 4*x;
+                sum += (p[0]+p[1]) + (p[2]+p[3]);
+              }
+              d[x] = sum * (1.0f/16);
+            }
+          }
+          return;
+        }
+        const int w = s.dstRect.width;
+        const __m128 q = _mm_set1_ps(0.25f);
+        for(int y=begin;y<end;++y){
+          const icl32f *r0 = s.srcRow(2*y), *r1 = s.srcRow(2*y+1);
+          icl32f *d = s.dstRow(y);
+          int x=0;
+          for(;x<=w-4;x+=4){
+            const __m128 a = _mm_add_ps(_mm_loadu_ps(r0+2*x),_mm_loadu_ps(r1+2*x));
+            const __m128 b = _mm_add_ps(_mm_loadu_ps(r0+2*x+4),_mm_loadu_ps(r1+2*x+4));
+            const __m128 h = _mm_add_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0)),
+                                        _mm_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1)));
+            _mm_storeu_ps(d+x,_mm_mul_ps(h,q));
+          }
+          for(;x<w;++x){
+            d[x] = ((r0[2*x]+r1[2*x]) + (r0[2*x+1]+r1[2*x+1])) * 0.25f;
+          }
+        }
+      }
+  #endif
+
+      // }}}
+
+      template<class T>
+      void ScaleBand<T>::operator()(int begin, int end) const{
+        if(t->mode == interpolateLIN) lin_rows(*this,begin,end);
+        else if(t->decimation) decimate_rows(*this,t->decimation,begin,end);
+        else area_rows(*this,begin,end);
+      }
+
+    } // anonymous namespace
+
+    template<class T>
+    bool scaleChannelROI(const T *src, int srcLineWidth, const Rect &srcRect,
+                         T *dst, int dstLineWidth, const Rect &dstRect,
+                         scalemode mode){
+      if(mode != interpolateLIN && mode != interpolateRA) return false;
+      if(srcRect.width <= 0 || srcRect.height <= 0 || dstRect.width <= 0 || dstRect.height <= 0) return true;
+
+      ScaleTablesLock tables(mode,srcRect,dstRect.getSize());
+      ScaleBand<T> band;
+      band.src = src;
+      band.srcLineWidth = srcLineWidth;
+      band.srcRect = srcRect;
+      band.dst = dst;
+      band.dstLineWidth = dstLineWidth;
+      band.dstRect = dstRect;
+      band.t = tables.t;
+
+      if(dstRect.getDim() < SCALE_PARALLEL_MIN_PIXELS){
+        band(0,dstRect.height);
+      }else{
+        parallel_for(0,dstRect.height,band,iclMax(1,SCALE_BAND_PIXELS/dstRect.width));
+      }
+      return true;
+    }
+
+  #define ICL_INSTANTIATE_DEPTH(D)                                                        \
+    template ICLCore_API bool scaleChannelROI<icl##D>(const icl##D*,int,const Rect&,      \
+                                                      icl##D*,int,const Rect&,scalemode);
+    ICL_INSTANTIATE_ALL_DEPTHS
+  #undef ICL_INSTANTIATE_DEPTH
+
+  } // namespace core
+} // namespace icl
@@ -0,0 +1,81 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/src/ICLCore/ImgScaling.h                       **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Rect.h>
+#include <ICLCore/Types.h>
+
+namespace icl{
+  namespace core{
+
+    /// scales a single channel ROI using linear or region-average interpolation \ingroup IMAGE
+    /** This is the engine behind Img<T>::scaledCopy and Img<T>::scaledCopyROI
+        for builds without IPP. Source and destination are given as plain
+        channel pointers with their line widths (in pixels) and the rectangles
+        that are to be mapped onto each other.
+
+        \section LIN interpolateLIN
+        Bilinear interpolation is computed separably: the two source lines
+        that contribute to a destination line are first blended vertically
+        (SIMD, across the whole source ROI width), then the blended line is
+        interpolated horizontally using precomputed index/weight tables.
+        icl8u data is processed in 11 bit fixed point arithmetics, all other
+        depths use floating point arithmetics. The mapping of destination to
+        source coordinates is identical to the former scalar implementation
+        (x_src = roi.x + x_dst * (roi.width-1)/dst.width).
+
+        \section RA interpolateRA
+        Region average interpolation is also computed separably: each
+        destination pixel is the normalized area-weighted sum of the source
+        pixels, that are covered by the back-projected destination pixel.
+        If the source size is exactly 2 or 4 times the destination size,
+        dedicated decimation kernels (exact box filter with integer sums) are
+        used.
+
+        \section TAB Coordinate Tables
+        Index and weight tables depend only on the source ROI and destination
+        size. They are cached internally (for the last 16 geometries), so that
+        scaling frames of a video stream does not recompute them.
+
+        \section PAR Parallelism
+        Large destination images are processed in bands of rows using
+        utils::parallel_for.
+
+        Integer results are rounded to the nearest value. Returns false,
+        if the given scalemode is not supported (i.e. interpolateNN) */
+    template<class T>
+    ICLCore_API bool scaleChannelROI(const T *src, int srcLineWidth, const utils::Rect &srcRect,
+                                     T *dst, int dstLineWidth, const utils::Rect &dstRect,
+                                     scalemode mode);
+
+  } // namespace core
+} // namespace icl
@@ -32,7 +32,7 @@
 
 #include <ICLUtils/CompatMacros.h>
 #include <ICLCore/Types.h>
-#include <ICLUtils/SmartArray.h>
+#include <ICLCore/ImgChannelPool.h>
 #include <ICLUtils/Exception.h>
 #include <ICLUtils/Macros.h>
 #include <ICLMath/FixedMatrix.h>
@@ -72,7 +72,7 @@ namespace icl{
   
       /// single constructor to create a pixelref instance
       /** This should not be used manually. Rather you should use Img<T>'s operator()(int x, int y) */
-      inline PixelRef(int x, int y, int width, std::vector<utils::SmartArray<T> > &data):
+      inline PixelRef(int x, int y, int width, std::vector<ImgChannelArray<T> > &data):
       m_data(data.size()){
         int offs = x+width*y;
         for(unsigned int i=0;i<data.size();++i){
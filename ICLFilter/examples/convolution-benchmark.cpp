@@ -0,0 +1,170 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/examples/convolution-benchmark.cpp           **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLFilter/ConvolutionOp.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/Random.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/CPUFeatures.h>
+#include <ICLUtils/Time.h>
+#include <cmath>
+#include <cstdlib>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::filter;
+
+// random test image in a range, that the scalar 3x3 code does not overflow
+ImgBase *create_image(depth d, const Size &size, int channels){
+  ImgBase *image = imgNew(d,size,channels);
+  for(int c=0;c<channels;++c){
+    switch(d){
+      case depth8u: {
+        icl8u *p = image->asImg<icl8u>()->begin(c), *e = image->asImg<icl8u>()->end(c);
+        for(;p!=e;++p) *p = rand() % 256;
+        break;
+      }
+      case depth16s: {
+        icl16s *p = image->asImg<icl16s>()->begin(c), *e = image->asImg<icl16s>()->end(c);
+        for(;p!=e;++p) *p = rand() % 2048 - 1024;
+        break;
+      }
+      case depth32f: {
+        icl32f *p = image->asImg<icl32f>()->begin(c), *e = image->asImg<icl32f>()->end(c);
+        for(;p!=e;++p) *p = float(rand() % 25600) / 100;
+        break;
+      }
+      default: break;
+    }
+  }
+  return image;
+}
+
+template<class T>
+double max_diff(const Img<T> &a, const Img<T> &b){
+  double d = 0;
+  const Size s = a.getROISize();
+  for(int c=0;c<a.getChannels();++c){
+    for(int y=0;y<s.height;++y){
+      const T *pa = a.getROIData(c) + y*a.getWidth();
+      const T *pb = b.getROIData(c) + y*b.getWidth();
+      for(int x=0;x<s.width;++x){
+        d = iclMax(d,std::fabs(double(pa[x]) - double(pb[x])));
+      }
+    }
+  }
+  return d;
+}
+
+double max_diff(const ImgBase *a, const ImgBase *b){
+  switch(a->getDepth()){
+#define ICL_INSTANTIATE_DEPTH(D) case depth##D: return max_diff(*a->asImg<icl##D>(),*b->asImg<icl##D>());
+    ICL_INSTANTIATE_ALL_DEPTHS;
+#undef ICL_INSTANTIATE_DEPTH
+  }
+  return 0;
+}
+
+// returns the average time per apply call in ms
+double benchmark(ConvolutionOp &op, const ImgBase *src, ImgBase **dst, int n){
+  op.apply(src,dst); // warm up and setup of the destination image
+  Time t = Time::now();
+  for(int i=0;i<n;++i){
+    op.apply(src,dst);
+  }
+  return t.age().toMilliSecondsDouble()/n;
+}
+
+int main(int n, char **ppc){
+  pa_explain("-size","source image size")
+            ("-n","number of apply calls per measurement")
+            ("-channels","number of source image channels");
+  pa_init(n,ppc,"-size|-s(Size=VGA) -n(int=20) -channels|-c(int=1)");
+
+  const Size size = pa("-size");
+  const int N = pa("-n"), channels = pa("-channels");
+
+  std::cout << "image size: " << size << "  channels: " << channels
+            << "  AVX2 supported: " << (cpu_supports(cpuAVX2) ? "yes" : "no") << std::endl;
+
+  // non-separable 7x7 integer kernel for the 'custom' case
+  int customData[49];
+  for(int i=0;i<49;++i) customData[i] = rand() % 11 - 5;
+  const ConvolutionKernel custom(customData,Size(7,7),49);
+
+  const ConvolutionKernel::fixedType types[] = {
+    ConvolutionKernel::gauss3x3, ConvolutionKernel::gauss5x5,
+    ConvolutionKernel::sobelX3x3, ConvolutionKernel::sobelX5x5,
+    ConvolutionKernel::sobelY3x3, ConvolutionKernel::sobelY5x5,
+    ConvolutionKernel::laplace3x3, ConvolutionKernel::laplace5x5,
+    ConvolutionKernel::custom
+  };
+  const char *names[] = { "gauss3x3", "gauss5x5", "sobelX3x3", "sobelX5x5", "sobelY3x3",
+                          "sobelY5x5", "laplace3x3", "laplace5x5", "custom7x7" };
+  const depth depths[] = { depth8u, depth16s, depth32f };
+
+  TextTable table;
+  table[0] = tok("kernel,depth,scalar [ms],SSE2 [ms],auto [ms],speedup,max. diff",",");
+
+  for(int d=0;d<3;++d){
+    ImgBase *src = create_image(depths[d],size,channels);
+    for(int t=0;t<9;++t){
+      ConvolutionKernel k = types[t] == ConvolutionKernel::custom ? custom : ConvolutionKernel(types[t]);
+      ConvolutionOp op(k);
+      ImgBase *ref = 0, *dst = 0;
+
+      op.setSIMDMode(ConvolutionOp::simdOff);
+      const double tScalar = benchmark(op,src,&ref,N);
+      op.setSIMDMode(ConvolutionOp::simdSSE2);
+      const double tSSE2 = benchmark(op,src,&dst,N);
+      double diff = max_diff(ref,dst);
+      op.setSIMDMode(ConvolutionOp::simdAuto);
+      const double tAuto = benchmark(op,src,&dst,N);
+      diff = iclMax(diff,max_diff(ref,dst));
+
+      const int row = table.getSize().height;
+      table(0,row) = names[t];
+      table(1,row) = str(depths[d]);
+      table(2,row) = str(tScalar);
+      table(3,row) = str(tSSE2);
+      table(4,row) = str(tAuto);
+      table(5,row) = str(tScalar/tAuto);
+      table(6,row) = str(diff);
+
+      ICL_DELETE(ref);
+      ICL_DELETE(dst);
+    }
+    ICL_DELETE(src);
+  }
+  std::cout << table << std::endl;
+}
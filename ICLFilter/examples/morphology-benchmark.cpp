@@ -0,0 +1,138 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/examples/morphology-benchmark.cpp            **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLFilter/MorphologicalOp.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Time.h>
+#include <cmath>
+#include <cstdlib>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::filter;
+
+ImgBase *create_image(depth d, const Size &size, int channels){
+  ImgBase *image = imgNew(d,size,channels);
+  for(int c=0;c<channels;++c){
+    if(d == depth8u){
+      icl8u *p = image->asImg<icl8u>()->begin(c), *e = image->asImg<icl8u>()->end(c);
+      for(;p!=e;++p) *p = rand() % 256;
+    }else{
+      icl32f *p = image->asImg<icl32f>()->begin(c), *e = image->asImg<icl32f>()->end(c);
+      for(;p!=e;++p) *p = float(rand() % 25600) / 100;
+    }
+  }
+  return image;
+}
+
+template<class T>
+double max_diff(const Img<T> &a, const Img<T> &b){
+  double d = 0;
+  const Size s = a.getROISize();
+  for(int c=0;c<a.getChannels();++c){
+    for(int y=0;y<s.height;++y){
+      const T *pa = a.getROIData(c) + y*a.getWidth();
+      const T *pb = b.getROIData(c) + y*b.getWidth();
+      for(int x=0;x<s.width;++x){
+        d = iclMax(d,std::fabs(double(pa[x]) - double(pb[x])));
+      }
+    }
+  }
+  return d;
+}
+
+double max_diff(const ImgBase *a, const ImgBase *b){
+  if(a->getROISize() != b->getROISize()) return -1;
+  if(a->getDepth() == depth8u) return max_diff(*a->asImg<icl8u>(),*b->asImg<icl8u>());
+  return max_diff(*a->asImg<icl32f>(),*b->asImg<icl32f>());
+}
+
+// returns the average time per apply call in ms
+double benchmark(MorphologicalOp &op, const ImgBase *src, ImgBase **dst, int n){
+  op.apply(src,dst); // warm up and setup of the destination image
+  Time t = Time::now();
+  for(int i=0;i<n;++i){
+    op.apply(src,dst);
+  }
+  return t.age().toMilliSecondsDouble()/n;
+}
+
+int main(int n, char **ppc){
+  pa_explain("-size","source image size")
+            ("-n","number of apply calls per measurement (the generic implementation "
+             "uses less calls for larger masks)")
+            ("-channels","number of source image channels")
+            ("-op","morphological operation (dilate, erode, openBorder, gradientBorder, ...)")
+            ("-max-mask-size","largest mask size (mask sizes 3,5,...,max-mask-size are tested)");
+  pa_init(n,ppc,"-size|-s(Size=VGA) -n(int=10) -channels|-c(int=1) -op(string=dilate) "
+          "-max-mask-size|-m(int=31)");
+
+  const Size size = pa("-size");
+  const int N = pa("-n"), channels = pa("-channels"), maxMaskSize = pa("-max-mask-size");
+  const std::string optype = pa("-op");
+
+  std::cout << "image size: " << size << "  channels: " << channels
+            << "  operation: " << optype << std::endl;
+
+  const depth depths[] = { depth8u, depth32f };
+
+  TextTable table;
+  table[0] = tok("mask,depth,generic [ms],van Herk/Gil-Werman [ms],speedup,max. diff",",");
+
+  for(int d=0;d<2;++d){
+    ImgBase *src = create_image(depths[d],size,channels);
+    for(int m=3;m<=maxMaskSize;m+=2){
+      MorphologicalOp op(optype,Size(m,m));
+      ImgBase *ref = 0, *dst = 0;
+
+      op.setRectangularFastPath(false);
+      const double tGeneric = benchmark(op,src,&ref,iclMax(1,N*9/(m*m)));
+      op.setRectangularFastPath(true);
+      const double tFast = benchmark(op,src,&dst,N);
+
+      const int row = table.getSize().height;
+      table(0,row) = str(m) + "x" + str(m);
+      table(1,row) = str(depths[d]);
+      table(2,row) = str(tGeneric);
+      table(3,row) = str(tFast);
+      table(4,row) = str(tGeneric/tFast);
+      table(5,row) = str(max_diff(ref,dst));
+
+      ICL_DELETE(ref);
+      ICL_DELETE(dst);
+    }
+    ICL_DELETE(src);
+  }
+  std::cout << table << std::endl;
+}
@@ -0,0 +1,164 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/examples/warp-benchmark.cpp                  **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLFilter/WarpOp.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Time.h>
+#include <cmath>
+#include <cstdlib>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::filter;
+
+// radial lens distortion map (as created for grabber undistortion)
+Img32f create_warp_map(const Size &size){
+  Img32f map(size,2);
+  const float cx = size.width/2.0f, cy = size.height/2.0f;
+  const float k = 0.25f/(cx*cx + cy*cy);
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      const float dx = x-cx, dy = y-cy, f = 1 + k*(dx*dx + dy*dy);
+      map(x,y,0) = cx + dx*f;
+      map(x,y,1) = cy + dy*f;
+    }
+  }
+  return map;
+}
+
+// the former per-pixel implementation: column-major traversal and one
+// interpolator call via function pointer for each pixel
+// pixels, whose rounded source position is outside the image are set to 0
+template<class T>
+inline bool ref_valid(float x, float y, const Channel<T> &src){
+  return x > -0.5f && y > -0.5f && x < src.getWidth()-0.5f && y < src.getHeight()-0.5f;
+}
+
+template<class T>
+T ref_nn(float x, float y, const Channel<T> &src){
+  if(!ref_valid(x,y,src)) return T(0);
+  return src(round(x),round(y));
+}
+
+template<class T>
+T ref_lin(float x, float y, const Channel<T> &src){
+  if(!ref_valid(x,y,src)) return T(0);
+  x = clip(x,0.0f,src.getWidth()-1.0f);
+  y = clip(y,0.0f,src.getHeight()-1.0f);
+  const int xll = iclMin((int)x,src.getWidth()-2), yll = iclMin((int)y,src.getHeight()-2);
+  const float fX0 = x - xll, fX1 = 1.0 - fX0;
+  const float fY0 = y - yll, fY1 = 1.0 - fY0;
+  const T* p = &src(xll,yll);
+  const int w = src.getWidth();
+  return clipped_cast<float,T>(fX1 * (fY1*p[0] + fY0*p[w]) + fX0 * (fY1*p[1] + fY0*p[w+1]));
+}
+
+template<class T>
+void ref_warp(const Img32f &map, const Img<T> &src, Img<T> &dst, scalemode mode){
+  T (*interpolator)(float, float, const Channel<T>&) = mode == interpolateNN ? ref_nn<T> : ref_lin<T>;
+  const Size size = src.getSize();
+  for(int c=0;c<src.getChannels();++c){
+    const Channel<T> s = src[c];
+    Channel<T> d = dst[c];
+    for(int x=0;x<size.width;++x){
+      for(int y=0;y<size.height;++y){
+        const int idx = x+size.width*y;
+        d[idx] = interpolator(map.begin(0)[idx],map.begin(1)[idx],s);
+      }
+    }
+  }
+}
+
+template<class T>
+double max_diff(const Img<T> &a, const Img<T> &b){
+  double d = 0;
+  for(int c=0;c<a.getChannels();++c){
+    for(int i=0;i<a.getDim();++i){
+      d = iclMax(d,std::fabs(double(a.begin(c)[i]) - double(b.begin(c)[i])));
+    }
+  }
+  return d;
+}
+
+template<class T>
+void benchmark(TextTable &table, const Size &size, scalemode mode, int n){
+  Img<T> src(size,formatRGB), ref(size,formatRGB);
+  for(int c=0;c<3;++c){
+    for(T *p=src.begin(c);p!=src.end(c);++p) *p = T(rand() % 256);
+  }
+  const Img32f map = create_warp_map(size);
+
+  Time t = Time::now();
+  for(int i=0;i<n;++i) ref_warp(map,src,ref,mode);
+  const double tRef = t.age().toMilliSecondsDouble()/n;
+
+  WarpOp op(map,mode);
+  t = Time::now();
+  const ImgBase *dst = op.apply(&src); // includes compiling the table
+  const double tFirst = t.age().toMilliSecondsDouble();
+  t = Time::now();
+  for(int i=0;i<n;++i) dst = op.apply(&src);
+  const double tOp = t.age().toMilliSecondsDouble()/n;
+
+  const int row = table.getSize().height;
+  table(0,row) = str(size);
+  table(1,row) = str(src.getDepth()).substr(5);
+  table(2,row) = mode == interpolateNN ? "NN" : "LIN";
+  table(3,row) = str(tRef);
+  table(4,row) = str(tFirst);
+  table(5,row) = str(tOp);
+  table(6,row) = str(tRef/tOp);
+  table(7,row) = str(max_diff(ref,*dst->asImg<T>()));
+}
+
+int main(int n, char **ppc){
+  pa_explain("-n","number of iterations per measurement");
+  pa_init(n,ppc,"-n(int=5)");
+  const int N = pa("-n");
+
+  TextTable table;
+  table[0] = tok("size,depth,mode,former [ms],first apply [ms],WarpOp [ms],speedup,max. diff",",");
+
+  const Size sizes[] = { Size::VGA, Size::HD720, Size::HD1080 };
+  for(int s=0;s<3;++s){
+    for(int m=0;m<2;++m){
+      const scalemode mode = m ? interpolateLIN : interpolateNN;
+      benchmark<icl8u>(table,sizes[s],mode,N);
+      benchmark<icl16s>(table,sizes[s],mode,N);
+      benchmark<icl32f>(table,sizes[s],mode,N);
+    }
+  }
+  std::cout << "3-channel images, radial distortion warp map" << std::endl;
+  std::cout << table << std::endl;
+}
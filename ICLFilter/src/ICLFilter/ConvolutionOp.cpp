@@ -29,8 +29,13 @@
 ********************************************************************/
 
 #include <ICLFilter/ConvolutionOp.h>
+#include <ICLFilter/ConvolutionOpSIMD.h>
 #include <ICLCore/Img.h>
+#include <ICLUtils/CPUFeatures.h>
 #include <limits>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
 
 using namespace icl::utils;
 using namespace icl::core;
@@ -209,11 +214,209 @@ namespace icl{
   #endif //ICL_HAVE_IPP
   
   
+#ifndef ICL_HAVE_IPP
+      /// exact factorization of an integer kernel into a column and a row vector (if possible)
+      bool factorize_kernel(const int *k, int w, int h, std::vector<int> &row, std::vector<int> &col){
+        int pr = -1, pc = -1;
+        for(int i=0;i<w*h;++i){
+          if(k[i]){ pr = i/w; pc = i%w; break; }
+        }
+        if(pr < 0) return false;
+        const long long p = k[pr*w+pc];
+        for(int y=0;y<h;++y){
+          for(int x=0;x<w;++x){
+            if((long long)k[y*w+x] * p != (long long)k[y*w+pc] * k[pr*w+x]) return false;
+          }
+        }
+        // the pivot row divided by the gcd of its elements is a valid row vector
+        // for integer kernels, all other rows are integer multiples of it
+        int g = 0;
+        for(int x=0;x<w;++x){
+          int a = std::abs(k[pr*w+x]);
+          while(a){ int t = g % a; g = a; a = t; }
+        }
+        row.resize(w);
+        col.resize(h);
+        for(int x=0;x<w;++x) row[x] = k[pr*w+x] / g;
+        for(int y=0;y<h;++y) col[y] = k[y*w+pc] / row[pc];
+        return true;
+      }
+
+      /// factorization of a float kernel into a column and a row vector (with a relative tolerance of 1e-6)
+      bool factorize_kernel(const float *k, int w, int h, std::vector<float> &row, std::vector<float> &col){
+        int pi = 0;
+        for(int i=1;i<w*h;++i){
+          if(std::fabs(k[i]) > std::fabs(k[pi])) pi = i;
+        }
+        const float maxAbs = std::fabs(k[pi]);
+        if(maxAbs == 0) return false;
+        const int pr = pi/w, pc = pi%w;
+        row.resize(w);
+        col.resize(h);
+        for(int x=0;x<w;++x) row[x] = k[pr*w+x];
+        for(int y=0;y<h;++y) col[y] = k[y*w+pc] / k[pi];
+        for(int y=0;y<h;++y){
+          for(int x=0;x<w;++x){
+            if(std::fabs(col[y]*row[x] - k[y*w+x]) > 1e-6 * maxAbs) return false;
+          }
+        }
+        return true;
+      }
+
+      /// SIMD job format for the given kernel/source/destination type (-1 if not supported)
+      template<class KernelType, class SrcType, class DstType> struct SIMDConvolutionFormat { static const int value = -1; };
+      template<> struct SIMDConvolutionFormat<int,icl8u,icl8u> { static const int value = SIMDConvolutionJob::format8u8u; };
+      template<> struct SIMDConvolutionFormat<int,icl8u,icl16s> { static const int value = SIMDConvolutionJob::format8u16s; };
+      template<> struct SIMDConvolutionFormat<int,icl16s,icl16s> { static const int value = SIMDConvolutionJob::format16s16s; };
+      template<> struct SIMDConvolutionFormat<float,icl32f,icl32f> { static const int value = SIMDConvolutionJob::format32f32f; };
+
+      /// Utility class, that sets up SIMDConvolutionJobs for all channels of an image
+      /** The plan is created for each apply call and therefore thread-safe
+          when the ConvolutionOp is applied concurrently on image parts */
+      class SIMDConvolutionPlan{
+        SIMDConvolutionJob m_job;
+        bool m_valid;
+        bool m_avx2;
+        std::vector<int> m_offsets, m_coeffs, m_rowOffsets, m_rowCoeffs, m_colRows, m_colCoeffs;
+        std::vector<float> m_fcoeffs, m_rowFCoeffs, m_colFCoeffs;
+        std::vector<int> m_buffer;
+
+        /// appends a 2D or row tap (integer taps are restricted to 16 bit)
+        static bool add_tap(int k, int offset, std::vector<int> &offsets, std::vector<int> &coeffs, std::vector<float>&){
+          if(k < -32767 || k > 32767) return false;
+          offsets.push_back(offset);
+          coeffs.push_back(k);
+          return true;
+        }
+        static bool add_tap(float k, int offset, std::vector<int> &offsets, std::vector<int>&, std::vector<float> &coeffs){
+          offsets.push_back(offset);
+          coeffs.push_back(k);
+          return true;
+        }
+
+        /// integer taps are processed pairwise
+        static void pad_taps(std::vector<int> &offsets, std::vector<int> &coeffs){
+          if(offsets.size() % 2){
+            offsets.push_back(offsets.back());
+            coeffs.push_back(0);
+          }
+        }
+
+        template<class KernelType>
+        bool setup_2d(const KernelType *k, const Size &s, int stride){
+          for(int y=0;y<s.height;++y){
+            for(int x=0;x<s.width;++x){
+              const KernelType v = k[x+y*s.width];
+              if(v && !add_tap(v,x+y*stride,m_offsets,m_coeffs,m_fcoeffs)) return false;
+            }
+          }
+          return true;
+        }
+
+        template<class KernelType>
+        bool setup_separable(const KernelType *k, const Size &s){
+          std::vector<KernelType> row,col;
+          if(!factorize_kernel(k,s.width,s.height,row,col)) return false;
+          int nRow = 0, nCol = 0, n2D = 0;
+          for(int x=0;x<s.width;++x) nRow += !!row[x];
+          for(int y=0;y<s.height;++y) nCol += !!col[y];
+          for(int i=0;i<s.getDim();++i) n2D += !!k[i];
+          if(nRow + nCol >= n2D || s.height > 32 || nRow > 31) return false;
+
+          for(int x=0;x<s.width;++x){
+            if(row[x] && !add_tap(row[x],x,m_rowOffsets,m_rowCoeffs,m_rowFCoeffs)) return false;
+          }
+          for(int y=0;y<s.height;++y){
+            if(col[y]){
+              m_colRows.push_back(y);
+              m_colCoeffs.push_back((int)col[y]);
+              m_colFCoeffs.push_back((float)col[y]);
+            }
+          }
+          return true;
+        }
+
+        public:
+        template<class KernelType, class SrcType, class DstType>
+        SIMDConvolutionPlan(const Img<SrcType> &src, const Img<DstType> &dst, const KernelType *k, ConvolutionOp &op):
+          m_valid(false),m_avx2(false){
+          const int format = SIMDConvolutionFormat<KernelType,SrcType,DstType>::value;
+          if(format < 0 || op.getSIMDMode() == ConvolutionOp::simdOff) return;
+          if(!op.getKernel().getFactor() || (format == SIMDConvolutionJob::format32f32f && op.getKernel().getFactor() != 1)) return;
+
+          const Size s = op.getMaskSize();
+          m_job.separable = setup_separable(k,s);
+          if(!m_job.separable){
+            m_rowOffsets.clear(); m_rowCoeffs.clear(); m_rowFCoeffs.clear();
+            m_colRows.clear(); m_colCoeffs.clear(); m_colFCoeffs.clear();
+            if(!setup_2d(k,s,src.getWidth())) return;
+          }
+          // for icl8u sources, 16 bit arithmetic is used if no (intermediate) result can exceed 16 bit
+          m_job.narrow = false;
+          if(format == SIMDConvolutionJob::format8u8u || format == SIMDConvolutionJob::format8u16s){
+            long long sumAbs = 0;
+            for(int i=0;i<s.getDim();++i) sumAbs += std::abs((int)k[i]);
+            m_job.narrow = 255 * sumAbs <= 32767;
+          }
+          if(format != SIMDConvolutionJob::format32f32f && !m_job.narrow){
+            pad_taps(m_offsets,m_coeffs);
+            pad_taps(m_rowOffsets,m_rowCoeffs);
+          }
+          if(m_job.separable){
+            m_buffer.resize(s.height * dst.getROISize().width);
+          }
+
+          m_job.format = (SIMDConvolutionJob::Format)format;
+          m_job.srcStride = src.getWidth();
+          m_job.dstStride = dst.getWidth();
+          m_job.width = dst.getROISize().width;
+          m_job.height = dst.getROISize().height;
+          m_job.factor = op.getKernel().getFactor();
+          m_job.nTaps = (int)m_offsets.size();
+          m_job.tapOffsets = m_offsets.empty() ? 0 : &m_offsets[0];
+          m_job.tapCoeffs = m_coeffs.empty() ? 0 : &m_coeffs[0];
+          m_job.tapFCoeffs = m_fcoeffs.empty() ? 0 : &m_fcoeffs[0];
+          m_job.kernelHeight = s.height;
+          m_job.nRowTaps = (int)m_rowOffsets.size();
+          m_job.rowOffsets = m_rowOffsets.empty() ? 0 : &m_rowOffsets[0];
+          m_job.rowCoeffs = m_rowCoeffs.empty() ? 0 : &m_rowCoeffs[0];
+          m_job.rowFCoeffs = m_rowFCoeffs.empty() ? 0 : &m_rowFCoeffs[0];
+          m_job.nColTaps = (int)m_colRows.size();
+          m_job.colRows = m_colRows.empty() ? 0 : &m_colRows[0];
+          m_job.colCoeffs = m_colCoeffs.empty() ? 0 : &m_colCoeffs[0];
+          m_job.colFCoeffs = m_colFCoeffs.empty() ? 0 : &m_colFCoeffs[0];
+          m_job.buffer = m_buffer.empty() ? 0 : &m_buffer[0];
+
+          m_avx2 = op.getSIMDMode() == ConvolutionOp::simdAuto && cpu_supports(cpuAVX2);
+          m_valid = true;
+        }
+
+        /// applies the convolution on the given channel, returns false if the scalar code must be used
+        template<class SrcType, class DstType>
+        bool apply(const Img<SrcType> &src, Img<DstType> &dst, int c, ConvolutionOp &op){
+          if(!m_valid) return false;
+          const Point o = op.getROIOffset() - op.getAnchor();
+          m_job.src = src.getData(c) + o.x + o.y * src.getWidth();
+          m_job.dst = dst.getROIData(c);
+          return (m_avx2 && simd_convolution_avx2(m_job)) || simd_convolution_sse2(m_job);
+        }
+      };
+#endif
+
       template<class KernelType, class SrcType, class DstType, ConvolutionKernel::fixedType t>
       inline void apply_convolution_sdt(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op){
+#ifndef ICL_HAVE_IPP
+        SIMDConvolutionPlan simd(src,dst,k,op);
+        for(int c=src.getChannels()-1;c>=0;--c){
+          if(!simd.apply(src,dst,c,op)){
+            convolute<KernelType,SrcType,DstType,t>(src,dst,k,op,c);
+          }
+        }
+#else
         for(int c=src.getChannels()-1;c>=0;--c){
           convolute<KernelType,SrcType,DstType,t>(src,dst,k,op,c);
         }
+#endif
       }
       
       template<class KernelType, class SrcType, class DstType>
@@ -252,21 +455,19 @@ namespace icl{
     } // end of anonymous namespace
     
     ConvolutionOp::ConvolutionOp(const ConvolutionKernel &kernel):
-      NeighborhoodOp(kernel.getSize()),m_forceUnsignedOutput(false){
+      NeighborhoodOp(kernel.getSize()),m_forceUnsignedOutput(false),m_simdMode(simdAuto){
       setKernel(kernel);
     }
     ConvolutionOp::ConvolutionOp(const ConvolutionKernel &kernel, bool forceUnsignedOutput):
-      NeighborhoodOp(kernel.getSize()),m_forceUnsignedOutput(forceUnsignedOutput){
+      NeighborhoodOp(kernel.getSize()),m_forceUnsignedOutput(forceUnsignedOutput),m_simdMode(simdAuto){
       setKernel(kernel);
     }
   
-    void ConvolutionOp::apply(const ImgBase *src, ImgBase **dst){
-      ICLASSERT_RETURN(src);
-      ICLASSERT_RETURN(!m_kernel.isNull());
+    bool ConvolutionOp::prepareConvolution(const ImgBase *src, ImgBase **dst){
       if(m_forceUnsignedOutput){
-        if(!prepare(dst,src)) return;
+        if(!prepare(dst,src)) return false;
       }else{
-        if(!prepare(dst,src,src->getDepth()==depth8u ? depth16s : src->getDepth())) return;
+        if(!prepare(dst,src,src->getDepth()==depth8u ? depth16s : src->getDepth())) return false;
       }
   
       if(src->getDepth() >= depth32f){
@@ -276,6 +477,18 @@ namespace icl{
                     "use an int-kernel instead. For now, the kernel is casted to int-type");
         m_kernel.toInt(true);
       }
+      return true;
+    }
+
+    bool ConvolutionOp::prepareSplitting(const ImgBase *src, ImgBase **dst){
+      if(m_kernel.isNull()) return false;
+      return prepareConvolution(src,dst);
+    }
+
+    void ConvolutionOp::apply(const ImgBase *src, ImgBase **dst){
+      ICLASSERT_RETURN(src);
+      ICLASSERT_RETURN(!m_kernel.isNull());
+      if(!prepareConvolution(src,dst)) return;
   
       if(m_kernel.isFloat()){
         apply_convolution<float>(*src,**dst,m_kernel.getFloatData(),*this);
@@ -83,6 +83,19 @@ namespace icl {
        - icl8u images & icl32f kernel <b>~135ms</b> (further implem. ~230ms)
        - icl32f-image & icl32f kernel <b>~60ms</b> (further implem. ~60ms)
     
+    <h2>SIMD-Optimized Fallback</h2>
+    If ICL is built without IPP, convolutions of icl8u, icl16s (integer
+    kernels) and icl32f images (float kernels) are computed by SSE2 or,
+    if supported by the CPU, AVX2 code. The instruction set is selected
+    at runtime. Separable kernels, such as the gaussian and sobel kernels,
+    are detected automatically and applied as two 1D passes. Integer results
+    are identical to the scalar implementation, except for the saturation of
+    values that exceed the destination range (the scalar 3x3 code wraps
+    around in this case). Float results of separable kernels may differ
+    in the order of 1e-6 due to the different summation order. The SIMD code
+    can be disabled using setSIMDMode(ConvolutionOp::simdOff), which is e.g.
+    used by the convolution-benchmark example.
+  
     <h2>Buffering Kernels</h2>
     In some applications the ConvolutionOp object has to be created
     during runtime. If the filter-kernel is created elsewhere, and it
@@ -96,6 +109,13 @@ namespace icl {
     class ICLFilter_API ConvolutionOp : public NeighborhoodOp, public utils::Uncopyable{
       public:
   
+      /// instruction set selection for the SIMD-optimized C++ fallback implementation
+      enum SIMDMode{
+        simdOff,  //!< use the scalar C++ implementation only
+        simdSSE2, //!< use SSE2 code (if ICL was compiled with SSE2 support)
+        simdAuto  //!< use AVX2 code if supported by the CPU, SSE2 code otherwise (default)
+      };
+
       /// Default constructor (force unsigned is set to false)
       ConvolutionOp(const ConvolutionKernel &kernel=ConvolutionKernel());
   
@@ -121,10 +141,24 @@ namespace icl {
       
       ///  returns currently used kernel (const)
       ConvolutionKernel &getKernel() { return m_kernel; }
+
+      /// sets the instruction set selection for the C++ fallback (has no effect if IPP is used)
+      void setSIMDMode(SIMDMode mode) { m_simdMode = mode; }
+
+      /// returns the current instruction set selection
+      SIMDMode getSIMDMode() const { return m_simdMode; }
   
+      protected:
+      /// prepares the destination image and adapts the kernel type (see UnaryOp::prepareSplitting)
+      virtual bool prepareSplitting(const core::ImgBase *src, core::ImgBase **dst);
+
       private:
+      /// prepares the destination image and adapts the kernel type to the source depth
+      bool prepareConvolution(const core::ImgBase *src, core::ImgBase **dst);
+
       ConvolutionKernel m_kernel;
       bool m_forceUnsignedOutput;
+      SIMDMode m_simdMode;
     };
    
   } // namespace filter
@@ -0,0 +1,142 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/src/ICLFilter/ConvolutionOpAVX2.cpp          **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+/* This file is compiled with ICL_AVX2_FLAGS (see ICLFilter/CMakeLists.txt).
+   Therefore, it must not include any headers that contain inline functions or
+   templates used by other translation units as well: the linker could pick
+   the AVX2-compiled instances, which would crash on CPUs without AVX2. */
+
+#include <ICLFilter/ConvolutionOpSIMDImpl.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace icl{
+  namespace filter{
+
+#ifdef __AVX2__
+    namespace{
+      /// Note: most AVX2 integer operations work on the two 128 bit lanes independently
+      /** Therefore, lo and hi contain the pixels [0-3|8-11] and [4-7|12-15]
+          after madd. This order is preserved by the 16 bit packing and
+          compensated for in load32/store32 and in the 8 bit store */
+      struct AVX2Ops{
+        typedef __m256i vi;
+        typedef __m256 vf;
+        static const int N = 16;
+        static const int NF = 8;
+
+        static inline vi zero() { return _mm256_setzero_si256(); }
+        static inline vi set1(int i) { return _mm256_set1_epi32(i); }
+        static inline vi add(vi a, vi b) { return _mm256_add_epi32(a,b); }
+        static inline vi mullo(vi a, vi b) { return _mm256_mullo_epi32(a,b); }
+
+        static inline vi load(const unsigned char *p){
+          return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)p));
+        }
+        static inline vi load(const short *p){
+          return _mm256_loadu_si256((const __m256i*)p);
+        }
+
+        static inline void madd(vi a, vi b, vi k, vi &lo, vi &hi){
+          lo = _mm256_add_epi32(lo,_mm256_madd_epi16(_mm256_unpacklo_epi16(a,b),k));
+          hi = _mm256_add_epi32(hi,_mm256_madd_epi16(_mm256_unpackhi_epi16(a,b),k));
+        }
+
+        static inline void load32(const int *p, vi &lo, vi &hi){
+          const vi a = _mm256_loadu_si256((const __m256i*)p);
+          const vi b = _mm256_loadu_si256((const __m256i*)(p+8));
+          lo = _mm256_permute2x128_si256(a,b,0x20);
+          hi = _mm256_permute2x128_si256(a,b,0x31);
+        }
+        static inline void store32(int *p, vi lo, vi hi){
+          _mm256_storeu_si256((__m256i*)p,_mm256_permute2x128_si256(lo,hi,0x20));
+          _mm256_storeu_si256((__m256i*)(p+8),_mm256_permute2x128_si256(lo,hi,0x31));
+        }
+        static inline void store(unsigned char *p, vi lo, vi hi){
+          const vi s = _mm256_packs_epi32(lo,hi);
+          const vi u = _mm256_permute4x64_epi64(_mm256_packus_epi16(s,s),_MM_SHUFFLE(3,1,2,0));
+          _mm_storeu_si128((__m128i*)p,_mm256_castsi256_si128(u));
+        }
+        static inline void store(short *p, vi lo, vi hi){
+          _mm256_storeu_si256((__m256i*)p,_mm256_packs_epi32(lo,hi));
+        }
+
+        static inline vi div_shift(vi v, int mask, int shift){
+          const vi bias = _mm256_and_si256(_mm256_srai_epi32(v,31),_mm256_set1_epi32(mask));
+          return _mm256_sra_epi32(_mm256_add_epi32(v,bias),_mm_cvtsi32_si128(shift));
+        }
+        static inline vi div_double(vi v, double f){
+          const __m256d df = _mm256_set1_pd(f);
+          const __m128i a = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)),df));
+          const __m128i b = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v,1)),df));
+          return _mm256_inserti128_si256(_mm256_castsi128_si256(a),b,1);
+        }
+
+        static inline vi set1_16(int k) { return _mm256_set1_epi16((short)k); }
+        static inline vi add16(vi a, vi b) { return _mm256_add_epi16(a,b); }
+        static inline vi mullo16(vi a, vi b) { return _mm256_mullo_epi16(a,b); }
+        static inline vi div16_shift(vi v, int mask, int shift){
+          const vi bias = _mm256_and_si256(_mm256_srai_epi16(v,15),_mm256_set1_epi16((short)mask));
+          return _mm256_sra_epi16(_mm256_add_epi16(v,bias),_mm_cvtsi32_si128(shift));
+        }
+        static inline void store16(short *p, vi v){
+          _mm256_storeu_si256((__m256i*)p,v);
+        }
+        static inline void store16(unsigned char *p, vi v){
+          const vi u = _mm256_permute4x64_epi64(_mm256_packus_epi16(v,v),_MM_SHUFFLE(3,1,2,0));
+          _mm_storeu_si128((__m128i*)p,_mm256_castsi256_si128(u));
+        }
+        static inline void widen16(vi v, vi &lo, vi &hi){
+          lo = _mm256_srai_epi32(_mm256_unpacklo_epi16(v,v),16);
+          hi = _mm256_srai_epi32(_mm256_unpackhi_epi16(v,v),16);
+        }
+
+        static inline vf fzero() { return _mm256_setzero_ps(); }
+        static inline vf fset1(float f) { return _mm256_set1_ps(f); }
+        static inline vf fload(const float *p) { return _mm256_loadu_ps(p); }
+        static inline void fstore(float *p, vf v) { _mm256_storeu_ps(p,v); }
+        static inline vf fadd(vf a, vf b) { return _mm256_add_ps(a,b); }
+        static inline vf fmul(vf a, vf b) { return _mm256_mul_ps(a,b); }
+      };
+    }
+
+    bool simd_convolution_avx2(const SIMDConvolutionJob &job){
+      return simd_convolution_run<AVX2Ops>(job);
+    }
+#else
+    bool simd_convolution_avx2(const SIMDConvolutionJob&){
+      return false;
+    }
+#endif
+
+  } // namespace filter
+}
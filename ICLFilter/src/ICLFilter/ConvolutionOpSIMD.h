@@ -0,0 +1,95 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/src/ICLFilter/ConvolutionOpSIMD.h            **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+namespace icl{
+  namespace filter{
+
+    /// Internally used description of a single channel convolution for the SIMD backend of the ConvolutionOp
+    /** The job is set up by the ConvolutionOp and processed by one of the
+        instruction set specific implementations. It does only contain plain
+        pointers and integers, because the AVX2 implementation is compiled in a
+        separate translation unit with different compiler flags, which must not
+        share any inline or template code with the rest of the library.
+
+        All tap lists are expected to contain non-zero coefficients only.
+        Unless the job is narrow, integer taps are processed pairwise, therefore
+        the integer 2D tap and row tap lists must be padded to an even length
+        (using a zero coefficient) and all integer 2D and row coefficients must
+        lie within [-32767,32767].
+        Separable jobs are restricted to a kernel height and a number of row
+        taps of at most 32. */
+    struct SIMDConvolutionJob{
+      /// supported source/destination depth combinations
+      enum Format{
+        format8u8u,   //!< icl8u source and destination (integer kernel)
+        format8u16s,  //!< icl8u source and icl16s destination (integer kernel)
+        format16s16s, //!< icl16s source and destination (integer kernel)
+        format32f32f  //!< icl32f source and destination (float kernel, factor 1)
+      };
+      Format format;
+
+      const void *src;   //!< source pixel under the kernel's upper left corner for the first destination pixel
+      int srcStride;     //!< source line stride (in pixels)
+      void *dst;         //!< first destination ROI pixel
+      int dstStride;     //!< destination line stride (in pixels)
+      int width;         //!< destination ROI width
+      int height;        //!< destination ROI height
+      int factor;        //!< integer division factor (integer kernels only, != 0)
+      bool narrow;       //!< if true, all (intermediate) integer results fit into 16 bit and 16 bit arithmetic is used
+
+      int nTaps;               //!< number of 2D taps (non-separable case)
+      const int *tapOffsets;   //!< source offsets of the 2D taps (in pixels)
+      const int *tapCoeffs;    //!< integer 2D coefficients
+      const float *tapFCoeffs; //!< float 2D coefficients
+
+      bool separable;          //!< if true, the row and column taps are used
+      int kernelHeight;        //!< kernel height (separable case)
+      int nRowTaps;            //!< number of horizontal taps
+      const int *rowOffsets;   //!< horizontal tap offsets (in pixels)
+      const int *rowCoeffs;    //!< integer horizontal coefficients
+      const float *rowFCoeffs; //!< float horizontal coefficients
+      int nColTaps;            //!< number of vertical taps
+      const int *colRows;      //!< kernel rows of the vertical taps
+      const int *colCoeffs;    //!< integer vertical coefficients
+      const float *colFCoeffs; //!< float vertical coefficients
+      void *buffer;            //!< intermediate buffer for kernelHeight x width 32 bit values (separable case, 16 bit if narrow)
+    };
+
+    /// Internally used SSE2 convolution (returns false if ICL was compiled without SSE2 support)
+    bool simd_convolution_sse2(const SIMDConvolutionJob &job);
+
+    /// Internally used AVX2 convolution (returns false if ICL was compiled without AVX2 support)
+    /** This function must only be called if utils::cpu_supports(utils::cpuAVX2) returns true */
+    bool simd_convolution_avx2(const SIMDConvolutionJob &job);
+
+  } // namespace filter
+}
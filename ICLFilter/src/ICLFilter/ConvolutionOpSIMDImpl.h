@@ -0,0 +1,444 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/src/ICLFilter/ConvolutionOpSIMDImpl.h        **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLFilter/ConvolutionOpSIMD.h>
+
+/* This header is included by the instruction set specific translation units
+   ConvolutionOpSSE2.cpp and ConvolutionOpAVX2.cpp only. Each of them defines
+   an 'Ops' class that wraps the required vector intrinsics and instantiates
+   simd_convolution_run<Ops>. Everything is placed in an anonymous namespace
+   so that the differently compiled instances never get merged by the linker.
+
+   Ops interface:
+   - typedef vi (integer vector), typedef vf (float vector)
+   - N: number of pixels processed per integer iteration (vi holds N/2 ints)
+   - NF: number of floats in vf
+   - vi zero(), vi set1(int), vi add(vi,vi), vi mullo(vi,vi)
+   - vi load(const unsigned char*), vi load(const short*): N pixels as 16 bit
+   - void madd(vi a, vi b, vi k, vi &lo, vi &hi): lo/hi += a*k.lo + b*k.hi
+     (the resulting lo/hi lane order is implementation specific)
+   - void load32(const int*,vi&,vi&), store32(int*,vi,vi): N ints in/from lo/hi
+   - void store(unsigned char*,vi,vi), store(short*,vi,vi): saturated N pixels
+   - vi div_shift(vi,int mask,int shift), vi div_double(vi,double): truncating
+     integer division
+   - 16 bit arithmetic: vi set1_16(int), vi add16(vi,vi), vi mullo16(vi,vi),
+     vi div16_shift(vi,int mask,int shift), void store16(short*,vi) (plain),
+     void store16(unsigned char*,vi) (saturated), void widen16(vi,vi &lo,vi &hi)
+     (sign extension to 32 bit in the lane order of madd)
+   - vf fzero(), vf fset1(float), vf fload(const float*), void fstore(float*,vf)
+     vf fadd(vf,vf), vf fmul(vf,vf)
+*/
+
+namespace icl{
+  namespace filter{
+    namespace{
+
+      /// division modes for the kernel factor (C-semantics, i.e. truncation towards zero)
+      enum SIMDConvolutionDivMode { divNone, divShift, divGeneric };
+
+      /// division by the kernel factor
+      struct SIMDConvolutionDivisor{
+        SIMDConvolutionDivMode mode;
+        int factor;
+        int shiftBits;
+        int shiftMask;
+
+        SIMDConvolutionDivisor(int factor):mode(divGeneric),factor(factor),shiftBits(0),shiftMask(0){
+          if(factor == 1){
+            mode = divNone;
+          }else if(factor > 0 && !(factor & (factor-1))){
+            mode = divShift;
+            while((1<<shiftBits) != factor) ++shiftBits;
+            shiftMask = factor-1;
+          }
+        }
+      };
+
+      template<class Ops, int MODE>
+      inline typename Ops::vi simd_convolution_div(typename Ops::vi v, const SIMDConvolutionDivisor &d){
+        if(MODE == divNone) return v;
+        if(MODE == divShift) return Ops::div_shift(v,d.shiftMask,d.shiftBits);
+        return Ops::div_double(v,(double)d.factor);
+      }
+
+      inline void simd_convolution_clip(int v, unsigned char &d){
+        d = v < 0 ? 0 : v > 255 ? 255 : (unsigned char)v;
+      }
+      inline void simd_convolution_clip(int v, short &d){
+        d = v < -32768 ? -32768 : v > 32767 ? 32767 : (short)v;
+      }
+
+      /// packs two 16 bit coefficients into one int (k0 in the lower half)
+      inline int simd_convolution_pair(int k0, int k1){
+        return (int)(((unsigned int)k0 & 0xffffu) | ((unsigned int)k1 << 16));
+      }
+
+      /// number of coefficient vectors that are kept in registers/on the stack
+      static const int SIMD_CONVOLUTION_CACHE = 32;
+
+      /// horizontal part: accumulates nTaps (even) integer taps for N pixels starting at s
+      template<class Ops, class S>
+      inline void simd_convolution_taps_int(const S *s, const int *off, const int *k, int nTaps,
+                                            const typename Ops::vi *kk, int nCached,
+                                            typename Ops::vi &lo, typename Ops::vi &hi){
+        lo = Ops::zero();
+        hi = Ops::zero();
+        int t = 0;
+        for(;t<nCached;t+=2){
+          Ops::madd(Ops::load(s+off[t]),Ops::load(s+off[t+1]),kk[t/2],lo,hi);
+        }
+        for(;t<nTaps;t+=2){
+          Ops::madd(Ops::load(s+off[t]),Ops::load(s+off[t+1]),Ops::set1(simd_convolution_pair(k[t],k[t+1])),lo,hi);
+        }
+      }
+
+      /// fills the coefficient cache for the pairwise processed integer taps, returns the number of cached taps
+      template<class Ops>
+      inline int simd_convolution_cache_pairs(const int *k, int nTaps, typename Ops::vi *kk){
+        int n = 0;
+        for(;n<nTaps && n<2*SIMD_CONVOLUTION_CACHE;n+=2){
+          kk[n/2] = Ops::set1(simd_convolution_pair(k[n],k[n+1]));
+        }
+        return n;
+      }
+
+      /// non-separable integer convolution, taps are processed pairwise
+      template<class Ops, class S, class D, int DIV>
+      void simd_convolution_2d_int(const SIMDConvolutionJob &j){
+        typedef typename Ops::vi vi;
+        const int N = Ops::N, W = j.width, nTaps = j.nTaps;
+        const int *off = j.tapOffsets, *k = j.tapCoeffs;
+        const SIMDConvolutionDivisor div(j.factor);
+        vi kk[SIMD_CONVOLUTION_CACHE];
+        const int nCached = simd_convolution_cache_pairs<Ops>(k,nTaps,kk);
+
+        for(int y=0;y<j.height;++y){
+          const S *s = (const S*)j.src + y*j.srcStride;
+          D *d = (D*)j.dst + y*j.dstStride;
+          int x = 0;
+          for(;x<=W-N;x+=N){
+            vi lo,hi;
+            simd_convolution_taps_int<Ops>(s+x,off,k,nTaps,kk,nCached,lo,hi);
+            Ops::store(d+x,simd_convolution_div<Ops,DIV>(lo,div),simd_convolution_div<Ops,DIV>(hi,div));
+          }
+          for(;x<W;++x){
+            int buf = 0;
+            for(int t=0;t<nTaps;++t) buf += k[t] * s[x+off[t]];
+            simd_convolution_clip(buf/j.factor,d[x]);
+          }
+        }
+      }
+
+      /// separable integer convolution: horizontal pass into a ring buffer of 32 bit rows, then vertical pass
+      /** The job's kernelHeight must not exceed SIMD_CONVOLUTION_CACHE */
+      template<class Ops, class S, class D, int DIV>
+      void simd_convolution_separable_int(const SIMDConvolutionJob &j){
+        typedef typename Ops::vi vi;
+        const int N = Ops::N, W = j.width, KH = j.kernelHeight;
+        const int nRow = j.nRowTaps, nCol = j.nColTaps;
+        const int *roff = j.rowOffsets, *rk = j.rowCoeffs;
+        int *buffer = (int*)j.buffer;
+        const SIMDConvolutionDivisor div(j.factor);
+        vi kk[SIMD_CONVOLUTION_CACHE], ck[SIMD_CONVOLUTION_CACHE];
+        const int nCached = simd_convolution_cache_pairs<Ops>(rk,nRow,kk);
+        for(int t=0;t<nCol;++t) ck[t] = Ops::set1(j.colCoeffs[t]);
+        const int *rows[SIMD_CONVOLUTION_CACHE];
+
+        for(int r=0;r<j.height+KH-1;++r){
+          // horizontal pass for source row r
+          const S *s = (const S*)j.src + r*j.srcStride;
+          int *b = buffer + (r%KH)*W;
+          int x = 0;
+          for(;x<=W-N;x+=N){
+            vi lo,hi;
+            simd_convolution_taps_int<Ops>(s+x,roff,rk,nRow,kk,nCached,lo,hi);
+            Ops::store32(b+x,lo,hi);
+          }
+          for(;x<W;++x){
+            int buf = 0;
+            for(int t=0;t<nRow;++t) buf += rk[t] * s[x+roff[t]];
+            b[x] = buf;
+          }
+
+          // vertical pass for destination row y, once all needed rows are available
+          const int y = r-KH+1;
+          if(y < 0) continue;
+          for(int t=0;t<nCol;++t) rows[t] = buffer + ((y+j.colRows[t])%KH)*W;
+          D *d = (D*)j.dst + y*j.dstStride;
+          x = 0;
+          for(;x<=W-N;x+=N){
+            vi lo = Ops::zero(), hi = Ops::zero();
+            for(int t=0;t<nCol;++t){
+              vi a,c;
+              Ops::load32(rows[t]+x,a,c);
+              lo = Ops::add(lo,Ops::mullo(a,ck[t]));
+              hi = Ops::add(hi,Ops::mullo(c,ck[t]));
+            }
+            Ops::store(d+x,simd_convolution_div<Ops,DIV>(lo,div),simd_convolution_div<Ops,DIV>(hi,div));
+          }
+          for(;x<W;++x){
+            int buf = 0;
+            for(int t=0;t<nCol;++t) buf += j.colCoeffs[t] * rows[t][x];
+            simd_convolution_clip(buf/j.factor,d[x]);
+          }
+        }
+      }
+
+      /// non-separable float convolution (taps are accumulated in the same order as in the scalar code)
+      template<class Ops>
+      void simd_convolution_2d_float(const SIMDConvolutionJob &j){
+        typedef typename Ops::vf vf;
+        const int NF = Ops::NF, W = j.width, nTaps = j.nTaps;
+        const int *off = j.tapOffsets;
+        const float *k = j.tapFCoeffs;
+        vf kk[SIMD_CONVOLUTION_CACHE];
+        const int nCached = nTaps < SIMD_CONVOLUTION_CACHE ? nTaps : SIMD_CONVOLUTION_CACHE;
+        for(int t=0;t<nCached;++t) kk[t] = Ops::fset1(k[t]);
+
+        for(int y=0;y<j.height;++y){
+          const float *s = (const float*)j.src + y*j.srcStride;
+          float *d = (float*)j.dst + y*j.dstStride;
+          int x = 0;
+          for(;x<=W-2*NF;x+=2*NF){
+            vf a = Ops::fzero(), b = Ops::fzero();
+            int t = 0;
+            for(;t<nCached;++t){
+              a = Ops::fadd(a,Ops::fmul(kk[t],Ops::fload(s+x+off[t])));
+              b = Ops::fadd(b,Ops::fmul(kk[t],Ops::fload(s+x+NF+off[t])));
+            }
+            for(;t<nTaps;++t){
+              const vf kt = Ops::fset1(k[t]);
+              a = Ops::fadd(a,Ops::fmul(kt,Ops::fload(s+x+off[t])));
+              b = Ops::fadd(b,Ops::fmul(kt,Ops::fload(s+x+NF+off[t])));
+            }
+            Ops::fstore(d+x,a);
+            Ops::fstore(d+x+NF,b);
+          }
+          for(;x<W;++x){
+            float buf = 0;
+            for(int t=0;t<nTaps;++t) buf += k[t] * s[x+off[t]];
+            d[x] = buf;
+          }
+        }
+      }
+
+      /// separable float convolution
+      /** The job's kernelHeight and row tap count must not exceed SIMD_CONVOLUTION_CACHE */
+      template<class Ops>
+      void simd_convolution_separable_float(const SIMDConvolutionJob &j){
+        typedef typename Ops::vf vf;
+        const int NF = Ops::NF, W = j.width, KH = j.kernelHeight;
+        const int nRow = j.nRowTaps, nCol = j.nColTaps;
+        const int *roff = j.rowOffsets;
+        const float *rk = j.rowFCoeffs, *ck = j.colFCoeffs;
+        float *buffer = (float*)j.buffer;
+        vf rkk[SIMD_CONVOLUTION_CACHE], ckk[SIMD_CONVOLUTION_CACHE];
+        for(int t=0;t<nRow;++t) rkk[t] = Ops::fset1(rk[t]);
+        for(int t=0;t<nCol;++t) ckk[t] = Ops::fset1(ck[t]);
+        const float *rows[SIMD_CONVOLUTION_CACHE];
+
+        for(int r=0;r<j.height+KH-1;++r){
+          const float *s = (const float*)j.src + r*j.srcStride;
+          float *b = buffer + (r%KH)*W;
+          int x = 0;
+          for(;x<=W-NF;x+=NF){
+            vf a = Ops::fzero();
+            for(int t=0;t<nRow;++t){
+              a = Ops::fadd(a,Ops::fmul(rkk[t],Ops::fload(s+x+roff[t])));
+            }
+            Ops::fstore(b+x,a);
+          }
+          for(;x<W;++x){
+            float buf = 0;
+            for(int t=0;t<nRow;++t) buf += rk[t] * s[x+roff[t]];
+            b[x] = buf;
+          }
+
+          const int y = r-KH+1;
+          if(y < 0) continue;
+          for(int t=0;t<nCol;++t) rows[t] = buffer + ((y+j.colRows[t])%KH)*W;
+          float *d = (float*)j.dst + y*j.dstStride;
+          x = 0;
+          for(;x<=W-NF;x+=NF){
+            vf a = Ops::fzero();
+            for(int t=0;t<nCol;++t){
+              a = Ops::fadd(a,Ops::fmul(ckk[t],Ops::fload(rows[t]+x)));
+            }
+            Ops::fstore(d+x,a);
+          }
+          for(;x<W;++x){
+            float buf = 0;
+            for(int t=0;t<nCol;++t) buf += ck[t] * rows[t][x];
+            d[x] = buf;
+          }
+        }
+      }
+
+      /// stores N 16 bit results, that are divided by the kernel factor first
+      template<class Ops, int DIV, class D>
+      inline void simd_convolution_store_narrow(D *d, typename Ops::vi v, const SIMDConvolutionDivisor &div){
+        if(DIV == divNone){
+          Ops::store16(d,v);
+        }else if(DIV == divShift){
+          Ops::store16(d,Ops::div16_shift(v,div.shiftMask,div.shiftBits));
+        }else{
+          typename Ops::vi lo,hi;
+          Ops::widen16(v,lo,hi);
+          Ops::store(d,simd_convolution_div<Ops,DIV>(lo,div),simd_convolution_div<Ops,DIV>(hi,div));
+        }
+      }
+
+      /// non-separable integer convolution with 16 bit accumulators (see SIMDConvolutionJob::narrow)
+      template<class Ops, class S, class D, int DIV>
+      void simd_convolution_2d_narrow(const SIMDConvolutionJob &j){
+        typedef typename Ops::vi vi;
+        const int N = Ops::N, W = j.width, nTaps = j.nTaps;
+        const int *off = j.tapOffsets, *k = j.tapCoeffs;
+        const SIMDConvolutionDivisor div(j.factor);
+        vi kk[SIMD_CONVOLUTION_CACHE];
+        const int nCached = nTaps < SIMD_CONVOLUTION_CACHE ? nTaps : SIMD_CONVOLUTION_CACHE;
+        for(int t=0;t<nCached;++t) kk[t] = Ops::set1_16(k[t]);
+
+        for(int y=0;y<j.height;++y){
+          const S *s = (const S*)j.src + y*j.srcStride;
+          D *d = (D*)j.dst + y*j.dstStride;
+          int x = 0;
+          for(;x<=W-N;x+=N){
+            vi a = Ops::zero();
+            int t=0;
+            for(;t<nCached;++t) a = Ops::add16(a,Ops::mullo16(Ops::load(s+x+off[t]),kk[t]));
+            for(;t<nTaps;++t) a = Ops::add16(a,Ops::mullo16(Ops::load(s+x+off[t]),Ops::set1_16(k[t])));
+            simd_convolution_store_narrow<Ops,DIV>(d+x,a,div);
+          }
+          for(;x<W;++x){
+            int buf = 0;
+            for(int t=0;t<nTaps;++t) buf += k[t] * s[x+off[t]];
+            simd_convolution_clip(buf/j.factor,d[x]);
+          }
+        }
+      }
+
+      /// separable integer convolution with 16 bit accumulators and a 16 bit ring buffer
+      template<class Ops, class S, class D, int DIV>
+      void simd_convolution_separable_narrow(const SIMDConvolutionJob &j){
+        typedef typename Ops::vi vi;
+        const int N = Ops::N, W = j.width, KH = j.kernelHeight;
+        const int nRow = j.nRowTaps, nCol = j.nColTaps;
+        const int *roff = j.rowOffsets, *rk = j.rowCoeffs, *ck = j.colCoeffs;
+        short *buffer = (short*)j.buffer;
+        const SIMDConvolutionDivisor div(j.factor);
+        vi rkk[SIMD_CONVOLUTION_CACHE], ckk[SIMD_CONVOLUTION_CACHE];
+        for(int t=0;t<nRow;++t) rkk[t] = Ops::set1_16(rk[t]);
+        for(int t=0;t<nCol;++t) ckk[t] = Ops::set1_16(ck[t]);
+        const short *rows[SIMD_CONVOLUTION_CACHE];
+
+        for(int r=0;r<j.height+KH-1;++r){
+          const S *s = (const S*)j.src + r*j.srcStride;
+          short *b = buffer + (r%KH)*W;
+          int x = 0;
+          for(;x<=W-N;x+=N){
+            vi a = Ops::zero();
+            for(int t=0;t<nRow;++t) a = Ops::add16(a,Ops::mullo16(Ops::load(s+x+roff[t]),rkk[t]));
+            Ops::store16(b+x,a);
+          }
+          for(;x<W;++x){
+            int buf = 0;
+            for(int t=0;t<nRow;++t) buf += rk[t] * s[x+roff[t]];
+            b[x] = (short)buf;
+          }
+
+          const int y = r-KH+1;
+          if(y < 0) continue;
+          for(int t=0;t<nCol;++t) rows[t] = buffer + ((y+j.colRows[t])%KH)*W;
+          D *d = (D*)j.dst + y*j.dstStride;
+          x = 0;
+          for(;x<=W-N;x+=N){
+            vi a = Ops::zero();
+            for(int t=0;t<nCol;++t) a = Ops::add16(a,Ops::mullo16(Ops::load(rows[t]+x),ckk[t]));
+            simd_convolution_store_narrow<Ops,DIV>(d+x,a,div);
+          }
+          for(;x<W;++x){
+            int buf = 0;
+            for(int t=0;t<nCol;++t) buf += ck[t] * rows[t][x];
+            simd_convolution_clip(buf/j.factor,d[x]);
+          }
+        }
+      }
+
+      template<class Ops, class S, class D, int DIV>
+      void simd_convolution_run_int(const SIMDConvolutionJob &j){
+        if(j.narrow){
+          if(j.separable){
+            simd_convolution_separable_narrow<Ops,S,D,DIV>(j);
+          }else{
+            simd_convolution_2d_narrow<Ops,S,D,DIV>(j);
+          }
+        }else if(j.separable){
+          simd_convolution_separable_int<Ops,S,D,DIV>(j);
+        }else{
+          simd_convolution_2d_int<Ops,S,D,DIV>(j);
+        }
+      }
+
+      template<class Ops, class S, class D>
+      void simd_convolution_run_int(const SIMDConvolutionJob &j){
+        switch(SIMDConvolutionDivisor(j.factor).mode){
+          case divNone: simd_convolution_run_int<Ops,S,D,divNone>(j); break;
+          case divShift: simd_convolution_run_int<Ops,S,D,divShift>(j); break;
+          default: simd_convolution_run_int<Ops,S,D,divGeneric>(j); break;
+        }
+      }
+
+      template<class Ops>
+      bool simd_convolution_run(const SIMDConvolutionJob &j){
+        if(j.separable && (j.kernelHeight > SIMD_CONVOLUTION_CACHE || j.nRowTaps > SIMD_CONVOLUTION_CACHE)){
+          return false;
+        }
+        switch(j.format){
+          case SIMDConvolutionJob::format8u8u: simd_convolution_run_int<Ops,unsigned char,unsigned char>(j); break;
+          case SIMDConvolutionJob::format8u16s: simd_convolution_run_int<Ops,unsigned char,short>(j); break;
+          case SIMDConvolutionJob::format16s16s: simd_convolution_run_int<Ops,short,short>(j); break;
+          case SIMDConvolutionJob::format32f32f:
+            if(j.separable){
+              simd_convolution_separable_float<Ops>(j);
+            }else{
+              simd_convolution_2d_float<Ops>(j);
+            }
+            break;
+          default: return false;
+        }
+        return true;
+      }
+
+    } // anonymous namespace
+  } // namespace filter
+}
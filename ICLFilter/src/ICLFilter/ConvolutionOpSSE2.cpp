@@ -0,0 +1,134 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/src/ICLFilter/ConvolutionOpSSE2.cpp          **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLUtils/SSETypes.h>
+#include <ICLFilter/ConvolutionOpSIMDImpl.h>
+
+namespace icl{
+  namespace filter{
+
+#ifdef ICL_HAVE_SSE2
+    namespace{
+      struct SSE2Ops{
+        typedef __m128i vi;
+        typedef __m128 vf;
+        static const int N = 8;
+        static const int NF = 4;
+
+        static inline vi zero() { return _mm_setzero_si128(); }
+        static inline vi set1(int i) { return _mm_set1_epi32(i); }
+        static inline vi add(vi a, vi b) { return _mm_add_epi32(a,b); }
+
+        /// SSE2 has no 32 bit multiplication, only the lower halfs of the 64 bit products are used
+        static inline vi mullo(vi a, vi b){
+          const vi even = _mm_mul_epu32(a,b);
+          const vi odd = _mm_mul_epu32(_mm_srli_si128(a,4),_mm_srli_si128(b,4));
+          return _mm_unpacklo_epi32(_mm_shuffle_epi32(even,_MM_SHUFFLE(0,0,2,0)),
+                                    _mm_shuffle_epi32(odd,_MM_SHUFFLE(0,0,2,0)));
+        }
+
+        static inline vi load(const unsigned char *p){
+          return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p),_mm_setzero_si128());
+        }
+        static inline vi load(const short *p){
+          return _mm_loadu_si128((const __m128i*)p);
+        }
+
+        static inline void madd(vi a, vi b, vi k, vi &lo, vi &hi){
+          lo = _mm_add_epi32(lo,_mm_madd_epi16(_mm_unpacklo_epi16(a,b),k));
+          hi = _mm_add_epi32(hi,_mm_madd_epi16(_mm_unpackhi_epi16(a,b),k));
+        }
+
+        static inline void load32(const int *p, vi &lo, vi &hi){
+          lo = _mm_loadu_si128((const __m128i*)p);
+          hi = _mm_loadu_si128((const __m128i*)(p+4));
+        }
+        static inline void store32(int *p, vi lo, vi hi){
+          _mm_storeu_si128((__m128i*)p,lo);
+          _mm_storeu_si128((__m128i*)(p+4),hi);
+        }
+        static inline void store(unsigned char *p, vi lo, vi hi){
+          const vi s = _mm_packs_epi32(lo,hi);
+          _mm_storel_epi64((__m128i*)p,_mm_packus_epi16(s,s));
+        }
+        static inline void store(short *p, vi lo, vi hi){
+          _mm_storeu_si128((__m128i*)p,_mm_packs_epi32(lo,hi));
+        }
+
+        static inline vi div_shift(vi v, int mask, int shift){
+          const vi bias = _mm_and_si128(_mm_srai_epi32(v,31),_mm_set1_epi32(mask));
+          return _mm_sra_epi32(_mm_add_epi32(v,bias),_mm_cvtsi32_si128(shift));
+        }
+        /// all int32 values are exactly representable as double, the truncated quotient is exact as well
+        static inline vi div_double(vi v, double f){
+          const __m128d df = _mm_set1_pd(f);
+          const vi a = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(v),df));
+          const vi b = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(v,_MM_SHUFFLE(1,0,3,2))),df));
+          return _mm_unpacklo_epi64(a,b);
+        }
+
+        static inline vi set1_16(int k) { return _mm_set1_epi16((short)k); }
+        static inline vi add16(vi a, vi b) { return _mm_add_epi16(a,b); }
+        static inline vi mullo16(vi a, vi b) { return _mm_mullo_epi16(a,b); }
+        static inline vi div16_shift(vi v, int mask, int shift){
+          const vi bias = _mm_and_si128(_mm_srai_epi16(v,15),_mm_set1_epi16((short)mask));
+          return _mm_sra_epi16(_mm_add_epi16(v,bias),_mm_cvtsi32_si128(shift));
+        }
+        static inline void store16(short *p, vi v){
+          _mm_storeu_si128((__m128i*)p,v);
+        }
+        static inline void store16(unsigned char *p, vi v){
+          _mm_storel_epi64((__m128i*)p,_mm_packus_epi16(v,v));
+        }
+        static inline void widen16(vi v, vi &lo, vi &hi){
+          lo = _mm_srai_epi32(_mm_unpacklo_epi16(v,v),16);
+          hi = _mm_srai_epi32(_mm_unpackhi_epi16(v,v),16);
+        }
+
+        static inline vf fzero() { return _mm_setzero_ps(); }
+        static inline vf fset1(float f) { return _mm_set1_ps(f); }
+        static inline vf fload(const float *p) { return _mm_loadu_ps(p); }
+        static inline void fstore(float *p, vf v) { _mm_storeu_ps(p,v); }
+        static inline vf fadd(vf a, vf b) { return _mm_add_ps(a,b); }
+        static inline vf fmul(vf a, vf b) { return _mm_mul_ps(a,b); }
+      };
+    }
+
+    bool simd_convolution_sse2(const SIMDConvolutionJob &job){
+      return simd_convolution_run<SSE2Ops>(job);
+    }
+#else
+    bool simd_convolution_sse2(const SIMDConvolutionJob&){
+      return false;
+    }
+#endif
+
+  } // namespace filter
+}
@@ -87,6 +87,14 @@ namespace icl {
        
        /// Import unaryOps apply function without destination image
        using UnaryOp::apply;
+
+     protected:
+       /// only depth8u source images can be split (others are converted into a buffer)
+       virtual bool prepareSplitting(const core::ImgBase *src, core::ImgBase **dst){
+         return src->getDepth() == core::depth8u && src != *dst && UnaryOp::prepare(dst,src,core::depth8u);
+       }
+
+     public:
       
        /// simple lut transformation dst(p) = lut(src(p))
        /** @param src source image
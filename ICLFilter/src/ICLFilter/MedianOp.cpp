@@ -101,7 +101,7 @@ namespace icl {
         c2 = std::max(c1, c2);
 
         a0 = std::max(a0, std::max(b0, c0));
-        a2 = std::min(a2, std::max(b2, c2));
+        a2 = std::min(a2, std::min(b2, c2));
         b1 = std::min(B1, C1);
         b2 = std::max(B1, C1);
         b1 = std::max(A1, b1);
@@ -185,6 +185,10 @@ namespace icl {
         MINMAX(tmp, r08, r14);
         MINMAX(tmp, r08, r11);
 
+        MINMAX(tmp, r12, r15);
+        MINMAX(tmp, r09, r15);
+        MINMAX(tmp, r09, r12);
+
         MINMAX(tmp, r13, r16);
         MINMAX(tmp, r10, r16);
         MINMAX(tmp, r10, r13);
@@ -310,34 +314,31 @@ namespace icl {
             b2 = max(b1, b2);
 
             for (; dstIt<dstEnd; dstIt += dstWidth, srcIt += srcWidth) {
+              // the sorted rows a and b are reused, only the new row is sorted
               T1 c0 = a0;
-              T1 c1 = A1;
+              T1 C1 = A1;
               T1 c2 = a2;
               a0 = b0;
               A1 = B1;
               a2 = b2;
               b0 = srcIt;
-              B1 = srcIt + 1;
+              b1 = srcIt + 1;
               b2 = srcIt + 2;
 
-              T1 C1 = min(c1, c2);
-              c2 = max(c1, c2);
-              c1 = max(c0, C1);
-              c0 = min(c0, C1);
-              C1 = min(c1, c2);
-              c2 = max(c1, c2);
-
-              a0 = max(a0, max(b0, c0));
-              a2 = min(a2, max(b2, c2));
-              b1 = min(B1, C1);
-              b2 = max(B1, C1);
-              b1 = max(A1, b1);
-              a1 = min(b1, b2);
-
-              b1 = min(a1, a2);
-              b2 = max(a1, a2);
-              b1 = max(a0, b1);
-              min(b1, b2).storeu(dstIt);
+              B1 = min(b1, b2);
+              b2 = max(b1, b2);
+              b1 = max(b0, B1);
+              b0 = min(b0, B1);
+              B1 = min(b1, b2);
+              b2 = max(b1, b2);
+
+              T1 lo = max(a0, max(b0, c0));
+              T1 hi = min(a2, min(b2, c2));
+              T1 mid = max(A1, min(B1, C1));
+              mid = min(mid, max(B1, C1));
+
+              T1 m = max(lo, min(mid, hi));
+              min(m, max(mid, hi)).storeu(dstIt);
             }
 
             // increment pointers to the next values
@@ -373,33 +374,29 @@ namespace icl {
 
               for (; dstIt<dstEnd; dstIt += dstWidth, srcIt += srcWidth) {
                 T c0 = a0;
-                T c1 = A1;
+                T C1 = A1;
                 T c2 = a2;
                 a0 = b0;
                 A1 = B1;
                 a2 = b2;
                 b0 = *srcIt;
-                B1 = srcIt[1];
+                b1 = srcIt[1];
                 b2 = srcIt[2];
 
-                T C1 = std::min(c1, c2);
-                c2 = std::max(c1, c2);
-                c1 = std::max(c0, C1);
-                c0 = std::min(c0, C1);
-                C1 = std::min(c1, c2);
-                c2 = std::max(c1, c2);
-
-                a0 = std::max(a0, std::max(b0, c0));
-                a2 = std::min(a2, std::max(b2, c2));
-                b1 = std::min(B1, C1);
-                b2 = std::max(B1, C1);
-                b1 = std::max(A1, b1);
-                a1 = std::min(b1, b2);
-
-                b1 = std::min(a1, a2);
-                b2 = std::max(a1, a2);
-                b1 = std::max(a0, b1);
-                *dstIt = std::min(b1, b2);
+                B1 = std::min(b1, b2);
+                b2 = std::max(b1, b2);
+                b1 = std::max(b0, B1);
+                b0 = std::min(b0, B1);
+                B1 = std::min(b1, b2);
+                b2 = std::max(b1, b2);
+
+                T lo = std::max(a0, std::max(b0, c0));
+                T hi = std::min(a2, std::min(b2, c2));
+                T mid = std::max(A1, std::min(B1, C1));
+                mid = std::min(mid, std::max(B1, C1));
+
+                T m = std::max(lo, std::min(mid, hi));
+                *dstIt = std::min(m, std::max(mid, hi));
               } 
             }
           }
@@ -440,7 +437,7 @@ namespace icl {
         c2 = max(c1, c2);
 
         a0 = max(a0, max(b0, c0));
-        a2 = min(a2, max(b2, c2));
+        a2 = min(a2, min(b2, c2));
         b1 = min(B1, C1);
         b2 = max(B1, C1);
         b1 = max(A1, b1);
@@ -524,6 +521,10 @@ namespace icl {
         MINMAX(tmp, r08, r14);
         MINMAX(tmp, r08, r11);
 
+        MINMAX(tmp, r12, r15);
+        MINMAX(tmp, r09, r15);
+        MINMAX(tmp, r09, r12);
+
         MINMAX(tmp, r13, r16);
         MINMAX(tmp, r10, r16);
         MINMAX(tmp, r10, r13);
@@ -634,7 +635,16 @@ namespace icl {
         }
       }
 
-      void apply_median_all(const Img<icl8u> *src, Img<icl8u> *dst, const Size &oMaskSize,const Point &roiOffset, const Point &oAnchor) {
+      /// mask widths from which on the constant-time median is used for Img8u
+      /** The running histogram of apply_median_huang needs 2*maskWidth
+          histogram updates per pixel, the constant-time median a few 16-bin
+          histogram additions and searches, independent of the mask size */
+      static const int CONSTANT_TIME_MEDIAN_MIN_WIDTH = 17;
+
+      /// minimum ratio of value range and mask dimension for using a coarse histogram for Img16s
+      static const int COARSE_MEDIAN_HISTOGRAM_MIN_RATIO = 16;
+
+      void apply_median_huang(const Img<icl8u> *src, Img<icl8u> *dst, const Size &oMaskSize,const Point &roiOffset, const Point &oAnchor) {
         // {{{ open
         const int half      = oMaskSize.getDim() / 2;
         const int halfexact = (oMaskSize.getDim() + 1) / 2;
@@ -698,68 +708,236 @@ namespace icl {
         }
       }
 
-      void apply_median_all(const Img<icl16s> *src, Img<icl16s> *dst, const Size &oMaskSize,const Point &roiOffset, const Point &oAnchor) {
+      /// adds (SIGN=1) or subtracts (SIGN=-1) 16 histogram bins
+      template<int SIGN>
+      inline void hist16_add(icl16u *dst, const icl16u *src){
+  #ifdef ICL_HAVE_SSE2
+        __m128i *d = reinterpret_cast<__m128i*>(dst);
+        const __m128i *s = reinterpret_cast<const __m128i*>(src);
+        if(SIGN > 0){
+          _mm_store_si128(d,_mm_add_epi16(_mm_load_si128(d),_mm_load_si128(s)));
+          _mm_store_si128(d+1,_mm_add_epi16(_mm_load_si128(d+1),_mm_load_si128(s+1)));
+        }else{
+          _mm_store_si128(d,_mm_sub_epi16(_mm_load_si128(d),_mm_load_si128(s)));
+          _mm_store_si128(d+1,_mm_sub_epi16(_mm_load_si128(d+1),_mm_load_si128(s+1)));
+        }
+  #else
+        for(int i=0;i<16;++i) dst[i] += SIGN*src[i];
+  #endif
+      }
+
+      /// constant-time median filter (Perreault and Hebert, 2007)
+      /** For each column of the source region, a histogram of the maskHeight
+          pixels of that column is maintained, which is updated with one
+          pixel removal and one insertion when moving to the next row. The
+          kernel histogram is the sum of maskWidth column histograms. When
+          moving to the next pixel, one column histogram is added and one is
+          subtracted. The histograms have 16 coarse bins (4 upper bits) and
+          256 fine bins. The coarse kernel histogram is updated for each pixel
+          while each 16-bin block of the fine kernel histogram is only updated
+          when the median falls into it. All counts are stored as icl16u, so the
+          mask dimension must not exceed 65535 */
+      void apply_median_constant_time(const Img<icl8u> *src, Img<icl8u> *dst, const Size &oMaskSize,const Point &roiOffset, const Point &oAnchor) {
         // {{{ open
-        const int half      = oMaskSize.getDim() / 2;
-        const int halfexact = (oMaskSize.getDim() + 1) / 2;
+        const int mw = oMaskSize.width, mh = oMaskSize.height;
+        const int w = dst->getROIWidth(), h = dst->getROIHeight();
+        const int cols = w + mw - 1;
+        const int need = oMaskSize.getDim()/2 + 1;
+        const int srcW = src->getWidth(), dstW = dst->getWidth();
+        const Point o = roiOffset - oAnchor;
+
+        // 16-byte aligned histogram memory (all histograms consist of 16-bin blocks)
+        std::vector<icl16u> mem(cols*(256+16) + 256 + 16 + 8);
+        icl16u *base = &mem[0];
+        base += (8 - (reinterpret_cast<size_t>(base) & 15)/2) & 7;
+        icl16u *colFine = base;
+        icl16u *colCoarse = colFine + cols*256;
+        icl16u *kFine = colCoarse + cols*16;
+        icl16u *kCoarse = kFine + 256;
+        std::vector<int> synced(16);
 
         for (int c = 0; c < src->getChannels(); c++) {
-          ImgIterator<icl16s> d    = dst->beginROI(c);
-          const ImgIterator<icl16s> s(const_cast<icl16s*>(src->getData(c)),src->getWidth(), Rect(roiOffset, dst->getROISize()));
-          const ImgIterator<icl16s> sR(s,oMaskSize,oAnchor);
-          const icl16s *s_tl = &(*sR);
-
-          for (int k = 0; k < dst->getROIWidth(); ++k, ++d, ++s_tl, ++s) {
-            icl16s median = 0;
-            icl16s hist[65536] = {0};
-            icl16s left = 0;
-
-            for (const ImgIterator<icl16s> sR(s,oMaskSize,oAnchor); sR.inRegionSubROI(); ++sR){
-              hist[*sR]++;
+          const icl8u *s = src->getData(c) + o.x + o.y*srcW;
+          icl8u *d = dst->getROIData(c);
+          std::fill(colFine,colFine+cols*(256+16),0);
+          for(int y=0;y<mh;++y){
+            const icl8u *r = s + y*srcW;
+            for(int x=0;x<cols;++x){
+              ++colFine[x*256+r[x]];
+              ++colCoarse[x*16+(r[x]>>4)];
             }
+          }
 
+          for(int y=0;y<h;++y, d+=dstW){
+            if(y){
+              const icl8u *rOut = s + (y-1)*srcW, *rIn = s + (y+mh-1)*srcW;
+              for(int x=0;x<cols;++x){
+                --colFine[x*256+rOut[x]];
+                --colCoarse[x*16+(rOut[x]>>4)];
+                ++colFine[x*256+rIn[x]];
+                ++colCoarse[x*16+(rIn[x]>>4)];
+              }
+            }
 
-            icl16s sum = 0;
+            std::fill(kCoarse,kCoarse+16,0);
+            for(int x=0;x<mw;++x){
+              hist16_add<1>(kCoarse,colCoarse+x*16);
+            }
+            // fine block b represents the columns synced[b] ... synced[b]+mw-1, it is
+            // recomputed if that is cheaper than adding and subtracting columns
+            std::fill(synced.begin(),synced.end(),-mw);
+
+            for(int x=0;x<w;++x){
+              if(x){
+                hist16_add<1>(kCoarse,colCoarse+(x+mw-1)*16);
+                hist16_add<-1>(kCoarse,colCoarse+(x-1)*16);
+              }
+              int sum = 0, b = 0;
+              for(;sum+kCoarse[b] < need;++b){
+                sum += kCoarse[b];
+              }
 
-            for (int i = 0; i < 65536; ++i) {
-              sum += hist[i];
-              if (sum >= halfexact) {
-                *d = median = i;
-                left = sum - hist[i];
+              icl16u *f = kFine + b*16;
+              if(2*(x - synced[b]) >= mw){
+                std::fill(f,f+16,0);
+                for(int i=x;i<x+mw;++i){
+                  hist16_add<1>(f,colFine+i*256+b*16);
+                }
+              }else{
+                for(int i=synced[b];i<x;++i){
+                  hist16_add<1>(f,colFine+(i+mw)*256+b*16);
+                  hist16_add<-1>(f,colFine+i*256+b*16);
+                }
+              }
+              synced[b] = x;
 
-                break;
+              int v = 0;
+              for(;sum+f[v] < need;++v){
+                sum += f[v];
               }
+              d[x] = b*16 + v;
             }
+          }
+        }
+      }
 
+      // }}}
 
-            const icl16s *sRtl = s_tl;
-            const icl16s *sRbl = &(s_tl[src->getWidth()*oMaskSize.height]);
+      void apply_median_all(const Img<icl8u> *src, Img<icl8u> *dst, const Size &oMaskSize,const Point &roiOffset, const Point &oAnchor) {
+        if(oMaskSize.width >= CONSTANT_TIME_MEDIAN_MIN_WIDTH && oMaskSize.getDim() <= 65535){
+          apply_median_constant_time(src,dst,oMaskSize,roiOffset,oAnchor);
+        }else{
+          apply_median_huang(src,dst,oMaskSize,roiOffset,oAnchor);
+        }
+      }
 
-            for (ImgIterator<icl16s> dCol(d,Size(1,dst->getROIHeight()-1),Point(0,-1)); dCol.inRegionSubROI();
-                  ++dCol, sRtl = &(sRtl[src->getWidth()]), sRbl = &(sRbl[src->getWidth()])) {
-              for (int i = 0; i < oMaskSize.width; ++i) {
-                hist[sRtl[i]]--;
-                if (sRtl[i] < median) --left;
-                hist[sRbl[i]]++;
-                if (sRbl[i] < median) ++left;
+      /// running histogram median (Huang) for Img16s
+      /** The 65536 fine bins are indexed by value+32768. If COARSE is true, an
+          additional coarse histogram with 16 values per bin allows the search
+          for the median to skip whole value ranges, which pays off if the
+          median jumps a lot from pixel to pixel (i.e. for small masks and large
+          value ranges). Columns are
+          processed from top to bottom; at the end of a column, the remaining
+          pixels are removed from the histogram again instead of clearing it.
+          All counts are stored as icl16u, so the mask dimension must not
+          exceed 65535 */
+      template<bool COARSE>
+      void apply_median_huang(const Img<icl16s> *src, Img<icl16s> *dst, const Size &oMaskSize,const Point &roiOffset, const Point &oAnchor) {
+        // {{{ open
+        const int mw = oMaskSize.width, mh = oMaskSize.height;
+        const int w = dst->getROIWidth(), h = dst->getROIHeight();
+        const int half = oMaskSize.getDim() / 2;
+        const int need = half + 1;
+        const int srcW = src->getWidth(), dstW = dst->getWidth();
+        const Point o = roiOffset - oAnchor;
+
+        std::vector<icl16u> fineMem(65536,0), coarseMem(COARSE ? 4096 : 1,0);
+        icl16u *fine = fineMem.data(), *coarse = coarseMem.data();
+
+  #define ADD_VALUE(V)  { const int v = int(V)+32768; ++fine[v]; if(COARSE) ++coarse[v>>4]; left += (v < median); }
+  #define SUB_VALUE(V)  { const int v = int(V)+32768; --fine[v]; if(COARSE) --coarse[v>>4]; left -= (v < median); }
+
+        // values < median are counted in left, each column starts with the
+        // median of the previous one to avoid long searches
+        int median = 32768, left = 0;
+        for (int c = 0; c < src->getChannels(); c++) {
+          for(int x=0;x<w;++x){
+            const icl16s *s = src->getData(c) + o.x + x + o.y*srcW;
+            icl16s *d = dst->getROIData(c) + x;
+
+            left = 0;
+            for(int y=0;y<mh;++y){
+              for(int i=0;i<mw;++i) ADD_VALUE(s[y*srcW+i]);
+            }
+
+            for(int y=0;y<h;++y, d+=dstW){
+              if(y){
+                const icl16s *rOut = s + (y-1)*srcW, *rIn = s + (y+mh-1)*srcW;
+                for(int i=0;i<mw;++i){
+                  SUB_VALUE(rOut[i]);
+                  ADD_VALUE(rIn[i]);
+                }
               }
 
+              // at coarse bin borders, whole coarse bins are skipped if possible
               if (left > half) {
                 do {
-                  --median;
-                  left -= hist[median];
+                  if(COARSE && !(median & 15) && left - coarse[(median>>4)-1] > half){
+                    left -= coarse[(median>>4)-1];
+                    median -= 16;
+                  }else{
+                    --median;
+                    left -= fine[median];
+                  }
                 } while(left > half);
               } else {
-                while (left + hist[median] < halfexact) {
-                  left += hist[median];
-                  ++median;
+                while (left + fine[median] < need) {
+                  if(COARSE && !(median & 15) && left + coarse[median>>4] < need){
+                    left += coarse[median>>4];
+                    median += 16;
+                  }else{
+                    left += fine[median];
+                    ++median;
+                  }
                 }
               }
+              *d = median - 32768;
+            }
 
-              *dCol = median;
+            for(int y=h-1;y<h+mh-1;++y){
+              for(int i=0;i<mw;++i) SUB_VALUE(s[y*srcW+i]);
             }
           }
         }
+  #undef ADD_VALUE
+  #undef SUB_VALUE
+      }
+
+      // }}}
+
+      void apply_median_all(const Img<icl16s> *src, Img<icl16s> *dst, const Size &oMaskSize,const Point &roiOffset, const Point &oAnchor) {
+        if(oMaskSize.getDim() > 65535){
+          apply_median_all<icl16s>(src,dst,oMaskSize,roiOffset,oAnchor);
+          return;
+        }
+        // the median moves by about range/dim values per pixel: the coarse
+        // histogram is only used if this is more than a few coarse bins
+        const Rect r(roiOffset-oAnchor,dst->getROISize()+oMaskSize-Size(1,1));
+        int minVal = 32767, maxVal = -32768;
+        for(int c=0;c<src->getChannels();++c){
+          for(int y=r.y;y<r.bottom();++y){
+            const icl16s *p = src->getData(c) + y*src->getWidth();
+            for(int x=r.x;x<r.right();++x){
+              minVal = iclMin(minVal,int(p[x]));
+              maxVal = iclMax(maxVal,int(p[x]));
+            }
+          }
+        }
+        if(maxVal - minVal > COARSE_MEDIAN_HISTOGRAM_MIN_RATIO * oMaskSize.getDim()){
+          apply_median_huang<true>(src,dst,oMaskSize,roiOffset,oAnchor);
+        }else{
+          apply_median_huang<false>(src,dst,oMaskSize,roiOffset,oAnchor);
+        }
       }
 
   #ifdef ICL_HAVE_SSE2
@@ -53,7 +53,16 @@ namespace icl {
         Images of the type Img8u and Img16s with other mask sizes
         are processed by the algorithm, that was introduced by
         Thomas S. Huang. With the help of a histogram the algorithm
-        runs in O(n).
+        runs in O(n). For Img8u and mask widths of 17 or more, the
+        constant-time median filter by Simon Perreault and Patrick
+        Hebert is used instead: it maintains a histogram for each image
+        column and combines them into the mask histogram using SSE2,
+        so the computation time does not depend on the mask size. For
+        Img16s, a coarse histogram (16 values per bin) is added if the
+        value range is large compared to the mask size, so that the
+        search for the median can skip empty value ranges. All
+        implementations produce exactly the same results as sorting
+        the pixels of each mask.
         For all other types a trivial implementation was designed to
         calculate the median values. It uses the naive algorithm
         of sorting all N pixel values inside the median mask,
@@ -251,6 +260,14 @@ namespace icl {
       
       /// Import unaryOps apply function without destination image
       using NeighborhoodOp::apply;
+
+      protected:
+      /// the median can always be applied to image parts (see UnaryOp::prepareSplitting)
+      virtual bool prepareSplitting(const core::ImgBase *src, core::ImgBase **dst){
+        return prepare(dst,src);
+      }
+
+      public:
   
       /// ensures that mask width and height are odd 
       /** This is a workaround, necessary because of an ipp Bug that allows no
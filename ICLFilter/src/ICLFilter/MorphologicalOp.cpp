@@ -34,6 +34,7 @@
 #include <ICLCore/ImgBorder.h>
 #include <functional>
 #include <ICLFilter/BinaryArithmeticalOp.h>
+#include <ICLUtils/SSETypes.h>
 
 using namespace icl::utils;
 using namespace icl::core;
@@ -62,6 +63,196 @@ namespace icl {
       }
     }
   
+    /// element-wise running maximum (MAX=true) or minimum of rows
+    /** dst[i] becomes v[i] if v[i] is larger (smaller) than acc[i] and
+        acc[i] otherwise, which is exactly the comparison that is used by
+        morph_cpp (NaN values of v are skipped) */
+    template<class T, bool MAX>
+    struct vhgw_row{
+      static inline T apply(T v, T acc){
+        return (MAX ? (v > acc) : (v < acc)) ? v : acc;
+      }
+      static void apply(const T *v, const T *acc, T *dst, int n){
+        for(int i=0;i<n;++i) dst[i] = apply(v[i],acc[i]);
+      }
+    };
+
+  #ifdef ICL_HAVE_SSE2
+  #define ICL_VHGW_SSE_ROW(T,MAX,VT,N,LOAD,STORE,OP)                   \
+    template<> struct vhgw_row<T,MAX>{                                  \
+      static void apply(const T *v, const T *acc, T *dst, int n){       \
+        int i=0;                                                        \
+        for(;i<=n-N;i+=N){                                              \
+          STORE(dst+i,OP(LOAD(v+i),LOAD(acc+i)));                      \
+        }                                                               \
+        for(;i<n;++i){                                                  \
+          dst[i] = (MAX ? (v[i] > acc[i]) : (v[i] < acc[i])) ? v[i] : acc[i]; \
+        }                                                               \
+      }                                                                 \
+    };
+    
+    static inline __m128i vhgw_load8u(const icl8u *p){ return _mm_loadu_si128((const __m128i*)p); }
+    static inline void vhgw_store8u(icl8u *p, __m128i v){ _mm_storeu_si128((__m128i*)p,v); }
+    
+    ICL_VHGW_SSE_ROW(icl8u,true,__m128i,16,vhgw_load8u,vhgw_store8u,_mm_max_epu8)
+    ICL_VHGW_SSE_ROW(icl8u,false,__m128i,16,vhgw_load8u,vhgw_store8u,_mm_min_epu8)
+    // _mm_max_ps(a,b) is defined as a>b ? a : b, so NaN values of a are skipped
+    ICL_VHGW_SSE_ROW(icl32f,true,__m128,4,_mm_loadu_ps,_mm_storeu_ps,_mm_max_ps)
+    ICL_VHGW_SSE_ROW(icl32f,false,__m128,4,_mm_loadu_ps,_mm_storeu_ps,_mm_min_ps)
+  #undef ICL_VHGW_SSE_ROW
+  #endif
+
+    /// van Herk/Gil-Werman running min/max along the columns of an image
+    /** Each of the outRows destination rows y becomes the maximum (minimum) of
+        the source rows y..y+k-1. The rows are split into blocks of k rows: for
+        each block, the suffix maxima and the prefix maxima of the next block
+        are computed, so that each result is a single comparison of a suffix
+        and a prefix row, independent of k. The rows are processed as a whole,
+        which allows to vectorize across the columns. S and P are buffers of
+        k*width elements, I is a row of width elements that is filled with
+        the init value, which is used as start value of all running maxima */
+    template<class T, bool MAX>
+    static void vhgw_columns(const T *src, int srcStride, T *dst, int dstStride,
+                             int width, int outRows, int k, T *S, T *P, const T *I){
+      typedef vhgw_row<T,MAX> op;
+      for(int y0=0;y0<outRows;y0+=k){
+        const int nOut = iclMin(k,outRows-y0);
+        
+        // suffixes of the block rows y0..y0+k-1
+        op::apply(src+(y0+k-1)*srcStride,I,S+(k-1)*width,width);
+        for(int i=k-2;i>=0;--i){
+          op::apply(src+(y0+i)*srcStride,S+(i+1)*width,S+i*width,width);
+        }
+        
+        // prefixes of the next block (only the ones that are needed)
+        for(int j=0;j<nOut-1;++j){
+          op::apply(src+(y0+k+j)*srcStride,j ? P+(j-1)*width : I, P+j*width,width);
+        }
+        
+        std::copy(S,S+width,dst+y0*dstStride);
+        for(int i=1;i<nOut;++i){
+          op::apply(S+i*width,P+(i-1)*width,dst+(y0+i)*dstStride,width);
+        }
+      }
+    }
+    
+    /// transposes the given width x height image into dst (height x width)
+    template<class T>
+    static void vhgw_transpose_scalar(const T *src, int srcStride, T *dst, int dstStride, int width, int height){
+      static const int B = 16;
+      for(int y0=0;y0<height;y0+=B){
+        const int y1 = iclMin(y0+B,height);
+        for(int x0=0;x0<width;x0+=B){
+          const int x1 = iclMin(x0+B,width);
+          for(int y=y0;y<y1;++y){
+            const T *s = src+y*srcStride;
+            for(int x=x0;x<x1;++x){
+              dst[x*dstStride+y] = s[x];
+            }
+          }
+        }
+      }
+    }
+
+    /// transposes the given width x height image into dst (height x width)
+    template<class T>
+    static void vhgw_transpose(const T *src, int srcStride, T *dst, int dstStride, int width, int height){
+      vhgw_transpose_scalar(src,srcStride,dst,dstStride,width,height);
+    }
+  
+  #ifdef ICL_HAVE_SSE2
+    template<>
+    void vhgw_transpose(const icl8u *src, int srcStride, icl8u *dst, int dstStride, int width, int height){
+      const int w16 = width & ~15, h16 = height & ~15;
+      __m128i r[16], t[16];
+      for(int y0=0;y0<h16;y0+=16){
+        for(int x0=0;x0<w16;x0+=16){
+          for(int i=0;i<16;++i){
+            r[i] = _mm_loadu_si128((const __m128i*)(src+(y0+i)*srcStride+x0));
+          }
+          // each of the 4 interleaving steps rotates the 8 bit (row,column)
+          // index of the elements by one bit, which transposes the block at the end
+          for(int s=0;s<4;++s){
+            for(int i=0;i<8;++i){
+              t[2*i] = _mm_unpacklo_epi8(r[i],r[i+8]);
+              t[2*i+1] = _mm_unpackhi_epi8(r[i],r[i+8]);
+            }
+            std::copy(t,t+16,r);
+          }
+          for(int i=0;i<16;++i){
+            _mm_storeu_si128((__m128i*)(dst+(x0+i)*dstStride+y0),r[i]);
+          }
+        }
+      }
+      if(w16 < width) vhgw_transpose_scalar(src+w16,srcStride,dst+w16*dstStride,dstStride,width-w16,h16);
+      if(h16 < height) vhgw_transpose_scalar(src+h16*srcStride,srcStride,dst+h16,dstStride,width,height-h16);
+    }
+  
+    template<>
+    void vhgw_transpose(const icl32f *src, int srcStride, icl32f *dst, int dstStride, int width, int height){
+      const int w4 = width & ~3, h4 = height & ~3;
+      for(int y0=0;y0<h4;y0+=4){
+        const icl32f *s = src+y0*srcStride;
+        for(int x0=0;x0<w4;x0+=4){
+          __m128 r0 = _mm_loadu_ps(s+x0), r1 = _mm_loadu_ps(s+srcStride+x0);
+          __m128 r2 = _mm_loadu_ps(s+2*srcStride+x0), r3 = _mm_loadu_ps(s+3*srcStride+x0);
+          _MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+          icl32f *d = dst+x0*dstStride+y0;
+          _mm_storeu_ps(d,r0);
+          _mm_storeu_ps(d+dstStride,r1);
+          _mm_storeu_ps(d+2*dstStride,r2);
+          _mm_storeu_ps(d+3*dstStride,r3);
+        }
+      }
+      if(w4 < width) vhgw_transpose_scalar(src+w4,srcStride,dst+w4*dstStride,dstStride,width-w4,h4);
+      if(h4 < height) vhgw_transpose_scalar(src+h4*srcStride,srcStride,dst+h4,dstStride,width,height-h4);
+    }
+  #endif
+  
+    /// returns whether all entries of the given mask are set
+    static bool is_rect_mask(const icl8u *mask, const Size &size){
+      for(int i=0;i<size.getDim();++i){
+        if(!mask[i]) return false;
+      }
+      return true;
+    }
+  
+    /// dilation (MAX=true) or erosion with a rectangular mask (van Herk/Gil-Werman)
+    /** The 2D maximum is separated into a vertical and a horizontal 1D pass,
+        each using a constant number of comparisons per pixel. The horizontal
+        pass is applied to the transposed result of the vertical pass, so that
+        both passes can be vectorized across image rows. The results are
+        identical to the ones of morph_cpp with a mask, that has no zero
+        entries */
+    template<class T, bool MAX>
+    void morph_rect(const Img<T> &src, Img<T> &dst, MorphologicalOp &op, T init){
+      const Size m = op.getMaskSize();
+      const Size r = dst.getROISize();
+      const Point o = op.getROIOffset() - op.getAnchor();
+      const int w = r.width + m.width - 1;
+      const int sw = src.getWidth();
+      const int n = iclMax(w,r.height);
+      
+      std::vector<T> buf(n*(2*iclMax(m.width,m.height) + 1) + 3*w*r.height);
+      T *S = buf.data(), *P = S + n*iclMax(m.width,m.height);
+      T *I = P + n*iclMax(m.width,m.height);
+      T *V = I + n, *VT = V + w*r.height, *RT = VT + w*r.height;
+      std::fill(I,I+n,init);
+      
+      for(int c=0;c<src.getChannels();++c){
+        const T *s = src.getData(c) + o.x + o.y*sw;
+        T *d = dst.getROIData(c);
+        if(m.width == 1){
+          vhgw_columns<T,MAX>(s,sw,d,dst.getWidth(),r.width,r.height,m.height,S,P,I);
+          continue;
+        }
+        vhgw_columns<T,MAX>(s,sw,V,w,w,r.height,m.height,S,P,I);
+        vhgw_transpose(V,w,VT,r.height,w,r.height);
+        vhgw_columns<T,MAX>(VT,r.height,RT,r.height,r.height,r.width,m.width,S,P,I);
+        vhgw_transpose(RT,r.height,d,dst.getWidth(),r.height,r.width);
+      }
+    }
+
     static Rect shrink_roi(Rect roi, const Size &maskSize){
       int dx = (maskSize.width-1)/2;
       int dy = (maskSize.height-1)/2;
@@ -92,20 +283,24 @@ namespace icl {
         std::copy(getMask(),getMask()+sizeSave.getDim(),back_inserter(maskSave));
         setMask(Size(3,3));
       }
+      const bool rect = m_rectFastPath && is_rect_mask(getMask(),getMaskSize());
       switch (m_eType){
         case dilate:
         case dilate3x3:
         case dilateBorderReplicate: 
-          morph_cpp(src,dst,*this,limits.minVal,std::greater<T>(),getMask()); 
+          if(rect) morph_rect<T,true>(src,dst,*this,limits.minVal);
+          else morph_cpp(src,dst,*this,limits.minVal,std::greater<T>(),getMask()); 
           break;
         case erode: 
         case erode3x3:
         case erodeBorderReplicate: 
-          morph_cpp(src,dst,*this,limits.maxVal,std::less<T>(),getMask()); 
+          if(rect) morph_rect<T,false>(src,dst,*this,limits.maxVal);
+          else morph_cpp(src,dst,*this,limits.maxVal,std::less<T>(),getMask()); 
           break;
         case tophatBorder:
         case blackhatBorder:{
           MorphologicalOp op(m_eType==tophatBorder ? openBorder : closeBorder,getMaskSize(),getMask());
+          op.setRectangularFastPath(m_rectFastPath);
           op.setClipToROI(getClipToROI());
           op.setCheckOnly(getCheckOnly());
           op.apply(poSrc,&m_openingAndClosingBuffer);
@@ -129,6 +324,7 @@ namespace icl {
         }
         case gradientBorder:{
           MorphologicalOp op(closeBorder,getMaskSize(),getMask());
+          op.setRectangularFastPath(m_rectFastPath);
           op.setClipToROI(getClipToROI());
           op.setCheckOnly(getCheckOnly());
           op.apply(poSrc,&m_gradientBorderBuffer_1);
@@ -144,10 +340,11 @@ namespace icl {
         case openBorder:
         case closeBorder:{
           MorphologicalOp op(m_eType==openBorder ? erode : dilate,getMaskSize(),getMask());
+          op.setRectangularFastPath(m_rectFastPath);
           op.setClipToROI(getClipToROI());
           op.setCheckOnly(getCheckOnly());
           op.apply(poSrc,&m_openingAndClosingBuffer);
-          op.setOptype(m_eType==openBorder ? erode : dilate);
+          op.setOptype(m_eType==openBorder ? dilate : erode);
           op.apply(m_openingAndClosingBuffer,ppoDst);
           break;
         }
@@ -183,20 +380,21 @@ namespace icl {
     }
   
     MorphologicalOp::MorphologicalOp (optype eOptype, const Size &maskSize,const icl8u *pcMask):
-      m_openingAndClosingBuffer(0),m_gradientBorderBuffer_1(0),m_gradientBorderBuffer_2(0)
+      m_openingAndClosingBuffer(0),m_gradientBorderBuffer_1(0),m_gradientBorderBuffer_2(0),
+      m_rectFastPath(true)
     {
       ICLASSERT_RETURN(maskSize.getDim());
       m_pcMask = 0;
-      setMask (maskSize,pcMask);
       m_eType = eOptype;    
+      setMask (maskSize,pcMask);
     }
 
     MorphologicalOp::MorphologicalOp (const std::string &o, const Size &maskSize,const icl8u *pcMask):
-      m_openingAndClosingBuffer(0),m_gradientBorderBuffer_1(0),m_gradientBorderBuffer_2(0)
+      m_openingAndClosingBuffer(0),m_gradientBorderBuffer_1(0),m_gradientBorderBuffer_2(0),
+      m_rectFastPath(true)
     {
       ICLASSERT_RETURN(maskSize.getDim());
       m_pcMask = 0;
-      setMask (maskSize,pcMask);
 
 #define CHECK_OPTYPE(X) else if(o == #X) { m_eType = X; }
       if(o == "dilate") { m_eType = dilate; }
@@ -214,6 +412,8 @@ namespace icl {
       else{
         throw ICLException("MorphologicalOp::MorphologicalOp: invalid optype string!");
       }
+      // the NeighborhoodOp mask size depends on the optype
+      setMask (maskSize,pcMask);
     }
 
 
@@ -227,7 +427,9 @@ namespace icl {
   
   
   #else //  ICL_HAVE_IPP is defined !
-    MorphologicalOp::MorphologicalOp (optype eOptype, const Size &maskSize,const icl8u *pcMask){
+    MorphologicalOp::MorphologicalOp (optype eOptype, const Size &maskSize,const icl8u *pcMask):
+      m_rectFastPath(true)
+    {
       ICLASSERT_RETURN(maskSize.getDim());
       
       m_eType=eOptype;    
@@ -247,10 +449,11 @@ namespace icl {
       m_pAdvState32f = 0;
     }
     
-    MorphologicalOp::MorphologicalOp (const std::string &o, const Size &maskSize,const icl8u *pcMask){
+    MorphologicalOp::MorphologicalOp (const std::string &o, const Size &maskSize,const icl8u *pcMask):
+      m_rectFastPath(true)
+    {
       ICLASSERT_RETURN(maskSize.getDim());
       m_pcMask = 0;
-      setMask (maskSize,pcMask);
 
     m_bMorphState8u=false;
       m_bMorphState32f=false;
@@ -280,6 +483,8 @@ namespace icl {
       else{
         throw ICLException("MorphologicalOp::MorphologicalOp: invalid optype string!");
       }
+      // the NeighborhoodOp mask size depends on the optype
+      setMask (maskSize,pcMask);
     }
 
 
@@ -461,7 +666,7 @@ namespace icl {
     template<typename T, IppStatus (IPP_DECL *ippiFunc) (const T*, int, T*, int, IppiSize, const Ipp8u*, IppiSize, IppiPoint)>
     IppStatus MorphologicalOp::ippiMorphologicalCall (const Img<T> *src, Img<T> *dst) {
       for(int c=0; c < src->getChannels(); c++) {
-        IppStatus s = ippiFunc(src->getROIData (c, this->m_oROIOffset),
+        IppStatus s = ippiFunc(src->getROIData (c, getROIOffset()),
                                src->getLineStep(),
                                dst->getROIData (c),
                                dst->getLineStep(),
@@ -475,7 +680,7 @@ namespace icl {
     template<typename T, IppStatus (IPP_DECL *ippiFunc) (const T*, int, T*, int, IppiSize)>
     IppStatus MorphologicalOp::ippiMorphologicalCall3x3 (const Img<T> *src, Img<T> *dst) {
       for(int c=0; c < src->getChannels(); c++) {
-        IppStatus s = ippiFunc(src->getROIData (c, this->m_oROIOffset),
+        IppStatus s = ippiFunc(src->getROIData (c, getROIOffset()),
                                src->getLineStep(),
                                dst->getROIData (c),
                                dst->getLineStep(),
@@ -489,7 +694,7 @@ namespace icl {
     template<typename T, IppStatus (IPP_DECL *ippiFunc) (const T*, int, T*, int, IppiSize, _IppiBorderType, IppiMorphState*)>
     IppStatus MorphologicalOp::ippiMorphologicalBorderReplicateCall (const Img<T> *src, Img<T> *dst,IppiMorphState* state) {
       for(int c=0; c < src->getChannels(); c++) {
-        IppStatus s = ippiFunc(src->getROIData (c, this->m_oROIOffset),
+        IppStatus s = ippiFunc(src->getROIData (c, getROIOffset()),
                                src->getLineStep(),
                                dst->getROIData (c),
                                dst->getLineStep(),
@@ -505,7 +710,7 @@ namespace icl {
     template<typename T, IppStatus (IPP_DECL *ippiFunc) (const T*, int, T*, int, IppiSize, IppiBorderType, IppiMorphAdvState*)>
     IppStatus MorphologicalOp::ippiMorphologicalBorderCall (const Img<T> *src, Img<T> *dst, IppiMorphAdvState* advState) {
       for(int c=0; c < src->getChannels(); c++) {
-        IppStatus s = ippiFunc(src->getROIData (c, this->m_oROIOffset),
+        IppStatus s = ippiFunc(src->getROIData (c, getROIOffset()),
                                src->getLineStep(),
                                dst->getROIData (c),
                                dst->getLineStep(),
@@ -527,17 +732,21 @@ namespace icl {
       
       if(m_eType >= 6){
         NeighborhoodOp::setMask (Size(1,1));
+      }else if(m_eType == dilate3x3 || m_eType == erode3x3){
+        NeighborhoodOp::setMask (Size(3,3));
       }else{
         NeighborhoodOp::setMask (maskSize);
       }
   
-      ICL_DELETE_ARRAY(m_pcMask);
-      m_pcMask = new icl8u[maskSize.getDim()];
+      // pcMask might be the current mask (e.g. when called from setOptype)
+      icl8u *newMask = new icl8u[maskSize.getDim()];
       if(pcMask){
-        std::copy(pcMask,pcMask+maskSize.getDim(),m_pcMask);
+        std::copy(pcMask,pcMask+maskSize.getDim(),newMask);
       }else{
-        std::fill(m_pcMask,m_pcMask+maskSize.getDim(),255);
+        std::fill(newMask,newMask+maskSize.getDim(),255);
       }
+      ICL_DELETE_ARRAY(m_pcMask);
+      m_pcMask = newMask;
   
       m_oMaskSizeMorphOp=maskSize;
       m_bHas_changed=true;
@@ -557,6 +766,12 @@ namespace icl {
     MorphologicalOp::optype MorphologicalOp::getOptype() const{
       return m_eType;
     }
+
+    bool MorphologicalOp::prepareSplitting(const ImgBase *src, ImgBase **dst){
+      if(m_eType != dilate && m_eType != erode) return false;
+      if(src->getDepth() != depth8u && src->getDepth() != depth32f) return false;
+      return prepare(dst,src);
+    }
   
   
   } // namespace filter
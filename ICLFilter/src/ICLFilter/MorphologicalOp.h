@@ -67,8 +67,7 @@ namespace icl {
         -# <b>erosion</b>: destination image pixel becomes the the minimum
            pixel of all pixels within mask 
         -# <b>erosion3x3 and dilatation3x3</b>: this is just a shortcut 
-           for using a 3x3 mask where all entries are set to 1. IPP obviously
-           does a lot of optimizations here, fallback doesn't
+           for using a 3x3 mask where all entries are set to 1
         -# <b>dilate/erode border replicate</b>: as standard operation, except
            copying border pixels from closes valid computed pixels (not tested 
            well in fallback case)
@@ -78,6 +77,19 @@ namespace icl {
         -# <b>blackhat</b> closing result - source image
         -# <b>gradient</b> closing result - opened result
   
+        \section RECT Rectangular Masks
+        If ICL is built without IPP, dilatation and erosion with masks that
+        have no zero entries (which is also the case for the default mask)
+        are computed by the van Herk/Gil-Werman algorithm: The rectangular
+        maximum/minimum is separated into a vertical and a horizontal running
+        maximum/minimum, that need only 3 comparisons per pixel each,
+        independent of the mask size. The passes are vectorized using SSE2
+        for Img8u and Img32f. Since all other operations are composed of
+        dilatations and erosions, they benefit as well. The results are
+        identical to the ones of the generic implementation, which can still
+        be selected using setRectangularFastPath(false), e.g. for benchmarking
+        (see the morphology-benchmark example).
+  
         \section EX Examples
         As a useful help, some example images are shown here:
   
@@ -143,11 +155,25 @@ namespace icl {
       */
       optype getOptype() const;
       
+      /// enables/disables the van Herk/Gil-Werman implementation for rectangular masks (default: true)
+      /** This has no effect if IPP is used */
+      void setRectangularFastPath(bool on) { m_rectFastPath = on; }
+      
+      /// returns whether the van Herk/Gil-Werman implementation is used for rectangular masks
+      bool getRectangularFastPath() const { return m_rectFastPath; }
+      
       /// Performs morph of an image with given optype and mask.
       void apply (const core::ImgBase *poSrc, core::ImgBase **ppoDst);
       
       /// Import unaryOps apply function without destination image
       using UnaryOp::apply;
+
+    protected:
+      /// only plain dilation and erosion can be applied to image parts
+      /** All other types use internal buffers or temporarily change the mask */
+      virtual bool prepareSplitting(const core::ImgBase *src, core::ImgBase **dst);
+
+    public:
       
   #ifdef ICL_HAVE_IPP
     private:
@@ -197,6 +223,7 @@ namespace icl {
     
       
       optype m_eType;
+      bool m_rectFastPath;
   
     };
   } // namespace filter
@@ -44,14 +44,22 @@ namespace icl {
     }
     bool NeighborhoodOp::prepare (ImgBase **ppoDst, const ImgBase *poSrc, depth eDepth) {
       Size oROIsize;   //< to-be-used ROI size
-      if (!computeROI (poSrc, m_oROIOffset, oROIsize)) return false;
+      // image parts only check their destination (their offset is passed with the part)
+      Point splitROIOffset;
+      Point &roiOffset = isSplitting() ? splitROIOffset : m_oROIOffset;
+      if (!computeROI (poSrc, roiOffset, oROIsize)) return false;
       
       return UnaryOp::prepare (ppoDst, eDepth, 
                       getClipToROI() ? oROIsize : poSrc->getSize(),
                       poSrc->getFormat(), poSrc->getChannels (), 
-                      Rect (getClipToROI() ? Point::null : m_oROIOffset, oROIsize),
+                      Rect (getClipToROI() ? Point::null : roiOffset, oROIsize),
                       poSrc->getTime());
     }
+
+    Rect NeighborhoodOp::beginSplitting(const ImgBase *src, const ImgBase *dst){
+      (void)src;
+      return Rect(m_oROIOffset,dst->getROISize());
+    }
    
     bool NeighborhoodOp::computeROI(const ImgBase *poSrc, Point& oROIoffset, Size& oROIsize) {
       // NEW Code
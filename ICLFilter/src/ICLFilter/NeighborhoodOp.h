@@ -106,7 +106,7 @@ namespace icl {
         return m_oAnchor;
       }
       const utils::Point &getROIOffset() const{
-        return m_oROIOffset;
+        return isSplitting() ? getSplitSourceOffset() : m_oROIOffset;
       }
       protected:
   
@@ -124,6 +124,12 @@ namespace icl {
            @return the given size in this base implementation
            **/
       virtual utils::Size adaptSize(const utils::Size &size){ return size; }
+
+      /// returns the adapted source ROI
+      /** While image parts are processed in parallel, the source parts are
+          cut from this ROI, so the ROI offset of each part is the part's own
+          source ROI offset (see UnaryOp::getSplitSourceOffset) */
+      virtual utils::Rect beginSplitting(const core::ImgBase *src, const core::ImgBase *dst);
        
       protected:
        ///TODO: later private with getter and setter functions
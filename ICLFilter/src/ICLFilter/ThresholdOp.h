@@ -92,6 +92,14 @@ namespace icl {
         
         /// Import unaryOps apply function without destination image
         using UnaryOp::apply;
+
+     protected:
+        /// thresholding is a pixel-wise operation (see UnaryOp::prepareSplitting)
+        virtual bool prepareSplitting(const core::ImgBase *src, core::ImgBase **dst){
+          return UnaryOp::prepare(dst,src);
+        }
+
+     public:
   
         /// returns the lower threshold
         /**
@@ -30,6 +30,7 @@
 
 #include <ICLUtils/Macros.h>
 #include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
 #include <ICLFilter/UnaryOp.h>
 #include <ICLFilter/UnaryOpWork.h>
 #include <ICLFilter/ImageSplitter.h>
@@ -39,6 +40,7 @@
 #include <ICLFilter/RotateOp.h>
 #include <ICLFilter/ScaleOp.h>
 #include <map>
+#include <pthread.h>
 
 #ifdef ICL_HAVE_IPP
 #include <ICLFilter/CannyOp.h>
@@ -67,15 +69,23 @@ namespace icl{
                   "method are not adapted. Instead the given result images are checked\n"
                   "for their compatibility. In case of uncompatible result images,\n"
                   "an exception is thrown.");
+      addProperty("UnaryOp.execution policy","menu","sequential,row bands,tiles","sequential",0,
+                  "Defines whether the operator is applied in parallel. If set to\n"
+                  "row bands or tiles, the destination ROI is split into parts that\n"
+                  "are processed by the threads of the global task scheduler\n"
+                  "(only supported by some operators)");
     }
   
-    UnaryOp::UnaryOp():m_poMT(0),m_buf(0){
+    UnaryOp::UnaryOp():m_poMT(0),m_executionPolicy(executeSequential),
+                       m_tileSize(128,128),m_splitting(false),m_buf(0){
       initConfigurable();
     }
     
     UnaryOp::UnaryOp(const UnaryOp &other):
-      m_poMT(0),m_oROIHandler(other.m_oROIHandler),m_buf(0){
+      m_poMT(0),m_oROIHandler(other.m_oROIHandler),m_executionPolicy(executeSequential),
+      m_tileSize(other.m_tileSize),m_splitting(false),m_buf(0){
       initConfigurable();
+      setExecutionPolicy(other.m_executionPolicy,other.m_tileSize);
     }
     
     UnaryOp &UnaryOp::operator=(const UnaryOp &other){
@@ -84,6 +94,7 @@ namespace icl{
       
       prop("UnaryOp.clip to ROI").value = other.prop("UnaryOp.clip to ROI").value;
       prop("UnaryOp.check only").value = other.prop("UnaryOp.check only").value;
+      setExecutionPolicy(other.m_executionPolicy,other.m_tileSize);
       
       return *this;
     }
@@ -93,9 +104,128 @@ namespace icl{
     }
     
     const ImgBase *UnaryOp::apply(const ImgBase *src){
-      apply(src,&m_buf);
+      applyParallel(src,&m_buf);
       return m_buf;
     }
+
+    void UnaryOp::setExecutionPolicy(ExecutionPolicy policy, const Size &tileSize){
+      ICLASSERT_RETURN(tileSize.width > 0 && tileSize.height > 0);
+      m_executionPolicy = policy;
+      m_tileSize = tileSize;
+      static const char *names[] = { "sequential", "row bands", "tiles" };
+      prop("UnaryOp.execution policy").value = names[(int)policy];
+      call_callbacks("UnaryOp.execution policy",this);
+    }
+
+    namespace{
+      struct UnaryOpPartTask;
+
+      /// thread local stack of the image parts that are processed by a thread
+      /** A thread, that waits for nested parallel work, may process parts of
+          other operators (or other parts of the same operator) meanwhile */
+      pthread_key_t s_partKey;
+      pthread_once_t s_partKeyOnce = PTHREAD_ONCE_INIT;
+      void create_part_key(){
+        pthread_key_create(&s_partKey,0);
+      }
+      UnaryOpPartTask *get_current_part(){
+        pthread_once(&s_partKeyOnce,create_part_key);
+        return static_cast<UnaryOpPartTask*>(pthread_getspecific(s_partKey));
+      }
+      void set_current_part(UnaryOpPartTask *t){
+        pthread_once(&s_partKeyOnce,create_part_key);
+        pthread_setspecific(s_partKey,t);
+      }
+
+      struct UnaryOpPartTask : public TaskScheduler::Task{
+        UnaryOpPartTask(UnaryOp *op, const ImgBase *src, ImgBase *dst):
+          op(op),src(src),dst(dst),srcOffset(src->getROIOffset()),prev(0){}
+        ~UnaryOpPartTask(){
+          delete src;
+          delete dst;
+        }
+        virtual void run(){
+          prev = get_current_part();
+          set_current_part(this);
+          try{
+            op->apply(src,&dst);
+          }catch(...){
+            set_current_part(prev);
+            throw;
+          }
+          set_current_part(prev);
+        }
+        UnaryOp *op;
+        const ImgBase *src;
+        ImgBase *dst;
+        Point srcOffset;        //!< source ROI offset of this part
+        UnaryOpPartTask *prev;  //!< part, the thread was processing before
+      };
+    }
+
+    const Point &UnaryOp::getSplitSourceOffset() const{
+      for(const UnaryOpPartTask *t = get_current_part(); t; t = t->prev){
+        if(t->op == this) return t->srcOffset;
+      }
+      throw ICLException("UnaryOp::getSplitSourceOffset: the calling thread does not process an image part of this operator");
+    }
+
+    void UnaryOp::applyParallel(const ImgBase *src, ImgBase **dst){
+      ICLASSERT_RETURN(src);
+      ICLASSERT_RETURN(dst);
+      const int nThreads = TaskScheduler::instance().getNumThreads();
+      if(m_executionPolicy == executeSequential || nThreads < 2 || m_splitting ||
+         src == *dst || !prepareSplitting(src,dst)){
+        apply(src,dst);
+        return;
+      }
+
+      const Rect dstROI = (*dst)->getROI();
+      std::vector<Rect> parts;
+      if(m_executionPolicy == executeRowBands){
+        const int n = iclMin(dstROI.height, 4*nThreads);
+        for(int i=0;i<n;++i){
+          const int yStart = (i*dstROI.height)/n, yEnd = ((i+1)*dstROI.height)/n;
+          parts.push_back(Rect(0,yStart,dstROI.width,yEnd-yStart));
+        }
+      }else{
+        for(int y=0;y<dstROI.height;y+=m_tileSize.height){
+          for(int x=0;x<dstROI.width;x+=m_tileSize.width){
+            parts.push_back(Rect(x,y,iclMin(m_tileSize.width,dstROI.width-x),
+                                 iclMin(m_tileSize.height,dstROI.height-y)));
+          }
+        }
+      }
+
+      // the destination image was prepared already: the parts are only checked
+      const bool ctr = getClipToROI();
+      const bool co = getCheckOnly();
+      m_oROIHandler.setClipToROI(false);
+      m_oROIHandler.setCheckOnly(true);
+
+      const Rect srcROI = beginSplitting(src,*dst);
+      m_splitting = true;
+
+      std::string error;
+      {
+        TaskGroup group;
+        for(unsigned int i=0;i<parts.size();++i){
+          const Rect &p = parts[i];
+          group.run(new UnaryOpPartTask(this,src->shallowCopy(p+srcROI.ul()),
+                                        (*dst)->shallowCopy(p+dstROI.ul())));
+        }
+        try{
+          group.wait();
+        }catch(const ICLException &ex){
+          error = ex.what();
+        }
+      }
+
+      m_splitting = false;
+      m_oROIHandler.setClipToROI(ctr);
+      m_oROIHandler.setCheckOnly(co);
+      if(error.length()) throw ICLException(error);
+    }
   
     
     void UnaryOp::applyMT(const ImgBase *poSrc, ImgBase **ppoDst, unsigned int nThreads){
@@ -421,6 +551,10 @@ namespace icl{
     void UnaryOp::setPropertyValue(const std::string &propertyName, const Any &value) throw (ICLException){
       if(propertyName == "UnaryOp.clip to ROI") setClipToROI(value == "on");
       else if(propertyName == "UnaryOp.check only") setCheckOnly(value == "on");
+      else if(propertyName == "UnaryOp.execution policy"){
+        setExecutionPolicy(value == "row bands" ? executeRowBands :
+                           value == "tiles" ? executeTiles : executeSequential, m_tileSize);
+      }
       Configurable::setPropertyValue(propertyName,value);
     }
   
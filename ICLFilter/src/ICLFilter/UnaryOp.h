@@ -69,9 +69,45 @@ namespace icl{
       /// pure virtual apply function, that must be implemented in all derived classes
       virtual void apply(const core::ImgBase *operand1, core::ImgBase **dst)=0;
   
-      /// apply function for multithreaded filtering (currently even slower than using one thread)
+      /// apply function for multithreaded filtering
+      /** The image is split into nThreads parts, that are processed by the
+          threads of the global utils::TaskScheduler. Please use
+          setExecutionPolicy and applyParallel instead. */
       virtual ICL_DEPRECATED void applyMT(const core::ImgBase *operand1, 
                                           core::ImgBase **dst, unsigned int nThreads);
+
+      /// execution policies for applyParallel
+      enum ExecutionPolicy{
+        executeSequential, //!< the whole ROI is processed by the calling thread (default)
+        executeRowBands,   //!< the destination ROI is split into row bands
+        executeTiles       //!< the destination ROI is split into tiles of a given size
+      };
+
+      /// sets the execution policy used by applyParallel
+      /** The tile size is only used for the executeTiles policy */
+      void setExecutionPolicy(ExecutionPolicy policy, const utils::Size &tileSize=utils::Size(128,128));
+
+      /// returns the current execution policy
+      ExecutionPolicy getExecutionPolicy() const { return m_executionPolicy; }
+
+      /// returns the tile size used for the executeTiles policy
+      const utils::Size &getTileSize() const { return m_tileSize; }
+
+      /// applies the operator using the current execution policy
+      /** If the execution policy is executeSequential, or if the operator
+          does not support splitting (see prepareSplitting), this is identical
+          to apply(src,dst). Otherwise, the destination image is prepared as
+          usual and its ROI is split into row bands or tiles, which are processed
+          in parallel by the threads of the global utils::TaskScheduler. For
+          neighborhood operators, the source parts are views into the whole
+          source image, so the parts overlap by the mask size and the result
+          is identical to the result of apply.
+
+          The function operators and apply(src) call this function, so that
+          setting an execution policy is sufficient to parallelize code that
+          uses these. Currently, ConvolutionOp, MorphologicalOp (dilate/erode),
+          MedianOp, ThresholdOp and LUTOp support splitting. */
+      void applyParallel(const core::ImgBase *src, core::ImgBase **dst);
   
       /// applys the filter usign an internal buffer as output image 
       /** Normally, this function must not be reimplemented, because it's default implementation
@@ -81,7 +117,7 @@ namespace icl{
       
       /// function operator (alternative for apply(src,dst)
       inline void operator()(const core::ImgBase *src, core::ImgBase **dst){
-        apply(src,dst);
+        applyParallel(src,dst);
       }
 
       /// function operator for the implicit destination apply(src) call
@@ -176,11 +212,51 @@ namespace icl{
         return m_oROIHandler.prepare(ppoDst, poSrc, eDepth);
       }
   
+      /// prepares a call to applyParallel
+      /** Operators, that support parallel execution, reimplement this function.
+          It has to prepare the destination image exactly as apply would do it,
+          and it has to perform all lazy adaptions of internal data, because
+          apply is called concurrently for the image parts afterwards. The
+          default implementation returns false, which makes applyParallel fall
+          back to a single apply call.
+          @return whether the operator can be split for the given source image */
+      virtual bool prepareSplitting(const core::ImgBase *src, core::ImgBase **dst){
+        (void)src; (void)dst;
+        return false;
+      }
+
+      /// called once by applyParallel before the parts are processed
+      /** Returns the source image region, that corresponds to the ROI of the
+          prepared destination image. The default implementation returns the
+          source ROI offset with the destination ROI size. */
+      virtual utils::Rect beginSplitting(const core::ImgBase *src, const core::ImgBase *dst){
+        return utils::Rect(src->getROIOffset(),dst->getROISize());
+      }
+
+      /// returns whether applyParallel is processing image parts right now
+      bool isSplitting() const { return m_splitting; }
+
+      /// returns the source ROI offset of the image part, the calling thread processes
+      /** This must only be called from apply while isSplitting() returns true.
+          The offset is passed along with each image part, so the result is also
+          correct if the thread processes other parts while it waits for nested
+          parallel work */
+      const utils::Point &getSplitSourceOffset() const;
+
       utils::MultiThreader *m_poMT;
       
       private:
     
       OpROIHandler m_oROIHandler;
+
+      /// current execution policy
+      ExecutionPolicy m_executionPolicy;
+
+      /// tile size for the executeTiles policy
+      utils::Size m_tileSize;
+
+      /// true while applyParallel processes image parts
+      bool m_splitting;
       
       core::ImgBase *m_buf;
     };    
@@ -125,69 +125,11 @@ namespace icl{
     };
   #endif
 
-    template<class T>
-    T interpolate_pixel_nn(float x, float y, const Channel<T> &src){
-      if(x < 0) return T(0);
-      return src(round(x),round(y));
-    }
-    
-    template<class T>
-    T interpolate_pixel_lin(float x, float y, const Channel<T> &src){
-      float fX0 = x - floor(x), fX1 = 1.0 - fX0;
-      float fY0 = y - floor(y), fY1 = 1.0 - fY0;
-      int xll = (int) x;
-      int yll = (int) y;
-     
-      const T* pLL = &src(xll,yll);
-      float a = *pLL;        //  a b
-      float b = *(++pLL);    //  c d
-      pLL += src.getWidth();
-      float d = *pLL;
-      float c = *(--pLL);
-  
-      return fX1 * (fY1*a + fY0*c) + fX0 * (fY1*b + fY0*d);
-    }
-    
-  
-    template<class T>
-    static inline void apply_warp_2(const Channel32f warpMap[2],
-                                    const Channel<T> &src,
-                                    Channel<T> &dst,
-                                    const Size &size, T (*interpolator)(float x, float y, const Channel<T> &src)){
-  
-      for(int x=0;x<size.width;++x){
-        for(int y=0;y<size.height;++y){
-          int idx = x+size.width*y;
-          dst[idx] = interpolator(warpMap[0][idx],warpMap[1][idx],src);
-        }
-      }
-    }
-
-    template<class T>
-    static void apply_warp(const Channel32f warpMap[2], 
-                           const Img<T>&src, 
-                           Img<T> &dst,
-                           scalemode mode){
-      for(int c=0;c<src.getChannels();++c){
-        const Channel<T> s = src[c];
-        Channel<T> d = dst[c];
-        if(mode == interpolateNN){
-          apply_warp_2<T>(warpMap,s,d,s.getSize(),interpolate_pixel_nn<T>);
-        }else if(mode == interpolateLIN){
-          apply_warp_2<T>(warpMap,s,d,s.getSize(),interpolate_pixel_lin<T>);
-        }else{
-          ERROR_LOG("region average interpolation mode does not work here!");
-          return;
-        }
-      }
-    }          
-  
   #ifdef ICL_HAVE_IPP
-    template<>  
-    void apply_warp<icl8u>(const Channel32f warpMap[2], 
-                                  const Img<icl8u> &src, 
-                                  Img<icl8u> &dst,
-                                  scalemode mode){
+    static void apply_warp_ipp(const Channel32f warpMap[2], 
+                               const Img<icl8u> &src, 
+                               Img<icl8u> &dst,
+                               scalemode mode){
       for(int c=0;c<src.getChannels();++c){
         IppStatus s = ippiRemap_8u_C1R(src.begin(c),src.getSize(),src.getLineStep(),
                                        src.getImageRect(),warpMap[0].begin(),sizeof(icl32f)*warpMap[0].getWidth(),
@@ -199,11 +141,10 @@ namespace icl{
         }
       }
     }
-    template<>  
-    void apply_warp<icl32f>(const Channel32f warpMap[2], 
-                                   const Img<icl32f> &src, 
-                                   Img<icl32f> &dst,
-                                   scalemode mode){
+    static void apply_warp_ipp(const Channel32f warpMap[2], 
+                               const Img<icl32f> &src, 
+                               Img<icl32f> &dst,
+                               scalemode mode){
       for(int c=0;c<src.getChannels();++c){
         IppStatus s = ippiRemap_32f_C1R(src.begin(c),src.getSize(),src.getLineStep(),
                                        src.getImageRect(),warpMap[0].begin(),sizeof(icl32f)*warpMap[0].getWidth(),
@@ -215,9 +156,6 @@ namespace icl{
         }
       }
     }
-  
-    
-    // specialization for apply_warp<icl8u> and <icl32f>
   #endif
   
     void prepare_warp_table_inplace(Img32f &warpMap){
@@ -238,7 +176,8 @@ namespace icl{
     
   
     WarpOp::WarpOp(const Img32f &warpMap,scalemode mode, bool allowWarpMapScaling):
-      m_allowWarpMapScaling(allowWarpMapScaling),m_scaleMode(mode),m_tryUseOpenCL(false){
+      m_allowWarpMapScaling(allowWarpMapScaling),m_scaleMode(mode),m_tryUseOpenCL(false),
+      m_tableDirty(true){
       warpMap.deepCopy(&m_warpMap);
       prepare_warp_table_inplace(m_warpMap);
   #ifdef ICL_HAVE_OPENCL
@@ -259,6 +198,7 @@ namespace icl{
       warpMap.deepCopy(&m_warpMap);
       prepare_warp_table_inplace(m_warpMap);
       m_scaledWarpMap = Img32f();
+      m_tableDirty = true;
   #ifdef ICL_HAVE_OPENCL
       m_clWarp->setWarpMap(m_warpMap);
   #endif
@@ -315,18 +255,30 @@ namespace icl{
       }
   #endif
 
-      switch(src->getDepth()){
-  #define ICL_INSTANTIATE_DEPTH(D)                                 \
-        case depth##D:                                             \
-        apply_warp<icl##D>(cwm,*src->asImg<icl##D>(),              \
-                           *(*dst)->asImg<icl##D>(),m_scaleMode);  \
-        break;
-        ICL_INSTANTIATE_ALL_DEPTHS;
-        default:
-          ICL_INVALID_DEPTH;
-  #undef ICL_INSTANTIATE_DEPTH
-  
+  #ifdef ICL_HAVE_IPP
+      if(m_scaleMode != interpolateRA){
+        if(src->getDepth() == depth8u){
+          apply_warp_ipp(cwm,*src->asImg<icl8u>(),*(*dst)->asImg<icl8u>(),m_scaleMode);
+          return;
+        }else if(src->getDepth() == depth32f){
+          apply_warp_ipp(cwm,*src->asImg<icl32f>(),*(*dst)->asImg<icl32f>(),m_scaleMode);
+          return;
+        }
+      }
+  #endif
+
+      if(m_scaleMode != interpolateNN && m_scaleMode != interpolateLIN){
+        ERROR_LOG("region average interpolation mode does not work here!");
+        return;
+      }
+
+      // the fixed point table is compiled once for each warp map, size and mode
+      const Img32f &warpMap = src->getSize() == m_warpMap.getSize() ? m_warpMap : m_scaledWarpMap;
+      if(m_tableDirty || m_table.getSize() != warpMap.getSize() || m_table.getScaleMode() != m_scaleMode){
+        m_table.compile(warpMap,m_scaleMode);
+        m_tableDirty = false;
       }
+      m_table.apply(src,*dst);
     }
   
     void WarpOp::setTryUseOpenCL(bool on){
@@ -33,6 +33,7 @@
 #include <ICLUtils/CompatMacros.h>
 #include <ICLCore/Img.h>
 #include <ICLFilter/UnaryOp.h>
+#include <ICLFilter/WarpTable.h>
 
 namespace icl{
   namespace filter{
@@ -62,6 +63,12 @@ namespace icl{
         \section IPP IPP-Support
         Support is purely optional and only defined in case of depth8u
         or depth32f input images
+
+        \section TAB Warp Tables
+        Without IPP, the warp map is compiled into a fixed point WarpTable
+        once (and again only if warp map, image size or interpolation mode
+        change), which is then applied row-major and multi-threaded.
+        Source coordinates are quantized to 1/128 pixel by this.
         
         \section PERF Performance
         As already mentioned, the operation performance does not depend
@@ -146,6 +153,8 @@ namespace icl{
       core::Img32f m_scaledWarpMap;
       core::scalemode m_scaleMode;
       bool m_tryUseOpenCL;
+      WarpTable m_table;
+      bool m_tableDirty;
 
 #ifdef ICL_HAVE_OPENCL
       struct CLWarp; // forward declaration
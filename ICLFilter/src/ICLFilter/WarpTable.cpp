@@ -0,0 +1,359 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/src/ICLFilter/WarpTable.cpp                  **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLFilter/WarpTable.h>
+#include <ICLUtils/ClippedCast.h>
+#include <ICLUtils/SSETypes.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <cmath>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace filter{
+
+    namespace{
+      /// fractional bits of the bilinear weights
+      static const int WEIGHT_BITS = 7;
+      static const int WEIGHT_ONE = 1 << WEIGHT_BITS;
+
+      /// images with less pixels are processed in the calling thread
+      static const int WARP_PARALLEL_MIN_PIXELS = 65536;
+
+      template<class T> struct WarpWork{ typedef float W; };
+      template<> struct WarpWork<icl64f>{ typedef icl64f W; };
+
+      template<class T, class W>
+      inline T warp_round(W v){ return clipped_cast<W,T>(v); }
+      template<> inline icl8u warp_round<icl8u,float>(float v){ return clipped_cast<float,icl8u>(v+0.5f); }
+      template<> inline icl16s warp_round<icl16s,float>(float v){ return clipped_cast<float,icl16s>(::floor(v+0.5f)); }
+      template<> inline icl32s warp_round<icl32s,float>(float v){ return clipped_cast<float,icl32s>(::floor(v+0.5f)); }
+
+      template<class T>
+      void warp_row_nn(const T *src, int srcWidth, const icl16s *xy, int n, T *dst){
+        for(int i=0;i<n;++i,xy+=2){
+          dst[i] = xy[0] < 0 ? T(0) : src[xy[1]*srcWidth + xy[0]];
+        }
+      }
+
+      template<class T>
+      void warp_row_lin_generic(const T *src, int srcWidth, const icl16s *xy, const icl8u *w, int n, T *dst){
+        typedef typename WarpWork<T>::W W;
+        static const W norm = W(1)/(WEIGHT_ONE*WEIGHT_ONE);
+        for(int i=0;i<n;++i,xy+=2,w+=2){
+          if(xy[0] < 0){
+            dst[i] = T(0);
+            continue;
+          }
+          const T *p = src + xy[1]*srcWidth + xy[0];
+          const W wx = w[0], wy = w[1], iwx = WEIGHT_ONE-w[0], iwy = WEIGHT_ONE-w[1];
+          const W top = iwx*p[0] + wx*p[1];
+          const W bottom = iwx*p[srcWidth] + wx*p[srcWidth+1];
+          dst[i] = warp_round<T,W>((iwy*top + wy*bottom)*norm);
+        }
+      }
+
+      template<class T>
+      void warp_row_lin_float(const T *src, int srcWidth, const icl16s *xy, const icl32f *w, int n, T *dst){
+        typedef typename WarpWork<T>::W W;
+        for(int i=0;i<n;++i,xy+=2,w+=2){
+          if(xy[0] < 0){
+            dst[i] = T(0);
+            continue;
+          }
+          const T *p = src + xy[1]*srcWidth + xy[0];
+          const W wx = w[0], wy = w[1];
+          const W top = p[0] + wx*(p[1]-p[0]);
+          const W bottom = p[srcWidth] + wx*(p[srcWidth+1]-p[srcWidth]);
+          dst[i] = warp_round<T,W>(top + wy*(bottom-top));
+        }
+      }
+
+      template<class T>
+      inline void warp_row_lin(const T *src, int srcWidth, const icl16s *xy, const icl8u *w, int n, T *dst){
+        warp_row_lin_generic(src,srcWidth,xy,w,n,dst);
+      }
+
+      /// depths, that use the 7 bit fixed point weights (all others use float weights)
+      template<class T> struct WarpFixedPoint{ static const bool value = false; };
+      template<> struct WarpFixedPoint<icl8u>{ static const bool value = true; };
+      template<> struct WarpFixedPoint<icl16s>{ static const bool value = true; };
+
+      /// returns whether the map position is valid (also rejects NaN)
+      /** same validity check as the rounded coordinates of the former implementation */
+      inline bool warp_valid(float fx, float fy, int sw, int sh){
+        return fx > -0.5f && fy > -0.5f && fx < sw-0.5f && fy < sh-0.5f;
+      }
+
+      /// computes the upper left pixel and the weights of the 2x2 neighbourhood (clamped to the image)
+      inline void warp_lin_coords(float fx, float fy, int sw, int sh, int &ix, int &iy, float &wx, float &wy){
+        ix = (int)::floor(fx);
+        iy = (int)::floor(fy);
+        wx = fx-ix;
+        wy = fy-iy;
+        if(ix < 0){ ix = 0; wx = 0; }
+        else if(ix > sw-2){ ix = sw-2; wx = 1; }
+        if(iy < 0){ iy = 0; wy = 0; }
+        else if(iy > sh-2){ iy = sh-2; wy = 1; }
+      }
+
+      inline void warp_store_weight(icl8u &w, float f){ w = (icl8u)::floor(f*WEIGHT_ONE+0.5f); }
+      inline void warp_store_weight(icl32f &w, float f){ w = f; }
+
+      /// calls f(fx,fy) for all warp map entries in tiled table order
+      template<class F>
+      void warp_visit_tiled(const Img32f &warpMap, F &f){
+        const int w = warpMap.getWidth(), h = warpMap.getHeight();
+        const icl32f *mx = warpMap.begin(0), *my = warpMap.begin(1);
+        for(int y0=0;y0<h;y0+=WarpTable::TILE_HEIGHT){
+          const int th = iclMin((int)WarpTable::TILE_HEIGHT,h-y0);
+          for(int x0=0;x0<w;x0+=WarpTable::TILE_WIDTH){
+            const int tw = iclMin((int)WarpTable::TILE_WIDTH,w-x0);
+            for(int y=y0;y<y0+th;++y){
+              for(int x=x0;x<x0+tw;++x){
+                f(mx[x+w*y],my[x+w*y]);
+              }
+            }
+          }
+        }
+      }
+
+      /// fills the source coordinates of the table
+      struct WarpCoordBuilder{
+        icl16s *xy;
+        int sw,sh;
+        bool lin;
+        void operator()(float fx, float fy){
+          if(!warp_valid(fx,fy,sw,sh)){
+            xy[0] = xy[1] = -1;
+          }else if(lin){
+            int ix,iy;
+            float wx,wy;
+            warp_lin_coords(fx,fy,sw,sh,ix,iy,wx,wy);
+            xy[0] = ix;
+            xy[1] = iy;
+          }else{
+            xy[0] = (icl16s)::floor(fx+0.5f);
+            xy[1] = (icl16s)::floor(fy+0.5f);
+          }
+          xy += 2;
+        }
+      };
+
+      /// fills the bilinear weights of the table (fixed point or float)
+      template<class W>
+      struct WarpWeightBuilder{
+        W *w;
+        int sw,sh;
+        void operator()(float fx, float fy){
+          if(!warp_valid(fx,fy,sw,sh)){
+            w[0] = w[1] = 0;
+          }else{
+            int ix,iy;
+            float wx,wy;
+            warp_lin_coords(fx,fy,sw,sh,ix,iy,wx,wy);
+            warp_store_weight(w[0],wx);
+            warp_store_weight(w[1],wy);
+          }
+          w += 2;
+        }
+      };
+
+      template<class W>
+      void build_warp_weights(const Img32f &warpMap, const Size &srcSize, std::vector<W> &weights){
+        weights.resize(2*warpMap.getDim());
+        if(weights.empty()) return;
+        WarpWeightBuilder<W> b = { &weights[0], srcSize.width, srcSize.height };
+        warp_visit_tiled(warpMap,b);
+      }
+
+  #ifdef ICL_HAVE_SSE2
+      template<>
+      void warp_row_lin(const icl8u *src, int srcWidth, const icl16s *xy, const icl8u *w, int n, icl8u *dst){
+        static const int ROUND = 1 << (2*WEIGHT_BITS-1);
+        const __m128i one = _mm_set1_epi16(WEIGHT_ONE);
+        const __m128i mask = _mm_set1_epi16(0xff);
+        const __m128i round = _mm_set1_epi32(ROUND);
+        const __m128i z = _mm_setzero_si128();
+        int i=0;
+        for(;i<=n-8;i+=8){
+          icl16s a[8],b[8],c[8],d[8];
+          for(int j=0;j<8;++j){
+            const icl16s *e = xy + 2*(i+j);
+            if(e[0] < 0){
+              a[j] = b[j] = c[j] = d[j] = 0;
+            }else{
+              const icl8u *p = src + e[1]*srcWidth + e[0];
+              a[j] = p[0];
+              b[j] = p[1];
+              c[j] = p[srcWidth];
+              d[j] = p[srcWidth+1];
+            }
+          }
+          const __m128i ww = _mm_loadu_si128((const __m128i*)(w+2*i));
+          const __m128i wx = _mm_and_si128(ww,mask), wy = _mm_srli_epi16(ww,8);
+          const __m128i iwx = _mm_sub_epi16(one,wx), iwy = _mm_sub_epi16(one,wy);
+          // horizontal pass: values are <= 255*128 and therefore fit into signed 16 bit
+          const __m128i top = _mm_add_epi16(_mm_mullo_epi16(_mm_loadu_si128((const __m128i*)a),iwx),
+                                            _mm_mullo_epi16(_mm_loadu_si128((const __m128i*)b),wx));
+          const __m128i bottom = _mm_add_epi16(_mm_mullo_epi16(_mm_loadu_si128((const __m128i*)c),iwx),
+                                               _mm_mullo_epi16(_mm_loadu_si128((const __m128i*)d),wx));
+          // vertical pass: top*iwy + bottom*wy
+          __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(top,bottom),_mm_unpacklo_epi16(iwy,wy));
+          __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(top,bottom),_mm_unpackhi_epi16(iwy,wy));
+          lo = _mm_srai_epi32(_mm_add_epi32(lo,round),2*WEIGHT_BITS);
+          hi = _mm_srai_epi32(_mm_add_epi32(hi,round),2*WEIGHT_BITS);
+          _mm_storel_epi64((__m128i*)(dst+i),_mm_packus_epi16(_mm_packs_epi32(lo,hi),z));
+        }
+        for(;i<n;++i){
+          const icl16s *e = xy + 2*i;
+          if(e[0] < 0){
+            dst[i] = 0;
+            continue;
+          }
+          const icl8u *p = src + e[1]*srcWidth + e[0];
+          const int wx = w[2*i], wy = w[2*i+1];
+          const int top = (WEIGHT_ONE-wx)*p[0] + wx*p[1];
+          const int bottom = (WEIGHT_ONE-wx)*p[srcWidth] + wx*p[srcWidth+1];
+          dst[i] = (icl8u)(((WEIGHT_ONE-wy)*top + wy*bottom + ROUND) >> (2*WEIGHT_BITS));
+        }
+      }
+
+  #endif
+
+      /// processes bands of tile-rows
+      template<class T>
+      struct WarpBands{
+        const Img<T> *src;
+        Img<T> *dst;
+        Size size;
+        const icl16s *xy;
+        const icl8u *weights;
+        const icl32f *fweights;
+
+        void operator()(int begin, int end) const{
+          const int sw = src->getWidth();
+          for(int band=begin;band<end;++band){
+            const int y0 = band*WarpTable::TILE_HEIGHT;
+            const int th = iclMin((int)WarpTable::TILE_HEIGHT,size.height-y0);
+            for(int c=0;c<src->getChannels();++c){
+              const T *s = src->begin(c);
+              T *d = dst->begin(c);
+              for(int x0=0;x0<size.width;x0+=WarpTable::TILE_WIDTH){
+                const int tw = iclMin((int)WarpTable::TILE_WIDTH,size.width-x0);
+                const int base = y0*size.width + x0*th;
+                for(int r=0;r<th;++r){
+                  const int idx = base + r*tw;
+                  T *dr = d + (y0+r)*size.width + x0;
+                  if(weights) warp_row_lin(s,sw,xy+2*idx,weights+2*idx,tw,dr);
+                  else if(fweights) warp_row_lin_float(s,sw,xy+2*idx,fweights+2*idx,tw,dr);
+                  else warp_row_nn(s,sw,xy+2*idx,tw,dr);
+                }
+              }
+            }
+          }
+        }
+      };
+
+      template<class T>
+      void apply_warp_table(const Img<T> &src, Img<T> &dst, const Size &size,
+                            const icl16s *xy, const icl8u *weights, const icl32f *fweights){
+        const bool fixed = WarpFixedPoint<T>::value;
+        WarpBands<T> bands = { &src, &dst, size, xy, fixed ? weights : 0, fixed ? 0 : fweights };
+        const int nBands = (size.height + WarpTable::TILE_HEIGHT - 1)/WarpTable::TILE_HEIGHT;
+        if(size.getDim()*src.getChannels() < WARP_PARALLEL_MIN_PIXELS){
+          bands(0,nBands);
+        }else{
+          parallel_for(0,nBands,bands,1);
+        }
+      }
+    }
+
+    WarpTable::WarpTable():m_mode(interpolateNN),m_lin(false){}
+
+    void WarpTable::compile(const Img32f &warpMap, scalemode mode, const Size &srcSize){
+      ICLASSERT_RETURN(warpMap.getChannels() >= 2);
+      m_size = warpMap.getSize();
+      m_srcSize = srcSize == Size::null ? m_size : srcSize;
+      m_mode = mode;
+      ICLASSERT_RETURN(m_srcSize.width < 32768 && m_srcSize.height < 32768);
+
+      const int sw = m_srcSize.width, sh = m_srcSize.height;
+      m_lin = mode == interpolateLIN && sw > 1 && sh > 1;
+      m_xy.resize(2*m_size.getDim());
+
+      {
+        Mutex::Locker lock(m_weightsMutex);
+        // the weights are built on first use for the applied depth
+        m_weights.clear();
+        m_fweights.clear();
+        m_map = m_lin ? warpMap : Img32f();
+      }
+
+      if(m_xy.empty()) return;
+      WarpCoordBuilder b = { &m_xy[0], sw, sh, m_lin };
+      warp_visit_tiled(warpMap,b);
+    }
+
+    void WarpTable::apply(const ImgBase *src, ImgBase *dst) const{
+      ICLASSERT_RETURN(src && dst && !isNull());
+      ICLASSERT_RETURN(src->getSize() == m_srcSize);
+      ICLASSERT_RETURN(dst->getSize() == m_size);
+      ICLASSERT_RETURN(src->getDepth() == dst->getDepth());
+      ICLASSERT_RETURN(src->getChannels() == dst->getChannels());
+
+      const icl8u *weights = 0;
+      const icl32f *fweights = 0;
+      if(m_lin){
+        const bool fixed = src->getDepth() == depth8u || src->getDepth() == depth16s;
+        Mutex::Locker lock(m_weightsMutex);
+        if(fixed){
+          if(m_weights.empty()) build_warp_weights(m_map,m_srcSize,m_weights);
+          weights = m_weights.empty() ? 0 : &m_weights[0];
+        }else{
+          if(m_fweights.empty()) build_warp_weights(m_map,m_srcSize,m_fweights);
+          fweights = m_fweights.empty() ? 0 : &m_fweights[0];
+        }
+      }
+      switch(src->getDepth()){
+  #define ICL_INSTANTIATE_DEPTH(D)                                                        \
+        case depth##D:                                                                  \
+          apply_warp_table(*src->asImg<icl##D>(),*dst->asImg<icl##D>(),m_size,&m_xy[0],weights,fweights); \
+          break;
+        ICL_INSTANTIATE_ALL_DEPTHS;
+        default:
+          ICL_INVALID_DEPTH;
+  #undef ICL_INSTANTIATE_DEPTH
+      }
+    }
+
+  } // namespace filter
+}
@@ -0,0 +1,127 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLFilter/src/ICLFilter/WarpTable.h                    **
+** Module : ICLFilter                                              **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Mutex.h>
+#include <vector>
+
+namespace icl{
+  namespace filter{
+
+    /// Compiled, fixed-point representation of a warp map (used by WarpOp)
+    /** A warp map is a 2-channel Img32f, that contains the source x- and
+        y-coordinate for each destination pixel. Applying it directly
+        requires reading two floats and computing the interpolation weights
+        for each pixel of each channel. The WarpTable compiles the map once
+        into a compact table:
+
+        * nearest neighbour: rounded int16 source coordinates
+        * bilinear: int16 coordinates of the upper left source pixel and the
+          weights for the x- and y-direction. For icl8u and icl16s images,
+          8 bit fixed point weights are used (i.e. 6 byte per pixel instead of
+          8 byte for the float map). These have 7 fractional bits (i.e. source
+          positions are quantized to 1/128 pixel), so that a weight of 1.0 can
+          be represented for clamped border pixels. All other depths use float
+          weights, so that their results are not affected by the quantization.
+          Only the weight table of the applied depth is built, on first use.
+          Until then, the table keeps a shallow copy of the warp map, whose
+          data must therefore not be changed until the table is recompiled
+
+        Source coordinates, whose rounded value is outside the source image,
+        are marked as invalid; the corresponding destination pixels are set
+        to 0. For bilinear interpolation, the 2x2 neighbourhood is clamped to
+        the image, so that border pixels never access memory outside the
+        source image.
+
+        \section TILES Tiled Ordering
+        The table entries are stored in tiles of 64x16 pixels. Each tile is
+        stored in row-major order, tiles of a tile-row are stored from left to
+        right. The apply function processes the image tile by tile, so that
+        table entries are read sequentially and the source pixels a tile refers
+        to mostly stay in cache. Tile-rows are processed in parallel using
+        utils::parallel_for.
+
+        \section SIMD SIMD Support
+        Bilinear interpolation of icl8u images uses SSE2 fixed point
+        arithmetics (8 pixels at once). All other depths use scalar code.
+        Integer results are rounded.
+    */
+    class ICLFilter_API WarpTable : public utils::Uncopyable{
+      public:
+
+      /// creates a null table
+      WarpTable();
+
+      /// compiles the given warp map for the given source image size
+      /** If srcSize is null, the size of the warp map is used. Only
+          interpolateNN and interpolateLIN are supported */
+      void compile(const core::Img32f &warpMap, core::scalemode mode,
+                   const utils::Size &srcSize=utils::Size::null);
+
+      /// returns whether the table was not yet compiled
+      bool isNull() const { return m_xy.empty(); }
+
+      /// returns the destination size (i.e. the warp map size)
+      const utils::Size &getSize() const { return m_size; }
+
+      /// returns the source image size the table was compiled for
+      const utils::Size &getSrcSize() const { return m_srcSize; }
+
+      /// returns the interpolation mode
+      core::scalemode getScaleMode() const { return m_mode; }
+
+      /// applies the table to all channels of src
+      /** src must have the table's source size, dst must have the same depth
+          and channel count as src and the table's size */
+      void apply(const core::ImgBase *src, core::ImgBase *dst) const;
+
+      /// tile width
+      static const int TILE_WIDTH = 64;
+
+      /// tile height
+      static const int TILE_HEIGHT = 16;
+
+      private:
+      utils::Size m_size;            //!< destination size
+      utils::Size m_srcSize;         //!< source size
+      core::scalemode m_mode;        //!< interpolation mode
+      bool m_lin;                    //!< whether bilinear weights are used
+      std::vector<icl16s> m_xy;      //!< x,y pairs (x = -1 for invalid pixels)
+      core::Img32f m_map;            //!< shallow copy of the warp map (bilinear only, for building the weights)
+      mutable utils::Mutex m_weightsMutex;    //!< protects the lazily built weights
+      mutable std::vector<icl8u> m_weights;   //!< fixed point wx,wy pairs (bilinear only, 8u and 16s)
+      mutable std::vector<icl32f> m_fweights; //!< float wx,wy pairs (bilinear only, other depths)
+    };
+
+  } // namespace filter
+}
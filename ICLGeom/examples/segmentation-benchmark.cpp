@@ -0,0 +1,180 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLGeom/examples/segmentation-benchmark.cpp            **
+** Module : ICLGeom                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLGeom/PlanarRansacEstimator.h>
+#include <ICLGeom/ObjectEdgeDetector.h>
+#include <ICLCV/RegionGrower.h>
+#include <ICLIO/GenericGrabber.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Random.h>
+#include <ICLUtils/Time.h>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::math;
+using namespace icl::core;
+using namespace icl::io;
+using namespace icl::cv;
+using namespace icl::geom;
+
+// reference criterion for the sequential flood fill (same as applyEqualThreshold)
+struct NonEdge{
+  bool operator()(icl8u, icl8u b) const { return b == 255; }
+};
+
+// tabletop scene (depth in mm): tilted table, some boxes and a ball
+static Img32f create_scene(const Size &size){
+  Img32f depth(size,1);
+  Channel32f d = depth[0];
+  const float s = size.width/640.0f;
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      float z = 1400 - 0.8f*y/s;
+      if(x > 100*s && x < 220*s && y > 150*s && y < 330*s) z = 1000;
+      if(x > 300*s && x < 380*s && y > 220*s && y < 360*s) z = 1050 + 0.5f*(x-300*s)/s;
+      const float dx = (x-500*s)/s, dy = (y-280*s)/s;
+      if(dx*dx+dy*dy < 60*60) z = 1000 - sqrt(60*60-dx*dx-dy*dy);
+      d(x,y) = z + gaussRandom(0,1);
+    }
+  }
+  return depth;
+}
+
+// pinhole back projection (kinect like focal length)
+static void create_xyzh(const Img32f &depth, std::vector<Vec> &xyzh){
+  const Size size = depth.getSize();
+  const float f = 575*size.width/640.0f, cx = size.width/2.0f, cy = size.height/2.0f;
+  xyzh.resize(size.getDim());
+  const icl32f *d = depth.begin(0);
+  for(int y=0, i=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x, ++i){
+      xyzh[i] = Vec((x-cx)*d[i]/f, (y-cy)*d[i]/f, d[i], 1);
+    }
+  }
+}
+
+int main(int n, char **ppc){
+  pa_explain("-input","recorded depth frames (generic grabber device and parameter, e.g. file '*.icl'); "
+             "if not given, synthetic frames are used")
+            ("-size","frame size")
+            ("-frames","number of processed frames")
+            ("-passes","number of RANSAC passes")
+            ("-threads","number of threads for the parallel configuration (0: ICL_NUM_THREADS or number of cores)");
+  pa_init(n,ppc,"-input|-i(device,device-params) -size|-s(Size=VGA) -frames|-f(int=10) -passes(int=20) -threads|-t(int=0)");
+
+  const int F = pa("-frames"), passes = pa("-passes");
+  std::vector<Img32f> frames;
+  if(pa("-input")){
+    GenericGrabber grabber(pa("-input"));
+    grabber.useDesired(depth32f);
+    for(int i=0;i<F;++i){
+      frames.push_back(*grabber.grab()->as32f());
+    }
+  }else{
+    randomSeed();
+    for(int i=0;i<F;++i){
+      frames.push_back(create_scene(pa("-size")));
+    }
+  }
+  const Size size = frames[0].getSize();
+
+  // the CPU backends are compared with one and with all threads
+  const int threads[2] = { 1, TaskScheduler::getDefaultNumThreads() };
+  const int nThreads = pa("-threads").as<int>() > 0 ? pa("-threads").as<int>() : threads[1];
+
+  TextTable table;
+  table[0] = tok("threads,edges [ms],flood fill [ms],union-find [ms],ransac pairs [ms],relabel [ms],regions,identical",",");
+  for(int c=0;c<2;++c){
+    const int t = c ? nThreads : 1;
+    TaskScheduler::setNumThreads(t);
+    ObjectEdgeDetector edgeDetector(ObjectEdgeDetector::CPU);
+    PlanarRansacEstimator ransac(PlanarRansacEstimator::CPU);
+    RegionGrower flood, unionFind;
+    double tEdges = 0, tFlood = 0, tUnionFind = 0, tRansac = 0, tRelabel = 0, regions = 0;
+    bool identical = true;
+    std::vector<Vec> xyzhData;
+
+    for(int f=0;f<F;++f){
+      create_xyzh(frames[f], xyzhData);
+      DataSegment<float,4> xyzh(&xyzhData[0][0], sizeof(Vec), xyzhData.size(), size.width);
+
+      Time tt = Time::now();
+      const Img8u &edges = edgeDetector.calculate(frames[f], false, true, false);
+      tEdges += tt.age().toMilliSecondsDouble();
+
+      Img8u mask(size,1);
+      tt = Time::now();
+      const Img32s &floodLabels = flood.apply(edges, NonEdge(), &mask, 25);
+      tFlood += tt.age().toMilliSecondsDouble();
+
+      mask.clear();
+      tt = Time::now();
+      const Img32s &labels = unionFind.applyEqualThreshold(edges, mask, 255, 25);
+      tUnionFind += tt.age().toMilliSecondsDouble();
+      identical &= std::equal(labels.begin(0), labels.end(0), floodLabels.begin(0));
+
+      std::vector<std::vector<int> > ids = unionFind.getRegions();
+      regions += ids.size();
+      if(ids.empty()) continue;
+
+      // all region pairs are tested (the segmentation tests adjacent regions only)
+      DynMatrix<bool> test(ids.size(), ids.size(), true);
+      tt = Time::now();
+      ransac.apply(xyzh, ids, test, 15, passes, 30, PlanarRansacEstimator::ON_ONE_SIDE, labels);
+      tRansac += tt.age().toMilliSecondsDouble();
+
+      int largest = 0;
+      for(unsigned int i=1;i<ids.size();++i){
+        if(ids[i].size() > ids[largest].size()) largest = i;
+      }
+      PlanarRansacEstimator::Result r = ransac.apply(xyzh, ids[largest], ids[largest], 10, passes, 1, 0, PlanarRansacEstimator::MAX_ON);
+      Img8u newMask(size,1);
+      Img32s oldLabel = labels, newLabel(size,1);
+      tt = Time::now();
+      ransac.relabel(xyzh, newMask, oldLabel, newLabel, 1, largest+1, 10, r);
+      tRelabel += tt.age().toMilliSecondsDouble();
+    }
+    const int row = table.getSize().height;
+    table(0,row) = str(t);
+    table(1,row) = str(tEdges/F);
+    table(2,row) = str(tFlood/F);
+    table(3,row) = str(tUnionFind/F);
+    table(4,row) = str(tRansac/F);
+    table(5,row) = str(tRelabel/F);
+    table(6,row) = str(regions/F);
+    table(7,row) = identical ? "yes" : "no";
+  }
+  std::cout << "frames: " << F << " (" << (pa("-input") ? "recorded" : "synthetic") << ")  size: " << size
+            << "  RANSAC passes: " << passes << std::endl;
+  std::cout << table << std::endl;
+}
@@ -62,40 +62,13 @@ namespace icl{
       typedef typename math::Octree<Scalar,CAPACITY,SF,Pt,ALLOC_CHUNK_SIZE>::Node Node;
       static void render(const Node *node){
         glBegin(GL_POINTS);
-        for(const Pt *p = node->points; p < node->next;++p){
-          glVertex3f( (*p)[0],(*p)[1],(*p)[2]);
+        for(int i=0;i<node->count();++i){
+          glVertex3f(node->xs[i],node->ys[i],node->zs[i]);
         }
         glEnd();
       }
     };
     
-#if 0
-    /// this optimization is not working: Why?
-    template<int CAPACITY, int SF, int ALLOC_CHUNK_SIZE>
-    struct OctreePointRenderer<float,CAPACITY,SF,math::FixedColVector<float,4>,ALLOC_CHUNK_SIZE>{
-      typedef FixedColVector<float,4> Pt;
-      typedef typename math::Octree<float,CAPACITY,SF,Pt,ALLOC_CHUNK_SIZE>::Node Node;
-      static void render(const Node *node){
-        glEnableClientState(GL_VERTEX_ARRAY);
-        glVertexPointer(4,GL_FLOAT,0,node->points);
-        glDrawArrays(GL_POINTS, 0, (int)(node->next - node->points));
-        glDisableClientState(GL_VERTEX_ARRAY);
-      }
-    };  
-
-    template<int CAPACITY, int SF, int ALLOC_CHUNK_SIZE>
-    struct OctreePointRenderer<icl32s,CAPACITY,SF,math::FixedColVector<icl32s,4>,ALLOC_CHUNK_SIZE>{
-      typedef FixedColVector<icl32s,4> Pt;
-      typedef typename math::Octree<icl32s,CAPACITY,SF,Pt,ALLOC_CHUNK_SIZE>::Node Node;
-      static void render(const Node *node){
-        glEnableClientState(GL_VERTEX_ARRAY);
-        glVertexPointer(4,GL_INT,0,node->points);
-        glDrawArrays(GL_POINTS, 0, (int)(node->next - node->points));
-        glDisableClientState(GL_VERTEX_ARRAY);
-      }
-    };
-#endif
-    
     /** \endcond */
     
 
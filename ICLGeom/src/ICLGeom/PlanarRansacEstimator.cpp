@@ -35,9 +35,178 @@
 #include <ICLUtils/CLIncludes.h>
 
 #include <ICLCore/Img.h>
+#include <ICLUtils/SSETypes.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Mutex.h>
+#include <algorithm>
 
 namespace icl{
   namespace geom{
+
+    namespace{
+      /// plane models in structure-of-arrays layout, padded to a multiple of 4
+      struct PlaneSet{
+        int n,padded;
+        std::vector<float> nx,ny,nz,d;
+        
+        PlaneSet(const std::vector<Vec> &n0, const std::vector<float> &dist):
+          n(n0.size()),padded((n0.size()+3)&~3),nx(padded,0.f),ny(padded,0.f),nz(padded,0.f),d(padded,0.f){
+          for(int i=0;i<n;++i){
+            nx[i] = n0[i][0];
+            ny[i] = n0[i][1];
+            nz[i] = n0[i][2];
+            d[i] = dist[i];
+          }
+        }
+      };
+
+      /// point access for vectors of points
+      struct VecPoints{
+        const Vec *points;
+        int subset;
+        inline const Vec &operator()(int i) const { return points[i*subset]; }
+      };
+
+      /// point access for point cloud ids
+      struct SegmentPoints{
+        const core::DataSegment<float,4> *xyzh;
+        const int *ids;
+        int subset;
+        inline const Vec &operator()(int i) const { return (*xyzh)[ids[i*subset]]; }
+      };
+
+      /// adds the numbers of points [begin,end) above, below and on all planes to the given counters
+      /** Four planes are processed at once, the point range is traversed once for each group of
+          four planes (the ranges passed here are small enough to stay in the cache) */
+      template<class Points>
+      void count_points(const Points &points, int begin, int end, const PlaneSet &planes, float t,
+                        int *above, int *below, int *on){
+        for(int j=0;j<planes.padded;j+=4){
+          int ca[4] = {0,0,0,0}, cb[4] = {0,0,0,0}, co[4] = {0,0,0,0};
+  #ifdef ICL_HAVE_SSE2
+          const __m128 nx = _mm_loadu_ps(&planes.nx[j]), ny = _mm_loadu_ps(&planes.ny[j]);
+          const __m128 nz = _mm_loadu_ps(&planes.nz[j]), d = _mm_loadu_ps(&planes.d[j]);
+          const __m128 tp = _mm_set1_ps(t), tn = _mm_set1_ps(-t);
+          __m128i va = _mm_setzero_si128(), vb = _mm_setzero_si128(), vo = _mm_setzero_si128();
+          for(int i=begin;i<end;++i){
+            const Vec &p = points(i);
+            __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]),nx),_mm_mul_ps(_mm_set1_ps(p[1]),ny));
+            s = _mm_sub_ps(_mm_add_ps(s,_mm_mul_ps(_mm_set1_ps(p[2]),nz)),d);
+            // comparison masks are -1 for true, so subtracting them counts
+            va = _mm_sub_epi32(va,_mm_castps_si128(_mm_cmpgt_ps(s,tp)));
+            vb = _mm_sub_epi32(vb,_mm_castps_si128(_mm_cmplt_ps(s,tn)));
+            vo = _mm_sub_epi32(vo,_mm_castps_si128(_mm_and_ps(_mm_cmpge_ps(s,tn),_mm_cmple_ps(s,tp))));
+          }
+          _mm_storeu_si128((__m128i*)ca,va);
+          _mm_storeu_si128((__m128i*)cb,vb);
+          _mm_storeu_si128((__m128i*)co,vo);
+  #else
+          for(int i=begin;i<end;++i){
+            const Vec &p = points(i);
+            for(int k=0;k<4;++k){
+              float s = (p[0]*planes.nx[j+k]+p[1]*planes.ny[j+k]+p[2]*planes.nz[j+k])-planes.d[j+k];
+              if(s>=-t && s<=t) ++co[k];
+              else if(s>t) ++ca[k];
+              else if(s<-t) ++cb[k];
+            }
+          }
+  #endif
+          for(int k=0;k<4 && j+k<planes.n;++k){
+            above[j+k] += ca[k];
+            below[j+k] += cb[k];
+            on[j+k] += co[k];
+          }
+        }
+      }
+
+      /// parallel point counting (used with utils::parallel_for)
+      template<class Points>
+      struct CountPoints{
+        const Points *points;
+        const PlaneSet *planes;
+        float t;
+        int *above, *below, *on;
+        utils::Mutex *mutex;
+
+        void operator()(int begin, int end) const{
+          std::vector<int> c(3*planes->n,0);
+          count_points(*points,begin,end,*planes,t,c.data(),c.data()+planes->n,c.data()+2*planes->n);
+          utils::Mutex::Locker lock(mutex);
+          for(int i=0;i<planes->n;++i){
+            above[i] += c[i];
+            below[i] += c[planes->n+i];
+            on[i] += c[2*planes->n+i];
+          }
+        }
+      };
+
+      /// minimum number of points per task
+      static const int COUNT_GRAIN = 2048;
+
+      template<class Points>
+      void count_points_parallel(const Points &points, int numPoints, const std::vector<Vec> &n0, const std::vector<float> &dist,
+                                 float threshold, std::vector<int> &cAbove, std::vector<int> &cBelow, std::vector<int> &cOn){
+        cAbove.assign(n0.size(),0);
+        cBelow.assign(n0.size(),0);
+        cOn.assign(n0.size(),0);
+        if(n0.empty()) return;
+        PlaneSet planes(n0,dist);
+        utils::Mutex mutex;
+        CountPoints<Points> f = { &points, &planes, threshold, cAbove.data(), cBelow.data(), cOn.data(), &mutex };
+        utils::parallel_for(0, numPoints, f, COUNT_GRAIN);
+      }
+
+      /// counts the points of all tested surface pairs (used with utils::parallel_for over the pairs)
+      struct CountPairs{
+        const core::DataSegment<float,4> *xyzh;
+        const std::vector<std::vector<int> > *pointIDs;
+        const std::vector<PlaneSet> *planes;
+        const int *row, *adjs;
+        int passes;
+        float t;
+        int *above, *below, *on;
+
+        void operator()(int begin, int end) const{
+          for(int j=begin;j<end;++j){
+            const std::vector<int> &ids = pointIDs->at(adjs[j]);
+            if(ids.empty()) continue;
+            SegmentPoints points = { xyzh, ids.data(), 1 };
+            count_points(points, 0, (int)ids.size(), (*planes)[row[j]], t, above+j*passes, below+j*passes, on+j*passes);
+          }
+        }
+      };
+
+      /// relabels image rows (used with utils::parallel_for)
+      struct RelabelRows{
+        const core::DataSegment<float,4> *xyzh;
+        icl8u *mask;
+        const icl32s *oldLabel;
+        icl32s *newLabel;
+        int w, desiredID, srcID;
+        Vec n0;
+        float dist, t;
+
+        void operator()(int begin, int end) const{
+          for(int i=begin*w;i<end*w;++i){
+            if(mask[i]){
+              newLabel[i] = oldLabel[i];
+            }else if(oldLabel[i]==srcID){
+              newLabel[i] = desiredID;
+              mask[i] = 1;
+            }else{
+              const Vec &p = (*xyzh)[i];
+              float s = (p[0]*n0[0]+p[1]*n0[1]+p[2]*n0[2])-dist;
+              if(s>=-t && s<=t){
+                newLabel[i] = desiredID;
+                mask[i] = 1;
+              }else{
+                newLabel[i] = 0;
+              }
+            }
+          }
+        }
+      };
+    }
     
     #ifdef ICL_HAVE_OPENCL
     //OpenCL kernel code
@@ -428,25 +597,17 @@ namespace icl{
     void PlanarRansacEstimator::calculateMultiCPU(core::DataSegment<float,4> &xyzh, std::vector<std::vector<int> > &pointIDs, math::DynMatrix<bool> &testMatrix, 
                     float threshold, int passes, std::vector<std::vector<Vec> > &n0Pre, std::vector<std::vector<float> > &distPre, std::vector<int> &cAbove, 
                     std::vector<int> &cBelow, std::vector<int> &cOn, std::vector<int> &adjs, std::vector<int> &start, std::vector<int> &end){
+      if(adjs.empty()) return;
+      std::vector<PlaneSet> planes;
+      std::vector<int> row(adjs.size());
       for(size_t i=0; i<testMatrix.rows(); i++){
+        planes.push_back(PlaneSet(n0Pre.at(i),distPre.at(i)));
         for(int j=start[i]; j<end[i]; j++){
-          int k=adjs[j];
-          for(unsigned int m=0; m<pointIDs.at(k).size(); m++){
-            for(int l=0; l<passes; l++){
-              Vec n01 = n0Pre.at(i).at(l);
-              Vec point = xyzh[pointIDs.at(k).at(m)];
-              float s1 = (point[0]*n01[0]+point[1]*n01[1]+point[2]*n01[2])-distPre.at(i).at(l);      
-              if((s1>=-threshold && s1<=threshold)){
-                cOn[j*passes+l]++;
-              }else if(s1>threshold){
-                cAbove[j*passes+l]++;
-              }else if(s1<threshold){
-                cBelow[j*passes+l]++;
-              } 
-            }
-          }
+          row[j]=i;
         }
       }
+      CountPairs f = { &xyzh, &pointIDs, &planes, row.data(), adjs.data(), passes, threshold, cAbove.data(), cBelow.data(), cOn.data() };
+      utils::parallel_for(0, (int)adjs.size(), f, 1);
     }
     
     
@@ -567,20 +728,24 @@ namespace icl{
     
     void PlanarRansacEstimator::calculateSingleCPU(std::vector<Vec> &dstPoints, float threshold, int passes, int subset, 
                 std::vector<Vec> &n0, std::vector<float> &dist, std::vector<int> &cAbove, std::vector<int> &cBelow, std::vector<int> &cOn){
-      for(int p=0; p<passes; p++){
-        for(unsigned int q=0; q<dstPoints.size(); q+=subset){
-          Vec n01 = n0[p];
-          Vec point = dstPoints.at(q);
-          float s1 = (point[0]*n01[0]+point[1]*n01[1]+point[2]*n01[2])-dist[p];      
-          if((s1>=-threshold && s1<=threshold)){
-            cOn[p]++;
-          }else if(s1>threshold){
-            cAbove[p]++;
-          }else if(s1<threshold){
-            cBelow[p]++;
-          } 
-        }
-      }            
+      countPointsCPU(dstPoints, subset, n0, dist, threshold, cAbove, cBelow, cOn);
+    }
+    
+    
+    void PlanarRansacEstimator::countPointsCPU(const std::vector<Vec> &points, int subset, const std::vector<Vec> &n0, 
+                const std::vector<float> &dist, float threshold, std::vector<int> &cAbove, std::vector<int> &cBelow, std::vector<int> &cOn){
+      subset = std::max(subset,1);
+      VecPoints p = { points.data(), subset };
+      count_points_parallel(p, (points.size()+subset-1)/subset, n0, dist, threshold, cAbove, cBelow, cOn);
+    }
+    
+    
+    void PlanarRansacEstimator::countPointsCPU(const core::DataSegment<float,4> &xyzh, const std::vector<int> &ids, int subset, 
+                const std::vector<Vec> &n0, const std::vector<float> &dist, float threshold, std::vector<int> &cAbove, 
+                std::vector<int> &cBelow, std::vector<int> &cOn){
+      subset = std::max(subset,1);
+      SegmentPoints p = { &xyzh, ids.data(), subset };
+      count_points_parallel(p, (ids.size()+subset-1)/subset, n0, dist, threshold, cAbove, cBelow, cOn);
     }
     
     
@@ -843,30 +1008,8 @@ namespace icl{
     
     void PlanarRansacEstimator::relabelCPU(core::DataSegment<float,4> &xyzh, core::Img8u &newMask, core::Img32s &oldLabel, core::Img32s &newLabel,
                      int desiredID, int srcID, float threshold, Result &result, int w, int h){
-      for(int y=0; y<h; y++){
-        for(int x=0; x<w; x++){
-          int i=x+y*w;
-          if(newMask(x,y,0)==0){
-            if(oldLabel(x,y,0)==srcID){
-              newLabel(x,y,0)=desiredID;
-              newMask(x,y,0)=1;
-            }else{
-              Vec n01 = result.n0;
-              float dist = result.dist;
-              float s1 = (xyzh[i][0]*n01[0]+xyzh[i][1]*n01[1]+xyzh[i][2]*n01[2])-dist;  
-              if((s1>=-threshold && s1<=threshold) && newMask(x,y,0)==0){
-                newLabel(x,y,0)=desiredID;
-                newMask(x,y,0)=1;
-              }else{
-                newLabel(x,y,0)=0;
-                newMask(x,y,0)=0;
-              }
-            }
-          }else{
-            newLabel(x,y,0)=oldLabel(x,y,0);
-          }
-        }
-      }    
+      RelabelRows f = { &xyzh, newMask.begin(0), oldLabel.begin(0), newLabel.begin(0), w, desiredID, srcID, result.n0, result.dist, threshold };
+      utils::parallel_for(0, h, f, 16);
     }
                     
   }
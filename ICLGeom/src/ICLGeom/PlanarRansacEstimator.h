@@ -153,6 +153,29 @@ namespace icl{
             @param passes the number of passes
         */ 
         static void calculateRandomModels(core::DataSegment<float,4> &xyzh, std::vector<int> &srcPoints, std::vector<Vec> &n0, std::vector<float> &dist, int passes);
+
+        /// Counts the points above, below and on the given planar models (CPU)
+        /** The points are distributed over all threads of the utils::TaskScheduler, four models are
+            evaluated at once using SSE2 (if available). This is the CPU backend of apply.
+            @param points the input points
+            @param subset the subset of points for matching (2 means every second point)
+            @param n0 the model normals
+            @param dist the model distances
+            @param threshold the maximal euclidean distance of points on the model
+            @param cAbove resulting number of points above each model (resized to n0.size())
+            @param cBelow resulting number of points below each model (resized to n0.size())
+            @param cOn resulting number of points on each model (resized to n0.size())
+        */
+        static void countPointsCPU(const std::vector<Vec> &points, int subset, const std::vector<Vec> &n0, const std::vector<float> &dist,
+                    float threshold, std::vector<int> &cAbove, std::vector<int> &cBelow, std::vector<int> &cOn);
+
+        /// Counts the points above, below and on the given planar models (CPU)
+        /** @param xyzh the input xyz pointcloud data
+            @param ids the point IDs (pointcloud position)
+            @see countPointsCPU(const std::vector<Vec>&,int,const std::vector<Vec>&,const std::vector<float>&,float,std::vector<int>&,std::vector<int>&,std::vector<int>&)
+        */
+        static void countPointsCPU(const core::DataSegment<float,4> &xyzh, const std::vector<int> &ids, int subset, const std::vector<Vec> &n0,
+                    const std::vector<float> &dist, float threshold, std::vector<int> &cAbove, std::vector<int> &cBelow, std::vector<int> &cOn);
         
       private:
       
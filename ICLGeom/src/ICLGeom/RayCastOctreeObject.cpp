@@ -62,9 +62,10 @@ namespace icl{
     void RayCastOctreeObject::ray_cast_sqr_rec(const RayCastOctreeObject::Super::Node *n, const ViewRay &ray, 
                                                float maxSqrDist, float maxDist, 
                                                std::vector<Vec> &result){
-      for(const Vec *p=n->points; p<n->next;++p){
-        if(sqr_ray_point_dist(ray,*p) < maxSqrDist){
-          result.push_back(*p);
+      for(int i=0;i<n->count();++i){
+        const Vec p = n->point(i);
+        if(sqr_ray_point_dist(ray,p) < maxSqrDist){
+          result.push_back(p);
         }
       }
       if(n->children){
@@ -82,10 +83,11 @@ namespace icl{
                                                      std::vector<Vec> &result,
                                                      std::vector<AABB> &boxes, std::vector<Vec> &points){
       boxes.push_back(n->boundary);
-      for(const Vec *p=n->points; p<n->next;++p){
-        points.push_back(*p);
-        if(sqr_ray_point_dist(ray,*p) < maxSqrDist){
-          result.push_back(*p);
+      for(int i=0;i<n->count();++i){
+        const Vec p = n->point(i);
+        points.push_back(p);
+        if(sqr_ray_point_dist(ray,p) < maxSqrDist){
+          result.push_back(p);
         }
       }
       if(n->children){
@@ -29,6 +29,9 @@
  ********************************************************************/
 
 #include <ICLGeom/Segmentation3D.h>
+#include <ICLGeom/PlanarRansacEstimator.h>
+#include <ICLCV/RegionGrower.h>
+#include <ICLUtils/TaskScheduler.h>
 
 #include <ICLUtils/CLIncludes.h>
 
@@ -38,6 +41,45 @@
 namespace icl {
 namespace geom {
 
+namespace {
+//growing criterion for regionGrowBlobs (every point can start a blob)
+struct DepthDistance {
+	const float *depth;
+	float t;
+	bool operator()(int i, int j) const {
+		return i == j || fabs(depth[i] - depth[j]) < t;
+	}
+};
+
+//assigns the points on the best blob plane (used with utils::parallel_for)
+struct AssignPlanePoints {
+	const DataSegment<float, 4> *xyz;
+	const int *assignment;
+	int *assignmentBlobs;
+	bool *elementsBlobs;
+	int planeID;
+	Vec n0;
+	float dist;
+	float t;
+
+	void operator()(int begin, int end) const {
+		for (int i = begin; i < end; i++) {
+			if (assignment[i] == planeID) {
+				assignmentBlobs[i] = 1;
+				elementsBlobs[i] = false;
+			} else if (elementsBlobs[i] == true) {
+				const Vec &p = (*xyz)[i];
+				float s1 = (p[0] * n0[0] + p[1] * n0[1] + p[2] * n0[2]) - dist;
+				if (s1 >= -t && s1 <= t) {
+					assignmentBlobs[i] = 1;
+					elementsBlobs[i] = false;
+				}
+			}
+		}
+	}
+};
+}
+
 #ifdef ICL_HAVE_OPENCL
 //OpenCL kernel code
 static char segmentationKernel[] =
@@ -456,33 +498,21 @@ void Segmentation3D::regionGrow() {
 			}
 		}
 	} else {
-		int numCluster = 0;
-		std::vector < std::vector<int> > remove;
-		for (int y = 0; y < h; ++y) {
-			for (int x = 0; x < w; ++x) {
-				int i = x + w * y;
-				if (elements[i] == true && normalEdgeImage(x, y, 0) == 255) {
-					elements[i] = false;
-					numCluster++;
-					assignment[i] = numCluster;
-					std::vector<int> data;
-					data.push_back(i);
-					checkNeighbourGrayThreshold(x, y, assignment[i], 255,
-							&data);
-					if (data.size() < minClusterSize) {
-						remove.push_back(data);
-						numCluster--;
-					} else {
-						cluster.push_back(data);
-					}
-				}
-			}
-		}
-		for (unsigned int i = 0; i < remove.size(); i++) {
-			for (unsigned int j = 0; j < remove.at(i).size(); j++) {
-				elements[remove.at(i).at(j)] = true;
-				assignment[remove.at(i).at(j)] = 0;
+		//parallel union-find region growing on the non-edge points
+		Img8u mask(s, 1);
+		icl8u *m = mask.begin(0);
+		for (int i = 0; i < dim; i++) {
+			m[i] = !elements[i];
+		}
+		cv::RegionGrower grower;
+		grower.applyEqualThreshold(normalEdgeImage, mask, 255, minClusterSize, 1);
+		std::vector < std::vector<int> > regions = grower.getRegions();
+		for (unsigned int i = 0; i < regions.size(); i++) {
+			for (unsigned int j = 0; j < regions.at(i).size(); j++) {
+				elements[regions.at(i).at(j)] = false;
+				assignment[regions.at(i).at(j)] = i + 1;
 			}
+			cluster.push_back(regions.at(i));
 		}
 	}
 }
@@ -714,51 +744,16 @@ void Segmentation3D::calculateCutfreeMatrix() {
           delete cOnRead;
 #endif
 				} else {
+					std::vector<Vec> n0(RANSACpasses);
+					std::vector<float> dist(RANSACpasses);
+					std::vector<int> cAbove, cBelow, cOn;
+					PlanarRansacEstimator::calculateRandomModels(xyzData,
+							cluster.at(a), n0, dist, RANSACpasses);
+					PlanarRansacEstimator::countPointsCPU(xyzData, cluster.at(b),
+							1, n0, dist, RANSACeuclDistance, cAbove, cBelow, cOn);
 					for (int p = 0; p < RANSACpasses; p++) {
-						Vec rPoint1;
-						Vec n01;
-						int p0i = cluster.at(a).at(
-								rand() % cluster.at(a).size());
-						int p1i = cluster.at(a).at(
-								rand() % cluster.at(a).size());
-						int p2i = cluster.at(a).at(
-								rand() % cluster.at(a).size());
-						Vec fa1;
-						Vec fb1;
-						Vec n1;
-						//PlaneFitting
-						fa1 = xyzData[p1i] - xyzData[p0i];
-						fb1 = xyzData[p2i] - xyzData[p0i];
-						n1[0] = fa1[1] * fb1[2] - fa1[2] * fb1[1];
-						n1[1] = fa1[2] * fb1[0] - fa1[0] * fb1[2];
-						n1[2] = fa1[0] * fb1[1] - fa1[1] * fb1[0];
-						n01[0] = n1[0] / norm3(n1);
-						n01[1] = n1[1] / norm3(n1);
-						n01[2] = n1[2] / norm3(n1);
-						rPoint1 = xyzData[p0i];
-						float distance1 = rPoint1[0] * n01[0]
-								+ rPoint1[1] * n01[1] + rPoint1[2] * n01[2];
-
-						int countAbove = 0;
-						int countBelow = 0;
-						int countOn = 0;
-						for (unsigned int p = 0; p < cluster.at(b).size();
-								p++) {
-							float s1 = (xyzData[cluster.at(b).at(p)][0] * n01[0]
-									+ xyzData[cluster.at(b).at(p)][1] * n01[1]
-									+ xyzData[cluster.at(b).at(p)][2] * n01[2])
-									- distance1;
-							if ((s1 >= -RANSACeuclDistance
-									&& s1 <= RANSACeuclDistance)) {
-								countOn++;
-							} else if (s1 > RANSACeuclDistance) {
-								countAbove++;
-							} else if (s1 < -RANSACeuclDistance) {
-								countBelow++;
-							}
-						}
-						if (countAbove < RANSACtolerance
-								|| countBelow < RANSACtolerance) {
+						if (cAbove[p] < RANSACtolerance
+								|| cBelow[p] < RANSACtolerance) {
 							countAcc++;
 						} else {
 							countNAcc++;
@@ -1307,18 +1302,13 @@ void Segmentation3D::blobSegmentation() {
 		}
 #endif
 	} else {
+		std::vector<Vec> n0v(n0, n0 + RANSACpasses);
+		std::vector<float> distv(dist, dist + RANSACpasses);
+		std::vector<int> cAboveCPU, cBelowCPU, cOnCPU;
+		PlanarRansacEstimator::countPointsCPU(xyzData, cluster.at(maxID), 1,
+				n0v, distv, RANSACeuclDistance / 2, cAboveCPU, cBelowCPU, cOnCPU);
 		for (int p = 0; p < RANSACpasses; p++) {
-			for (unsigned int q = 0; q < cluster.at(maxID).size(); q++) {
-				Vec n01 = n0[p];
-				float s1 = (xyzData[cluster.at(maxID).at(q)][0] * n01[0]
-						+ xyzData[cluster.at(maxID).at(q)][1] * n01[1]
-						+ xyzData[cluster.at(maxID).at(q)][2] * n01[2])
-						- dist[p];
-				if ((s1 >= -RANSACeuclDistance / 2
-						&& s1 <= RANSACeuclDistance / 2)) {
-					cOnRead[p]++;
-				}
-			}
+			cOnRead[p] = cOnCPU[p];
 		}
 	}
 	int maxMatch = 0;
@@ -1353,21 +1343,10 @@ void Segmentation3D::blobSegmentation() {
 		}
 #endif
 	} else {
-		for (int i = 0; i < w * h; i++) {
-			if (assignment[i] == maxID + 1) {
-				assignmentBlobs[i] = 1;
-				elementsBlobs[i] = false;
-			} else {
-				Vec n01 = n0[maxMatchID];
-				float s1 = (xyzData[i][0] * n01[0] + xyzData[i][1] * n01[1]
-						+ xyzData[i][2] * n01[2]) - dist[maxMatchID];
-				if ((s1 >= -RANSACeuclDistance && s1 <= RANSACeuclDistance)
-						&& elementsBlobs[i] == true) {
-					assignmentBlobs[i] = 1;
-					elementsBlobs[i] = false;
-				}
-			}
-		}
+		AssignPlanePoints assign = { &xyzData, assignment, assignmentBlobs,
+				elementsBlobs, maxID + 1, n0[maxMatchID], dist[maxMatchID],
+				(float) RANSACeuclDistance };
+		utils::parallel_for(0, w * h, assign, 4096);
 	}
 
 	regionGrowBlobs();
@@ -1463,92 +1442,6 @@ void Segmentation3D::colorPointcloud() {
 	}
 }
 
-void Segmentation3D::checkNeighbourGrayThreshold(int x, int y, int zuw,
-		int threshold, std::vector<int> *data) {
-	std::vector<int> toProcessX;
-	std::vector<int> toProcessY;
-	bool process = true;
-	unsigned int index = 0;
-	toProcessX.push_back(x);
-	toProcessY.push_back(y);
-
-	while (process == true) {
-		int i = toProcessX.at(index) + w * toProcessY.at(index);
-		x = toProcessX.at(index);
-		y = toProcessY.at(index);
-
-		if (elements[i + 1] == true && x + 1 < w
-				&& normalEdgeImage(x + 1, y, 0) == threshold) {
-			elements[i + 1] = false;
-			assignment[i + 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) + 1);
-			toProcessY.push_back(toProcessY.at(index));
-			data->push_back(i + 1);
-		}
-		if (elements[i - 1] == true && x - 1 >= 0
-				&& normalEdgeImage(x - 1, y, 0) == threshold) {
-			elements[i - 1] = false;
-			assignment[i - 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) - 1);
-			toProcessY.push_back(toProcessY.at(index));
-			data->push_back(i - 1);
-		}
-		if (elements[i + w] == true && y + 1 < h
-				&& normalEdgeImage(x, y + 1, 0) == threshold) {
-			elements[i + w] = false;
-			assignment[i + w] = zuw;
-			toProcessX.push_back(toProcessX.at(index));
-			toProcessY.push_back(toProcessY.at(index) + 1);
-			data->push_back(i + w);
-		}
-		if (elements[i + w - 1] == true && x - 1 >= 0 && y + 1 < h
-				&& normalEdgeImage(x - 1, y + 1, 0) == threshold) {
-			elements[i + w - 1] = false;
-			assignment[i + w - 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) - 1);
-			toProcessY.push_back(toProcessY.at(index) + 1);
-			data->push_back(i + w - 1);
-		}
-		if (elements[i + w + 1] == true && x + 1 < w && y + 1 < h
-				&& normalEdgeImage(x + 1, y + 1, 0) == threshold) {
-			elements[i + w + 1] = false;
-			assignment[i + w + 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) + 1);
-			toProcessY.push_back(toProcessY.at(index) + 1);
-			data->push_back(i + w + 1);
-		}
-		if (elements[i - w] == true && y - 1 >= 0
-				&& normalEdgeImage(x, y - 1, 0) == threshold) {
-			elements[i - w] = false;
-			assignment[i - w] = zuw;
-			toProcessX.push_back(toProcessX.at(index));
-			toProcessY.push_back(toProcessY.at(index) - 1);
-			data->push_back(i - w);
-		}
-		if (elements[i - w - 1] == true && x - 1 >= 0 && y - 1 >= 0
-				&& normalEdgeImage(x - 1, y - 1, 0) == threshold) {
-			elements[i - w - 1] = false;
-			assignment[i - w - 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) - 1);
-			toProcessY.push_back(toProcessY.at(index) - 1);
-			data->push_back(i - w - 1);
-		}
-		if (elements[i - w + 1] == true && x + 1 < w && y - 1 >= 0
-				&& normalEdgeImage(x + 1, y - 1, 0) == threshold) {
-			elements[i - w + 1] = false;
-			assignment[i - w + 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) + 1);
-			toProcessY.push_back(toProcessY.at(index) - 1);
-			data->push_back(i - w + 1);
-		}
-
-		index++;
-		if (index >= toProcessX.size()) {
-			process = false;
-		}
-	}
-}
-
 void Segmentation3D::checkNeighbourDistanceRemaining(int x, int y, int zuw,
 		std::vector<int> *data) {
 	std::vector<int> toProcessX;
@@ -1636,123 +1529,20 @@ void Segmentation3D::checkNeighbourDistanceRemaining(int x, int y, int zuw,
 }
 
 void Segmentation3D::regionGrowBlobs() {
-	int numCluster = 1;
-	std::vector < std::vector<int> > remove;
-	for (int y = 0; y < h; ++y) {
-		for (int x = 0; x < w; ++x) {
-			int i = x + w * y;
-			if (elementsBlobs[i] == true) {
-				elementsBlobs[i] = false;
-				numCluster++;
-				assignmentBlobs[i] = numCluster;
-				std::vector<int> data;
-				data.push_back(i);
-				checkNeighbourDistance(x, y, assignmentBlobs[i], &data);
-				if (data.size() < minClusterSize) {
-					remove.push_back(data);
-					numCluster--;
-				}
-			}
-		}
-	}
-	for (unsigned int i = 0; i < remove.size(); i++) {
-		for (unsigned int j = 0; j < remove.at(i).size(); j++) {
-			elementsBlobs[remove.at(i).at(j)] = true;
-			assignmentBlobs[remove.at(i).at(j)] = 0;
-		}
+	//parallel union-find region growing, blob ids start at 2
+	Img8u mask(s, 1);
+	icl8u *m = mask.begin(0);
+	for (int i = 0; i < dim; i++) {
+		m[i] = !elementsBlobs[i];
 	}
-}
-
-void Segmentation3D::checkNeighbourDistance(int x, int y, int zuw,
-		std::vector<int> *data) {
-	std::vector<int> toProcessX;
-	std::vector<int> toProcessY;
-	bool process = true;
-	unsigned int index = 0;
-	toProcessX.push_back(x);
-	toProcessY.push_back(y);
-
-	while (process == true) {
-		int i = toProcessX.at(index) + w * toProcessY.at(index);
-		x = toProcessX.at(index);
-		y = toProcessY.at(index);
-
-		if (elementsBlobs[i + 1] == true && x + 1 < w
-				&& fabs(depthImage(x, y, 0) - depthImage(x + 1, y, 0))
-						< BLOBSeuclDistance) {
-			elementsBlobs[i + 1] = false;
-			assignmentBlobs[i + 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) + 1);
-			toProcessY.push_back(toProcessY.at(index));
-			data->push_back(i + 1);
-		}
-		if (elementsBlobs[i - 1] == true && x - 1 >= 0
-				&& fabs(depthImage(x, y, 0) - depthImage(x - 1, y, 0))
-						< BLOBSeuclDistance) {
-			elementsBlobs[i - 1] = false;
-			assignmentBlobs[i - 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) - 1);
-			toProcessY.push_back(toProcessY.at(index));
-			data->push_back(i - 1);
-		}
-		if (elementsBlobs[i + w] == true && y + 1 < h
-				&& fabs(depthImage(x, y, 0) - depthImage(x, y + 1, 0))
-						< BLOBSeuclDistance) {
-			elementsBlobs[i + w] = false;
-			assignmentBlobs[i + w] = zuw;
-			toProcessX.push_back(toProcessX.at(index));
-			toProcessY.push_back(toProcessY.at(index) + 1);
-			data->push_back(i + w);
-		}
-		if (elementsBlobs[i + w - 1] == true && x - 1 >= 0 && y + 1 < h
-				&& fabs(depthImage(x, y, 0) - depthImage(x - 1, y + 1, 0))
-						< BLOBSeuclDistance) {
-			elementsBlobs[i + w - 1] = false;
-			assignmentBlobs[i + w - 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) - 1);
-			toProcessY.push_back(toProcessY.at(index) + 1);
-			data->push_back(i + w - 1);
-		}
-		if (elementsBlobs[i + w + 1] == true && x + 1 < w && y + 1 < h
-				&& fabs(depthImage(x, y, 0) - depthImage(x + 1, y + 1, 0))
-						< BLOBSeuclDistance) {
-			elementsBlobs[i + w + 1] = false;
-			assignmentBlobs[i + w + 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) + 1);
-			toProcessY.push_back(toProcessY.at(index) + 1);
-			data->push_back(i + w + 1);
-		}
-		if (elementsBlobs[i - w] == true && y - 1 >= 0
-				&& fabs(depthImage(x, y, 0) - depthImage(x, y - 1, 0))
-						< BLOBSeuclDistance) {
-			elementsBlobs[i - w] = false;
-			assignmentBlobs[i - w] = zuw;
-			toProcessX.push_back(toProcessX.at(index));
-			toProcessY.push_back(toProcessY.at(index) - 1);
-			data->push_back(i - w);
-		}
-		if (elementsBlobs[i - w - 1] == true && x - 1 >= 0 && y - 1 >= 0
-				&& fabs(depthImage(x, y, 0) - depthImage(x - 1, y - 1, 0))
-						< BLOBSeuclDistance) {
-			elementsBlobs[i - w - 1] = false;
-			assignmentBlobs[i - w - 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) - 1);
-			toProcessY.push_back(toProcessY.at(index) - 1);
-			data->push_back(i - w - 1);
-		}
-		if (elementsBlobs[i - w + 1] == true && x + 1 < w && y - 1 >= 0
-				&& fabs(depthImage(x, y, 0) - depthImage(x + 1, y - 1, 0))
-						< BLOBSeuclDistance) {
-			elementsBlobs[i - w + 1] = false;
-			assignmentBlobs[i - w + 1] = zuw;
-			toProcessX.push_back(toProcessX.at(index) + 1);
-			toProcessY.push_back(toProcessY.at(index) - 1);
-			data->push_back(i - w + 1);
-		}
-
-		index++;
-		if (index >= toProcessX.size()) {
-			process = false;
+	DepthDistance crit = { depthImage.begin(0), (float) BLOBSeuclDistance };
+	cv::RegionGrower grower;
+	const Img32s &labels = grower.applyUnionFind(s, crit, &mask, minClusterSize, 2);
+	const icl32s *l = labels.begin(0);
+	for (int i = 0; i < dim; i++) {
+		if (elementsBlobs[i] == true) {
+			assignmentBlobs[i] = l[i];
+			elementsBlobs[i] = (l[i] == 0);
 		}
 	}
 }
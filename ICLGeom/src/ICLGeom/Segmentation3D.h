@@ -231,14 +231,10 @@ namespace icl{
       bool clReady;
       bool useCL;
       
-      void checkNeighbourGrayThreshold(int x, int y, int zuw, int threshold, std::vector<int> *data);
-      
       void checkNeighbourDistanceRemaining(int x, int y, int zuw, std::vector<int> *data);
       
       void regionGrowBlobs();
       
-      void checkNeighbourDistance(int x, int y, int zuw, std::vector<int> *data);
-      
       bool checkNotExist(int zw, std::vector<int> &nb);
       
       float dist3(const Vec &a, const Vec &b);
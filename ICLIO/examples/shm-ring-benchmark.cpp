@@ -0,0 +1,199 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/examples/shm-ring-benchmark.cpp                  **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/SharedMemoryRing.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Thread.h>
+#include <ICLUtils/Time.h>
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cstdlib>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::io;
+
+struct ReaderResult{
+  double frames;     // number of received frames
+  double overruns;   // number of frames that were overwritten before they were read
+  double latency;    // mean latency in ms
+  double maxLatency; // max. latency in ms
+  double seconds;    // time from first to last frame
+};
+
+// reads all frames 1..n in order (runs in a forked process)
+ReaderResult run_reader(const std::string &name, int n, bool zeroCopy){
+  SharedMemoryRing ring(name,SharedMemoryRing::Reader);
+  ImgBase *buf = 0;
+  ReaderResult r = { 0, 0, 0, 0, 0 };
+  Time first = Time::null;
+  icl64s next = 1;
+  while(next <= n){
+    const icl64s latest = ring.getLatestSequenceNumber();
+    if(latest < next){
+      Thread::usleep(10);
+      continue;
+    }
+    if(latest - next >= ring.getNumSlots()){
+      // already overwritten
+      const icl64s oldest = latest - ring.getNumSlots() + 1;
+      r.overruns += oldest - next;
+      next = oldest;
+    }
+    SharedMemoryRing::Status status;
+    Time t;
+    if(zeroCopy){
+      const ImgBase *image = ring.access(next,&status);
+      if(image){
+        t = image->getTime();
+        if(!ring.isValid(next)) status = SharedMemoryRing::Overrun;
+      }
+    }else{
+      status = ring.read(next,&buf);
+      t = buf ? buf->getTime() : Time::null;
+    }
+    if(status == SharedMemoryRing::OK){
+      const Time now = Time::now();
+      if(first == Time::null) first = now;
+      const double l = (now - t).toMilliSecondsDouble();
+      r.latency += l;
+      r.maxLatency = iclMax(r.maxLatency,l);
+      r.seconds = (now - first).toSecondsDouble();
+      ++r.frames;
+    }else{
+      ++r.overruns;
+    }
+    ++next;
+  }
+  if(r.frames) r.latency /= r.frames;
+  ICL_DELETE(buf);
+  return r;
+}
+
+int main(int n, char **ppc){
+  pa_explain("-size","image size")
+            ("-depth","image depth")
+            ("-n","number of published frames per measurement")
+            ("-slots","number of ring slots")
+            ("-fps","publishing rate (0: as fast as possible)")
+            ("-max-readers","maximum number of reader processes (measured with 1,2,4,... readers)")
+            ("-zero-copy","readers access the frames in place instead of copying them");
+  pa_init(n,ppc,"-size|-s(Size=VGA) -depth|-d(depth=depth8u) -n(int=1000) -slots(int=8) -fps(float=0) "
+          "-max-readers(int=8) -zero-copy");
+
+  const Size size = pa("-size");
+  const int N = pa("-n");
+  const int slots = pa("-slots");
+  const float fps = pa("-fps");
+  const bool zeroCopy = pa("-zero-copy");
+  const int maxReaders = pa("-max-readers");
+
+  ImgBase *image = imgNew(pa("-depth"),size,formatRGB);
+  for(int c=0;c<image->getChannels();++c){
+    icl8u *p = (icl8u*)image->getDataPtr(c);
+    const int len = image->getDim()*(int)getSizeOf(image->getDepth());
+    for(int i=0;i<len;++i) p[i] = rand();
+  }
+
+  std::cout << "image: " << size << " " << image->getDepth() << " (" << image->getDim()*3*getSizeOf(image->getDepth())/1024
+            << " kB)  frames: " << N << "  slots: " << slots << "  zero-copy: " << (zeroCopy ? "yes" : "no") << std::endl;
+
+  TextTable table;
+  table[0] = tok("readers,publish [fps],receive [fps/reader],overruns [%],mean latency [ms],max. latency [ms]",",");
+
+  for(int numReaders=1;numReaders<=maxReaders;numReaders*=2){
+    const std::string name = "benchmark-" + str(getpid());
+    SharedMemoryRing ring(name,SharedMemoryRing::Writer,slots);
+
+    std::vector<int> pipes(numReaders);
+    std::vector<pid_t> pids(numReaders);
+    for(int i=0;i<numReaders;++i){
+      int fd[2];
+      if(pipe(fd)){
+        std::cerr << "unable to create pipe" << std::endl;
+        return 1;
+      }
+      pids[i] = fork();
+      if(!pids[i]){
+        ::close(fd[0]);
+        ReaderResult r = run_reader(name,N,zeroCopy);
+        if(::write(fd[1],&r,sizeof(r)) != sizeof(r)) _exit(1);
+        _exit(0);
+      }
+      ::close(fd[1]);
+      pipes[i] = fd[0];
+    }
+
+    Thread::msleep(200); // let the readers attach
+
+    const Time start = Time::now();
+    for(int i=0;i<N;++i){
+      if(fps > 0){
+        const Time due = start + Time::microSeconds((Time::value_type)(1e6*i/fps));
+        const Time now = Time::now();
+        if(due > now) Thread::usleep((due-now).toMicroSeconds());
+      }
+      image->setTime(Time::now());
+      ring.write(image);
+    }
+    const double publishFPS = N / start.age().toSecondsDouble();
+
+    ReaderResult sum = { 0, 0, 0, 0, 0 };
+    for(int i=0;i<numReaders;++i){
+      ReaderResult r = { 0, 0, 0, 0, 0 };
+      if(::read(pipes[i],&r,sizeof(r)) != sizeof(r)){
+        std::cerr << "reader " << i << " failed" << std::endl;
+      }
+      ::close(pipes[i]);
+      waitpid(pids[i],0,0);
+      sum.frames += r.frames;
+      sum.overruns += r.overruns;
+      sum.latency += r.latency;
+      sum.maxLatency = iclMax(sum.maxLatency,r.maxLatency);
+      sum.seconds += r.frames / iclMax(r.seconds,1e-6);
+    }
+
+    const int row = table.getSize().height;
+    table(0,row) = str(numReaders);
+    table(1,row) = str(publishFPS);
+    table(2,row) = str(sum.seconds/numReaders);
+    table(3,row) = str(100.0 * sum.overruns / (double(N)*numReaders));
+    table(4,row) = str(sum.latency/numReaders);
+    table(5,row) = str(sum.maxLatency);
+  }
+  std::cout << table << std::endl;
+  ICL_DELETE(image);
+  return 0;
+}
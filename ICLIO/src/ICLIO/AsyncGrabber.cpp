@@ -0,0 +1,320 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/AsyncGrabber.cpp                       **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/AsyncGrabber.h>
+#include <ICLIO/Grabber.h>
+#include <ICLUtils/Thread.h>
+#include <ICLUtils/Mutex.h>
+#include <ICLUtils/Exception.h>
+#include <ICLUtils/Macros.h>
+#include <deque>
+#include <vector>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    namespace{
+      /// waiting threads poll their condition in this interval (in microseconds)
+      static const unsigned int POLL_INTERVAL = 200;
+
+      struct QueueEntry{
+        QueueEntry(ImgBase *image=0, const Time &time=Time::null):image(image),time(time){}
+        ImgBase *image;
+        Time time;
+      };
+    }
+
+    struct AsyncGrabber::Data{
+
+      class Worker : public Thread{
+      public:
+        Worker(Data *data):data(data){}
+        virtual void run(){ data->produce(); }
+        Data *data;
+      };
+
+      Grabber *grabber;
+      int queueSize;
+      QueuePolicy policy;
+
+      std::deque<QueueEntry> queue;
+      std::vector<ImgBase*> freeImages;
+      ImgBase *current;
+      Time currentTime;
+
+      /// serializes the backend's grab calls with accesses from other threads (see Grabber::AccessLocker)
+      Mutex access;
+
+      /// protects the queue, the state and the statistics
+      Mutex mutex;
+      bool stopped;
+      bool ended;
+      std::string error;
+      int timeout;
+
+      Stats stats;
+      double depthSum, latencySum, waitSum;
+
+      Worker worker;
+
+      Data(Grabber *grabber, int queueSize, QueuePolicy policy):
+        grabber(grabber),queueSize(queueSize),policy(policy),current(0),
+        access(Mutex::mutexTypeRecursive),stopped(false),ended(false),timeout(5000),worker(this){
+        // queueSize queued images + one that is being filled + one owned by the caller
+        freeImages.resize(queueSize+2,(ImgBase*)0);
+        resetStats();
+      }
+
+      ~Data(){
+        mutex.lock();
+        stopped = true;
+        mutex.unlock();
+        worker.wait();
+
+        for(unsigned int i=0;i<freeImages.size();++i){
+          ICL_DELETE(freeImages[i]);
+        }
+        for(unsigned int i=0;i<queue.size();++i){
+          ICL_DELETE(queue[i].image);
+        }
+        ICL_DELETE(current);
+      }
+
+      void resetStats(){
+        stats.grabbed = stats.delivered = stats.dropped = stats.failed = 0;
+        stats.meanQueueDepth = stats.meanLatency = stats.maxLatency = stats.meanWaitTime = 0;
+        stats.maxQueueDepth = 0;
+        depthSum = latencySum = waitSum = 0;
+      }
+
+      /// backend thread loop
+      void produce(){
+        while(true){
+          mutex.lock();
+          if(policy == block){
+            while(!stopped && (int)queue.size() >= queueSize){
+              mutex.unlock();
+              Thread::usleep(POLL_INTERVAL);
+              mutex.lock();
+            }
+          }
+          if(stopped){
+            mutex.unlock();
+            return;
+          }
+          ImgBase *slot = freeImages.back();
+          freeImages.pop_back();
+          mutex.unlock();
+
+          const ImgBase *result = 0;
+          std::string err;
+          try{
+            Mutex::Locker lock(access);
+            result = grabber->grab(&slot);
+            if(result && result != slot){
+              result->deepCopy(&slot);
+            }
+          }catch(const std::exception &e){
+            err = e.what();
+          }catch(...){
+            err = "unknown exception";
+          }
+          const Time t = Time::now();
+
+          mutex.lock();
+          if(err.length()){
+            freeImages.push_back(slot);
+            error = err;
+            ended = true;
+            mutex.unlock();
+            return;
+          }
+          if(!result){
+            freeImages.push_back(slot);
+            ++stats.failed;
+            mutex.unlock();
+            Thread::msleep(1);
+            continue;
+          }
+          if(slot->getTime() == Time::null){
+            slot->setTime(t);
+          }
+          ++stats.grabbed;
+          if((int)queue.size() >= queueSize){
+            freeImages.push_back(queue.front().image);
+            queue.pop_front();
+            ++stats.dropped;
+          }
+          queue.push_back(QueueEntry(slot,t));
+          mutex.unlock();
+        }
+      }
+
+      const ImgBase *consume(){
+        const Time t0 = Time::now();
+        mutex.lock();
+        const Time deadline = t0 + Time::milliSeconds(timeout);
+        bool timedOut = false;
+        while(queue.empty() && !ended && !stopped && !timedOut){
+          mutex.unlock();
+          Thread::usleep(POLL_INTERVAL);
+          mutex.lock();
+          timedOut = timeout >= 0 && Time::now() >= deadline;
+        }
+        if(queue.empty()){
+          const std::string err = error;
+          mutex.unlock();
+          if(ended){
+            ERROR_LOG("backend grabber stopped: " << err);
+          }else if(timedOut){
+            WARNING_LOG("no image was grabbed within " << timeout << "ms");
+          }
+          return 0;
+        }
+        const int depth = queue.size();
+        QueueEntry e = queue.front();
+        queue.pop_front();
+        if(current) freeImages.push_back(current);
+        current = e.image;
+        currentTime = e.time;
+
+        const Time now = Time::now();
+        const double latency = (now - e.time).toMilliSecondsDouble();
+        ++stats.delivered;
+        depthSum += depth;
+        latencySum += latency;
+        waitSum += (now - t0).toMilliSecondsDouble();
+        stats.maxQueueDepth = iclMax(stats.maxQueueDepth,depth);
+        stats.maxLatency = iclMax(stats.maxLatency,(float)latency);
+        stats.meanQueueDepth = depthSum / stats.delivered;
+        stats.meanLatency = latencySum / stats.delivered;
+        stats.meanWaitTime = waitSum / stats.delivered;
+
+        mutex.unlock();
+        return current;
+      }
+    };
+
+    AsyncGrabber::AsyncGrabber(Grabber *grabber, int queueSize, QueuePolicy policy){
+      if(!grabber) throw ICLException("AsyncGrabber: given grabber was null");
+      if(queueSize < 1) throw ICLException("AsyncGrabber: queue size must be at least 1");
+      m_data = new Data(grabber, policy == latestOnly ? 1 : queueSize, policy);
+      grabber->setAccessMutex(&m_data->access);
+      m_data->worker.start();
+    }
+
+    AsyncGrabber::~AsyncGrabber(){
+      m_data->grabber->setAccessMutex(0);
+      delete m_data;
+    }
+
+    const ImgBase *AsyncGrabber::grab(ImgBase **dst){
+      const ImgBase *image = m_data->consume();
+      if(image && dst){
+        image->deepCopy(dst);
+        return *dst;
+      }
+      return image;
+    }
+
+    Time AsyncGrabber::getLastAcquisitionTime() const{
+      Mutex::Locker lock(m_data->mutex);
+      return m_data->currentTime;
+    }
+
+    int AsyncGrabber::getQueueDepth() const{
+      Mutex::Locker lock(m_data->mutex);
+      return m_data->queue.size();
+    }
+
+    void AsyncGrabber::setTimeout(int ms){
+      Mutex::Locker lock(m_data->mutex);
+      m_data->timeout = ms;
+    }
+
+    int AsyncGrabber::getTimeout() const{
+      Mutex::Locker lock(m_data->mutex);
+      return m_data->timeout;
+    }
+
+    int AsyncGrabber::getQueueSize() const{
+      return m_data->queueSize;
+    }
+
+    AsyncGrabber::QueuePolicy AsyncGrabber::getQueuePolicy() const{
+      return m_data->policy;
+    }
+
+    void AsyncGrabber::clear(){
+      Mutex::Locker lock(m_data->mutex);
+      while(m_data->queue.size()){
+        m_data->freeImages.push_back(m_data->queue.front().image);
+        m_data->queue.pop_front();
+      }
+    }
+
+    AsyncGrabber::Stats AsyncGrabber::getStats() const{
+      Mutex::Locker lock(m_data->mutex);
+      return m_data->stats;
+    }
+
+    void AsyncGrabber::resetStats(){
+      Mutex::Locker lock(m_data->mutex);
+      m_data->resetStats();
+    }
+
+    AsyncGrabber::QueuePolicy AsyncGrabber::policyFromString(const std::string &name){
+      if(name == "drop-oldest" || name == "drop") return dropOldest;
+      if(name == "block") return block;
+      if(name == "latest" || name == "latest-only") return latestOnly;
+      throw ICLException("AsyncGrabber: invalid queue policy '" + name + "' (allowed: drop-oldest, block or latest)");
+    }
+
+    std::string AsyncGrabber::policyToString(QueuePolicy policy){
+      switch(policy){
+        case dropOldest: return "drop-oldest";
+        case block: return "block";
+        default: return "latest";
+      }
+    }
+
+    std::ostream &operator<<(std::ostream &s, const AsyncGrabber::Stats &st){
+      return s << "grabbed: " << st.grabbed << " delivered: " << st.delivered
+               << " dropped: " << st.dropped << " failed: " << st.failed
+               << " queue depth (mean/max): " << st.meanQueueDepth << "/" << st.maxQueueDepth
+               << " latency (mean/max): " << st.meanLatency << "ms/" << st.maxLatency << "ms"
+               << " wait time (mean): " << st.meanWaitTime << "ms";
+    }
+
+  } // namespace io
+}
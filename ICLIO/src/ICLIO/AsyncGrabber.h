@@ -0,0 +1,184 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/AsyncGrabber.h                         **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Time.h>
+#include <ICLCore/ImgBase.h>
+#include <string>
+
+namespace icl{
+  namespace io{
+
+    /** \cond */
+    class Grabber;
+    /** \endcond */
+
+    /// Asynchronous prefetching wrapper for arbitrary Grabber instances \ingroup GRABBER_G
+    /** Grabber::grab() is synchronous: the image is acquired, decoded and
+        converted on the caller's thread. The AsyncGrabber moves this work
+        into a dedicated backend thread, that continuously grabs into a
+        bounded queue of recycled images. The calling thread's grab() call
+        then only has to dequeue the next image, so that acquisition and
+        processing overlap.
+
+        \section BUF Buffers
+        Internally, queueSize+2 images are allocated once and recycled:
+        up to queueSize images are waiting in the queue, one is currently
+        filled by the backend thread and one is owned by the caller. The
+        image returned by grab() remains valid until the next call to grab().
+
+        \section POL Queue Policies
+        The queue policy defines what happens if the backend thread is faster
+        than the consumer:
+        - <b>dropOldest</b> the oldest queued frame is recycled to make room
+          for the new one (the consumer always gets the newest queueSize frames)
+        - <b>block</b> the backend thread waits until a queue slot gets free.
+          No frame is lost, the source is throttled to the consumer's speed
+          (useful e.g. for file or video sources)
+        - <b>latestOnly</b> like dropOldest with a queue size of 1: grab()
+          always returns the most recent frame
+
+        \section TS Time Stamps and Statistics
+        Each queued image is tagged with the time it was acquired (if the
+        backend did not set an image time stamp itself, the acquisition time
+        is written into the image's time stamp). getStats() provides frame
+        counters, queue depth and latency statistics.
+
+        \section GG GenericGrabber Integration
+        The AsyncGrabber can be activated for every GenericGrabber backend
+        using the special \@-options \@async=QUEUE_SIZE and
+        \@async-policy=drop-oldest|block|latest, e.g.
+        <pre>
+        icl-camviewer -input file 'images/image*.ppm'\@async=4\@async-policy=block
+        </pre>
+
+        \section THR Thread Safety
+        The wrapped Grabber's grab() method is called from the backend thread.
+        While the AsyncGrabber exists, these calls are serialized with all other
+        accesses to the grabber by a mutex that is attached to the grabber:
+        Grabber::setPropertyValue (and therefore also property GUIs and the
+        GenericGrabber's property interface) and all GenericGrabber methods
+        that forward to the wrapped grabber lock it automatically. Code that
+        changes the wrapped grabber's state directly must hold a
+        Grabber::AccessLocker. Changes only affect frames that are grabbed
+        after the change, already queued frames can be discarded using clear().
+        The AsyncGrabber does not take ownership of the wrapped grabber.
+
+        \section TO Timeout
+        grab() waits at most getTimeout() milliseconds (5000 by default) for
+        the next image and returns 0 if no image arrived in time.
+    */
+    class ICLIO_API AsyncGrabber : public utils::Uncopyable{
+      public:
+
+      /// queue policy
+      enum QueuePolicy{
+        dropOldest, //!< recycle the oldest queued frame if the queue is full
+        block,      //!< backend thread waits for a free queue slot
+        latestOnly  //!< only the newest frame is kept
+      };
+
+      /// statistics about the asynchronous acquisition
+      struct Stats{
+        icl64s grabbed;         //!< number of frames grabbed by the backend thread
+        icl64s delivered;       //!< number of frames returned by grab()
+        icl64s dropped;         //!< number of frames that were recycled before being delivered
+        icl64s failed;          //!< number of failed backend grab calls
+        float meanQueueDepth;   //!< mean number of queued frames when grab() was called
+        int maxQueueDepth;      //!< max number of queued frames when grab() was called
+        float meanLatency;      //!< mean time (in ms) between acquisition and delivery
+        float maxLatency;       //!< max time (in ms) between acquisition and delivery
+        float meanWaitTime;     //!< mean time (in ms) grab() was blocked waiting for a frame
+      };
+
+      /// creates a running asynchronous wrapper for the given grabber
+      /** The grabber is not owned and must stay valid until the
+          AsyncGrabber is destroyed */
+      AsyncGrabber(Grabber *grabber, int queueSize=3, QueuePolicy policy=dropOldest);
+
+      /// Destructor (stops the backend thread)
+      ~AsyncGrabber();
+
+      /// returns the next queued image (blocks until an image is available)
+      /** If dst is given, the image is deep-copied into *dst, otherwise,
+          the returned image remains valid until the next call to grab().
+          If the backend grabber stopped with an error or if no image
+          arrived within the timeout, 0 is returned */
+      const core::ImgBase *grab(core::ImgBase **dst=0);
+
+      /// sets the maximum time (in ms) grab() waits for the next image (a negative value waits forever)
+      void setTimeout(int ms);
+
+      /// returns the current timeout (in ms)
+      int getTimeout() const;
+
+      /// returns the acquisition time stamp of the image returned by the last grab() call
+      utils::Time getLastAcquisitionTime() const;
+
+      /// returns the current number of queued images
+      int getQueueDepth() const;
+
+      /// returns the queue size
+      int getQueueSize() const;
+
+      /// returns the queue policy
+      QueuePolicy getQueuePolicy() const;
+
+      /// discards all queued images (e.g. after the grabber parameters were changed)
+      void clear();
+
+      /// returns the current statistics
+      Stats getStats() const;
+
+      /// resets the statistics
+      void resetStats();
+
+      /// parses a queue policy name ("drop-oldest", "block" or "latest")
+      /** An exception is thrown if the name is not valid */
+      static QueuePolicy policyFromString(const std::string &name);
+
+      /// returns the name of the given queue policy
+      static std::string policyToString(QueuePolicy policy);
+
+      private:
+      /** \cond */
+      struct Data;
+      Data *m_data;
+      /** \endcond */
+    };
+
+    /// ostream operator for AsyncGrabber::Stats
+    ICLIO_API std::ostream &operator<<(std::ostream &s, const AsyncGrabber::Stats &stats);
+
+  } // namespace io
+}
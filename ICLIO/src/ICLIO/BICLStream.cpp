@@ -0,0 +1,431 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/BICLStream.cpp                         **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/BICLStream.h>
+#include <ICLUtils/StringUtils.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifndef ICL_SYSTEM_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define icl_fseek fseeko
+#define icl_ftell ftello
+#else
+#define icl_fseek _fseeki64
+#define icl_ftell _ftelli64
+#endif
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    namespace{
+      /// container file header (64 bytes)
+      struct FileHeader{
+        char magick[8];       //!< "ICLBICLS"
+        icl32s version;       //!< format version (1)
+        icl32s reserved0;
+        icl64s frameCount;    //!< number of frames (only valid if indexOffset != 0)
+        icl64s indexOffset;   //!< offset of the frame table (0 if not finalized)
+        char reserved1[32];
+      };
+
+      /// frame record header (16 bytes)
+      struct RecordHeader{
+        char magick[4];       //!< "frm0"
+        icl32s padding;       //!< number of padding bytes between record header and frame
+        icl64s length;        //!< frame length
+      };
+
+      /// frame table entry
+      struct IndexEntry{
+        icl64s offset;        //!< offset of the serialized frame
+        icl64s length;        //!< length of the serialized frame
+      };
+
+      static const int ALIGNMENT = 16;
+
+      inline icl64s align_up(icl64s x){
+        return (x + ALIGNMENT - 1) & ~(icl64s)(ALIGNMENT - 1);
+      }
+
+      /// grants access to the ImageCompressor's header layout
+      struct FrameCodec : public ImageCompressor{
+        static int paramsSize() { return sizeof(Header::Params); }
+
+        static const Header::Params &params(const icl8u *frame){
+          return *reinterpret_cast<const Header::Params*>(frame);
+        }
+
+        static int metaLen(const icl8u *frame){
+          return params(frame).metaLen;
+        }
+
+        static bool isUncompressed(const icl8u *frame){
+          return !strncmp(params(frame).compressionMode,"none",4);
+        }
+
+        static Time timeStamp(const icl8u *frame){
+          return Time(params(frame).timeStamp);
+        }
+
+        template<class T>
+        static ImgBase *wrap(const Header::Params &p, icl8u *pixels){
+          const Size size(p.width,p.height);
+          std::vector<T*> channels(p.channels);
+          for(int c=0;c<p.channels;++c){
+            channels[c] = reinterpret_cast<T*>(pixels) + c*size.getDim();
+          }
+          return new Img<T>(size,p.channels,(format)p.colorFormat,channels,false);
+        }
+
+        /// creates an image whose channels point into the given uncompressed frame
+        static ImgBase *createShallow(icl8u *frame, icl64s len){
+          const Header::Params &p = params(frame);
+          if(p.width < 0 || p.height < 0 || p.channels < 0 || p.metaLen < 0){
+            throw ICLException("BICLStreamReader: invalid frame header");
+          }
+          if(p.depth < 0 || p.depth > depthLast){
+            throw ICLException("BICLStreamReader: invalid frame depth");
+          }
+          // checked step by step: the full product of the header fields may overflow
+          const icl64s available = len - (icl64s)sizeof(Header::Params) - p.metaLen;
+          const icl64s dim = (icl64s)p.width * p.height;
+          if(available < 0 || dim > available || dim * p.channels > available / getSizeOf((depth)p.depth)){
+            throw ICLException("BICLStreamReader: truncated frame");
+          }
+          icl8u *pixels = frame + sizeof(Header::Params) + p.metaLen;
+          ImgBase *image = 0;
+          switch(p.depth){
+#define ICL_INSTANTIATE_DEPTH(D) case depth##D: image = wrap<icl##D>(p,pixels); break;
+            ICL_INSTANTIATE_ALL_DEPTHS;
+#undef ICL_INSTANTIATE_DEPTH
+            default: throw ICLException("BICLStreamReader: invalid frame depth");
+          }
+          image->setROI(Rect(p.roiX,p.roiY,p.roiWidth,p.roiHeight));
+          image->setTime(Time(p.timeStamp));
+          const char *meta = reinterpret_cast<const char*>(frame + sizeof(Header::Params));
+          image->getMetaData().assign(meta,meta+p.metaLen);
+          return image;
+        }
+      };
+
+      /// random access to mapped container data
+      struct MemorySource{
+        MemorySource(const icl8u *data, icl64s size):data(data),size(size){}
+        bool read(icl64s offset, void *dst, icl64s len) const{
+          if(offset < 0 || offset + len > size) return false;
+          memcpy(dst, data + offset, len);
+          return true;
+        }
+        const icl8u *data;
+        icl64s size;
+      };
+
+      /// random access to a container file
+      struct FileSource{
+        FileSource(FILE *f):f(f){
+          icl_fseek(f,0,SEEK_END);
+          size = icl_ftell(f);
+        }
+        bool read(icl64s offset, void *dst, icl64s len) const{
+          if(offset < 0 || offset + len > size) return false;
+          icl_fseek(f,offset,SEEK_SET);
+          return fread(dst,1,len,f) == (size_t)len;
+        }
+        FILE *f;
+        icl64s size;
+      };
+
+      /// parses a container header and frame table (returns the end of the last frame record)
+      /** If the container was not finalized, the frame table is reconstructed by
+          scanning all frame records */
+      template<class Source>
+      static icl64s read_index(const Source &src, const std::string &filename, std::vector<IndexEntry> &index){
+        FileHeader h;
+        if(!src.read(0, &h, sizeof(h))){
+          throw ICLException("BICLStream: file " + filename + " is too short");
+        }
+        if(strncmp(h.magick,"ICLBICLS",8) || h.version != 1){
+          throw ICLException("BICLStream: file " + filename + " is not a valid .bicls container");
+        }
+        index.clear();
+        if(h.indexOffset > 0){
+          // the table is only trusted if it fits into the file and all frames lie within the data section
+          const icl64s maxFrames = h.indexOffset >= (icl64s)sizeof(FileHeader) && h.indexOffset <= src.size ?
+                                   (src.size - h.indexOffset) / (icl64s)sizeof(IndexEntry) : -1;
+          if(h.frameCount >= 0 && h.frameCount <= maxFrames){
+            index.resize(h.frameCount);
+            bool valid = !h.frameCount || src.read(h.indexOffset, &index[0], h.frameCount*(icl64s)sizeof(IndexEntry));
+            for(icl64s i=0;valid && i<h.frameCount;++i){
+              const IndexEntry &e = index[i];
+              valid = e.offset >= (icl64s)sizeof(FileHeader) && e.length > FrameCodec::paramsSize() &&
+                      e.offset <= h.indexOffset && e.length <= h.indexOffset - e.offset;
+            }
+            if(valid) return h.indexOffset;
+            index.clear();
+          }
+          WARNING_LOG("BICLStream: container " << filename << " has a corrupt frame table (recovering frame table)");
+        }else{
+          WARNING_LOG("BICLStream: container " << filename << " was not finalized (recovering frame table)");
+        }
+        icl64s offset = sizeof(FileHeader);
+        RecordHeader r;
+        while(src.read(offset, &r, sizeof(r))){
+          if(strncmp(r.magick,"frm0",4) || r.padding < 0 || r.padding >= ALIGNMENT || r.length <= FrameCodec::paramsSize()) break;
+          IndexEntry e = { offset + (icl64s)sizeof(RecordHeader) + r.padding, r.length };
+          if(e.offset > src.size || e.length > src.size - e.offset) break;
+          index.push_back(e);
+          offset = align_up(e.offset + e.length);
+        }
+        return offset;
+      }
+    }
+
+    struct BICLStreamReader::Data{
+      std::string filename;
+      icl8u *data;
+      icl64s size;
+      std::vector<IndexEntry> index;
+      ImageCompressor compressor;
+      ImgBase *shallow;
+      std::vector<icl8u> fallback;
+#ifndef ICL_SYSTEM_WINDOWS
+      int fd;
+#endif
+
+      void release(){
+        ICL_DELETE(shallow);
+#ifndef ICL_SYSTEM_WINDOWS
+        if(data) munmap(data, size);
+        ::close(fd);
+#endif
+        data = 0;
+      }
+    };
+
+    BICLStreamReader::BICLStreamReader(const std::string &filename) throw (ICLException):m_data(new Data){
+      m_data->filename = filename;
+      m_data->data = 0;
+      m_data->size = 0;
+      m_data->shallow = 0;
+#ifndef ICL_SYSTEM_WINDOWS
+      m_data->fd = open(filename.c_str(), O_RDONLY);
+      struct stat st;
+      if(m_data->fd < 0 || fstat(m_data->fd,&st)){
+        if(m_data->fd >= 0) ::close(m_data->fd);
+        delete m_data;
+        throw FileNotFoundException(filename);
+      }
+      m_data->size = st.st_size;
+      if(m_data->size > 0){
+        // private writable mapping: images that point into the mapping can be modified (copy-on-write)
+        void *p = mmap(0, m_data->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_data->fd, 0);
+        if(p == MAP_FAILED){
+          ::close(m_data->fd);
+          delete m_data;
+          throw ICLException("BICLStreamReader: unable to map file " + filename);
+        }
+        m_data->data = (icl8u*)p;
+      }
+#else
+      FILE *f = fopen(filename.c_str(),"rb");
+      if(!f){
+        delete m_data;
+        throw FileNotFoundException(filename);
+      }
+      icl_fseek(f,0,SEEK_END);
+      m_data->size = icl_ftell(f);
+      icl_fseek(f,0,SEEK_SET);
+      m_data->fallback.resize(m_data->size);
+      if(m_data->size) fread(&m_data->fallback[0],1,m_data->size,f);
+      fclose(f);
+      m_data->data = m_data->size ? &m_data->fallback[0] : 0;
+#endif
+      try{
+        read_index(MemorySource(m_data->data, m_data->size), filename, m_data->index);
+      }catch(...){
+        m_data->release();
+        delete m_data;
+        throw;
+      }
+    }
+
+    BICLStreamReader::~BICLStreamReader(){
+      m_data->release();
+      delete m_data;
+    }
+
+    const std::string &BICLStreamReader::getFileName() const{
+      return m_data->filename;
+    }
+
+    int BICLStreamReader::getFrameCount() const{
+      return (int)m_data->index.size();
+    }
+
+    bool BICLStreamReader::isUncompressed(int idx) const{
+      ICLASSERT_THROW(idx >= 0 && idx < getFrameCount(), ICLException("BICLStreamReader: invalid frame index " + str(idx)));
+      return FrameCodec::isUncompressed(m_data->data + m_data->index[idx].offset);
+    }
+
+    Time BICLStreamReader::getTimeStamp(int idx) const{
+      ICLASSERT_THROW(idx >= 0 && idx < getFrameCount(), ICLException("BICLStreamReader: invalid frame index " + str(idx)));
+      return FrameCodec::timeStamp(m_data->data + m_data->index[idx].offset);
+    }
+
+    const ImgBase *BICLStreamReader::getFrame(int idx, ImgBase **dst){
+      ICLASSERT_THROW(idx >= 0 && idx < getFrameCount(), ICLException("BICLStreamReader: invalid frame index " + str(idx)));
+      const IndexEntry &e = m_data->index[idx];
+      icl8u *frame = m_data->data + e.offset;
+      if(FrameCodec::isUncompressed(frame)){
+        ICL_DELETE(m_data->shallow);
+        m_data->shallow = FrameCodec::createShallow(frame, e.length);
+        if(dst){
+          m_data->shallow->deepCopy(dst);
+          return *dst;
+        }
+        return m_data->shallow;
+      }
+      return m_data->compressor.uncompress(frame, (int)e.length, dst);
+    }
+
+
+    struct BICLStreamWriter::Data{
+      std::string filename;
+      FILE *file;
+      ImageCompressor compressor;
+      std::vector<IndexEntry> index;
+      icl64s end;
+    };
+
+    static void write_bytes(FILE *f, const void *data, size_t len, const std::string &filename){
+      if(len && fwrite(data,1,len,f) != len){
+        throw ICLException("BICLStreamWriter: unable to write to file " + filename);
+      }
+    }
+
+    static void write_file_header(FILE *f, icl64s frameCount, icl64s indexOffset, const std::string &filename){
+      FileHeader h;
+      memset(&h,0,sizeof(h));
+      memcpy(h.magick,"ICLBICLS",8);
+      h.version = 1;
+      h.frameCount = frameCount;
+      h.indexOffset = indexOffset;
+      icl_fseek(f,0,SEEK_SET);
+      write_bytes(f,&h,sizeof(h),filename);
+    }
+
+    BICLStreamWriter::BICLStreamWriter(const std::string &filename,
+                                       const ImageCompressor::CompressionSpec &spec,
+                                       bool append) throw (ICLException):m_data(new Data){
+      m_data->filename = filename;
+      m_data->compressor.setCompression(spec);
+      m_data->file = append ? fopen(filename.c_str(),"r+b") : 0;
+      if(m_data->file){
+        // read the existing index (the index is overwritten by the next frame)
+        try{
+          m_data->end = read_index(FileSource(m_data->file), filename, m_data->index);
+        }catch(...){
+          fclose(m_data->file);
+          delete m_data;
+          throw;
+        }
+      }else{
+        m_data->file = fopen(filename.c_str(),"w+b");
+        if(!m_data->file){
+          delete m_data;
+          throw ICLException("BICLStreamWriter: unable to open file " + filename + " for writing");
+        }
+        m_data->end = sizeof(FileHeader);
+      }
+      // mark the container as not finalized until close() is called
+      write_file_header(m_data->file, 0, 0, filename);
+      icl_fseek(m_data->file, m_data->end, SEEK_SET);
+    }
+
+    BICLStreamWriter::~BICLStreamWriter(){
+      close();
+      delete m_data;
+    }
+
+    void BICLStreamWriter::write(const ImgBase *image){
+      ICLASSERT_RETURN(image);
+      ICLASSERT_RETURN(m_data->file);
+      const ImageCompressor::CompressedData data = m_data->compressor.compress(image);
+
+      // pad such that the pixel data (behind frame header and meta data) is aligned
+      const icl64s frameStart = m_data->end + sizeof(RecordHeader);
+      const icl64s pixelStart = frameStart + FrameCodec::paramsSize() + FrameCodec::metaLen(data.bytes);
+      RecordHeader r;
+      memcpy(r.magick,"frm0",4);
+      r.padding = (int)(align_up(pixelStart) - pixelStart);
+      r.length = data.len;
+
+      static const icl8u zeros[ALIGNMENT] = {0};
+      IndexEntry e = { frameStart + r.padding, data.len };
+      const icl64s next = align_up(e.offset + e.length);
+
+      write_bytes(m_data->file, &r, sizeof(r), m_data->filename);
+      write_bytes(m_data->file, zeros, r.padding, m_data->filename);
+      write_bytes(m_data->file, data.bytes, data.len, m_data->filename);
+      write_bytes(m_data->file, zeros, next - (e.offset + e.length), m_data->filename);
+
+      m_data->index.push_back(e);
+      m_data->end = next;
+    }
+
+    void BICLStreamWriter::close(){
+      if(!m_data->file) return;
+      try{
+        icl_fseek(m_data->file, m_data->end, SEEK_SET);
+        if(m_data->index.size()){
+          write_bytes(m_data->file, &m_data->index[0], m_data->index.size()*sizeof(IndexEntry), m_data->filename);
+        }
+        write_file_header(m_data->file, m_data->index.size(), m_data->end, m_data->filename);
+      }catch(ICLException &e){
+        ERROR_LOG(e.what());
+      }
+      fclose(m_data->file);
+      m_data->file = 0;
+    }
+
+    int BICLStreamWriter::getFrameCount() const{
+      return (int)m_data->index.size();
+    }
+
+  } // namespace io
+}
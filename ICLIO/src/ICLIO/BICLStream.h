@@ -0,0 +1,132 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/BICLStream.h                           **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Exception.h>
+#include <ICLUtils/Time.h>
+#include <ICLIO/ImageCompressor.h>
+#include <string>
+
+namespace icl{
+  namespace io{
+
+    /// Reader for indexed multi-frame .bicls containers \ingroup FILEIO_G
+    /** A .bicls container stores a sequence of frames, each serialized by the
+        ImageCompressor (i.e. each frame is exactly what would be stored in a
+        single .bicl file), and a frame offset table for O(1) random access.
+
+        The reader memory-maps the whole container. Frames that were stored
+        with compression mode "none" are not copied at all: the returned image's
+        channels point directly into the mapping. The mapping is private
+        (copy-on-write), so the returned images can be modified without
+        affecting the file, but they are only valid as long as the reader exists
+        and until the next call to getFrame(). Compressed frames are decoded
+        directly from the mapping.
+
+        \section FMT File Format
+        - 64 byte file header: magic "ICLBICLS", version, frame count and the
+          offset of the frame table (0 if the container was not finalized)
+        - frame records: a 16 byte record header (magic, padding and frame length)
+          followed by padding and the serialized frame. The padding is chosen
+          such that each frame's pixel data is 16-byte aligned in the file.
+        - frame table: (offset,length) pairs of 64 bit integers
+
+        If a container was not finalized (e.g. because the writing process
+        crashed), the frame table is reconstructed by scanning the frame records.
+    */
+    class ICLIO_API BICLStreamReader : public utils::Uncopyable{
+      public:
+      /// opens and maps the given container (throws an exception on errors)
+      BICLStreamReader(const std::string &filename) throw (utils::ICLException);
+
+      /// Destructor (unmaps the file)
+      ~BICLStreamReader();
+
+      /// returns the container filename
+      const std::string &getFileName() const;
+
+      /// returns the number of frames
+      int getFrameCount() const;
+
+      /// returns whether the given frame is stored uncompressed (and is therefore returned without copying)
+      bool isUncompressed(int idx) const;
+
+      /// returns the time stamp of the given frame
+      utils::Time getTimeStamp(int idx) const;
+
+      /// returns the given frame
+      /** If dst is null, uncompressed frames are returned as shallow images that
+          point into the file mapping. Otherwise, the frame is copied/decoded
+          into *dst. */
+      const core::ImgBase *getFrame(int idx, core::ImgBase **dst=0);
+
+      private:
+      /** \cond */
+      struct Data;
+      Data *m_data;
+      /** \endcond */
+    };
+
+    /// Writer for indexed multi-frame .bicls containers \ingroup FILEIO_G
+    /** Frames are appended to the container. The frame table is written when
+        the writer is closed (or destroyed). If the given file already exists and
+        is a valid container, new frames are appended to it (unless append is false).
+        @see BICLStreamReader for the file format */
+    class ICLIO_API BICLStreamWriter : public utils::Uncopyable{
+      public:
+      /// opens the given container for writing
+      BICLStreamWriter(const std::string &filename,
+                       const ImageCompressor::CompressionSpec &spec=ImageCompressor::CompressionSpec("none"),
+                       bool append=true) throw (utils::ICLException);
+
+      /// Destructor (calls close())
+      ~BICLStreamWriter();
+
+      /// appends the given image to the container
+      void write(const core::ImgBase *image);
+
+      /// writes the frame table and closes the file
+      void close();
+
+      /// returns the number of frames in the container (including previously existing ones)
+      int getFrameCount() const;
+
+      private:
+      /** \cond */
+      struct Data;
+      Data *m_data;
+      /** \endcond */
+    };
+
+  } // namespace io
+}
@@ -0,0 +1,136 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/BICLStreamGrabber.cpp                  **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/BICLStreamGrabber.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/File.h>
+#include <ICLUtils/ClippedCast.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    BICLStreamGrabber::BICLStreamGrabber(const std::string &filename) throw (ICLException):
+      m_reader(filename),m_nextIdx(0),m_autoNext(true),m_loop(true),m_updatingProperties(false){
+      if(!m_reader.getFrameCount()){
+        throw ICLException("BICLStreamGrabber: container " + filename + " does not contain any frames");
+      }
+      addProperty("format","info","","unknown",0,"");
+      addProperty("size","info","","unknown",0,"");
+      addProperty("frame-count","info","",str(m_reader.getFrameCount()),0,"Number of frames in the container");
+      addProperty("frame-index","range:spinbox","[0," + str(m_reader.getFrameCount()-1) + "]",0,0,"Index of the next frame");
+      addProperty("next","command","",Any(),0,"Increments the frame index");
+      addProperty("prev","command","",Any(),0,"Decrements the frame index");
+      addProperty("jump-to-start","command","",Any(),0,"Resets the frame index to 0");
+      addProperty("auto-next","flag","",m_autoNext,0,"Whether to automatically increment the frame index for every grabbed frame");
+      addProperty("loop","flag","",m_loop,0,"Whether to restart at frame 0 after the last frame");
+      Configurable::registerCallback(utils::function(this,&BICLStreamGrabber::processPropertyChange));
+    }
+
+    BICLStreamGrabber::~BICLStreamGrabber(){}
+
+    const ImgBase *BICLStreamGrabber::acquireImage(){
+      Mutex::Locker lock(m_mutex);
+      const int n = m_reader.getFrameCount();
+      if(m_nextIdx >= n){
+        if(!m_loop) return 0;
+        m_nextIdx = 0;
+      }
+      const ImgBase *image = 0;
+      try{
+        image = m_reader.getFrame(m_nextIdx);
+      }catch(ICLException &e){
+        ERROR_LOG("unable to read frame " << m_nextIdx << " from " << m_reader.getFileName() << ": " << e.what());
+        return 0;
+      }
+      if(m_autoNext) ++m_nextIdx;
+
+      m_updatingProperties = true;
+      setPropertyValue("format", Any(image->getFormat()));
+      setPropertyValue("size", Any(image->getSize()));
+      setPropertyValue("frame-index", m_nextIdx < n ? m_nextIdx : 0);
+      m_updatingProperties = false;
+      return image;
+    }
+
+    int BICLStreamGrabber::getFrameCount() const{
+      return m_reader.getFrameCount();
+    }
+
+    int BICLStreamGrabber::getNextFrameIndex() const{
+      Mutex::Locker lock(m_mutex);
+      return m_nextIdx;
+    }
+
+    void BICLStreamGrabber::setNextFrameIndex(int idx){
+      Mutex::Locker lock(m_mutex);
+      m_nextIdx = clip(idx,0,m_reader.getFrameCount()-1);
+    }
+
+    void BICLStreamGrabber::processPropertyChange(const utils::Configurable::Property &prop){
+      if(m_updatingProperties) return;
+      const int n = m_reader.getFrameCount();
+      if(prop.name == "frame-index"){
+        setNextFrameIndex(parse<int>(prop.value));
+      }else if(prop.name == "next"){
+        Mutex::Locker lock(m_mutex);
+        m_nextIdx = (m_nextIdx + 1) % n;
+      }else if(prop.name == "prev"){
+        Mutex::Locker lock(m_mutex);
+        m_nextIdx = (m_nextIdx + n - 1) % n;
+      }else if(prop.name == "jump-to-start"){
+        setNextFrameIndex(0);
+      }else if(prop.name == "auto-next"){
+        m_autoNext = parse<bool>(prop.value);
+      }else if(prop.name == "loop"){
+        m_loop = parse<bool>(prop.value);
+      }
+    }
+
+    static Grabber *createBICLStreamGrabber(const std::string &param){
+      return new BICLStreamGrabber(param);
+    }
+
+    static const std::vector<GrabberDeviceDescription> &getBICLStreamDeviceList(std::string filter, bool rescan){
+      static std::vector<GrabberDeviceDescription> deviceList;
+      if(!rescan) return deviceList;
+      deviceList.clear();
+      if(filter.size() && File(filter).exists()){
+        deviceList.push_back(GrabberDeviceDescription("bicls", filter, "A grabber for .bicls image containers."));
+      }
+      return deviceList;
+    }
+
+    REGISTER_GRABBER(bicls,utils::function(createBICLStreamGrabber),utils::function(getBICLStreamDeviceList),"bicls:container file name:memory mapped replay of .bicls multi-frame containers");
+
+  } // namespace io
+}
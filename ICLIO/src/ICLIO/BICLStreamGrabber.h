@@ -0,0 +1,86 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/BICLStreamGrabber.h                    **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Mutex.h>
+#include <ICLIO/Grabber.h>
+#include <ICLIO/BICLStream.h>
+
+namespace icl{
+  namespace io{
+
+    /// Grabber for indexed multi-frame .bicls containers \ingroup FILEIO_G \ingroup GRABBER_G
+    /** The grabber replays the frames of a .bicls container (see BICLStreamReader).
+        Uncompressed frames are provided without copying the pixel data: the
+        returned images point into the memory mapped file. Random access
+        to arbitrary frames is possible using the "frame-index" property.
+
+        Containers can be recorded using the FileWriter or the GenericImageOutput
+        (e.g. icl-pipe -input dc 0 -o file recording.bicls) and replayed using
+        the GenericGrabber's "bicls" backend (e.g. icl-camviewer -input bicls recording.bicls).
+    */
+    class ICLIO_API BICLStreamGrabber : public Grabber{
+      public:
+
+      /// opens the given container
+      BICLStreamGrabber(const std::string &filename) throw (utils::ICLException);
+
+      /// Destructor
+      ~BICLStreamGrabber();
+
+      /// returns the next frame
+      virtual const core::ImgBase* acquireImage();
+
+      /// returns the number of frames
+      int getFrameCount() const;
+
+      /// returns the index of the next to-be-grabbed frame
+      int getNextFrameIndex() const;
+
+      /// sets the next to-be-grabbed frame
+      void setNextFrameIndex(int idx);
+
+      private:
+
+      /// callback function for property changes.
+      void processPropertyChange(const utils::Configurable::Property &p);
+
+      BICLStreamReader m_reader;   //!< wrapped container reader
+      int m_nextIdx;               //!< next frame index
+      bool m_autoNext;             //!< automatically increment the frame index
+      bool m_loop;                 //!< restart after the last frame
+      mutable utils::Mutex m_mutex;
+      bool m_updatingProperties;
+    };
+
+  } // namespace io
+}
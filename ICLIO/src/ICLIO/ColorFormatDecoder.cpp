@@ -78,102 +78,26 @@ namespace icl{
         
       void gray(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer=0){
         ensureCompatible(dst,depth8u,size,formatGray);
-        Img8u &image = *(*dst)->as8u();
-  
-        (void)buffer;
-        Img8u tmp(size,1,std::vector<icl8u*>(1,const_cast<icl8u*>(rawData)),false);
-        cc(&tmp,&image);
+        convertInterleaved(rawData,layoutGray,*dst);
       }
       
-      
       void y444(const icl8u* rawData, const Size &size, ImgBase **dst, std::vector<icl8u> *buffer){
         ensureCompatible(dst,depth8u,size,formatRGB);
-        Img8u &image = *(*dst)->as8u();
-  
-  #ifdef ICL_HAVE_IPP
-        if(buffer){
-          buffer->resize(size.getDim()*3);
-          ippiYUVToRGB_8u_C3R(rawData,3*size.width,buffer->data(),3*size.width,size);
-          interleavedToPlanar(buffer->data(),&image);
-          return;
-        }
-  #endif
-  
-        icl8u *dstR = image.begin(0);
-        icl8u *dstG = image.begin(1);
-        icl8u *dstB = image.begin(2);
-        
-        const icl8u *pSrcEnd = rawData+size.getDim()*3;
-        
         // data order uyv uyv ...
-        for(const icl8u *pSrc = rawData; pSrc <pSrcEnd ; pSrc+=3){
-          int tr,tg,tb;
-          cc_util_yuv_to_rgb(pSrc[1],pSrc[0],pSrc[2],tr,tg,tb);
-          *dstR++ = tr;
-          *dstG++ = tg;
-          *dstB++ = tb;
-        }
+        convertInterleaved(rawData,layoutUYV,*dst);
       }
       
-      // uses ipp if available and if buf is not null
       void yuyv(const icl8u* yuyv, const Size &size, ImgBase **dst, std::vector<icl8u> *buf=0){
         ensureCompatible(dst,depth8u,size,formatRGB);
-        Img8u &image = *(*dst)->as8u();
-        /*
-  #ifdef ICL_HAVE_IPP
-        if(buf){
-          // 3Times faster on -O4
-          buf->resize(size.getDim()*3);
-          ippiCbYCr422ToRGB_8u_C2C3R(yuyv,2*size.width, buf->data(),3*size.width, size);
-          interleavedToPlanar(buf->data(),&image);
-          return;
-        }
-  #endif
-            */
-        // interleaved order yuyv
-        icl8u *r = image.begin(0), *g = image.begin(1), *b=image.begin(2);
-        const int dim = image.getDim()/2;
-        for(int i=0;i<dim;++i){
-          int tr,tg,tb;
-          cc_util_yuv_to_rgb(yuyv[0], yuyv[1], yuyv[3],tr,tg,tb);
-          r[2*i] = tr;
-          g[2*i] = tg;
-          b[2*i] = tb;
-          
-          cc_util_yuv_to_rgb(yuyv[2], yuyv[1], yuyv[3],tr,tg,tb);
-          r[2*i+1] = tr;
-          g[2*i+1] = tg;
-          b[2*i+1] = tb;
-          
-          yuyv += 4;
-        }
+        convertInterleaved(yuyv,layoutYUYV,*dst);
       }
 
-      // uses ipp if available and if buf is not null
       void yuy2(const icl8u* yuy2, const Size &size, ImgBase **dst, std::vector<icl8u> *buf=0){
         ensureCompatible(dst,depth8u,size,formatRGB);
-        Img8u &image = *(*dst)->as8u();
-        // interleaved order yuyv
-        icl8u *r = image.begin(0), *g = image.begin(1), *b=image.begin(2);
-        const int dim = image.getDim()/2;
-        for(int i=0;i<dim;++i){
-          int tr,tg,tb;
-          cc_util_yuv_to_rgb(yuy2[1], yuy2[0], yuy2[2],tr,tg,tb);
-          r[2*i] = tr;
-          g[2*i] = tg;
-          b[2*i] = tb;
-          
-          cc_util_yuv_to_rgb(yuy2[3], yuy2[0], yuy2[2],tr,tg,tb);
-          r[2*i+1] = tr;
-          g[2*i+1] = tg;
-          b[2*i+1] = tb;
-          
-          yuy2 += 4;
-        }
+        // interleaved order uyvy
+        convertInterleaved(yuy2,layoutUYVY,*dst);
       }
 
-     
-  
   #ifdef ICL_HAVE_LIBJPEG    
       void mjpg(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u> *buf = 0){
         try{
@@ -194,13 +118,18 @@ namespace icl{
         convertYUV420ToRGB8(data,size,(*dst)->as8u());
       }
 
-       void rgb3(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u>*){
+      void rgb3(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u>*){
+        ensureCompatible(dst,depth8u,size,formatRGB);
+        convertInterleaved(data,layoutRGB,*dst);
+      }
+
+      void bgr3(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u>*){
         ensureCompatible(dst,depth8u,size,formatRGB);
-        interleavedToPlanar(data, (*dst)->as8u());
+        convertInterleaved(data,layoutBGR,*dst);
       }
       
     }
-    ColorFormatDecoder::ColorFormatDecoder():m_dstBuf(0){
+    ColorFormatDecoder::ColorFormatDecoder():m_dstBuf(0),m_convBuf(0){
       m_functions[FourCC("GRAY").asInt()] = color_format_converter::gray;
       m_functions[FourCC("Y800").asInt()] = color_format_converter::gray;
       m_functions[FourCC("GREY").asInt()] = color_format_converter::gray;
@@ -211,6 +140,8 @@ namespace icl{
       m_functions[FourCC("MYRM").asInt()] = color_format_converter::myrm;
       m_functions[FourCC("Y10B").asInt()] = color_format_converter::y10b;
       m_functions[FourCC("RGB3").asInt()] = color_format_converter::rgb3;
+      m_functions[FourCC("BGR3").asInt()] = color_format_converter::bgr3;
+      m_functions[FourCC("UYVY").asInt()] = color_format_converter::yuy2;
       m_functions[FourCC("RGGB").asInt()] = color_format_converter::bayer<BayerConverter::bayerPattern_RGGB>;
       m_functions[FourCC("GBRG").asInt()] = color_format_converter::bayer<BayerConverter::bayerPattern_GBRG>;
       m_functions[FourCC("GRBG").asInt()] = color_format_converter::bayer<BayerConverter::bayerPattern_GRBG>;
@@ -219,10 +150,20 @@ namespace icl{
   #ifdef ICL_HAVE_LIBJPEG
       m_functions[FourCC("MJPG").asInt()] = color_format_converter::mjpg;
   #endif
-  
+
+      m_layouts[FourCC("GRAY").asInt()] = layoutGray;
+      m_layouts[FourCC("Y800").asInt()] = layoutGray;
+      m_layouts[FourCC("GREY").asInt()] = layoutGray;
+      m_layouts[FourCC("YUYV").asInt()] = layoutYUYV;
+      m_layouts[FourCC("YUY2").asInt()] = layoutUYVY;
+      m_layouts[FourCC("UYVY").asInt()] = layoutUYVY;
+      m_layouts[FourCC("Y444").asInt()] = layoutUYV;
+      m_layouts[FourCC("RGB3").asInt()] = layoutRGB;
+      m_layouts[FourCC("BGR3").asInt()] = layoutBGR;
     }
     ColorFormatDecoder::~ColorFormatDecoder(){
       ICL_DELETE(m_dstBuf);
+      ICL_DELETE(m_convBuf);
     }
     
     void ColorFormatDecoder::decode(FourCC fourcc, const icl8u *data, const Size &size, ImgBase **dst){
@@ -231,5 +172,25 @@ namespace icl{
   
       it->second(data,size,dst,&m_buffer);
     }
+
+    void ColorFormatDecoder::decode(FourCC fourcc, const icl8u *data, const Size &size, ImgBase **dst,
+                                    depth d, format fmt){
+      ICLASSERT_RETURN(dst);
+      std::map<icl32u,interleavedLayout>::const_iterator it = m_layouts.find(fourcc.asInt());
+      if(it != m_layouts.end()){
+        const format natural = it->second == layoutGray ? formatGray : formatRGB;
+        ensureCompatible(dst, (int)d == -1 ? depth8u : d, size, (int)fmt == -1 ? natural : fmt);
+        convertInterleaved(data,it->second,*dst);
+        return;
+      }
+      if((int)d == -1 && (int)fmt == -1){
+        decode(fourcc,data,size,dst);
+        return;
+      }
+      decode(fourcc,data,size,&m_convBuf);
+      ensureCompatible(dst, (int)d == -1 ? m_convBuf->getDepth() : d, m_convBuf->getSize(),
+                       (int)fmt == -1 ? m_convBuf->getFormat() : fmt);
+      cc(m_convBuf,*dst);
+    }
   } // namespace io
 }
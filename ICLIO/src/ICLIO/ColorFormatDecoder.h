@@ -32,6 +32,7 @@
 
 #include <ICLUtils/CompatMacros.h>
 #include <ICLCore/Img.h>
+#include <ICLCore/CCFunctions.h>
 #include <ICLIO/FourCC.h>
 
 #include <map>
@@ -52,6 +53,8 @@ namespace icl{
         * <b>GRAY, GREY or Y800</b> simple 8bit grayscale image (no version, copy only)
         * <b>YUYV</b> encodes 2 rgb-pixels in 4 bytes, ordered Y_1UY_2V, so the first
           pixel is created from Y_1, U and V and the 2nd pixel is created from Y_2, U, and V
+        * <b>YUY2, UYVY</b> like YUYV, but ordered UY_1VY_2
+        * <b>RGB3, BGR3</b> interleaved 24 bit RGB and BGR data
         * <b>Y444</b> Simple interleaved YUV-format, data order: U_1,Y_1,V_2,U_2, ...
         * <b>YU12</b> Very common planar format where Y, U and V channels are packed
           in order Y,U,V. The special thing is here, that U and V have only half x- and 
@@ -67,6 +70,15 @@ namespace icl{
         \section EX ICL Specific Extensions
         For supporting the Myrmex Tactile Device, we added an extra
         FourCC code called "MYRM".
+
+        \section FUS Fused Decoding
+        The decode methods that get an additional core::depth and core::format
+        directly produce images with the given parameters. For the interleaved
+        FourCC codes (GRAY, GREY, Y800, YUYV, YUY2, UYVY, Y444, RGB3 and BGR3)
+        unpacking, color conversion and depth conversion are fused into a single
+        pass (see core::convertInterleaved). Here, only the ROI of an already
+        existing destination image is written. All other codes are decoded
+        as usual and converted afterwards.
   
         @see FourCC
     */
@@ -78,7 +90,9 @@ namespace icl{
       private:
       std::vector<icl8u> m_buffer; //!< internal buffer  
       std::map<icl32u,decoder_func> m_functions; //!< internal lookup for conversion functions
+      std::map<icl32u,core::interleavedLayout> m_layouts; //!< codes that support fused decoding
       core::ImgBase *m_dstBuf;  //!< optionally used output buffer
+      core::ImgBase *m_convBuf; //!< intermediate buffer for non-fused decoding with conversion
       
       public:
       /// create a new instance
@@ -100,6 +114,19 @@ namespace icl{
         decode(fourcc,data,size,&m_dstBuf);
         return m_dstBuf;
       }
+
+      /// decodes a given data range into an image of given depth and format
+      /** If d or fmt is -1 (as the Grabber's unused desired parameters), the
+          decoder's default is used for it (see \ref FUS) */
+      void decode(FourCC fourcc, const icl8u *data, const utils::Size &size, core::ImgBase **dst,
+                  core::depth d, core::format fmt);
+
+      /// decode with given depth and format, but use the internal buffer as output
+      const core::ImgBase *decode(FourCC fourcc, const icl8u *data, const utils::Size &size,
+                                  core::depth d, core::format fmt){
+        decode(fourcc,data,size,&m_dstBuf,d,fmt);
+        return m_dstBuf;
+      }
       
     };
   } // namespace io
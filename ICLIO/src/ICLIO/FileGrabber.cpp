@@ -30,14 +30,17 @@
 
 #include <string>
 #include <map>
+#include <algorithm>
 #include <ICLIO/FileGrabber.h>
 #include <ICLIO/FileList.h>
 #include <ICLIO/FilenameGenerator.h>
 #include <ICLUtils/Exception.h>
 #include <ICLUtils/StringUtils.h>
 #include <ICLUtils/Thread.h>
+#include <ICLUtils/Mutex.h>
 #include <ICLUtils/Function.h>
 #include <ICLUtils/File.h>
+#include <ICLUtils/TaskScheduler.h>
 // plugins
 #include <ICLIO/FileGrabberPluginPNM.h>
 #include <ICLIO/FileGrabberPluginBICL.h>
@@ -69,6 +72,10 @@ using namespace icl::core;
 namespace icl{
   namespace io{
 
+    /** \cond */
+    class FileGrabberReadAhead;
+    /** \endcond */
+
     struct FileGrabber::Data{
         /// internal file list
         FileList oFileList;
@@ -102,80 +109,304 @@ namespace icl{
 
         /// also for time stamp based image acquisition
         Time referenceTimeReal;
-      
+
+        /// parallel read-ahead decoder (null if read-ahead is disabled)
+        FileGrabberReadAhead *readAhead;
+
+        /// desired number of read-ahead frames (applied in the grabbing thread)
+        int readAheadFrames;
+
+        /// desired number of read-ahead threads (0: one per core)
+        int readAheadThreads;
     };
     
-    static FileGrabberPlugin *find_plugin(const std::string &type){
-      static std::map<std::string,SmartPtr<FileGrabberPlugin> > plugins;
-      if(!plugins.size()){
-        plugins[".ppm"] = new FileGrabberPluginPNM;
-        plugins[".pgm"] = new FileGrabberPluginPNM;
-        plugins[".pnm"] = new FileGrabberPluginPNM;
-        plugins[".icl"] = new FileGrabberPluginPNM;
-        plugins[".csv"] = new FileGrabberPluginCSV;
-        plugins[".bicl"] = new FileGrabberPluginBICL;
-        plugins[".rle1"] = new FileGrabberPluginBICL;
-        plugins[".rle4"] = new FileGrabberPluginBICL;
-        plugins[".rle6"] = new FileGrabberPluginBICL;
-        plugins[".rle8"] = new FileGrabberPluginBICL;
+    typedef std::map<std::string,SmartPtr<FileGrabberPlugin> > PluginMap;
+
+    static void create_plugins(PluginMap &plugins){
+      plugins[".ppm"] = new FileGrabberPluginPNM;
+      plugins[".pgm"] = new FileGrabberPluginPNM;
+      plugins[".pnm"] = new FileGrabberPluginPNM;
+      plugins[".icl"] = new FileGrabberPluginPNM;
+      plugins[".csv"] = new FileGrabberPluginCSV;
+      plugins[".bicl"] = new FileGrabberPluginBICL;
+      plugins[".rle1"] = new FileGrabberPluginBICL;
+      plugins[".rle4"] = new FileGrabberPluginBICL;
+      plugins[".rle6"] = new FileGrabberPluginBICL;
+      plugins[".rle8"] = new FileGrabberPluginBICL;
 
 #ifdef ICL_HAVE_LIBJPEG
-        plugins[".jpg"] = new FileGrabberPluginJPEG;
-        plugins[".jpeg"] = new FileGrabberPluginJPEG;
-        plugins[".jicl"] = new FileGrabberPluginBICL;
+      plugins[".jpg"] = new FileGrabberPluginJPEG;
+      plugins[".jpeg"] = new FileGrabberPluginJPEG;
+      plugins[".jicl"] = new FileGrabberPluginBICL;
 #elif ICL_HAVE_IMAGEMAGICK
-        plugins[".jpg"] = new FileGrabberPluginImageMagick;
-        plugins[".jpeg"] = new FileGrabberPluginImageMagick;
+      plugins[".jpg"] = new FileGrabberPluginImageMagick;
+      plugins[".jpeg"] = new FileGrabberPluginImageMagick;
 #endif
 
 #ifdef ICL_HAVE_LIBZ
-        plugins[".ppm.gz"] = new FileGrabberPluginPNM;
-        plugins[".pgm.gz"] = new FileGrabberPluginPNM;
-        plugins[".pnm.gz"] = new FileGrabberPluginPNM;
-        plugins[".icl.gz"] = new FileGrabberPluginPNM;
-        plugins[".csv.gz"] = new FileGrabberPluginCSV;
-        plugins[".bicl.gz"] = new FileGrabberPluginBICL;
-        plugins[".rle1.gz"] = new FileGrabberPluginBICL;
-        plugins[".rle4.gz"] = new FileGrabberPluginBICL;
-        plugins[".rle6.gz"] = new FileGrabberPluginBICL;
-        plugins[".rle8.gz"] = new FileGrabberPluginBICL;
+      plugins[".ppm.gz"] = new FileGrabberPluginPNM;
+      plugins[".pgm.gz"] = new FileGrabberPluginPNM;
+      plugins[".pnm.gz"] = new FileGrabberPluginPNM;
+      plugins[".icl.gz"] = new FileGrabberPluginPNM;
+      plugins[".csv.gz"] = new FileGrabberPluginCSV;
+      plugins[".bicl.gz"] = new FileGrabberPluginBICL;
+      plugins[".rle1.gz"] = new FileGrabberPluginBICL;
+      plugins[".rle4.gz"] = new FileGrabberPluginBICL;
+      plugins[".rle6.gz"] = new FileGrabberPluginBICL;
+      plugins[".rle8.gz"] = new FileGrabberPluginBICL;
+      plugins[".zicl"] = new FileGrabberPluginBICL;
 #endif
 
 #ifdef ICL_HAVE_LIBPNG
-        plugins[".png"] = new FileGrabberPluginPNG;
+      plugins[".png"] = new FileGrabberPluginPNG;
 #endif
 
 #ifdef ICL_HAVE_IMAGEMAGICK
-        const char *imageMagickFormats[] = {
+      const char *imageMagickFormats[] = {
   #ifndef ICL_HAVE_LIBPNG
-          "png",
+        "png",
   #endif
-          "gif","pdf","ps","avs","bmp","cgm","cin","cur","cut","dcx",
-          "dib","dng","dot","dpx","emf","epdf","epi","eps","eps2","eps3",
-          "epsf","epsi","ept","fax","gplt","gray","hpgl","html","ico","info",
-          "jbig","jng","jp2","jpc","man","mat","miff","mono","mng","mpeg","m2v",
-          "mpc","msl","mtv","mvg","palm","pbm","pcd","pcds","pcl","pcx","pdb",
-          "pfa","pfb","picon","pict","pix","ps","ps2","ps3","psd","ptif","pwp",
-          "rad","rgb","pgba","rla","rle","sct","sfw","sgi","shtml","sun","svg",
-          "tga","tiff","tim","ttf","txt","uil","uyuv","vicar","viff","wbmp",
-          "wmf","wpg","xbm","xcf","xpm","xwd","ydbcr","ycbcra","yuv",0
-        };
-        
-        for(const char **pc=imageMagickFormats;*pc;++pc){
-          plugins[std::string(".")+*pc] = new FileGrabberPluginImageMagick;
-        }
-#endif
-        // add additional plugins to the map
+        "gif","pdf","ps","avs","bmp","cgm","cin","cur","cut","dcx",
+        "dib","dng","dot","dpx","emf","epdf","epi","eps","eps2","eps3",
+        "epsf","epsi","ept","fax","gplt","gray","hpgl","html","ico","info",
+        "jbig","jng","jp2","jpc","man","mat","miff","mono","mng","mpeg","m2v",
+        "mpc","msl","mtv","mvg","palm","pbm","pcd","pcds","pcl","pcx","pdb",
+        "pfa","pfb","picon","pict","pix","ps","ps2","ps3","psd","ptif","pwp",
+        "rad","rgb","pgba","rla","rle","sct","sfw","sgi","shtml","sun","svg",
+        "tga","tiff","tim","ttf","txt","uil","uyuv","vicar","viff","wbmp",
+        "wmf","wpg","xbm","xcf","xpm","xwd","ydbcr","ycbcra","yuv",0
+      };
+      
+      for(const char **pc=imageMagickFormats;*pc;++pc){
+        plugins[std::string(".")+*pc] = new FileGrabberPluginImageMagick;
       }
+#endif
+      // add additional plugins to the map
+    }
+
+    static FileGrabberPlugin *find_plugin_in(PluginMap &plugins, const std::string &type){
       std::string lowerType = type;
       for(unsigned int i=0;i<lowerType.length();++i){
         lowerType[i] = tolower(lowerType[i]);
       }
-      std::map<std::string,SmartPtr<FileGrabberPlugin> >::iterator it = plugins.find(lowerType);
+      PluginMap::iterator it = plugins.find(lowerType);
       if(it == plugins.end()) return 0;
       else return it->second.get();
     }
-    
+
+    static FileGrabberPlugin *find_plugin(const std::string &type){
+      static PluginMap plugins;
+      if(!plugins.size()){
+        create_plugins(plugins);
+      }
+      return find_plugin_in(plugins,type);
+    }
+
+    /// Bounded parallel read-ahead decoder for the FileGrabber
+    /** A fixed ring of slots holds the decoding results for a window
+        of upcoming file indices. A small pool of worker threads decodes
+        pending slots in window order. Each worker uses its own plugin
+        instances and decodes into a private buffer image, that is swapped
+        with the slot image once decoding is finished, so that all images
+        are recycled and the memory is bounded by slots + workers + 1 images.
+        If the window moves (e.g. by frame seeks), slots outside the new window
+        are reused and results of obsolete decoding jobs are dropped. */
+    class FileGrabberReadAhead : public Uncopyable{
+      struct Slot{
+        enum State { Free, Pending, Decoding, Ready, Failed };
+        Slot():fileIndex(-1),order(0),state(Free),image(0),generation(0){}
+        int fileIndex;
+        int order;
+        State state;
+        ImgBase *image;
+        std::string error;
+        int generation;
+      };
+
+      class Worker : public Thread{
+      public:
+        Worker(FileGrabberReadAhead *parent):parent(parent),buffer(0){
+          create_plugins(plugins);
+        }
+        ~Worker(){
+          ICL_DELETE(buffer);
+        }
+        virtual void run(){
+          parent->work(*this);
+        }
+        FileGrabberReadAhead *parent;
+        PluginMap plugins;
+        ImgBase *buffer;
+      };
+
+      FileList files;
+      std::string forcedPluginType;
+      std::vector<Slot> slots;
+      std::vector<Worker*> workers;
+      Mutex mutex;
+      bool stopped;
+
+      /// waiting threads poll their condition in this interval (in microseconds)
+      static const unsigned int POLL_INTERVAL = 200;
+
+      void work(Worker &w){
+        while(true){
+          mutex.lock();
+          Slot *s = 0;
+          while(!stopped && !(s = nextPending())){
+            mutex.unlock();
+            Thread::usleep(POLL_INTERVAL);
+            mutex.lock();
+          }
+          if(stopped){
+            mutex.unlock();
+            return;
+          }
+          s->state = Slot::Decoding;
+          const int generation = s->generation;
+          const std::string filename = files[s->fileIndex];
+          mutex.unlock();
+
+          std::string error;
+          try{
+            File f(filename);
+            if(!f.exists()) throw FileNotFoundException(f.getName());
+            FileGrabberPlugin *p = find_plugin_in(w.plugins, forcedPluginType == "" ? f.getSuffix() : forcedPluginType);
+            if(!p) throw InvalidFileException(str("file type (filename was \"")+f.getName()+"\")");
+            try{
+              p->grab(f,&w.buffer);
+            }catch(ICLException&){
+              if(f.isOpen()) f.close();
+              throw;
+            }
+          }catch(const std::exception &e){
+            error = e.what();
+          }
+
+          Mutex::Locker lock(mutex);
+          if(s->generation == generation){
+            if(error.length()){
+              s->state = Slot::Failed;
+              s->error = error;
+            }else{
+              std::swap(s->image,w.buffer);
+              s->state = Slot::Ready;
+            }
+          }
+        }
+      }
+
+      /// returns the pending slot that comes first in the current window
+      Slot *nextPending(){
+        Slot *best = 0;
+        for(unsigned int i=0;i<slots.size();++i){
+          if(slots[i].state == Slot::Pending && (!best || slots[i].order < best->order)){
+            best = &slots[i];
+          }
+        }
+        return best;
+      }
+
+      Slot *find(int fileIndex){
+        for(unsigned int i=0;i<slots.size();++i){
+          if(slots[i].state != Slot::Free && slots[i].fileIndex == fileIndex) return &slots[i];
+        }
+        return 0;
+      }
+
+      void release(Slot &s){
+        s.state = Slot::Free;
+        s.fileIndex = -1;
+        ++s.generation;
+      }
+
+    public:
+      FileGrabberReadAhead(const FileList &files, const std::string &forcedPluginType, int frames, int threads):
+        files(files),forcedPluginType(forcedPluginType),slots(frames),stopped(false){
+        workers.resize(iclMin(frames,threads));
+        for(unsigned int i=0;i<workers.size();++i){
+          workers[i] = new Worker(this);
+          workers[i]->start();
+        }
+      }
+
+      ~FileGrabberReadAhead(){
+        mutex.lock();
+        stopped = true;
+        mutex.unlock();
+        for(unsigned int i=0;i<workers.size();++i){
+          workers[i]->wait();
+          delete workers[i];
+        }
+        for(unsigned int i=0;i<slots.size();++i){
+          ICL_DELETE(slots[i].image);
+        }
+      }
+
+      int getFrames() const { return slots.size(); }
+
+      int getThreads() const { return workers.size(); }
+
+      /// moves the read-ahead window to [first, first+frames)
+      void schedule(int first, bool loop){
+        const int n = files.size();
+        std::vector<int> window;
+        for(int i=0;i<iclMin((int)slots.size(),n);++i){
+          int idx = first + i;
+          if(idx >= n){
+            if(!loop) break;
+            idx -= n;
+          }
+          window.push_back(idx);
+        }
+        Mutex::Locker lock(mutex);
+        for(unsigned int i=0;i<slots.size();++i){
+          Slot &s = slots[i];
+          if(s.state == Slot::Free) continue;
+          std::vector<int>::iterator it = std::find(window.begin(),window.end(),s.fileIndex);
+          if(it == window.end()){
+            release(s);
+          }else{
+            s.order = (int)(it - window.begin());
+          }
+        }
+        for(unsigned int i=0;i<window.size();++i){
+          if(find(window[i])) continue;
+          for(unsigned int j=0;j<slots.size();++j){
+            Slot &s = slots[j];
+            if(s.state == Slot::Free){
+              s.fileIndex = window[i];
+              s.order = i;
+              s.state = Slot::Pending;
+              break;
+            }
+          }
+        }
+      }
+
+      /// waits for the given file to be decoded and swaps the result into *dst
+      /** The file index must be part of the current window */
+      void fetch(int fileIndex, ImgBase **dst) throw (ICLException){
+        Mutex::Locker lock(mutex);
+        Slot *s = find(fileIndex);
+        while(s && (s->state == Slot::Pending || s->state == Slot::Decoding)){
+          mutex.unlock();
+          Thread::usleep(POLL_INTERVAL);
+          mutex.lock();
+        }
+        if(!s){
+          throw ICLException("FileGrabber: read-ahead slot for file " + str(fileIndex) + " not found");
+        }
+        if(s->state == Slot::Failed){
+          std::string error = s->error;
+          release(*s);
+          throw ICLException(error);
+        }
+        std::swap(s->image,*dst);
+        release(*s);
+      }
+    };
+
     FileGrabber::FileGrabber()
       :  m_data(new Data), m_propertyMutex(utils::Mutex::mutexTypeRecursive), m_updatingProperties(false)
     {
@@ -185,6 +416,9 @@ namespace icl{
       m_data->loop = true;
       m_data->poBufferImage = 0;
       m_data->useTimeStamps = false;
+      m_data->readAhead = 0;
+      m_data->readAheadFrames = 0;
+      m_data->readAheadThreads = 0;
       addProperties();
     }
     
@@ -241,8 +475,10 @@ namespace icl{
       m_data->loop = true;
       m_data->poBufferImage = 0;
       m_data->useTimeStamps = false;
-      
-      
+      m_data->readAhead = 0;
+      m_data->readAheadFrames = 0;
+      m_data->readAheadThreads = 0;
+
       if(buffer){
         bufferImages(false);
       }
@@ -254,6 +490,7 @@ namespace icl{
     FileGrabber::~FileGrabber(){
       // {{{ open
 
+      ICL_DELETE(m_data->readAhead);
       ICL_DELETE(m_data->poBufferImage);
       for(unsigned int i=0;i<m_data->vecImageBuffer.size();i++){
         ICL_DELETE(m_data->vecImageBuffer[i]);
@@ -363,9 +600,22 @@ namespace icl{
       }
 
       ICLASSERT_RETURN_VAL(!m_data->oFileList.isNull(),NULL);
-      File f(m_data->oFileList[m_data->iCurrIdx]);
+
+      // (re-)create or release the read-ahead decoder in the grabbing thread
+      const int raThreads = m_data->readAheadThreads > 0 ? m_data->readAheadThreads : TaskScheduler::getDefaultNumThreads();
+      if(m_data->readAheadFrames <= 0){
+        ICL_DELETE(m_data->readAhead);
+      }else if(!m_data->readAhead || m_data->readAhead->getFrames() != m_data->readAheadFrames
+               || m_data->readAhead->getThreads() != iclMin(m_data->readAheadFrames,raThreads)){
+        ICL_DELETE(m_data->readAhead);
+        m_data->readAhead = new FileGrabberReadAhead(m_data->oFileList, m_data->forcedPluginType,
+                                                     m_data->readAheadFrames, raThreads);
+      }
+
+      const int fileIdx = m_data->iCurrIdx;
+      File f(m_data->oFileList[fileIdx]);
       if(m_data->bAutoNext) ++m_data->iCurrIdx;
-      if(!f.exists()) throw FileNotFoundException(f.getName());
+      if(!m_data->readAhead && !f.exists()) throw FileNotFoundException(f.getName());
       if(m_data->iCurrIdx >= m_data->oFileList.size()){
         if(m_data->loop){
           m_data->iCurrIdx = 0;
@@ -374,17 +624,24 @@ namespace icl{
         }
       }
 
-      FileGrabberPlugin *p = find_plugin(m_data->forcedPluginType == "" ? f.getSuffix() : m_data->forcedPluginType);
-      if(!p){
-        throw InvalidFileException(str("file type (filename was \"")+f.getName()+"\")");
-        return 0;
-      }
+      if(m_data->readAhead){
+        m_data->readAhead->schedule(fileIdx,m_data->loop);
+        m_data->readAhead->fetch(fileIdx,&m_data->poBufferImage);
+        // keep the workers busy with the following files
+        m_data->readAhead->schedule(m_data->iCurrIdx,m_data->loop);
+      }else{
+        FileGrabberPlugin *p = find_plugin(m_data->forcedPluginType == "" ? f.getSuffix() : m_data->forcedPluginType);
+        if(!p){
+          throw InvalidFileException(str("file type (filename was \"")+f.getName()+"\")");
+          return 0;
+        }
 
-      try{
-        p->grab(f,&m_data->poBufferImage);
-      }catch(ICLException&){
-        if(f.isOpen()) f.close();
-        throw;
+        try{
+          p->grab(f,&m_data->poBufferImage);
+        }catch(ICLException&){
+          if(f.isOpen()) f.close();
+          throw;
+        }
       }
 
       if(m_data->useTimeStamps){
@@ -424,6 +681,18 @@ namespace icl{
 
     void FileGrabber::forcePluginType(const std::string &suffix){
       m_data->forcedPluginType = suffix;
+      // the read-ahead decoder is re-created with the new plugin type at the next grab call
+      ICL_DELETE(m_data->readAhead);
+    }
+
+    void FileGrabber::setReadAhead(int frames, int threads){
+      m_data->readAheadFrames = iclMax(0,frames);
+      m_data->readAheadThreads = iclMax(0,threads);
+      setPropertyValue("read-ahead",m_data->readAheadFrames);
+    }
+
+    int FileGrabber::getReadAhead() const{
+      return m_data->readAheadFrames;
     }
 
     void FileGrabber::addProperties(){
@@ -439,6 +708,7 @@ namespace icl{
       addProperty("absolute progress","info","",str(m_data->iCurrIdx+1) + " / " + str(m_data->oFileList.size()),0,"The absolute progress through the files. 'current nunmber/total number'");
       addProperty("auto-next","flag","",m_data->bAutoNext,0,"Whether to automatically grab the next file for every frame");
       addProperty("loop","flag","",m_data->loop,0,"Whether to reset the file counter to zero after reaching the last");
+      addProperty("read-ahead","range:spinbox","[0,64]",m_data->readAheadFrames,0,"Number of upcoming files that are decoded in parallel in the background (0: off)");
       addProperty("file-count","info","",str(m_data->oFileList.size()),0,"Total count of files the grabber will show");
       //addProperty("frame-index","range","[0," + str(m_data->oFileList.size()-1) + "]1",m_data->iCurrIdx,20,"Currently grabbed frame");
       addProperty("frame-index","range:spinbox","[0," + str(m_data->oFileList.size()-1) + "]",m_data->iCurrIdx,20,"Currently grabbed frame");
@@ -463,6 +733,8 @@ namespace icl{
         }
       }else if(prop.name == "jump-to-start"){
         m_data->iCurrIdx = 0;
+      }else if(prop.name == "read-ahead"){
+        m_data->readAheadFrames = parse<int>(prop.value);
       }else if(prop.name == "auto-next"){
         m_data->bAutoNext = parse<bool>(prop.value);
       }else if(prop.name ==  "frame-index"){
@@ -157,6 +157,27 @@ namespace icl{
       */
         void forcePluginType(const std::string &suffix);
 
+        /// enables parallel read-ahead decoding of the next frames files
+        /** If frames is > 0, the following frames files (in grabbing order)
+            are decoded in the background by a pool of worker threads, while
+            grab() only has to pick up the already decoded result. The frame
+            order is kept, decoded images are recycled and the memory usage is
+            bounded by frames + threads + 1 images. If the frame index is changed
+            (e.g. using the "frame-index" or "next" property), pending results are
+            dropped and decoding restarts at the new index. Read-ahead is not used
+            if images were pre-buffered (see bufferImages).
+            Read ahead can also be set via the "read-ahead" property (e.g.
+            -input file 'images/ *.jpg'\@read-ahead=8 for GenericGrabber based
+            applications).
+            @param frames number of files that are decoded ahead (0 disables read-ahead)
+            @param threads number of decoder threads (0: ICL_NUM_THREADS or number of cores),
+                           at most frames threads are used
+        */
+        void setReadAhead(int frames, int threads=0);
+
+        /// returns the number of read-ahead frames (0 if read-ahead is disabled)
+        int getReadAhead() const;
+
       private:
         /// grab implementation called bz acquireImage().
         const core::ImgBase *grabImage();
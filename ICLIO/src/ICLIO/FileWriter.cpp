@@ -35,6 +35,7 @@
 #include <ICLIO/FileWriterPluginPNM.h> 
 #include <ICLIO/FileWriterPluginCSV.h> 
 #include <ICLIO/FileWriterPluginBICL.h> 
+#include <ICLIO/FileWriterPluginBICLStream.h>
 #ifdef ICL_HAVE_LIBJPEG
 #include <ICLIO/FileWriterPluginJPEG.h> 
 #endif
@@ -70,6 +71,7 @@ namespace icl{
         FileWriter::s_mapPlugins[".rle4"] = new FileWriterPluginBICL("rlen","4");
         FileWriter::s_mapPlugins[".rle6"] = new FileWriterPluginBICL("rlen","6");
         FileWriter::s_mapPlugins[".rle8"] = new FileWriterPluginBICL("rlen","8");
+        FileWriter::s_mapPlugins[".bicls"] = new FileWriterPluginBICLStream;
   
         
   
@@ -93,6 +95,7 @@ namespace icl{
         FileWriter::s_mapPlugins[".rle4.gz"] = new FileWriterPluginBICL("rlen","4");
         FileWriter::s_mapPlugins[".rle6.gz"] = new FileWriterPluginBICL("rlen","6");
         FileWriter::s_mapPlugins[".rle8.gz"] = new FileWriterPluginBICL("rlen","8");
+        FileWriter::s_mapPlugins[".zicl"] = new FileWriterPluginBICL("zlib","1");
   
   #endif
   
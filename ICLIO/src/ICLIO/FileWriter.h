@@ -76,6 +76,9 @@ namespace icl{
           as rle1
         - <b>jicl</b> only supported with jpeg support, like bicl, but with jpeg compressed
           image data (jpeg compression is set to 70%, does also support saving meta data).
+        - <b>zicl</b> only supported with zlib support, like bicl, but with lossless
+          compressed image data (see ImageCompressor's "zlib" mode). This is the best
+          choice for depth images and other non-Img8u images
   
         
         \section ZLIB Z-Lib support
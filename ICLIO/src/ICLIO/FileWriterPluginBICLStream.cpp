@@ -0,0 +1,62 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/FileWriterPluginBICLStream.cpp         **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/FileWriterPluginBICLStream.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+    FileWriterPluginBICLStream::FileWriterPluginBICLStream(const std::string &compressionType,
+                                                           const std::string &quality):
+      spec(compressionType,quality){}
+
+    FileWriterPluginBICLStream::~FileWriterPluginBICLStream(){
+      Mutex::Locker lock(mutex);
+      writers.clear();
+    }
+
+    void FileWriterPluginBICLStream::write(File &file, const ImgBase *image){
+      Mutex::Locker lock(mutex);
+      SmartPtr<BICLStreamWriter> &w = writers[file.getName()];
+      if(!w){
+        w = new BICLStreamWriter(file.getName(), spec, true);
+      }
+      w->write(image);
+    }
+
+    void FileWriterPluginBICLStream::close(const std::string &filename){
+      Mutex::Locker lock(mutex);
+      writers.erase(filename);
+    }
+
+  } // namespace io
+}
@@ -0,0 +1,70 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/FileWriterPluginBICLStream.h           **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Mutex.h>
+#include <ICLUtils/SmartPtr.h>
+#include <ICLIO/FileWriterPlugin.h>
+#include <ICLIO/BICLStream.h>
+#include <map>
+
+namespace icl{
+  namespace io{
+
+    /// Writer plugin to append images to indexed multi-frame containers (extension bicls)
+    /** For each filename, a BICLStreamWriter is opened at the first write call and
+        all further images that are written to the same filename are appended.
+        Usually, the FileWriter is therefore used with a file pattern without hashes
+        (e.g. FileWriter("recording.bicls")). The containers are finalized when
+        the plugin is destroyed (i.e. at program exit) or when close() is called.  */
+    class ICLIO_API FileWriterPluginBICLStream : public FileWriterPlugin{
+      public:
+
+      FileWriterPluginBICLStream(const std::string &compressionType="none",
+                                 const std::string &quality="none");
+
+      /// Destructor (finalizes all containers)
+      ~FileWriterPluginBICLStream();
+
+      /// write implementation
+      virtual void write(utils::File &file, const core::ImgBase *image);
+
+      /// finalizes the container with the given filename
+      void close(const std::string &filename);
+
+      private:
+      ImageCompressor::CompressionSpec spec;
+      std::map<std::string,utils::SmartPtr<BICLStreamWriter> > writers;
+      utils::Mutex mutex;
+    };
+  } // namespace io
+}
@@ -30,6 +30,7 @@
 
 #include <set>
 #include <ICLIO/GenericGrabber.h>
+#include <ICLIO/AsyncGrabber.h>
 #include <ICLUtils/StringUtils.h>
 #include <ICLUtils/Exception.h>
 #include <ICLUtils/TextTable.h>
@@ -120,6 +121,7 @@ namespace icl{
 
 
     GenericGrabber::~GenericGrabber(){
+      ICL_DELETE(m_async);
       if(m_poGrabber){
         GrabberInstanceTable::get() -> deleteGrabber(m_poDesc);
       }
@@ -134,6 +136,10 @@ namespace icl{
       init(*pa,(*pa) + "=" + *utils::pa(pa.getID(),1));
     }
 
+    const ImgBase *GenericGrabber::grabAsync(ImgBase **dst){
+      return m_async->grab(dst);
+    }
+
     struct SpecifiedDevice{
         std::string type;
         std::string id;
@@ -196,6 +202,7 @@ namespace icl{
       GrabberRegister *grabberReg = GrabberRegister::getInstance();
 
       // (re)set GenericGrabber to default values
+      ICL_DELETE(m_async);
       if(m_poGrabber){
         // delete old grabber
         GrabberInstanceTable::get()->deleteGrabber(m_poDesc);
@@ -282,16 +289,23 @@ namespace icl{
         setInternalConfigurable(m_poGrabber);
 
         const std::vector<std::string> &options = pmap[m_poDesc.type].options;
+        int asyncQueueSize = 0;
+        AsyncGrabber::QueuePolicy asyncPolicy = AsyncGrabber::dropOldest;
         // setting extra properties ...
         for(unsigned int i=0;i<options.size();++i){
           std::pair<std::string,std::string> p = split_at_first('=',options[i]);
           if(p.second.length()) p.second = p.second.substr(1);
-          if(p.first == "load"){
+          if(p.first == "async"){
+            asyncQueueSize = p.second.length() ? parse<int>(p.second) : 3;
+          }else if(p.first == "async-policy"){
+            asyncPolicy = AsyncGrabber::policyFromString(p.second);
+            if(!asyncQueueSize) asyncQueueSize = 3;
+          }else if(p.first == "load"){
             m_poGrabber->loadProperties(p.second);
           }else if(p.first == "info"){
             std::cout << "Property list for " << m_poDesc << std::endl;
             std::vector<std::string> ps = m_poGrabber->getPropertyList();
-            TextTable t(4,ps.size()+4,35);
+            TextTable t(4,ps.size()+6,35);
             t[0] = tok("property,type,allowed values,current value",",");
             for(unsigned int j=0;j<ps.size();++j){
               const std::string &p2 = ps[j];
@@ -329,6 +343,16 @@ namespace icl{
             t(2,ps.size()+3) = str("RSB-scope of server to connect to remotely ") + helpText;
             t(3,ps.size()+3) = str("-");
 
+            t(0,ps.size()+4) = str("async");
+            t(1,ps.size()+4) = str("special");
+            t(2,ps.size()+4) = str("grab asynchronously into a queue of the given size (default 3)");
+            t(3,ps.size()+4) = str("-");
+
+            t(0,ps.size()+5) = str("async-policy");
+            t(1,ps.size()+5) = str("special");
+            t(2,ps.size()+5) = str("queue policy for async: drop-oldest, block or latest");
+            t(3,ps.size()+5) = str("drop-oldest");
+
             std::cout << t << std::endl;
             std::terminate();
           }else if(p.first == "udist"){
@@ -353,6 +377,10 @@ namespace icl{
             m_poGrabber->setPropertyValue(p.first,p.second);
           }
         }
+        // the backend thread is started once all other options were applied
+        if(asyncQueueSize > 0){
+          m_async = new AsyncGrabber(m_poGrabber,asyncQueueSize,asyncPolicy);
+        }
       }
     }
 
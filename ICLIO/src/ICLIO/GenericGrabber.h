@@ -43,6 +43,7 @@ namespace icl {
 
     /** \cond */
     class ConfigurableRemoteServer;
+    class AsyncGrabber;
     /** \endcond */
     
     /// Common interface class for all grabbers \ingroup GRABBER_G
@@ -62,12 +63,17 @@ namespace icl {
 
         ConfigurableRemoteServer *m_remoteServer;
 
+        AsyncGrabber *m_async; //!< optional asynchronous prefetching wrapper
+
+        /// grabs from the asynchronous wrapper (AsyncGrabber is only forward declared here)
+        const core::ImgBase *grabAsync(core::ImgBase **dst);
+
       public:
         using utils::ConfigurableProxy::registerCallback;
         
         /// Initialized the grabber from given prog-arg
         /** The progarg needs two sub-parameters */
-        GenericGrabber(const utils::ProgArg &pa) throw (utils::ICLException):m_poGrabber(0),m_remoteServer(0){
+        GenericGrabber(const utils::ProgArg &pa) throw (utils::ICLException):m_poGrabber(0),m_remoteServer(0),m_async(0){
           init(pa);
         }
 
@@ -75,14 +81,14 @@ namespace icl {
         /** internally this function calls the init function immediately*/
         GenericGrabber(const std::string &devicePriorityList,
                        const std::string &params,
-                       bool notifyErrors = true) throw (utils::ICLException):m_poGrabber(0),m_remoteServer(0){
+                       bool notifyErrors = true) throw (utils::ICLException):m_poGrabber(0),m_remoteServer(0),m_async(0){
           init(devicePriorityList,params,notifyErrors);
         }
 
 
         /// Empty default constructor, which creates a null-instance
         /** null instances of grabbers can be adapted using the init-function*/
-      GenericGrabber():m_poGrabber(0),m_remoteServer(0){}
+      GenericGrabber():m_poGrabber(0),m_remoteServer(0),m_async(0){}
 
         /// initialization function to change/initialize the grabber back-end
         /** @param devicePriorityList Comma separated list of device tokens (no white spaces).
@@ -101,6 +107,7 @@ namespace icl {
                                     - <b>cvcam</b> OpenCV based camera grabber (supporting video 4 linux devices)
                                     - <b>cvvideo</b> OpenCV based video grabber
                                     - <b>sm</b> Qt-based Shared-Memory grabber (using QSharedMemoryInstance)
+                                    - <b>smr</b> lock-free shared memory ring buffer grabber (see SharedMemoryRingGrabber)
                                     - <b>myr</b> Uses Myrmex tactile input device as image source
                                     - <b>kinectd</b> Uses libfreenect to grab Microsoft-Kinect's core::depth images
                                     - <b>kinectc</b> Uses libfreenect to grab Microsoft-Kinect's rgb color images
@@ -118,7 +125,9 @@ namespace icl {
                                     are set immediately after grabber instantiation. By these means particularly a
                                     grabber's core::format can be set in the grabber instantiation call. Furthermore, three
                                     special \@-tokens are possible: \@info (e.g. dc=0\@info) lists the 0th dc device's
-                                    available properties. \@load=filename loads a given property filename directly.
+                                    available properties. \@async=N grabs asynchronously in a backend thread into a
+                                    queue of N prefetched images (see icl::io::AsyncGrabber), the queue policy can be
+                                    set using \@async-policy=drop-oldest|block|latest (drop-oldest by default). \@load=filename loads a given property filename directly.
             \@udist=filename loads a given undistortion parameter filename directly and therefore
                                     makes the grabber grab undistorted images according to the undistortion parameters
                                     and model type (either 3 or 5 parameters) that is found in the given xml-file.
@@ -159,6 +168,7 @@ namespace icl {
                                       (e.g. device ID 301 selects the 2nd firewire device)
                                     - cvvideo=video-filename (string)
                                     - sm=Shared-memory-segment-id (string)
+                                    - smr=ring-name (string)
                                     - myr=deviceIndex (int) (the device index is used to create the /dev/videoX device)
                                     - kinectd=device-index (int)
                                     - kinectc=device-index (int)
@@ -199,7 +209,13 @@ namespace icl {
           utils::Mutex::Locker __lock(m_mutex);
           ICLASSERT_RETURN_VAL(!isNull(), 0);
 
-          return m_poGrabber->grab(dst);
+          return m_async ? grabAsync(dst) : m_poGrabber->grab(dst);
+        }
+
+        /// returns the asynchronous prefetching wrapper (or 0 if \@async was not given)
+        AsyncGrabber *getAsyncGrabber() const {
+          utils::Mutex::Locker __lock(m_mutex);
+          return m_async;
         }
 
         /// returns wheter an underlying grabber could be created
@@ -213,6 +229,7 @@ namespace icl {
         void setDesiredFormatInternal(core::format fmt){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->setDesiredFormatInternal(fmt);
         }
 
@@ -220,6 +237,7 @@ namespace icl {
         void setDesiredSizeInternal(const utils::Size &size){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->setDesiredSizeInternal(size);
         }
 
@@ -227,6 +245,7 @@ namespace icl {
         void setDesiredDepthInternal(core::depth d){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->setDesiredDepthInternal(d);
         }
 
@@ -234,6 +253,7 @@ namespace icl {
         core::format getDesiredFormatInternal() const{
           ICLASSERT_RETURN_VAL(!isNull(),(core::format)-1);
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           return m_poGrabber->getDesiredFormatInternal();
         }
 
@@ -241,6 +261,7 @@ namespace icl {
         core::depth getDesiredDepthInternal() const{
           ICLASSERT_RETURN_VAL(!isNull(),(core::depth)-1);
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           return m_poGrabber->getDesiredDepthInternal();
         }
 
@@ -248,6 +269,7 @@ namespace icl {
         utils::Size getDesiredSizeInternal() const{
           ICLASSERT_RETURN_VAL(!isNull(),utils::Size::null);
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           return m_poGrabber->getDesiredSizeInternal();
         }
 
@@ -255,6 +277,7 @@ namespace icl {
         void registerCallback(Grabber::callback cb){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->registerCallback(cb);
         }
 
@@ -262,6 +285,7 @@ namespace icl {
         void removeAllCallbacks(){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->removeAllCallbacks();
         }
 
@@ -271,6 +295,7 @@ namespace icl {
         bool desiredUsed() const{
           ICLASSERT_RETURN_VAL(!isNull(),false);
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           return m_poGrabber->desiredUsed<T>();
         }
 
@@ -279,6 +304,7 @@ namespace icl {
         void useDesired(const T &t){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->useDesired<T>(t);
         }
 
@@ -286,6 +312,7 @@ namespace icl {
         void useDesired(core::depth d, const utils::Size &size, core::format fmt){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->useDesired(d, size, fmt);
         }
 
@@ -295,6 +322,7 @@ namespace icl {
         void ignoreDesired() {
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->ignoreDesired<T>();
         }
 
@@ -302,6 +330,7 @@ namespace icl {
         void ignoreDesired(){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->ignoreDesired();
         }
 
@@ -311,6 +340,7 @@ namespace icl {
         T getDesired() const {
           ICLASSERT_RETURN_VAL(!isNull(), T());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           return m_poGrabber->getDesired<T>();
         }
 
@@ -318,6 +348,7 @@ namespace icl {
         void enableUndistortion(const std::string &filename){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->enableUndistortion(filename);
         }
 
@@ -325,6 +356,7 @@ namespace icl {
         void enableUndistortion(const ImageUndistortion &udist){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->enableUndistortion(udist);
         }
 
@@ -333,6 +365,7 @@ namespace icl {
         void enableUndistortion(const utils::ProgArg &pa){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->enableUndistortion(pa);
         }
 
@@ -340,6 +373,7 @@ namespace icl {
         void enableUndistortion(const core::Img32f &warpMap){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->enableUndistortion(warpMap);
         }
 
@@ -350,6 +384,7 @@ namespace icl {
         void setUndistortionInterpolationMode(core::scalemode mode){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->setUndistortionInterpolationMode(mode);
         }
 
@@ -357,6 +392,7 @@ namespace icl {
         void disableUndistortion(){
           ICLASSERT_RETURN(!isNull());
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           m_poGrabber->disableUndistortion();
         }
 
@@ -364,6 +400,7 @@ namespace icl {
         bool isUndistortionEnabled() const{
           ICLASSERT_RETURN_VAL(!isNull(),false);
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           return m_poGrabber->isUndistortionEnabled();
         }
 
@@ -371,6 +408,7 @@ namespace icl {
         const core::Img32f *getUndistortionWarpMap() const{
           ICLASSERT_RETURN_VAL(!isNull(),0);
           utils::Mutex::Locker l(m_mutex);
+          Grabber::AccessLocker a(m_poGrabber);
           return m_poGrabber->getUndistortionWarpMap();
         }
 
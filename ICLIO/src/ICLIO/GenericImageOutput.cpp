@@ -56,6 +56,10 @@
 #include <ICLIO/V4L2LoopBackOutput.h>
 #endif
 
+#ifndef ICL_SYSTEM_WINDOWS
+#include <ICLIO/SharedMemoryRingPublisher.h>
+#endif
+
 #include <ICLIO/FileWriter.h>
 
 #include <ICLUtils/StringUtils.h>
@@ -160,6 +164,21 @@ namespace icl{
         o = new SharedMemoryPublisher(d);
       }
   #endif
+
+  #ifndef ICL_SYSTEM_WINDOWS
+      plugins.push_back("smr~ring name[:number of slots]~lock-free shared memory ring buffer");
+
+      if(type == "smr"){
+        std::vector<std::string> ts = tok(d,":");
+        if(ts.size() == 1){
+          o = new SharedMemoryRingPublisher(ts[0]);
+        }else if(ts.size() == 2){
+          o = new SharedMemoryRingPublisher(ts[0],parse<int>(ts[1]));
+        }else{
+          throw ICLException("invalid definition string (expected: ring-name[:number-of-slots])");
+        }
+      }
+  #endif
       
   #if defined(ICL_HAVE_RSB) && defined(ICL_HAVE_PROTOBUF)
       plugins.push_back("rsb~[transport:]/scope~Network output stream");
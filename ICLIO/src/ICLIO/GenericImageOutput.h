@@ -49,6 +49,7 @@ namespace icl{
           - "file" (description=filepattern)
           - "video" (description=output-video-filename,CODEC-FOURCCC=DIV3,VideoSize=VGA,FPS=24)
           - "sm" (SharedMemory output, description=memory-segment-ID)
+          - "smr" (lock-free shared memory ring buffer, description=ring-name[:number-of-slots])
           - "xcfp" (XCF Publisher output, description=stream-name)
           - "rsb" (Robotics Service Bus Output), description=[comma-sep. transport-list=spread]:scope)
           - "udp" QUdpSocket-based udp transfer, description=host:port
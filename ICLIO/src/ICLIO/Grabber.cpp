@@ -60,6 +60,9 @@ namespace icl{
             
       Mutex callbackMutex;
       std::vector<Grabber::callback> callbacks;
+
+      /// set by an attached AsyncGrabber (0 otherwise)
+      Mutex *accessMutex;
     };
 
     
@@ -75,6 +78,7 @@ namespace icl{
       data->undistortionEnabled = true;
       data->undistortionInterpolationMode = interpolateNN;
       data->undistortionUseOpenCL = false;
+      data->accessMutex = 0;
     }
 
     Grabber::~Grabber() {
@@ -164,6 +168,27 @@ namespace icl{
       return translate_any_string<std::string>(v);
     }
 
+    void Grabber::setAccessMutex(Mutex *mutex){
+      data->accessMutex = mutex;
+    }
+
+    Grabber::AccessLocker::AccessLocker(const Grabber *grabber):m(grabber->data->accessMutex){
+      if(m) m->lock();
+    }
+
+    Grabber::AccessLocker::~AccessLocker(){
+      if(m) m->unlock();
+    }
+
+    void Grabber::setPropertyValue(const std::string &propertyName, const Any &value) throw (ICLException){
+      AccessLocker lock(this);
+      setPropertyValueInternal(propertyName, value);
+    }
+
+    void Grabber::setPropertyValueInternal(const std::string &propertyName, const Any &value) throw (ICLException){
+      Configurable::setPropertyValue(propertyName, value);
+    }
+
     const ImgBase *Grabber::grab(ImgBase **ppoDst){
       const ImgBase *acquired = acquireImage();
       if(!acquired) return acquired;
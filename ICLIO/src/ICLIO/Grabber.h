@@ -157,6 +157,9 @@ namespace icl {
         /// hidden data
         Data *data;
 
+        /// sets the mutex that is locked by AccessLocker instances (used by the AsyncGrabber)
+        void setAccessMutex(utils::Mutex *mutex);
+
       protected:
         /// internally set a desired format
         virtual void setDesiredFormatInternal(core::format fmt);
@@ -176,6 +179,13 @@ namespace icl {
         /// returns the desired format
         virtual utils::Size getDesiredSizeInternal() const;
 
+        /// internally sets a property value (called by setPropertyValue with the access mutex locked)
+        /** Grabber implementations that need to handle property changes directly
+            must override this method rather than setPropertyValue. The default
+            implementation calls Configurable::setPropertyValue */
+        virtual void setPropertyValueInternal(const std::string &propertyName,
+                                              const utils::Any &value) throw (utils::ICLException);
+
       public:
 
         /// grant private method access to the grabber handle template
@@ -184,6 +194,9 @@ namespace icl {
         /// grant private method access to the GenericGrabber class
         friend class GenericGrabber;
 
+        /// grant access to the access mutex (see AccessLocker)
+        friend class AsyncGrabber;
+
         ///
         Grabber();
 
@@ -275,6 +288,30 @@ namespace icl {
         const core::Img32f *getUndistortionWarpMap() const;
         /// @}
 
+        /// sets a property value
+        /** If an AsyncGrabber is attached, the property change is serialized
+            with the AsyncGrabber's backend thread (see AccessLocker). This method
+            must not be overridden, use setPropertyValueInternal instead */
+        virtual void setPropertyValue(const std::string &propertyName,
+                                      const utils::Any &value) throw (utils::ICLException);
+
+        /// Scoped lock that serializes grabber accesses with the backend thread of an attached AsyncGrabber
+        /** While an AsyncGrabber is attached to a grabber, Grabber::grab is called from
+            the AsyncGrabber's backend thread. Accesses from other threads, that change the
+            grabber state (desired parameters, undistortion or device settings), must hold an
+            AccessLocker. If no AsyncGrabber is attached, the AccessLocker does nothing.
+            Property changes via setPropertyValue and all GenericGrabber methods are
+            serialized automatically. */
+        class ICLIO_API AccessLocker : public utils::Uncopyable{
+          utils::Mutex *m;
+          public:
+          /// locks the given grabber's access mutex (if an AsyncGrabber is attached)
+          AccessLocker(const Grabber *grabber);
+
+          /// unlocks the access mutex
+          ~AccessLocker();
+        };
+
         /// new image callback type
         typedef utils::Function<void,const core::ImgBase*> callback;
 
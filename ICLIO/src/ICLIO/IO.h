@@ -168,6 +168,10 @@
     # set several options at once
     icl-camviewer -input kinectc '0\@LED=green\@core::format=IR Image (10Bit)'
 
+    # grab images asynchronously: a backend thread prefetches up to 4 images while the
+    # application processes the last one (see icl::io::AsyncGrabber for queue policies)
+    icl-camviewer -input file 'images/*.ppm'\@async=4\@async-policy=block
+
     # enable image undistortion according to undistortion parameters stored in an appropriate** xml file.
     icl-camviewer -input dc 0\@udist=my-udist-properties.xml
     
@@ -195,6 +199,11 @@
     
     # now, the images can be read online from the shared memory
     icl-camviewer -input sm my-segment
+
+    # the same using a lock-free ring buffer with 8 slots: the publisher never waits
+    # for the readers, and readers can grab frames without copying them
+    icl-pipe -input dc 0 -o smr my-ring:8
+    icl-camviewer -input smr my-ring@zero-copy=on
     
     # capture a video using an opencv based video writer (here, with DIVX code, VGA-resolution
     # and playback speed of 24 frames per second (note, not all combinations of codecs, resolutions
@@ -32,13 +32,19 @@
 #include <ICLIO/Kinect11BitCompressor.h>
 #include <ICLFilter/DitheringOp.h>
 #include <stdint.h>
+#include <cstring>
 #ifdef ICL_HAVE_LIBJPEG
 #include <ICLIO/JPEGEncoder.h>
 #include <ICLIO/JPEGDecoder.h>
 #endif
+#ifdef ICL_HAVE_LIBZ
+#include <zlib.h>
+#endif
 //#include <ICLCV/RegionDetectorTools.h>
 #include <ICLUtils/File.h>
 #include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/SSETypes.h>
 
 using namespace icl::utils;
 using namespace icl::core;
@@ -46,142 +52,97 @@ using namespace icl::filter;
 
 namespace icl{
   namespace io{
-  
-    struct ImageCompressor::Data{
-      Img8u ditheringBuffer;
-      std::vector<icl8u> encoded_buffer;
-      ImgBase *decoded_buffer;
-      ImageCompressor::CompressionSpec compression;
-      
-  #ifdef ICL_HAVE_LIBJPEG
-      SmartPtr<JPEGEncoder> jpegEncoder;
-  #endif
-  
-    };
-  
-    ImageCompressor::ImageCompressor(const ImageCompressor::CompressionSpec &spec):m_data(new Data){
-      m_data->decoded_buffer = 0;
-      setCompression(spec);
-    }
-  
-    ImageCompressor::~ImageCompressor(){
-      ICL_DELETE(m_data->decoded_buffer);
-      delete m_data;
-    }
-    
-    /// only decodes an image header
-    ImageCompressor::Header ImageCompressor::uncompressHeader(const icl8u *data,int len){
-      ICLASSERT_THROW(len > (int)sizeof(Header::Params), ICLException("ImageCompressor::uncompressHeader: data length too small"));
-      Header header;
-      header.params = *(reinterpret_cast<const Header::Params*>(data));
-      header.data = data;
-      return header;
-    }
-  
-    /// internal utlity function
-    int ImageCompressor::estimateRawDataSize(const ImgBase *image, bool skipMetaData){
-      return (image->getChannels() * image->getDim() * getSizeOf(image->getDepth()) +
-              (skipMetaData ? 0 : image->getMetaData().length()) + sizeof(ImgParams) +
-              sizeof(depth) + sizeof(Time) );
-    }
-  
-    int ImageCompressor::estimateEncodedBufferSize(const ImgBase *image, bool skipMetaData){
-      const int metaDataLength = skipMetaData ? 0 : (int)image->getMetaData().length();
-      const int headerSize = sizeof(Header::Params) + metaDataLength;
-      const int numPix = image->getDim() * image->getChannels() * getSizeOf(image->getDepth());
-      if(m_data->compression.mode == "rlen" && m_data->compression.quality == "8"){
-        return headerSize + 2*numPix;
-      }else{
-        return headerSize + numPix;
+
+    namespace{
+      /// minimum number of pixels of a run-length encoded strip
+      static const int RLE_STRIP_MIN_PIXELS = 1<<16;
+
+      /// minimum number of pixels of a JPEG strip (each strip gets its own JPEG header)
+      static const int JPEG_STRIP_MIN_PIXELS = 1<<18;
+
+      /// header of a single strip of strip-based compressed data
+      struct StripHeader{
+        icl32s channel; //!< channel index (-1 if the strip contains all channels)
+        icl32s y;       //!< first image row
+        icl32s height;  //!< number of image rows
+        icl32s len;     //!< length of the strip's data (following the strip header)
+      };
+
+      /// reads a strip header (strips are not necessarily aligned within the compressed data)
+      inline StripHeader read_strip_header(const icl8u *p){
+        StripHeader h;
+        std::memcpy(&h,p,sizeof(StripHeader));
+        return h;
       }
-    }
-  
-    static const icl8u *find_first_not_binarized(const icl8u *curr, const icl8u *end, icl8u val){
-      if(val){
-        for(;curr<end;++curr){
-          if(*curr < 127) return curr;
-        }
-      }else{
-        for(;curr<end;++curr){
-          if(*curr >= 127) return curr;
+
+      /// writes a strip header to the given (possibly unaligned) address
+      inline void write_strip_header(icl8u *p, const StripHeader &h){
+        std::memcpy(p,&h,sizeof(StripHeader));
+      }
+
+      /// number of pixels that are packed/unpacked at once in "1611" mode
+      /** 16 11-bit values fill exactly 11 16-bit words, so blocks can be processed independently */
+      static const int PACK_1611_BLOCK_PIXELS = 1<<16;
+
+      /// returns whether the given compression mode uses strip-based encoding
+      inline bool is_strip_mode(const std::string &mode){
+        return mode == "rlen" || mode == "dith" || mode == "jpeg" || mode == "zlib";
+      }
+
+      /// returns the number of image rows per strip
+      /** The height is a multiple of 16 in order to keep JPEG MCUs intact */
+      inline int get_strip_height(const Size &size, int minPixels){
+        if(!size.width || !size.height) return 1;
+        int h = (minPixels + size.width - 1) / size.width;
+        h = ((h + 15) / 16) * 16;
+        return iclMax(1,iclMin(h,size.height));
+      }
+
+      static const icl8u *find_first_not_binarized(const icl8u *curr, const icl8u *end, icl8u val){
+        if(val){
+          for(;curr<end;++curr){
+            if(*curr < 127) return curr;
+          }
+        }else{
+          for(;curr<end;++curr){
+            if(*curr >= 127) return curr;
+          }
         }
+        return end;
       }
-      return end;
-    }
-  
-    static icl8u *compressChannel(const icl8u *imageData, 
-                                  icl8u *compressedData, 
-                                  const Size &imageSize, 
-                                  const Rect &roi, 
-                                  const ImageCompressor::CompressionSpec &spec,
-                                  Img8u &ditheringBuffer){
-      if(spec.mode == "none"){
-        std::copy(imageData,imageData+imageSize.getDim(), compressedData);
-        compressedData += imageSize.getDim();
-      }else if(spec.mode == "dith"){
-        DitheringOp op;
-        op.setLevels(round(pow(2,parse<int>(spec.quality))));
-        Img8u tmp(imageSize, formatGray, std::vector<icl8u*>(1,(icl8u*)imageData), false);
-        op.apply(&tmp,bpp(ditheringBuffer));
-        return compressChannel(ditheringBuffer.begin(0), compressedData, imageSize, roi,
-                               ImageCompressor::CompressionSpec("rlen",spec.quality),
-                               ditheringBuffer);
-      }else if(spec.mode == "rlen"){
-        switch(parse<int>(spec.quality)){
+
+      /// run-length encodes n pixels using the given quality (returns the end of the compressed data)
+      icl8u *rle_encode(const icl8u *imageData, int n, icl8u *compressedData, int quality){
+        const icl8u *imageDataEnd = imageData+n;
+        if(!n) return compressedData;
+        switch(quality){
           case 1:{
-            const icl8u *imageDataEnd = imageData+imageSize.getDim();
             icl8u currVal = !!*imageData;
-            int allLen = 0;
             while(imageData < imageDataEnd){
               const icl8u *other = find_first_not_binarized(imageData,imageDataEnd,currVal); 
               size_t len = (size_t)(other-imageData);
               while(len >= 128){
                 *compressedData++ = 0xff >> int(!currVal);
                 len -= 128;
-                allLen += 128;
               }
               if(len){
                 *compressedData++ = (len-1) | (currVal << 7);
-                allLen += len;
               }
               currVal = !currVal;
               imageData = other;
             }
             break;
           }
-          case 4:{
-            const icl8u *imageDataEnd = imageData+imageSize.getDim();
-            
-            int currVal = *imageData & 0xf0; // use most significant 4 bits
-            int currLen = 0;
-            while(imageData < imageDataEnd){
-              while( (imageData < imageDataEnd) && ((*imageData & 0xf0) == currVal) ){
-                ++currLen;
-                ++imageData;
-              }
-              while(currLen >= 16){
-                *compressedData++ = currVal | 0xf;
-                currLen -= 16;
-              }
-              if(currLen){
-                *compressedData++ = currVal | (currLen-1);
-              }
-              
-              currVal = *imageData & 0xf0;
-              currLen = 0;
-            }
-            break;
-          }
+          case 4:
           case 6:{
-            const icl8u *imageDataEnd = imageData+imageSize.getDim();
-            static const int VAL_MASK=0xFC;
-            static const int LEN_MASK=0x3;
-            static const int MAX_LEN=4;
-            
-            int currVal = *imageData & VAL_MASK; // use most significant 6 bits
-            int currLen = 0;
+            const int VAL_MASK = quality == 4 ? 0xF0 : 0xFC;
+            const int LEN_MASK = quality == 4 ? 0xF : 0x3;
+            const int MAX_LEN = LEN_MASK+1;
             
             while(imageData < imageDataEnd){
+              // use the most significant 4 or 6 bits
+              const int currVal = *imageData & VAL_MASK;
+              int currLen = 0;
               while( (imageData < imageDataEnd) && ((*imageData & VAL_MASK) == currVal) ){
                 ++currLen;
                 ++imageData;
@@ -193,24 +154,18 @@ namespace icl{
               if(currLen){
                 *compressedData++ = currVal | (currLen-1);
               }
-              
-              currVal = *imageData & VAL_MASK;
-              currLen = 0;
             }
             break;
           }
           case 8:{
             static const int MAX_LEN=256;
-            const icl8u *imageDataEnd = imageData+imageSize.getDim();
-            int currVal = *imageData;
-            int currLen = 0;
-            // std::cout << "################" << std::endl;
             while(imageData < imageDataEnd){
+              const int currVal = *imageData;
+              int currLen = 0;
               while( (imageData < imageDataEnd) && (*imageData == currVal) ){
                 ++currLen;
                 ++imageData;
               }
-              //std::cout << currLen << " x" << currVal << " | " <<std::flush;
               while(currLen >= MAX_LEN){
                 *compressedData++ = currVal;
                 *compressedData++ = MAX_LEN-1;
@@ -220,87 +175,414 @@ namespace icl{
                 *compressedData++ = currVal;
                 *compressedData++ = currLen-1;
               }
-              currVal = *imageData;
-              currLen = 0;
             }
             break;        
           }
-          default: throw ICLException("ImageCompressor::compressChannel: unsupported RLE compression quality (" + spec.quality + ")");
-				}
-      }else{
-        throw ICLException("ImageCompressor::compressChannel: unsupported compression mode (" + spec.mode + ")");
+          default: 
+            throw ICLException("ImageCompressor::compress: unsupported RLE compression quality (" + str(quality) + ")");
+        }
+        return compressedData;
       }
-      return compressedData;
-    }
-  
-    static const icl8u *uncompressChannel(icl8u *imageData, 
-                                          int imageDataLen, 
-                                          const icl8u *compressedData, 
-                                          const ImageCompressor::CompressionSpec &spec){
-      if(spec.mode == "none"){
-        std::copy(compressedData,compressedData+imageDataLen,imageData);
-        compressedData += imageDataLen;
-      }else if(spec.mode == "rlen" || spec.mode == "dith"){
-        switch(parse<int>(spec.quality)){
-          case 1:{
-            icl8u *pc = imageData;
-            icl8u *pcEnd = imageData + imageDataLen;
-            const icl8u *p = compressedData;
-            
+
+      /// throws an exception if the given compressed data position is not valid
+      inline void check_rle_data(const icl8u *p, const icl8u *end){
+        if(p >= end) throw ICLException("ImageCompressor::uncompress: truncated run-length encoded data");
+      }
+
+      /// decodes n run-length encoded pixels (returns the end of the consumed compressed data)
+      /** The compressed data is read from [compressedData,compressedEnd). Runs are clipped
+          at the end of the destination pixels, so corrupt data can never lead to writing more
+          than n pixels. If the compressed data ends before n pixels were decoded, an
+          exception is thrown */
+      const icl8u *rle_decode(icl8u *imageData, int n, const icl8u *compressedData, 
+                              const icl8u *compressedEnd, int quality){
+        icl8u *pc = imageData;
+        icl8u *pcEnd = imageData + n;
+        const icl8u *p = compressedData;
+        switch(quality){
+          case 1:
             for(;pc < pcEnd; ++p){
-              const int l = ( (*p) & 127) + 1;
+              check_rle_data(p,compressedEnd);
+              const int l = iclMin(( (*p) & 127) + 1, (int)(pcEnd-pc));
               std::fill(pc,pc+l,((*p)>>7) * 255);
               pc += l;
             }
-            compressedData = p;
             break;
-          }
-          case 4:{
-            icl8u *pc = imageData;
-            icl8u *pcEnd = imageData + imageDataLen;
-            const icl8u *p = compressedData;
+          case 4:
             for(;pc < pcEnd; ++p){
-              const int l = ( (*p) & 0xf) + 1;
+              check_rle_data(p,compressedEnd);
+              const int l = iclMin(( (*p) & 0xf) + 1, (int)(pcEnd-pc));
               std::fill(pc,pc+l,((*p) & 0xf0));
               pc += l;
             }
-            compressedData = p;   
             break;
-          }
           case 6:{
             static const int VAL_MASK=0xFC;
             static const int LEN_MASK=0x3;
-            
-            icl8u *pc = imageData;
-            icl8u *pcEnd = imageData + imageDataLen;
-            const icl8u *p = compressedData;
             for(;pc < pcEnd; ++p){
-              const int l = ( (*p) & LEN_MASK) + 1;
+              check_rle_data(p,compressedEnd);
+              const int l = iclMin(( (*p) & LEN_MASK) + 1, (int)(pcEnd-pc));
               std::fill(pc,pc+l,((*p) & VAL_MASK));
               pc += l;
             }
-            compressedData = p;   
             break;
           }
-          case 8:{
-            icl8u *pc = imageData;
-            icl8u *pcEnd = imageData + imageDataLen;
-            const icl8u *p = compressedData;
+          case 8:
             for(;pc < pcEnd; p+=2){
-              const int l = p[1]+1;
+              check_rle_data(p+1,compressedEnd);
+              const int l = iclMin(p[1]+1, (int)(pcEnd-pc));
               std::fill(pc,pc+l,p[0]);
               pc += l;
             }
-            compressedData = p;   
             break;
-          }
           default: 
-            throw ICLException("ImageCompressor::uncompressChannel: unsupported RLE compression quality (" + spec.quality + ")"); 
+            throw ICLException("ImageCompressor::uncompress: unsupported RLE compression quality (" + str(quality) + ")"); 
+        }
+        return p;
+      }
+
+      /// packs (16 to 11 bit) or unpacks (11 to 16 bit) the "1611" blocks [begin,end)
+      /** Block b contains the pixels [b*PACK_1611_BLOCK_PIXELS, (b+1)*PACK_1611_BLOCK_PIXELS) and
+          its packed words start at word (b*PACK_1611_BLOCK_PIXELS/16)*11. Therefore, the packed
+          data is identical to the data that is created by packing all pixels at once. */
+      struct Pack1611Blocks{
+        const uint16_t *src;
+        uint16_t *dst;
+        int n, quality;
+        bool pack;
+
+        void operator()(int begin, int end) const{
+          for(int b=begin;b<end;++b){
+            const int i = b*PACK_1611_BLOCK_PIXELS, m = iclMin(PACK_1611_BLOCK_PIXELS, n-i);
+            const int w = (i/16)*11;
+            if(pack){
+              if(quality == 0) Kinect11BitCompressor::pack16to11_2(src+i, dst+w, m);
+              else if(quality == 1) Kinect11BitCompressor::pack16to11(src+i, dst+w, m);
+            }else{
+              if(quality == 0) Kinect11BitCompressor::unpack11to16_2(src+w, dst+i, m);
+              else if(quality == 1) Kinect11BitCompressor::unpack11to16(src+w, dst+i, m);
+            }
+          }
+        }
+      };
+
+      /// run-length encodes the strips [begin,end) (strip k contains the rows of strip k%nStrips of channel k/nStrips)
+      struct EncodeRLEStrips{
+        const icl8u *const *channels;
+        std::vector<icl8u> *buffers;
+        int *lens;
+        int width, height, stripHeight, nStrips, quality;
+
+        void operator()(int begin, int end) const{
+          for(int k=begin;k<end;++k){
+            StripHeader h = { k/nStrips, (k%nStrips)*stripHeight, 0, 0 };
+            h.height = iclMin(stripHeight, height-h.y);
+            const int n = width*h.height;
+            std::vector<icl8u> &buf = buffers[k];
+            const size_t maxLen = sizeof(StripHeader) + (quality == 8 ? 2*n : n);
+            if(buf.size() < maxLen) buf.resize(maxLen);
+            icl8u *dst = buf.data() + sizeof(StripHeader);
+            h.len = (int)(rle_encode(channels[h.channel] + h.y*width, n, dst, quality) - dst);
+            write_strip_header(buf.data(), h);
+            lens[k] = (int)sizeof(StripHeader) + h.len;
+          }
+        }
+      };
+      
+      /// decodes the run-length encoded strips [begin,end)
+      struct DecodeRLEStrips{
+        const icl8u *const *strips;
+        icl8u *const *channels;
+        int width, quality;
+
+        void operator()(int begin, int end) const{
+          for(int k=begin;k<end;++k){
+            const StripHeader h = read_strip_header(strips[k]);
+            const icl8u *data = strips[k] + sizeof(StripHeader);
+            rle_decode(channels[h.channel] + h.y*width, width*h.height, data, data + h.len, quality);
+          }
+        }
+      };
+      
+#ifdef ICL_HAVE_LIBJPEG
+      /// encodes the strips [begin,end) as individual JPEGs
+      struct EncodeJPEGStrips{
+        const Img8u *image;
+        JPEGEncoder **encoders;
+        std::vector<icl8u> *buffers;
+        int *lens;
+        int stripHeight;
+
+        void operator()(int begin, int end) const{
+          const int W = image->getWidth(), H = image->getHeight();
+          for(int k=begin;k<end;++k){
+            StripHeader h = { -1, k*stripHeight, 0, 0 };
+            h.height = iclMin(stripHeight, H-h.y);
+            std::vector<icl8u*> rows(image->getChannels());
+            for(int c=0;c<image->getChannels();++c){
+              rows[c] = const_cast<icl8u*>(image->begin(c)) + h.y*W;
+            }
+            const Img8u strip(Size(W,h.height), image->getChannels(), image->getFormat(), rows, false);
+            const JPEGEncoder::EncodedData &jpeg = encoders[k]->encode(&strip);
+            std::vector<icl8u> &buf = buffers[k];
+            h.len = jpeg.len;
+            if(buf.size() < sizeof(StripHeader) + jpeg.len) buf.resize(sizeof(StripHeader) + jpeg.len);
+            write_strip_header(buf.data(), h);
+            std::copy(jpeg.bytes,jpeg.bytes+jpeg.len,buf.data()+sizeof(StripHeader));
+            lens[k] = (int)sizeof(StripHeader) + h.len;
+          }
+        }
+      };
+
+      /// decodes the JPEG strips [begin,end)
+      struct DecodeJPEGStrips{
+        const icl8u *const *strips;
+        ImgBase **buffers;
+        Img8u *image;
+
+        void operator()(int begin, int end) const{
+          const int W = image->getWidth();
+          for(int k=begin;k<end;++k){
+            const StripHeader h = read_strip_header(strips[k]);
+            JPEGDecoder::decode(strips[k] + sizeof(StripHeader), h.len, &buffers[k]);
+            const Img8u &strip = *buffers[k]->as8u();
+            ICLASSERT_THROW(strip.getSize() == Size(W,h.height) && strip.getChannels() == image->getChannels(),
+                            ICLException("ImageCompressor::uncompress: JPEG strip does not match the image header"));
+            for(int c=0;c<image->getChannels();++c){
+              std::copy(strip.begin(c), strip.end(c), image->begin(c) + h.y*W);
+            }
+          }
+        }
+      };
+#endif
+#ifdef ICL_HAVE_LIBZ
+      /// computes the residuals r[i] = x[i] - x[i-1] - up[i] + up[i-1] for i in [1,n)
+      /** U is an unsigned type, so that the residuals wrap around (which makes the
+          predictor lossless for all depths, float data is processed bitwise) */
+      template<class U>
+      inline void gradient_residuals(const U *x, const U *up, U *r, int n){
+        for(int i=1;i<n;++i) r[i] = x[i] - x[i-1] - up[i] + up[i-1];
+      }
+
+      /// computes the terms t[i] = r[i] + up[i] - up[i-1] for i in [1,n) (in-place)
+      template<class U>
+      inline void gradient_terms(U *r, const U *up, int n){
+        for(int i=1;i<n;++i) r[i] = r[i] + up[i] - up[i-1];
+      }
+
+  #ifdef ICL_HAVE_SSE2
+  #define ICL_INSTANTIATE_GRADIENT_SSE(U,STEP,ADD,SUB)                                      \
+      template<>                                                                             \
+      inline void gradient_residuals(const U *x, const U *up, U *r, int n){                  \
+        int i=1;                                                                             \
+        for(;i<=n-STEP;i+=STEP){                                                             \
+          const __m128i a = SUB(_mm_loadu_si128((const __m128i*)(x+i)),                       \
+                                _mm_loadu_si128((const __m128i*)(x+i-1)));                    \
+          const __m128i b = SUB(_mm_loadu_si128((const __m128i*)(up+i)),                      \
+                                _mm_loadu_si128((const __m128i*)(up+i-1)));                   \
+          _mm_storeu_si128((__m128i*)(r+i), SUB(a,b));                                        \
+        }                                                                                    \
+        for(;i<n;++i) r[i] = x[i] - x[i-1] - up[i] + up[i-1];                                \
+      }                                                                                      \
+      template<>                                                                             \
+      inline void gradient_terms(U *r, const U *up, int n){                                  \
+        int i=1;                                                                             \
+        for(;i<=n-STEP;i+=STEP){                                                             \
+          const __m128i d = SUB(_mm_loadu_si128((const __m128i*)(up+i)),                      \
+                                _mm_loadu_si128((const __m128i*)(up+i-1)));                   \
+          _mm_storeu_si128((__m128i*)(r+i), ADD(_mm_loadu_si128((const __m128i*)(r+i)),d));   \
+        }                                                                                    \
+        for(;i<n;++i) r[i] = r[i] + up[i] - up[i-1];                                         \
+      }
+
+      ICL_INSTANTIATE_GRADIENT_SSE(icl8u,16,_mm_add_epi8,_mm_sub_epi8)
+      ICL_INSTANTIATE_GRADIENT_SSE(uint16_t,8,_mm_add_epi16,_mm_sub_epi16)
+      ICL_INSTANTIATE_GRADIENT_SSE(uint32_t,4,_mm_add_epi32,_mm_sub_epi32)
+      ICL_INSTANTIATE_GRADIENT_SSE(uint64_t,2,_mm_add_epi64,_mm_sub_epi64)
+  #undef ICL_INSTANTIATE_GRADIENT_SSE
+  #endif
+
+      /// predicts a strip of rows (rows x h, the first row is predicted from its left neighbours only)
+      template<class U>
+      void predict_strip(const U *src, U *r, int w, int h){
+        r[0] = src[0];
+        for(int i=1;i<w;++i) r[i] = src[i] - src[i-1];
+        for(int y=1;y<h;++y){
+          const U *x = src + y*w, *up = x - w;
+          U *ry = r + y*w;
+          ry[0] = x[0] - up[0];
+          gradient_residuals(x,up,ry,w);
+        }
+      }
+
+      /// inverse of predict_strip (r is overwritten)
+      template<class U>
+      void unpredict_strip(U *r, U *dst, int w, int h){
+        dst[0] = r[0];
+        for(int i=1;i<w;++i) dst[i] = r[i] + dst[i-1];
+        for(int y=1;y<h;++y){
+          U *x = dst + y*w, *ry = r + y*w;
+          const U *up = x - w;
+          gradient_terms(ry,up,w);
+          x[0] = ry[0] + up[0];
+          for(int i=1;i<w;++i) x[i] = ry[i] + x[i-1];
+        }
+      }
+
+      /// splits n elements of size N into N byte planes (this makes the residual's high bytes compressible)
+      template<int N>
+      void shuffle_bytes(const icl8u *src, icl8u *dst, int n){
+        for(int b=0;b<N;++b){
+          icl8u *p = dst + b*n;
+          for(int i=0;i<n;++i) p[i] = src[i*N+b];
+        }
+      }
+
+      /// inverse of shuffle_bytes
+      template<int N>
+      void unshuffle_bytes(const icl8u *src, icl8u *dst, int n){
+        for(int b=0;b<N;++b){
+          const icl8u *p = src + b*n;
+          for(int i=0;i<n;++i) dst[i*N+b] = p[i];
+        }
+      }
+
+      /// predicts and deflates the strips [begin,end) (strip k contains the rows of strip k%nStrips of channel k/nStrips)
+      template<class U>
+      struct EncodeZlibStrips{
+        const icl8u *const *channels;
+        std::vector<icl8u> *buffers;
+        int *lens;
+        int width, height, stripHeight, nStrips, level;
+
+        void operator()(int begin, int end) const{
+          std::vector<U> residuals;
+          std::vector<icl8u> planes;
+          for(int k=begin;k<end;++k){
+            StripHeader h = { k/nStrips, (k%nStrips)*stripHeight, 0, 0 };
+            h.height = iclMin(stripHeight, height-h.y);
+            const int n = width*h.height;
+            const uLong nBytes = n*sizeof(U);
+            residuals.resize(n);
+            predict_strip(reinterpret_cast<const U*>(channels[h.channel]) + h.y*width, residuals.data(), width, h.height);
+            const icl8u *bytes = reinterpret_cast<const icl8u*>(residuals.data());
+            if(sizeof(U) > 1){
+              planes.resize(nBytes);
+              shuffle_bytes<sizeof(U)>(bytes, planes.data(), n);
+              bytes = planes.data();
+            }
+            std::vector<icl8u> &buf = buffers[k];
+            uLongf len = compressBound(nBytes);
+            if(buf.size() < sizeof(StripHeader) + len) buf.resize(sizeof(StripHeader) + len);
+            if(compress2(buf.data() + sizeof(StripHeader), &len, bytes, nBytes, level) != Z_OK){
+              throw ICLException("ImageCompressor::compress: zlib compression failed");
+            }
+            h.len = (int)len;
+            write_strip_header(buf.data(), h);
+            lens[k] = (int)sizeof(StripHeader) + h.len;
+          }
         }
+      };
+
+      /// inflates and reconstructs the strips [begin,end)
+      template<class U>
+      struct DecodeZlibStrips{
+        const icl8u *const *strips;
+        icl8u *const *channels;
+        int width;
+
+        void operator()(int begin, int end) const{
+          std::vector<U> residuals;
+          std::vector<icl8u> planes;
+          for(int k=begin;k<end;++k){
+            const StripHeader h = read_strip_header(strips[k]);
+            const int n = width*h.height;
+            uLongf nBytes = n*sizeof(U);
+            residuals.resize(n);
+            icl8u *bytes = reinterpret_cast<icl8u*>(residuals.data());
+            if(sizeof(U) > 1){
+              planes.resize(nBytes);
+              bytes = planes.data();
+            }
+            if(uncompress(bytes, &nBytes, strips[k] + sizeof(StripHeader), h.len) != Z_OK || nBytes != n*sizeof(U)){
+              throw ICLException("ImageCompressor::uncompress: invalid zlib compressed strip");
+            }
+            if(sizeof(U) > 1){
+              unshuffle_bytes<sizeof(U)>(planes.data(), reinterpret_cast<icl8u*>(residuals.data()), n);
+            }
+            unpredict_strip(residuals.data(), reinterpret_cast<U*>(channels[h.channel]) + h.y*width, width, h.height);
+          }
+        }
+      };
+#endif
+    }
+  
+    struct ImageCompressor::Data{
+      std::vector<Img8u> ditheringBuffers;
+      std::vector<icl8u> encoded_buffer;
+      ImgBase *decoded_buffer;
+      ImageCompressor::CompressionSpec compression;
+      
+      // strip-based encoding
+      int stripHeight;                           //!< rows per strip
+      int nStrips;                               //!< strips per channel (or for all channels for jpeg)
+      int nChunks;                               //!< total number of strips
+      std::vector<const icl8u*> channels;        //!< channel data to encode (dithered for "dith")
+      std::vector<std::vector<icl8u> > strips;   //!< encoded strips (including their strip header)
+      std::vector<int> stripLens;                //!< length of each encoded strip
+      
+      // strip-based decoding
+      std::vector<const icl8u*> stripPtrs;       //!< begin of each compressed strip
+      std::vector<icl8u*> dstChannels;           //!< channel data to decode into
+      std::vector<ImgBase*> decodingBuffers;     //!< jpeg decoding buffers (one per strip)
+      
+  #ifdef ICL_HAVE_LIBJPEG
+      std::vector<SmartPtr<JPEGEncoder> > jpegEncoders;
+      std::vector<JPEGEncoder*> jpegEncoderPtrs;
+  #endif
+      const ImgBase *image;                      //!< image that is currently encoded
+    };
+  
+    ImageCompressor::ImageCompressor(const ImageCompressor::CompressionSpec &spec):m_data(new Data){
+      m_data->decoded_buffer = 0;
+      m_data->stripHeight = m_data->nStrips = m_data->nChunks = 0;
+      m_data->image = 0;
+      setCompression(spec);
+    }
+  
+    ImageCompressor::~ImageCompressor(){
+      ICL_DELETE(m_data->decoded_buffer);
+      for(unsigned int i=0;i<m_data->decodingBuffers.size();++i){
+        ICL_DELETE(m_data->decodingBuffers[i]);
+      }
+      delete m_data;
+    }
+    
+    /// only decodes an image header
+    ImageCompressor::Header ImageCompressor::uncompressHeader(const icl8u *data,int len){
+      ICLASSERT_THROW(len > (int)sizeof(Header::Params), ICLException("ImageCompressor::uncompressHeader: data length too small"));
+      Header header;
+      header.params = *(reinterpret_cast<const Header::Params*>(data));
+      header.data = data;
+      return header;
+    }
+  
+    /// internal utlity function
+    int ImageCompressor::estimateRawDataSize(const ImgBase *image, bool skipMetaData){
+      return (image->getChannels() * image->getDim() * getSizeOf(image->getDepth()) +
+              (skipMetaData ? 0 : image->getMetaData().length()) + sizeof(ImgParams) +
+              sizeof(depth) + sizeof(Time) );
+    }
+  
+    int ImageCompressor::estimateEncodedBufferSize(const ImgBase *image, bool skipMetaData){
+      const int metaDataLength = skipMetaData ? 0 : (int)image->getMetaData().length();
+      const int headerSize = sizeof(Header::Params) + metaDataLength;
+      const int numPix = image->getDim() * image->getChannels() * getSizeOf(image->getDepth());
+      if(m_data->compression.mode == "rlen" && m_data->compression.quality == "8"){
+        return headerSize + 2*numPix;
       }else{
-        throw ICLException("ImageCompressor::uncompressChannel: unsupported compression mode (" + spec.mode + ")"); 
+        return headerSize + numPix;
       }
-      return compressedData;
     }
     
     inline void set_4(char p[4], const char *s){
@@ -311,7 +593,7 @@ namespace icl{
     
     ImageCompressor::Header ImageCompressor::createHeader(const ImgBase *image, bool skipMetaData){
       Header::Params params;
-      set_4(params.magick,"!icl");
+      set_4(params.magick, is_strip_mode(m_data->compression.mode) ? "!ics" : "!icl");
       set_4(params.compressionMode,m_data->compression.mode.c_str());
       params.compressionQuality = parse<icl32s>(m_data->compression.quality);
       params.width = image->getWidth();
@@ -329,25 +611,119 @@ namespace icl{
       Header header = { params, 0 };
       return header;
     }
+
+    void ImageCompressor::prepareStrips(const ImgBase *image){
+      const std::string &mode = m_data->compression.mode;
+      const int q = parse<int>(m_data->compression.quality);
+      const int C = image->getChannels();
+      m_data->image = image;
+      
+      if(mode == "jpeg"){
+        m_data->stripHeight = get_strip_height(image->getSize(), JPEG_STRIP_MIN_PIXELS);
+        m_data->nStrips = (image->getHeight() + m_data->stripHeight - 1) / m_data->stripHeight;
+        m_data->nChunks = m_data->nStrips;
+  #ifdef ICL_HAVE_LIBJPEG
+        while((int)m_data->jpegEncoders.size() < m_data->nChunks){
+          m_data->jpegEncoders.push_back(new JPEGEncoder);
+          m_data->jpegEncoderPtrs.push_back(m_data->jpegEncoders.back().get());
+        }
+        for(int i=0;i<m_data->nChunks;++i){
+          m_data->jpegEncoders[i]->setQuality(q);
+        }
+  #endif
+      }else{
+        m_data->stripHeight = get_strip_height(image->getSize(), RLE_STRIP_MIN_PIXELS);
+        m_data->nStrips = (image->getHeight() + m_data->stripHeight - 1) / m_data->stripHeight;
+        m_data->nChunks = m_data->nStrips * C;
+        m_data->channels.resize(C);
+        if(mode == "dith"){
+          // dithering propagates errors through the whole channel and is therefore not split
+          m_data->ditheringBuffers.resize(C);
+          DitheringOp op;
+          op.setLevels(round(pow(2,q)));
+          for(int c=0;c<C;++c){
+            Img8u tmp(image->getSize(), formatGray, std::vector<icl8u*>(1,(icl8u*)image->as8u()->begin(c)), false);
+            ImgBase *dst = &m_data->ditheringBuffers[c];
+            op.apply(&tmp,&dst);
+            m_data->channels[c] = m_data->ditheringBuffers[c].begin(0);
+          }
+        }else{
+          for(int c=0;c<C;++c){
+            m_data->channels[c] = (const icl8u*)image->getDataPtr(c);
+          }
+        }
+      }
+      if((int)m_data->strips.size() < m_data->nChunks){
+        m_data->strips.resize(m_data->nChunks);
+      }
+      m_data->stripLens.resize(m_data->nChunks);
+    }
+    
+    void ImageCompressor::encodeStrips(int begin, int end){
+      if(m_data->compression.mode == "jpeg"){
+  #ifdef ICL_HAVE_LIBJPEG
+        const EncodeJPEGStrips enc = { m_data->image->as8u(), m_data->jpegEncoderPtrs.data(),
+                                       m_data->strips.data(), m_data->stripLens.data(),
+                                       m_data->stripHeight };
+        parallel_for(begin,end,enc,1);
+  #else
+        (void)begin; (void)end;
+        throw ICLException("ImageCompressor:encode jpeg compression is not supported without libjpeg");
+  #endif
+      }else if(m_data->compression.mode == "zlib"){
+  #ifdef ICL_HAVE_LIBZ
+  #define ICL_ENCODE_ZLIB(U)                                                                      \
+        {                                                                                         \
+          const EncodeZlibStrips<U> enc = { m_data->channels.data(), m_data->strips.data(),       \
+                                            m_data->stripLens.data(), m_data->image->getWidth(),  \
+                                            m_data->image->getHeight(), m_data->stripHeight,      \
+                                            m_data->nStrips, parse<int>(m_data->compression.quality) }; \
+          parallel_for(begin,end,enc,1);                                                          \
+        }
+        switch(getSizeOf(m_data->image->getDepth())){
+          case 1: ICL_ENCODE_ZLIB(icl8u); break;
+          case 2: ICL_ENCODE_ZLIB(uint16_t); break;
+          case 4: ICL_ENCODE_ZLIB(uint32_t); break;
+          default: ICL_ENCODE_ZLIB(uint64_t); break;
+        }
+  #undef ICL_ENCODE_ZLIB
+  #else
+        throw ICLException("ImageCompressor:encode zlib compression is not supported without libz");
+  #endif
+      }else{
+        const EncodeRLEStrips enc = { m_data->channels.data(), m_data->strips.data(), m_data->stripLens.data(),
+                                      m_data->image->getWidth(), m_data->image->getHeight(), 
+                                      m_data->stripHeight, m_data->nStrips, 
+                                      parse<int>(m_data->compression.quality) };
+        parallel_for(begin,end,enc,1);
+      }
+    }
   
-    const ImageCompressor::CompressedData ImageCompressor::compress(const ImgBase *image, bool skipMetaData){ 
+    void ImageCompressor::checkDepth(const ImgBase *image){
       ICLASSERT_THROW(image,ICLException("ImageCompressor::compress: image width null"));
-  
-			if( (m_data->compression.mode != "none") && image->getDepth() != depth8u
-					&& ( (m_data->compression.mode != "1611") && image->getDepth() != depth16s) ){
-        throw ICLException("ImageCompressor::compress: image compression is only supported for Img8u images");
+      if( (m_data->compression.mode != "none") && (m_data->compression.mode != "zlib") && image->getDepth() != depth8u
+          && ( (m_data->compression.mode != "1611") && image->getDepth() != depth16s) ){
+        throw ICLException("ImageCompressor::compress: image compression is only supported for Img8u images "
+                           "(use the lossless mode 'zlib' for other depths)");
+      }
+      if(m_data->compression.mode == "jpeg" && image->getChannels() != 1 && image->getChannels() != 3){
+        throw ICLException("ImageCompressor::compress: jpeg compression is only supported for 1 or 3 channel images");
       }
+    }
+
+    const ImageCompressor::CompressedData ImageCompressor::compress(const ImgBase *image, bool skipMetaData){ 
+      checkDepth(image);
       
       Header header = createHeader(image,skipMetaData);
       
-      if(m_data->compression.mode == "jpeg"){
-  #ifdef ICL_HAVE_LIBJPEG
-  
-        if(!m_data->jpegEncoder) m_data->jpegEncoder = new JPEGEncoder;
-        m_data->jpegEncoder->setQuality(parse<int>(m_data->compression.quality));
-        const JPEGEncoder::EncodedData &jpeg = m_data->jpegEncoder->encode(image->as8u());
-        
-        int minLen = sizeof(Header::Params) + header.params.metaLen + jpeg.len;
+      if(is_strip_mode(m_data->compression.mode)){
+        prepareStrips(image);
+        encodeStrips(0,m_data->nChunks);
+
+        int minLen = sizeof(Header::Params) + header.params.metaLen;
+        for(int k=0;k<m_data->nChunks;++k){
+          minLen += m_data->stripLens[k];
+        }
         if((int)m_data->encoded_buffer.size() < minLen){
           m_data->encoded_buffer.resize(minLen);
         }
@@ -358,16 +734,14 @@ namespace icl{
         dst += sizeof(Header::Params);
         
         if(!skipMetaData){
-          std::copy(image->getMetaData().begin(), image->getMetaData().end(),dst);//header.metaBegin(), header.metaBegin()+header.params.metaLen,dst);
-          dst+= header.params.metaLen;
+          std::copy(image->getMetaData().begin(), image->getMetaData().end(),dst);
+          dst += header.params.metaLen;
+        }
+        for(int k=0;k<m_data->nChunks;++k){
+          const icl8u *strip = m_data->strips[k].data();
+          dst = std::copy(strip, strip+m_data->stripLens[k], dst);
         }
-        
-        std::copy(jpeg.bytes,jpeg.bytes+jpeg.len, dst);
-                                        
         return CompressedData(m_data->encoded_buffer.data(),minLen,float(minLen)/estimateRawDataSize(image,skipMetaData));
-  #else
-        throw ICLException("ImageCompressor:encode jpeg compression is not supported without libjpeg");
-  #endif
 			} else if(m_data->compression.mode == "1611") {
 
 				const Img16s *img16s_in = image->as16s();
@@ -395,15 +769,14 @@ namespace icl{
 				const uint16_t *src_16 = (const uint16_t*)(img16s_in->getData(0));
 				uint16_t *dst_16 = (uint16_t*)(dst);
 
-				int q = parse<int>(m_data->compression.quality);
-				if (q == 0)
-					Kinect11BitCompressor::pack16to11_2(src_16,dst_16,len);
-				else if (q == 1)
-					Kinect11BitCompressor::pack16to11(src_16,dst_16,len);
+				const int nBlocks = (len + PACK_1611_BLOCK_PIXELS - 1) / PACK_1611_BLOCK_PIXELS;
+				const Pack1611Blocks pack = { src_16, dst_16, len, parse<int>(m_data->compression.quality), true };
+				parallel_for(0,nBlocks,pack,1);
 
 				return CompressedData(m_data->encoded_buffer.data(),finalSize,encoded_len/float(len));
 			}
       
+      // no compression
       m_data->encoded_buffer.resize(estimateEncodedBufferSize(image,skipMetaData));
       
       icl8u *dst = m_data->encoded_buffer.data();
@@ -417,28 +790,48 @@ namespace icl{
         dst+= header.params.metaLen;
       }
   
-      float len = 0;
+      int l = image->getDim() * getSizeOf(image->getDepth());
+      for(int c=0;c<image->getChannels();++c){
+        std::copy((const icl8u*)image->getDataPtr(c),
+                  (const icl8u*)image->getDataPtr(c)+l,
+                  dst+c*l);
+      }
+      int len = (int)(dst + l * image->getChannels() - m_data->encoded_buffer.data());
+  
+      return CompressedData(m_data->encoded_buffer.data(), len, len/(float)m_data->encoded_buffer.size());
+    }
     
-      if(image->getDepth() == depth8u){
-        const Img8u *image8u = image->as8u();
-        for(int c=0;c<image->getChannels();++c){
-          dst = compressChannel(image8u->begin(c),dst, image8u->getSize(),
-                                image8u->getImageRect(), header.compressionSpec(),
-                                m_data->ditheringBuffer);
-        }
-        len = (float)(dst-m_data->encoded_buffer.data());
-      }else{ // only no-compression mode
-        int l = image->getDim() * getSizeOf(image->getDepth());
-        for(int c=0;c<image->getChannels();++c){
-          std::copy((const icl8u*)image->getDataPtr(c),
-                    (const icl8u*)image->getDataPtr(c)+l,
-                    dst+c*l);
+    void ImageCompressor::compress(const ImgBase *image, const ChunkCallback &cb, bool skipMetaData){
+      checkDepth(image);
+      if(!is_strip_mode(m_data->compression.mode)){
+        const CompressedData data = compress(image,skipMetaData);
+        cb(data.bytes,data.len);
+        return;
+      }
+      
+      // header and meta data first (the total length is not known yet)
+      Header header = createHeader(image,skipMetaData);
+      const int headerLen = sizeof(Header::Params) + header.params.metaLen;
+      if((int)m_data->encoded_buffer.size() < headerLen){
+        m_data->encoded_buffer.resize(headerLen);
+      }
+      *reinterpret_cast<Header::Params*>(m_data->encoded_buffer.data()) = header.params;
+      if(!skipMetaData){
+        std::copy(image->getMetaData().begin(), image->getMetaData().end(),
+                  m_data->encoded_buffer.data() + sizeof(Header::Params));
+      }
+      cb(m_data->encoded_buffer.data(), headerLen);
+
+      // then the strips in batches (each thread encodes about 2 strips per batch)
+      prepareStrips(image);
+      const int batchSize = 2*TaskScheduler::instance().getNumThreads();
+      for(int begin=0;begin<m_data->nChunks;begin+=batchSize){
+        const int end = iclMin(begin+batchSize, m_data->nChunks);
+        encodeStrips(begin,end);
+        for(int k=begin;k<end;++k){
+          cb(m_data->strips[k].data(), m_data->stripLens[k]);
         }
-  
-        len = l * image->getChannels();
       }
-  
-      return CompressedData(m_data->encoded_buffer.data(), (int)len+sizeof(Header::Params), len/m_data->encoded_buffer.size());
     }
   
     Time ImageCompressor::pickTimeStamp(const icl8u *data){
@@ -457,6 +850,72 @@ namespace icl{
     ImageCompressor::CompressionSpec ImageCompressor::Header::compressionSpec() const{
       return CompressionSpec(getCompressionMode(), str(params.compressionQuality));
     }
+
+    void ImageCompressor::uncompressStrips(const Header &header, const icl8u *end, ImgBase *image){
+      // collect the strips
+      const int W = header.params.width, H = header.params.height, C = header.params.channels;
+      const std::string mode = header.getCompressionMode();
+      const bool jpeg = mode == "jpeg";
+      std::vector<const icl8u*> &strips = m_data->stripPtrs;
+      strips.clear();
+      // strips are decoded in parallel: they must be ordered and must not overlap
+      int lastChannel = jpeg ? -1 : 0, lastEnd = 0;
+      for(const icl8u *p = header.imageBegin(); p < end; ){
+        ICLASSERT_THROW(p + sizeof(StripHeader) <= end, 
+                        ICLException("ImageCompressor::uncompress: truncated strip header"));
+        const StripHeader h = read_strip_header(p);
+        ICLASSERT_THROW(h.len >= 0 && h.len <= end - (p + sizeof(StripHeader)), 
+                        ICLException("ImageCompressor::uncompress: truncated strip"));
+        ICLASSERT_THROW(h.y >= 0 && h.height >= 0 && h.y <= H - h.height && 
+                        (jpeg ? h.channel == -1 : (h.channel >= 0 && h.channel < C)),
+                        ICLException("ImageCompressor::uncompress: invalid strip header"));
+        ICLASSERT_THROW(h.channel > lastChannel || (h.channel == lastChannel && h.y >= lastEnd),
+                        ICLException("ImageCompressor::uncompress: overlapping strips"));
+        lastChannel = h.channel;
+        lastEnd = h.y + h.height;
+        strips.push_back(p);
+        p += sizeof(StripHeader) + h.len;
+      }
+      
+      if(jpeg){
+  #ifdef ICL_HAVE_LIBJPEG
+        while(m_data->decodingBuffers.size() < strips.size()){
+          m_data->decodingBuffers.push_back(0);
+        }
+        const DecodeJPEGStrips dec = { strips.data(), m_data->decodingBuffers.data(), image->as8u() };
+        parallel_for(0,(int)strips.size(),dec,1);
+  #else
+        (void)image;
+        throw ICLException("ImageCompressor::uncompress: jpeg decoding is not supported without LIBJPEG");
+  #endif
+      }else{
+        m_data->dstChannels.resize(C);
+        for(int c=0;c<C;++c){
+          m_data->dstChannels[c] = (icl8u*)image->getDataPtr(c);
+        }
+        if(mode == "zlib"){
+  #ifdef ICL_HAVE_LIBZ
+  #define ICL_DECODE_ZLIB(U)                                                                       \
+          {                                                                                        \
+            const DecodeZlibStrips<U> dec = { strips.data(), m_data->dstChannels.data(), W };      \
+            parallel_for(0,(int)strips.size(),dec,1);                                              \
+          }
+          switch(getSizeOf(image->getDepth())){
+            case 1: ICL_DECODE_ZLIB(icl8u); break;
+            case 2: ICL_DECODE_ZLIB(uint16_t); break;
+            case 4: ICL_DECODE_ZLIB(uint32_t); break;
+            default: ICL_DECODE_ZLIB(uint64_t); break;
+          }
+  #undef ICL_DECODE_ZLIB
+  #else
+          throw ICLException("ImageCompressor::uncompress: zlib decoding is not supported without libz");
+  #endif
+        }else{
+          const DecodeRLEStrips dec = { strips.data(), m_data->dstChannels.data(), W, header.params.compressionQuality };
+          parallel_for(0,(int)strips.size(),dec,1);
+        }
+      }
+    }
     
     const ImgBase *ImageCompressor::uncompress(const icl8u *data, int len, ImgBase **dst){
       ICLASSERT_THROW(data, ICLException("ImageCompressor::uncompress: "
@@ -466,8 +925,17 @@ namespace icl{
   
       Header header = uncompressHeader(data,len);
 			ImgBase *&useDst = dst ? *dst : m_data->decoded_buffer;
-  
-      if(header.getCompressionMode() == "jpeg"){
+      ICLASSERT_THROW(header.params.metaLen >= 0 && header.params.metaLen <= len - (int)sizeof(Header::Params) &&
+                      header.params.width >= 0 && header.params.height >= 0 && header.params.channels >= 0,
+                      ICLException("ImageCompressor::uncompress: invalid image header"));
+
+      if(header.getMagickCode() == "!ics"){
+        ICLASSERT_THROW(header.params.depth == depth8u || header.getCompressionMode() == "zlib",
+                        ICLException("ImageCompressor::uncompress: strip-based compression requires depth8u"));
+        header.setupImage(&useDst);
+        useDst->getMetaData().assign(header.metaBegin(), header.metaBegin()+header.params.metaLen);
+        uncompressStrips(header, data+len, useDst);
+      }else if(header.getCompressionMode() == "jpeg"){
   #ifdef ICL_HAVE_LIBJPEG
         JPEGDecoder::decode(header.imageBegin(), header.imageLen(), &useDst);
         useDst->getMetaData().assign(header.metaBegin(), header.metaBegin()+header.params.metaLen);
@@ -475,17 +943,20 @@ namespace icl{
         throw ICLException("ImageCompressor::uncompress: jpeg decoding is not supported without LIBJPEG");
   #endif
 			}else if(header.getCompressionMode() == "1611") {
-				int len = header.params.width*header.params.height;
+				int n = header.params.width*header.params.height;
+				ICLASSERT_THROW(header.params.depth == depth16s && 
+				                (size_t)(data + len - header.imageBegin()) >= 
+				                Kinect11BitCompressor::estimate_packed_size(n)*sizeof(uint16_t),
+				                ICLException("ImageCompressor::uncompress: truncated 1611 compressed data"));
 				header.setupImage(&useDst);
 				useDst->getMetaData().assign(header.metaBegin(), header.metaBegin()+header.params.metaLen);
 
 				Img16s *s16s = useDst->as16s();
 				uint16_t *dst16 = (uint16_t*)s16s->getData(0);
 				const uint16_t *src16 = (const uint16_t*)header.imageBegin();
-				if (header.params.compressionQuality == 0)
-					Kinect11BitCompressor::unpack11to16_2(src16,dst16,len);
-				else if (header.params.compressionQuality == 1)
-					Kinect11BitCompressor::unpack11to16(src16,dst16,len);
+				const int nBlocks = (n + PACK_1611_BLOCK_PIXELS - 1) / PACK_1611_BLOCK_PIXELS;
+				const Pack1611Blocks unpack = { src16, dst16, n, header.params.compressionQuality, false };
+				parallel_for(0,nBlocks,unpack,1);
 
 			}else{
   
@@ -494,13 +965,17 @@ namespace icl{
   
         const icl8u *p = header.imageBegin();
   
-        if(useDst->getDepth() == depth8u){
+        if(header.getCompressionMode() == "rlen" || header.getCompressionMode() == "dith"){
+          // data of older versions: the channels were encoded as a whole
           Img8u *b8u = useDst->as8u();
           for(int c=0;c<b8u->getChannels();++c){
-            p = uncompressChannel(b8u->begin(c), header.params.width * header.params.height, p, header.compressionSpec());
+            p = rle_decode(b8u->begin(c), header.params.width * header.params.height, p, data+len,
+                           header.params.compressionQuality);
           }
         }else{
           int l = useDst->getDim() * getSizeOf(useDst->getDepth());
+          ICLASSERT_THROW(data + len - p >= (ptrdiff_t)l * useDst->getChannels(),
+                          ICLException("ImageCompressor::uncompress: truncated image data"));
           for(int c=0;c<useDst->getChannels();++c){
             std::copy(p+c*l, p+(c+1)*l, (icl8u*)useDst->getDataPtr(c));
 					}
@@ -523,6 +998,15 @@ namespace icl{
         int q = parse<int>(spec.quality);
         if(q<0 || q>100){
           throw ICLException("ImageCompressor::setCompression: invalid jpeg compression quality (" + spec.quality + ")");
+        }
+      }else if(spec.mode == "zlib"){
+        if(!spec.quality.length()){
+          m_data->compression = CompressionSpec("zlib","1");
+          return;
+        }
+        int q = parse<int>(spec.quality);
+        if(q<0 || q>9){
+          throw ICLException("ImageCompressor::setCompression: invalid zlib compression level (" + spec.quality + ")");
         }
 			}else if (spec.mode == "1611") {
 				int q = parse<int>(spec.quality);
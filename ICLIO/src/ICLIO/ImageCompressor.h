@@ -32,6 +32,7 @@
 
 #include <ICLUtils/CompatMacros.h>
 #include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Function.h>
 #include <ICLCore/Img.h>
 
 namespace icl{
@@ -78,12 +79,20 @@ namespace icl{
 					- Quality 0: Cuts the upper 5 bits (only values up to 2^11 are supported)
 					- Quality 1: Compresses 16-bit arrays to 11-bit packed arrays as follows: D = (a/Z)+b
 						and uncompresses Z = a/(D-b) (See Kinect11BitCompressor for details)
-        - "none" Uncompressed image serialization. This is the only compression mode, that
-          can be used for non-core::Img8u images.
+        - "zlib" lossless compression for all image depths (only available if ICL was
+          build with zlib support). Each image row is transformed by a gradient
+          predictor (x - (left + top - topLeft), computed with wrap-around arithmetic on the
+          pixels' bit patterns, which makes it lossless for floating point images too).
+          The resulting residuals are split into byte-planes (so that the mostly zero
+          high bytes form long runs) and compressed using zlib's deflate. The quality
+          is the zlib compression level (0-9, default is 1, which is usually the best
+          trade-off for streaming).
+        - "none" Uncompressed image serialization.
         
         \section DEPTH Depth Support
-        Only core::Img8u-images can be compressed. For all other formats, the compression 
-        mode "none" (with quality setting "none") has to be chosen.
+        Only core::Img8u-images can be compressed using the lossy modes. For all other
+        depths, the lossless "zlib" mode or "none" (with quality setting "none") has
+        to be chosen. The Kinect-specific mode "1611" is only available for core::Img16s.
   
         \section SERIALIZATION Serialization Structure
         The serialized image consists of 3 parts: The Header information, which is
@@ -92,6 +101,23 @@ namespace icl{
         The lengths of the meta data and the image data segements are defined by the
         header.
         
+        \section STRIPS Strip-based Compression
+        The "rlen", "dith", "jpeg" and "zlib" modes split the image into horizontal strips
+        of at least 64K (JPEG: 256K) pixels, whose height is a multiple of 16. For
+        run-length and zlib encoding, each channel's strips are encoded independently, for
+        JPEG each strip is encoded as an individual JPEG image that contains all
+        channels. Each encoded strip is preceded by a small strip header (channel,
+        first row, number of rows and data length). Strips are encoded and decoded
+        in parallel using the utils::TaskScheduler. Strip-based data is marked
+        by the magick code "!ics" (instead of "!icl"); data created by older versions
+        (with run-length codes spanning whole channels) can still be decoded.
+        
+        The strip-layout also allows for streaming: the compress-variant that gets
+        a ChunkCallback passes the header and the encoded strips as soon as they are
+        available, so that e.g. sending data via network can start before the whole
+        image is compressed. In this case, the header's dataLen is 0 and the length
+        of the concatenated chunks has to be passed to uncompress.
+        
         \section META Meta Data
         The ImageCompressor preserves an images meta data, however meta data is always binarized
         in an uncompressed manner.
@@ -125,9 +151,10 @@ namespace icl{
         \section MEM Memory Consumption 
         In order to avoid run-time memory allocation, the
         run-length coder always ensures that enough bytes
-        are available: I.e. 1 byte per image pixel 
-        + header size of 37 + N bytes (N is meta data size)\n
-        for JPEG data, 2x the raw image data is allocated
+        are available for each strip: I.e. 1 byte per image pixel
+        (2 bytes for quality 8) + 16 bytes for the strip header.
+        Encoded strips are kept in buffers that are re-used for
+        subsequent images.
     */
     class ICLIO_API ImageCompressor : public utils::Uncopyable{
       struct Data;  //!< pimpl type
@@ -139,6 +166,15 @@ namespace icl{
       /// internal utlity function
       int estimateRawDataSize(const core::ImgBase *image, bool skipMetaData);
       
+      /// internal utility function (throws if the image cannot be compressed with the current mode)
+      void checkDepth(const core::ImgBase *image);
+      
+      /// internal utility function that sets up the strip layout for strip-based compression
+      void prepareStrips(const core::ImgBase *image);
+      
+      /// internal utility function that encodes the strips [begin,end) in parallel
+      void encodeStrips(int begin, int end);
+      
       public:
       /// compression specification
       struct ICLIO_API CompressionSpec{
@@ -187,6 +223,9 @@ namespace icl{
       
       /// creates a header for a given image (not data will be null)
       Header createHeader(const core::ImgBase *image, bool skipMetaData);
+      
+      /// decodes strip-based compressed data in parallel (end is the end of the compressed data)
+      void uncompressStrips(const Header &header, const icl8u *end, core::ImgBase *image);
   
       public:
   
@@ -229,6 +268,7 @@ namespace icl{
             the number of bits, that are used for the value domain. 
             Default value is 1, which is used for binary images)
           - "jpeg" jpeg encoding (quality is default jpeg quality 1% - 100%)
+          - "zlib" lossless encoding for all depths (quality is the zlib compression level 0-9)
       */
       virtual void setCompression(const CompressionSpec &spec);
       
@@ -244,6 +284,16 @@ namespace icl{
       /// encodes a given image into the compressed code
       /** JPEG compression does not yet meta data */
       const CompressedData compress(const core::ImgBase *image, bool skipMetaData=false);
+      
+      /// callback type for chunk-wise compression (gets chunk data and chunk length)
+      typedef utils::Function<void,const icl8u*,int> ChunkCallback;
+      
+      /// encodes a given image and passes the compressed code chunk by chunk to the given callback
+      /** The first chunk contains header and meta data, followed by one chunk per
+          encoded strip (see \ref STRIPS). Chunk data is only valid during the callback.
+          Concatenating all chunks results in data that can be decoded by uncompress.
+          For the non strip-based modes, the whole compressed image is passed at once. */
+      void compress(const core::ImgBase *image, const ChunkCallback &cb, bool skipMetaData=false);
   
       /// decodes the given byte segment
       const core::ImgBase *uncompress(const icl8u *compressedData, int len, core::ImgBase **dst=0);
@@ -0,0 +1,449 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRing.cpp                   **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/SharedMemoryRing.h>
+#include <ICLCore/Img.h>
+#include <ICLCore/CoreFunctions.h>
+#include <ICLUtils/StringUtils.h>
+
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    namespace{
+      /// segment header (64 bytes)
+      struct RingHeader{
+        char magic[8];             //!< "ICLSMRNG"
+        icl32s version;            //!< format version (1)
+        icl32s numSlots;           //!< number of slots
+        icl64s slotSize;           //!< payload capacity of each slot
+        volatile icl64s writeSeq;  //!< number of the newest complete frame
+        volatile icl32s valid;     //!< 0 once the writer re-created or removed the segment
+        icl32s writerPid;          //!< process id of the writer
+        char reserved[24];
+      };
+
+      /// slot header (64 bytes) followed by the pixel data and the meta data
+      struct SlotHeader{
+        volatile icl64s seq;       //!< 2k-1 while frame k is written, 2k afterwards
+        icl64s timeStamp;
+        icl32s width,height,channels,depth,format;
+        icl32s roi[4];
+        icl32s metaLen;
+        icl64s dataLen;            //!< pixel data length in bytes
+      };
+
+      static const char RING_MAGIC[8] = {'I','C','L','S','M','R','N','G'};
+      static const icl64s HEADER_SIZE = 64;
+      static const icl64s SLOT_HEADER_SIZE = 64;
+      static const std::string PREFIX = "icl-smr-";
+
+      inline void barrier(){
+        __sync_synchronize();
+      }
+
+      inline icl64s align64(icl64s n){
+        return (n + 63) & ~icl64s(63);
+      }
+
+      inline icl64s segment_size(int numSlots, icl64s slotSize){
+        return HEADER_SIZE + numSlots * (SLOT_HEADER_SIZE + align64(slotSize));
+      }
+
+      inline icl64s image_size(const ImgBase *image){
+        return (icl64s)image->getDim() * image->getChannels() * getSizeOf(image->getDepth());
+      }
+
+      /// checks whether a copied slot header is consistent with the slot size
+      inline bool is_consistent(const SlotHeader &h, icl64s slotSize){
+        return h.depth >= 0 && h.depth <= depthLast && h.channels >= 0 && h.width >= 0 && h.height >= 0 &&
+               h.metaLen >= 0 && h.dataLen + h.metaLen <= slotSize &&
+               h.dataLen == (icl64s)h.width * h.height * h.channels * getSizeOf((depth)h.depth);
+      }
+
+      template<class T>
+      ImgBase *wrap(const SlotHeader &h, icl8u *pixels){
+        const Size size(h.width,h.height);
+        std::vector<T*> channels(h.channels);
+        for(int c=0;c<h.channels;++c){
+          channels[c] = reinterpret_cast<T*>(pixels) + c*size.getDim();
+        }
+        return new Img<T>(size,h.channels,(format)h.format,channels,false);
+      }
+    }
+
+    struct SharedMemoryRing::Data{
+      std::string name;
+      std::string shmName;
+      Mode mode;
+      int fd;
+      icl8u *mem;
+      icl64s memSize;
+      icl8u *retired;          //!< reader: previous mapping, kept until the next read/access call
+      icl64s retiredSize;
+      ImgBase *shallow;
+
+      RingHeader *header() { return reinterpret_cast<RingHeader*>(mem); }
+
+      SlotHeader *slot(icl64s seq){
+        const RingHeader *h = header();
+        const icl64s idx = (seq-1) % h->numSlots;
+        return reinterpret_cast<SlotHeader*>(mem + HEADER_SIZE + idx * (SLOT_HEADER_SIZE + align64(h->slotSize)));
+      }
+
+      void unmap(){
+        if(mem) munmap(mem,memSize);
+        if(fd >= 0) ::close(fd);
+        mem = 0;
+        memSize = 0;
+        fd = -1;
+      }
+
+      void releaseRetired(){
+        if(retired) munmap(retired,retiredSize);
+        retired = 0;
+        retiredSize = 0;
+      }
+
+      /// returns whether an existing segment was left behind by a writer process that no longer exists
+      bool isStale() const{
+        const int f = shm_open(shmName.c_str(), O_RDONLY, 0);
+        if(f < 0) return false;
+        RingHeader h;
+        const bool complete = ::read(f,&h,sizeof(h)) == (ssize_t)sizeof(h);
+        ::close(f);
+        return complete && !std::memcmp(h.magic,RING_MAGIC,8) && h.writerPid > 0 &&
+               ::kill(h.writerPid,0) && errno == ESRCH;
+      }
+
+      /// writer: creates a new segment
+      /** An existing segment is only replaced if it is our own one (replaceOwn, used when the
+          slots are enlarged) or if its writer process no longer exists. Otherwise, an
+          exception is thrown. The segment is only accessible for the current user */
+      void create(int numSlots, icl64s slotSize, icl64s firstSeq, bool replaceOwn){
+        if(replaceOwn) ::shm_unlink(shmName.c_str());
+        fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if(fd < 0 && errno == EEXIST && !replaceOwn && isStale()){
+          ::shm_unlink(shmName.c_str());
+          fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        }
+        if(fd < 0){
+          if(errno == EEXIST){
+            throw ICLException("SharedMemoryRing: segment " + shmName + " is already used by another writer");
+          }
+          throw ICLException("SharedMemoryRing: unable to create segment " + shmName + ": " + strerror(errno));
+        }
+        memSize = segment_size(numSlots,slotSize);
+        if(ftruncate(fd,memSize)){
+          ::close(fd);
+          fd = -1;
+          ::shm_unlink(shmName.c_str());
+          throw ICLException("SharedMemoryRing: unable to resize segment " + shmName + ": " + strerror(errno));
+        }
+        void *m = mmap(0,memSize,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+        if(m == MAP_FAILED){
+          ::close(fd);
+          fd = -1;
+          ::shm_unlink(shmName.c_str());
+          throw ICLException("SharedMemoryRing: unable to map segment " + shmName + ": " + strerror(errno));
+        }
+        mem = (icl8u*)m;
+        RingHeader *h = header();
+        h->version = 1;
+        h->numSlots = numSlots;
+        h->slotSize = slotSize;
+        h->writeSeq = firstSeq;
+        h->writerPid = getpid();
+        std::copy(RING_MAGIC,RING_MAGIC+8,h->magic);
+        barrier();
+        h->valid = 1;
+      }
+
+      /// reader: tries to attach to the current segment
+      bool attach(){
+        fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+        if(fd < 0) return false;
+        struct stat st;
+        if(fstat(fd,&st) || st.st_size < HEADER_SIZE){
+          unmap();
+          return false;
+        }
+        memSize = st.st_size;
+        void *m = mmap(0,memSize,PROT_READ,MAP_SHARED,fd,0);
+        if(m == MAP_FAILED){
+          mem = 0;
+          unmap();
+          return false;
+        }
+        mem = (icl8u*)m;
+        const RingHeader *h = header();
+        if(!h->valid || std::memcmp(h->magic,RING_MAGIC,8) || h->version != 1 ||
+           h->numSlots <= 0 || segment_size(h->numSlots,h->slotSize) > memSize){
+          unmap();
+          return false;
+        }
+        return true;
+      }
+
+      /// reader: makes sure, that the current segment is mapped
+      bool ensureAttached(){
+        if(mem && !header()->valid){
+          // the writer re-created or removed the segment: the old mapping is
+          // kept until the next read/access call, since an image returned by
+          // access() might still point into it
+          releaseRetired();
+          ::close(fd);
+          retired = mem;
+          retiredSize = memSize;
+          mem = 0;
+          memSize = 0;
+          fd = -1;
+        }
+        return mem || attach();
+      }
+    };
+
+    SharedMemoryRing::SharedMemoryRing(const std::string &name, Mode mode, int numSlots, icl64s slotSize) throw (ICLException):
+      m_data(new Data){
+      m_data->name = name;
+      m_data->shmName = "/" + PREFIX + name;
+      m_data->mode = mode;
+      m_data->fd = -1;
+      m_data->mem = 0;
+      m_data->memSize = 0;
+      m_data->retired = 0;
+      m_data->retiredSize = 0;
+      m_data->shallow = 0;
+      if(name.empty() || name.find('/') != std::string::npos){
+        delete m_data;
+        throw ICLException("SharedMemoryRing: invalid ring name '" + name + "'");
+      }
+      if(mode == Writer){
+        try{
+          m_data->create(iclMax(numSlots,2),iclMax(slotSize,icl64s(0)),0,false);
+        }catch(...){
+          delete m_data;
+          throw;
+        }
+      }else{
+        m_data->attach();
+      }
+    }
+
+    SharedMemoryRing::~SharedMemoryRing(){
+      ICL_DELETE(m_data->shallow);
+      if(m_data->mode == Writer && m_data->mem){
+        m_data->header()->valid = 0;
+        ::shm_unlink(m_data->shmName.c_str());
+      }
+      m_data->unmap();
+      m_data->releaseRetired();
+      delete m_data;
+    }
+
+    const std::string &SharedMemoryRing::getName() const{
+      return m_data->name;
+    }
+
+    SharedMemoryRing::Mode SharedMemoryRing::getMode() const{
+      return m_data->mode;
+    }
+
+    int SharedMemoryRing::getNumSlots() const{
+      return m_data->mem ? m_data->header()->numSlots : 0;
+    }
+
+    icl64s SharedMemoryRing::getSlotSize() const{
+      return m_data->mem ? m_data->header()->slotSize : 0;
+    }
+
+    icl64s SharedMemoryRing::write(const ImgBase *image) throw (ICLException){
+      ICLASSERT_THROW(m_data->mode == Writer, ICLException("SharedMemoryRing::write: ring was not created in Writer mode"));
+      ICLASSERT_THROW(image, ICLException("SharedMemoryRing::write: image is null"));
+      const std::string &meta = image->getMetaData();
+      const icl64s dataLen = image_size(image);
+      const icl64s needed = dataLen + (icl64s)meta.length();
+
+      RingHeader *h = m_data->header();
+      if(needed > h->slotSize){
+        const int numSlots = h->numSlots;
+        const icl64s seq = h->writeSeq;
+        h->valid = 0;
+        barrier();
+        m_data->unmap();
+        m_data->create(numSlots,needed,seq,true);
+        h = m_data->header();
+      }
+
+      const icl64s seq = h->writeSeq + 1;
+      SlotHeader *s = m_data->slot(seq);
+      s->seq = 2*seq - 1;
+      barrier();
+
+      s->timeStamp = image->getTime().toMicroSeconds();
+      s->width = image->getWidth();
+      s->height = image->getHeight();
+      s->channels = image->getChannels();
+      s->depth = (icl32s)image->getDepth();
+      s->format = (icl32s)image->getFormat();
+      const Rect roi = image->getROI();
+      s->roi[0] = roi.x;
+      s->roi[1] = roi.y;
+      s->roi[2] = roi.width;
+      s->roi[3] = roi.height;
+      s->metaLen = (icl32s)meta.length();
+      s->dataLen = dataLen;
+
+      icl8u *pixels = reinterpret_cast<icl8u*>(s) + SLOT_HEADER_SIZE;
+      const icl64s channelLen = (icl64s)image->getDim() * getSizeOf(image->getDepth());
+      for(int c=0;c<image->getChannels();++c){
+        std::memcpy(pixels + c*channelLen, image->getDataPtr(c), channelLen);
+      }
+      std::copy(meta.begin(),meta.end(),pixels + dataLen);
+
+      barrier();
+      s->seq = 2*seq;
+      barrier();
+      h->writeSeq = seq;
+      return seq;
+    }
+
+    icl64s SharedMemoryRing::getLatestSequenceNumber(){
+      if(m_data->mode == Writer) return m_data->header()->writeSeq;
+      if(!m_data->ensureAttached()) return 0;
+      return m_data->header()->writeSeq;
+    }
+
+    SharedMemoryRing::Status SharedMemoryRing::read(icl64s seq, ImgBase **dst){
+      ICLASSERT_THROW(dst, ICLException("SharedMemoryRing::read: dst is null"));
+      ICL_DELETE(m_data->shallow);
+      m_data->releaseRetired();
+      if(seq <= 0 || seq > getLatestSequenceNumber()) return NotAvailable;
+
+      const SlotHeader *s = m_data->slot(seq);
+      if(s->seq != 2*seq) return Overrun;
+      barrier();
+      const SlotHeader h = *s;
+      if(!is_consistent(h,m_data->header()->slotSize)){
+        // the header was modified while it was copied
+        return Overrun;
+      }
+
+      const Rect roi(h.roi[0],h.roi[1],h.roi[2],h.roi[3]);
+      ImgBase *image = ensureCompatible(dst,(depth)h.depth,Size(h.width,h.height),h.channels,(format)h.format);
+      const icl8u *pixels = reinterpret_cast<const icl8u*>(s) + SLOT_HEADER_SIZE;
+      const icl64s channelLen = (icl64s)h.width * h.height * getSizeOf((depth)h.depth);
+      for(int c=0;c<h.channels;++c){
+        std::memcpy(image->getDataPtr(c), pixels + c*channelLen, channelLen);
+      }
+      std::string &meta = image->getMetaData();
+      meta.assign(reinterpret_cast<const char*>(pixels + h.dataLen), h.metaLen);
+
+      barrier();
+      if(s->seq != 2*seq) return Overrun;
+
+      image->setROI(roi);
+      image->setTime(Time(h.timeStamp));
+      return OK;
+    }
+
+    const ImgBase *SharedMemoryRing::access(icl64s seq, Status *status){
+      ICL_DELETE(m_data->shallow);
+      m_data->releaseRetired();
+      Status dummy;
+      Status &st = status ? *status : dummy;
+      if(seq <= 0 || seq > getLatestSequenceNumber()){
+        st = NotAvailable;
+        return 0;
+      }
+      const SlotHeader *s = m_data->slot(seq);
+      if(s->seq != 2*seq){
+        st = Overrun;
+        return 0;
+      }
+      barrier();
+      const SlotHeader h = *s;
+      barrier();
+      if(s->seq != 2*seq || !is_consistent(h,m_data->header()->slotSize)){
+        st = Overrun;
+        return 0;
+      }
+      icl8u *pixels = const_cast<icl8u*>(reinterpret_cast<const icl8u*>(s)) + SLOT_HEADER_SIZE;
+      switch(h.depth){
+#define ICL_INSTANTIATE_DEPTH(D) case depth##D: m_data->shallow = wrap<icl##D>(h,pixels); break;
+        ICL_INSTANTIATE_ALL_DEPTHS;
+#undef ICL_INSTANTIATE_DEPTH
+      }
+      m_data->shallow->setROI(Rect(h.roi[0],h.roi[1],h.roi[2],h.roi[3]));
+      m_data->shallow->setTime(Time(h.timeStamp));
+      m_data->shallow->setMetaData(std::string(reinterpret_cast<const char*>(pixels + h.dataLen), h.metaLen));
+      st = OK;
+      return m_data->shallow;
+    }
+
+    bool SharedMemoryRing::isValid(icl64s seq){
+      if(!m_data->mem || seq <= 0 || !m_data->header()->valid) return false;
+      barrier();
+      return m_data->slot(seq)->seq == 2*seq;
+    }
+
+    void SharedMemoryRing::remove(const std::string &name){
+      ::shm_unlink(("/" + PREFIX + name).c_str());
+    }
+
+    std::vector<std::string> SharedMemoryRing::list(){
+      std::vector<std::string> names;
+#ifdef ICL_SYSTEM_LINUX
+      DIR *dir = opendir("/dev/shm");
+      if(!dir) return names;
+      while(struct dirent *e = readdir(dir)){
+        const std::string n = e->d_name;
+        if(n.length() > PREFIX.length() && n.substr(0,PREFIX.length()) == PREFIX){
+          names.push_back(n.substr(PREFIX.length()));
+        }
+      }
+      closedir(dir);
+#endif
+      return names;
+    }
+
+  } // namespace io
+}
@@ -0,0 +1,150 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRing.h                     **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Exception.h>
+#include <ICLCore/ImgBase.h>
+#include <string>
+#include <vector>
+
+namespace icl{
+  namespace io{
+
+    /// Lock-free single-writer/multi-reader image ring buffer in POSIX shared memory
+    /** The ring consists of a fixed number of slots, each large enough to hold
+        one image. Frames are numbered consecutively starting with 1; frame k is
+        written to slot (k-1) % N. Each slot is protected by a sequence counter
+        (seqlock): while frame k is written, the slot's counter is 2k-1, afterwards
+        it is 2k. Readers never take any lock and never block the writer. A reader
+        checks the slot counter before and after accessing the slot; if the counter
+        changed in the meantime, the frame was overwritten (overrun) and the
+        reader's copy is discarded.
+
+        Readers can either copy a frame (read) or access it in place without any
+        copy (access). In-place access returns an image whose channels point into
+        the shared memory segment. Since the writer does not wait for the readers,
+        such frames can be overwritten at any time; isValid() tells whether a
+        frame is still intact after it was processed.
+
+        If the writer receives an image that is larger than the slots, it
+        re-creates the segment with larger slots. The old segment is marked
+        invalid, and readers transparently re-attach to the new one. Frame
+        numbers are continued, but frames of the old segment are lost.
+
+        The segments are named "/icl-smr-<name>" (on Linux, they appear in
+        /dev/shm) and are only accessible for the user who created them. A
+        writer never replaces the segment of another running writer; segments
+        that were left behind by a crashed writer are replaced automatically.
+        The ring is not available on Windows.
+
+        @see SharedMemoryRingPublisher
+        @see SharedMemoryRingGrabber
+    */
+    class ICLIO_API SharedMemoryRing : public utils::Uncopyable{
+      public:
+
+      /// access mode
+      enum Mode{
+        Writer, //!< creates (and finally removes) the segment
+        Reader  //!< attaches to an existing segment
+      };
+
+      /// result of read and access operations
+      enum Status{
+        OK,             //!< the frame was read successfully
+        NotAvailable,   //!< the frame was not written yet (or the segment does not exist)
+        Overrun         //!< the frame was already overwritten by the writer
+      };
+
+      /// creates a ring
+      /** In Writer mode, the segment is created immediately using the given
+          number of slots. If a ring with the given name is already written
+          by another process, an exception is thrown. The initial slot size can be given (in bytes); it is
+          increased automatically if larger images are written. In Reader mode,
+          numSlots and slotSize are ignored and the ring attaches lazily to the
+          segment once the writer created it. */
+      SharedMemoryRing(const std::string &name, Mode mode, int numSlots=4, icl64s slotSize=0) throw (utils::ICLException);
+
+      /// Destructor (in Writer mode, the segment is removed)
+      ~SharedMemoryRing();
+
+      /// returns the ring name
+      const std::string &getName() const;
+
+      /// returns the access mode
+      Mode getMode() const;
+
+      /// returns the number of slots (0 if a reader is not attached yet)
+      int getNumSlots() const;
+
+      /// returns the current slot size in bytes (0 if a reader is not attached yet)
+      icl64s getSlotSize() const;
+
+      /// writes a new frame (Writer mode only) and returns its frame number
+      icl64s write(const core::ImgBase *image) throw (utils::ICLException);
+
+      /// returns the frame number of the newest complete frame (0 if there is none)
+      icl64s getLatestSequenceNumber();
+
+      /// copies the given frame into *dst (Reader mode only)
+      /** The copy is validated after it was created. If the frame was (partly)
+          overwritten during copying, Overrun is returned. */
+      Status read(icl64s seq, core::ImgBase **dst);
+
+      /// provides the given frame without copying (Reader mode only)
+      /** The returned image's channels point into the shared memory segment. The
+          image must not be modified and must not be deleted. It is valid
+          until the next call to access() or read(). The writer can overwrite
+          the frame at any time; use isValid() to check whether the frame's data
+          was still intact after processing it. If the frame is not available,
+          null is returned and status (if given) is set accordingly. */
+      const core::ImgBase *access(icl64s seq, Status *status=0);
+
+      /// returns whether the given frame is still stored in the ring
+      bool isValid(icl64s seq);
+
+      /// removes a (stale) segment with the given name
+      static void remove(const std::string &name);
+
+      /// returns the names of all existing rings (Linux only)
+      static std::vector<std::string> list();
+
+      private:
+      /** \cond */
+      struct Data;
+      Data *m_data;
+      /** \endcond */
+    };
+
+  } // namespace io
+}
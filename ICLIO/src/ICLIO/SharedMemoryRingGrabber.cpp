@@ -0,0 +1,166 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRingGrabber.cpp            **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/SharedMemoryRingGrabber.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Thread.h>
+#include <ICLUtils/Time.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    SharedMemoryRingGrabber::SharedMemoryRingGrabber(const std::string &name) throw (ICLException):
+      m_ring(name,SharedMemoryRing::Reader),m_buffer(0),m_last(0),m_overruns(0),m_skipped(0),
+      m_sequential(false),m_zeroCopy(false),m_timeout(1000),m_updatingProperties(false),
+      m_infoFormat((format)-1),m_infoSlots(0),m_infoOverruns(-1),m_infoSkipped(-1){
+      addProperty("mode","menu","newest,sequential","newest",0,
+                  "newest: always grab the newest frame, sequential: grab all frames in order");
+      addProperty("zero-copy","flag","",m_zeroCopy,0,"Whether to provide images that point directly into the shared memory");
+      addProperty("timeout","range:spinbox","[0,60000]",m_timeout,0,"Maximum time (in ms) to wait for a new frame");
+      addProperty("format","info","","unknown",0,"");
+      addProperty("size","info","","unknown",0,"");
+      addProperty("slots","info","","0",0,"Number of slots of the ring");
+      addProperty("sequence-number","info","","0",0,"Frame number of the last grabbed frame");
+      addProperty("overruns","info","","0",0,"Number of frames that were overwritten before they could be grabbed");
+      addProperty("skipped","info","","0",0,"Number of frames that were skipped in 'newest' mode");
+      Configurable::registerCallback(utils::function(this,&SharedMemoryRingGrabber::processPropertyChange));
+    }
+
+    SharedMemoryRingGrabber::~SharedMemoryRingGrabber(){
+      ICL_DELETE(m_buffer);
+    }
+
+    void SharedMemoryRingGrabber::updateInfoProperties(const ImgBase *image){
+      m_updatingProperties = true;
+      if(image->getFormat() != m_infoFormat){
+        m_infoFormat = image->getFormat();
+        setPropertyValue("format", Any(m_infoFormat));
+      }
+      if(image->getSize() != m_infoSize){
+        m_infoSize = image->getSize();
+        setPropertyValue("size", Any(m_infoSize));
+      }
+      if(m_ring.getNumSlots() != m_infoSlots){
+        m_infoSlots = m_ring.getNumSlots();
+        setPropertyValue("slots", m_infoSlots);
+      }
+      if(m_overruns != m_infoOverruns){
+        m_infoOverruns = m_overruns;
+        setPropertyValue("overruns", m_overruns);
+      }
+      if(m_skipped != m_infoSkipped){
+        m_infoSkipped = m_skipped;
+        setPropertyValue("skipped", m_skipped);
+      }
+      setPropertyValue("sequence-number", m_last);
+      m_updatingProperties = false;
+    }
+
+    const ImgBase *SharedMemoryRingGrabber::acquireImage(){
+      const Time deadline = Time::now() + Time::milliSeconds(m_timeout);
+      while(true){
+        const icl64s latest = m_ring.getLatestSequenceNumber();
+        if(latest < m_last){
+          // the publisher was restarted
+          m_last = 0;
+        }
+        if(latest > m_last){
+          icl64s seq = latest;
+          if(m_sequential){
+            // frames older than latest-numSlots+1 are already overwritten
+            const icl64s oldest = latest - m_ring.getNumSlots() + 1;
+            if(m_last && oldest > m_last + 1) m_overruns += oldest - m_last - 1;
+            seq = iclMax(m_last + 1, oldest);
+          }else if(m_last){
+            m_skipped += latest - m_last - 1;
+          }
+
+          SharedMemoryRing::Status status;
+          const ImgBase *image = 0;
+          if(m_zeroCopy){
+            image = m_ring.access(seq,&status);
+          }else{
+            status = m_ring.read(seq,&m_buffer);
+            image = m_buffer;
+          }
+
+          if(status == SharedMemoryRing::OK){
+            m_last = seq;
+            updateInfoProperties(image);
+            return image;
+          }else if(status == SharedMemoryRing::Overrun){
+            ++m_overruns;
+            m_last = seq;
+            continue;
+          }
+        }
+        if(Time::now() > deadline) return 0;
+        Thread::usleep(100);
+      }
+    }
+
+    bool SharedMemoryRingGrabber::isValid(){
+      return m_ring.isValid(m_last);
+    }
+
+    void SharedMemoryRingGrabber::processPropertyChange(const utils::Configurable::Property &prop){
+      if(m_updatingProperties) return;
+      if(prop.name == "mode"){
+        m_sequential = (prop.value == "sequential");
+      }else if(prop.name == "zero-copy"){
+        m_zeroCopy = parse<bool>(prop.value);
+      }else if(prop.name == "timeout"){
+        m_timeout = parse<int>(prop.value);
+      }
+    }
+
+    static Grabber *createSharedMemoryRingGrabber(const std::string &param){
+      return new SharedMemoryRingGrabber(param);
+    }
+
+    static const std::vector<GrabberDeviceDescription> &getSharedMemoryRingDeviceList(std::string filter, bool rescan){
+      static std::vector<GrabberDeviceDescription> deviceList;
+      if(!rescan) return deviceList;
+      deviceList.clear();
+      std::vector<std::string> names = SharedMemoryRing::list();
+      for(unsigned int i=0;i<names.size();++i){
+        if(filter.size() && filter != names[i]) continue;
+        deviceList.push_back(GrabberDeviceDescription("smr", names[i], "Lock-free shared memory ring buffer " + names[i]));
+      }
+      return deviceList;
+    }
+
+    REGISTER_GRABBER(smr,utils::function(createSharedMemoryRingGrabber),utils::function(getSharedMemoryRingDeviceList),"smr:ring name:lock-free shared memory ring buffer");
+
+  } // namespace io
+}
@@ -0,0 +1,110 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRingGrabber.h              **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLIO/Grabber.h>
+#include <ICLIO/SharedMemoryRing.h>
+
+namespace icl{
+  namespace io{
+
+    /// Grabber for images published via SharedMemoryRingPublisher \ingroup GRABBER_G
+    /** The grabber polls the ring for new frames; it never blocks the publisher.
+        Two modes are supported:
+        - <b>newest</b> (default): always the newest frame is returned; frames
+          that were published in between are skipped
+        - <b>sequential</b>: all frames are returned in order; if the grabber
+          is too slow, the frames that were already overwritten are counted
+          as overruns and skipped
+
+        If the "zero-copy" property is set, the returned images point directly
+        into the shared memory segment. In this case, the image must not be
+        modified, and it can be overwritten by the publisher while it is
+        processed. isValid() tells whether the last grabbed frame is still intact.
+
+        If no new frame is published within the "timeout" property (in ms,
+        1000 by default), acquireImage returns 0.
+
+        The grabber is available in the GenericGrabber as "smr" backend
+        (e.g. icl-camviewer -input smr myring). */
+    class ICLIO_API SharedMemoryRingGrabber : public Grabber{
+      public:
+
+      /// creates a grabber for the ring with the given name
+      /** The publisher does not need to exist yet */
+      SharedMemoryRingGrabber(const std::string &name) throw (utils::ICLException);
+
+      /// Destructor
+      ~SharedMemoryRingGrabber();
+
+      /// waits for the next frame and returns it (or 0 if the timeout elapsed)
+      virtual const core::ImgBase* acquireImage();
+
+      /// returns whether the last grabbed frame was not yet overwritten by the publisher
+      bool isValid();
+
+      /// returns the number of frames that were overwritten before they could be read
+      icl64s getOverrunCount() const { return m_overruns; }
+
+      /// returns the number of frames that were skipped in "newest" mode
+      icl64s getSkippedCount() const { return m_skipped; }
+
+      /// returns the frame number of the last grabbed frame
+      icl64s getSequenceNumber() const { return m_last; }
+
+      private:
+
+      /// callback function for property changes.
+      void processPropertyChange(const utils::Configurable::Property &p);
+
+      /// updates the info properties whose value changed
+      void updateInfoProperties(const core::ImgBase *image);
+
+      SharedMemoryRing m_ring;  //!< wrapped ring
+      core::ImgBase *m_buffer;  //!< destination image for copying frames
+      icl64s m_last;            //!< last grabbed frame number
+      icl64s m_overruns;        //!< number of overwritten frames
+      icl64s m_skipped;         //!< number of skipped frames
+      bool m_sequential;        //!< mode
+      bool m_zeroCopy;          //!< zero-copy access
+      int m_timeout;            //!< max. waiting time in ms
+      bool m_updatingProperties;
+
+      core::format m_infoFormat; //!< values of the info properties
+      utils::Size m_infoSize;
+      int m_infoSlots;
+      icl64s m_infoOverruns;
+      icl64s m_infoSkipped;
+    };
+
+  } // namespace io
+}
@@ -0,0 +1,60 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRingPublisher.cpp          **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/SharedMemoryRingPublisher.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    SharedMemoryRingPublisher::SharedMemoryRingPublisher(const std::string &name, int numSlots) throw (ICLException):
+      m_ring(name,SharedMemoryRing::Writer,numSlots){
+    }
+
+    void SharedMemoryRingPublisher::send(const ImgBase *image){
+      if(!image){
+        ERROR_LOG("unable to publish null image");
+        return;
+      }
+      m_ring.write(image);
+    }
+
+    icl64s SharedMemoryRingPublisher::getLatestSequenceNumber(){
+      return m_ring.getLatestSequenceNumber();
+    }
+
+    const std::string &SharedMemoryRingPublisher::getName() const{
+      return m_ring.getName();
+    }
+
+  } // namespace io
+}
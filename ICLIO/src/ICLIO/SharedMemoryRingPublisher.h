@@ -0,0 +1,68 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRingPublisher.h            **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLIO/ImageOutput.h>
+#include <ICLIO/SharedMemoryRing.h>
+
+namespace icl{
+  namespace io{
+
+    /// Image output that publishes images via a lock-free SharedMemoryRing
+    /** In contrast to the SharedMemoryPublisher, publishing never waits for the
+        readers: images are written into the next slot of the ring, and readers
+        that are too slow detect that they missed frames. Images are always
+        transferred uncompressed.
+
+        The publisher is available in the GenericImageOutput as "smr" backend
+        (e.g. icl-pipe -input dc 0 -o smr myring:8); the corresponding grabber
+        backend is also called "smr" (e.g. icl-camviewer -input smr myring). */
+    class ICLIO_API SharedMemoryRingPublisher : public ImageOutput{
+      SharedMemoryRing m_ring; //!< wrapped ring
+
+      public:
+
+      /// creates a new publisher with given ring name and number of slots
+      SharedMemoryRingPublisher(const std::string &name, int numSlots=4) throw (utils::ICLException);
+
+      /// publishes the given image
+      virtual void send(const core::ImgBase *image);
+
+      /// returns the frame number of the last published image
+      icl64s getLatestSequenceNumber();
+
+      /// returns the ring name
+      const std::string &getName() const;
+    };
+
+  } // namespace io
+}
@@ -104,11 +104,13 @@ namespace icl{
         ImgBase *imageOut;
         std::vector<icl8u> convertBuffer;
         ColorFormatDecoder decoder;
+        depth outputDepth;   // desired depth or -1 (applied while decoding)
+        format outputFormat; // desired format or -1 (applied while decoding)
         bool stoppedAlready;
 
         Impl(const std::string &deviceName, const std::string &initialFormat="", bool startGrabbing=true):
           deviceName(deviceName),isGrabbing(startGrabbing),avoidDoubleFrames(true),lastTime(Time::now()),
-          image(0),imageOut(0),stoppedAlready(false){
+          image(0),imageOut(0),outputDepth((depth)-1),outputFormat((format)-1),stoppedAlready(false){
           
           // note, \b is the word boundary special character (while $ is a line end which does not work so well here)
           if(deviceName.length() == 1 && match(deviceName,"^[0-9]\\b")){
@@ -479,12 +481,18 @@ namespace icl{
           if(deviceNameInfo == "Myrmex"){ // spezialization for the myrmex tactile device
             fourcc = FourCC("MYRM");
           }
-          decoder.decode(fourcc,p, currentSize, &image);
+          decoder.decode(fourcc,p, currentSize, &image, outputDepth, outputFormat);
           if(image) image->setTime(t);
         }
 
-        const ImgBase *acquireImage(){
+        const ImgBase *acquireImage(depth d, format fmt){
           Mutex::Locker lock(mutex);
+          if(d != outputDepth || fmt != outputFormat){
+            // the current image still has the old parameters
+            outputDepth = d;
+            outputFormat = fmt;
+            ICL_DELETE(image);
+          }
           while(!image || (avoidDoubleFrames && lastTime == image->getTime())){
             mutex.unlock();
             Thread::msleep(0);
@@ -709,7 +717,10 @@ namespace icl{
     const ImgBase *V4L2Grabber::acquireImage(){
       Mutex::Locker lock(implMutex);
       const ImgBase *image = 0;
-      do{ image = impl->acquireImage(); } while(!image || !image->getDim() );
+      // desired depth and format are directly produced by the decoder
+      const depth d = getDesired<depth>();
+      const format fmt = getDesired<format>();
+      do{ image = impl->acquireImage(d,fmt); } while(!image || !image->getDim() );
       return image;
     }
 
@@ -64,11 +64,20 @@ namespace icl{
         start();
       }
       void run(){
+        std::vector<icl8u> parts;
         while(running){
-          subscriber->recv(msg.get());
+          // images are sent as multi-part messages (one part per compressed chunk)
+          parts.clear();
+          int more = 0;
+          do{
+            subscriber->recv(msg.get());
+            const icl8u *d = (const icl8u*)msg->data();
+            parts.insert(parts.end(), d, d+msg->size());
+            size_t moreSize = sizeof(more);
+            subscriber->getsockopt(ZMQ_RCVMORE, &more, &moreSize);
+          }while(more);
           mutex.lock();
-          rbuf.resize(msg->size());
-          memcpy(&rbuf[0],msg->data(), msg->size());
+          rbuf.swap(parts);
           mutex.unlock();
         }
       }
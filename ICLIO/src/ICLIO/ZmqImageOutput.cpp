@@ -31,6 +31,7 @@
 #include <ICLIO/ZmqImageOutput.h>
 #include <zmq.hpp>
 #include <ICLUtils/StringUtils.h>
+#include <cstring>
 
 namespace icl{
   using namespace core;
@@ -43,6 +44,14 @@ namespace icl{
       SmartPtr<zmq::context_t> context;
       SmartPtr<zmq::socket_t> publisher;
       SmartPtr<zmq::message_t> message;
+      SmartPtr<zmq::message_t> pending; //!< last compressed chunk (not yet sent)
+      
+      /// sends the pending chunk as part of a multi-part message and keeps the given chunk
+      void sendChunk(const icl8u *data, int len){
+        if(pending) publisher->send(*pending,ZMQ_SNDMORE);
+        pending = new zmq::message_t(len);
+        memcpy(pending->data(),data,len);
+      }
     };
 
     
@@ -67,10 +76,13 @@ namespace icl{
     }
     
     void ZmqImageOutput::send(const core::ImgBase *image){
-      const CompressedData d = ImageCompressor::compress(image);
-      zmq::message_t m(d.bytes,d.len,0);
-      m_data->publisher->send(m);
-      
+      // compressed chunks are sent as soon as they are available;
+      // the last one completes the multi-part message
+      ImageCompressor::compress(image, utils::function(m_data,&Data::sendChunk));
+      if(m_data->pending){
+        m_data->publisher->send(*m_data->pending);
+        m_data->pending = SmartPtr<zmq::message_t>();
+      }
 
     }
 
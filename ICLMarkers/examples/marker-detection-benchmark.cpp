@@ -0,0 +1,150 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLMarkers/examples/marker-detection-benchmark.cpp     **
+** Module : ICLMarkers                                             **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLMarkers/FiducialDetector.h>
+#include <ICLMarkers/FiducialDetectorPluginForQuads.h>
+#include <ICLMarkers/BCHCode.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Random.h>
+#include <ICLUtils/Time.h>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::markers;
+
+// dense grid of bch markers on a noisy background
+static Img8u create_grid(const Size &size, int markerSize, float noise){
+  Img8u image(size,formatGray);
+  image.fill(230);
+  const int cell = markerSize + markerSize/3;
+  int id = 0;
+  for(int y=markerSize/6; y+markerSize<=size.height; y+=cell){
+    for(int x=markerSize/6; x+markerSize<=size.width; x+=cell){
+      Img8u m = BCHCoder::createMarkerImage(id++ % 4096, 2, Size(markerSize,markerSize));
+      image.setROI(Rect(x,y,markerSize,markerSize));
+      m.deepCopyROI(&image);
+    }
+  }
+  image.setFullROI();
+  icl8u *p = image.begin(0);
+  for(int i=0;i<size.getDim();++i){
+    p[i] = clipped_cast<float,icl8u>(p[i] + gaussRandom(0,noise));
+  }
+  return image;
+}
+
+static bool equal_quads(const std::vector<TiltedQuad> &a, const std::vector<TiltedQuad> &b){
+  if(a.size() != b.size()) return false;
+  for(unsigned int i=0;i<a.size();++i){
+    if(!std::equal(a[i].data(), a[i].data()+4, b[i].data())) return false;
+  }
+  return true;
+}
+
+// fiducials are only valid until the next detection call
+struct Marker{
+  int id;
+  Point32f center;
+  std::vector<Point32f> corners;
+  bool operator==(const Marker &m) const{
+    return id == m.id && center == m.center && corners == m.corners;
+  }
+};
+
+static std::vector<Marker> get_markers(const std::vector<Fiducial> &fids){
+  std::vector<Marker> ms(fids.size());
+  for(unsigned int i=0;i<fids.size();++i){
+    ms[i].id = fids[i].getID();
+    ms[i].center = fids[i].getCenter2D();
+    ms[i].corners = fids[i].getCorners2D();
+  }
+  return ms;
+}
+
+int main(int n, char **ppc){
+  pa_explain("-size","image size")
+            ("-marker-size","marker size in pixels (including the border)")
+            ("-noise","standard deviation of the gaussian image noise")
+            ("-runs","number of timed detection runs")
+            ("-threads","number of threads for the parallel configuration (0: ICL_NUM_THREADS or number of cores)");
+  pa_init(n,ppc,"-size|-s(Size=1280x960) -marker-size|-m(int=40) -noise(float=8) -runs|-r(int=20) -threads|-t(int=0)");
+
+  randomSeed();
+  const Img8u image = create_grid(pa("-size"), pa("-marker-size"), pa("-noise"));
+  const int runs = pa("-runs");
+
+  // all per-quad stages are compared with one and with all threads
+  const int nThreads = pa("-threads").as<int>() > 0 ? pa("-threads").as<int>() : TaskScheduler::getDefaultNumThreads();
+  std::vector<TiltedQuad> refQuads;
+  std::vector<Marker> refMarkers;
+
+  TextTable table;
+  table[0] = tok("threads,regions,quads,markers,quad detection [ms],total [ms],identical",",");
+  for(int c=0;c<2;++c){
+    const int t = c ? nThreads : 1;
+    TaskScheduler::setNumThreads(t);
+    FiducialDetector fd("bch","[0-4095]",ParamList("size",Size(30,30)));
+    QuadDetector &qd = dynamic_cast<FiducialDetectorPluginForQuads*>(fd.getPlugin())->getQuadDetector();
+
+    std::vector<TiltedQuad> quads = qd.detect(&image);
+    std::vector<Marker> markers = get_markers(fd.detect(&image));
+    const int regions = (int)qd.getAllCorners().size();
+
+    double tQuads = 0, tMarkers = 0;
+    for(int r=0;r<runs;++r){
+      Time tt = Time::now();
+      qd.detect(&image);
+      tQuads += tt.age().toMilliSecondsDouble();
+      tt = Time::now();
+      fd.detect(&image);
+      tMarkers += tt.age().toMilliSecondsDouble();
+    }
+    if(!c){
+      refQuads = quads;
+      refMarkers = markers;
+    }
+
+    const int row = table.getSize().height;
+    table(0,row) = str(t);
+    table(1,row) = str(regions);
+    table(2,row) = str(quads.size());
+    table(3,row) = str(markers.size());
+    table(4,row) = str(tQuads/runs);
+    table(5,row) = str(tMarkers/runs);
+    table(6,row) = (equal_quads(quads,refQuads) && markers == refMarkers) ? "yes" : "no";
+  }
+  std::cout << "image size: " << image.getSize() << "  marker size: " << pa("-marker-size").as<int>()
+            << "  runs: " << runs << std::endl;
+  std::cout << table << std::endl;
+}
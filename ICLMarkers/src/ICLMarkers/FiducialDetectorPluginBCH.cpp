@@ -32,6 +32,7 @@
 #include <ICLMarkers/FiducialDetectorPluginBCH.h>
 #include <ICLMarkers/BCHCode.h>
 #include <ICLMarkers/Fiducial.h>
+#include <ICLUtils/TaskScheduler.h>
 
 using namespace icl::utils;
 using namespace icl::math;
@@ -43,25 +44,29 @@ namespace icl{
   namespace markers{
     
     namespace{
+      // note: apply is called concurrently for several patches
       struct PatternBinarization{  
-        virtual void apply(icl8u *p) = 0;  
+        virtual void apply(icl8u *p) const = 0;  
         virtual ~PatternBinarization() {}
       };
       
       struct PatternBinarizationThresh : public PatternBinarization{
         int t;
         PatternBinarizationThresh(int t=0):t(t){}
-        virtual void apply(icl8u *p){
+        static void threshold(icl8u *p, int t){
           for(int i=0;i<36;++i) p[i] = 255*(p[i]>t);
         }
+        virtual void apply(icl8u *p) const{
+          threshold(p,t);
+        }
       };
       
-      struct PatternBinarizationKMeans : public PatternBinarizationThresh{
+      struct PatternBinarizationKMeans : public PatternBinarization{
         int maxIterations;
         PatternBinarizationKMeans(int maxIterations):
           maxIterations(maxIterations){}
   
-        virtual void apply(icl8u *p){
+        virtual void apply(icl8u *p) const{
           float mean = std::accumulate(p,p+36,0.0f)/36.0f;
           for(int j=0;j<maxIterations;++j){
             Point l,r;
@@ -70,28 +75,30 @@ namespace icl{
             }
             mean = round( (float(l[0])/l[1] + float(r[0])/r[1]) / 2  );
           }
-          PatternBinarizationThresh::t = mean;
-          PatternBinarizationThresh::apply(p);
+          PatternBinarizationThresh::threshold(p,mean);
         }
       };
     }
   
     struct FiducialDetectorPluginBCH::Data{
-      Img8u buffer;
+      /// decoding buffer and bch decoder (both are not thread-safe)
+      struct Decoder{
+        Img8u buffer;
+        BCHCoder bch;
+        Decoder():buffer(Size(6,6),1){}
+      };
+
+      std::vector<SmartPtr<Decoder> > decoders; //!< one decoder per thread
       std::bitset<4096> loaded;
       int maxLoaded;
       std::vector<Size32f> sizes;
   
       SmartPtr<PatternBinarization> bin;
       int maxBCHErr;
-      BCHCoder bch;
     };
     
     FiducialDetectorPluginBCH::FiducialDetectorPluginBCH():
       data(new Data){
-      data->buffer.setChannels(1);
-      data->buffer.setSize(Size(6,6));
-  
       data->loaded.reset();
       data->maxLoaded = -1;
       data->sizes.resize(4096);
@@ -158,16 +165,20 @@ namespace icl{
       }else{
         data->bin = new PatternBinarizationKMeans(getPropertyValue("binarize.k-means steps").as<int>());
       }
+      while((int)data->decoders.size() < TaskScheduler::instance().getNumThreads()){
+        data->decoders.push_back(new Data::Decoder);
+      }
     }
     
   
     FiducialImpl *FiducialDetectorPluginBCH::classifyPatch(const Img8u &image, int *rot, 
                                                            bool returnRejectedQuads, ImageRegion r){
-      image.scaledCopyROI(&data->buffer, interpolateRA);
+      Data::Decoder &d = *data->decoders[TaskScheduler::getCurrentWorkerIndex()+1];
+      image.scaledCopyROI(&d.buffer, interpolateRA);
       
-      data->bin->apply(data->buffer.begin(0));
+      data->bin->apply(d.buffer.begin(0));
       
-      DecodedBCHCode2D p = data->bch.decode2D(data->buffer,data->maxLoaded,false);
+      DecodedBCHCode2D p = d.bch.decode2D(d.buffer,data->maxLoaded,false);
   
       static Fiducial::FeatureSet supported = Fiducial::AllFeatures;
       static Fiducial::FeatureSet computed = ( Fiducial::Center2D | 
@@ -74,6 +74,9 @@ namespace icl{
   
       /// extracts and stores some properties locally to speed up classifyPatch 
       void prepareForPatchClassification();
+
+      /// bch decoding uses one decoding buffer per thread
+      virtual bool isPatchClassificationThreadSafe() const { return true; }
   
       /// Identifies the given image patch using bch decoding
       virtual FiducialImpl *classifyPatch(const core::Img8u &image, int *rot, bool returnRejectedQuads, cv::ImageRegion r);
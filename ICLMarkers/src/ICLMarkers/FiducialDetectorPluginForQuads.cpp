@@ -32,6 +32,7 @@
 #include <ICLMath/StraightLine2D.h>
 #include <ICLMath/Homography2D.h>
 #include <ICLFilter/ImageRectification.h>
+#include <ICLUtils/TaskScheduler.h>
 
 #include <ICLMarkers/FiducialDetectorPluginForQuads.h>
 #include <ICLMarkers/QuadDetector.h>
@@ -46,11 +47,70 @@ using namespace icl::filter;
 namespace icl{
   namespace markers{
   
+    namespace{
+      /// rectification and classification result of a single quad
+      struct QuadResult{
+        bool valid;                   //!< whether the quad could be rectified
+        Img8u rect;                   //!< rectified marker patch
+        FixedMatrix<float,3,3> hom;   //!< homography used for the rectification
+        FiducialImpl *impl;           //!< classification result (or null)
+        int rot;                      //!< marker rotation in units of 90 degree
+      };
+
+      typedef std::vector<SmartPtr<ImageRectification<icl8u> > > RectificationPool;
+
+      /// rectifies the quads [begin,end) using one ImageRectification instance per thread
+      struct RectifyQuads{
+        const std::vector<TiltedQuad> *quads;
+        const Img8u *image;
+        RectificationPool *rectifiers;
+        std::vector<QuadResult> *results;
+        Size size;
+        Rect roi;
+        int maxTilt;
+
+        void operator()(int begin, int end) const{
+          ImageRectification<icl8u> &rectify = *(*rectifiers)[TaskScheduler::getCurrentWorkerIndex()+1];
+          for(int i=begin;i<end;++i){
+            const TiltedQuad &q = (*quads)[i];
+            QuadResult &r = (*results)[i];
+            r.impl = 0;
+            r.rot = 0;
+            try {
+              rectify.apply(q.data(),*image,size,&r.hom,0,0,maxTilt,true,&roi).deepCopy(&r.rect);
+              r.rect.setROI(roi);
+              r.valid = true;
+            }catch(const ICLException&){
+              r.valid = false;
+            }
+          }
+        }
+      };
+
+      /// classifies the rectified patches of the quads [begin,end)
+      struct ClassifyQuads{
+        FiducialDetectorPluginForQuads *plugin;
+        const std::vector<TiltedQuad> *quads;
+        std::vector<QuadResult> *results;
+        bool returnRejected;
+
+        void operator()(int begin, int end) const{
+          for(int i=begin;i<end;++i){
+            QuadResult &r = (*results)[i];
+            if(r.valid){
+              r.impl = plugin->classifyPatch(r.rect, &r.rot, returnRejected, (*quads)[i].getRegion());
+            }
+          }
+        }
+      };
+    }
+
     struct FiducialDetectorPluginForQuads::Data{
       QuadDetector quadd;
       const std::vector<TiltedQuad> *quads;
       std::vector<FiducialImpl*> impls;
-      ImageRectification<icl8u> rectify;
+      RectificationPool rectifiers;  //!< one rectification buffer per thread
+      std::vector<QuadResult> results;
     };
     
     FiducialDetectorPluginForQuads::FiducialDetectorPluginForQuads():
@@ -180,38 +240,40 @@ namespace icl{
                      innerSize.width,innerSize.height);
       
   
-      FixedMatrix<float,3,3> HOM;
-  
+      if(!Rect(Point::null,s).contains(roi)){
+        ERROR_LOG(" FiducialDetectorPluginForQuads:: current plugin settings for the marker's"
+                  " inner and outer sizes do not allow to create an appropriate image ROI for"
+                  " rectification");
+        return;
+      }
+
       prepareForPatchClassification();
-   
-  
-      
-      for(unsigned int i=0;i<data->quads->size();++i){
-        const TiltedQuad &q = data->quads->operator[](i);
-        /// !! add some heuristics that skip detection of too tilted quads
-        
-        //#warning remove static here!
-        Img8u rect;
-        try {
-          rect = data->rectify.apply(q.data(),image,s,&HOM,0,0,m,true,&roi);
-          //static_data_set("rectified-image",Any::ptr(&rect));
-        }catch(const ICLException){ continue; }
-  
-        try{
-          rect.setROI(roi);
-        }catch(InvalidImgParamException&){
-          ERROR_LOG(" FiducialDetectorPluginForQuads:: current plugin settings for the marker's"
-                    " inner and outer sizes do not allow to create an appropriate image ROI for"
-                    " rectification");
-
-          return;
-        }
-  
-  
-  
-        int rot = 0;
-        FiducialImpl *impl = classifyPatch(rect, &rot,returnRejected,q.getRegion());
-        
+
+      // quads are rectified (and if possible classified) in parallel; the
+      // results are collected in quad order, so the output does not depend
+      // on the number of threads
+      const std::vector<TiltedQuad> &quads = *data->quads;
+      const int numThreads = TaskScheduler::instance().getNumThreads();
+      while((int)data->rectifiers.size() < numThreads){
+        data->rectifiers.push_back(new ImageRectification<icl8u>);
+      }
+      data->results.resize(quads.size());
+
+      RectifyQuads rectify = { &quads, &image, &data->rectifiers, &data->results, s, roi, m };
+      parallel_for(0, (int)quads.size(), rectify, 4);
+
+      ClassifyQuads classify = { this, &quads, &data->results, returnRejected };
+      if(isPatchClassificationThreadSafe()){
+        parallel_for(0, (int)quads.size(), classify, 4);
+      }else{
+        classify(0, (int)quads.size());
+      }
+
+      for(unsigned int i=0;i<quads.size();++i){
+        const TiltedQuad &q = quads[i];
+        const QuadResult &r = data->results[i];
+        FiducialImpl *impl = r.impl;
+
         if(impl){
           impl->index = data->impls.size();
           data->impls.push_back(impl);
@@ -219,7 +281,7 @@ namespace icl{
   
           FiducialImpl::Info2D *info2D = impl->ensure2D();
           info2D->infoCenter = get_intersection(q.data());
-          info2D->infoRotation = estimate_marker_rotation(HOM, rot, s, info2D->infoCenter);
+          info2D->infoRotation = estimate_marker_rotation(r.hom, r.rot, s, info2D->infoCenter);
           info2D->infoCorners.assign(q.data(),q.data()+4);
         }
       }
@@ -97,7 +97,14 @@ namespace icl{
           a certain implementation can read out and store all property values that are used
           in classify patch once in a whole image processing cylce */
       virtual void prepareForPatchClassification(){}
-  
+
+      /// returns whether classifyPatch can be called concurrently from several threads
+      /** The quads are always rectified in parallel. If this method returns true, also
+          classifyPatch is called in parallel for all rectified quads. Otherwise, the
+          patches are classified sequentially by the calling thread. In both cases,
+          the results are collected in quad order. Default implementation returns false */
+      virtual bool isPatchClassificationThreadSafe() const { return false; }
+
       /// this method must be called in the subclasses
       virtual FiducialImpl *classifyPatch(const core::Img8u &image, int *rot, bool returnRejectedQuads, cv::ImageRegion r) = 0;
       
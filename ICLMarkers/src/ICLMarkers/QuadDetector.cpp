@@ -41,6 +41,7 @@
 #include <ICLIO/FileWriter.h>
 #include <float.h>
 #include <ICLUtils/StackTimer.h>
+#include <ICLUtils/TaskScheduler.h>
 #include <ICLGeom/Camera.h>
 #include <ICLGeom/CoplanarPointPoseEstimator.h>
 
@@ -67,12 +68,43 @@ namespace icl {
           double aTanB = atan2(b.y - center.y, b.x - center.x);
           return (aTanA < aTanB);
         }
-      } clockSort;
+      };
 
     public:
 
       enum { APPROX_CSS, APPROX_RDP };
 
+      /// result of the corner computation for a single region
+      /** Regions are processed in parallel. Each region writes to its own
+          result, which are merged in region order afterwards. By this
+          means, the detection result does not depend on the number of threads */
+      struct RegionResult{
+        PVec corners;                                     //!< approximated region corners
+        PVec quad;                                        //!< resulting quad (if it has 4 corners)
+        PVecVec longest, secLongest, perp, inter, mirror; //!< debug information of the heuristics
+      };
+
+      /// contour approximation tools (one instance per thread)
+      struct Approximator{
+        CornerDetectorCSS css;
+        RDPApproximation rdp;
+      };
+
+      /// processes the regions [begin,end)
+      struct ProcessRegions{
+        Data *data;
+        const std::vector<ImageRegion> *rs;
+        bool optEdges;
+        float minRating;
+        bool useInter, usePerp, useMirror;
+
+        void operator()(int begin, int end) const;
+      };
+
+      /// computes the corners of the given region using the given approximation tools
+      static PVec computeCorners(const ImageRegion &r, int approxAlgorithm,
+                                 CornerDetectorCSS &css, RDPApproximation &rdp);
+
       //Debug information
       std::vector<std::vector<icl::utils::Point32f> > longestCorners;
       std::vector<std::vector<icl::utils::Point32f> > secLongestCorners;
@@ -131,6 +163,7 @@ namespace icl {
       }
 
       inline void orderClockWise(std::vector<Point32f> &points) {
+        ClockwiseSort clockSort;
         clockSort.center = Point32f(0, 0);
         for (unsigned i = 0; i < points.size(); i++) {
           clockSort.center += points[i];
@@ -141,7 +174,7 @@ namespace icl {
 
       std::vector<Point32f> getQCornersByMirror(Point32f &srcVecStart,
                                                 Point32f &srcVecEnd, int srcVecStartIdx, int srcVecEndIdx,
-                                                std::vector<Point32f> &allCorners) {
+                                                std::vector<Point32f> &allCorners, RegionResult &res) {
         std::vector<Point32f> qCorners;
         std::vector<Point32f> secLongest;
         Vec2 srcVec = getVector(srcVecStart, srcVecEnd);
@@ -181,7 +214,7 @@ namespace icl {
           secLongest.push_back(preSrcVecStart);
           secLongest.push_back(srcVecStart);
         }
-        secLongestCorners.push_back(secLongest);
+        res.secLongest.push_back(secLongest);
 
         qCorners.push_back(thirdCorner);
 
@@ -203,7 +236,7 @@ namespace icl {
 
       std::vector<Point32f> getQCornersByIntersection(Point32f &srcVecStart,
                                                       Point32f &srcVecEnd, int srcVecStartIdx, int srcVecEndIdx,
-                                                      std::vector<Point32f> &allCorners) {
+                                                      std::vector<Point32f> &allCorners, RegionResult &res) {
         std::vector<Point32f> qCorners;
         std::vector<Point32f> secLongest;
         int postSrcVecEndIdx = (srcVecEndIdx + 1 + allCorners.size()) % allCorners.size();
@@ -247,7 +280,7 @@ namespace icl {
           secLongest.push_back(srcVecStart);
         }
 
-        secLongestCorners.push_back(secLongest);
+        res.secLongest.push_back(secLongest);
 
         qCorners.push_back(thirdCorner);
         if (intersection2Vec.normalized() != intersectionVec.normalized() &&
@@ -357,7 +390,8 @@ namespace icl {
 #endif
       }
 
-      std::vector<Point32f> removeObstacleCorners(std::vector<Point32f> &corners, float minRating, bool useInterHeuristic, bool usePerpHeuristic, bool useMirrorHeuristic) {
+      std::vector<Point32f> removeObstacleCorners(std::vector<Point32f> &corners, float minRating, bool useInterHeuristic, bool usePerpHeuristic, bool useMirrorHeuristic,
+                                                  RegionResult &res) {
 
         std::vector<Point32f> quadCorners;
         if (useInterHeuristic || usePerpHeuristic || useMirrorHeuristic) {
@@ -383,7 +417,7 @@ namespace icl {
 
           longest.push_back(longestVecStart);
           longest.push_back(longestVecEnd);
-          longestCorners.push_back(longest);
+          res.longest.push_back(longest);
 
           std::vector<Point32f> cornersPerp;
           std::vector<Point32f> cornersInter;
@@ -399,13 +433,13 @@ namespace icl {
 #endif
 
           if (useInterHeuristic) {
-            cornersInter = getQCornersByIntersection(longestVecStart, longestVecEnd, longestVecStartIdx, longestVecEndIdx, corners);
+            cornersInter = getQCornersByIntersection(longestVecStart, longestVecEnd, longestVecStartIdx, longestVecEndIdx, corners, res);
             cornersInter.push_back(longestVecStart);
             cornersInter.push_back(longestVecEnd);
             orderClockWise(cornersInter);
             interRating = getQuadRating(cornersInter);
 
-            interCorners.push_back(cornersInter);
+            res.inter.push_back(cornersInter);
           }
           if (usePerpHeuristic) {
 
@@ -415,18 +449,18 @@ namespace icl {
             orderClockWise(cornersPerp);
             perpRating = getQuadRating(cornersPerp);
 
-            perpCorners.push_back(cornersPerp);
+            res.perp.push_back(cornersPerp);
           }
 
           if (useMirrorHeuristic) {
 
-            cornersMirror = getQCornersByMirror(longestVecStart, longestVecEnd, longestVecStartIdx, longestVecEndIdx, corners);
+            cornersMirror = getQCornersByMirror(longestVecStart, longestVecEnd, longestVecStartIdx, longestVecEndIdx, corners, res);
             cornersMirror.push_back(longestVecStart);
             cornersMirror.push_back(longestVecEnd);
             orderClockWise(cornersMirror);
             mirrorRating = getQuadRating(cornersMirror);
 
-            mirrorCorners.push_back(cornersMirror);
+            res.mirror.push_back(cornersMirror);
           }
 
           //                cout << "minRating " << minRating << "perpR " << perpRating << " interR " << interRating << " mirrR " << mirrorRating << endl;
@@ -467,11 +501,13 @@ namespace icl {
       }
 
       std::vector<TiltedQuad> quads;
+      std::vector<RegionResult> results;
 
       SmartPtr<RegionDetector> rd;
       CornerDetectorCSS css;
       RDPApproximation rdp;
       int approxAlgorithm;
+      std::vector<SmartPtr<Approximator> > approximators;
 
       SmartPtr<LocalThresholdOp> lt;
       SmartPtr<UnaryOp> pp;
@@ -483,6 +519,64 @@ namespace icl {
       ImgBase *lastBinImage;
     };
 
+    std::vector<Point32f> QuadDetector::Data::computeCorners(const ImageRegion &r, int approxAlgorithm,
+                                                             CornerDetectorCSS &css, RDPApproximation &rdp){
+      const std::vector<Point> &boundary = r.getBoundary();
+
+      switch (approxAlgorithm) {
+        case APPROX_RDP :
+          return rdp.approximate(boundary);
+        case APPROX_CSS :
+        default :
+          css.setSigma(iclMin(7.,boundary.size() * (3.2/60) - 0.5));
+          return css.detectCorners(boundary);
+      }
+    }
+
+    void QuadDetector::Data::ProcessRegions::operator()(int begin, int end) const{
+      Approximator &a = *data->approximators[TaskScheduler::getCurrentWorkerIndex()+1];
+      const bool useAnyHeuristic = useInter || usePerp || useMirror;
+
+      for(int i=begin;i<end;++i){
+        const ImageRegion &r = (*rs)[i];
+        RegionResult &res = data->results[i];
+        res.quad.clear();
+        res.longest.clear();
+        res.secLongest.clear();
+        res.perp.clear();
+        res.inter.clear();
+        res.mirror.clear();
+
+        const std::vector<Point> &boundary = r.getBoundary();
+        res.corners = computeCorners(r, data->approxAlgorithm, a.css, a.rdp);
+
+        if(useAnyHeuristic && (res.corners.size() > 4)){
+          PVec cornersCopy = data->removeObstacleCorners(res.corners, minRating,
+                                                         useInter, usePerp, useMirror, res);
+          if(cornersCopy.size() == 4){
+            if(optEdges){
+              // implement find corner subpix!
+            }
+            res.quad = cornersCopy;
+          }
+        }else{
+          if(res.corners.size() == 4){
+            if(optEdges) {
+              try{
+                PVec corners = res.corners;
+                optimize_edges(corners, boundary);
+                res.quad = corners;
+              }catch (int code) {
+                (void) code;
+              }
+            }else{
+              res.quad = res.corners;
+            }
+          }
+        }
+      }
+    }
+
     static const int RD_VALS[6] = { 0, 255, 0, 0, 255, 255 };
     QuadDetector::QuadDetector(QuadDetector::QuadColor c, bool dynamic,
                                float minRating) :
@@ -629,7 +723,6 @@ namespace icl {
       const bool useIntersectionHeuristic = getPropertyValue("intersection heuristic");
       const bool usePerpendicularHeuristic = getPropertyValue("perpendicular heuristic");
       const bool useMirrorHeuristic = getPropertyValue("mirror heuristic");
-      const bool useAnyHeuristic = useIntersectionHeuristic || usePerpendicularHeuristic || useMirrorHeuristic;
 
       data->approxAlgorithm = Data::APPROX_CSS;
       if (approxAlgorithm == "RDP") data->approxAlgorithm = Data::APPROX_RDP;
@@ -641,56 +734,44 @@ namespace icl {
       data->interCorners.clear();
       data->mirrorCorners.clear();
 
+      // the contour approximation tools are not thread-safe: each thread
+      // gets its own instances, that are parameterized like the global ones
+      const int numThreads = TaskScheduler::instance().getNumThreads();
+      while((int)data->approximators.size() < numThreads){
+        data->approximators.push_back(new Data::Approximator);
+      }
+      for(int i=0;i<numThreads;++i){
+        Data::Approximator &a = *data->approximators[i];
+        a.rdp = data->rdp;
+        a.css.setAngleThreshold(data->css.getAngleThreshold());
+        a.css.setRCCoeff(data->css.getRCCoeff());
+        a.css.setCurvatureCutoff(data->css.getCurvatureCutoff());
+        a.css.setStraightLineThreshold(data->css.getStraightLineThreshold());
+        a.css.setAccurate(data->css.getAccurate());
+      }
+
+      data->results.resize(rs.size());
+      Data::ProcessRegions proc = { data, &rs, optEdges, minRating, useIntersectionHeuristic,
+                                    usePerpendicularHeuristic, useMirrorHeuristic };
+      parallel_for(0, (int)rs.size(), proc, 8);
+
       for (unsigned int i = 0; i < rs.size(); ++i) {
-        const std::vector<Point> &boundary = rs[i].getBoundary();
-        //if(dynCSSSigma) {
-        //  data->css.setSigma(iclMin(7.,boundary.size() * (3.2/60) - 0.5));
-        //}
-        //PVec corners = data->css.detectCorners(boundary);
-        PVec corners = computeCorners(rs[i]);
-        
-        data->allCorners.push_back(corners);
-        if(useAnyHeuristic && (corners.size() > 4)){
-          PVec cornersCopy = data->removeObstacleCorners(corners,
-                                                    minRating,
-                                                    useIntersectionHeuristic,
-                                                    usePerpendicularHeuristic,
-                                                    useMirrorHeuristic);
-          if(cornersCopy.size() == 4){
-            if(optEdges){
-              // implement find corner subpix!
-            }
-            data->quads.push_back(TiltedQuad(cornersCopy.data(), rs[i]));
-          }
-        }else{
-          if(corners.size() == 4){
-            if(optEdges) {
-              try{
-                optimize_edges(corners, boundary); 
-                data->quads.push_back(TiltedQuad(corners.data(), rs[i]));
-              }catch (int code) {
-                (void) code;
-              }
-            }else{
-              data->quads.push_back(TiltedQuad(corners.data(), rs[i]));
-            }
-          }
+        const Data::RegionResult &res = data->results[i];
+        data->allCorners.push_back(res.corners);
+        data->longestCorners.insert(data->longestCorners.end(), res.longest.begin(), res.longest.end());
+        data->secLongestCorners.insert(data->secLongestCorners.end(), res.secLongest.begin(), res.secLongest.end());
+        data->perpCorners.insert(data->perpCorners.end(), res.perp.begin(), res.perp.end());
+        data->interCorners.insert(data->interCorners.end(), res.inter.begin(), res.inter.end());
+        data->mirrorCorners.insert(data->mirrorCorners.end(), res.mirror.begin(), res.mirror.end());
+        if(res.quad.size() == 4){
+          data->quads.push_back(TiltedQuad(res.quad.data(), rs[i]));
         }
       }
       return data->quads;
     }
 
     std::vector<Point32f> QuadDetector::computeCorners(const ImageRegion &r) const{
-      const std::vector<Point> &boundary = r.getBoundary();
-
-      switch (data->approxAlgorithm) {
-        case Data::APPROX_RDP :
-          return data->rdp.approximate(boundary);
-        case Data::APPROX_CSS :
-        default :
-          data->css.setSigma(iclMin(7.,boundary.size() * (3.2/60) - 0.5));
-          return data->css.detectCorners(boundary);
-      }
+      return Data::computeCorners(r, data->approxAlgorithm, data->css, data->rdp);
     }
 
     const QuadDetector::PVecVec &QuadDetector::getAllCorners() const{
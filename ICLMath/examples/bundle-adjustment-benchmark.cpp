@@ -0,0 +1,205 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLMath/examples/bundle-adjustment-benchmark.cpp       **
+** Module : ICLMath                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLMath/SparseBundleAdjuster.h>
+#include <ICLMath/FixedMatrix.h>
+#include <ICLMath/FixedVector.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Random.h>
+#include <ICLUtils/Time.h>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::math;
+
+typedef SparseBundleAdjuster<double> SBA;
+typedef FixedMatrix<double,3,3> Mat3;
+typedef FixedColVector<double,3> Vec3;
+
+// pinhole camera with fixed intrinsics, camera parameters are (rx,ry,rz,tx,ty,tz)
+static const double F = 500, CX = 320, CY = 240;
+
+static void project(const SBA::Vector &cam, const SBA::Vector &p, SBA::Vector &dst){
+  const Mat3 R = create_rot_3D<double>(cam[0],cam[1],cam[2]);
+  const Vec3 x = R*Vec3(p[0],p[1],p[2]) + Vec3(cam[3],cam[4],cam[5]);
+  dst[0] = F*x[0]/x[2] + CX;
+  dst[1] = F*x[1]/x[2] + CY;
+}
+
+// analytic derivatives for translation and point, central differences for the rotation
+static void jacobian(const SBA::Vector &cam, const SBA::Vector &p, SBA::Matrix &J){
+  const Mat3 R = create_rot_3D<double>(cam[0],cam[1],cam[2]);
+  const Vec3 x = R*Vec3(p[0],p[1],p[2]) + Vec3(cam[3],cam[4],cam[5]);
+  const double iz = 1.0/x[2], iz2 = iz*iz;
+  // d(u,v)/d(x,y,z) in camera coordinates
+  const double du[3] = { F*iz, 0, -F*x[0]*iz2 };
+  const double dv[3] = { 0, F*iz, -F*x[1]*iz2 };
+  for(int i=0;i<3;++i){
+    J(3+i,0) = du[i];
+    J(3+i,1) = dv[i];
+    J(6+i,0) = du[0]*R(i,0) + du[1]*R(i,1) + du[2]*R(i,2);
+    J(6+i,1) = dv[0]*R(i,0) + dv[1]*R(i,1) + dv[2]*R(i,2);
+  }
+  SBA::Vector c(6,cam.begin()), f1(2), f2(2);
+  const double delta = 1.e-6;
+  for(int i=0;i<3;++i){
+    c[i] = cam[i] + delta/2;
+    project(c,p,f1);
+    c[i] = cam[i] - delta/2;
+    project(c,p,f2);
+    c[i] = cam[i];
+    J(i,0) = (f1[0]-f2[0])/delta;
+    J(i,1) = (f1[1]-f2[1])/delta;
+  }
+}
+
+struct Problem{
+  SBA::Matrix cameras, points;
+  std::vector<SBA::Observation> observations;
+};
+
+// cameras on a circle around a cloud of points, looking at its center
+static Problem create_problem(int nc, int np, double noise, SBA::Matrix &realCameras){
+  Problem pr;
+  realCameras = SBA::Matrix(6,nc);
+  SBA::Matrix realPoints(3,np);
+  for(int i=0;i<np;++i){
+    for(int k=0;k<3;++k) realPoints(k,i) = random(-500.0,500.0);
+  }
+  for(int c=0;c<nc;++c){
+    const double a = 2*M_PI*c/nc;
+    realCameras(0,c) = random(-0.05,0.05);
+    realCameras(1,c) = a;
+    realCameras(2,c) = random(-0.05,0.05);
+    realCameras(3,c) = random(-50.0,50.0);
+    realCameras(4,c) = random(-50.0,50.0);
+    realCameras(5,c) = 3000;
+  }
+  SBA::Vector y(2);
+  for(int c=0;c<nc;++c){
+    const SBA::Vector cam(6,realCameras.row_begin(c),false);
+    for(int i=0;i<np;++i){
+      project(cam,SBA::Vector(3,realPoints.row_begin(i),false),y);
+      if(y[0] < 0 || y[0] >= 640 || y[1] < 0 || y[1] >= 480 || random(1.0) > 0.3) continue;
+      y[0] += gaussRandom(0,noise);
+      y[1] += gaussRandom(0,noise);
+      pr.observations.push_back(SBA::Observation(c,i,y));
+    }
+  }
+  pr.cameras = realCameras;
+  pr.points = realPoints;
+  for(int c=2;c<nc;++c){
+    for(int k=0;k<3;++k) pr.cameras(k,c) += gaussRandom(0,0.01);
+    for(int k=3;k<6;++k) pr.cameras(k,c) += gaussRandom(0,10);
+  }
+  for(int i=0;i<np;++i){
+    for(int k=0;k<3;++k) pr.points(k,i) += gaussRandom(0,10);
+  }
+  return pr;
+}
+
+int main(int n, char **ppc){
+  pa_explain("-cameras","number of cameras")
+            ("-points","number of points")
+            ("-noise","gaussian image noise [pixels]")
+            ("-numeric","use the numerical Jacobian instead of the (partially) analytic one")
+            ("-iterations","show per-iteration timing of the last configuration")
+            ("-threads","number of threads for the parallel configuration (0: ICL_NUM_THREADS or number of cores)");
+  pa_init(n,ppc,"-cameras|-c(int=100) -points|-p(int=5000) -noise(double=0.5) -numeric -iterations -threads|-t(int=0)");
+
+  randomSeed();
+  SBA::Matrix realCameras;
+  const Problem pr = create_problem(pa("-cameras"), pa("-points"), pa("-noise"), realCameras);
+
+  SBA sba(project, 2, pa("-numeric") ? SBA::Jacobian() : SBA::Jacobian(jacobian));
+  // the first two cameras fix the gauge (pose and scale)
+  std::vector<int> fixed(2);
+  fixed[1] = 1;
+  sba.setFixedCameras(fixed);
+
+  const int nThreads = pa("-threads").as<int>() > 0 ? pa("-threads").as<int>() : TaskScheduler::getDefaultNumThreads();
+  TextTable table;
+  table[0] = tok("threads,iterations,initial RMS [px],final RMS [px],camera error [mm],total [ms],jacobian [ms],schur [ms],solve [ms],evaluation [ms]",",");
+  SBA::Result r;
+  for(int c=0;c<2;++c){
+    TaskScheduler::setNumThreads(c ? nThreads : 1);
+    Time t = Time::now();
+    r = sba.fit(pr.cameras, pr.points, pr.observations);
+    const double total = t.age().toMilliSecondsDouble();
+    double tj = 0, ts = 0, tl = 0, te = 0, camError = 0;
+    for(unsigned int i=0;i<r.iterations.size();++i){
+      tj += r.iterations[i].jacobianTime;
+      ts += r.iterations[i].schurTime;
+      tl += r.iterations[i].solveTime;
+      te += r.iterations[i].evaluationTime;
+    }
+    for(unsigned int i=0;i<realCameras.rows();++i){
+      for(int k=3;k<6;++k) camError += sqr(r.cameras(k,i) - realCameras(k,i));
+    }
+    const int row = table.getSize().height;
+    const double N = pr.observations.size();
+    table(0,row) = str(c ? nThreads : 1);
+    table(1,row) = str(r.iteration);
+    table(2,row) = str(sqrt(2*r.initialError/N));
+    table(3,row) = str(sqrt(2*r.error/N));
+    table(4,row) = str(sqrt(camError/realCameras.rows()));
+    table(5,row) = str(total);
+    table(6,row) = str(tj);
+    table(7,row) = str(ts);
+    table(8,row) = str(tl);
+    table(9,row) = str(te);
+  }
+  std::cout << "cameras: " << pr.cameras.rows() << "  points: " << pr.points.rows()
+            << "  observations: " << pr.observations.size()
+            << "  reduced system: " << pr.cameras.rows()*6 << "x" << pr.cameras.rows()*6
+            << "  (dense normal equations: " << (pr.cameras.rows()*6 + pr.points.rows()*3) << "x"
+            << (pr.cameras.rows()*6 + pr.points.rows()*3) << ")" << std::endl;
+  std::cout << table << std::endl;
+
+  if(pa("-iterations")){
+    TextTable it;
+    it[0] = tok("iteration,error,lambda,accepted,jacobian [ms],schur [ms],solve [ms],evaluation [ms]",",");
+    for(unsigned int i=0;i<r.iterations.size();++i){
+      const SBA::IterationInfo &info = r.iterations[i];
+      it(0,i+1) = str(info.iteration);
+      it(1,i+1) = str(info.error);
+      it(2,i+1) = str(info.lambda);
+      it(3,i+1) = info.accepted ? "yes" : "no";
+      it(4,i+1) = str(info.jacobianTime);
+      it(5,i+1) = str(info.schurTime);
+      it(6,i+1) = str(info.solveTime);
+      it(7,i+1) = str(info.evaluationTime);
+    }
+    std::cout << it << std::endl;
+  }
+}
@@ -0,0 +1,155 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLMath/examples/kdtree-benchmark.cpp                  **
+** Module : ICLMath                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLMath/FlatKDTree.h>
+#include <ICLMath/KDTree.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Time.h>
+#include <cstdlib>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::math;
+
+typedef FlatKDTree<double> Tree;
+
+static double urand(){
+  return double(rand())/RAND_MAX;
+}
+
+static int brute_force_nn(const std::vector<double> &pts, int n, int dim, const double *q){
+  int best = -1;
+  double bestD = 0;
+  for(int i=0;i<n;++i){
+    double d = 0;
+    for(int j=0;j<dim;++j) d += sqr(pts[i*dim+j]-q[j]);
+    if(best < 0 || d < bestD){
+      best = i;
+      bestD = d;
+    }
+  }
+  return best;
+}
+
+static void add_row(TextTable &table, const std::string &method, double buildMs,
+                    double queryUs, double accuracy){
+  const int row = table.getSize().height;
+  table(0,row) = method;
+  table(1,row) = buildMs < 0 ? std::string("-") : str(buildMs);
+  table(2,row) = str(queryUs);
+  table(3,row) = str(accuracy*100);
+}
+
+int main(int n, char **ppc){
+  pa_explain("-n","number of points")
+            ("-q","number of query points")
+            ("-dim","point dimension")
+            ("-checks","maximum number of leaf checks for the approximate search")
+            ("-threads","number of threads for batch queries (0: ICL_NUM_THREADS or number of cores)");
+  pa_init(n,ppc,"-n(int=100000) -q(int=10000) -dim(int=3) -checks(int=32) -threads|-t(int=0)");
+
+  const int N = pa("-n"), Q = pa("-q"), dim = pa("-dim"), checks = pa("-checks");
+  TaskScheduler::setNumThreads(pa("-threads"));
+
+  std::vector<double> pts(N*dim), queries(Q*dim);
+  for(unsigned int i=0;i<pts.size();++i) pts[i] = urand();
+  for(unsigned int i=0;i<queries.size();++i) queries[i] = urand();
+
+  // ground truth with brute force (for a subset of the queries)
+  const int QB = iclMin(Q,500);
+  std::vector<int> truth(QB);
+  Time t = Time::now();
+  for(int i=0;i<QB;++i) truth[i] = brute_force_nn(pts,N,dim,&queries[i*dim]);
+  const double tBrute = t.age().toMicroSecondsDouble()/QB;
+
+  TextTable table;
+  table[0] = tok("method,build [ms],time per query [us],accuracy [%]",",");
+  add_row(table,"brute force",-1,tBrute,1);
+
+  // existing KDTree (DynMatrix points, single descent)
+  std::vector<DynMatrix<icl64f> > mats(N,DynMatrix<icl64f>(1,dim));
+  std::vector<DynMatrix<icl64f>*> matPtrs(N);
+  for(int i=0;i<N;++i){
+    std::copy(&pts[i*dim],&pts[i*dim]+dim,mats[i].begin());
+    matPtrs[i] = &mats[i];
+  }
+  t = Time::now();
+  KDTree old(matPtrs);
+  const double tOldBuild = t.age().toMilliSecondsDouble();
+  std::vector<DynMatrix<icl64f> > qmats(Q,DynMatrix<icl64f>(1,dim));
+  for(int i=0;i<Q;++i) std::copy(&queries[i*dim],&queries[i*dim]+dim,qmats[i].begin());
+  int correct = 0;
+  t = Time::now();
+  for(int i=0;i<Q;++i){
+    DynMatrix<icl64f> *p = old.nearestNeighbour(qmats[i]);
+    if(i < QB && p == &mats[truth[i]]) ++correct;
+  }
+  add_row(table,"KDTree",tOldBuild,t.age().toMicroSecondsDouble()/Q,double(correct)/QB);
+
+  // flat tree
+  t = Time::now();
+  Tree tree(&pts[0],N,dim);
+  const double tBuild = t.age().toMilliSecondsDouble();
+
+  std::vector<Tree::Neighbour> r;
+  correct = 0;
+  t = Time::now();
+  for(int i=0;i<Q;++i){
+    tree.knn(&queries[i*dim],1,r);
+    if(i < QB && r[0].index == truth[i]) ++correct;
+  }
+  add_row(table,"FlatKDTree knn",tBuild,t.age().toMicroSecondsDouble()/Q,double(correct)/QB);
+
+  correct = 0;
+  t = Time::now();
+  for(int i=0;i<Q;++i){
+    tree.knnApprox(&queries[i*dim],1,checks,r);
+    if(i < QB && r[0].index == truth[i]) ++correct;
+  }
+  add_row(table,"FlatKDTree knnApprox("+str(checks)+")",-1,t.age().toMicroSecondsDouble()/Q,double(correct)/QB);
+
+  t = Time::now();
+  tree.knnBatch(&queries[0],Q,1,r);
+  const double tBatch = t.age().toMicroSecondsDouble()/Q;
+  correct = 0;
+  for(int i=0;i<QB;++i) if(r[i].index == truth[i]) ++correct;
+  add_row(table,"FlatKDTree knnBatch",-1,tBatch,double(correct)/QB);
+
+  t = Time::now();
+  tree.knnBatch(&queries[0],Q,8,r);
+  add_row(table,"FlatKDTree knnBatch (k=8)",-1,t.age().toMicroSecondsDouble()/Q,1);
+
+  std::cout << "points: " << N << "  queries: " << Q << "  dim: " << dim
+            << "  threads: " << TaskScheduler::instance().getNumThreads() << std::endl;
+  std::cout << table << std::endl;
+}
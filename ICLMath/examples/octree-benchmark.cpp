@@ -0,0 +1,157 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLMath/examples/octree-benchmark.cpp                  **
+** Module : ICLMath                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+#include <ICLMath/Octree.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Time.h>
+#include <cstdlib>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::math;
+
+typedef Octree<float> Tree;
+typedef Tree::AABB AABB;
+typedef FixedColVector<float,4> Pt;
+
+static float urand(){
+  return 1000*float(rand())/RAND_MAX;
+}
+
+static float sqr_dist(const Pt &a, const Pt &b){
+  return sqr(a[0]-b[0]) + sqr(a[1]-b[1]) + sqr(a[2]-b[2]);
+}
+
+static void add_row(TextTable &table, const std::string &method, double us, double accuracy){
+  const int row = table.getSize().height;
+  table(0,row) = method;
+  table(1,row) = str(us);
+  table(2,row) = accuracy < 0 ? std::string("-") : str(accuracy*100);
+}
+
+int main(int n, char **ppc){
+  pa_explain("-n","number of points")
+            ("-q","number of query points")
+            ("-k","number of neighbours for knn queries")
+            ("-r","radius for radius queries (points are in [0,1000]^3)")
+            ("-threads","number of threads for batch queries (0: ICL_NUM_THREADS or number of cores)");
+  pa_init(n,ppc,"-n(int=300000) -q(int=20000) -k(int=8) -r(float=15) -threads|-t(int=0)");
+
+  const int N = pa("-n"), Q = pa("-q"), K = pa("-k");
+  const float R = pa("-r");
+  TaskScheduler::setNumThreads(pa("-threads"));
+
+  std::vector<Pt> pts(N,Pt(0,0,0,1)), queries(Q,Pt(0,0,0,1));
+  for(int i=0;i<N;++i) pts[i] = Pt(urand(),urand(),urand(),1);
+  for(int i=0;i<Q;++i) queries[i] = Pt(urand(),urand(),urand(),1);
+
+  Tree tree(0,1000);
+  Time t = Time::now();
+  tree.assign(pts.begin(),pts.end());
+  const double tBuild = t.age().toMilliSecondsDouble();
+  t = Time::now();
+  tree.assign(pts.begin(),pts.end());
+  const double tRebuild = t.age().toMilliSecondsDouble();
+
+  // brute force ground truth for a subset of the queries
+  const int QB = iclMin(Q,100);
+  std::vector<float> kthDist(QB);
+  std::vector<int> radiusCount(QB);
+  std::vector<float> d(N);
+  for(int i=0;i<QB;++i){
+    for(int j=0;j<N;++j) d[j] = sqr_dist(pts[j],queries[i]);
+    radiusCount[i] = 0;
+    for(int j=0;j<N;++j) radiusCount[i] += d[j] <= R*R;
+    std::nth_element(d.begin(),d.begin()+K-1,d.end());
+    kthDist[i] = d[K-1];
+  }
+
+  TextTable table;
+  table[0] = tok("method,time per query [us],correct [%]",",");
+
+  t = Time::now();
+  int correct = 0;
+  for(int i=0;i<Q;++i){
+    Pt p = tree.nn(queries[i]);
+    (void)p;
+  }
+  add_row(table,"nn",t.age().toMicroSecondsDouble()/Q,-1);
+
+  std::vector<int> idx;
+  std::vector<float> dists;
+  t = Time::now();
+  for(int i=0;i<Q;++i){
+    tree.knn(queries[i],K,idx,&dists);
+    if(i < QB && (int)dists.size() == K && dists.back() == kthDist[i]) ++correct;
+  }
+  add_row(table,"knn (k="+str(K)+")",t.age().toMicroSecondsDouble()/Q,double(correct)/QB);
+
+  t = Time::now();
+  tree.knnBatch(queries,K,idx,&dists);
+  const double tKnnBatch = t.age().toMicroSecondsDouble()/Q;
+  correct = 0;
+  for(int i=0;i<QB;++i) correct += dists[i*K+K-1] == kthDist[i];
+  add_row(table,"knnBatch (k="+str(K)+")",tKnnBatch,double(correct)/QB);
+
+  correct = 0;
+  t = Time::now();
+  for(int i=0;i<Q;++i){
+    tree.radius(queries[i],R,idx);
+    if(i < QB) correct += (int)idx.size() == radiusCount[i];
+  }
+  add_row(table,"radius (r="+str(R)+")",t.age().toMicroSecondsDouble()/Q,double(correct)/QB);
+
+  std::vector<std::vector<int> > ridx;
+  t = Time::now();
+  tree.radiusBatch(queries,R,ridx);
+  const double tRadiusBatch = t.age().toMicroSecondsDouble()/Q;
+  correct = 0;
+  for(int i=0;i<QB;++i) correct += (int)ridx[i].size() == radiusCount[i];
+  add_row(table,"radiusBatch (r="+str(R)+")",tRadiusBatch,double(correct)/QB);
+
+  t = Time::now();
+  for(int i=0;i<Q;++i){
+    std::vector<Pt> found = tree.query(queries[i][0]-R,queries[i][1]-R,queries[i][2]-R,2*R,2*R,2*R);
+  }
+  add_row(table,"query (box 2r)",t.age().toMicroSecondsDouble()/Q,-1);
+
+  t = Time::now();
+  for(int i=0;i<Q;++i){
+    tree.queryIndices(queries[i][0]-R,queries[i][1]-R,queries[i][2]-R,2*R,2*R,2*R,idx);
+  }
+  add_row(table,"queryIndices (box 2r)",t.age().toMicroSecondsDouble()/Q,-1);
+
+  std::cout << "points: " << N << "  queries: " << Q
+            << "  threads: " << TaskScheduler::instance().getNumThreads() << std::endl;
+  std::cout << "build: " << tBuild << " ms  rebuild (reusing nodes): " << tRebuild << " ms" << std::endl;
+  std::cout << table << std::endl;
+}
@@ -0,0 +1,129 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLMath/examples/ransac-benchmark.cpp                  **
+** Module : ICLMath                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+#include <ICLMath/RansacFitter.h>
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/TextTable.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Time.h>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::math;
+
+typedef std::vector<float> Point2D;
+typedef std::vector<float> Line; // normalized (a,b,c) with a*x + b*y + c = 0
+typedef RansacFitter<Point2D,Line> Fitter;
+
+// total least squares line fit
+static Line fit_line(const std::vector<Point2D> &pts){
+  double mx = 0, my = 0;
+  for(unsigned int i=0;i<pts.size();++i){
+    mx += pts[i][0];
+    my += pts[i][1];
+  }
+  mx /= pts.size();
+  my /= pts.size();
+  double sxx = 0, sxy = 0, syy = 0;
+  for(unsigned int i=0;i<pts.size();++i){
+    const double dx = pts[i][0]-mx, dy = pts[i][1]-my;
+    sxx += dx*dx;
+    sxy += dx*dy;
+    syy += dy*dy;
+  }
+  // normal is the eigenvector of the smaller eigenvalue
+  const double angle = 0.5 * atan2(2*sxy, sxx-syy) + M_PI/2;
+  Line l(3);
+  l[0] = cos(angle);
+  l[1] = sin(angle);
+  l[2] = -(l[0]*mx + l[1]*my);
+  return l;
+}
+
+static icl64f line_dist(const Line &l, const Point2D &p){
+  return fabs(l[0]*p[0] + l[1]*p[1] + l[2]);
+}
+
+int main(int n, char **ppc){
+  pa_explain("-n","number of points")
+            ("-outliers","outlier ratio")
+            ("-fits","number of fit calls per configuration")
+            ("-iterations","maximum number of RANSAC iterations")
+            ("-threads","number of threads for the parallel configuration (0: ICL_NUM_THREADS or number of cores)");
+  pa_init(n,ppc,"-n(int=1000) -outliers(float=0.5) -fits(int=100) -iterations(int=1000) -threads|-t(int=0)");
+
+  const int N = pa("-n"), F = pa("-fits"), I = pa("-iterations");
+  const float outliers = pa("-outliers");
+  TaskScheduler::setNumThreads(pa("-threads"));
+
+  // line y = 0.5x + 10 with gaussian noise, outliers uniformly distributed;
+  // inliers come first, which is the ordering expected by progressive sampling
+  randomSeed();
+  std::vector<Point2D> pts(N,Point2D(2));
+  for(int i=0;i<N;++i){
+    if(i < N*(1-outliers)){
+      pts[i][0] = random(0.0,100.0);
+      pts[i][1] = 0.5*pts[i][0] + 10 + gaussRandom(0,0.5);
+    }else{
+      pts[i][0] = random(0.0,100.0);
+      pts[i][1] = random(0.0,100.0);
+    }
+  }
+
+  TextTable table;
+  table[0] = tok("configuration,time per fit [ms],iterations,inliers,error",",");
+  const char *names[] = { "fixed iterations", "adaptive (p=0.99)", "adaptive + T(1,1)",
+                          "adaptive + T(1,1) + PROSAC", "adaptive + T(1,1) + parallel" };
+  for(int c=0;c<5;++c){
+    Fitter fitter(2, I, fit_line, line_dist, 1.5, N*(1-outliers)/2);
+    if(c >= 1) fitter.setConfidence(0.99);
+    if(c >= 2) fitter.setPreTestPoints(1);
+    fitter.setProgressiveSampling(c == 3);
+    fitter.setParallel(c == 4);
+
+    double iterations = 0, inliers = 0, error = 0;
+    Time t = Time::now();
+    for(int i=0;i<F;++i){
+      const Fitter::Result &r = fitter.fit(pts);
+      iterations += r.iterationCount;
+      inliers += r.consensusSet.size();
+      error += r.error;
+    }
+    const int row = table.getSize().height;
+    table(0,row) = names[c];
+    table(1,row) = str(t.age().toMilliSecondsDouble()/F);
+    table(2,row) = str(iterations/F);
+    table(3,row) = str(inliers/F);
+    table(4,row) = str(error/F);
+  }
+  std::cout << "points: " << N << "  outliers: " << outliers*100 << "%"
+            << "  threads: " << TaskScheduler::instance().getNumThreads() << std::endl;
+  std::cout << table << std::endl;
+}
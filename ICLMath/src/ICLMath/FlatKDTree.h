@@ -0,0 +1,409 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLMath/src/ICLMath/FlatKDTree.h                       **
+** Module : ICLMath                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Macros.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+namespace icl{
+  namespace math{
+
+    /// Cache-friendly kd-tree with contiguous node and point storage
+    /** In contrast to the KDTree class, the FlatKDTree copies all points into
+        a single contiguous array, that is reordered such that the points of
+        each leaf are stored consecutively. Nodes are stored in a single
+        std::vector in depth-first order (the left child of a node is always
+        the next node), so no per-node heap allocations are needed.
+
+        \section TPL Template Parameters
+        * T scalar type (usually float or double)
+        * DIM compile-time dimension. If DIM is 0, the dimension is given at
+          run-time to the constructor or to build. A compile-time dimension
+          allows the compiler to unroll the distance computations.
+
+        \section BUILD Building
+        Each node splits its points at the median of the dimension with the
+        largest spread (using std::nth_element), which results in a balanced
+        tree built in O(n log n). Nodes with at most leafSize points become
+        leaves.
+
+        \section QUERIES Queries
+        * nearest and knn: exact k-nearest-neighbour search using incremental
+          distance bounds (Arya and Mount)
+        * radius: all points within a given radius
+        * knnApprox: approximate best-bin-first search, that checks at most a
+          given number of leaves
+        * knnBatch and radiusBatch: process many queries in parallel using
+          utils::parallel_for
+
+        Points are always identified by their index in the data, that was
+        passed to build. All distances are squared euclidean distances.
+
+        \code
+        std::vector<float> pts = ...; // n 3D-points (x,y,z,x,y,z,...)
+        FlatKDTree<float,3> tree(pts.data(),n);
+        std::vector<FlatKDTree<float,3>::Neighbour> nn;
+        float q[3] = {1,2,3};
+        tree.knn(q,5,nn);
+        \endcode
+    */
+    template<class T, int DIM=0>
+    class FlatKDTree{
+      public:
+
+      /// search result
+      struct Neighbour{
+        int index;  //!< index of the point (as passed to build)
+        T dist2;    //!< squared distance to the query point
+
+        /// constructor
+        Neighbour(int index=-1, T dist2=std::numeric_limits<T>::max()):index(index),dist2(dist2){}
+
+        /// comparison by distance
+        bool operator<(const Neighbour &n) const { return dist2 < n.dist2; }
+      };
+
+      /// creates an empty tree
+      FlatKDTree(int leafSize=8):m_dim(DIM),m_leafSize(iclMax(1,leafSize)){}
+
+      /// creates a tree from n points with given dimension (stored as x0,y0,..,x1,y1,..)
+      FlatKDTree(const T *data, int n, int dim=DIM, int leafSize=8):m_dim(DIM),m_leafSize(iclMax(1,leafSize)){
+        build(data,n,dim);
+      }
+
+      /// (re-)builds the tree from n points with given dimension
+      /** The data is copied */
+      void build(const T *data, int n, int dim=DIM){
+        ICLASSERT_RETURN(DIM == 0 || dim == DIM);
+        ICLASSERT_RETURN(dim > 0 && n >= 0);
+        m_dim = dim;
+        m_nodes.clear();
+        m_indices.resize(n);
+        for(int i=0;i<n;++i) m_indices[i] = i;
+        if(!n){
+          m_points.clear();
+          return;
+        }
+        m_nodes.reserve(2*(n/m_leafSize+1));
+        build_node(data,0,n);
+
+        // reorder points, so that leaf points are contiguous
+        m_points.resize((size_t)n*dim);
+        m_positions.resize(n);
+        for(int i=0;i<n;++i){
+          std::copy(data+(size_t)m_indices[i]*dim,data+(size_t)(m_indices[i]+1)*dim,&m_points[(size_t)i*dim]);
+          m_positions[m_indices[i]] = i;
+        }
+      }
+
+      /// returns the number of points
+      int size() const { return (int)m_indices.size(); }
+
+      /// returns the point dimension
+      int getDim() const { return DIM ? DIM : m_dim; }
+
+      /// returns the number of tree nodes
+      int getNumNodes() const { return (int)m_nodes.size(); }
+
+      /// returns the point with given index (as passed to build)
+      const T *getPoint(int index) const { return &m_points[(size_t)m_positions[index]*getDim()]; }
+
+      /// returns the index of the nearest neighbour (-1 if the tree is empty)
+      int nearest(const T *q, T *dist2=0) const{
+        std::vector<Neighbour> r;
+        knn(q,1,r);
+        if(dist2) *dist2 = r.size() ? r[0].dist2 : std::numeric_limits<T>::max();
+        return r.size() ? r[0].index : -1;
+      }
+
+      /// exact k-nearest-neighbour search (results are sorted by distance)
+      void knn(const T *q, int k, std::vector<Neighbour> &result) const{
+        result.clear();
+        if(!size() || k <= 0) return;
+        std::vector<T> off(getDim(),T(0));
+        Heap heap(result,iclMin(k,size()),std::numeric_limits<T>::max());
+        search(0,q,0,&off[0],heap);
+        std::sort_heap(result.begin(),result.end());
+      }
+
+      /// finds all points within the given radius
+      void radius(const T *q, T r, std::vector<Neighbour> &result, bool sortResult=true) const{
+        result.clear();
+        if(!size()) return;
+        std::vector<T> off(getDim(),T(0));
+        Heap heap(result,0,r*r);
+        search(0,q,0,&off[0],heap);
+        if(sortResult) std::sort(result.begin(),result.end());
+      }
+
+      /// approximate k-nearest-neighbour search (best-bin-first)
+      /** At most maxLeafChecks leaves are examined. Branches are visited in order
+          of their distance to the query. If maxLeafChecks is <= 0, the search
+          is exact. Results are sorted by distance. */
+      void knnApprox(const T *q, int k, int maxLeafChecks, std::vector<Neighbour> &result) const{
+        if(maxLeafChecks <= 0){
+          knn(q,k,result);
+          return;
+        }
+        result.clear();
+        if(!size() || k <= 0) return;
+        Heap heap(result,iclMin(k,size()),std::numeric_limits<T>::max());
+        std::vector<Branch> branches;
+        branches.push_back(Branch(0,0));
+        int checked = 0;
+        while(branches.size() && checked < maxLeafChecks){
+          std::pop_heap(branches.begin(),branches.end());
+          const Branch b = branches.back();
+          branches.pop_back();
+          if(b.dist2 >= heap.worst()) break;
+          int node = b.node;
+          while(m_nodes[node].dim >= 0){
+            const Node &n = m_nodes[node];
+            const T diff = q[n.dim] - n.split;
+            const int nearNode = diff < 0 ? node+1 : n.right;
+            const int farNode = diff < 0 ? n.right : node+1;
+            branches.push_back(Branch(farNode,iclMax(b.dist2,diff*diff)));
+            std::push_heap(branches.begin(),branches.end());
+            node = nearNode;
+          }
+          check_leaf(m_nodes[node],q,heap);
+          ++checked;
+        }
+        std::sort_heap(result.begin(),result.end());
+      }
+
+      /// parallel k-nearest-neighbour search for nQueries query points
+      /** The results for query i are stored at results[i*k ... i*k+k-1], sorted
+          by distance. If the tree contains less than k points, the remaining
+          entries have index -1. If maxLeafChecks is > 0, knnApprox is used. */
+      void knnBatch(const T *queries, int nQueries, int k, std::vector<Neighbour> &results,
+                    int maxLeafChecks=0) const{
+        results.assign((size_t)iclMax(nQueries,0)*iclMax(k,0),Neighbour());
+        if(k <= 0 || nQueries <= 0) return;
+        BatchKnn b = { this, queries, k, maxLeafChecks, &results[0] };
+        utils::parallel_for(0,nQueries,b,BATCH_GRAIN);
+      }
+
+      /// parallel radius search for nQueries query points
+      void radiusBatch(const T *queries, int nQueries, T r,
+                       std::vector<std::vector<Neighbour> > &results, bool sortResults=true) const{
+        results.resize(iclMax(nQueries,0));
+        if(nQueries <= 0) return;
+        BatchRadius b = { this, queries, r, sortResults, &results[0] };
+        utils::parallel_for(0,nQueries,b,BATCH_GRAIN);
+      }
+
+      private:
+
+      /// number of queries per parallel task
+      static const int BATCH_GRAIN = 64;
+
+      /// tree node (dim is -1 for leaves)
+      struct Node{
+        int dim;    //!< split dimension (-1 for leaves)
+        T split;    //!< split value
+        int right;  //!< index of the right child (the left child is the next node)
+        int begin;  //!< first point (leaves only)
+        int end;    //!< end of the point range (leaves only)
+      };
+
+      /// bounded max-heap of the best results found so far
+      struct Heap{
+        std::vector<Neighbour> &r;
+        int k;     //!< maximum size (0 for unbounded radius search)
+        T bound;   //!< fixed bound (radius search)
+
+        Heap(std::vector<Neighbour> &r, int k, T bound):r(r),k(k),bound(bound){}
+
+        inline T worst() const{
+          return (!k || (int)r.size() < k) ? bound : r.front().dist2;
+        }
+
+        inline void push(int index, T dist2){
+          if(!k){
+            r.push_back(Neighbour(index,dist2));
+          }else if((int)r.size() < k){
+            r.push_back(Neighbour(index,dist2));
+            std::push_heap(r.begin(),r.end());
+          }else{
+            std::pop_heap(r.begin(),r.end());
+            r.back() = Neighbour(index,dist2);
+            std::push_heap(r.begin(),r.end());
+          }
+        }
+      };
+
+      /// pending branch for best-bin-first search
+      struct Branch{
+        int node;
+        T dist2;
+        Branch(int node, T dist2):node(node),dist2(dist2){}
+        // reversed, so that std heap functions yield the closest branch first
+        bool operator<(const Branch &b) const { return dist2 > b.dist2; }
+      };
+
+      /// compares point indices by one coordinate
+      struct CoordLess{
+        const T *data;
+        int dim, d;
+        bool operator()(int a, int b) const{
+          return data[(size_t)a*dim+d] < data[(size_t)b*dim+d];
+        }
+      };
+
+      struct BatchKnn{
+        const FlatKDTree *t;
+        const T *queries;
+        int k, maxLeafChecks;
+        Neighbour *results;
+        void operator()(int begin, int end) const{
+          std::vector<Neighbour> r;
+          const int dim = t->getDim();
+          for(int i=begin;i<end;++i){
+            t->knnApprox(queries+(size_t)i*dim,k,maxLeafChecks,r);
+            std::copy(r.begin(),r.end(),results+(size_t)i*k);
+          }
+        }
+      };
+
+      struct BatchRadius{
+        const FlatKDTree *t;
+        const T *queries;
+        T r;
+        bool sortResults;
+        std::vector<Neighbour> *results;
+        void operator()(int begin, int end) const{
+          const int dim = t->getDim();
+          for(int i=begin;i<end;++i){
+            t->radius(queries+(size_t)i*dim,r,results[i],sortResults);
+          }
+        }
+      };
+
+      int build_node(const T *data, int begin, int end){
+        const int idx = (int)m_nodes.size();
+        m_nodes.push_back(Node());
+        Node n;
+        n.dim = -1;
+        n.split = 0;
+        n.right = -1;
+        n.begin = begin;
+        n.end = end;
+        if(end-begin > m_leafSize){
+          // split dimension: largest spread
+          const int dim = getDim();
+          T bestSpread = -1;
+          for(int d=0;d<dim;++d){
+            T lo = data[(size_t)m_indices[begin]*dim+d], hi = lo;
+            for(int i=begin+1;i<end;++i){
+              const T v = data[(size_t)m_indices[i]*dim+d];
+              if(v < lo) lo = v;
+              else if(v > hi) hi = v;
+            }
+            if(hi-lo > bestSpread){
+              bestSpread = hi-lo;
+              n.dim = d;
+            }
+          }
+          const int mid = begin + (end-begin)/2;
+          CoordLess less = { data, dim, n.dim };
+          std::nth_element(m_indices.begin()+begin,m_indices.begin()+mid,m_indices.begin()+end,less);
+          n.split = data[(size_t)m_indices[mid]*dim+n.dim];
+          build_node(data,begin,mid);
+          n.right = build_node(data,mid,end);
+        }
+        m_nodes[idx] = n;
+        return idx;
+      }
+
+      /// squared distance, the summation is stopped once it exceeds bound (partial distance search)
+      inline T dist2(const T *a, const T *b, T bound) const{
+        const int dim = getDim();
+        T s = 0;
+        int i = 0;
+        for(;i<=dim-4;i+=4){
+          const T d0 = a[i]-b[i], d1 = a[i+1]-b[i+1], d2 = a[i+2]-b[i+2], d3 = a[i+3]-b[i+3];
+          s += (d0*d0 + d1*d1) + (d2*d2 + d3*d3);
+          if(s > bound) return s;
+        }
+        for(;i<dim;++i){
+          const T d = a[i]-b[i];
+          s += d*d;
+        }
+        return s;
+      }
+
+      inline void check_leaf(const Node &n, const T *q, Heap &heap) const{
+        const int dim = getDim();
+        const T *p = &m_points[(size_t)n.begin*dim];
+        for(int i=n.begin;i<n.end;++i,p+=dim){
+          const T w = heap.worst();
+          const T d = dist2(q,p,w);
+          if(d < w || (!heap.k && d <= heap.bound)) heap.push(m_indices[i],d);
+        }
+      }
+
+      /// exact search with incremental distance bounds
+      /** rd is the squared distance of the query to the node's cell and off
+          contains the per dimension offsets, rd is composed of */
+      void search(int node, const T *q, T rd, T *off, Heap &heap) const{
+        const Node &n = m_nodes[node];
+        if(n.dim < 0){
+          check_leaf(n,q,heap);
+          return;
+        }
+        const T diff = q[n.dim] - n.split;
+        const int nearNode = diff < 0 ? node+1 : n.right;
+        const int farNode = diff < 0 ? n.right : node+1;
+        search(nearNode,q,rd,off,heap);
+        const T old = off[n.dim];
+        const T farRd = rd - old*old + diff*diff;
+        if(farRd < heap.worst() || (!heap.k && farRd <= heap.bound)){
+          off[n.dim] = diff;
+          search(farNode,q,farRd,off,heap);
+          off[n.dim] = old;
+        }
+      }
+
+      int m_dim;                     //!< run-time dimension (if DIM is 0)
+      int m_leafSize;                //!< maximum number of points per leaf
+      std::vector<Node> m_nodes;     //!< nodes in depth-first order
+      std::vector<T> m_points;       //!< reordered point data
+      std::vector<int> m_indices;    //!< original index of each reordered point
+      std::vector<int> m_positions;  //!< reordered position of each original point
+    };
+
+  } // namespace math
+} // namespace icl
@@ -46,7 +46,10 @@ namespace icl{
         data points. 
         <b>Note:</b> If point data was passed to the KD-Tree constructor, it only references
         by the KD-Tree instance. Therefore, that tree instance will only stay valid as long as
-        the referenced data does
+        the referenced data does.
+        <b>Note:</b> nearestNeighbour only descends to a single leaf and therefore does not
+        always find the actual nearest neighbour. For exact k-nearest-neighbour, radius and
+        batch queries, the much faster FlatKDTree class template should be used.
     */
     class ICLMath_API KDTree : public utils::Uncopyable{
       private:
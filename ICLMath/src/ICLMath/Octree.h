@@ -28,6 +28,7 @@
 **                                                                 **
 ********************************************************************/
 
+
 #pragma once
 
 
@@ -36,6 +37,8 @@
 #include <ICLUtils/Rect32f.h>
 #include <ICLUtils/Range.h>
 #include <ICLUtils/StringUtils.h>
+#include <ICLUtils/SSETypes.h>
+#include <ICLUtils/TaskScheduler.h>
 #include <ICLMath/FixedVector.h>
 
 #include <algorithm>
@@ -45,6 +48,40 @@ namespace icl{
 
   namespace math{
     
+    /** \cond */
+    namespace octree_internal{
+      /// computes the squared distances of n structure-of-arrays points to q
+      template<class Scalar>
+      struct LeafScan{
+        static inline void sqr_dists(const Scalar *xs, const Scalar *ys, const Scalar *zs, int n,
+                                     const Scalar *q, Scalar *d){
+          for(int i=0;i<n;++i){
+            d[i] = utils::sqr(xs[i]-q[0]) + utils::sqr(ys[i]-q[1]) + utils::sqr(zs[i]-q[2]);
+          }
+        }
+      };
+
+  #ifdef ICL_HAVE_SSE2
+      template<>
+      struct LeafScan<float>{
+        static inline void sqr_dists(const float *xs, const float *ys, const float *zs, int n,
+                                     const float *q, float *d){
+          const __m128 qx = _mm_set1_ps(q[0]), qy = _mm_set1_ps(q[1]), qz = _mm_set1_ps(q[2]);
+          int i = 0;
+          for(;i<n-3;i+=4){
+            const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs+i),qx);
+            const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys+i),qy);
+            const __m128 dz = _mm_sub_ps(_mm_loadu_ps(zs+i),qz);
+            _mm_storeu_ps(d+i,_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx,dx),_mm_mul_ps(dy,dy)),_mm_mul_ps(dz,dz)));
+          }
+          for(;i<n;++i){
+            d[i] = utils::sqr(xs[i]-q[0]) + utils::sqr(ys[i]-q[1]) + utils::sqr(zs[i]-q[2]);
+          }
+        }
+      };
+  #endif
+    }
+    /** \endcond */
 
     /// Generic Octree Implementation
     /** The Octree implementation is a simple 3D-generalization of the 
@@ -54,7 +91,23 @@ namespace icl{
         
         Even though, we do not have any reliable results, it might be
         possible, that the octree is much faster then the pcl-octree!
-        
+
+        \section IDX Index based Queries
+        Each point gets the index of its insertion (counted from the last
+        call to clear() or assign()). The queryIndices(), knn() and radius()
+        methods and their batch variants (knnBatch() and radiusBatch(), which
+        are parallelized using utils::parallel_for) return these indices
+        rather than point copies. Please note, that the Octree's pruning
+        assumes all points to be inside the root bounding box.
+
+        \section SOA Memory Layout
+        Each node stores the x-, y- and z-coordinates of its points in a
+        structure-of-arrays layout, which allows for SIMD based distance
+        computation (for float-Octrees, if SSE2 is available). Only these
+        three coordinates are stored, i.e. all points returned by the query
+        functions have a homogeneous component of 1 (see Node::point).
+        The nodes are allocated in chunks. These are not freed by clear(),
+        so re-filling an Octree does not need any new allocations.
     **/
     template<class Scalar, int CAPACITY=16, int SF=1, class Pt=FixedColVector<Scalar,4>, int ALLOC_CHUNK_SIZE=1024>
     class Octree{
@@ -91,6 +144,16 @@ namespace icl{
                    && fabs(center[2] - o.center[2]) < (halfSize[2] + o.halfSize[2]));
                    
         }
+
+        /// returns the squared distance of the given point to the AABB (0 if contained)
+        Scalar sqrDist(const Scalar *q) const{
+          Scalar d = 0;
+          for(int i=0;i<3;++i){
+            const Scalar a = fabs(q[i] - center[i]) - halfSize[i];
+            if(a > 0) d += a*a;
+          }
+          return d;
+        }
       };
       
       /// Internally used node structure
@@ -98,8 +161,11 @@ namespace icl{
           are distributed to one of the four children */
       struct Node{
         AABB boundary;         //!< node boundary
-        Pt points[CAPACITY];   //!< contained nodes
-        Pt *next;              //!< next node to fill 
+        Scalar xs[CAPACITY];   //!< x-coordinates of the contained points
+        Scalar ys[CAPACITY];   //!< y-coordinates of the contained points
+        Scalar zs[CAPACITY];   //!< z-coordinates of the contained points
+        int indices[CAPACITY]; //!< insertion indices of the contained points
+        int n;                 //!< number of contained points
         Node *children;        //!< pointer to four child-nodes
         Node *parent;          //!< parent node
         float radius;          //!< aabb radius (can be used for bounding sphere tests)
@@ -110,7 +176,7 @@ namespace icl{
         /// constructor from given AABB-boundary
         Node(const AABB &boundary){
           this->boundary = boundary;
-          this->next = this->points;
+          this->n = 0;
           this->children = 0;
           this->parent = 0;
           this->radius = ::sqrt( utils::sqr(boundary.halfSize[0]) +
@@ -118,14 +184,35 @@ namespace icl{
                                  utils::sqr(boundary.halfSize[2]) );
         }
         /// initialization methods (with given boundary)
-        /** sets next to points-begin and children to NULL */
+        /** sets the point count and children to NULL */
         void init(Node *parent, const AABB &boundary){
           this->boundary = boundary;
-          this->next = this->points;
+          this->n = 0;
           this->children = 0;
           this->parent = parent;
           this->radius = parent->radius/2;
         }
+
+        /// returns the number of points contained in this node
+        int count() const { return n; }
+
+        /// returns whether the node contains CAPACITY points
+        bool full() const { return n == CAPACITY; }
+
+        /// returns the i-th contained point (scaled up, homogeneous component is 1)
+        Pt point(int i) const{
+          Pt p(xs[i],ys[i],zs[i]);
+          p[3] = 1;
+          return p;
+        }
+
+        /// adds a point (the node must not be full)
+        void add(const Pt &p, int index){
+          xs[n] = p[0];
+          ys[n] = p[1];
+          zs[n] = p[2];
+          indices[n++] = index;
+        }
     
         /// recursive getter function that queries all nodes within a given bounding box
         /** breaks the recursion if no children are present or if the nodes
@@ -135,9 +222,27 @@ namespace icl{
           if (!this->boundary.intersects(boundary)){
             return;
           }
-          for(const Pt *p=points; p<next ; ++p){
-            if(boundary.contains(*p)){
-              found.push_back(scale_down(*p));
+          for(int i=0;i<n;++i){
+            const Pt p = point(i);
+            if(boundary.contains(p)){
+              found.push_back(scale_down(p));
+            }
+          }
+          if(!children) return;
+          
+          for(int i=0;i<8;++i){
+            children[i].query(boundary,found);
+          }
+        }
+
+        /// index based version of query
+        void query(const AABB &boundary, std::vector<int> &found) const{
+          if (!this->boundary.intersects(boundary)){
+            return;
+          }
+          for(int i=0;i<n;++i){
+            if(boundary.contains(point(i))){
+              found.push_back(indices[i]);
             }
           }
           if(!children) return;
@@ -170,38 +275,50 @@ namespace icl{
       };
       
       /// Inernally used block allocator
-      /** The allocator allocates ALLOC_CHUNK_SIZE*4 Node instances
-          at once and automatically frees all data at destruction time */
+      /** The allocator allocates ALLOC_CHUNK_SIZE*8 Node instances
+          at once and automatically frees all data at destruction time.
+          Allocated chunks are reused after clear() */
       struct Allocator{
         
         /// allocated data
         std::vector<Node*> allocated;
+
+        /// index of the current chunk
+        int chunk;
         
         /// current data
         int curr;
 
         /// allocates the first data chunk
-        Allocator(){ grow(); }
+        Allocator():chunk(-1){ grow(); }
         
-        /// allocates the next data chunk
+        /// moves to the next data chunk (allocated on demand)
         void grow(){
-          allocated.push_back(new Node[ALLOC_CHUNK_SIZE*8]);
+          if(++chunk == (int)allocated.size()){
+            allocated.push_back(new Node[ALLOC_CHUNK_SIZE*8]);
+          }
           curr = 0;
         }
       
-        /// deletes all allocated data chunks (except for the first)
+        /// marks all data chunks as unused (without freeing them)
         void clear(){
+          chunk = 0;
+          curr = 0;
+        }
+
+        /// deletes all allocated data chunks (except for the first)
+        void release(){
           for(size_t i=1;i<allocated.size();++i){
             delete [] allocated[i];
           }
           allocated.resize(1);
-          curr = 0;
+          clear();
         }
         
-        /// returns the next four Node instances (allocates new data on demand)
+        /// returns the next eight Node instances (allocates new data on demand)
         Node *next(){
           if(curr == ALLOC_CHUNK_SIZE) grow();
-          return allocated.back()+8*curr++;
+          return allocated[chunk]+8*curr++;
         }
         
         /// frees all allocated data
@@ -214,20 +331,15 @@ namespace icl{
         /// returns all contained points
         std::vector<Pt> all() const{
           std::vector<Pt> pts;
-          for(size_t i=0;i<allocated.size()-1;++i){
+          for(int i=0;i<=chunk;++i){
             const Node *ns = allocated[i];
-            for(size_t j=0;j<ALLOC_CHUNK_SIZE*8;++j){
-              for(const Pt* p = ns[j].points; p != ns[j].next;++p){
-                pts.push_back(scale_down(*p));
+            const int n = (i == chunk ? curr : ALLOC_CHUNK_SIZE)*8;
+            for(int j=0;j<n;++j){
+              for(int k=0;k<ns[j].n;++k){
+                pts.push_back(scale_down(ns[j].point(k)));
               }
             }
           }
-          const Node *ns = allocated.back();
-          for(int i=0;i<curr*4;++i){
-            for(const Pt* p = ns[i].points; p != ns[i].next;++p){
-              pts.push_back(scale_down(*p));
-            }
-          }
           return pts;
         }
       };
@@ -267,6 +379,20 @@ namespace icl{
         return sdp;
       }
 
+      /// computes the squared distances of all points of the given node (returns the argmin)
+      static inline int sqr_dists(const Node *n, const Scalar *q, Scalar *d){
+        const int c = n->count();
+        octree_internal::LeafScan<Scalar>::sqr_dists(n->xs,n->ys,n->zs,c,q,d);
+        int best = -1;
+        for(int i=0;i<c;++i){
+          if(best < 0 || d[i] < d[best]) best = i;
+        }
+        return best;
+      }
+
+      /// (distance,index) pair used for knn-search
+      typedef std::pair<Scalar,int> Neighbour;
+
 
       public:
       /// creates a QuadTree for the given 2D rectangle
@@ -292,7 +418,8 @@ namespace icl{
       protected:
       
       /// internal utility method that is used to find an approximated nearest neighbour
-      const Pt &nn_approx_internal(const Pt &p, double &currMinDist, const Pt *&currNN) const throw (utils::ICLException){
+      /** The result is given by its node and the index within the node */
+      void nn_approx_internal(const Pt &p, double &currMinDist, const Node *&nnNode, int &nnIdx) const throw (utils::ICLException){
         // 1st find cell, that continas p
         const Node *n = root;
         while(n->children){
@@ -303,29 +430,134 @@ namespace icl{
         }
         
         // this cell could be empty, in this case, the parent must contain good points
-        if(n->next == n->points){
+        if(!n->count()){
           n = n->parent;
           if(!n) throw utils::ICLException("no nn found for given point " + utils::str(p));
         }
         
         double sqrMinDist = utils::sqr(currMinDist);
 
-        for(const Pt *x=n->points; x < n->next; ++x){
-          Scalar dSqr = ( utils::sqr(x->operator[](0)-p[0]) 
-                          + utils::sqr(x->operator[](1)-p[1])
-                          + utils::sqr(x->operator[](2)-p[2]) );
-          if(dSqr < sqrMinDist){
-            sqrMinDist = dSqr;
-            currNN = x; 
-          }
+        Scalar d[CAPACITY];
+        const int best = sqr_dists(n,&p[0],d);
+        if(best >= 0 && d[best] < sqrMinDist){
+          sqrMinDist = d[best];
+          nnNode = n;
+          nnIdx = best;
         }
         currMinDist = sqrt(sqrMinDist);
 
-        if(!currNN){
+        if(!nnNode){
           throw utils::ICLException("no nn found for given point " + utils::str(p.transp()));
         }
-        return *currNN;
       }
+
+      /// internal k-nearest neighbour search (p must be scaled up, result is sorted)
+      void knn_internal(const Pt &p, int k, std::vector<Neighbour> &heap,
+                        std::vector<const Node*> &stack) const{
+        heap.clear();
+        stack.clear();
+        if(k <= 0) return;
+        stack.push_back(root);
+        Scalar d[CAPACITY];
+        std::pair<Scalar,int> cs[8];
+        while(stack.size()){
+          const Node *n = stack.back();
+          stack.pop_back();
+          const bool full = (int)heap.size() == k;
+          if(full && n->boundary.sqrDist(&p[0]) > heap.front().first) continue;
+
+          const int c = n->count();
+          octree_internal::LeafScan<Scalar>::sqr_dists(n->xs,n->ys,n->zs,c,&p[0],d);
+          for(int i=0;i<c;++i){
+            if((int)heap.size() < k){
+              heap.push_back(Neighbour(d[i],n->indices[i]));
+              std::push_heap(heap.begin(),heap.end());
+            }else if(d[i] < heap.front().first){
+              std::pop_heap(heap.begin(),heap.end());
+              heap.back() = Neighbour(d[i],n->indices[i]);
+              std::push_heap(heap.begin(),heap.end());
+            }
+          }
+
+          if(!n->children) continue;
+          // push children far-to-near, so that the nearest one is processed first
+          int nc = 0;
+          for(int i=0;i<8;++i){
+            const Scalar bd = n->children[i].boundary.sqrDist(&p[0]);
+            if((int)heap.size() < k || bd <= heap.front().first){
+              cs[nc++] = std::pair<Scalar,int>(bd,i);
+            }
+          }
+          std::sort(cs,cs+nc);
+          for(int i=nc-1;i>=0;--i){
+            stack.push_back(n->children + cs[i].second);
+          }
+        }
+        std::sort_heap(heap.begin(),heap.end());
+      }
+
+      /// internal radius search (p and sqrRadius must be scaled up)
+      void radius_internal(const Pt &p, Scalar sqrRadius, std::vector<int> &indices,
+                           std::vector<const Node*> &stack) const{
+        indices.clear();
+        stack.clear();
+        stack.push_back(root);
+        Scalar d[CAPACITY];
+        while(stack.size()){
+          const Node *n = stack.back();
+          stack.pop_back();
+          const int c = n->count();
+          octree_internal::LeafScan<Scalar>::sqr_dists(n->xs,n->ys,n->zs,c,&p[0],d);
+          for(int i=0;i<c;++i){
+            if(d[i] <= sqrRadius) indices.push_back(n->indices[i]);
+          }
+          if(!n->children) continue;
+          for(int i=0;i<8;++i){
+            if(n->children[i].boundary.sqrDist(&p[0]) <= sqrRadius){
+              stack.push_back(n->children+i);
+            }
+          }
+        }
+      }
+
+      /// internally used functor for parallel knn-queries
+      struct KNNBatch{
+        const Octree *tree;
+        const Pt *queries;
+        int k;
+        int *indices;
+        Scalar *sqrDists;
+        void operator()(int begin, int end) const{
+          std::vector<Neighbour> heap;
+          std::vector<const Node*> stack;
+          heap.reserve(k);
+          stack.reserve(128);
+          for(int i=begin;i<end;++i){
+            tree->knn_internal(scale_up(queries[i]),k,heap,stack);
+            for(int j=0;j<k;++j){
+              const bool valid = j < (int)heap.size();
+              indices[i*k+j] = valid ? heap[j].second : -1;
+              if(sqrDists) sqrDists[i*k+j] = valid ? heap[j].first/(SF*SF) : Scalar(-1);
+            }
+          }
+        }
+      };
+
+      /// internally used functor for parallel radius-queries
+      struct RadiusBatch{
+        const Octree *tree;
+        const Pt *queries;
+        Scalar sqrRadius;
+        std::vector<int> *indices;
+        void operator()(int begin, int end) const{
+          std::vector<const Node*> stack;
+          stack.reserve(128);
+          for(int i=begin;i<end;++i){
+            tree->radius_internal(scale_up(queries[i]),sqrRadius,indices[i],stack);
+          }
+        }
+      };
+
       public:
       
       /// returs the Octree's top-level bounding box
@@ -343,9 +575,10 @@ namespace icl{
           on the QuadTree's template parameters */
       Pt nn_approx(const Pt &p) const throw (utils::ICLException){
         double currMinDist = sqrt(utils::Range<Scalar>::limits().maxVal-1);
-        const Pt *currNN  = 0;
-        nn_approx_internal(scale_up(p),currMinDist,currNN);
-        return scale_down_1(*currNN);
+        const Node *nnNode = 0;
+        int nnIdx = 0;
+        nn_approx_internal(scale_up(p),currMinDist,nnNode,nnIdx);
+        return scale_down_1(nnNode->point(nnIdx));
       }
 
       /// finds the nearest neighbor to the given node
@@ -373,10 +606,12 @@ namespace icl{
         stack.reserve(128);
         stack.push_back(root);
         double currMinDist = sqrt(utils::Range<Scalar>::limits().maxVal-1);
-        const Pt *currNN  = 0;
+        const Node *nnNode = 0;
+        int nnIdx = 0;
         
-        nn_approx_internal(p,currMinDist,currNN);
+        nn_approx_internal(p,currMinDist,nnNode,nnIdx);
         
+        Scalar d[CAPACITY];
         while(stack.size()){
           const Node *n = stack.back();
           stack.pop_back();
@@ -386,20 +621,65 @@ namespace icl{
               if(b.intersects(n->children[i].boundary)) stack.push_back(n->children+i);
             }
           }
-          Scalar sqrMinDist = utils::sqr(currMinDist);
-
-          for(const Pt *x=n->points; x < n->next; ++x){
-            Scalar dSqr = (utils::sqr(x->operator[](0)-p[0]) + 
-                           utils::sqr(x->operator[](1)-p[1]) +
-                           utils::sqr(x->operator[](2)-p[2]));
-            if(dSqr < sqrMinDist){
-              sqrMinDist = dSqr;
-              currNN = x; 
-            }
+          const int best = sqr_dists(n,&p[0],d);
+          if(best >= 0 && d[best] < utils::sqr(currMinDist)){
+            nnNode = n;
+            nnIdx = best;
+            currMinDist = sqrt(d[best]);
           }
-          currMinDist = sqrt(sqrMinDist);
         }
-        return scale_down_1(*currNN);
+        return scale_down_1(nnNode->point(nnIdx));
+      }
+
+      /// finds the k nearest neighbours of p
+      /** The indices (see \ref IDX) are sorted by ascending distance. If the
+          Octree contains less than k points, less indices are returned.
+          Optionally, the squared distances are returned as well. */
+      void knn(const Pt &p, int k, std::vector<int> &indices, std::vector<Scalar> *sqrDists=0) const{
+        std::vector<Neighbour> heap;
+        std::vector<const Node*> stack;
+        heap.reserve(k);
+        stack.reserve(128);
+        knn_internal(scale_up(p),k,heap,stack);
+        indices.resize(heap.size());
+        if(sqrDists) sqrDists->resize(heap.size());
+        for(unsigned int i=0;i<heap.size();++i){
+          indices[i] = heap[i].second;
+          if(sqrDists) (*sqrDists)[i] = heap[i].first/(SF*SF);
+        }
+      }
+
+      /// finds the indices of all points, whose distance to p is not larger than the given radius
+      /** The indices are not sorted */
+      void radius(const Pt &p, Scalar radius, std::vector<int> &indices) const{
+        std::vector<const Node*> stack;
+        stack.reserve(128);
+        radius_internal(scale_up(p),utils::sqr(radius*SF),indices,stack);
+      }
+
+      /// parallel k-nearest neighbour search for all given query points
+      /** The result contains k indices for each query point (query i's neighbours
+          start at i*k). If less than k points are found, the remaining entries
+          are set to -1 (and their squared distances to -1 as well). */
+      void knnBatch(const std::vector<Pt> &queries, int k, std::vector<int> &indices,
+                    std::vector<Scalar> *sqrDists=0) const{
+        const int n = (int)queries.size();
+        indices.resize(n*k);
+        if(sqrDists) sqrDists->resize(n*k);
+        if(!n || k <= 0) return;
+        KNNBatch f = { this, queries.data(), k, indices.data(), sqrDists ? sqrDists->data() : 0 };
+        utils::parallel_for(0, n, f, 64);
+      }
+
+      /// parallel radius search for all given query points
+      /** indices[i] contains the result of radius(queries[i],radius,indices[i]) */
+      void radiusBatch(const std::vector<Pt> &queries, Scalar radius,
+                       std::vector<std::vector<int> > &indices) const{
+        const int n = (int)queries.size();
+        indices.resize(n);
+        if(!n) return;
+        RadiusBatch f = { this, queries.data(), utils::sqr(radius*SF), indices.data() };
+        utils::parallel_for(0, n, f, 64);
       }
 
       /// inserts a node into the QuadTree
@@ -408,7 +688,7 @@ namespace icl{
           if new nodes are needed. */ 
       template<class OtherVectorType>
       void insert(const OtherVectorType &pIn){
-        ++num;
+        const int index = num++;
         Pt p = pIn;
         p[0] *= SF;
         p[1] *= SF;
@@ -416,8 +696,8 @@ namespace icl{
 
         Node *n = root;
         while(true){
-          if(n->next != n->points+CAPACITY){
-            *n->next++ = p;
+          if(!n->full()){
+            n->add(p,index);
             return;
           }
           if(!n->children) n->split(alloc.next());
@@ -450,9 +730,27 @@ namespace icl{
         return found;
       }
 
+      /// returns the indices of all contained points within the given rectangle
+      void queryIndices(const Scalar &minX, const Scalar &minY, const Scalar &minZ, 
+                        const Scalar &width, const Scalar &height, const Scalar &depth,
+                        std::vector<int> &indices) const{
+        AABB range(scale_up(Pt(minX+width/2, minY+height/2, minZ+depth/2)),
+                   scale_up(Pt(width/2,height/2, depth/2)));
+        indices.clear();
+        root->query(range,indices);
+      }
+
       /// returns all contained points
       std::vector<Pt> queryAll() const {
-        return alloc.all();
+        std::vector<Pt> pts;
+        for(int i=0;i<root->n;++i){
+          pts.push_back(scale_down(root->point(i)));
+        }
+        if(root->children){
+          std::vector<Pt> other = alloc.all();
+          pts.insert(pts.end(),other.begin(),other.end());
+        }
+        return pts;
       }
 
       /*
@@ -467,11 +765,13 @@ namespace icl{
       */
       
       /// removes all contained points and nodes
-      /** The allocator will free all memory except for the first CHUNK */
-      void clear(){
-        root->next = root->points;
+      /** By default, the allocated nodes are kept for reuse. If freeMemory
+          is true, the allocator will free all memory except for the first CHUNK */
+      void clear(bool freeMemory=false){
+        root->n = 0;
         root->children = 0;
-        alloc.clear();
+        if(freeMemory) alloc.release();
+        else alloc.clear();
         num = 0;
       }
 
@@ -492,4 +792,3 @@ namespace icl{
 
   } // namespace math
 } // namespace icl
-
@@ -34,8 +34,11 @@
 #include <ICLUtils/Function.h>
 #include <ICLUtils/Uncopyable.h>
 #include <ICLUtils/Random.h>
+#include <ICLUtils/TaskScheduler.h>
 #include <ICLMath/DynVector.h>
 #include <ICLMath/FixedVector.h>
+#include <algorithm>
+#include <cmath>
 
 namespace icl{
   namespace math{
@@ -57,6 +60,33 @@ namespace icl{
         are just a few restrictions for the DataPoint and Model classes.
         - default constructable
         - copyable
+
+        \section ENG Evaluation Engine
+        Each hypothesis is created from a random sample of minPointsForModel
+        distinct points. Consensus sets are handled as index lists; the
+        DataPoint instances of a consensus set are only copied if the set is
+        large enough to be refitted. The scoring of a hypothesis is stopped
+        as soon as it cannot reach minClosePointsForGoodModel inliers anymore.
+        The following optional extensions can be enabled:
+        - <b>adaptive termination</b> (setConfidence): the number of
+          iterations is reduced to the number of samples that is needed
+          to draw at least one outlier free sample with the given
+          probability. The inlier ratio is estimated from the best model
+          found so far. The iterations parameter remains an upper bound.
+        - <b>T(d,d) pre-test</b> (setPreTestPoints): before a hypothesis is
+          scored, d random points are tested. If not all of them are inliers,
+          the hypothesis is rejected without scoring all points.
+        - <b>progressive sampling</b> (setProgressiveSampling): PROSAC-like
+          guided sampling. The given data points are expected to be sorted
+          by descending quality (e.g. feature match score). Samples are
+          drawn from a growing subset of the best points, which reaches the
+          whole data set after the given number of iterations.
+        - <b>parallel evaluation</b> (setParallel): hypotheses are evaluated
+          in batches using utils::parallel_for. In this case, the fitting- and
+          the error function must be reentrant. Since each hypothesis uses
+          its own random generator that is seeded from the global random
+          generator (see utils::randomSeed), the result does only depend on
+          the batch size.
     */
     template<class DataPoint=std::vector<float>,
              class Model=std::vector<float> >
@@ -92,6 +122,18 @@ namespace icl{
       
       /// min error criterion for early exit
       icl64f m_minErrorExit;
+
+      /// confidence for the adaptive termination (0: disabled)
+      icl64f m_confidence;
+
+      /// number of points for the T(d,d) pre-test (0: disabled)
+      int m_preTestPoints;
+
+      /// flag for PROSAC-like guided sampling
+      bool m_progressiveSampling;
+
+      /// flag for parallel hypothesis evaluation
+      bool m_parallel;
       
       public:
       /// result structure
@@ -105,6 +147,9 @@ namespace icl{
         /// consensus set of best match (i.e. inliers)
         /** empty if no model was found */
         DataSet consensusSet;
+
+        /// indices of the consensus set points within the fitted data set
+        std::vector<int> consensusIndices;
   
         /// number of iterations needed
         int iterationCount;
@@ -116,28 +161,164 @@ namespace icl{
       private:
       /// internal result buffer
       Result m_result;
-      
-      /// internal utility method
-      static inline bool find_in(const std::vector<int> &v, int i, int n){
-        return std::find(v.data(), v.data()+n, i) != v.data()+n;
+
+      /// internal per hypothesis data (reused in subsequent fit calls)
+      struct Hypothesis{
+        std::vector<int> sample;        //!< indices of the minimal sample
+        DataSet samplePoints;           //!< points of the minimal sample
+        std::vector<icl8u> mask;        //!< marks the sample indices
+        std::vector<int> inliers;       //!< consensus set (indices)
+        DataSet inlierPoints;           //!< consensus set (copied for refitting only)
+        Model model;                    //!< refitted model
+        icl64f error;                   //!< mean error of the refitted model
+        bool good;                      //!< whether the hypothesis has enough inliers
+      };
+
+      /// internal buffer of hypotheses (one per batch entry)
+      std::vector<Hypothesis> m_hyps;
+
+      /// PROSAC growth function: iteration limits for subset sizes minPointsForModel ... N
+      std::vector<int> m_prosacLimits;
+
+      /// tiny xorshift random generator (one instance per hypothesis)
+      class Rand{
+        unsigned int s;
+        public:
+        /// creates a generator for the given hypothesis
+        Rand(unsigned int seed, int iteration){
+          s = seed ^ ((unsigned int)(iteration+1) * 0x9E3779B9u);
+          if(!s) s = 0x9E3779B9u;
+          for(int i=0;i<4;++i) next();
+        }
+        /// returns the next random number
+        inline unsigned int next(){
+          s ^= s << 13;
+          s ^= s >> 17;
+          s ^= s << 5;
+          return s;
+        }
+        /// returns a random number in [0,n)
+        inline int operator()(int n){
+          return (int)(((uint64_t)next() * (unsigned int)n) >> 32);
+        }
+      };
+
+      /// internally used functor for parallel evaluation
+      struct EvaluateBatch{
+        RansacFitter *fitter;
+        const DataSet *points;
+        unsigned int seed;
+        int firstIteration;
+        void operator()(int begin, int end) const{
+          for(int i=begin;i<end;++i){
+            fitter->evaluate(*points, seed, firstIteration+i, fitter->m_hyps[i]);
+          }
+        }
+      };
+
+      /// creates the PROSAC growth function for n points
+      void create_prosac_limits(int n){
+        const int m = m_minPointsForModel;
+        m_prosacLimits.resize(n-m+1);
+        icl64f tn = m_iterations;
+        for(int i=0;i<m;++i) tn *= icl64f(m-i)/(n-i);
+        int tp = 1;
+        m_prosacLimits[0] = tp;
+        for(int k=m;k<n;++k){
+          const icl64f tn1 = tn * (k+1) / (k+1-m);
+          tp += (int)ceil(tn1-tn);
+          m_prosacLimits[k+1-m] = tp;
+          tn = tn1;
+        }
       }
-  
-      /// internal utility method
-      void find_random_consensus_set(DataSet &currConsensusSet,
-                                     const DataSet &allPoints,
-                                     std::vector<int> &usedIndices){
-        const int n = currConsensusSet.size();
-        utils::URandI r(allPoints.size()-1);
-        
-        for(int i=0;i<n;++i){
-          do { usedIndices[i] = r; } while ( find_in(usedIndices, usedIndices[i], i-1) );
-          currConsensusSet[i] = allPoints[ usedIndices[i] ];
+
+      /// draws the minimal sample for the given iteration
+      void draw_sample(int n, int iteration, Rand &r, std::vector<int> &sample){
+        const int m = m_minPointsForModel;
+        int first = 0, range = n;
+        if(m_progressiveSampling){
+          // subset of the best k points, always containing the k-th point
+          const int k = m + (int)(std::lower_bound(m_prosacLimits.begin(), m_prosacLimits.end(), iteration+1)
+                                  - m_prosacLimits.begin());
+          if(k < n){
+            sample[0] = k-1;
+            first = 1;
+            range = k-1;
+          }
+        }
+        for(int i=first;i<m;++i){
+          int idx;
+          do{ idx = r(range); } while(std::find(sample.begin(), sample.begin()+i, idx) != sample.begin()+i);
+          sample[i] = idx;
         }
       }
+
+      /// evaluates a single hypothesis
+      void evaluate(const DataSet &allPoints, unsigned int seed, int iteration, Hypothesis &h){
+        const int n = (int)allPoints.size(), m = m_minPointsForModel;
+        h.good = false;
+        h.sample.resize(m);
+        h.samplePoints.resize(m);
+        h.mask.resize(n,0);
+
+        Rand r(seed,iteration);
+        draw_sample(n,iteration,r,h.sample);
+        for(int i=0;i<m;++i){
+          h.samplePoints[i] = allPoints[h.sample[i]];
+        }
+        h.model = m_fitting(h.samplePoints);
+
+        // T(d,d) pre-test on random non-sample points
+        for(int i=0;i<m_preTestPoints && n > m;++i){
+          int j;
+          do{ j = r(n); } while(std::find(h.sample.begin(), h.sample.end(), j) != h.sample.end());
+          if(!(m_err(h.model, allPoints[j]) < m_maxModelDistance)) return;
+        }
+
+        // scoring with early bailout (sample points are always part of the consensus set)
+        h.inliers.assign(h.sample.begin(), h.sample.end());
+        for(int i=0;i<m;++i) h.mask[h.sample[i]] = 1;
+        int remaining = n - m;
+        for(int j=0;j<n;++j){
+          if(h.mask[j]) continue;
+          if(m_err(h.model, allPoints[j]) < m_maxModelDistance){
+            h.inliers.push_back(j);
+          }
+          if((int)h.inliers.size() + --remaining < m_minClosePointsForGoodModel) break;
+        }
+        for(int i=0;i<m;++i) h.mask[h.sample[i]] = 0;
+        if((int)h.inliers.size() < m_minClosePointsForGoodModel) return;
+
+        // refitting on the consensus set
+        const int k = (int)h.inliers.size();
+        h.inlierPoints.resize(k);
+        for(int i=0;i<k;++i){
+          h.inlierPoints[i] = allPoints[h.inliers[i]];
+        }
+        h.model = m_fitting(h.inlierPoints);
+        icl64f error = 0;
+        for(int i=0;i<k;++i){
+          error += m_err(h.model, h.inlierPoints[i]);
+        }
+        h.error = error / k;
+        h.good = true;
+      }
+
+      /// returns the number of iterations that are needed for the current best model
+      int adapted_iteration_count(int n) const{
+        if(m_confidence <= 0 || !m_result.consensusIndices.size()) return m_iterations;
+        const icl64f w = icl64f(m_result.consensusIndices.size())/n;
+        const icl64f pGood = ::pow(w, m_minPointsForModel + (n > m_minPointsForModel ? m_preTestPoints : 0));
+        if(pGood >= 1) return 1;
+        if(pGood <= 0 || m_confidence >= 1) return m_iterations;
+        const icl64f k = ::ceil(::log(1-m_confidence) / ::log(1-pGood));
+        return k < m_iterations ? (int)k : m_iterations;
+      }
       
       public:
       /// empty constructor (creates a dummy instance)
-      RansacFitter(){}
+      RansacFitter():m_confidence(0),m_preTestPoints(0),
+                     m_progressiveSampling(false),m_parallel(false){}
       
       /// constructor with given parameters
       /** The parameters functionality is documented with the
@@ -154,56 +335,76 @@ namespace icl{
         m_maxModelDistance(maxModelDistance),
         m_minClosePointsForGoodModel(minClosePointsForGoodModel),
         m_fitting(fitting),m_err(err),
-        m_minErrorExit(minErrorExit){
+        m_minErrorExit(minErrorExit),
+        m_confidence(0),m_preTestPoints(0),
+        m_progressiveSampling(false),m_parallel(false){
       }
+
+      /// enables the adaptive termination with given confidence (e.g. 0.99; 0 disables it)
+      void setConfidence(icl64f confidence) { m_confidence = confidence; }
+
+      /// returns the confidence for adaptive termination
+      icl64f getConfidence() const { return m_confidence; }
+
+      /// sets the number of points for the T(d,d) pre-test (0 disables it)
+      void setPreTestPoints(int d) { m_preTestPoints = d; }
+
+      /// returns the number of points for the T(d,d) pre-test
+      int getPreTestPoints() const { return m_preTestPoints; }
+
+      /// enables PROSAC-like sampling (data points must be sorted by descending quality)
+      void setProgressiveSampling(bool on) { m_progressiveSampling = on; }
+
+      /// returns whether PROSAC-like sampling is enabled
+      bool getProgressiveSampling() const { return m_progressiveSampling; }
+
+      /// enables the parallel evaluation of hypotheses (fitting and error functions must be reentrant)
+      void setParallel(bool on) { m_parallel = on; }
+
+      /// returns whether hypotheses are evaluated in parallel
+      bool getParallel() const { return m_parallel; }
       
       /// fitting function (actual RANSAC algorithm)
       const Result &fit(const DataSet &allPoints){
         m_result.model = Model();
         m_result.consensusSet.clear();
+        m_result.consensusIndices.clear();
         m_result.error = utils::Range64f::limits().maxVal;
         m_result.iterationCount = 0;
-        std::vector<DataPoint> consensusSet(m_minPointsForModel);
-        std::vector<int> usedIndices(m_minPointsForModel);
-        
-        int i = 0;
-        for(i=0;i<m_iterations;++i){
-          consensusSet.resize(m_minPointsForModel);
-          find_random_consensus_set(consensusSet, allPoints, usedIndices);
-
-          /*          std::cout << "   selected indices: [ " 
-                    << usedIndices[0] << ", "
-                    << usedIndices[1] << ", "
-                    << usedIndices[2] << ", "
-                    << usedIndices[3] << "]" << std::endl;
-              */
-          Model model = m_fitting(consensusSet);
-          for(int j=0;j<(int)allPoints.size();++j){
-            if(find_in(usedIndices, j, usedIndices.size())) continue;
-            if(m_err(model, allPoints[j]) < m_maxModelDistance){
-              consensusSet.push_back(allPoints[j]);
-            }
+
+        const int n = (int)allPoints.size();
+        if(n < m_minPointsForModel || m_minPointsForModel <= 0) return m_result;
+        if(m_progressiveSampling) create_prosac_limits(n);
+
+        const int batchSize = m_parallel ? 4*utils::TaskScheduler::instance().getNumThreads() : 1;
+        if((int)m_hyps.size() < batchSize) m_hyps.resize(batchSize);
+        const unsigned int seed = utils::random(0xFFFFFFFFu);
+
+        int i = 0, maxIterations = m_iterations;
+        bool exit = false;
+        while(i < maxIterations && !exit){
+          const int b = iclMin(batchSize, maxIterations-i);
+          if(b > 1){
+            EvaluateBatch eval = { this, &allPoints, seed, i };
+            utils::parallel_for(0, b, eval, 1);
+          }else{
+            evaluate(allPoints, seed, i, m_hyps[0]);
           }
-          
-          
-          if((int)consensusSet.size() >= m_minClosePointsForGoodModel){
-            model = m_fitting(consensusSet);
-            double error = 0;
-            for(unsigned int j=0;j<consensusSet.size();++j){
-              error += m_err(model, consensusSet[j]);
-            }
-            error /= consensusSet.size();
-            
-            if(error < m_result.error){
-              m_result.error = error;
-              m_result.model = model;
-              m_result.consensusSet = consensusSet;
-              if(m_result.error < m_minErrorExit){
-                m_result.iterationCount = i;
-                return m_result;
-              }
-            }
+          for(int j=0;j<b && !exit;++j){
+            Hypothesis &h = m_hyps[j];
+            ++i;
+            if(!h.good || !(h.error < m_result.error)) continue;
+            m_result.error = h.error;
+            m_result.model = h.model;
+            m_result.consensusIndices = h.inliers;
+            exit = m_result.error < m_minErrorExit;
           }
+          maxIterations = adapted_iteration_count(n);
+        }
+
+        m_result.consensusSet.resize(m_result.consensusIndices.size());
+        for(unsigned int j=0;j<m_result.consensusIndices.size();++j){
+          m_result.consensusSet[j] = allPoints[m_result.consensusIndices[j]];
         }
         m_result.iterationCount = i;
         return m_result;
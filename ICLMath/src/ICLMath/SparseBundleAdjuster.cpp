@@ -0,0 +1,669 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLMath/src/ICLMath/SparseBundleAdjuster.cpp           **
+** Module : ICLMath                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLMath/SparseBundleAdjuster.h>
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Time.h>
+#include <ICLUtils/StringUtils.h>
+#include <cmath>
+#include <iostream>
+
+using namespace icl::utils;
+
+namespace icl{
+  namespace math{
+
+    namespace{
+
+      /// internal problem state (all blocks are stored row-major in flat arrays)
+      template<class Scalar>
+      struct BAState{
+        typedef typename SparseBundleAdjuster<Scalar>::Projection Projection;
+        typedef typename SparseBundleAdjuster<Scalar>::Jacobian Jacobian;
+        typedef DynColVector<Scalar> Vector;
+        typedef DynMatrix<Scalar> Matrix;
+
+        int M,C,P,B,N,nc,np;
+        Projection f;
+        Jacobian j;
+
+        Matrix cams, pts, camsNew, ptsNew;
+        std::vector<int> obsCam, obsPt;
+        std::vector<Scalar> y;
+        std::vector<std::vector<int> > camObs, ptObs;
+        std::vector<char> camFixed, ptFixed;
+
+        std::vector<Scalar> r, rNew, J, W, Y;   // per observation
+        std::vector<Scalar> U, ga;              // per camera
+        std::vector<Scalar> V, gb, Vinv;        // per point
+        std::vector<Scalar> dc, dp;             // parameter update
+        Matrix S;                               // reduced camera system
+        std::vector<Scalar> rhs;
+        Scalar lambda;
+      };
+
+      /// evaluates the residuals (and optionally the Jacobian blocks) of observations [begin,end)
+      template<class Scalar>
+      struct Evaluate{
+        BAState<Scalar> *s;
+        const DynMatrix<Scalar> *cams, *pts;
+        Scalar *r;
+        bool jacobian;
+
+        void operator()(int begin, int end) const{
+          typedef DynColVector<Scalar> Vector;
+          const int M = s->M, C = s->C, P = s->P, B = s->B;
+          for(int o=begin;o<end;++o){
+            const Vector c(C, const_cast<Scalar*>(cams->row_begin(s->obsCam[o])), false);
+            const Vector p(P, const_cast<Scalar*>(pts->row_begin(s->obsPt[o])), false);
+            Vector ro(M, r+o*M, false);
+            s->f(c,p,ro);
+            for(int m=0;m<M;++m) ro[m] -= s->y[o*M+m];
+            if(!jacobian) continue;
+
+            Scalar *Jo = &s->J[o*M*B];
+            DynMatrix<Scalar> Jm(B, M, Jo, false);
+            s->j(c,p,Jm);
+            // W = Jc^T Jp
+            Scalar *Wo = &s->W[o*C*P];
+            for(int a=0;a<C;++a){
+              for(int b=0;b<P;++b){
+                Scalar sum = 0;
+                for(int m=0;m<M;++m) sum += Jo[m*B+a] * Jo[m*B+C+b];
+                Wo[a*P+b] = sum;
+              }
+            }
+          }
+        }
+      };
+
+      /// accumulates U = Jc^T Jc and ga = Jc^T r of cameras [begin,end)
+      template<class Scalar>
+      struct CameraBlocks{
+        BAState<Scalar> *s;
+
+        void operator()(int begin, int end) const{
+          const int M = s->M, C = s->C, B = s->B;
+          for(int cam=begin;cam<end;++cam){
+            Scalar *U = &s->U[cam*C*C], *g = &s->ga[cam*C];
+            std::fill(U,U+C*C,Scalar(0));
+            std::fill(g,g+C,Scalar(0));
+            const std::vector<int> &obs = s->camObs[cam];
+            for(unsigned int k=0;k<obs.size();++k){
+              const Scalar *Jo = &s->J[obs[k]*M*B], *ro = &s->r[obs[k]*M];
+              for(int m=0;m<M;++m){
+                const Scalar *Jm = Jo+m*B;
+                for(int a=0;a<C;++a){
+                  g[a] += Jm[a] * ro[m];
+                  for(int b=0;b<=a;++b) U[a*C+b] += Jm[a] * Jm[b];
+                }
+              }
+            }
+            for(int a=0;a<C;++a){
+              for(int b=0;b<a;++b) U[b*C+a] = U[a*C+b];
+            }
+          }
+        }
+      };
+
+      /// accumulates V = Jp^T Jp and gb = Jp^T r of points [begin,end)
+      template<class Scalar>
+      struct PointBlocks{
+        BAState<Scalar> *s;
+
+        void operator()(int begin, int end) const{
+          const int M = s->M, C = s->C, P = s->P, B = s->B;
+          for(int pt=begin;pt<end;++pt){
+            Scalar *V = &s->V[pt*P*P], *g = &s->gb[pt*P];
+            std::fill(V,V+P*P,Scalar(0));
+            std::fill(g,g+P,Scalar(0));
+            const std::vector<int> &obs = s->ptObs[pt];
+            for(unsigned int k=0;k<obs.size();++k){
+              const Scalar *Jo = &s->J[obs[k]*M*B], *ro = &s->r[obs[k]*M];
+              for(int m=0;m<M;++m){
+                const Scalar *Jm = Jo+m*B+C;
+                for(int a=0;a<P;++a){
+                  g[a] += Jm[a] * ro[m];
+                  for(int b=0;b<=a;++b) V[a*P+b] += Jm[a] * Jm[b];
+                }
+              }
+            }
+            for(int a=0;a<P;++a){
+              for(int b=0;b<a;++b) V[b*P+a] = V[a*P+b];
+            }
+          }
+        }
+      };
+
+      /// in-place Cholesky decomposition of the lower triangle of a small n x n matrix
+      template<class Scalar>
+      bool cholesky_small(Scalar *A, int n){
+        for(int k=0;k<n;++k){
+          Scalar d = A[k*n+k];
+          for(int t=0;t<k;++t) d -= A[k*n+t]*A[k*n+t];
+          if(!(d > 0)) return false;
+          A[k*n+k] = std::sqrt(d);
+          for(int i=k+1;i<n;++i){
+            Scalar v = A[i*n+k];
+            for(int t=0;t<k;++t) v -= A[i*n+t]*A[k*n+t];
+            A[i*n+k] = v / A[k*n+k];
+          }
+        }
+        return true;
+      }
+
+      /// solves L L^T x = b in-place (L is the lower triangle of A)
+      template<class Scalar>
+      void cholesky_solve(const Scalar *L, int n, Scalar *b){
+        for(int i=0;i<n;++i){
+          Scalar v = b[i];
+          for(int t=0;t<i;++t) v -= L[i*n+t]*b[t];
+          b[i] = v / L[i*n+i];
+        }
+        for(int i=n-1;i>=0;--i){
+          Scalar v = b[i];
+          for(int t=i+1;t<n;++t) v -= L[t*n+i]*b[t];
+          b[i] = v / L[i*n+i];
+        }
+      }
+
+      /// computes Vinv = (V + lambda I)^-1 and Y = W Vinv for points [begin,end)
+      template<class Scalar>
+      struct PointInverse{
+        BAState<Scalar> *s;
+
+        void operator()(int begin, int end) const{
+          const int C = s->C, P = s->P;
+          std::vector<Scalar> L(P*P), e(P);
+          for(int pt=begin;pt<end;++pt){
+            Scalar *Vinv = &s->Vinv[pt*P*P];
+            bool ok = !s->ptFixed[pt];
+            if(ok){
+              std::copy(&s->V[pt*P*P], &s->V[(pt+1)*P*P], L.begin());
+              for(int a=0;a<P;++a) L[a*P+a] += s->lambda;
+              ok = cholesky_small(L.data(),P);
+            }
+            if(!ok){
+              // fixed (or degenerated) points are not updated
+              std::fill(Vinv,Vinv+P*P,Scalar(0));
+            }else{
+              for(int a=0;a<P;++a){
+                std::fill(e.begin(),e.end(),Scalar(0));
+                e[a] = 1;
+                cholesky_solve(L.data(),P,e.data());
+                for(int b=0;b<P;++b) Vinv[b*P+a] = e[b];
+              }
+            }
+            const std::vector<int> &obs = s->ptObs[pt];
+            for(unsigned int k=0;k<obs.size();++k){
+              const Scalar *Wo = &s->W[obs[k]*C*P];
+              Scalar *Yo = &s->Y[obs[k]*C*P];
+              for(int a=0;a<C;++a){
+                for(int b=0;b<P;++b){
+                  Scalar sum = 0;
+                  for(int t=0;t<P;++t) sum += Wo[a*P+t] * Vinv[t*P+b];
+                  Yo[a*P+b] = sum;
+                }
+              }
+            }
+          }
+        }
+      };
+
+      /// computes the block rows [begin,end) of the reduced camera system S = U* - W V*^-1 W^T (lower triangle only)
+      template<class Scalar>
+      struct SchurRows{
+        BAState<Scalar> *s;
+
+        void operator()(int begin, int end) const{
+          const int C = s->C, P = s->P, n = s->nc*C;
+          for(int cj=begin;cj<end;++cj){
+            Scalar *rhs = &s->rhs[cj*C];
+            for(int a=0;a<C;++a){
+              Scalar *row = s->S.row_begin(cj*C+a);
+              std::fill(row,row+n,Scalar(0));
+              for(int b=0;b<C;++b) row[cj*C+b] = s->U[cj*C*C+a*C+b];
+              row[cj*C+a] += s->lambda;
+              rhs[a] = -s->ga[cj*C+a];
+            }
+            const std::vector<int> &obs = s->camObs[cj];
+            for(unsigned int k=0;k<obs.size();++k){
+              const int pt = s->obsPt[obs[k]];
+              if(s->ptFixed[pt]) continue;
+              const Scalar *Yo = &s->Y[obs[k]*C*P], *gb = &s->gb[pt*P];
+              for(int a=0;a<C;++a){
+                for(int t=0;t<P;++t) rhs[a] += Yo[a*P+t] * gb[t];
+              }
+              const std::vector<int> &pobs = s->ptObs[pt];
+              for(unsigned int q=0;q<pobs.size();++q){
+                const int ck = s->obsCam[pobs[q]];
+                // only the lower triangle is used by the Cholesky decomposition
+                if(ck > cj) continue;
+                const Scalar *Wq = &s->W[pobs[q]*C*P];
+                for(int a=0;a<C;++a){
+                  Scalar *row = s->S.row_begin(cj*C+a) + ck*C;
+                  for(int b=0;b<C;++b){
+                    Scalar sum = 0;
+                    for(int t=0;t<P;++t) sum += Yo[a*P+t] * Wq[b*P+t];
+                    row[b] -= sum;
+                  }
+                }
+              }
+            }
+          }
+        }
+      };
+
+      /// computes the column entries L(i,k) for rows [begin,end) (used by the parallel Cholesky decomposition)
+      template<class Scalar>
+      struct CholeskyColumn{
+        DynMatrix<Scalar> *A;
+        int k;
+
+        void operator()(int begin, int end) const{
+          const Scalar *Lk = A->row_begin(k);
+          const Scalar d = Lk[k];
+          for(int i=begin;i<end;++i){
+            Scalar *Li = A->row_begin(i);
+            Scalar v = Li[k];
+            for(int t=0;t<k;++t) v -= Li[t]*Lk[t];
+            Li[k] = v / d;
+          }
+        }
+      };
+
+      /// parallel in-place Cholesky decomposition (lower triangle) of a dense symmetric matrix
+      template<class Scalar>
+      bool cholesky(DynMatrix<Scalar> &A){
+        const int n = A.rows();
+        for(int k=0;k<n;++k){
+          Scalar *Lk = A.row_begin(k);
+          Scalar d = Lk[k];
+          for(int t=0;t<k;++t) d -= Lk[t]*Lk[t];
+          if(!(d > 0)) return false;
+          Lk[k] = std::sqrt(d);
+          CholeskyColumn<Scalar> col = { &A, k };
+          parallel_for(k+1, n, col, 16);
+        }
+        return true;
+      }
+
+      /// back substitution of the point updates for points [begin,end)
+      template<class Scalar>
+      struct PointUpdate{
+        BAState<Scalar> *s;
+
+        void operator()(int begin, int end) const{
+          const int C = s->C, P = s->P;
+          std::vector<Scalar> v(P);
+          for(int pt=begin;pt<end;++pt){
+            Scalar *dp = &s->dp[pt*P];
+            if(s->ptFixed[pt]){
+              std::fill(dp,dp+P,Scalar(0));
+              continue;
+            }
+            for(int a=0;a<P;++a) v[a] = -s->gb[pt*P+a];
+            const std::vector<int> &obs = s->ptObs[pt];
+            for(unsigned int k=0;k<obs.size();++k){
+              const Scalar *Wo = &s->W[obs[k]*C*P], *dc = &s->dc[s->obsCam[obs[k]]*C];
+              for(int a=0;a<P;++a){
+                for(int t=0;t<C;++t) v[a] -= Wo[t*P+a] * dc[t];
+              }
+            }
+            const Scalar *Vinv = &s->Vinv[pt*P*P];
+            for(int a=0;a<P;++a){
+              Scalar sum = 0;
+              for(int b=0;b<P;++b) sum += Vinv[a*P+b] * v[b];
+              dp[a] = sum;
+            }
+          }
+        }
+      };
+
+      template<class Scalar>
+      struct NumericJacobian : public FunctionImpl<void,const DynColVector<Scalar>&,
+                                                   const DynColVector<Scalar>&,
+                                                   DynMatrix<Scalar>&>{
+        typedef typename SparseBundleAdjuster<Scalar>::Projection Projection;
+        typedef DynColVector<Scalar> Vector;
+
+        Projection f;
+        int M;
+        Scalar delta;
+
+        NumericJacobian(Projection f, int M, Scalar delta):f(f),M(M),delta(delta){}
+
+        virtual void operator()(const Vector &cam, const Vector &point, DynMatrix<Scalar> &J) const{
+          Vector c(cam.dim(), cam.begin()), p(point.dim(), point.begin()), f1(M), f2(M);
+          const int C = c.dim();
+          for(unsigned int i=0;i<c.dim();++i){
+            c[i] = cam[i] + delta/2;
+            f(c,p,f1);
+            c[i] = cam[i] - delta/2;
+            f(c,p,f2);
+            c[i] = cam[i];
+            for(int m=0;m<M;++m) J(i,m) = (f1[m] - f2[m]) / delta;
+          }
+          for(unsigned int i=0;i<p.dim();++i){
+            p[i] = point[i] + delta/2;
+            f(c,p,f1);
+            p[i] = point[i] - delta/2;
+            f(c,p,f2);
+            p[i] = point[i];
+            for(int m=0;m<M;++m) J(C+i,m) = (f1[m] - f2[m]) / delta;
+          }
+        }
+      };
+
+      /// minimum number of observations per task
+      static const int OBS_GRAIN = 64;
+    }
+
+    template<class Scalar>
+    SparseBundleAdjuster<Scalar>::SparseBundleAdjuster(){
+
+    }
+
+    template<class Scalar>
+    SparseBundleAdjuster<Scalar>::SparseBundleAdjuster(Projection f, int measurementDim, Jacobian j,
+                                                       Scalar tau, int maxIterations, Scalar minError,
+                                                       Scalar eps1, Scalar eps2){
+      init(f,measurementDim,j,tau,maxIterations,minError,eps1,eps2);
+    }
+
+    template<class Scalar>
+    void SparseBundleAdjuster<Scalar>::init(Projection f, int measurementDim, Jacobian j,
+                                            Scalar tau, int maxIterations, Scalar minError,
+                                            Scalar eps1, Scalar eps2){
+      this->f = f;
+      this->M = measurementDim;
+      this->j = j ? j : create_numerical_jacobian(f,measurementDim);
+      this->tau = tau;
+      this->maxIterations = maxIterations;
+      this->minError = minError;
+      this->eps1 = eps1;
+      this->eps2 = eps2;
+    }
+
+    template<class Scalar>
+    void SparseBundleAdjuster<Scalar>::setFixedCameras(const std::vector<int> &cameras){
+      fixedCameras = cameras;
+    }
+
+    template<class Scalar>
+    void SparseBundleAdjuster<Scalar>::setFixedPoints(const std::vector<int> &points){
+      fixedPoints = points;
+    }
+
+    template<class Scalar>
+    typename SparseBundleAdjuster<Scalar>::Result
+    SparseBundleAdjuster<Scalar>::fit(const Matrix &cameras, const Matrix &points,
+                                      const std::vector<Observation> &observations) throw (ICLException){
+      if(!f) throw ICLException("SparseBundleAdjuster::fit: called on a null instance");
+      if(!cameras.rows() || !points.rows() || observations.empty()){
+        throw ICLException("SparseBundleAdjuster::fit: no cameras, points or observations given");
+      }
+      BAState<Scalar> s;
+      s.M = M;
+      s.C = cameras.cols();
+      s.P = points.cols();
+      s.B = s.C + s.P;
+      s.N = observations.size();
+      s.nc = cameras.rows();
+      s.np = points.rows();
+      s.f = f;
+      s.j = j;
+      s.cams = cameras;
+      s.pts = points;
+      s.camsNew = cameras;
+      s.ptsNew = points;
+
+      const int M = s.M, C = s.C, P = s.P, N = s.N, nc = s.nc, np = s.np;
+      s.obsCam.resize(N);
+      s.obsPt.resize(N);
+      s.y.resize(N*M);
+      s.camObs.resize(nc);
+      s.ptObs.resize(np);
+      for(int o=0;o<N;++o){
+        const Observation &ob = observations[o];
+        if(ob.camera < 0 || ob.camera >= nc || ob.point < 0 || ob.point >= np){
+          throw ICLException("SparseBundleAdjuster::fit: invalid camera or point index in observation " + str(o));
+        }
+        if((int)ob.measurement.dim() != M){
+          throw ICLException("SparseBundleAdjuster::fit: wrong measurement dimension in observation " + str(o));
+        }
+        s.obsCam[o] = ob.camera;
+        s.obsPt[o] = ob.point;
+        std::copy(ob.measurement.begin(), ob.measurement.end(), s.y.begin()+o*M);
+        s.camObs[ob.camera].push_back(o);
+        s.ptObs[ob.point].push_back(o);
+      }
+      s.camFixed.assign(nc,0);
+      s.ptFixed.assign(np,0);
+      for(unsigned int i=0;i<fixedCameras.size();++i){
+        if(fixedCameras[i] >= 0 && fixedCameras[i] < nc) s.camFixed[fixedCameras[i]] = 1;
+      }
+      for(unsigned int i=0;i<fixedPoints.size();++i){
+        if(fixedPoints[i] >= 0 && fixedPoints[i] < np) s.ptFixed[fixedPoints[i]] = 1;
+      }
+
+      s.r.resize(N*M);
+      s.rNew.resize(N*M);
+      s.J.resize(N*M*s.B);
+      s.W.resize(N*C*P);
+      s.Y.resize(N*C*P);
+      s.U.resize(nc*C*C);
+      s.ga.resize(nc*C);
+      s.V.resize(np*P*P);
+      s.gb.resize(np*P);
+      s.Vinv.resize(np*P*P);
+      s.dc.resize(nc*C);
+      s.dp.resize(np*P);
+      s.rhs.resize(nc*C);
+      s.S.setBounds(nc*C, nc*C);
+
+      Result result;
+      result.iteration = 0;
+      result.lambda = 0;
+
+      Evaluate<Scalar> eval = { &s, &s.cams, &s.pts, s.r.data(), false };
+      parallel_for(0, N, eval, OBS_GRAIN);
+      Scalar e = 0;
+      for(int i=0;i<N*M;++i) e += s.r[i]*s.r[i];
+      e /= 2;
+      result.initialError = e;
+
+      Scalar v = 2;
+      bool recompute = true;
+      int it = 0;
+      for(;it < maxIterations && e >= minError; ++it){
+        IterationInfo info = { it, e, 0, false, 0, 0, 0, 0 };
+
+        if(recompute){
+          Time t = Time::now();
+          Evaluate<Scalar> evalJ = { &s, &s.cams, &s.pts, s.r.data(), true };
+          parallel_for(0, N, evalJ, OBS_GRAIN);
+          info.jacobianTime = t.age().toMilliSecondsDouble();
+
+          t = Time::now();
+          CameraBlocks<Scalar> cb = { &s };
+          parallel_for(0, nc, cb, 1);
+          PointBlocks<Scalar> pb = { &s };
+          parallel_for(0, np, pb, 16);
+          info.schurTime = t.age().toMilliSecondsDouble();
+          recompute = false;
+
+          Scalar maxG = 0, maxDiag = 0;
+          for(int c=0;c<nc;++c){
+            if(s.camFixed[c]) continue;
+            for(int a=0;a<C;++a){
+              maxG = iclMax(maxG, (Scalar)std::fabs(s.ga[c*C+a]));
+              maxDiag = iclMax(maxDiag, s.U[c*C*C+a*C+a]);
+            }
+          }
+          for(int p=0;p<np;++p){
+            if(s.ptFixed[p]) continue;
+            for(int a=0;a<P;++a){
+              maxG = iclMax(maxG, (Scalar)std::fabs(s.gb[p*P+a]));
+              maxDiag = iclMax(maxDiag, s.V[p*P*P+a*P+a]);
+            }
+          }
+          if(maxG <= eps1) break;
+          if(it == 0) s.lambda = tau * maxDiag;
+        }
+        info.lambda = s.lambda;
+
+        Time t = Time::now();
+        PointInverse<Scalar> pi = { &s };
+        parallel_for(0, np, pi, 16);
+        SchurRows<Scalar> sr = { &s };
+        parallel_for(0, nc, sr, 1);
+        // fixed cameras are not updated
+        for(int c=0;c<nc;++c){
+          if(!s.camFixed[c]) continue;
+          for(int a=c*C;a<(c+1)*C;++a){
+            for(int b=0;b<nc*C;++b) s.S(a,b) = s.S(b,a) = 0;
+            s.S(a,a) = 1;
+            s.rhs[a] = 0;
+          }
+        }
+        info.schurTime += t.age().toMilliSecondsDouble();
+
+        t = Time::now();
+        bool solved = cholesky(s.S);
+        if(solved){
+          std::copy(s.rhs.begin(), s.rhs.end(), s.dc.begin());
+          // forward and backward substitution on the rows of L
+          const int n = nc*C;
+          for(int i=0;i<n;++i){
+            const Scalar *Li = s.S.row_begin(i);
+            Scalar x = s.dc[i];
+            for(int k=0;k<i;++k) x -= Li[k]*s.dc[k];
+            s.dc[i] = x / Li[i];
+          }
+          for(int i=n-1;i>=0;--i){
+            Scalar x = s.dc[i];
+            for(int k=i+1;k<n;++k) x -= s.S(i,k)*s.dc[k];
+            s.dc[i] = x / s.S(i,i);
+          }
+          PointUpdate<Scalar> pu = { &s };
+          parallel_for(0, np, pu, 16);
+        }
+        info.solveTime = t.age().toMilliSecondsDouble();
+
+        if(solved){
+          t = Time::now();
+          Scalar stepNorm = 0, paramNorm = 0, predicted = 0;
+          for(int c=0;c<nc;++c){
+            for(int a=0;a<C;++a){
+              const Scalar d = s.dc[c*C+a];
+              s.camsNew(a,c) = s.cams(a,c) + d;
+              stepNorm += d*d;
+              paramNorm += s.cams(a,c)*s.cams(a,c);
+              predicted += d*(s.lambda*d - s.ga[c*C+a]);
+            }
+          }
+          for(int p=0;p<np;++p){
+            for(int a=0;a<P;++a){
+              const Scalar d = s.dp[p*P+a];
+              s.ptsNew(a,p) = s.pts(a,p) + d;
+              stepNorm += d*d;
+              paramNorm += s.pts(a,p)*s.pts(a,p);
+              predicted += d*(s.lambda*d - s.gb[p*P+a]);
+            }
+          }
+          Evaluate<Scalar> evalNew = { &s, &s.camsNew, &s.ptsNew, s.rNew.data(), false };
+          parallel_for(0, N, evalNew, OBS_GRAIN);
+          Scalar eNew = 0;
+          for(int i=0;i<N*M;++i) eNew += s.rNew[i]*s.rNew[i];
+          eNew /= 2;
+          info.evaluationTime = t.age().toMilliSecondsDouble();
+
+          // gain ratio (actual vs. predicted reduction)
+          const Scalar rho = predicted > 0 ? 2*(e - eNew)/predicted : Scalar(-1);
+          if(rho > 0){
+            s.cams = s.camsNew;
+            s.pts = s.ptsNew;
+            s.r.swap(s.rNew);
+            e = eNew;
+            s.lambda *= iclMax(Scalar(1.0/3.0), Scalar(1.0 - std::pow(2*rho - 1, 3)));
+            v = 2;
+            info.accepted = true;
+            recompute = true;
+          }
+          info.error = e;
+          result.iterations.push_back(info);
+          if(dbg){
+            result.iteration = it;
+            result.error = e;
+            result.lambda = s.lambda;
+            result.cameras = s.cams;
+            result.points = s.pts;
+            dbg(result);
+          }
+          if(std::sqrt(stepNorm) <= eps2*(std::sqrt(paramNorm) + eps2)) { ++it; break; }
+          if(info.accepted) continue;
+        }else{
+          info.error = e;
+          result.iterations.push_back(info);
+        }
+        s.lambda *= v;
+        v *= 2;
+        if(v > 1.e15) { ++it; break; }
+      }
+
+      result.iteration = it;
+      result.error = e;
+      result.lambda = s.lambda;
+      result.cameras = s.cams;
+      result.points = s.pts;
+      return result;
+    }
+
+    template<class Scalar>
+    typename SparseBundleAdjuster<Scalar>::Jacobian
+    SparseBundleAdjuster<Scalar>::create_numerical_jacobian(Projection f, int measurementDim, Scalar delta){
+      return Jacobian(new NumericJacobian<Scalar>(f,measurementDim,delta));
+    }
+
+    template<class Scalar>
+    void SparseBundleAdjuster<Scalar>::default_debug_callback(const Result &r){
+      std::cout << r << std::endl;
+    }
+
+    template<class Scalar>
+    void SparseBundleAdjuster<Scalar>::setDebugCallback(DebugCallback dbg){
+      this->dbg = dbg;
+    }
+
+    template class ICLMath_API SparseBundleAdjuster<icl32f>;
+    template class ICLMath_API SparseBundleAdjuster<icl64f>;
+  } // namespace math
+}
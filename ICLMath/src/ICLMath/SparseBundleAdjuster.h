@@ -0,0 +1,208 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLMath/src/ICLMath/SparseBundleAdjuster.h             **
+** Module : ICLMath                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLMath/DynVector.h>
+#include <ICLUtils/Function.h>
+#include <ICLUtils/Exception.h>
+
+namespace icl{
+  namespace math{
+
+    /// Sparse Levenberg Marquardt optimizer for bundle adjustment problems
+    /** The dense LevenbergMarquardtFitter builds the complete Jacobian and solves the
+        normal equations \f$ (J^TJ + \lambda I)\delta = -J^Tr \f$ with a dense solver. For
+        bundle adjustment problems, i.e. the joint optimization of many camera parameter
+        blocks and many point parameter blocks, this is infeasible, because each residual
+        depends on exactly one camera and one point only.
+
+        \section _SBA_P_ Problem Formulation
+        The problem is defined by a set of cameras (C parameters each), a set of points
+        (P parameters each) and a set of observations. Each observation links one camera
+        j with one point i and contains a measurement \f$ y_{ij} \f$ of dimension M
+        (usually the 2D image position of the point). The projection function f computes
+        the expected measurement from the camera and point parameters, the optimizer
+        minimizes
+
+        \f[ E = \frac{1}{2} \sum_{(i,j)} \| f(c_j, p_i) - y_{ij} \|^2 \f]
+
+        The camera and point parameters are passed as matrices, where each row contains
+        the parameters of one camera or point.
+
+        \section _SBA_A_ Algorithm
+        - the Jacobian is stored block-wise: one M x (C+P) block per observation
+        - the camera blocks \f$ U_j \f$, the point blocks \f$ V_i \f$ and the coupling
+          blocks \f$ W_{ij} \f$ of the normal equations are accumulated from these blocks
+        - the point parameters are eliminated using the Schur complement
+          \f$ S = U - W V^{-1} W^T \f$, which is cheap, because V is block diagonal
+        - the reduced camera system S (size #cameras*C) is solved using a Cholesky
+          decomposition, the point updates are obtained by back substitution
+
+        Residuals, Jacobian blocks, the Schur complement rows and the Cholesky decomposition
+        are computed in parallel using utils::parallel_for. The given projection function and
+        Jacobian must therefore be thread-safe.
+
+        \section _SBA_J_ Jacobian
+        The Jacobian of f for a single observation is an M x (C+P) matrix, whose first C
+        columns contain the partial derivatives with respect to the camera parameters,
+        the last P columns the ones with respect to the point parameters. If no analytic
+        Jacobian is given, a numerical Jacobian is created (see create_numerical_jacobian).
+
+        \section _SBA_G_ Gauge Freedom
+        Bundle adjustment problems are usually not well defined without fixing some of
+        the parameters (e.g. the first camera). Cameras and points can be excluded from the
+        optimization using setFixedCameras and setFixedPoints.
+
+        \section _SBA_T_ Timing
+        The Result contains an IterationInfo entry for each iteration, that reports the
+        time needed for the Jacobian evaluation, the Schur complement, the linear solver
+        and the evaluation of the updated parameters.
+    */
+    template<class Scalar>
+    class ICLMath_API SparseBundleAdjuster{
+      public:
+
+      typedef DynColVector<Scalar> Vector; //!< vector type
+      typedef DynMatrix<Scalar> Matrix;    //!< matrix type
+
+      /// a single measurement of a point in a camera
+      struct Observation{
+        int camera;           //!< camera index (row in the cameras matrix)
+        int point;            //!< point index (row in the points matrix)
+        Vector measurement;   //!< measured value (dimension M)
+
+        /// creates an observation
+        Observation(int camera=0, int point=0, const Vector &measurement=Vector()):
+          camera(camera),point(point),measurement(measurement){}
+      };
+
+      /// timing and error information for a single iteration
+      struct IterationInfo{
+        int iteration;          //!< iteration index
+        Scalar error;           //!< error after this iteration
+        Scalar lambda;          //!< damping parameter used in this iteration
+        bool accepted;          //!< whether the step was accepted
+        float jacobianTime;     //!< time for residual and Jacobian evaluation [ms]
+        float schurTime;        //!< time for the normal equation blocks and the Schur complement [ms]
+        float solveTime;        //!< time for solving the reduced camera system and the back substitution [ms]
+        float evaluationTime;   //!< time for evaluating the error of the updated parameters [ms]
+      };
+
+      /// fitting result
+      struct Result{
+        int iteration;                           //!< number of iterations needed
+        Scalar initialError;                     //!< initial error
+        Scalar error;                            //!< reached error
+        Scalar lambda;                           //!< last damping parameter
+        Matrix cameras;                          //!< optimized camera parameters
+        Matrix points;                           //!< optimized point parameters
+        std::vector<IterationInfo> iterations;   //!< per iteration information
+
+        /// overloaded ostream-operator
+        friend ICLMath_API inline std::ostream &operator<<(std::ostream &str, const Result &d){
+          return str << "iteration: " << d.iteration << " initial error: " << d.initialError
+                     << " error:" << d.error << "  lambda:" << d.lambda;
+        }
+      };
+
+      /// projection function y = f(camera, point)
+      typedef utils::Function<void,const Vector&,const Vector&,Vector&> Projection;
+
+      /// Jacobian of f for a single observation (M x (C+P), see \ref _SBA_J_)
+      typedef utils::Function<void,const Vector&,const Vector&,Matrix&> Jacobian;
+
+      /// Optionally given debug callback, that is called in every iteration
+      typedef utils::Function<void,const Result&> DebugCallback;
+
+      /// creates a dummy (null instance)
+      SparseBundleAdjuster();
+
+      /// create an instance with given parameters
+      /** @param f projection function
+          @param measurementDim measurement dimension M
+          @param j optionally given Jacobian of f. If j is null, a numerical Jacobian is used
+          @param tau used for the initial damping parameter (see LevenbergMarquardtFitter)
+          @param maxIterations maximum number of iterations
+          @param minError if the current error gets less than this threshold, the optimization is finished
+          @param eps1 if the maximum gradient component is less than this threshold, the optimization is finished
+          @param eps2 if the change in parameters is less than this threshold, the optimization is finished
+      */
+      SparseBundleAdjuster(Projection f, int measurementDim, Jacobian j=Jacobian(),
+                           Scalar tau=1.e-3, int maxIterations=100, Scalar minError=1.e-6,
+                           Scalar eps1=1.e-10, Scalar eps2=1.e-10);
+
+      /// (re)-initialization method
+      void init(Projection f, int measurementDim, Jacobian j=Jacobian(),
+                Scalar tau=1.e-3, int maxIterations=100, Scalar minError=1.e-6,
+                Scalar eps1=1.e-10, Scalar eps2=1.e-10);
+
+      /// excludes the given cameras from the optimization
+      void setFixedCameras(const std::vector<int> &cameras);
+
+      /// excludes the given points from the optimization
+      void setFixedPoints(const std::vector<int> &points);
+
+      /// optimizes the given camera and point parameters
+      /** @param cameras initial camera parameters (one row per camera)
+          @param points initial point parameters (one row per point)
+          @param observations the observations (camera and point indices must be valid)
+      */
+      Result fit(const Matrix &cameras, const Matrix &points,
+                 const std::vector<Observation> &observations) throw (utils::ICLException);
+
+      /// creates a numerical Jacobian for the given projection function
+      /** Central differences with the given delta are used */
+      static Jacobian create_numerical_jacobian(Projection f, int measurementDim, Scalar delta=1.e-5);
+
+      /// default debug callback that simply streams r to std::cout
+      static void default_debug_callback(const Result &r);
+
+      /// sets a debug callback method, which is called automatically in every iteration
+      void setDebugCallback(DebugCallback dbg=default_debug_callback);
+
+      private:
+
+      Projection f;             //!< projection function
+      Jacobian j;               //!< Jacobian of f
+      int M;                    //!< measurement dimension
+      Scalar tau;               //!< used for initial damping parameter lambda
+      int maxIterations;        //!< maximum number of iterations
+      Scalar minError;          //!< minimum error threshold
+      Scalar eps1;              //!< minimum gradient threshold
+      Scalar eps2;              //!< minimum parameter change threshold
+      std::vector<int> fixedCameras; //!< fixed camera indices
+      std::vector<int> fixedPoints;  //!< fixed point indices
+      DebugCallback dbg;        //!< debug callback
+    };
+
+  } // namespace math
+} // namespace icl
@@ -0,0 +1,119 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLUtils/src/ICLUtils/Atomic.h                         **
+** Module : ICLUtils                                               **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <cstddef>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace icl{
+  namespace utils{
+
+    /// Portable atomic operations on int and size_t values \ingroup THREAD
+    /** All operations are sequentially consistent. GCC compatible compilers
+        use the __atomic builtins, MSVC uses the _Interlocked intrinsics.
+        The values must not be accessed in a non-atomic way while other
+        threads use them.
+        \code
+        int counter = 0;
+        // in several threads
+        if(!Atomic::dec(&counter)) notify();
+        \endcode */
+    struct Atomic{
+  #if defined(__GNUC__)
+      /// atomically adds d to *v and returns the new value
+      static inline int add(int *v, int d){ return __atomic_add_fetch(v,d,__ATOMIC_SEQ_CST); }
+
+      /// atomically reads *v
+      static inline int load(const int *v){ return __atomic_load_n(v,__ATOMIC_SEQ_CST); }
+
+      /// atomically sets *v to x
+      static inline void store(int *v, int x){ __atomic_store_n(v,x,__ATOMIC_SEQ_CST); }
+
+      /// atomically adds d to *v and returns the new value
+      static inline size_t add(size_t *v, size_t d){ return __atomic_add_fetch(v,d,__ATOMIC_SEQ_CST); }
+
+      /// atomically subtracts d from *v and returns the new value
+      static inline size_t sub(size_t *v, size_t d){ return __atomic_sub_fetch(v,d,__ATOMIC_SEQ_CST); }
+
+      /// atomically reads *v
+      static inline size_t load(const size_t *v){ return __atomic_load_n(v,__ATOMIC_SEQ_CST); }
+
+      /// atomically sets *v to x
+      static inline void store(size_t *v, size_t x){ __atomic_store_n(v,x,__ATOMIC_SEQ_CST); }
+  #elif defined(_MSC_VER)
+      static inline int add(int *v, int d){
+        return (int)_InterlockedExchangeAdd((volatile long*)v,(long)d) + d;
+      }
+      static inline int load(const int *v){
+        return (int)_InterlockedCompareExchange((volatile long*)v,0,0);
+      }
+      static inline void store(int *v, int x){
+        _InterlockedExchange((volatile long*)v,(long)x);
+      }
+    #ifdef _WIN64
+      static inline size_t add(size_t *v, size_t d){
+        return (size_t)_InterlockedExchangeAdd64((volatile __int64*)v,(__int64)d) + d;
+      }
+      static inline size_t load(const size_t *v){
+        return (size_t)_InterlockedCompareExchange64((volatile __int64*)v,0,0);
+      }
+      static inline void store(size_t *v, size_t x){
+        _InterlockedExchange64((volatile __int64*)v,(__int64)x);
+      }
+    #else
+      static inline size_t add(size_t *v, size_t d){
+        return (size_t)_InterlockedExchangeAdd((volatile long*)v,(long)d) + d;
+      }
+      static inline size_t load(const size_t *v){
+        return (size_t)_InterlockedCompareExchange((volatile long*)v,0,0);
+      }
+      static inline void store(size_t *v, size_t x){
+        _InterlockedExchange((volatile long*)v,(long)x);
+      }
+    #endif
+      static inline size_t sub(size_t *v, size_t d){ return add(v,(size_t)0-d); }
+  #else
+  #error "ICLUtils/Atomic.h: atomic operations are not implemented for this compiler"
+  #endif
+
+      /// atomically increments *v and returns the new value
+      static inline int inc(int *v){ return add(v,1); }
+
+      /// atomically decrements *v and returns the new value
+      static inline int dec(int *v){ return add(v,-1); }
+    };
+
+  } // namespace utils
+}
@@ -0,0 +1,113 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLUtils/src/ICLUtils/CPUFeatures.cpp                  **
+** Module : ICLUtils                                               **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLUtils/CPUFeatures.h>
+#include <cstdlib>
+
+#if defined _MSC_VER && (defined _M_X64 || defined _M_IX86)
+#include <intrin.h>
+#define ICL_CPUID_MSVC
+#elif (defined __GNUC__ || defined __clang__) && (defined __x86_64__ || defined __i386__)
+#include <cpuid.h>
+#define ICL_CPUID_GCC
+#endif
+
+namespace icl{
+  namespace utils{
+
+    namespace{
+      struct CPUFeatureTable{
+        bool features[cpuAVX2+1];
+
+        static void cpuid(int leaf, int subleaf, unsigned int r[4]){
+          r[0] = r[1] = r[2] = r[3] = 0;
+#if defined ICL_CPUID_MSVC
+          int regs[4];
+          __cpuidex(regs,leaf,subleaf);
+          for(int i=0;i<4;++i) r[i] = (unsigned int)regs[i];
+#elif defined ICL_CPUID_GCC
+          if((unsigned int)leaf > __get_cpuid_max(0,0)) return;
+          __cpuid_count(leaf,subleaf,r[0],r[1],r[2],r[3]);
+#else
+          (void)leaf; (void)subleaf;
+#endif
+        }
+
+        /// returns whether the OS saves the xmm and ymm registers on context switches
+        static bool os_supports_ymm(){
+#if defined ICL_CPUID_MSVC
+          return (_xgetbv(0) & 6) == 6;
+#elif defined ICL_CPUID_GCC
+          unsigned int eax = 0, edx = 0;
+          __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+          return (eax & 6) == 6;
+#else
+          return false;
+#endif
+        }
+
+        CPUFeatureTable(){
+          for(int i=0;i<=cpuAVX2;++i) features[i] = false;
+          unsigned int r[4];
+          cpuid(0,0,r);
+          const unsigned int maxLeaf = r[0];
+          if(maxLeaf < 1) return;
+
+          cpuid(1,0,r);
+          const unsigned int ecx = r[2], edx = r[3];
+          features[cpuSSE2] = edx & (1<<26);
+          features[cpuSSE3] = ecx & (1<<0);
+          features[cpuSSSE3] = ecx & (1<<9);
+          features[cpuSSE41] = ecx & (1<<19);
+          features[cpuSSE42] = ecx & (1<<20);
+
+          const bool osxsave = ecx & (1<<27);
+          const bool ymm = osxsave && os_supports_ymm();
+          features[cpuAVX] = ymm && (ecx & (1<<28));
+
+          if(maxLeaf >= 7){
+            cpuid(7,0,r);
+            features[cpuAVX2] = features[cpuAVX] && (r[1] & (1<<5));
+          }
+          if(getenv("ICL_DISABLE_AVX2")){
+            features[cpuAVX2] = false;
+          }
+        }
+      };
+    }
+
+    bool cpu_supports(CPUFeature f){
+      static const CPUFeatureTable table;
+      if((int)f < 0 || (int)f > (int)cpuAVX2) return false;
+      return table.features[f];
+    }
+
+  } // namespace utils
+}
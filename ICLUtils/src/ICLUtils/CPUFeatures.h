@@ -0,0 +1,62 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLUtils/src/ICLUtils/CPUFeatures.h                    **
+** Module : ICLUtils                                               **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+
+namespace icl{
+  namespace utils{
+
+    /// CPU instruction set extensions that can be queried at runtime \ingroup UTILS
+    enum CPUFeature{
+      cpuSSE2,  //!< SSE2 (always available on x86_64)
+      cpuSSE3,  //!< SSE3
+      cpuSSSE3, //!< supplemental SSE3
+      cpuSSE41, //!< SSE 4.1
+      cpuSSE42, //!< SSE 4.2
+      cpuAVX,   //!< AVX (including operating system support for the ymm registers)
+      cpuAVX2   //!< AVX2 (including operating system support for the ymm registers)
+    };
+
+    /// returns whether the CPU, the program is currently running on, supports the given feature \ingroup UTILS
+    /** The CPU is queried only once using the cpuid instruction. On non-x86
+        platforms, false is returned for all features. Please note, that the result
+        does not tell whether ICL was compiled with support for the given feature.
+        Code paths for instruction sets beyond SSE2 are compiled into separate
+        translation units (see ICL_AVX2_FLAGS in the top-level CMakeLists.txt)
+        and must only be entered if this function returns true.
+        Setting the environment variable ICL_DISABLE_AVX2 (to any value) lets this
+        function return false for cpuAVX2, which is useful to compare the AVX2
+        code paths against the SSE2 ones. */
+    ICLUtils_API bool cpu_supports(CPUFeature f);
+
+  } // namespace utils
+}
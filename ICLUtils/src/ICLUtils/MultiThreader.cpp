@@ -30,167 +30,61 @@
 
 #include <ICLUtils/MultiThreader.h>
 #include <ICLUtils/Macros.h>
-#include <ICLUtils/Thread.h>
-#include <ICLUtils/Semaphore.h>
-#include <ICLUtils/Mutex.h>
+#include <ICLUtils/TaskScheduler.h>
 
 
 namespace icl{
   namespace utils{
-    class MultiThreader::MTWorkThread : public Thread{
+    class MultiThreader::MTWorkThread : public TaskScheduler::Task{
     public:
       // {{{ open
-  
-      MTWorkThread(Semaphore *sem1, Semaphore *sem2, Semaphore *semDone):work(0),m_bCurr(0){
-        // {{{ open
-  
-        m_apoSems[0] = sem1;
-        m_apoSems[1] = sem2;
-        m_poSemDone = semDone;
-        m_bEnd = false;
-      }
-  
-      // }}}
-      
-      ~MTWorkThread(){
-        // {{{ open
-  
-        m_oWorkMutex.lock();
-        work = 0;
-        m_oWorkMutex.unlock();
-        m_bEnd = true;
-        m_apoSems[m_bCurr]->release(1);
-      }
-  
-      // }}}
-      
+
+      MTWorkThread(MultiThreader::Work *work):work(work){}
+
       virtual void run(){
-        // {{{ open
-  
-        while(!m_bEnd){
-          m_apoSems[m_bCurr]->acquire(1);
-          Thread::usleep(0);
-          m_oWorkMutex.lock();
-          Thread::usleep(0);
-          if(work){
-  
-            work->perform();
-          }
-          Thread::usleep(0);
-          m_oWorkMutex.unlock();
-          Thread::usleep(0);
-          m_poSemDone->release(1);
-          Thread::usleep(0);
-          m_bCurr = !m_bCurr;
-          
-          Thread::usleep(0);
-        }
+        work->perform();
       }
-  
-      // }}}
-      
-      void setWork(MultiThreader::Work *work){
-        // {{{ open
-  
-        m_oWorkMutex.lock();
-        this->work = work;
-        m_oWorkMutex.unlock();
-      }
-  
+
       // }}}
-      
+
     private:
       MultiThreader::Work *work;
-      Semaphore *m_apoSems[2];
-      Semaphore *m_poSemDone;
-      Mutex m_oWorkMutex;
-      bool m_bCurr;
-      bool m_bEnd;
     };
-  
-    // }}}
-  
+
     class MultiThreaderImpl{
       // {{{ open
-  
+
     public:
-      MultiThreaderImpl(int nThreads):
-        // {{{ open
-  
-        m_iNThreads(nThreads),m_bCurr(0){
-        m_vecThreads.resize(nThreads);
-        
-        m_apoSems[0] = new Semaphore(nThreads);
-        m_apoSems[1] = new Semaphore(nThreads);
-        m_poDoneSem = new Semaphore(nThreads);
-        
-        
-        m_apoSems[0]->acquire(nThreads);
-        m_apoSems[1]->acquire(nThreads);
-        m_poDoneSem->acquire(nThreads);
-        
-        for(int i=0;i<nThreads;++i){
-          m_vecThreads[i] = new MultiThreader::MTWorkThread(m_apoSems[0],m_apoSems[1],m_poDoneSem);
-          m_vecThreads[i]->start();
-        }
-      }
-  
-      // }}}
-      ~MultiThreaderImpl(){
-        // {{{ open
-  
-        for(int i=0;i<m_iNThreads;++i){
-          delete m_vecThreads[i];
-        }
-        delete m_apoSems[0];
-        delete m_apoSems[1];
-      }
-  
-      // }}}
-      
+      MultiThreaderImpl(int nThreads):m_iNThreads(nThreads){}
+
       inline void apply(MultiThreader::WorkSet &ws){
         // {{{ open
-  
-        ICLASSERT_RETURN((int)ws.size() == m_iNThreads);
-        
-        /// arm the threads
-        for(unsigned int i=0;i<ws.size();i++){
-          m_vecThreads[i]->setWork(ws[i]);
-        }
-        
-        m_apoSems[m_bCurr]->release(m_iNThreads);
-        m_poDoneSem->acquire(m_iNThreads);
-        
-        /// defuse the threads !
+
+        // the work packages are processed by the global TaskScheduler's
+        // threads, which are shared with all other parallel algorithms
+        TaskGroup group;
         for(unsigned int i=0;i<ws.size();i++){
-          m_vecThreads[i]->setWork(0);
+          if(ws[i]) group.run(new MultiThreader::MTWorkThread(ws[i]));
         }
-        
-        m_bCurr =! m_bCurr;
+        group.wait();
       }
-  
+
       // }}}
-      
-      inline int getNumThreads() const { 
+
+      inline int getNumThreads() const {
         // {{{ open
-  
+
         return m_iNThreads;
       }
-  
+
       // }}}
-  
+
     private:
       int m_iNThreads;
-      std::vector<MultiThreader::MTWorkThread*> m_vecThreads;
-      Semaphore *m_apoSems[2];
-      Semaphore *m_poDoneSem;
-      Mutex m_oSemMutex;
-      bool m_bCurr;
-  
     };
-  
+
     // }}}
-  
+
     void MultiThreaderImplDelOp::delete_func( MultiThreaderImpl *impl){
       // {{{ open
   
@@ -54,9 +54,12 @@ namespace icl{
         Works will be computed in a single thread internally when given to the apply
         operator of the MultiThreader. \n
 
-        <b>Please note</b> This tool was written before openmp became popular
-        and part of compilers. Today we recommend to use openmp rather then the
-        Multithreader class.
+        <b>Please note</b> The work packages are processed by the threads of
+        the process-wide utils::TaskScheduler, which are shared with all other
+        parallelized algorithms. The thread count given to the constructor is
+        only kept for backwards compatibility. For new code, we recommend to use
+        utils::parallel_for or utils::TaskGroup directly, which are much more
+        convenient and do also support load balancing and nested parallelism.
         
         \section __EX Example
         The following example explains how to parallelize a simple function-call
@@ -171,7 +174,7 @@ namespace icl{
       };
   
       /** \cond */
-      /// internally used working Thread class
+      /// internally used task class that wraps a single Work instance
       class MTWorkThread;
       /** \endcond */
   
@@ -185,6 +188,8 @@ namespace icl{
       MultiThreader(int nThreads);
       
       /// applying operator (performs each Work* element of ws parallel)
+      /** The call returns when all work packages are finished. The WorkSet
+          size is no longer restricted to the number of threads */
       void operator()(WorkSet &ws);
       
       /// returns the number of WorkThreads
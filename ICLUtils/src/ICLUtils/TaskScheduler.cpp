@@ -0,0 +1,390 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLUtils/src/ICLUtils/TaskScheduler.cpp                **
+** Module : ICLUtils                                               **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLUtils/TaskScheduler.h>
+#include <ICLUtils/Thread.h>
+#include <ICLUtils/Mutex.h>
+#include <ICLUtils/Exception.h>
+#include <ICLUtils/Atomic.h>
+#include <ICLUtils/StringUtils.h>
+#include <pthread.h>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+
+#ifdef ICL_SYSTEM_WINDOWS
+  #include <Windows.h>
+#else
+  #include <unistd.h>
+#endif
+
+namespace icl{
+  namespace utils{
+
+    namespace{
+      /// a queued task and the group it belongs to
+      struct QueuedTask{
+        QueuedTask(TaskScheduler::Task *task=0, TaskGroup *group=0):task(task),group(group){}
+        TaskScheduler::Task *task;
+        TaskGroup *group;
+      };
+
+      /// task queue that can be accessed from both ends
+      struct TaskQueue{
+        Mutex mutex;
+        std::deque<QueuedTask> tasks;
+      };
+
+      /// thread local worker index (stored as index+1, 0 for non workers)
+      pthread_key_t s_workerKey;
+      pthread_once_t s_workerKeyOnce = PTHREAD_ONCE_INIT;
+      void create_worker_key(){
+        pthread_key_create(&s_workerKey,0);
+      }
+      int get_worker_index(){
+        pthread_once(&s_workerKeyOnce,create_worker_key);
+        return (int)(size_t)pthread_getspecific(s_workerKey) - 1;
+      }
+      void set_worker_index(int idx){
+        pthread_once(&s_workerKeyOnce,create_worker_key);
+        pthread_setspecific(s_workerKey,(void*)(size_t)(idx+1));
+      }
+    }
+
+    class TaskSchedulerImpl{
+    public:
+
+      class Worker : public Thread{
+      public:
+        Worker(TaskSchedulerImpl *impl, int idx):impl(impl),idx(idx){}
+        virtual void run(){
+          set_worker_index(idx);
+          impl->workerLoop(idx);
+        }
+        TaskSchedulerImpl *impl;
+        int idx;
+      };
+
+      TaskSchedulerImpl(int nThreads):nThreads(nThreads),refs(1),queued(0),sleeping(0),sleepingWaiters(0),stopped(false){
+        pthread_mutex_init(&sleepMutex,0);
+        pthread_cond_init(&cond,0);
+        // queue 0 is the injection queue, queue i+1 belongs to worker i
+        queues.resize(nThreads);
+        for(int i=0;i<nThreads;++i){
+          queues[i] = new TaskQueue;
+        }
+        workers.resize(nThreads-1);
+        for(int i=0;i<nThreads-1;++i){
+          workers[i] = new Worker(this,i);
+          workers[i]->start();
+        }
+      }
+
+      ~TaskSchedulerImpl(){
+        pthread_mutex_lock(&sleepMutex);
+        stopped = true;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&sleepMutex);
+        for(unsigned int i=0;i<workers.size();++i){
+          workers[i]->wait();
+          delete workers[i];
+        }
+        for(unsigned int i=0;i<queues.size();++i){
+          for(unsigned int j=0;j<queues[i]->tasks.size();++j){
+            delete queues[i]->tasks[j].task;
+          }
+          delete queues[i];
+        }
+        pthread_cond_destroy(&cond);
+        pthread_mutex_destroy(&sleepMutex);
+      }
+
+      /// adds a reference
+      void acquire(){
+        Atomic::inc(&refs);
+      }
+
+      /// removes a reference and deletes the pool if it was the last one
+      /** The last reference is either held by the TaskScheduler instance or by
+          a top-level task group, which is never destroyed by one of the pool's
+          own workers. Therefore, the workers are never joined by themselves. */
+      static void release(TaskSchedulerImpl *impl){
+        if(!Atomic::dec(&impl->refs)) delete impl;
+      }
+
+      /// returns the queue of the calling thread
+      TaskQueue &ownQueue(){
+        const int w = get_worker_index();
+        return *queues[(w >= 0 && w < nThreads-1) ? w+1 : 0];
+      }
+
+      /// wakes up a sleeping thread (the sleep mutex is only taken if there is one)
+      /** Sleeping threads increment the sleeping counter before they check
+          their wake-up condition under the sleep mutex. Since the caller has
+          changed the condition before, either the sleeper sees the change or
+          we see the sleeper, which then is already waiting or will be once we
+          got the mutex. */
+      void wakeUp(){
+        if(!Atomic::load(&sleeping)) return;
+        pthread_mutex_lock(&sleepMutex);
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&sleepMutex);
+      }
+
+      void spawn(TaskScheduler::Task *task, TaskGroup *group){
+        Atomic::inc(&group->m_pending);
+
+        TaskQueue &q = ownQueue();
+        q.mutex.lock();
+        q.tasks.push_back(QueuedTask(task,group));
+        q.mutex.unlock();
+
+        Atomic::inc(&queued);
+        wakeUp();
+      }
+
+      /// tries to grab a task: own queue's back first, then other queues' front
+      bool grab(QueuedTask &t){
+        const int w = get_worker_index();
+        const int own = (w >= 0 && w < nThreads-1) ? w+1 : 0;
+        bool found = false;
+        {
+          TaskQueue &q = *queues[own];
+          Mutex::Locker l(q.mutex);
+          if(q.tasks.size()){
+            t = q.tasks.back();
+            q.tasks.pop_back();
+            found = true;
+          }
+        }
+        for(int i=1;i<nThreads && !found;++i){
+          TaskQueue &q = *queues[(own+i)%nThreads];
+          Mutex::Locker l(q.mutex);
+          if(q.tasks.size()){
+            t = q.tasks.front();
+            q.tasks.pop_front();
+            found = true;
+          }
+        }
+        // the counter may become negative for a moment, if a task is
+        // grabbed before its spawner has incremented the counter
+        if(found) Atomic::dec(&queued);
+        return found;
+      }
+
+      /// executes the task and notifies its group
+      void execute(QueuedTask &t){
+        std::string error;
+        try{
+          t.task->run();
+        }catch(const std::exception &ex){
+          error = ex.what();
+        }catch(...){
+          error = "unknown exception";
+        }
+        delete t.task;
+        TaskGroup *g = t.group;
+        if(error.length()){
+          pthread_mutex_lock(&sleepMutex);
+          if(!g->m_error.length()) g->m_error = error;
+          pthread_mutex_unlock(&sleepMutex);
+        }
+        // the group may be destroyed by its waiter as soon as the counter is 0
+        if(!Atomic::dec(&g->m_pending) && Atomic::load(&sleepingWaiters)){
+          pthread_mutex_lock(&sleepMutex);
+          pthread_cond_broadcast(&cond);
+          pthread_mutex_unlock(&sleepMutex);
+        }
+      }
+
+      bool runOne(){
+        QueuedTask t;
+        if(!grab(t)) return false;
+        execute(t);
+        return true;
+      }
+
+      void workerLoop(int idx){
+        (void)idx;
+        while(true){
+          if(runOne()) continue;
+          pthread_mutex_lock(&sleepMutex);
+          Atomic::inc(&sleeping);
+          while(!stopped && Atomic::load(&queued) <= 0){
+            pthread_cond_wait(&cond,&sleepMutex);
+          }
+          Atomic::dec(&sleeping);
+          const bool stop = stopped;
+          pthread_mutex_unlock(&sleepMutex);
+          if(stop) return;
+        }
+      }
+
+      void wait(TaskGroup *group){
+        while(Atomic::load(&group->m_pending)){
+          if(runOne()) continue;
+
+          pthread_mutex_lock(&sleepMutex);
+          Atomic::inc(&sleepingWaiters);
+          Atomic::inc(&sleeping);
+          while(Atomic::load(&group->m_pending) && Atomic::load(&queued) <= 0){
+            pthread_cond_wait(&cond,&sleepMutex);
+          }
+          Atomic::dec(&sleeping);
+          Atomic::dec(&sleepingWaiters);
+          pthread_mutex_unlock(&sleepMutex);
+          // we might have consumed a wake-up signal that was meant for a worker
+          if(!Atomic::load(&group->m_pending) && Atomic::load(&queued) > 0){
+            wakeUp();
+          }
+        }
+      }
+
+      int nThreads;
+      int refs;
+      std::vector<TaskQueue*> queues;
+      std::vector<Worker*> workers;
+
+      /// protects the sleep state and the error messages of all groups
+      /** The task and group counters are accessed atomically, so that
+          the mutex is only taken for going to sleep and for waking up
+          sleeping threads */
+      pthread_mutex_t sleepMutex;
+      pthread_cond_t cond;
+      int queued;
+      int sleeping;
+      int sleepingWaiters;
+      bool stopped;
+    };
+
+    namespace{
+      Mutex s_instanceMutex;
+      TaskScheduler *s_instance = 0;
+
+      struct InstanceCleanup{
+        ~InstanceCleanup(){
+          Mutex::Locker l(s_instanceMutex);
+          ICL_DELETE(s_instance);
+        }
+      } s_instanceCleanup;
+    }
+
+    TaskScheduler::TaskScheduler(int nThreads):
+      m_impl(new TaskSchedulerImpl(iclMax(1,nThreads))){
+    }
+
+    TaskScheduler::~TaskScheduler(){
+      TaskSchedulerImpl::release(m_impl);
+    }
+
+    TaskScheduler &TaskScheduler::instance(){
+      Mutex::Locker l(s_instanceMutex);
+      if(!s_instance){
+        s_instance = new TaskScheduler(getDefaultNumThreads());
+      }
+      return *s_instance;
+    }
+
+    TaskSchedulerImpl *TaskScheduler::acquireImpl(){
+      Mutex::Locker l(s_instanceMutex);
+      if(!s_instance){
+        s_instance = new TaskScheduler(getDefaultNumThreads());
+      }
+      s_instance->m_impl->acquire();
+      return s_instance->m_impl;
+    }
+
+    void TaskScheduler::setNumThreads(int n){
+      if(n <= 0) n = getDefaultNumThreads();
+      Mutex::Locker l(s_instanceMutex);
+      if(!s_instance){
+        s_instance = new TaskScheduler(n);
+        return;
+      }
+      if(s_instance->m_impl->nThreads == n) return;
+      // the instance itself stays valid, references returned by instance() are kept
+      TaskSchedulerImpl *old = s_instance->m_impl;
+      s_instance->m_impl = new TaskSchedulerImpl(n);
+      TaskSchedulerImpl::release(old);
+    }
+
+    int TaskScheduler::getDefaultNumThreads(){
+      const char *env = getenv("ICL_NUM_THREADS");
+      if(env){
+        int n = parse<int>(env);
+        if(n > 0) return n;
+        WARNING_LOG("invalid value for ICL_NUM_THREADS: " << env << " (using number of cores)");
+      }
+#ifdef ICL_SYSTEM_WINDOWS
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      int n = (int)info.dwNumberOfProcessors;
+#else
+      int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+      return iclMax(1,n);
+    }
+
+    int TaskScheduler::getCurrentWorkerIndex(){
+      return get_worker_index();
+    }
+
+    int TaskScheduler::getNumThreads() const{
+      Mutex::Locker l(s_instanceMutex);
+      return m_impl->nThreads;
+    }
+
+    TaskGroup::TaskGroup():m_sched(TaskScheduler::acquireImpl()),m_pending(0){}
+
+    TaskGroup::~TaskGroup(){
+      try{
+        wait();
+      }catch(const ICLException &ex){
+        ERROR_LOG("unhandled exception in task: " << ex.what());
+      }
+      TaskSchedulerImpl::release(m_sched);
+    }
+
+    void TaskGroup::run(TaskScheduler::Task *task){
+      ICLASSERT_RETURN(task);
+      m_sched->spawn(task,this);
+    }
+
+    void TaskGroup::wait(){
+      m_sched->wait(this);
+      if(m_error.length()){
+        std::string err = m_error;
+        m_error = "";
+        throw ICLException(err);
+      }
+    }
+
+  } // namespace utils
+}
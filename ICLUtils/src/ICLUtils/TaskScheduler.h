@@ -0,0 +1,281 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLUtils/src/ICLUtils/TaskScheduler.h                  **
+** Module : ICLUtils                                               **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Macros.h>
+#include <ICLUtils/Rect.h>
+#include <ICLUtils/Size.h>
+#include <string>
+#include <vector>
+
+namespace icl{
+  namespace utils{
+
+    /** \cond */
+    class TaskGroup;
+    class TaskSchedulerImpl;
+    /** \endcond */
+
+    /// Process-wide work-stealing thread pool \ingroup THREAD
+    /** The TaskScheduler manages a single, lazily created set of worker threads
+        that is shared by all parallelized algorithms of ICL. Tasks are never
+        given to the scheduler directly, but always through a TaskGroup (or the
+        high level functions utils::parallel_for and utils::parallel_for_2d),
+        which is used to wait for a set of tasks to be finished.
+
+        \section WS Work Stealing
+        Each worker thread owns a task queue. Tasks that are spawned from within
+        a worker thread (nested parallelism) are pushed to the worker's own queue
+        and processed in LIFO order, which keeps the working set of a thread
+        cache local. Idle workers steal tasks from the opposite end of other
+        workers' queues. Tasks that are spawned from a non-worker thread are
+        put into a shared injection queue.
+
+        \section WAIT Waiting
+        A thread that waits for a TaskGroup does not block as long as there is
+        work left: it helps processing queued tasks. Therefore, the pool is
+        created with one thread less than getNumThreads() returns: the waiting
+        caller is the last thread. This does also make nested task groups
+        dead-lock free.
+
+        \section NT Number of Threads
+        The number of threads is determined by the ICL_NUM_THREADS environment
+        variable or -- if this is not set -- by the number of online cores.
+        It can be changed at run-time using the static setNumThreads method.
+        If the thread count is set to 1, all tasks are executed by the calling
+        thread, which is useful for debugging.
+    */
+    class ICLUtils_API TaskScheduler : public Uncopyable{
+      public:
+
+      /// Interface for tasks processed by the scheduler
+      class Task{
+        public:
+        /// virtual destructor
+        virtual ~Task(){}
+
+        /// abstract working function
+        virtual void run()=0;
+      };
+
+      /// returns the process wide scheduler instance (created at first call)
+      static TaskScheduler &instance();
+
+      /// sets the number of threads used (including the waiting caller thread)
+      /** Values <= 0 restore the default value (see getDefaultNumThreads).
+          A new pool is created for task groups that are created afterwards.
+          Existing task groups keep using the previous pool, which is destroyed
+          when the last of them is destroyed. */
+      static void setNumThreads(int n);
+
+      /// returns the default thread count (ICL_NUM_THREADS or number of cores)
+      static int getDefaultNumThreads();
+
+      /// returns the index of the calling worker thread
+      /** Worker indices are in range [0,getNumThreads()-1). Threads, that
+          do not belong to the pool (e.g. the main thread), get -1. */
+      static int getCurrentWorkerIndex();
+
+      /// returns the number of threads used (the caller thread is included)
+      int getNumThreads() const;
+
+      /// Destructor (joins all worker threads)
+      ~TaskScheduler();
+
+      private:
+      /// private constructor (use instance())
+      TaskScheduler(int nThreads);
+
+      /// returns the current implementation with an extra reference (used by TaskGroup)
+      static TaskSchedulerImpl *acquireImpl();
+
+      /// internal implementation (replaced by setNumThreads)
+      TaskSchedulerImpl *m_impl;
+
+      /// task groups directly access the implementation
+      friend class TaskGroup;
+    };
+
+
+    /// Set of tasks that are processed in parallel using the TaskScheduler \ingroup THREAD
+    /** A TaskGroup is used to spawn tasks and to wait for them to be
+        finished. Task groups can be nested: a task may create another
+        TaskGroup and wait for it.
+
+        \code
+        struct MyTask : public TaskScheduler::Task{
+          MyTask(float *data, int n):data(data),n(n){}
+          float *data;
+          int n;
+          virtual void run(){
+            for(int i=0;i<n;++i) data[i] = sqrt(data[i]);
+          }
+        };
+
+        TaskGroup g;
+        for(int i=0;i<10;++i){
+          g.run(new MyTask(data+i*100,100));
+        }
+        g.wait();
+        \endcode
+
+        Exceptions, that are thrown by a task are caught and reported by
+        throwing an ICLException from the wait() method.
+    */
+    class ICLUtils_API TaskGroup : public Uncopyable{
+      public:
+
+      /// creates an empty group
+      TaskGroup();
+
+      /// Destructor (waits for all pending tasks)
+      ~TaskGroup();
+
+      /// spawns the given task (ownership is passed to the group)
+      /** The task is deleted after it was processed */
+      void run(TaskScheduler::Task *task);
+
+      /// waits (and helps) until all spawned tasks are finished
+      /** If one of the tasks has thrown an exception, an ICLException
+          is thrown that contains the error message */
+      void wait();
+
+      private:
+      /// scheduler used (referenced until the group is destroyed)
+      TaskSchedulerImpl *m_sched;
+
+      /// number of tasks that are not finished yet (accessed atomically)
+      int m_pending;
+
+      /// first error that occurred
+      std::string m_error;
+
+      /// implementation accesses the counter
+      friend class TaskSchedulerImpl;
+    };
+
+
+    /** \cond */
+    namespace parallel_for_impl{
+
+      template<class F>
+      struct RangeTask : public TaskScheduler::Task{
+        RangeTask(TaskGroup *g, F *f, int begin, int end, int grain):
+          g(g),f(f),begin(begin),end(end),grain(grain){}
+        TaskGroup *g;
+        F *f;
+        int begin,end,grain;
+        virtual void run(){
+          // recursive splitting: the upper half is left for thiefs
+          while(end-begin > grain){
+            const int mid = begin + (end-begin)/2;
+            g->run(new RangeTask<F>(g,f,mid,end,grain));
+            end = mid;
+          }
+          (*f)(begin,end);
+        }
+      };
+
+      template<class F>
+      struct TileFunctor{
+        TileFunctor(F *f, const std::vector<Rect> *tiles):f(f),tiles(tiles){}
+        F *f;
+        const std::vector<Rect> *tiles;
+        void operator()(int begin, int end) const{
+          for(int i=begin;i<end;++i) (*f)((*tiles)[i]);
+        }
+      };
+    }
+    /** \endcond */
+
+    /// processes the index range [begin,end) in parallel \ingroup THREAD
+    /** The range is split into chunks of at most grainSize indices. For each
+        chunk, the given functor is called with the chunk boundaries f(b,e)
+        (i.e. the functor must iterate from b to e-1 itself). If grainSize is
+        0, it is chosen such that each thread gets about 4 chunks.
+        The call returns after the whole range was processed.
+
+        \code
+        struct Sqrt{
+          float *data;
+          void operator()(int begin, int end) const{
+            for(int i=begin;i<end;++i) data[i] = sqrt(data[i]);
+          }
+        };
+        Sqrt s = { data };
+        parallel_for(0,N,s);
+        \endcode
+
+        The functor is copied once, all chunks are processed by the same
+        copy, so it must be safe to call it concurrently. */
+    template<class F>
+    void parallel_for(int begin, int end, const F &f, int grainSize=0){
+      const int n = end-begin;
+      if(n <= 0) return;
+      const int nThreads = TaskScheduler::instance().getNumThreads();
+      if(grainSize <= 0){
+        grainSize = iclMax(1, n/(4*nThreads));
+      }
+      F fc(f);
+      if(nThreads == 1 || n <= grainSize){
+        fc(begin,end);
+        return;
+      }
+      TaskGroup g;
+      g.run(new parallel_for_impl::RangeTask<F>(&g,&fc,begin,end,grainSize));
+      g.wait();
+    }
+
+    /// processes the given rectangle in parallel in tiles \ingroup THREAD
+    /** The rectangle is split into a grid of tiles of the given size (tiles
+        at the right and bottom border might be smaller). The functor is
+        called once for each tile f(const Rect &tile). If tileSize's width
+        is 0 or larger than the rect, full rows of tiles are used. The
+        same for tile height. */
+    template<class F>
+    void parallel_for_2d(const Rect &r, const Size &tileSize, const F &f){
+      if(r.width <= 0 || r.height <= 0) return;
+      const int tw = (tileSize.width <= 0 || tileSize.width > r.width) ? r.width : tileSize.width;
+      const int th = (tileSize.height <= 0 || tileSize.height > r.height) ? r.height : tileSize.height;
+      std::vector<Rect> tiles;
+      for(int y=r.y;y<r.bottom();y+=th){
+        for(int x=r.x;x<r.right();x+=tw){
+          tiles.push_back(Rect(x,y,iclMin(tw,r.right()-x),iclMin(th,r.bottom()-y)));
+        }
+      }
+      F fc(f);
+      parallel_for(0,(int)tiles.size(),parallel_for_impl::TileFunctor<F>(&fc,&tiles),1);
+    }
+
+  } // namespace utils
+}
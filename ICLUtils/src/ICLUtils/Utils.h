@@ -41,6 +41,7 @@
 #include <ICLUtils/FPSLimiter.h>
 #include <ICLUtils/Timer.h>
 #include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/TaskScheduler.h>
 #include <ICLUtils/MultiTypeMap.h>
 #include <ICLUtils/ProgArg.h>
 #include <ICLUtils/Range.h>